@@ -0,0 +1,120 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/benchmarks/micro/bench.h"
+
+#include <vector>
+
+#include "hphp/runtime/base/array-init.h"
+#include "hphp/runtime/base/array-iterator.h"
+#include "hphp/runtime/base/type-array.h"
+#include "hphp/runtime/base/type-string.h"
+#include "hphp/runtime/base/type-variant.h"
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr int64_t kTableSize = 256;
+
+Array makeIntKeyed() {
+  Array arr = Array::Create();
+  // Sparse keys force a MixedArray rather than a packed layout.
+  for (int64_t i = 0; i < kTableSize; i++) {
+    arr.set(i * 7, i);
+  }
+  return arr;
+}
+
+Array makeStrKeyed(std::vector<String>& keys) {
+  Array arr = Array::Create();
+  keys.reserve(kTableSize);
+  for (int64_t i = 0; i < kTableSize; i++) {
+    auto key = String("key_") + String(i);
+    keys.push_back(key);
+    arr.set(key, i);
+  }
+  return arr;
+}
+
+}
+
+BENCHMARK(packed_array_append_64) {
+  for (uint64_t i = 0; i < iters; i++) {
+    Array arr = Array::Create();
+    for (int64_t k = 0; k < 64; k++) {
+      arr.append(k);
+    }
+    bench::use(arr.size());
+  }
+}
+
+BENCHMARK(mixed_array_set_int_64) {
+  for (uint64_t i = 0; i < iters; i++) {
+    Array arr = Array::Create();
+    for (int64_t k = 0; k < 64; k++) {
+      arr.set(k * 7, k);
+    }
+    bench::use(arr.size());
+  }
+}
+
+BENCHMARK(mixed_array_get_int_hit) {
+  auto const arr = makeIntKeyed();
+  for (uint64_t i = 0; i < iters; i++) {
+    bench::use(arr.rvalAt((i % kTableSize) * 7).asInt64Val());
+  }
+}
+
+BENCHMARK(mixed_array_get_str_hit) {
+  std::vector<String> keys;
+  auto const arr = makeStrKeyed(keys);
+  for (uint64_t i = 0; i < iters; i++) {
+    bench::use(arr.rvalAt(keys[i % kTableSize]).asInt64Val());
+  }
+}
+
+BENCHMARK(mixed_array_exists_str_miss) {
+  std::vector<String> keys;
+  auto const arr = makeStrKeyed(keys);
+  String miss("no_such_key");
+  for (uint64_t i = 0; i < iters; i++) {
+    bench::use(arr.exists(miss));
+  }
+}
+
+BENCHMARK(array_iterate_256) {
+  auto const arr = makeIntKeyed();
+  for (uint64_t i = 0; i < iters; i++) {
+    int64_t sum = 0;
+    for (ArrayIter iter(arr); iter; ++iter) {
+      sum += iter.second().asInt64Val();
+    }
+    bench::use(sum);
+  }
+}
+
+BENCHMARK(array_cow_copy_256) {
+  auto const arr = makeIntKeyed();
+  for (uint64_t i = 0; i < iters; i++) {
+    Array copy = arr;
+    copy.set(int64_t{1}, i);  // escalates the shared array to a copy
+    bench::use(copy.size());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
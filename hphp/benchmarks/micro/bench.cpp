@@ -0,0 +1,189 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/benchmarks/micro/bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hphp/util/cycles.h"
+#include "hphp/util/hardware-counter.h"
+
+namespace HPHP { namespace bench {
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Benchmark {
+  const char* name;
+  BenchFn fn;
+};
+
+std::vector<Benchmark>& registry() {
+  // Function-local so BENCHMARK registrars in other translation units
+  // can run before this file's static initializers.
+  static std::vector<Benchmark> s_registry;
+  return s_registry;
+}
+
+struct Sample {
+  double cyclesPerIter;
+  double instrsPerIter;
+};
+
+Sample measure(BenchFn fn, uint64_t iters) {
+  HardwareCounter::Reset();
+  auto const start = cpuCyclesSerialized();
+  fn(iters);
+  auto const stop = cpuCyclesSerialized();
+  auto const instrs = HardwareCounter::GetInstructionCount();
+  return Sample {
+    (double)(stop - start) / iters,
+    (double)instrs / iters
+  };
+}
+
+/*
+ * Grow the iteration count until one run is long enough to dwarf the
+ * measurement overhead, then keep the fastest of a few samples: the
+ * minimum is the run least disturbed by interrupts and migrations.
+ */
+Sample run(const Benchmark& bench) {
+  constexpr uint64_t kMinCycles = 20 * 1000 * 1000;
+  constexpr int kSamples = 5;
+
+  uint64_t iters = 1;
+  for (;;) {
+    auto const start = cpuCyclesSerialized();
+    bench.fn(iters);
+    auto const stop = cpuCyclesSerialized();
+    if (stop - start >= kMinCycles) break;
+    iters *= 2;
+  }
+
+  auto best = measure(bench.fn, iters);
+  for (int i = 1; i < kSamples; i++) {
+    auto const s = measure(bench.fn, iters);
+    if (s.cyclesPerIter < best.cyclesPerIter) best = s;
+  }
+  return best;
+}
+
+std::map<std::string,double> readBaseline(const char* filename) {
+  std::map<std::string,double> baseline;
+  auto const f = fopen(filename, "r");
+  if (!f) {
+    fprintf(stderr, "microbench: can't read baseline %s\n", filename);
+    return baseline;
+  }
+  char name[256];
+  double cycles, instrs;
+  while (fscanf(f, "%255s %lf %lf", name, &cycles, &instrs) == 3) {
+    baseline[name] = cycles;
+  }
+  fclose(f);
+  return baseline;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void registerBenchmark(const char* name, BenchFn fn) {
+  registry().push_back(Benchmark{name, fn});
+}
+
+int runBenchmarks(int argc, char** argv) {
+  const char* filter = nullptr;
+  const char* recordFile = nullptr;
+  const char* baselineFile = nullptr;
+  double threshold = 10.0;
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "--filter=", 9)) {
+      filter = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--record=", 9)) {
+      recordFile = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--baseline=", 11)) {
+      baselineFile = argv[i] + 11;
+    } else if (!strncmp(argv[i], "--threshold=", 12)) {
+      threshold = atof(argv[i] + 12);
+    } else {
+      fprintf(stderr,
+              "usage: %s [--filter=SUBSTR] [--record=FILE]\n"
+              "       [--baseline=FILE] [--threshold=PCT]\n"
+              "Gating: with --baseline, exits nonzero if any benchmark's\n"
+              "cycles/iter regressed more than PCT%% (default 10).\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  auto& benchmarks = registry();
+  std::sort(benchmarks.begin(), benchmarks.end(),
+            [] (const Benchmark& a, const Benchmark& b) {
+              return strcmp(a.name, b.name) < 0;
+            });
+
+  std::map<std::string,double> baseline;
+  if (baselineFile) baseline = readBaseline(baselineFile);
+
+  FILE* record = nullptr;
+  if (recordFile) {
+    record = fopen(recordFile, "w");
+    if (!record) {
+      fprintf(stderr, "microbench: can't write %s\n", recordFile);
+      return 1;
+    }
+  }
+
+  int regressions = 0;
+  for (auto const& bench : benchmarks) {
+    if (filter && !strstr(bench.name, filter)) continue;
+    auto const s = run(bench);
+    printf("%-40s %12.1f cycles/iter %14.1f instrs/iter",
+           bench.name, s.cyclesPerIter, s.instrsPerIter);
+    auto const it = baseline.find(bench.name);
+    if (it != baseline.end() && it->second > 0) {
+      auto const delta = (s.cyclesPerIter - it->second) / it->second * 100.0;
+      printf(" %+7.1f%%", delta);
+      if (delta > threshold) {
+        printf(" REGRESSION");
+        ++regressions;
+      }
+    }
+    printf("\n");
+    fflush(stdout);
+    if (record) {
+      fprintf(record, "%s %.1f %.1f\n",
+              bench.name, s.cyclesPerIter, s.instrsPerIter);
+    }
+  }
+  if (record) fclose(record);
+
+  if (regressions) {
+    fprintf(stderr, "microbench: %d benchmark(s) regressed more than %.1f%%\n",
+            regressions, threshold);
+    return 2;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}}
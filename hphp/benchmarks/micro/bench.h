@@ -0,0 +1,71 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_BENCHMARKS_MICRO_BENCH_H_
+#define incl_HPHP_BENCHMARKS_MICRO_BENCH_H_
+
+#include <cstdint>
+
+namespace HPHP { namespace bench {
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Calibrated microbenchmark harness for runtime primitives.
+ *
+ * A benchmark is a function that runs its body `iters` times; the
+ * harness picks `iters` so each run is long enough to measure, then
+ * reports cycles and retired instructions per iteration (via cycles.h
+ * and hardware-counter.h).  See runBenchmarks() for the command line,
+ * including the --baseline/--threshold regression gate used in CI.
+ */
+
+using BenchFn = void (*)(uint64_t iters);
+
+void registerBenchmark(const char* name, BenchFn fn);
+
+/*
+ * Run every registered benchmark (subject to --filter) and print one
+ * result line each.  Returns nonzero on bad usage or when --baseline
+ * gating detects a regression.
+ */
+int runBenchmarks(int argc, char** argv);
+
+/*
+ * Keep the compiler from optimizing a computed value, or the loop that
+ * produced it, out of the measured region.
+ */
+template<typename T>
+inline void use(T&& val) {
+  asm volatile("" : : "g"(val) : "memory");
+}
+
+inline void clobber() {
+  asm volatile("" : : : "memory");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}}
+
+#define BENCHMARK(name)                                           \
+  static void HPHP_bench_##name(uint64_t iters);                  \
+  static const struct HPHP_benchReg_##name {                      \
+    HPHP_benchReg_##name() {                                      \
+      ::HPHP::bench::registerBenchmark(#name, HPHP_bench_##name); \
+    }                                                             \
+  } HPHP_benchRegInst_##name;                                     \
+  static void HPHP_bench_##name(uint64_t iters)
+
+#endif // incl_HPHP_BENCHMARKS_MICRO_BENCH_H_
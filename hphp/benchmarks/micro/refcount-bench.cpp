@@ -0,0 +1,71 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/benchmarks/micro/bench.h"
+
+#include "hphp/runtime/base/array-init.h"
+#include "hphp/runtime/base/memory-manager.h"
+#include "hphp/runtime/base/req-malloc.h"
+#include "hphp/runtime/base/type-array.h"
+#include "hphp/runtime/base/type-string.h"
+#include "hphp/runtime/base/type-variant.h"
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(refcount_string_copy) {
+  String s("a counted string", 16, CopyString);
+  for (uint64_t i = 0; i < iters; i++) {
+    String copy = s;  // incref
+    bench::use(copy.size());
+  }                   // decref
+}
+
+BENCHMARK(refcount_variant_string_copy) {
+  Variant v(String("a counted string", 16, CopyString));
+  for (uint64_t i = 0; i < iters; i++) {
+    Variant copy = v;
+    bench::use(copy.getRefCount());
+  }
+}
+
+BENCHMARK(refcount_variant_array_copy) {
+  Variant v(make_packed_array(1, 2, 3, 4));
+  for (uint64_t i = 0; i < iters; i++) {
+    Variant copy = v;
+    bench::use(copy.getRefCount());
+  }
+}
+
+BENCHMARK(refcount_variant_assign_over) {
+  Variant a(String("first string value", CopyString));
+  Variant b(String("second string value", CopyString));
+  Variant dst;
+  for (uint64_t i = 0; i < iters; i++) {
+    dst = (i & 1) ? a : b;  // decref old value, incref new
+    bench::use(dst.getRefCount());
+  }
+}
+
+BENCHMARK(request_alloc_small) {
+  for (uint64_t i = 0; i < iters; i++) {
+    auto const ptr = req::malloc_noptrs(48);
+    bench::use(ptr);
+    req::free(ptr);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
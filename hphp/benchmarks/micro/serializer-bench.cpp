@@ -0,0 +1,79 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/benchmarks/micro/bench.h"
+
+#include <string>
+
+#include "hphp/runtime/base/array-init.h"
+#include "hphp/runtime/base/type-array.h"
+#include "hphp/runtime/base/type-string.h"
+#include "hphp/runtime/base/type-variant.h"
+#include "hphp/runtime/base/variable-serializer.h"
+#include "hphp/runtime/base/variable-unserializer.h"
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+Variant makeNested() {
+  Array arr = Array::Create();
+  for (int64_t i = 0; i < 16; i++) {
+    arr.set(String("k") + String(i),
+            make_packed_array(i, i * 2.5, String("value_") + String(i)));
+  }
+  return Variant(arr);
+}
+
+}
+
+BENCHMARK(serialize_php_nested) {
+  auto const v = makeNested();
+  for (uint64_t i = 0; i < iters; i++) {
+    VariableSerializer vs(VariableSerializer::Type::Serialize);
+    bench::use(vs.serialize(v, true).size());
+  }
+}
+
+BENCHMARK(serialize_json_nested) {
+  auto const v = makeNested();
+  for (uint64_t i = 0; i < iters; i++) {
+    VariableSerializer vs(VariableSerializer::Type::JSON);
+    bench::use(vs.serializeValue(v, true).size());
+  }
+}
+
+BENCHMARK(unserialize_php_nested) {
+  auto const v = makeNested();
+  VariableSerializer vs(VariableSerializer::Type::Serialize);
+  auto const ser = vs.serialize(v, true);
+  for (uint64_t i = 0; i < iters; i++) {
+    VariableUnserializer vu(ser.data(), ser.size(),
+                            VariableUnserializer::Type::Serialize);
+    bench::use(vu.unserialize().isArray());
+  }
+}
+
+BENCHMARK(serialize_php_string_1k) {
+  Variant v(String(std::string(1024, 'x')));
+  for (uint64_t i = 0; i < iters; i++) {
+    VariableSerializer vs(VariableSerializer::Type::Serialize);
+    bench::use(vs.serialize(v, true).size());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,94 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/benchmarks/micro/bench.h"
+
+#include "hphp/runtime/base/string-buffer.h"
+#include "hphp/runtime/base/string-data.h"
+#include "hphp/runtime/base/type-string.h"
+#include "hphp/util/hash.h"
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(string_concat_small) {
+  String lhs("hello, ");
+  String rhs("world");
+  for (uint64_t i = 0; i < iters; i++) {
+    String result = lhs + rhs;
+    bench::use(result.size());
+  }
+}
+
+BENCHMARK(string_concat_grow_64) {
+  String piece("0123456789abcdef");
+  for (uint64_t i = 0; i < iters; i++) {
+    String acc;
+    for (int k = 0; k < 64; k++) {
+      acc += piece;
+    }
+    bench::use(acc.size());
+  }
+}
+
+BENCHMARK(string_buffer_append_64) {
+  for (uint64_t i = 0; i < iters; i++) {
+    StringBuffer buf;
+    for (int k = 0; k < 64; k++) {
+      buf.append("0123456789abcdef", 16);
+    }
+    bench::use(buf.size());
+  }
+}
+
+BENCHMARK(string_from_int_cached) {
+  // In the precomputed range: exercises the shared int-string table.
+  for (uint64_t i = 0; i < iters; i++) {
+    String s(int64_t(i & 4095));
+    bench::use(s.size());
+  }
+}
+
+BENCHMARK(string_from_int_uncached) {
+  for (uint64_t i = 0; i < iters; i++) {
+    String s(int64_t(1000000 + i));
+    bench::use(s.size());
+  }
+}
+
+BENCHMARK(string_from_double) {
+  for (uint64_t i = 0; i < iters; i++) {
+    String s(0.5 + (i & 15));
+    bench::use(s.size());
+  }
+}
+
+BENCHMARK(string_hash_16) {
+  String s("0123456789abcdef");
+  for (uint64_t i = 0; i < iters; i++) {
+    // hash() memoizes, so hash the bytes directly each time.
+    bench::use(hash_string_i(s.data(), s.size()));
+  }
+}
+
+BENCHMARK(string_make_copy_16) {
+  for (uint64_t i = 0; i < iters; i++) {
+    String s("0123456789abcdef", 16, CopyString);
+    bench::use(s.size());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -11302,6 +11302,9 @@ void emitAllHHBC(AnalysisResultPtr&& ar) {
 
   if (!Option::UseHHBBC) {
     batchCommit(std::move(ues));
+    if (!RuntimeOption::RepoFlatPath.empty()) {
+      Repo::get().exportFlatUnits(RuntimeOption::RepoFlatPath);
+    }
     return;
   }
 
@@ -11315,6 +11318,10 @@ void emitAllHHBC(AnalysisResultPtr&& ar) {
   }();
   batchCommit(std::move(pair.first));
   commitGlobalData(std::move(pair.second));
+  if (!RuntimeOption::RepoFlatPath.empty()) {
+    Timer timer(Timer::WallTime, "exporting flat unit file");
+    Repo::get().exportFlatUnits(RuntimeOption::RepoFlatPath);
+  }
 }
 
 namespace {
@@ -17,10 +17,12 @@
 
 #include <vector>
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <type_traits>
+#include <unordered_map>
 
 #include <folly/gen/Base.h>
 #include <folly/Conv.h>
@@ -39,6 +41,9 @@
 #include "hphp/hhbbc/unit-util.h"
 #include "hphp/hhbbc/class-util.h"
 #include "hphp/hhbbc/index.h"
+#include "hphp/hhbbc/options.h"
+
+#include "hphp/util/hash.h"
 
 namespace HPHP { namespace HHBBC {
 
@@ -68,6 +73,12 @@ struct EmitUnitState {
    * require knowing these offsets.
    */
   std::vector<Offset> defClsMap;
+
+  /*
+   * Extents of function bodies already emitted, indexed by a hash of
+   * their bytecode, for body deduplication.
+   */
+  std::unordered_map<size_t,std::vector<std::pair<Offset,Offset>>> bodyOffsets;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -990,6 +1001,62 @@ void emit_finish_func(EmitUnitState& state,
   fe.ue().recordFunction(&fe);
 }
 
+/*
+ * Body deduplication.  Codegen tends to produce large numbers of
+ * structurally identical functions (accessors, memoize wrappers); when a
+ * function emits bytecode that is byte-identical to a body already in the
+ * unit, retarget its FuncEmitter at the earlier copy and drop the new one.
+ *
+ * Byte equality is sufficient: jump immediates are relative, and litstr,
+ * array, and class ids in the bytecode are unit-level, so identical bytes
+ * within one unit mean identical behavior.  All of a FuncEmitter's
+ * bytecode offsets are unit-absolute, so retargeting is a uniform shift.
+ */
+void dedup_func_body(EmitUnitState& state, UnitEmitter& ue, FuncEmitter& fe) {
+  if (!options.DedupFuncBodies) return;
+  auto const base = fe.base;
+  auto const past = fe.past;
+  auto const len  = size_t(past - base);
+  if (!len) return;
+
+  // A body that defined a class left its DefCls offset in defClsMap; that
+  // offset would go stale if this copy were dropped.
+  for (auto const off : state.defClsMap) {
+    if (off != kInvalidOffset && off >= base) return;
+  }
+
+  auto const hash = (size_t)hash_string_cs(
+    reinterpret_cast<const char*>(ue.bc()) + base, len);
+  auto& extents = state.bodyOffsets[hash];
+  for (auto const& cand : extents) {
+    if (cand.second - cand.first != past - base) continue;
+    if (std::memcmp(ue.bc() + cand.first, ue.bc() + base, len)) continue;
+
+    auto const delta = cand.first - base;
+    fe.base += delta;
+    fe.past += delta;
+    for (auto& param : fe.params) {
+      if (param.funcletOff != InvalidAbsoluteOffset) {
+        param.funcletOff += delta;
+      }
+    }
+    for (auto& eh : fe.ehtab) {
+      eh.m_base += delta;
+      eh.m_past += delta;
+      if (eh.m_handler != kInvalidOffset) eh.m_handler += delta;
+      if (eh.m_end != kInvalidOffset)     eh.m_end += delta;
+    }
+    for (auto& fpi : fe.fpitab) {
+      fpi.m_fpushOff  += delta;
+      fpi.m_fpiEndOff += delta;
+    }
+    ue.rollbackBc(base);
+    FTRACE(2, "    (body deduped against offset {})\n", cand.first);
+    return;
+  }
+  extents.emplace_back(base, past);
+}
+
 void emit_init_func(FuncEmitter& fe, const php::Func& func) {
   Id id = 0;
 
@@ -1018,6 +1085,7 @@ void emit_func(EmitUnitState& state, UnitEmitter& ue, const php::Func& func) {
   emit_init_func(*fe, func);
   auto const info = emit_bytecode(state, ue, func);
   emit_finish_func(state, func, *fe, info);
+  dedup_func_body(state, ue, *fe);
 }
 
 void emit_pseudomain(EmitUnitState& state,
@@ -1089,6 +1157,7 @@ void emit_class(EmitUnitState& state,
     pce->addMethod(fe);
     auto const info = emit_bytecode(state, ue, *m);
     emit_finish_func(state, *m, *fe, info);
+    dedup_func_body(state, ue, *fe);
   }
 
   std::vector<Type> useVars;
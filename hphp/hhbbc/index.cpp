@@ -2086,6 +2086,16 @@ void Index::mark_persistent_classes_and_functions(php::Program& program) {
   }
 }
 
+void Index::for_each_dependency(
+  const std::function<void(const Context&,
+                           borrowed_ptr<const php::Func>)>& fun) const {
+  for (auto const& kv : m_data->dependencyMap) {
+    for (auto const& dep : kv.second) {
+      fun(dep.first, kv.first);
+    }
+  }
+}
+
 const CompactVector<borrowed_ptr<const php::Class>>*
 Index::lookup_closures(borrowed_ptr<const php::Class> cls) const {
   auto const it = m_data->classClosureMap.find(cls);
@@ -16,6 +16,7 @@
 #ifndef incl_HHBBC_INDEX_H_
 #define incl_HHBBC_INDEX_H_
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <tuple>
@@ -752,6 +753,17 @@ struct Index {
    */
   void mark_persistent_classes_and_functions(php::Program& program);
 
+  /*
+   * Call `fun' for each (dependent context, depended-upon function) edge the
+   * index recorded during analysis.  Used to persist a unit-level dependency
+   * graph for incremental rebuilds.
+   *
+   * No other threads may be using the Index when this is called.
+   */
+  void for_each_dependency(
+    const std::function<void(const Context&,
+                             borrowed_ptr<const php::Func>)>& fun) const;
+
   /*
    * Return true if the resolved function is an async
    * function.
@@ -110,6 +110,9 @@ void parse_options(int argc, char** argv) {
     ("stats-file",
       po::value(&options.stats_file)->default_value(""),
       "stats file path")
+    ("dep-graph-file",
+      po::value(&options.DepGraphFile)->default_value(""),
+      "unit dependency graph path; enables incremental analysis")
     ("no-optimizations",
       po::bool_switch(&options.NoOptimizations),
       "turn off all optimizations")
@@ -166,6 +169,7 @@ void parse_options(int argc, char** argv) {
                                 po::value(&options.DisallowDynamicVarEnvFuncs))
     ("analyze-pseudomains",     po::value(&options.AnalyzePseudomains))
     ("analyze-public-statics",  po::value(&options.AnalyzePublicStatics))
+    ("dedup-func-bodies",       po::value(&options.DedupFuncBodies))
     ;
 
   po::options_description all;
@@ -268,6 +272,18 @@ void write_output(std::vector<std::unique_ptr<UnitEmitter>> ues,
   RuntimeOption::RepoEvalMode = "local";
   open_repo(output_repo);
   SCOPE_EXIT { Repo::shutdown(); };
+
+  // The symbol universe is closed in RepoAuthoritative mode; count it so
+  // the runtime can pre-size its NamedEntity table and never grow it.
+  // Names repeated across units are double-counted, so this is an upper
+  // bound, which is fine for a capacity hint.
+  uint32_t numNames = 0;
+  for (auto& ue : ues) {
+    numNames += ue->numPreClasses() +
+                ue->fevec().size() +
+                ue->typeAliases().size();
+  }
+
   batchCommit(std::move(ues));
 
   auto gd                         = Repo::GlobalData{};
@@ -289,7 +305,7 @@ void write_output(std::vector<std::unique_ptr<UnitEmitter>> ues,
   gd.HackArrCompatNotices         = RuntimeOption::EvalHackArrCompatNotices;
   gd.APCProfile                   = std::move(apcProfile);
   gd.InitialNamedEntityTableSize  =
-    RuntimeOption::EvalInitialNamedEntityTableSize;
+    std::max(RuntimeOption::EvalInitialNamedEntityTableSize, numNames);
   gd.InitialStaticStringTableSize =
     RuntimeOption::EvalInitialStaticStringTableSize;
 
@@ -267,11 +267,35 @@ struct Options {
    */
   bool ElideAutoloadInvokes = true;
 
+  /*
+   * If true, when two functions in a unit emit byte-identical bytecode,
+   * share one copy of the body between them instead of emitting both.
+   * Codegen'd accessors and memoize wrappers commonly collapse this way,
+   * shrinking both the repo and the translation cache.
+   *
+   * This is in the can-potentially-change-program-behavior section because
+   * the shared body keeps the source locations of the function it was
+   * first emitted for, so its duplicates can report that function's line
+   * numbers in backtraces and error messages.
+   */
+  bool DedupFuncBodies = true;
+
   /*
    * The filepath where to save the stats file.  If the path is empty, then we
    * save the stats file to a temporary file.
    */
   std::string stats_file;
+
+  /*
+   * The filepath of the unit-level dependency graph.  When non-empty, each
+   * build saves the dependencies the Index recorded during analysis, along
+   * with a fingerprint for every unit; if the file already holds a graph
+   * from a previous build, the iterative analysis passes only visit units
+   * whose fingerprints changed plus everything that transitively depended
+   * on them.  See whole-program.cpp for details on what this does and
+   * doesn't buy.
+   */
+  std::string DepGraphFile;
 };
 extern Options options;
 
@@ -46,6 +46,24 @@ extern size_t work_chunk;
 
 //////////////////////////////////////////////////////////////////////
 
+namespace detail {
+
+/*
+ * Guided self-scheduling: start with chunks up to work_chunk, and hand out
+ * smaller and smaller chunks as the input runs dry, so no thread gets stuck
+ * with a large grab near the end while the rest of the pool idles.  `index'
+ * may race past `size' here; callers already clamp against it.
+ */
+inline size_t next_chunk(const std::atomic<size_t>& index, size_t size) {
+  auto const taken = std::min(index.load(std::memory_order_relaxed), size);
+  auto const guided = (size - taken) / (4 * num_threads);
+  return std::max(std::min(work_chunk, guided), size_t{1});
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////
+
 /*
  * Call a function on each element of `inputs', in parallel.
  *
@@ -70,8 +88,9 @@ void for_each(const std::vector<Item>& inputs, Func func) {
         };
 
         for (;;) {
-          auto start = index.fetch_add(work_chunk);
-          auto const stop = std::min(start + work_chunk, inputs.size());
+          auto const chunk = detail::next_chunk(index, inputs.size());
+          auto start = index.fetch_add(chunk);
+          auto const stop = std::min(start + chunk, inputs.size());
           if (start >= stop) break;
           for (auto i = start; i != stop; ++i) func(inputs[i]);
         }
@@ -121,8 +140,9 @@ auto map(Items&& inputs, Func func) -> std::vector<decltype(func(inputs[0]))> {
         };
 
         for (;;) {
-          auto start = index.fetch_add(work_chunk);
-          auto const stop = std::min(start + work_chunk, inputs.size());
+          auto const chunk = detail::next_chunk(index, inputs.size());
+          auto start = index.fetch_add(chunk);
+          auto const stop = std::min(start + chunk, inputs.size());
           if (start >= stop) break;
 
           std::transform(
@@ -24,6 +24,8 @@
 #include <folly/Traits.h>
 #include <folly/Hash.h>
 
+#include <tbb/concurrent_hash_map.h>
+
 #include "hphp/runtime/base/array-init.h"
 #include "hphp/runtime/base/array-iterator.h"
 #include "hphp/runtime/base/double-to-int64.h"
@@ -1295,17 +1297,24 @@ bool Type::equivData(const Type& o) const {
   case DataTag::Cls:
     return m_data.dcls.type == o.m_data.dcls.type &&
            m_data.dcls.cls.same(o.m_data.dcls.cls);
+  // The array-like payloads are interned by the factory functions, so equal
+  // payloads usually share one allocation and the pointer test settles it.
   case DataTag::RefInner:
-    return *m_data.inner == *o.m_data.inner;
+    return m_data.inner.get() == o.m_data.inner.get() ||
+           *m_data.inner == *o.m_data.inner;
   case DataTag::ArrLikePacked:
-    return m_data.packed->elems == o.m_data.packed->elems;
+    return m_data.packed.get() == o.m_data.packed.get() ||
+           m_data.packed->elems == o.m_data.packed->elems;
   case DataTag::ArrLikePackedN:
-    return m_data.packedn->type == o.m_data.packedn->type;
+    return m_data.packedn.get() == o.m_data.packedn.get() ||
+           m_data.packedn->type == o.m_data.packedn->type;
   case DataTag::ArrLikeMap:
-    return m_data.map->map == o.m_data.map->map;
+    return m_data.map.get() == o.m_data.map.get() ||
+           m_data.map->map == o.m_data.map->map;
   case DataTag::ArrLikeMapN:
-    return m_data.mapn->key == o.m_data.mapn->key &&
-           m_data.mapn->val == o.m_data.mapn->val;
+    return m_data.mapn.get() == o.m_data.mapn.get() ||
+           (m_data.mapn->key == o.m_data.mapn->key &&
+            m_data.mapn->val == o.m_data.mapn->val);
   }
   not_reached();
 }
@@ -1692,9 +1701,101 @@ Type vec_empty()         { return Type { BSVecE }; }
 Type counted_vec_empty() { return Type { BCVecE }; }
 Type some_vec_empty()    { return Type { BVecE }; }
 
+namespace {
+
+/*
+ * Intern tables for the out-of-line array-like payloads.
+ *
+ * Analysis creates the same structured types over and over again---every
+ * visit of a function that builds an array literal recreates its type from
+ * scratch.  Interning the payloads as the factory functions build them
+ * makes equal payloads share one allocation, and lets equivData
+ * short-circuit on pointer identity before falling back to a deep
+ * comparison.
+ *
+ * Sharing is safe with respect to mutation: the only way to modify a
+ * payload through a copy_ptr is mutate(), which copies whenever the
+ * refcount is above one, and the table always holds a reference of its
+ * own.  Entries are never evicted; the tables live for the duration of the
+ * whole-program pass, which is exactly when the duplication hurts.
+ */
+template<class T>
+struct InternTable {
+  copy_ptr<T> intern(copy_ptr<T> p, size_t h) {
+    typename Map::accessor acc;
+    m_map.insert(acc, h);
+    for (auto const& entry : acc->second) {
+      if (equal(*entry, *p)) return entry;
+    }
+    acc->second.push_back(p);
+    return p;
+  }
+
+private:
+  static bool equal(const DArrLikePacked& a, const DArrLikePacked& b) {
+    return a.elems == b.elems;
+  }
+  static bool equal(const DArrLikePackedN& a, const DArrLikePackedN& b) {
+    return a.type == b.type;
+  }
+  static bool equal(const DArrLikeMap& a, const DArrLikeMap& b) {
+    return a.map == b.map;
+  }
+  static bool equal(const DArrLikeMapN& a, const DArrLikeMapN& b) {
+    return a.key == b.key && a.val == b.val;
+  }
+
+  using Map = tbb::concurrent_hash_map<size_t,std::vector<copy_ptr<T>>>;
+  Map m_map;
+};
+
+InternTable<DArrLikePacked>  s_packedTable;
+InternTable<DArrLikePackedN> s_packednTable;
+InternTable<DArrLikeMap>     s_mapTable;
+InternTable<DArrLikeMapN>    s_mapnTable;
+
+/*
+ * Type::hash() is shallow (bits and tag only), so mix in the hashes of the
+ * payload's immediate children to spread the intern buckets out.  Deeper
+ * structure only shows up as bits/tag of the children, which is fine---the
+ * buckets hold a list and fall back to a deep comparison.
+ */
+size_t payload_hash(const DArrLikePacked& p) {
+  auto h = folly::hash::hash_combine(p.elems.size());
+  for (auto const& t : p.elems) {
+    h = folly::hash::hash_combine(h, t.hash());
+  }
+  return h;
+}
+
+size_t payload_hash(const DArrLikePackedN& p) {
+  return folly::hash::hash_combine(size_t{1}, p.type.hash());
+}
+
+size_t payload_hash(const DArrLikeMap& m) {
+  auto h = folly::hash::hash_combine(m.map.size());
+  for (auto const& kv : m.map) {
+    h = folly::hash::hash_combine(
+      h,
+      static_cast<int>(kv.first.m_type),
+      static_cast<uint64_t>(kv.first.m_data.num),
+      kv.second.hash()
+    );
+  }
+  return h;
+}
+
+size_t payload_hash(const DArrLikeMapN& m) {
+  return folly::hash::hash_combine(m.key.hash(), m.val.hash());
+}
+
+}
+
 Type packedn_impl(trep bits, Type t) {
   auto r = Type { bits };
   construct_inner(r.m_data.packedn, std::move(t));
+  r.m_data.packedn = s_packednTable.intern(
+    r.m_data.packedn, payload_hash(*r.m_data.packedn));
   r.m_dataTag = DataTag::ArrLikePackedN;
   return r;
 }
@@ -1703,6 +1804,8 @@ Type packed_impl(trep bits, std::vector<Type> elems) {
   assert(!elems.empty());
   auto r = Type { bits };
   construct_inner(r.m_data.packed, std::move(elems));
+  r.m_data.packed = s_packedTable.intern(
+    r.m_data.packed, payload_hash(*r.m_data.packed));
   r.m_dataTag = DataTag::ArrLikePacked;
   return r;
 }
@@ -1934,6 +2037,8 @@ Type map_impl(trep bits, MapElems m) {
 
   auto r = Type { bits };
   construct_inner(r.m_data.map, std::move(m));
+  r.m_data.map = s_mapTable.intern(
+    r.m_data.map, payload_hash(*r.m_data.map));
   r.m_dataTag = DataTag::ArrLikeMap;
   return r;
 }
@@ -1963,6 +2068,8 @@ Type mapn_impl(trep bits, Type k, Type v) {
     std::move(k),
     std::move(v)
   );
+  r.m_data.mapn = s_mapnTable.intern(
+    r.m_data.mapn, payload_hash(*r.m_data.mapn));
   r.m_dataTag = DataTag::ArrLikeMapN;
   return r;
 }
@@ -18,11 +18,15 @@
 #include <vector>
 #include <algorithm>
 #include <atomic>
+#include <fstream>
+#include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 
 #include <folly/Memory.h>
 #include <folly/ScopeGuard.h>
+#include <folly/String.h>
 
 #include "hphp/runtime/vm/unit-emitter.h"
 
@@ -125,6 +129,46 @@ struct WorkResult {
 
 //////////////////////////////////////////////////////////////////////
 
+/*
+ * Rough cost estimates for scheduling.  The parallel phases hand work out
+ * dynamically, so their tails are bound by whichever item starts last;
+ * sorting the work largest-first keeps a giant generated unit from becoming
+ * a straggler that idles the rest of the pool at the end of a phase.
+ */
+size_t cost_of_func(const php::Func& f) {
+  auto ret = size_t{0};
+  for (auto& b : f.blocks) ret += b->hhbcs.size();
+  return ret;
+}
+
+size_t cost_of_context(const Context& ctx) {
+  return ctx.func ? cost_of_func(*ctx.func) : 0;
+}
+
+size_t cost_of_work_item(const WorkItem& wi) {
+  if (wi.type == WorkType::Func) return cost_of_context(wi.ctx);
+  auto ret = size_t{1};
+  for (auto& m : wi.ctx.cls->methods) ret += cost_of_func(*m);
+  return ret;
+}
+
+template<class T, class CostFn>
+void sort_by_cost(std::vector<T>& items, CostFn cost) {
+  std::vector<std::pair<size_t,T>> keyed;
+  keyed.reserve(items.size());
+  for (auto& item : items) keyed.emplace_back(cost(item), std::move(item));
+  std::stable_sort(
+    begin(keyed), end(keyed),
+    [] (const std::pair<size_t,T>& a, const std::pair<size_t,T>& b) {
+      return a.first > b.first;
+    }
+  );
+  items.clear();
+  for (auto& kv : keyed) items.push_back(std::move(kv.second));
+}
+
+//////////////////////////////////////////////////////////////////////
+
 // Return a Context for every function in the Program.
 std::vector<Context> all_function_contexts(const php::Program& program) {
   std::vector<Context> ret;
@@ -142,6 +186,7 @@ std::vector<Context> all_function_contexts(const php::Program& program) {
       ret.push_back(Context { borrow(u), borrow(u->pseudomain) });
     }
   }
+  sort_by_cost(ret, cost_of_context);
   return ret;
 }
 
@@ -246,7 +291,8 @@ WorkItem work_item_for(Context ctx, AnalyzeMode mode) {
  * Repeat until the work list is empty.
  */
 void analyze_iteratively(Index& index, php::Program& program,
-                         AnalyzeMode mode) {
+                         AnalyzeMode mode,
+                         const std::set<std::string>* dirtyUnits = nullptr) {
   trace_time tracer(mode == AnalyzeMode::ConstPass ?
                     "analyze constants" : "analyze iteratively");
 
@@ -263,6 +309,21 @@ void analyze_iteratively(Index& index, php::Program& program,
   };
 
   auto work = initial_work(program, mode);
+  if (dirtyUnits) {
+    // Incremental mode: seed the work list with only the dirty units.  We
+    // don't filter the revisit sets below, so clean units still get
+    // reanalyzed when a fact they depend on is refined.
+    work.erase(
+      std::remove_if(
+        begin(work), end(work),
+        [&] (const WorkItem& wi) {
+          return !dirtyUnits->count(wi.ctx.unit->filename->toCppString());
+        }
+      ),
+      end(work)
+    );
+  }
+  sort_by_cost(work, cost_of_work_item);
   while (!work.empty()) {
     auto const results = [&] {
       trace_time trace(
@@ -333,6 +394,7 @@ void analyze_iteratively(Index& index, php::Program& program,
     }
 
     work.assign(begin(revisit), end(revisit));
+    sort_by_cost(work, cost_of_work_item);
   }
 }
 
@@ -409,6 +471,173 @@ void final_pass(Index& index, php::Program& program) {
 
 //////////////////////////////////////////////////////////////////////
 
+/*
+ * Support for incremental rebuilds.
+ *
+ * When options.DepGraphFile is set, each build saves a unit-level view of
+ * the dependencies the Index recorded during analysis, along with a
+ * fingerprint (md5) for every unit.  The next build loads the previous
+ * graph, marks every unit whose fingerprint changed as dirty, propagates
+ * dirtiness to everything that transitively depended on a dirty unit, and
+ * seeds the iterative analysis passes with only the dirty set.
+ *
+ * Clean units are still parsed, run through the final pass, and emitted,
+ * but may keep their unrefined baseline facts in the Index.  Since
+ * analysis only ever refines facts monotonically, skipping refinement is
+ * always sound; a stale or missing graph costs optimization quality,
+ * never correctness.  Emitting clean units byte-identically from a cache
+ * would additionally need an output-unit cache at the repo layer, which
+ * we don't have.
+ */
+struct DepGraph {
+  // md5 by filename for every unit of the build that wrote the graph.
+  std::map<std::string,std::string> fingerprints;
+  // dependent filename -> the filenames whose facts it consumed.
+  std::map<std::string,std::set<std::string>> deps;
+};
+
+folly::Optional<DepGraph> load_dep_graph(const std::string& file) {
+  std::ifstream in(file);
+  if (!in.is_open()) return folly::none;
+
+  std::string line;
+  if (!std::getline(in, line) || line != "HHBBCDepGraph 1") {
+    return folly::none;
+  }
+
+  DepGraph ret;
+  while (std::getline(in, line)) {
+    std::vector<std::string> parts;
+    folly::split('\t', line, parts);
+    if (parts.size() == 3 && parts[0] == "unit") {
+      ret.fingerprints[parts[2]] = parts[1];
+    } else if (parts.size() == 3 && parts[0] == "dep") {
+      ret.deps[parts[1]].insert(parts[2]);
+    } else {
+      return folly::none;
+    }
+  }
+  return ret;
+}
+
+void save_dep_graph(const std::string& file, const DepGraph& graph) {
+  std::ofstream out(file);
+  if (!out.is_open()) {
+    Trace::traceRelease("failed to write dependency graph to %s\n",
+                        file.c_str());
+    return;
+  }
+  out << "HHBBCDepGraph 1\n";
+  for (auto const& kv : graph.fingerprints) {
+    out << "unit\t" << kv.second << '\t' << kv.first << '\n';
+  }
+  for (auto const& kv : graph.deps) {
+    for (auto const& provider : kv.second) {
+      out << "dep\t" << kv.first << '\t' << provider << '\n';
+    }
+  }
+}
+
+/*
+ * Units whose fingerprints changed since the previous build, plus
+ * everything that transitively consumed facts from them.
+ */
+std::set<std::string> compute_dirty_units(const php::Program& program,
+                                          const DepGraph& old) {
+  std::set<std::string> dirty;
+  for (auto& u : program.units) {
+    auto const name = u->filename->toCppString();
+    auto const it = old.fingerprints.find(name);
+    if (it == end(old.fingerprints) || it->second != u->md5.toString()) {
+      dirty.insert(name);
+    }
+  }
+
+  std::map<std::string,std::set<std::string>> rdeps;
+  for (auto const& kv : old.deps) {
+    for (auto const& provider : kv.second) {
+      rdeps[provider].insert(kv.first);
+    }
+  }
+
+  std::vector<std::string> work(begin(dirty), end(dirty));
+  while (!work.empty()) {
+    auto const cur = std::move(work.back());
+    work.pop_back();
+    auto const it = rdeps.find(cur);
+    if (it == end(rdeps)) continue;
+    for (auto const& dep : it->second) {
+      if (dirty.insert(dep).second) work.push_back(dep);
+    }
+  }
+  return dirty;
+}
+
+DepGraph collect_dep_graph(const Index& index,
+                           const php::Program& program,
+                           const DepGraph* old,
+                           const std::set<std::string>* dirty) {
+  DepGraph ret;
+  for (auto& u : program.units) {
+    ret.fingerprints[u->filename->toCppString()] = u->md5.toString();
+  }
+
+  // Function-level dependencies recorded by the Index, collapsed to units.
+  index.for_each_dependency(
+    [&] (const Context& dependent, borrowed_ptr<const php::Func> provider) {
+      if (dependent.unit == provider->unit) return;
+      ret.deps[dependent.unit->filename->toCppString()].insert(
+        provider->unit->filename->toCppString()
+      );
+    }
+  );
+
+  // The Index only tracks function dependencies, so add edges for the class
+  // hierarchy as well: a unit depends on every unit that may define one of
+  // its classes' parents, interfaces, or used traits.
+  std::unordered_map<
+    SString,
+    std::set<std::string>,
+    string_data_hash,
+    string_data_isame
+  > classDefs;
+  for (auto& u : program.units) {
+    for (auto& c : u->classes) {
+      classDefs[c->name].insert(u->filename->toCppString());
+    }
+  }
+  for (auto& u : program.units) {
+    auto const name = u->filename->toCppString();
+    auto const addEdge = [&] (SString parent) {
+      if (!parent || parent->empty()) return;
+      auto const it = classDefs.find(parent);
+      if (it == end(classDefs)) return;
+      for (auto const& def : it->second) {
+        if (def != name) ret.deps[name].insert(def);
+      }
+    };
+    for (auto& c : u->classes) {
+      addEdge(c->parentName);
+      for (auto const i : c->interfaceNames) addEdge(i);
+      for (auto const t : c->usedTraitNames) addEdge(t);
+    }
+  }
+
+  // Units we didn't analyze this build recorded no dependencies, so carry
+  // their edges forward from the previous graph; otherwise the graph would
+  // decay across consecutive incremental builds.
+  if (old && dirty) {
+    for (auto const& kv : old->deps) {
+      if (dirty->count(kv.first)) continue;
+      if (!ret.fingerprints.count(kv.first)) continue;  // unit was removed
+      ret.deps[kv.first].insert(begin(kv.second), end(kv.second));
+    }
+  }
+  return ret;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 template<class Container>
 std::unique_ptr<php::Program> parse_program(Container units) {
   trace_time tracer("parse");
@@ -460,19 +689,49 @@ whole_program(std::vector<std::unique_ptr<UnitEmitter>> ues,
   state_after("parse", *program);
 
   Index index{borrow(program)};
+
+  folly::Optional<DepGraph> prevGraph;
+  std::set<std::string> dirty;
+  const std::set<std::string>* dirtyUnits = nullptr;
+  if (!options.DepGraphFile.empty()) {
+    prevGraph = load_dep_graph(options.DepGraphFile);
+    if (prevGraph) {
+      dirty = compute_dirty_units(*program, *prevGraph);
+      dirtyUnits = &dirty;
+      if (Trace::moduleEnabledRelease(Trace::hhbbc_time, 1)) {
+        Trace::traceRelease("incremental: %lu of %lu units dirty\n",
+                            (unsigned long)dirty.size(),
+                            (unsigned long)program->units.size());
+      }
+    }
+  }
+
   if (!options.NoOptimizations) {
     assert(check(*program));
     constant_pass(index, *program);
-    analyze_iteratively(index, *program, AnalyzeMode::NormalPass);
+    analyze_iteratively(index, *program, AnalyzeMode::NormalPass, dirtyUnits);
     if (options.AnalyzePublicStatics) {
+      // Note: public statics must be collected from every function---the
+      // refined types are unions over all the writes we saw---so this pass
+      // isn't restricted to the dirty set.
       analyze_public_statics(index, *program);
-      analyze_iteratively(index, *program, AnalyzeMode::NormalPass);
+      analyze_iteratively(index, *program, AnalyzeMode::NormalPass,
+                          dirtyUnits);
     }
     final_pass(index, *program);
     index.mark_persistent_classes_and_functions(*program);
     state_after("optimize", *program);
   }
 
+  if (!options.DepGraphFile.empty()) {
+    trace_time trace("save dependency graph");
+    save_dep_graph(
+      options.DepGraphFile,
+      collect_dep_graph(index, *program,
+                        prevGraph ? &*prevGraph : nullptr, dirtyUnits)
+    );
+  }
+
   if (options.AnalyzePublicStatics) {
     mark_persistent_static_properties(index, *program);
   }
@@ -74,6 +74,10 @@ APCHandle::Pair APCHandle::Create(const Variant& source,
         auto value = new APCTypedValue(APCTypedValue::StaticStr{}, st);
         return {value->getHandle(), sizeof(APCTypedValue)};
       }
+      if (apcExtension::CompressionThreshold > 0 &&
+          s->size() >= apcExtension::CompressionThreshold) {
+        return APCString::MakeCompressedString(s);
+      }
       if (apcExtension::UseUncounted) {
         auto st = StringData::MakeUncounted(s->slice());
         auto value = new APCTypedValue(APCTypedValue::UncountedStr{}, st);
@@ -235,6 +239,8 @@ Variant APCHandle::toLocal() const {
       auto const serObj = APCString::fromHandle(this)->getStringData();
       return apc_unserialize(serObj->data(), serObj->size());
     }
+    case APCKind::CompressedString:
+      return Variant::attach(APCString::fromHandle(this)->uncompress());
     case APCKind::SharedCollection:
       return APCCollection::fromHandle(this)->createObject();
     case APCKind::SharedObject:
@@ -266,6 +272,7 @@ void APCHandle::deleteShared() {
     case APCKind::SerializedDict:
     case APCKind::SerializedKeyset:
     case APCKind::SerializedObject:
+    case APCKind::CompressedString:
       APCString::Delete(APCString::fromHandle(this));
       return;
 
@@ -346,6 +353,7 @@ bool APCHandle::checkInvariants() const {
     case APCKind::SerializedDict:
     case APCKind::SerializedKeyset:
     case APCKind::SerializedObject:
+    case APCKind::CompressedString:
       assert(m_type == kInvalidDataType);
       return true;
   }
@@ -18,6 +18,7 @@
 #define incl_HPHP_APC_HANDLE_H_
 
 #include <atomic>
+#include <limits>
 
 #include "hphp/util/atomic.h"
 #include "hphp/util/hash.h"
@@ -49,7 +50,8 @@ enum class APCKind: uint8_t {
   SharedObject, SharedCollection,
   SerializedArray, SerializedVec,
   SerializedDict, SerializedKeyset,
-  SerializedObject
+  SerializedObject,
+  CompressedString
 };
 
 /*
@@ -116,6 +118,7 @@ enum class APCKind: uint8_t {
  *  SerializedDict    APCString       kInvalidDataType
  *  SerializedKeyset  APCString       kInvalidDataType
  *  SerializedObject  APCString       kInvalidDataType
+ *  CompressedString  APCString       kInvalidDataType
  *  Collection        APCObject       kInvalidDataType
  *
  * Thread safety:
@@ -240,6 +243,22 @@ struct APCHandle {
     m_obj_attempted.store(true, std::memory_order_relaxed);
   }
 
+  /*
+   * For CompressedString handles, a saturating count of fetches. The store
+   * uses it to decide when a compressed value is hot enough to be worth
+   * caching decompressed. Relaxed increments may briefly overshoot the
+   * saturation point under contention; callers only compare the result
+   * against small thresholds, so that is harmless. Like setObjAttempted,
+   * this is an exception to the thread-safety rule documented above the
+   * class.
+   */
+  uint8_t bumpFetchCount() {
+    assert(m_kind == APCKind::CompressedString);
+    auto const c = m_fetch_count.load(std::memory_order_relaxed);
+    if (c == std::numeric_limits<uint8_t>::max()) return c;
+    return m_fetch_count.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
   /*
    * If true, this APCHandle is an APCTypedValue holding an "uncounted"
    * string or array; (not static or refcounted).
@@ -271,6 +290,7 @@ private:
   const DataType m_type;
   const APCKind m_kind;
   std::atomic<uint8_t> m_obj_attempted{false};
+  std::atomic<uint8_t> m_fetch_count{0};
   DEBUG_ONLY std::atomic<uint8_t> m_unref_root_count{0};
   mutable std::atomic<uint32_t> m_count{1};
 };
@@ -104,6 +104,7 @@ size_t getMemSize(const APCHandle* handle) {
       return getMemSize(APCArray::fromHandle(handle));
 
     case APCKind::SerializedObject:
+    case APCKind::CompressedString:
       return getMemSize(APCString::fromHandle(handle));
 
     case APCKind::SharedObject:
@@ -556,6 +557,7 @@ APCDetailedStats::counterFor(const APCHandle* handle) {
       return m_uncString;
 
     case APCKind::SharedString:
+    case APCKind::CompressedString:
       return m_apcString;
 
     case APCKind::UncountedArray:
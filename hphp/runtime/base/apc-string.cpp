@@ -15,12 +15,23 @@
 */
 #include "hphp/runtime/base/apc-string.h"
 
+#include <cstring>
+
+#include <lz4.h>
+
+#include "hphp/runtime/base/type-string.h"
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
 APCHandle::Pair
 APCString::MakeSharedString(APCKind kind, StringData* data) {
-  auto const len    = static_cast<uint32_t>(data->size());
+  return MakeSharedPayload(kind, data->data(),
+                           static_cast<uint32_t>(data->size()));
+}
+
+APCHandle::Pair
+APCString::MakeSharedPayload(APCKind kind, const char* data, uint32_t len) {
   auto const size   = len + 1 + sizeof(APCString);
   auto const mem    = std::malloc(size);
   auto apcStr       = new (mem) APCString(kind);
@@ -33,9 +44,10 @@ APCString::MakeSharedString(APCKind kind, StringData* data) {
   apcStr->m_str.m_len         = len; // don't store hash
 
   assert(apcStr == reinterpret_cast<APCString*>(chars) - 1);
-  auto const mcret = memcpy(chars, data->data(), len + 1);
+  auto const mcret = memcpy(chars, data, len);
   apcStr = reinterpret_cast<APCString*>(mcret) - 1;
   // Recalculating apcStr from mcret avoids a spill.
+  chars[len] = '\0';
 
   apcStr->m_str.preCompute();
 
@@ -47,5 +59,43 @@ APCString::MakeSharedString(APCKind kind, StringData* data) {
   return {&apcStr->m_handle, size};
 }
 
+/*
+ * Compressed payload layout: the uncompressed length, followed by the raw
+ * LZ4 block. The length prefix is what LZ4_decompress_safe needs to size
+ * its output buffer (the block format does not record it).
+ */
+APCHandle::Pair APCString::MakeCompressedString(StringData* data) {
+  auto const len   = static_cast<uint32_t>(data->size());
+  auto const bound = LZ4_compressBound(len);
+  if (bound <= 0) return MakeSharedString(data);
+  String buf(bound + sizeof(uint32_t), ReserveString);
+  auto const dst = buf.mutableData();
+  memcpy(dst, &len, sizeof(len));
+  auto const csize =
+    LZ4_compress_default(data->data(), dst + sizeof(uint32_t), len, bound);
+  // Values that don't shrink are not worth a decompression on every fetch.
+  if (csize <= 0 || csize + sizeof(uint32_t) >= len) {
+    return MakeSharedString(data);
+  }
+  return MakeSharedPayload(APCKind::CompressedString, dst,
+                           csize + sizeof(uint32_t));
+}
+
+StringData* APCString::uncompress() const {
+  assert(m_handle.kind() == APCKind::CompressedString);
+  auto const str = getStringData();
+  assert(str->size() > sizeof(uint32_t));
+  uint32_t len;
+  memcpy(&len, str->data(), sizeof(len));
+  auto const ret = StringData::Make(len);
+  auto const dsize = LZ4_decompress_safe(str->data() + sizeof(uint32_t),
+                                         ret->mutableData(),
+                                         str->size() - sizeof(uint32_t),
+                                         len);
+  always_assert(dsize == static_cast<int>(len));
+  ret->setSize(len);
+  return ret;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 }
@@ -55,6 +55,13 @@ struct APCString {
     return MakeSharedString(APCKind::SerializedObject, str.get());
   }
 
+  /*
+   * Store an LZ4-compressed copy of str, to be decompressed on each fetch.
+   * Falls back to MakeSharedString when the data does not shrink enough
+   * to pay for the per-fetch decompression.
+   */
+  static APCHandle::Pair MakeCompressedString(StringData* str);
+
   static void Delete(APCString* s) {
     s->~APCString();
     std::free(s);
@@ -67,7 +74,8 @@ struct APCString {
            handle->kind() == APCKind::SerializedVec ||
            handle->kind() == APCKind::SerializedDict ||
            handle->kind() == APCKind::SerializedKeyset ||
-           handle->kind() == APCKind::SerializedObject);
+           handle->kind() == APCKind::SerializedObject ||
+           handle->kind() == APCKind::CompressedString);
     static_assert(
       offsetof(APCString, m_handle) == 0,
       "m_handle must appear first in APCString"
@@ -82,7 +90,8 @@ struct APCString {
            handle->kind() == APCKind::SerializedVec ||
            handle->kind() == APCKind::SerializedDict ||
            handle->kind() == APCKind::SerializedKeyset ||
-           handle->kind() == APCKind::SerializedObject);
+           handle->kind() == APCKind::SerializedObject ||
+           handle->kind() == APCKind::CompressedString);
     static_assert(
       offsetof(APCString, m_handle) == 0,
       "m_handle must appear first in APCString"
@@ -102,8 +111,15 @@ struct APCString {
     return &m_str;
   }
 
+  /*
+   * Decompress a CompressedString into a fresh request-local StringData.
+   * The caller takes ownership of the reference.
+   */
+  StringData* uncompress() const;
+
 private:
   static APCHandle::Pair MakeSharedString(APCKind, StringData*);
+  static APCHandle::Pair MakeSharedPayload(APCKind, const char*, uint32_t);
   explicit APCString(APCKind kind) : m_handle(kind) {}
   ~APCString() {}
   APCString(const APCString&) = delete;
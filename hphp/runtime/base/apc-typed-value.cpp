@@ -97,6 +97,7 @@ bool APCTypedValue::checkInvariants() const {
     case APCKind::SerializedVec:
     case APCKind::SerializedDict:
     case APCKind::SerializedKeyset:
+    case APCKind::CompressedString:
       assert(false);
       break;
   }
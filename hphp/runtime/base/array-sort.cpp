@@ -17,6 +17,7 @@
 #include "hphp/runtime/base/array-init.h"
 #include "hphp/runtime/base/array-iterator.h"
 #include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/base/req-containers.h"
 #include "hphp/runtime/base/sort-helpers.h"
 #include "hphp/runtime/base/tv-mutate.h"
 #include "hphp/runtime/base/tv-variant.h"
@@ -28,6 +29,8 @@
 
 #include <folly/ScopeGuard.h>
 
+#include <limits>
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -290,6 +293,62 @@ void SetArray::Ksort(ArrayData* ad, int sort_flags, bool ascending) {
   CALL_SORT(AssocKeyAccessor<SetArray::Elm>);
 }
 
+namespace {
+
+// Below this size the comparison sort's better constants win.
+constexpr uint32_t kIntRadixSortMin = 512;
+
+/*
+ * LSD radix sort for packed arrays the preSort scan proved to be
+ * all-int.  The elements are fully described by their 64-bit payloads,
+ * so we sort extracted keys (biased so signed order matches the
+ * unsigned bucket order) and write them back, never moving whole
+ * TypedValues.  Passes whose byte is constant across the array---all
+ * of the high ones, for typical id-sized ints---are skipped.
+ */
+NEVER_INLINE
+void packedIntRadixSort(TypedValue* data, uint32_t n, bool ascending) {
+  constexpr auto kSignBias = std::numeric_limits<int64_t>::min();
+  req::vector<uint64_t> keys(n);
+  req::vector<uint64_t> scratch(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    assert(data[i].m_type == KindOfInt64);
+    keys[i] = uint64_t(data[i].m_data.num ^ kSignBias);
+  }
+
+  auto src = keys.data();
+  auto dst = scratch.data();
+  for (uint32_t shift = 0; shift < 64; shift += 8) {
+    uint32_t count[256] = {};
+    for (uint32_t i = 0; i < n; ++i) {
+      count[(src[i] >> shift) & 0xff]++;
+    }
+    if (count[(src[0] >> shift) & 0xff] == n) continue;
+    uint32_t sum = 0;
+    for (auto& c : count) {
+      auto const tmp = c;
+      c = sum;
+      sum += tmp;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      dst[count[(src[i] >> shift) & 0xff]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+
+  if (ascending) {
+    for (uint32_t i = 0; i < n; ++i) {
+      data[i].m_data.num = int64_t(src[i]) ^ kSignBias;
+    }
+  } else {
+    for (uint32_t i = 0; i < n; ++i) {
+      data[i].m_data.num = int64_t(src[n - i - 1]) ^ kSignBias;
+    }
+  }
+}
+
+}
+
 void PackedArray::Sort(ArrayData* ad, int sort_flags, bool ascending) {
   assert(checkInvariants(ad));
   if (ad->m_size <= 1) {
@@ -304,6 +363,12 @@ void PackedArray::Sort(ArrayData* ad, int sort_flags, bool ascending) {
   a->m_pos = 0;
   auto data_begin = packedData(ad);
   auto data_end = data_begin + a->m_size;
+  if (flav == IntegerSort &&
+      (sort_flags == SORT_REGULAR || sort_flags == SORT_NUMERIC) &&
+      a->m_size >= kIntRadixSortMin) {
+    packedIntRadixSort(data_begin, a->m_size, ascending);
+    return;
+  }
   CALL_SORT(TVAccessor);
 }
 
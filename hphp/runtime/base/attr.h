@@ -136,6 +136,11 @@ enum Attr {
   // <<__Memoize> caches).  Reuses the AttrBuiltin bit.
   AttrNoSerialize          = (1 << 20), //       |    X     |         //
                                         //       |          |         //
+  // Indicates that this builtin cannot raise errors, throw exceptions, or
+  // reenter the VM, so JITed calls to it need neither a catch trace nor
+  // synced VM registers.               //       |          |         //
+  AttrLeafBuiltin          = (1 << 21), //       |          |    X    //
+                                        //       |          |         //
   // Indicates that the frame should be ignored when searching for context
   // (e.g., array_map evalutates its callback in the context of the caller).
   AttrSkipFrame            = (1 << 22), //       |          |    X    //
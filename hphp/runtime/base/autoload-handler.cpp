@@ -227,6 +227,33 @@ const StaticString
   s_file("file"),
   s_line("line");
 
+template <class T>
+bool AutoloadHandler::loadFromNativeMap(const String& clsName,
+                                        NativeAutoloadMap::Kind kind,
+                                        bool toLower,
+                                        const T &checkExists) {
+  auto const map = NativeAutoloadMap::get();
+  if (!map) return false;
+  const String& name = normalizeNS(clsName);
+  String canonicalName = toLower ? HHVM_FN(strtolower)(name) : name;
+  auto const path = map->lookup(kind, canonicalName.slice());
+  if (path.empty()) return false;
+  String fName{path.data(), path.size(), CopyString};
+  VMRegAnchor _;
+  bool initial;
+  auto const ec = g_context.getNoCheck();
+  auto const unit = lookupUnit(fName.get(), "", &initial);
+  if (!unit) return false;
+  if (initial) {
+    tvDecRefGen(
+      ec->invokeFunc(unit->getMain(nullptr), init_null_variant,
+                     nullptr, nullptr, nullptr, nullptr,
+                     ExecutionContext::InvokePseudoMain)
+    );
+  }
+  return checkExists();
+}
+
 template <class T>
 AutoloadHandler::Result
 AutoloadHandler::loadFromMapImpl(const String& clsName,
@@ -328,6 +355,10 @@ AutoloadHandler::invokeFailureCallback(const Variant& func, const String& kind,
 }
 
 bool AutoloadHandler::autoloadFunc(StringData* name) {
+  if (loadFromNativeMap(String{name}, NativeAutoloadMap::Kind::Function,
+                        true, FuncExistsChecker(name))) {
+    return true;
+  }
   return !m_map.isNull() &&
     loadFromMap(String{name},
                 s_function,
@@ -336,6 +367,10 @@ bool AutoloadHandler::autoloadFunc(StringData* name) {
 }
 
 bool AutoloadHandler::autoloadConstant(StringData* name) {
+  if (loadFromNativeMap(String{name}, NativeAutoloadMap::Kind::Constant,
+                        false, ConstExistsChecker(name))) {
+    return true;
+  }
   return !m_map.isNull() &&
     loadFromMap(String{name},
                 s_constant,
@@ -344,6 +379,10 @@ bool AutoloadHandler::autoloadConstant(StringData* name) {
 }
 
 bool AutoloadHandler::autoloadType(const String& name) {
+  if (loadFromNativeMap(name, NativeAutoloadMap::Kind::Type,
+                        true, TypeExistsChecker(name))) {
+    return true;
+  }
   return !m_map.isNull() &&
     loadFromMap(name, s_type, true, TypeExistsChecker(name)) != Failure;
 }
@@ -375,6 +414,10 @@ bool AutoloadHandler::autoloadClass(const String& clsName,
   if (!is_valid_class_name(className.slice())) {
     return false;
   }
+  if (loadFromNativeMap(className, NativeAutoloadMap::Kind::Class,
+                        true, ClassExistsChecker(className))) {
+    return true;
+  }
   if (!m_map.isNull()) {
     ClassExistsChecker ce(className);
     Result res = loadFromMap(className, s_class, true, ce);
@@ -477,6 +520,15 @@ AutoloadHandler::loadFromMapPartial(const String& className,
 bool AutoloadHandler::autoloadClassOrType(const String& clsName) {
   if (clsName.empty()) return false;
   const String& className = normalizeNS(clsName);
+  {
+    ClassOrTypeExistsChecker cte(className);
+    if (loadFromNativeMap(className, NativeAutoloadMap::Kind::Class,
+                          true, cte) ||
+        loadFromNativeMap(className, NativeAutoloadMap::Kind::Type,
+                          true, cte)) {
+      return true;
+    }
+  }
   if (!m_map.isNull()) {
     ClassOrTypeExistsChecker cte(className);
     bool tryClass = true, tryType = true;
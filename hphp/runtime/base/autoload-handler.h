@@ -18,6 +18,7 @@
 
 #include <utility>
 
+#include "hphp/runtime/base/autoload-native-map.h"
 #include "hphp/runtime/base/req-containers.h"
 #include "hphp/runtime/base/request-event-handler.h"
 #include "hphp/runtime/base/type-variant.h"
@@ -98,6 +99,17 @@ public:
   DECLARE_STATIC_REQUEST_LOCAL(AutoloadHandler, s_instance);
 
 private:
+  /**
+   * Try the process-wide native map (Autoload.NativeMapPath) before any
+   * per-request map or PHP callback. On a hit, includes the mapped file and
+   * returns true if the symbol then exists; on a miss returns false so the
+   * caller falls through to the PHP machinery. There is no failure callback
+   * on this path, so exceptions from the included file propagate.
+   */
+  template <class T>
+  bool loadFromNativeMap(const String& name, NativeAutoloadMap::Kind kind,
+                         bool toLower, const T &checkExists);
+
   /**
    * This method may return Success or Failure.
    */
@@ -0,0 +1,253 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/runtime/base/autoload-native-map.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <folly/String.h>
+
+#include "hphp/runtime/base/init-fini-node.h"
+#include "hphp/runtime/base/runtime-option.h"
+#include "hphp/util/logger.h"
+#include "hphp/util/safe-cast.h"
+
+namespace HPHP {
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+NativeAutoloadMap* s_map{nullptr};
+
+// FNV-1a over the symbol, seeded with the kind so the four symbol spaces
+// can share one bucket array without colliding on equal names.
+uint64_t hashSymbol(NativeAutoloadMap::Kind kind, folly::StringPiece symbol) {
+  uint64_t h = 0xcbf29ce484222325ULL ^ (uint64_t(kind) + 1);
+  for (auto const c : symbol) {
+    h ^= uint8_t(c);
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+bool parseKind(folly::StringPiece s, NativeAutoloadMap::Kind& kind) {
+  if (s == "class")    { kind = NativeAutoloadMap::Kind::Class;    return true; }
+  if (s == "function") { kind = NativeAutoloadMap::Kind::Function; return true; }
+  if (s == "constant") { kind = NativeAutoloadMap::Kind::Constant; return true; }
+  if (s == "type")     { kind = NativeAutoloadMap::Kind::Type;     return true; }
+  return false;
+}
+
+bool caseInsensitiveKind(NativeAutoloadMap::Kind kind) {
+  return kind != NativeAutoloadMap::Kind::Constant;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool NativeAutoloadMap::load(const std::string& path) {
+  auto const fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Logger::Error("NativeAutoloadMap: cannot open %s: %s",
+                  path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+  SCOPE_EXIT { ::close(fd); };
+  struct stat sb;
+  if (::fstat(fd, &sb) != 0) {
+    Logger::Error("NativeAutoloadMap: cannot stat %s: %s",
+                  path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+  auto const size = size_t(sb.st_size);
+  if (size < sizeof(Header)) {
+    Logger::Error("NativeAutoloadMap: %s is too small to hold a header",
+                  path.c_str());
+    return false;
+  }
+  auto const base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    Logger::Error("NativeAutoloadMap: cannot mmap %s: %s",
+                  path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+  auto const header = static_cast<const Header*>(base);
+  auto const bucketBytes = header->buckets * sizeof(Bucket);
+  if (header->magic != kMagic ||
+      header->buckets == 0 ||
+      (header->buckets & (header->buckets - 1)) != 0 ||
+      size != sizeof(Header) + bucketBytes + header->poolSize ||
+      header->poolSize == 0) {
+    Logger::Error("NativeAutoloadMap: %s has a corrupt or incompatible header",
+                  path.c_str());
+    ::munmap(base, size);
+    return false;
+  }
+  auto const pool =
+    static_cast<const char*>(base) + sizeof(Header) + bucketBytes;
+  if (pool[header->poolSize - 1] != '\0') {
+    Logger::Error("NativeAutoloadMap: %s has an unterminated string pool",
+                  path.c_str());
+    ::munmap(base, size);
+    return false;
+  }
+  // The mapping and the singleton stay alive for the process; load() runs
+  // once from the ProcessInit hook before any worker thread exists.
+  auto map = new NativeAutoloadMap();
+  map->m_header = header;
+  map->m_buckets = reinterpret_cast<const Bucket*>(
+    static_cast<const char*>(base) + sizeof(Header)
+  );
+  map->m_pool = pool;
+  s_map = map;
+  Logger::Info("NativeAutoloadMap: loaded %lu symbols from %s",
+               (unsigned long)header->entries, path.c_str());
+  return true;
+}
+
+const NativeAutoloadMap* NativeAutoloadMap::get() {
+  return s_map;
+}
+
+folly::StringPiece NativeAutoloadMap::lookup(Kind kind,
+                                             folly::StringPiece symbol) const {
+  auto const h = hashSymbol(kind, symbol);
+  auto const mask = m_header->buckets - 1;
+  for (auto i = h & mask; ; i = (i + 1) & mask) {
+    auto const& b = m_buckets[i];
+    if (b.sym == kEmptyBucket) return folly::StringPiece{};
+    if (b.hash == h) {
+      auto const sym = m_pool + b.sym;
+      if (symbol.size() == strlen(sym) &&
+          memcmp(symbol.data(), sym, symbol.size()) == 0) {
+        return folly::StringPiece{m_pool + b.path};
+      }
+    }
+  }
+}
+
+bool NativeAutoloadMap::build(const std::string& input,
+                              const std::string& output) {
+  std::ifstream in(input);
+  if (!in.is_open()) {
+    Logger::Error("NativeAutoloadMap: cannot read %s", input.c_str());
+    return false;
+  }
+
+  struct Entry {
+    uint64_t hash;
+    std::string symbol;
+    std::string path;
+  };
+  std::vector<Entry> entries;
+  std::string pool;
+  pool.push_back('\0'); // offset 0 stays unused so it can't alias kEmptyBucket
+
+  std::string line;
+  size_t lineno = 0;
+  while (std::getline(in, line)) {
+    ++lineno;
+    if (line.empty() || line[0] == '#') continue;
+    std::vector<folly::StringPiece> fields;
+    folly::split('\t', line, fields);
+    Kind kind;
+    if (fields.size() != 3 || !parseKind(fields[0], kind) ||
+        fields[1].empty() || fields[2].empty()) {
+      Logger::Error("NativeAutoloadMap: %s:%lu: "
+                    "expected kind<TAB>symbol<TAB>path",
+                    input.c_str(), (unsigned long)lineno);
+      return false;
+    }
+    std::string symbol = fields[1].str();
+    if (caseInsensitiveKind(kind)) {
+      std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                     [](unsigned char c) { return std::tolower(c); });
+    }
+    entries.push_back({hashSymbol(kind, symbol),
+                       std::move(symbol), fields[2].str()});
+  }
+
+  auto buckets = size_t{8};
+  while (buckets < entries.size() * 2) buckets <<= 1;
+  std::vector<Bucket> table(buckets, Bucket{0, kEmptyBucket, 0});
+  auto const mask = buckets - 1;
+
+  auto intern = [&](const std::string& s) {
+    auto const off = safe_cast<uint32_t>(pool.size());
+    pool.append(s.data(), s.size());
+    pool.push_back('\0');
+    return off;
+  };
+
+  for (auto const& e : entries) {
+    auto i = e.hash & mask;
+    for (; table[i].sym != kEmptyBucket; i = (i + 1) & mask) {
+      if (table[i].hash == e.hash &&
+          e.symbol == pool.c_str() + table[i].sym) {
+        Logger::Error("NativeAutoloadMap: duplicate symbol %s",
+                      e.symbol.c_str());
+        return false;
+      }
+    }
+    table[i] = Bucket{e.hash, intern(e.symbol), intern(e.path)};
+  }
+
+  Header header{kMagic, buckets, entries.size(), pool.size()};
+  std::ofstream out(output, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    Logger::Error("NativeAutoloadMap: cannot write %s", output.c_str());
+    return false;
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(table.data()),
+            table.size() * sizeof(Bucket));
+  out.write(pool.data(), pool.size());
+  out.close();
+  if (out.fail()) {
+    Logger::Error("NativeAutoloadMap: error writing %s", output.c_str());
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+InitFiniNode s_nativeAutoloadMapLoad(
+  [] {
+    if (!RuntimeOption::AutoloadNativeMapPath.empty()) {
+      NativeAutoloadMap::load(RuntimeOption::AutoloadNativeMapPath);
+    }
+  },
+  InitFiniNode::When::ProcessInit
+);
+
+}
+
+//////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,96 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#ifndef incl_HPHP_AUTOLOAD_NATIVE_MAP_H_
+#define incl_HPHP_AUTOLOAD_NATIVE_MAP_H_
+
+#include <cstdint>
+#include <string>
+
+#include <folly/Range.h>
+
+namespace HPHP {
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * A process-wide, immutable symbol->path autoload table.
+ *
+ * The table is generated offline by build() and mmap'd read-only at
+ * process init (Autoload.NativeMapPath), so every worker thread -- and
+ * every hhvm process mapping the same file -- shares one copy of the
+ * pages. A lookup is one hash, a short probe run over an open-addressed
+ * bucket array sized to twice the entry count, and a final key compare;
+ * no PHP code runs and nothing is allocated on the request heap, so
+ * symbol misses during warmup resolve without entering the VM's autoload
+ * callbacks.
+ */
+struct NativeAutoloadMap {
+  enum class Kind : uint8_t { Class, Function, Constant, Type };
+
+  /*
+   * Map the table at `path' into the process. Returns false and logs on
+   * any failure; the process then falls back to the PHP autoload maps.
+   * Call once, before worker threads start.
+   */
+  static bool load(const std::string& path);
+
+  /*
+   * The table loaded by load(), or nullptr if none was loaded.
+   */
+  static const NativeAutoloadMap* get();
+
+  /*
+   * Generate `output' from the text listing at `input': one
+   * "kind<TAB>symbol<TAB>path" entry per line, where kind is one of
+   * class, function, constant or type. Symbols of case-insensitive kinds
+   * are canonicalized to lowercase by the builder. Returns false and
+   * logs on malformed input or I/O errors.
+   */
+  static bool build(const std::string& input, const std::string& output);
+
+  /*
+   * Return the path for `symbol', or an empty piece on miss. The symbol
+   * must already be normalized the way AutoloadHandler normalizes keys
+   * for its map arrays: leading namespace separator trimmed, lowercased
+   * for case-insensitive kinds.
+   */
+  folly::StringPiece lookup(Kind kind, folly::StringPiece symbol) const;
+
+private:
+  struct Header {
+    uint64_t magic;
+    uint64_t buckets;  // power of two, 2x entry count
+    uint64_t entries;
+    uint64_t poolSize; // string pool bytes following the bucket array
+  };
+  struct Bucket {
+    uint64_t hash;     // full hash with the kind mixed in
+    uint32_t sym;      // pool offset of the NUL-terminated symbol
+    uint32_t path;     // pool offset of the NUL-terminated path
+  };
+  static constexpr uint64_t kMagic = 0x314d4c4f54554148ULL; // "HAUTOLM1"
+  static constexpr uint32_t kEmptyBucket = 0xffffffffu;
+
+  const Header* m_header{nullptr};
+  const Bucket* m_buckets{nullptr};
+  const char* m_pool{nullptr};
+};
+
+//////////////////////////////////////////////////////////////////////
+
+}
+
+#endif
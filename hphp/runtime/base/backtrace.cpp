@@ -429,16 +429,32 @@ void addBacktraceToStructLog(const Array& bt, StructuredLogEntry& cols) {
 }
 
 template<class L>
-static void walkStack(L func) {
+static void walkStack(L func, c_WaitableWaitHandle* wh = nullptr,
+                      bool skipTop = false) {
   VMRegAnchor _;
   folly::small_vector<c_WaitableWaitHandle*, 64> visitedWHs;
-  ActRec* fp = vmfp();
+  Offset prevPc = 0;
+  auto fp = wh
+    ? getActRecFromWaitHandleWrapper(wh, &prevPc, visitedWHs)
+    : vmfp();
 
   // If there are no VM frames, we're done.
   if (!fp || !rds::header()) return;
 
+  // Skip the top frame, along with any immediately following inlined frames;
+  // it belongs to whoever asked for the walk, not to the sample.
+  if (skipTop) {
+    fp = getPrevActRec(fp, &prevPc, visitedWHs);
+    if (RuntimeOption::EvalJit) {
+      while (fp && (jit::TCA)fp->m_savedRip == jit::tc::ustubs().retInlHelper) {
+        fp = getPrevActRec(fp, &prevPc, visitedWHs);
+      }
+    }
+    // We skipped over the only VM frame, we're done.
+    if (!fp) return;
+  }
+
   // Handle the subsequent VM frames.
-  Offset prevPc = 0;
   for (; fp != nullptr; fp = getPrevActRec(fp, &prevPc, visitedWHs)) {
 
     // Do not capture frame for HPHP only functions.
@@ -484,6 +500,14 @@ req::ptr<CompactTrace> createCompactBacktrace() {
   return ret;
 }
 
+req::ptr<CompactTrace> createCompactBacktrace(c_WaitableWaitHandle* wh,
+                                              bool skipTop) {
+  auto ret = req::make<CompactTrace>();
+  walkStack([&] (ActRec* fp, Offset prevPc) { ret->insert(fp, prevPc); },
+            wh, skipTop);
+  return ret;
+}
+
 namespace {
 
 struct CTKHasher final {
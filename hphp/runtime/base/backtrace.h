@@ -221,6 +221,15 @@ void addBacktraceToStructLog(const Array& bt, StructuredLogEntry& cols);
 int64_t createBacktraceHash();
 req::ptr<CompactTrace> createCompactBacktrace();
 
+/*
+ * Walk the stack into a CompactTrace, optionally starting from a wait handle
+ * instead of the current frame, and optionally skipping the top frame (plus
+ * any immediately following inlined frames). Used by samplers that want to
+ * record raw (Func*, offset) pairs cheaply and symbolize later via extract().
+ */
+req::ptr<CompactTrace> createCompactBacktrace(c_WaitableWaitHandle* wh,
+                                              bool skipTop);
+
 } // HPHP
 
 #endif // incl_HPHP_BACKTRACE_H_
@@ -47,6 +47,28 @@ ObjectData* allocFromArray##type(ArrayData* arr) { \
 COLLECTIONS_PAIRED_TYPES(X)
 #undef X
 
+ObjectData* alloc(CollectionType ctype) {
+  switch (ctype) {
+#define X(type) \
+    case CollectionType::type: return req::make<c_##type>().detach();
+COLLECTIONS_PAIRED_TYPES(X)
+#undef X
+    case CollectionType::Pair: not_reached();
+  }
+  not_reached();
+}
+
+ObjectData* alloc(CollectionType ctype, ArrayData* arr) {
+  switch (ctype) {
+#define X(type) \
+    case CollectionType::type: return req::make<c_##type>(arr).detach();
+COLLECTIONS_PAIRED_TYPES(X)
+#undef X
+    case CollectionType::Pair: not_reached();
+  }
+  not_reached();
+}
+
 newFromArrayFunc allocFromArrayFunc(CollectionType ctype) {
   switch (ctype) {
 #define X(type) case CollectionType::type: return allocFromArray##type;
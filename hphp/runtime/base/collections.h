@@ -64,20 +64,22 @@ newFromArrayFunc allocFromArrayFunc(CollectionType ctype);
 
 /*
  * Create a new empty collection, with refcount set to 1.
+ *
+ * Dispatches on the type directly rather than through the function
+ * pointers above, saving an indirect call on the interpreter path; the
+ * JIT still burns the per-type initializer into the TC.
  */
-inline ObjectData* alloc(CollectionType ctype) {
-  return allocEmptyFunc(ctype)();
-}
+ObjectData* alloc(CollectionType ctype);
 
 /*
  * Create a collection from an array, with refcount set to 1.
  *
  * Pre: The array must have a kind that's compatible with the collection type
- * we're creating.
+ * we're creating.  For Imm* literals the array is the unit's static array,
+ * which is attached without copying; only the object header is allocated
+ * per execution.
  */
-inline ObjectData* alloc(CollectionType ctype, ArrayData* arr) {
-  return allocFromArrayFunc(ctype)(arr);
-}
+ObjectData* alloc(CollectionType ctype, ArrayData* arr);
 
 /*
  * Creates a Pair. Takes ownership of the TypedValues passed in.
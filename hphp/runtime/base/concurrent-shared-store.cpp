@@ -16,22 +16,28 @@
 
 #include "hphp/runtime/base/concurrent-shared-store.h"
 
+#include <algorithm>
 #include <mutex>
 #include <set>
 #include <string>
 #include <vector>
 #include <folly/Format.h>
 
+#include "hphp/util/async-job.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/timer.h"
 #include "hphp/util/trace.h"
 
+#include "hphp/runtime/base/array-init.h"
+#include "hphp/runtime/base/array-iterator.h"
 #include "hphp/runtime/base/variable-serializer.h"
 #include "hphp/runtime/base/variable-unserializer.h"
 #include "hphp/runtime/base/apc-handle-defs.h"
 #include "hphp/runtime/base/apc-object.h"
+#include "hphp/runtime/base/apc-string.h"
 #include "hphp/runtime/base/apc-stats.h"
 #include "hphp/runtime/base/apc-file-storage.h"
+#include "hphp/runtime/base/zend-string.h"
 #include "hphp/runtime/ext/apc/ext_apc.h"
 #include "hphp/runtime/ext/apc/snapshot.h"
 #include "hphp/runtime/vm/treadmill.h"
@@ -59,6 +65,23 @@ bool check_noTTL(const char* key, size_t keyLen) {
   return false;
 }
 
+/*
+ * Request replay capture (see beginReadCapture).  Values are serialized
+ * and uuencoded at read time, inside the request, since the recorded
+ * bundle is finalized after request memory may already be gone.
+ */
+__thread std::vector<std::pair<std::string,std::string>>* tl_readCapture;
+
+void recordCapturedRead(const String& key, const Variant& value) {
+  try {
+    auto const ser = apc_serialize(value);
+    auto const enc = string_uuencode(ser.data(), ser.size());
+    tl_readCapture->emplace_back(key.toCppString(), enc.toCppString());
+  } catch (...) {
+    // Values that can't be serialized just aren't captured.
+  }
+}
+
 #ifdef HPHP_TRACE
 std::string show(const StoreValue& sval) {
   return sval.data().left() ?
@@ -104,6 +127,7 @@ EntryInfo::Type EntryInfo::getAPCType(const APCHandle* handle) {
     case APCKind::UncountedString:
       return EntryInfo::Type::UncountedString;
     case APCKind::SharedString:
+    case APCKind::CompressedString:
       return EntryInfo::Type::APCString;
     case APCKind::UncountedArray:
       return EntryInfo::Type::UncountedArray;
@@ -401,6 +425,7 @@ bool ConcurrentTableSharedStore::clear() {
     free(const_cast<void*>(vpKey));
   }
   m_vars.clear();
+  bumpVersion();
   return true;
 }
 
@@ -483,9 +508,26 @@ bool ConcurrentTableSharedStore::eraseImpl(const char* key,
     }
   }
   free(const_cast<void*>(vpkey));
+  bumpVersion();
   return true;
 }
 
+// Lower 'earliest' to 'value' unless it already holds something smaller.
+void ConcurrentTableSharedStore::updateEarliest(std::atomic<time_t>& earliest,
+                                                time_t value) {
+  auto cur = earliest.load(std::memory_order_relaxed);
+  while (value < cur &&
+         !earliest.compare_exchange_weak(cur, value,
+                                         std::memory_order_relaxed)) {
+  }
+}
+
+void ConcurrentTableSharedStore::pushExpiration(intptr_t key, time_t expiry) {
+  auto& shard = expShard(key);
+  shard.queue.push({ key, expiry });
+  updateEarliest(shard.earliest, expiry);
+}
+
 // Should be called outside m_lock
 void ConcurrentTableSharedStore::purgeExpired() {
   if (m_purgeCounter.fetch_add(1, std::memory_order_relaxed) %
@@ -497,26 +539,43 @@ void ConcurrentTableSharedStore::purgeExpired() {
       HPHP::Treadmill::getOldestStartTime() : 0;
   ExpirationPair tmp;
   int i = 0;
-  while (apcExtension::PurgeRate < 0 || i < apcExtension::PurgeRate) {
-    if (!m_expQueue.try_pop(tmp)) {
-      break;
+  for (auto& shard : m_expShards) {
+    // Nothing in this shard has expired yet; skip it without touching
+    // the queue.
+    if (now < shard.earliest.load(std::memory_order_relaxed)) continue;
+    // Reset the hint before draining; concurrent pushes and the re-push
+    // of the first unexpired entry below lower it again.
+    shard.earliest.store(std::numeric_limits<time_t>::max(),
+                         std::memory_order_relaxed);
+    while (apcExtension::PurgeRate < 0 || i < apcExtension::PurgeRate) {
+      if (!shard.queue.try_pop(tmp)) {
+        break;
+      }
+      if (tmp.second > now) {
+        shard.queue.push(tmp);
+        updateEarliest(shard.earliest, tmp.second);
+        break;
+      }
+      if (UNLIKELY(tmp.first ==
+                   intptr_t(apcExtension::FileStorageFlagKey.c_str()))) {
+        adviseOut();
+        tmp.second = time(nullptr) + apcExtension::FileStorageAdviseOutPeriod;
+        shard.queue.push(tmp);
+        updateEarliest(shard.earliest, tmp.second);
+        continue;
+      }
+      ExpMap::accessor acc;
+      if (m_expMap.find(acc, tmp.first)) {
+        eraseImpl((char*)tmp.first, true, oldestLive, &acc);
+      }
+      ++i;
     }
-    if (tmp.second > now) {
-      m_expQueue.push(tmp);
+    if (apcExtension::PurgeRate >= 0 && i >= apcExtension::PurgeRate) {
+      // Out of budget with this shard possibly still holding expired
+      // entries; make sure the next purge rescans it.
+      updateEarliest(shard.earliest, now);
       break;
     }
-    if (UNLIKELY(tmp.first ==
-                 intptr_t(apcExtension::FileStorageFlagKey.c_str()))) {
-      adviseOut();
-      tmp.second = time(nullptr) + apcExtension::FileStorageAdviseOutPeriod;
-      m_expQueue.push(tmp);
-      continue;
-    }
-    ExpMap::accessor acc;
-    if (m_expMap.find(acc, tmp.first)) {
-      eraseImpl((char*)tmp.first, true, oldestLive, &acc);
-    }
-    ++i;
   }
   FTRACE(1, "Expired {} entries", i);
 }
@@ -554,6 +613,49 @@ bool ConcurrentTableSharedStore::handlePromoteObj(const String& key,
   return false;
 }
 
+/*
+ * Analogous to handlePromoteObj: swap a hot CompressedString for the plain
+ * representation its value would normally get, trading the compression
+ * savings back for fetches that no longer decompress.
+ */
+bool ConcurrentTableSharedStore::handlePromoteCompressed(const String& key,
+                                                         APCHandle* svar,
+                                                         const Variant& value) {
+  assert(value.isString());
+  auto const pair = [&] {
+    auto const s = value.getStringData();
+    if (apcExtension::UseUncounted) {
+      auto const st = StringData::MakeUncounted(s->slice());
+      auto const v = new APCTypedValue(APCTypedValue::UncountedStr{}, st);
+      return APCHandle::Pair{v->getHandle(),
+                             st->size() + sizeof(APCTypedValue)};
+    }
+    return APCString::MakeSharedString(s);
+  }();
+  auto const converted = pair.handle;
+  auto const size = pair.size;
+
+  Map::accessor acc;
+  if (!m_vars.find(acc, tagStringData(key.get()))) {
+    converted->unreferenceRoot(size);
+    return false;
+  }
+
+  auto& sval = acc->second;
+  auto const handle = sval.data().left();
+  if (handle == svar && handle->kind() == APCKind::CompressedString) {
+    sval.setHandle(converted);
+    APCStats::getAPCStats().updateAPCValue(
+      converted, size, handle, sval.dataSize, sval.expire == 0, false);
+    handle->unreferenceRoot(sval.dataSize);
+    sval.dataSize = size;
+    return true;
+  }
+
+  converted->unreferenceRoot(size);
+  return false;
+}
+
 APCHandle* ConcurrentTableSharedStore::unserialize(const String& key,
                                                    StoreValue* sval) {
   auto const sAddr = sval->data().right();
@@ -592,84 +694,168 @@ APCHandle* ConcurrentTableSharedStore::unserialize(const String& key,
   }
 }
 
+void ConcurrentTableSharedStore::beginReadCapture() {
+  if (!tl_readCapture) {
+    tl_readCapture = new std::vector<std::pair<std::string,std::string>>();
+  } else {
+    tl_readCapture->clear();
+  }
+}
+
+std::vector<std::pair<std::string,std::string>>
+ConcurrentTableSharedStore::takeReadCapture() {
+  std::vector<std::pair<std::string,std::string>> ret;
+  if (tl_readCapture) {
+    ret.swap(*tl_readCapture);
+    delete tl_readCapture;
+    tl_readCapture = nullptr;
+  }
+  return ret;
+}
+
 bool ConcurrentTableSharedStore::get(const String& keyStr, Variant& value) {
   FTRACE(3, "Get {}\n", keyStr.get()->data());
-  HotCache::Idx hotIdx;
-  if (s_hotCache.get(keyStr.get(), value, hotIdx)) return true;
-  const StoreValue *sval;
-  APCHandle *svar = nullptr;
-  SharedMutex::ReadHolder l(m_lock);
-  bool expired = false;
-  bool promoteObj = false;
-  auto tag = tagStringData(keyStr.get());
+  GetAction action;
   {
-    Map::const_accessor acc;
-    if (!m_vars.find(acc, tag)) {
-      return false;
-    }
-    sval = &acc->second;
-    if (sval->expired()) {
-      // Because it only has a read lock on the data, deletion from
-      // expiration has to happen after the lock is released
-      expired = true;
+    SharedMutex::ReadHolder l(m_lock);
+    action = getUnderLock(keyStr, value);
+  }
+  auto const found = finishGet(keyStr, value, action);
+  if (UNLIKELY(tl_readCapture != nullptr) && found) {
+    recordCapturedRead(keyStr, value);
+  }
+  return found;
+}
+
+// Single-key lookup core; the caller must hold m_lock. Work that can
+// only run once the lock is released (expired-key erasure, object
+// promotion) is described in the returned GetAction and must be applied
+// with finishGet.
+ConcurrentTableSharedStore::GetAction
+ConcurrentTableSharedStore::getUnderLock(const String& keyStr,
+                                         Variant& value) {
+  GetAction action;
+  HotCache::Idx hotIdx;
+  if (s_hotCache.get(keyStr.get(), value, hotIdx)) {
+    action.found = true;
+    return action;
+  }
+  Map::const_accessor acc;
+  if (!m_vars.find(acc, tagStringData(keyStr.get()))) {
+    return action;
+  }
+  auto const sval = &acc->second;
+  if (sval->expired()) {
+    // Because it only has a read lock on the data, deletion from
+    // expiration has to happen after the lock is released
+    action.expired = true;
+    return action;
+  }
+  APCHandle* svar;
+  if (auto const handle = sval->data().left()) {
+    svar = handle;
+  } else {
+    std::lock_guard<SmallLock> sval_lock(sval->lock);
+
+    if (auto const handle = sval->data().left()) {
+      svar = handle;
     } else {
-      if (auto const handle = sval->data().left()) {
-        svar = handle;
-      } else {
-        std::lock_guard<SmallLock> sval_lock(sval->lock);
-
-        if (auto const handle = sval->data().left()) {
-          svar = handle;
-        } else {
-          /*
-           * Note that unserialize can run arbitrary php code via a __wakeup
-           * routine, which could try to access this same key, and we're
-           * holding various locks here.  This is only for promoting primed
-           * values to in-memory values, so it's basically not a real
-           * problem, but ... :)
-           */
-          svar = unserialize(keyStr, const_cast<StoreValue*>(sval));
-          if (!svar) return false;
-        }
-      }
-      assert(sval->data().left() == svar);
-      APCKind kind = sval->getKind();
-      if (apcExtension::AllowObj &&
-          (kind == APCKind::SerializedObject ||
-           kind == APCKind::SharedObject ||
-           kind == APCKind::SharedCollection) &&
-          !svar->objAttempted()) {
-        // Hold ref here for later promoting the object
-        svar->referenceNonRoot();
-        promoteObj = true;
-      }
-      value = sval->toLocal();
-      if (!promoteObj) {
-        /*
-         * Successful slow-case lookup => add value to cache (if key and kind
-         * are eligible and there is still room for it). Another thread may be
-         * updating the same key concurrently, but ConcurrentTableSharedStore's
-         * per-entry lock ensures it will agree on the value.
-         */
-        s_hotCache.store(hotIdx, keyStr.get(), svar, sval);
-      }
+      /*
+       * Note that unserialize can run arbitrary php code via a __wakeup
+       * routine, which could try to access this same key, and we're
+       * holding various locks here.  This is only for promoting primed
+       * values to in-memory values, so it's basically not a real
+       * problem, but ... :)
+       */
+      svar = unserialize(keyStr, const_cast<StoreValue*>(sval));
+      if (!svar) return action;
     }
   }
-  if (expired) {
-    eraseImpl(tag, true,
+  assert(sval->data().left() == svar);
+  APCKind kind = sval->getKind();
+  if (apcExtension::AllowObj &&
+      (kind == APCKind::SerializedObject ||
+       kind == APCKind::SharedObject ||
+       kind == APCKind::SharedCollection) &&
+      !svar->objAttempted()) {
+    // Hold ref here for later promoting the object
+    svar->referenceNonRoot();
+    action.promote = svar;
+  } else if (kind == APCKind::CompressedString &&
+             apcExtension::CompressionHotCount > 0 &&
+             svar->bumpFetchCount() >=
+               std::min(apcExtension::CompressionHotCount, 255)) {
+    // Hot enough to be worth caching decompressed; hold a ref as above.
+    svar->referenceNonRoot();
+    action.decompress = svar;
+  }
+  value = sval->toLocal();
+  if (!action.promote) {
+    /*
+     * Successful slow-case lookup => add value to cache (if key and kind
+     * are eligible and there is still room for it). Another thread may be
+     * updating the same key concurrently, but ConcurrentTableSharedStore's
+     * per-entry lock ensures it will agree on the value.
+     */
+    s_hotCache.store(hotIdx, keyStr.get(), svar, sval);
+  }
+  action.found = true;
+  return action;
+}
+
+bool ConcurrentTableSharedStore::finishGet(const String& keyStr,
+                                           Variant& value,
+                                           const GetAction& action) {
+  if (action.expired) {
+    eraseImpl(tagStringData(keyStr.get()), true,
               apcExtension::UseUncounted ?
               HPHP::Treadmill::getOldestStartTime() : 0, nullptr);
     return false;
   }
+  if (!action.found) return false;
 
-  if (promoteObj)  {
-    handlePromoteObj(keyStr, svar, value);
+  if (action.promote) {
+    handlePromoteObj(keyStr, action.promote, value);
     // release the extra ref
-    svar->unreferenceNonRoot();
+    action.promote->unreferenceNonRoot();
+  } else if (action.decompress) {
+    handlePromoteCompressed(keyStr, action.decompress, value);
+    action.decompress->unreferenceNonRoot();
   }
   return true;
 }
 
+bool ConcurrentTableSharedStore::getMulti(const Array& keys, ArrayInit& init) {
+  struct Fetched {
+    String key;
+    Variant value;
+    GetAction action;
+  };
+  std::vector<Fetched> fetched;
+  fetched.reserve(keys.size());
+  {
+    SharedMutex::ReadHolder l(m_lock);
+    for (ArrayIter iter(keys); iter; ++iter) {
+      Fetched f;
+      f.key = iter.second().toString();
+      FTRACE(3, "Get {}\n", f.key.get()->data());
+      f.action = getUnderLock(f.key, f.value);
+      fetched.push_back(std::move(f));
+    }
+  }
+  auto found = false;
+  for (auto& f : fetched) {
+    if (finishGet(f.key, f.value, f.action)) {
+      found = true;
+      init.set(f.key, f.value);
+      if (UNLIKELY(tl_readCapture != nullptr)) {
+        recordCapturedRead(f.key, f.value);
+      }
+    }
+  }
+  return found;
+}
+
 int64_t ConcurrentTableSharedStore::inc(const String& key, int64_t step,
                                         bool& found) {
   found = false;
@@ -707,6 +893,7 @@ int64_t ConcurrentTableSharedStore::inc(const String& key, int64_t step,
   sval.setHandle(pair.handle);
   sval.dataSize = pair.size;
   found = true;
+  bumpVersion();
   return ret;
 }
 
@@ -737,6 +924,7 @@ bool ConcurrentTableSharedStore::cas(const String& key, int64_t old,
   oldHandle->unreferenceRoot(sval.dataSize);
   sval.setHandle(pair.handle);
   sval.dataSize = pair.size;
+  bumpVersion();
   return true;
 }
 
@@ -871,11 +1059,12 @@ bool ConcurrentTableSharedStore::storeImpl(const String& key,
     if (expiry) {
       auto ikey = intptr_t(acc->first);
       if (m_expMap.insert({ ikey, 0 })) {
-        m_expQueue.push({ ikey, expiry });
+        pushExpiration(ikey, expiry);
       }
     }
   }
   }  // m_lock
+  bumpVersion();
   if (apcExtension::ExpireOnSets) {
     purgeExpired();
   }
@@ -883,44 +1072,95 @@ bool ConcurrentTableSharedStore::storeImpl(const String& key,
   return true;
 }
 
-void ConcurrentTableSharedStore::prime(std::vector<KeyValuePair>&& vars) {
-  SharedMutex::ReadHolder l(m_lock);
-  // we are priming, so we are not checking existence or expiration
-  for (unsigned int i = 0; i < vars.size(); i++) {
-    const KeyValuePair &item = vars[i];
-    Map::accessor acc;
-    auto const keyLen = strlen(item.key);
-    auto const copy = strdup(item.key);
-    if (m_vars.insert(acc, copy)) {
-      APCStats::getAPCStats().addPrimedKey(keyLen);
-    } else {
-      free(copy);
+namespace {
+// Entries primed per dispatcher job; chunks this size keep dispatcher
+// overhead negligible for multi-million-key prime sets.
+constexpr size_t kPrimeChunkSize = 4096;
+}
 
-      // We're going to overwrite what was there.
-      auto& sval = acc->second;
-      sval.data().match(
-        [&] (APCHandle* handle) {
-          handle->unreferenceRoot(sval.dataSize);
-        },
-        [&] (char*) {}
-      );
-      sval.clearData();
-      sval.dataSize = 0;
-      sval.expire   = 0;
+void ConcurrentTableSharedStore::primeEntry(const KeyValuePair& item) {
+  Map::accessor acc;
+  auto const keyLen = strlen(item.key);
+  auto const copy = strdup(item.key);
+  if (m_vars.insert(acc, copy)) {
+    APCStats::getAPCStats().addPrimedKey(keyLen);
+  } else {
+    free(copy);
+
+    // We're going to overwrite what was there.
+    auto& sval = acc->second;
+    sval.data().match(
+      [&] (APCHandle* handle) {
+        handle->unreferenceRoot(sval.dataSize);
+      },
+      [&] (char*) {}
+    );
+    sval.clearData();
+    sval.dataSize = 0;
+    sval.expire   = 0;
+  }
+
+  acc->second.readOnly = apcExtension::EnableConstLoad && item.readOnly;
+  if (item.inMem()) {
+    APCStats::getAPCStats().addAPCValue(item.value, item.sSize, true);
+    acc->second.set(item.value, 0);
+    acc->second.dataSize = item.sSize;
+  } else {
+    acc->second.tagged_data.store(item.sAddr, std::memory_order_release);
+    acc->second.dataSize = item.sSize;
+    APCStats::getAPCStats().addInFileValue(std::abs(acc->second.dataSize));
+  }
+  FTRACE(2, "Primed key {} {}\n", acc->first, show(acc->second));
+}
+
+struct ConcurrentTableSharedStore::PrimeJob {
+  PrimeJob(ConcurrentTableSharedStore* store,
+           const KeyValuePair* begin,
+           const KeyValuePair* end)
+    : store(store), begin(begin), end(end) {}
+  ConcurrentTableSharedStore* store;
+  const KeyValuePair* begin;
+  const KeyValuePair* end;
+};
+
+struct ConcurrentTableSharedStore::PrimeWorker {
+  void onThreadEnter() {}
+  void doJob(std::shared_ptr<PrimeJob> job) {
+    for (auto item = job->begin; item != job->end; ++item) {
+      job->store->primeEntry(*item);
     }
+  }
+  void onThreadExit() {}
+};
 
-    acc->second.readOnly = apcExtension::EnableConstLoad && item.readOnly;
-    if (item.inMem()) {
-      APCStats::getAPCStats().addAPCValue(item.value, item.sSize, true);
-      acc->second.set(item.value, 0);
-      acc->second.dataSize = item.sSize;
-    } else {
-      acc->second.tagged_data.store(item.sAddr, std::memory_order_release);
-      acc->second.dataSize = item.sSize;
-      APCStats::getAPCStats().addInFileValue(std::abs(acc->second.dataSize));
+void ConcurrentTableSharedStore::prime(std::vector<KeyValuePair>&& vars,
+                                       bool parallel) {
+  SharedMutex::ReadHolder l(m_lock);
+  // we are priming, so we are not checking existence or expiration
+  auto const numJobs = (vars.size() + kPrimeChunkSize - 1) / kPrimeChunkSize;
+  auto const threads = parallel
+    ? std::min<size_t>(std::max(apcExtension::LoadThread, 1), numJobs)
+    : 1;
+  if (threads < 2) {
+    for (auto const& item : vars) primeEntry(item);
+  } else {
+    /*
+     * m_vars is a concurrent map and APCStats counters are atomic, so
+     * entries can be inserted from many threads at once. Chunked jobs
+     * keep the hotness-sorted order from SnapshotLoader::load mostly
+     * intact, so map nodes for neighboring hot keys still tend to be
+     * allocated together.
+     */
+    std::vector<std::shared_ptr<PrimeJob>> jobs;
+    jobs.reserve(numJobs);
+    for (size_t i = 0; i < vars.size(); i += kPrimeChunkSize) {
+      auto const end = std::min(i + kPrimeChunkSize, vars.size());
+      jobs.push_back(
+        std::make_shared<PrimeJob>(this, vars.data() + i, vars.data() + end));
     }
-    FTRACE(2, "Primed key {} {}\n", acc->first, show(acc->second));
+    JobDispatcher<PrimeJob, PrimeWorker>(std::move(jobs), threads).run();
   }
+  bumpVersion();
 }
 
 bool ConcurrentTableSharedStore::constructPrime(const String& v,
@@ -980,9 +1220,8 @@ void ConcurrentTableSharedStore::primeDone() {
   // initial accesses to the primed keys are not too bad. Still, for
   // the keys in file, a deserialization from memory is required on first
   // access.
-  ExpirationPair p(intptr_t(apcExtension::FileStorageFlagKey.c_str()),
-                   time(nullptr) + apcExtension::FileStorageAdviseOutPeriod);
-  m_expQueue.push(p);
+  pushExpiration(intptr_t(apcExtension::FileStorageFlagKey.c_str()),
+                 time(nullptr) + apcExtension::FileStorageAdviseOutPeriod);
 
   for (auto iter = apcExtension::CompletionKeys.begin();
        iter != apcExtension::CompletionKeys.end(); ++iter) {
@@ -1014,6 +1253,19 @@ bool ConcurrentTableSharedStore::primeFromSnapshot(const char* filename) {
   return true;
 }
 
+bool ConcurrentTableSharedStore::primeFromSnapshotFd(int fd) {
+  assert(!m_snapshotLoader);
+  m_snapshotLoader = std::make_unique<SnapshotLoader>();
+  if (!m_snapshotLoader->tryInitializeFromFd(fd)) {
+    m_snapshotLoader.reset();
+    return false;
+  }
+  Logger::Info("Loading from inherited snapshot fd %d", fd);
+  m_snapshotLoader->load(*this);
+  primeDone();
+  return true;
+}
+
 void ConcurrentTableSharedStore::adviseOut() {
   if (s_apc_file_storage.getState() !=
       APCFileStorage::StorageState::Invalid) {
@@ -17,7 +17,9 @@
 #ifndef incl_HPHP_CONCURRENT_SHARED_STORE_H_
 #define incl_HPHP_CONCURRENT_SHARED_STORE_H_
 
+#include <array>
 #include <atomic>
+#include <limits>
 #include <utility>
 #include <vector>
 #include <string>
@@ -29,6 +31,7 @@
 #include <tbb/concurrent_priority_queue.h>
 
 #include "hphp/util/either.h"
+#include "hphp/util/hash.h"
 #include "hphp/util/smalllocks.h"
 
 #include "hphp/runtime/base/apc-handle.h"
@@ -42,6 +45,8 @@ namespace HPHP {
 
 //////////////////////////////////////////////////////////////////////
 
+struct ArrayInit;
+
 /*
  * This is the in-APC representation of a value, in ConcurrentTableSharedStore.
  */
@@ -216,12 +221,39 @@ struct ConcurrentTableSharedStore {
   ConcurrentTableSharedStore&
     operator=(const ConcurrentTableSharedStore&) = delete;
 
+  /*
+   * Monotonic count of mutations to the store.  Request-local read
+   * caches remember the version they were filled at and drop their
+   * contents whenever it has moved.
+   */
+  uint64_t version() const {
+    return m_version.load(std::memory_order_acquire);
+  }
+
   /*
    * Retrieve a value from the store.  Returns false if the value wasn't
    * contained in the table (or was expired).
    */
   bool get(const String& key, Variant& value);
 
+  /*
+   * Retrieve several values at once, acquiring the store lock once for
+   * the whole batch instead of once per key.  Each found key is set in
+   * `init' mapped to its value; missing and expired keys are skipped.
+   * Returns true if at least one key was found.
+   */
+  bool getMulti(const Array& keys, ArrayInit& init);
+
+  /*
+   * Request replay capture.  While enabled on this thread, every
+   * successful read records its key and uuencoded serialized value, so
+   * the APC state a request observed can be bundled with the recorded
+   * request and primed into the store before replaying it.  See
+   * HttpProtocol::RecordRequest and ReplayTransport.
+   */
+  static void beginReadCapture();
+  static std::vector<std::pair<std::string,std::string>> takeReadCapture();
+
   /*
    * Add a value to the store if no (unexpired) value with this key is already
    * present.
@@ -286,12 +318,26 @@ struct ConcurrentTableSharedStore {
   /*
    * The API for priming APC.  Poorly documented.
    */
-  void prime(std::vector<KeyValuePair>&& vars);
+  /*
+   * Batch-insert vars into the store. With parallel set, the batch is
+   * inserted on a pool of Server.APC.LoadThread workers; callers that
+   * already run inside a load worker (the shared object prime path)
+   * must leave it unset to avoid stacking pools on top of each other.
+   */
+  void prime(std::vector<KeyValuePair>&& vars, bool parallel = false);
   bool constructPrime(const String& v, KeyValuePair& item, bool serialized);
   bool constructPrime(const Variant& v, KeyValuePair& item);
   void primeDone();
   // Returns false on failure (in particular, for the old file format).
   bool primeFromSnapshot(const char* filename);
+  // Prime from a snapshot fd inherited from a predecessor server
+  // during takeover. Takes ownership of the fd.
+  bool primeFromSnapshotFd(int fd);
+  // The fd of the snapshot we primed from, or -1 if we did not prime
+  // from one. Used to hand the snapshot to a taking-over server.
+  int snapshotFd() const {
+    return m_snapshotLoader ? m_snapshotLoader->fd() : -1;
+  }
   // Evict any file-backed APC values from OS page cache.
   void adviseOut();
 
@@ -388,10 +434,34 @@ private:
   };
 
 private:
+  /*
+   * Work a lookup must defer until m_lock is released: erasing an
+   * expired entry, and finishing an object or hot-compressed-string
+   * promotion (which hold an extra non-root reference on the handle
+   * until then).
+   */
+  struct GetAction {
+    bool found{false};
+    bool expired{false};
+    APCHandle* promote{nullptr};
+    APCHandle* decompress{nullptr};
+  };
+
+  GetAction getUnderLock(const String& keyStr, Variant& value);
+  bool finishGet(const String& keyStr, Variant& value, const GetAction&);
+  void bumpVersion() {
+    m_version.fetch_add(1, std::memory_order_release);
+  }
   bool eraseImpl(const char*, bool, int64_t, ExpMap::accessor* expAcc);
   bool storeImpl(const String&, const Variant&, int64_t, bool, bool);
   void purgeExpired();
+  void pushExpiration(intptr_t key, time_t expiry);
+  static void updateEarliest(std::atomic<time_t>& earliest, time_t value);
   bool handlePromoteObj(const String&, APCHandle*, const Variant&);
+  bool handlePromoteCompressed(const String&, APCHandle*, const Variant&);
+  struct PrimeJob;
+  struct PrimeWorker;
+  void primeEntry(const KeyValuePair& item);
   APCHandle* unserialize(const String&, StoreValue*);
   void dumpKeyAndValue(std::ostream&);
   static EntryInfo makeEntryInfo(const char*, StoreValue*, int64_t curr_time);
@@ -430,11 +500,27 @@ private:
    * reallocated, and the entry in m_expQueue doesn't correspond to
    * the new key; but thats fine - if the key really has expired, it
    * will be purged, and if not, nothing will happen.
+   *
+   * The queue is striped by key address into kExpQueueShards
+   * independent shards so concurrent writers running purges don't
+   * serialize on a single priority queue. Each shard carries a hint of
+   * the earliest expiry it holds; purgeExpired skips shards whose hint
+   * is still in the future, making a purge cost proportional to what
+   * actually expired instead of the queue size.
    */
-  tbb::concurrent_priority_queue<ExpirationPair,
-                                 ExpirationCompare> m_expQueue;
+  static constexpr size_t kExpQueueShards = 16;
+  struct ExpShard {
+    tbb::concurrent_priority_queue<ExpirationPair,
+                                   ExpirationCompare> queue;
+    std::atomic<time_t> earliest{std::numeric_limits<time_t>::max()};
+  };
+  ExpShard& expShard(intptr_t key) {
+    return m_expShards[hash_int64(key) % kExpQueueShards];
+  }
+  std::array<ExpShard, kExpQueueShards> m_expShards;
   ExpMap m_expMap;
   std::atomic<uint64_t> m_purgeCounter{0};
+  std::atomic<uint64_t> m_version{1};
 
   std::unique_ptr<SnapshotLoader> m_snapshotLoader;
 };
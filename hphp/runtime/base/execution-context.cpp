@@ -211,6 +211,18 @@ void ExecutionContext::setContentType(const String& mimetype,
 // write()
 
 void ExecutionContext::write(const String& s) {
+  if (m_sb) {
+    // Appending the String itself (rather than its data) lets the
+    // buffer record large fragments by reference in rope mode.
+    m_sb->append(s);
+    if (m_out && m_out->chunk_size > 0) {
+      if (m_sb->size() >= m_out->chunk_size) {
+        obFlush();
+      }
+    }
+    if (m_implicitFlush) flush();
+    return;
+  }
   write(s.data(), s.size());
 }
 
@@ -305,7 +305,11 @@ private:
   struct OutputBuffer {
     explicit OutputBuffer(Variant&& h, int chunk_sz, OBFlags flgs)
       : oss(8192), handler(std::move(h)), chunk_size(chunk_sz), flags(flgs)
-    {}
+    {
+      // Response assembly is append-mostly; let large echoed strings be
+      // recorded by reference and coalesced once at flush time.
+      oss.enableRope();
+    }
     StringBuffer oss;
     Variant handler;
     int chunk_size;
@@ -33,10 +33,15 @@ FileAwait::FileAwait(int fd, uint16_t events, double timeout) {
   if (timeout_ms > 0) {
     m_timeout = std::make_shared<FileTimeoutHandler>(asio_event_base.get(),
                                                      this);
-    asio_event_base->runInEventBaseThreadAndWait([this,timeout_ms] {
-      if (m_timeout) {
-        m_timeout->scheduleTimeout(timeout_ms);
-      }
+    // Arm the timeout without waiting on the event-base thread.  The
+    // shared_ptr capture keeps the handler alive until the lambda runs,
+    // and the synchronous cancel in ~FileAwait is queued behind this
+    // lambda, so it cannot observe a half-armed timeout.  The
+    // synchronous round trip this used to make is what dominated the
+    // cost of awaiting many fds at once.
+    auto to = m_timeout;
+    asio_event_base->runInEventBaseThread([to, timeout_ms] {
+      to->scheduleTimeout(timeout_ms);
     });
   }
 }
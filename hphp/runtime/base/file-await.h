@@ -34,6 +34,17 @@ struct FileEventHandler : AsioEventHandler {
   FileAwait* m_fileAwait;
 };
 
+/*
+ * One awaited fd, as created by stream_await().
+ *
+ * Every FileAwait in the process registers its FileEventHandler on the
+ * single AsioEventBase singleton, so all awaited fds multiplex onto one
+ * event-loop thread and one underlying epoll set; there is no per-await
+ * thread or poll loop.  Readiness and timeouts are delivered to the
+ * request via markAsFinished(), which enqueues onto the ASIO
+ * external-thread-event queue -- the scheduler drains that queue in
+ * batches, so many fds becoming ready at once wake the request once.
+ */
 struct FileAwait : AsioExternalThreadEvent {
   enum Status {
     ERROR = -1,
@@ -43,6 +43,7 @@
 #include <folly/portability/SysFile.h>
 
 #include <algorithm>
+#include <sys/uio.h>
 
 namespace HPHP {
 
@@ -379,6 +380,18 @@ int64_t File::filteredWrite(const char* buffer, int64_t length) {
   return 0;
 }
 
+int64_t File::writevImpl(const iovec* iov, int count) {
+  int64_t total = 0;
+  for (int i = 0; i < count; i++) {
+    auto const len = int64_t(iov[i].iov_len);
+    if (!len) continue;
+    int64_t written = writeImpl((const char*)iov[i].iov_base, len);
+    total += written;
+    if (written != len) break;
+  }
+  return total;
+}
+
 int64_t File::write(const String& data, int64_t length /* = 0 */) {
   if (seekable()) {
     int64_t offset = m_data->m_readpos - m_data->m_writepos;
@@ -27,6 +27,7 @@
 #include "hphp/runtime/base/type-variant.h"
 
 struct stat;
+struct iovec;
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -193,6 +194,14 @@ struct File : SweepableResourceData {
    * Write one chunk of output. Returns bytes written.
    */
   virtual int64_t writeImpl(const char *buffer, int64_t length) = 0;
+
+  /**
+   * Write a batch of chunks. Returns total bytes written. The default
+   * implementation loops over writeImpl(); streams backed by a plain file
+   * descriptor override it with a single scatter-gather write.
+   */
+  virtual int64_t writevImpl(const iovec* iov, int count);
+
   virtual int64_t write(const String& str, int64_t length = 0);
   int putc(char c);
 
@@ -320,6 +329,9 @@ protected:
    */
   int64_t filteredWrite(const char* buffer, int64_t length);
 
+  bool hasReadFilters() const { return !m_readFilters.empty(); }
+  bool hasWriteFilters() const { return !m_writeFilters.empty(); }
+
   FileData* getFileData() { return m_data.get(); }
   const FileData* getFileData() const { return m_data.get(); }
 
@@ -251,13 +251,24 @@ template<typename ArrayType, typename ElmType>
 member_rval::ptr_u
 HashTable<ArrayType, ElmType>::NvGetInt(const ArrayData* ad, int64_t k) {
   auto a = asArrayType(ad);
+  // Arrays whose int keys were assigned monotonically from zero keep
+  // key i in slot i.  Speculatively check that slot before paying for
+  // the hash-table probe; ids larger than the element count skip the
+  // check for free, and mismatches fall through to the normal find.
+  if (uint64_t(k) < a->m_used) {
+    auto const& elm = a->data()[k];
+    if (!elm.isTombstone() && elm.hasIntKey() && elm.intKey() == k) {
+      return elm.datatv();
+    }
+  }
   auto i = a->find(k, hash_int64(k));
   return LIKELY(validPos(i)) ? a->data()[i].datatv() : nullptr;
 }
 
-#if !defined(__SSE4_2__) || defined(NO_HWCRC) || !defined(NO_M_DATA) || \
-  defined(_MSC_VER)
-// This function is implemented directly in ASM in hash-table-x64.S otherwise.
+#if (!defined(__SSE4_2__) && !defined(ENABLE_AARCH64_CRC)) || \
+  defined(NO_HWCRC) || !defined(NO_M_DATA) || defined(_MSC_VER)
+// This function is implemented directly in ASM in hash-table-x64.S
+// (hash-table-arm.S on aarch64) otherwise.
 template<typename ArrayType, typename ElmType>
 member_rval::ptr_u
 HashTable<ArrayType, ElmType>::NvGetStr(const ArrayData* ad,
@@ -20,12 +20,13 @@
 #include "hphp/runtime/base/hash-table-x64.h"
 #include "hphp/runtime/base/string-data.h"
 
-// NvGetStr is implemented in assembly in hash-table-x64.S, additional macros
-// are defined for various offsets in hash-table-x64.h
+// NvGetStr is implemented in assembly in hash-table-x64.S (hash-table-arm.S
+// on aarch64), additional macros are defined for various offsets in
+// hash-table-x64.h
 // Types inheriting from HashTable should add this macro to statically verify
 // the offsets are correct.
-#if defined(__SSE4_2__) && defined(NO_M_DATA) && !defined(NO_HWCRC) && \
-    !defined(_MSC_VER)
+#if (defined(__SSE4_2__) || defined(ENABLE_AARCH64_CRC)) && \
+    defined(NO_M_DATA) && !defined(NO_HWCRC) && !defined(_MSC_VER)
 
 #define HASH_TABLE_CHECK_OFFSETS(ArrayType, ElmType) \
   static_assert(ArrayType::dataOff() == ArrayType ## _DATA, ""); \
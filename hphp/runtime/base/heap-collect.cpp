@@ -32,7 +32,11 @@
 #include "hphp/util/type-scan.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <folly/Range.h>
 #include <folly/portability/Unistd.h>
@@ -51,6 +55,10 @@ struct Counter {
   }
 };
 
+// Minimum number of slabs before init() bothers spinning up worker threads
+// to parse them; below this the thread-launch overhead dominates.
+constexpr size_t kParallelInitMinSlabs = 32;
+
 bool hasNativeData(const HeapObject* h) {
   assert(isObjectKind(h->kind()));
   return static_cast<const ObjectData*>(h)->getAttribute(
@@ -63,6 +71,7 @@ template<bool apcgc> struct Marker {
   void init();
   void traceRoots();
   void trace();
+  void dedupStrings();
   void sweep();
 
   // drain the scanner, enqueue pointers
@@ -90,13 +99,26 @@ template<bool apcgc> struct Marker {
   Counter allocd_, marked_, pinned_, unknown_; // bytes
   Counter cscanned_roots_, cscanned_; // bytes
   Counter xscanned_roots_, xscanned_; // bytes
+  Counter dedupped_; // displaced duplicate strings
   size_t init_ns_, initfree_ns_, roots_ns_, mark_ns_, sweep_ns_;
+  size_t dedup_ns_{0};
   size_t max_worklist_{0}; // max size of work_
   size_t freed_bytes_{0};
   PtrMap<const HeapObject*> ptrs_;
   type_scan::Scanner type_scanner_;
   std::vector<const HeapObject*> work_;
   APCGCManager* apcgc_ ;
+
+  // one canonical instance per distinct content, for dedupStrings()
+  struct StrHash {
+    size_t operator()(const StringData* s) const { return s->hash(); }
+  };
+  struct StrSame {
+    bool operator()(const StringData* a, const StringData* b) const {
+      return a->same(b);
+    }
+  };
+  std::unordered_set<StringData*, StrHash, StrSame> dedup_table_;
 };
 
 // TODO(T20460162): The contiguous heap has a bitmap of which chunks of memory
@@ -265,6 +287,7 @@ NEVER_INLINE void Marker<apcgc>::init() {
     enqueue(h);
   };
 
+  std::vector<HeapObject*> slabs;
   heap_.iterate(
     [&](HeapObject* h, size_t size) { // onBig
       ptrs_.insert(h, size);
@@ -280,6 +303,20 @@ NEVER_INLINE void Marker<apcgc>::init() {
     },
     [&](HeapObject* h, size_t size) { // onSlab
       ptrs_.insert(h, size);
+      slabs.push_back(h);
+    }
+  );
+
+  // Parse the slabs collected above. Clearing marks and building a slab's
+  // crossing map only touches state inside that slab, so distinct slabs can
+  // be parsed on separate threads. The counters and work_ are not
+  // thread-safe, so each worker accumulates locally and we merge serially
+  // after joining. Small heaps stay on the single-threaded path.
+  auto const numWorkers = std::min<size_t>(
+    std::max(Process::GetCPUCount(), 1), slabs.size() / kParallelInitMinSlabs
+  );
+  if (!RuntimeOption::EvalGCParallelInit || numWorkers < 2) {
+    for (auto h : slabs) {
       Slab::fromHeader(h)->initCrossingMap([&](HeapObject* h, size_t size) {
         init(h, size);
         if (h->kind() == HeaderKind::SmallMalloc &&
@@ -288,7 +325,45 @@ NEVER_INLINE void Marker<apcgc>::init() {
         }
       });
     }
-  );
+  } else {
+    struct SlabWork {
+      Counter allocd, unknown;
+      std::vector<std::pair<HeapObject*,size_t>> pending; // unknown type-index
+    };
+    std::vector<SlabWork> locals(numWorkers);
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (auto i = size_t{0}; i < numWorkers; ++i) {
+      workers.emplace_back([&, i] {
+        auto& local = locals[i];
+        while (true) {
+          auto const s = next.fetch_add(1, std::memory_order_relaxed);
+          if (s >= slabs.size()) break;
+          Slab::fromHeader(slabs[s])->initCrossingMap(
+            [&](HeapObject* h, size_t size) {
+              h->clearMarks();
+              local.allocd += size;
+              if (h->kind() == HeaderKind::SmallMalloc &&
+                  !type_scan::isKnownType(
+                    static_cast<MallocNode*>(h)->typeIndex())) {
+                local.unknown += size;
+                h->mark(GCBits::Pin);
+                local.pending.emplace_back(h, size);
+              }
+            }
+          );
+        }
+      });
+    }
+    for (auto& worker : workers) worker.join();
+    for (auto& local : locals) {
+      allocd_.count += local.allocd.count;
+      allocd_.bytes += local.allocd.bytes;
+      unknown_.count += local.unknown.count;
+      unknown_.bytes += local.unknown.bytes;
+      for (auto& p : local.pending) enqueue(p.first);
+    }
+  }
   ptrs_.prepare();
   if (apcgc) {
     apcgc_ = &APCGCManager::getInstance();
@@ -337,6 +412,97 @@ NEVER_INLINE void Marker<apcgc>::trace() {
   }
 }
 
+// Opportunistic string deduplication. Long-running requests accumulate
+// many copies of the same small strings (repeated array keys, parsed
+// tokens). With marking complete, walk the surviving arrays and redirect
+// duplicate counted strings to one canonical instance, releasing each
+// displaced copy once its last reference is gone. Only array slots are
+// rewritten: array code reloads the slot and re-checks the refcount
+// before any in-place string mutation, so substituting an equal instance
+// behind the array's back is safe, unlike raw StringData* fields which
+// may cache a uniqueness decision. Pinned strings are left alone; a
+// conservative pointer may be a raw borrow that holds no reference.
+template <bool apcgc>
+NEVER_INLINE void Marker<apcgc>::dedupStrings() {
+  auto const t0 = cpu_ns();
+  SCOPE_EXIT { dedup_ns_ = cpu_ns() - t0; };
+  auto const maxSize = RuntimeOption::EvalGCStringDedupMaxSize;
+  auto dedup = [&](StringData* s) {
+    if (!s->isRefCounted() || size_t(s->size()) > maxSize ||
+        s->marks() == GCBits::Pin) {
+      return s;
+    }
+    auto const insert = dedup_table_.insert(s);
+    auto const canon = *insert.first;
+    if (canon == s) return s; // first (or repeat) sighting of the canonical
+    canon->incRefCount();
+    dedupped_ += s->heapSize();
+    decRefStr(s);
+    return canon;
+  };
+  auto fix_tv = [&](TypedValue& tv) {
+    if (tv.m_type == KindOfString) {
+      tv.m_data.pstr = dedup(tv.m_data.pstr);
+    }
+  };
+  auto fix = [&](HeapObject* h) {
+    if (!marked(h)) return;
+    switch (h->kind()) {
+      case HeaderKind::Packed:
+      case HeaderKind::VecArray: {
+        auto const arr = static_cast<ArrayData*>(h);
+        auto const data = packedData(arr);
+        for (uint32_t i = 0, n = arr->getSize(); i < n; ++i) {
+          fix_tv(data[i]);
+        }
+        break;
+      }
+      case HeaderKind::Mixed:
+      case HeaderKind::Dict: {
+        auto const arr = static_cast<MixedArray*>(h);
+        auto const elms = arr->data();
+        for (uint32_t i = 0, n = arr->iterLimit(); i < n; ++i) {
+          auto& e = elms[i];
+          if (e.isTombstone()) continue;
+          if (e.hasStrKey()) e.skey = dedup(e.skey); // same content, same hash
+          fix_tv(e.data);
+        }
+        break;
+      }
+      case HeaderKind::Keyset: {
+        auto const arr = static_cast<SetArray*>(h);
+        auto const elms = arr->data();
+        for (uint32_t i = 0, n = arr->iterLimit(); i < n; ++i) {
+          auto& e = elms[i];
+          if (!e.isInvalid() && e.tv.m_type == KindOfString) {
+            e.tv.m_data.pstr = dedup(e.tv.m_data.pstr);
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  };
+  heap_.iterate(
+    [&](HeapObject* big, size_t /*size*/) { // onBig
+      if (big->kind() == HeaderKind::BigObj) {
+        fix(static_cast<MallocNode*>(big) + 1);
+      }
+    },
+    [&](HeapObject* big, size_t /*size*/) { // onSlab
+      auto slab = Slab::fromHeader(big);
+      slab->find_if((HeapObject*)slab->start(),
+        [&](HeapObject* h, size_t /*size*/) {
+          fix(h);
+          return false;
+        }
+      );
+    }
+  );
+  dedup_table_.clear();
+}
+
 // another pass through the heap, this time using the PtrMap we computed
 // in init(). Free and maybe quarantine unmarked objects.
 template <bool apcgc>
@@ -368,12 +534,25 @@ NEVER_INLINE void Marker<apcgc>::sweep() {
 
   mm.initFree();
 
+  // While we're visiting every object anyway, optionally refresh the
+  // per-class live counters from the marked survivors. One hash update per
+  // live object is noise next to the mark phase we just paid for.
+  auto const classCounts = RuntimeOption::EvalGCClassCounters;
+  if (classCounts) t_live_class_counts.clear();
+  auto count_live = [&](const HeapObject* h, size_t size) {
+    if (auto obj = innerObj(h)) {
+      t_live_class_counts[obj->getVMClass()] += size;
+    }
+  };
+
   heap_.iterate(
     [&](HeapObject* big, size_t big_size) { // onBig
       if (big->kind() == HeaderKind::BigObj) {
         big = static_cast<MallocNode*>(big) + 1;
         if (!marked(big)) {
           mm.freeBigSize(big);
+        } else if (classCounts) {
+          count_live(big, big_size - sizeof(MallocNode));
         }
       }
     },
@@ -384,11 +563,14 @@ NEVER_INLINE void Marker<apcgc>::sweep() {
           if (!marked(h) && !isFreeKind(h->kind()) &&
               h->kind() != HeaderKind::SmallMalloc) {
             mm.freeSmallSize(h, h_size);
+          } else if (classCounts && marked(h)) {
+            count_live(h, h_size);
           }
           return false;
         }
       );
     });
+  if (classCounts) t_live_counts_valid = true;
   if (apcgc) {
     // This should be removed after global GC API is provided
     // Currently we do this to sweeping only when script mode
@@ -399,6 +581,15 @@ NEVER_INLINE void Marker<apcgc>::sweep() {
 thread_local bool t_eager_gc{false};
 thread_local BloomFilter<256*1024> t_surprise_filter;
 
+// Per-class live-object counters from the most recent collection, keyed by
+// Class. Maintained during sweep() when Eval.GCClassCounters is set, so
+// objprof can answer per-class memory queries without a heap walk. Stored
+// in unrequest (malloc) memory so reading them never allocates on the
+// request heap. Class* stays valid for the request that populated the map;
+// resetGC() clears it before the next one.
+thread_local std::unordered_map<const Class*, Counter> t_live_class_counts;
+thread_local bool t_live_counts_valid{false};
+
 // Structured Logging
 
 thread_local std::atomic<size_t> g_req_num;
@@ -457,6 +648,7 @@ void logCollection(const char* phase, const Marker<apcgc>& mkr) {
   sample.setInt("initfree_micros", mkr.initfree_ns_/1000);
   sample.setInt("roots_micros", mkr.roots_ns_/1000);
   sample.setInt("mark_micros", mkr.mark_ns_/1000);
+  sample.setInt("dedup_micros", mkr.dedup_ns_/1000);
   sample.setInt("sweep_micros", mkr.sweep_ns_/1000);
   // size metrics gathered during gc
   sample.setInt("allocd_bytes", mkr.allocd_.bytes);
@@ -465,6 +657,8 @@ void logCollection(const char* phase, const Marker<apcgc>& mkr) {
   sample.setInt("marked_bytes", mkr.marked_.bytes);
   sample.setInt("pinned_bytes", mkr.pinned_.bytes);
   sample.setInt("unknown_bytes", mkr.unknown_.bytes);
+  sample.setInt("dedup_bytes", mkr.dedupped_.bytes);
+  sample.setInt("dedup_strings", mkr.dedupped_.count);
   sample.setInt("freed_bytes", mkr.freed_bytes_);
   sample.setInt("trigger_bytes", t_trigger);
   sample.setInt("cscanned_roots", mkr.cscanned_roots_.bytes);
@@ -481,12 +675,12 @@ void logCollection(const char* phase, const Marker<apcgc>& mkr) {
   StructuredLog::log("hhvm_gc", sample);
 }
 
-void collectImpl(HeapImpl& heap, const char* phase) {
+size_t collectImpl(HeapImpl& heap, const char* phase) {
   VMRegAnchor _;
   if (t_eager_gc && RuntimeOption::EvalFilterGCPoints) {
     t_eager_gc = false;
     auto pc = vmpc();
-    if (t_surprise_filter.test(pc)) return;
+    if (t_surprise_filter.test(pc)) return 0;
     t_surprise_filter.insert(pc);
     TRACE(2, "eager gc %s at %p\n", phase, pc);
     phase = "eager";
@@ -504,21 +698,25 @@ void collectImpl(HeapImpl& heap, const char* phase) {
     mkr.init();
     mkr.traceRoots();
     mkr.trace();
+    if (RuntimeOption::EvalGCStringDedupMaxSize > 0) mkr.dedupStrings();
     mkr.sweep();
     if (t_enable_samples) {
       logCollection(phase, mkr);
     }
     ++t_gc_num;
+    return mkr.freed_bytes_;
   } else {
     Marker<false> mkr(heap);
     mkr.init();
     mkr.traceRoots();
     mkr.trace();
+    if (RuntimeOption::EvalGCStringDedupMaxSize > 0) mkr.dedupStrings();
     mkr.sweep();
     if (t_enable_samples) {
       logCollection(phase, mkr);
     }
     ++t_gc_num;
+    return mkr.freed_bytes_;
   }
 }
 
@@ -527,9 +725,25 @@ void collectImpl(HeapImpl& heap, const char* phase) {
 void MemoryManager::resetGC() {
   t_req_num = ++g_req_num;
   t_gc_num = 0;
+  m_gcTriggerScale = 1;
+  t_live_counts_valid = false;
+  t_live_class_counts.clear();
   updateNextGc();
 }
 
+bool MemoryManager::hasGCClassCounts() {
+  return t_live_counts_valid;
+}
+
+std::vector<MemoryManager::ClassCount> MemoryManager::getGCClassCounts() {
+  std::vector<ClassCount> counts;
+  counts.reserve(t_live_class_counts.size());
+  for (auto const& kv : t_live_class_counts) {
+    counts.push_back({kv.first, kv.second.count, kv.second.bytes});
+  }
+  return counts;
+}
+
 void MemoryManager::resetEagerGC() {
   if (RuntimeOption::EvalEagerGC && RuntimeOption::EvalFilterGCPoints) {
     t_surprise_filter.clear();
@@ -557,14 +771,28 @@ void MemoryManager::updateNextGc() {
   int64_t delta = (mm_limit - stats.mmUsage) *
                   RuntimeOption::EvalGCTriggerPct;
   delta = std::max(delta, RuntimeOption::EvalGCMinTrigger);
-  m_nextGc = stats.mmUsage + delta;
+  m_nextGc = stats.mmUsage + delta * m_gcTriggerScale;
 }
 
 void MemoryManager::collect(const char* phase) {
+  // Arrays parked for deferred release already have zero counts;
+  // destroy them before tracing so the collector never sees them.
+  // (gc_collect_cycles can get here without passing the surprise
+  // handler's own drain.)
+  drainDeferredReleases();
   if (empty()) return;
   t_req_age = cpu_ns()/1000 - m_req_start_micros;
   t_trigger = m_nextGc;
-  collectImpl(m_heap, phase);
+  auto const freed = collectImpl(m_heap, phase);
+  // When a collection reclaims almost nothing, the heap is dominated by
+  // objects surviving the whole request; retracing them at every trigger
+  // is wasted work. Back the trigger distance off geometrically until a
+  // collection pays for itself again, and reset the scale each request.
+  if (freed < size_t(RuntimeOption::EvalGCMinTrigger / 4)) {
+    m_gcTriggerScale = std::min<int64_t>(m_gcTriggerScale * 2, 8);
+  } else {
+    m_gcTriggerScale = 1;
+  }
   updateNextGc();
 }
 
@@ -19,6 +19,7 @@
 #include "hphp/runtime/server/server-stats.h"
 #include "hphp/runtime/base/curl-tls-workarounds.h"
 #include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/ext/curl/curl-pool.h"
 #include "hphp/util/timer.h"
 #include <curl/easy.h>
 #include <vector>
@@ -127,7 +128,20 @@ int HttpClient::request(const char* verb,
   char error_str[CURL_ERROR_SIZE + 1];
   memset(error_str, 0, sizeof(error_str));
 
-  CURL *cp = curl_easy_init();
+  // When configured, draw the handle from a process-wide pool instead of
+  // creating a fresh one, so the connection and TLS session caches carry
+  // over from earlier requests to the same destinations.
+  CurlHandlePoolPtr pool;
+  PooledCurlHandle *pooledHandle = nullptr;
+  if (!RuntimeOption::HttpConnectionPool.empty()) {
+    pool = CurlHandlePool::getOrCreateNamedPool(
+      RuntimeOption::HttpConnectionPool,
+      RuntimeOption::HttpConnectionPoolSize,
+      RuntimeOption::HttpConnectionPoolWaitTimeout,
+      RuntimeOption::HttpConnectionPoolReuseLimit);
+    pooledHandle = pool->fetch();
+  }
+  CURL *cp = pooledHandle ? pooledHandle->useHandle() : curl_easy_init();
   curl_easy_setopt(cp, CURLOPT_URL,               url);
   curl_easy_setopt(cp, CURLOPT_WRITEFUNCTION,     curl_write);
   curl_easy_setopt(cp, CURLOPT_WRITEDATA,         (void*)this);
@@ -281,7 +295,11 @@ int HttpClient::request(const char* verb,
     curl_slist_free_all(slist);
   }
 
-  curl_easy_cleanup(cp);
+  if (pooledHandle != nullptr) {
+    pool->store(pooledHandle);
+  } else {
+    curl_easy_cleanup(cp);
+  }
   return code;
 }
 
@@ -17,11 +17,14 @@
 #include "hphp/runtime/base/init-fini-node.h"
 #include "hphp/util/timer.h"
 
+#include <cstring>
+#include <string>
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
 InitFiniNode *InitFiniNode::s_nodes[NumNodes];
-InitFiniNode::IFDispatcher* InitFiniNode::s_dispatcher[NumNodes];
+InitFiniNode::IFDriver* InitFiniNode::s_driver[NumNodes];
 
 void InitFiniNode::iterate(InitFiniNode *node) {
   while (node) {
@@ -35,21 +38,98 @@ void InitFiniNode::IFWorker::doJob(std::shared_ptr<IFJob> job) {
   job->node.func();
 }
 
+/*
+ * Runs one concurrent node list.  Dependency-free nodes go straight to a
+ * JobDispatcher; nodes annotated with `dependsOn' are held back until the
+ * nodes they name have finished.  Execution proceeds in topological
+ * waves: each pass runs every node whose dependencies are satisfied, in
+ * parallel, then starts over with whatever became runnable.  With no
+ * annotations the first wave is the whole list, which is the old
+ * behavior.
+ *
+ * With maxWorkers == 0 the waves run synchronously on the calling
+ * thread, preserving the serial fallback.
+ */
+struct InitFiniNode::IFDriver {
+  IFDriver(InitFiniNode* head, uint32_t maxWorkers)
+    : m_head(head)
+    , m_maxWorkers(maxWorkers)
+    , m_func(this, &IFDriver::run) {
+    m_func.setNoInitFini();
+  }
+
+  void start() { m_func.start(); }
+  void waitForEnd() { m_func.waitForEnd(); }
+
+  void run() {
+    unsigned remaining = 0;
+    for (auto n = m_head; n; n = n->next) {
+      n->done = false;
+      ++remaining;
+    }
+    while (remaining > 0) {
+      std::vector<InitFiniNode*> wave;
+      for (auto n = m_head; n; n = n->next) {
+        if (!n->done && ready(n)) wave.push_back(n);
+      }
+      if (wave.empty()) {
+        // Every remaining node is waiting on another remaining node, so
+        // the annotations form a cycle.
+        std::string blocked;
+        for (auto n = m_head; n; n = n->next) {
+          if (n->done) continue;
+          blocked += " ";
+          blocked += n->name ? n->name : "(unnamed)";
+        }
+        always_assert_flog(false,
+                           "cycle in InitFiniNode dependencies:{}", blocked);
+      }
+      if (m_maxWorkers == 0) {
+        for (auto n : wave) n->func();
+      } else {
+        std::vector<std::shared_ptr<IFJob>> jobs;
+        jobs.reserve(wave.size());
+        for (auto n : wave) jobs.push_back(std::make_shared<IFJob>(*n));
+        JobDispatcher<IFJob, IFWorker>(std::move(jobs), m_maxWorkers).run();
+      }
+      for (auto n : wave) n->done = true;
+      remaining -= wave.size();
+    }
+  }
+
+ private:
+  bool ready(const InitFiniNode* n) const {
+    for (auto dep : n->after) {
+      const InitFiniNode* d = nullptr;
+      for (auto m = m_head; m; m = m->next) {
+        if (m->name && !strcmp(m->name, dep)) {
+          d = m;
+          break;
+        }
+      }
+      always_assert_flog(d, "InitFiniNode '{}' waits on unknown node '{}'",
+                         n->name ? n->name : "(unnamed)", dep);
+      if (!d->done) return false;
+    }
+    return true;
+  }
+
+  InitFiniNode* m_head;
+  uint32_t m_maxWorkers;
+  AsyncFunc<IFDriver> m_func;
+};
+
 void InitFiniNode::concurrentStart(uint32_t maxWorkers, When when) {
   if (maxWorkers == 0) {
-    iterate(when);
+    IFDriver(node(when), 0).run();
     return;
   }
-  std::vector<std::shared_ptr<IFJob> > jobs;
-  for (const auto* n = node(when); n; n = n->next) {
-    jobs.push_back(std::make_shared<IFJob>(*n));
-  }
-  dispatcher(when) = new IFDispatcher(std::move(jobs), maxWorkers);
-  dispatcher(when)->start();
+  driver(when) = new IFDriver(node(when), maxWorkers);
+  driver(when)->start();
 }
 
 void InitFiniNode::concurrentWaitForEnd(When when) {
-  auto& d = dispatcher(when);
+  auto& d = driver(when);
   if (d) {
     d->waitForEnd();
     delete d;
@@ -21,6 +21,9 @@
 #include "hphp/util/assertions.h"
 #include "hphp/util/async-job.h"
 
+#include <initializer_list>
+#include <vector>
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -40,8 +43,8 @@ struct InitFiniNode {
       RequestFini,
       ThreadInit,
       ThreadFini,
-      // ProcessInitConcurrent should only be used for thread-safe code with few
-      // dependencies (e.g., runtime options, logging).
+      // ProcessInitConcurrent should only be used for thread-safe code;
+      // nodes that need another node's work may name it in `dependsOn'.
       PostRuntimeOptions,    // after runtime options are set, single-threaded
       ProcessPreInit,        // after pthread initialization and config parsing
       ProcessInit,           // after PreInit
@@ -58,11 +61,26 @@ struct InitFiniNode {
 
   const static unsigned NumNodes = static_cast<unsigned>(When::Sentinel);
 
-  InitFiniNode(void(*f)(), When when, const char* what = nullptr) {
+  /*
+   * Nodes in the concurrently executed lists (ProcessInitConcurrent and
+   * WarmupConcurrent) may name other nodes in the same list that must
+   * finish before they run, e.g.,
+   *
+   *   InitFiniNode s_init(init, When::ProcessInitConcurrent, "bar",
+   *                       {"foo"});
+   *
+   * The scheduler overlaps everything else while honoring the
+   * annotations; named dependencies must exist in the same list.  The
+   * annotation is ignored for the serially executed lists, which run in
+   * registration order as before.
+   */
+  InitFiniNode(void(*f)(), When when, const char* what = nullptr,
+               std::initializer_list<const char*> dependsOn = {}) {
     InitFiniNode*& n = node(when);
     func = f;
     next = n;
     name = what;
+    after.insert(after.end(), dependsOn.begin(), dependsOn.end());
     n = this;
   }
 
@@ -92,21 +110,25 @@ struct InitFiniNode {
     void onThreadExit() {}
   };
  private:
-  using IFDispatcher = JobDispatcher<IFJob, IFWorker>;
+  // Runs one concurrent list on a JobDispatcher, in topological waves
+  // when any node carries a dependency annotation.
+  struct IFDriver;
 
   static InitFiniNode*& node(When when) {
     auto idx = static_cast<unsigned>(when);
     assert(idx < NumNodes);
     return s_nodes[idx];
   }
-  static IFDispatcher*& dispatcher(When when) {
+  static IFDriver*& driver(When when) {
     auto idx = static_cast<unsigned>(when);
     assert(idx < NumNodes);
-    return s_dispatcher[idx];
+    return s_driver[idx];
   }
   void (*func)();
   InitFiniNode* next;
   const char* name;
+  std::vector<const char*> after;       // names of nodes we must follow
+  bool done{false};                     // only touched by the IFDriver
 
   static void iterate(When when) { iterate(node(when)); }
   static void iterate(InitFiniNode* node);
@@ -114,7 +136,7 @@ struct InitFiniNode {
   static void concurrentWaitForEnd(When when);
 
   static InitFiniNode* s_nodes[NumNodes];
-  static IFDispatcher* s_dispatcher[NumNodes];
+  static IFDriver* s_driver[NumNodes];
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -17,6 +17,8 @@
 
 #include "hphp/runtime/base/intl-convert.h"
 
+#include "hphp/util/utf8-scan.h"
+
 #include <cstdint>
 #include <cstdlib>
 
@@ -34,6 +36,28 @@ void intl_convert_utf8_to_utf16(UChar** target, int* target_len,
    */
   *status = U_ZERO_ERROR;
 
+  /* All-ASCII input widens one UChar per byte; skip ICU's validating
+   * decode and the pre-flighting pass entirely.
+   */
+  if (src_len >= 0 &&
+      utf8_ascii_prefix(src, src_len) == static_cast<size_t>(src_len)) {
+    if (*target != nullptr && src_len < *target_len) {
+      dst_buf = *target;
+    } else {
+      dst_buf = (UChar *)malloc((src_len + 1) * sizeof(UChar));
+    }
+    for (int32_t i = 0; i < src_len; ++i) {
+      dst_buf[i] = (UChar)(unsigned char)src[i];
+    }
+    dst_buf[src_len] = 0;
+    if (dst_buf != *target) {
+      if (*target) free(*target);
+      *target = dst_buf;
+    }
+    *target_len = src_len;
+    return;
+  }
+
   u_strFromUTF8(*target, *target_len, &dst_len, src, src_len, status);
 
   if (*status == U_ZERO_ERROR) {
@@ -78,6 +102,20 @@ void intl_convert_utf16_to_utf8(char** target, int* target_len,
   char* dst_buf = nullptr;
   int32_t dst_len;
 
+  /* All-ASCII input narrows one byte per UChar; skip both ICU passes. */
+  if (src_len >= 0 &&
+      utf16_is_ascii(reinterpret_cast<const uint16_t*>(src), src_len)) {
+    dst_buf = (char *)malloc(src_len + 1);
+    for (int32_t i = 0; i < src_len; ++i) {
+      dst_buf[i] = (char)src[i];
+    }
+    dst_buf[src_len] = 0;
+    *status = U_ZERO_ERROR;
+    *target = dst_buf;
+    *target_len = src_len;
+    return;
+  }
+
   /* Determine required destination buffer size (pre-flighting). */
   *status = U_ZERO_ERROR;
   u_strToUTF8(nullptr, 0, &dst_len, src, src_len, status);
@@ -263,6 +263,11 @@ inline void* MemoryManager::mallocSmallIndex(size_t index) {
   auto bytes = sizeIndex2Size(index);
   m_stats.mmUsage += bytes;
 
+  if (UNLIKELY(m_allocSampleCountdown != 0) &&
+      (m_allocSampleCountdown -= bytes) <= 0) {
+    recordAllocSample(bytes);
+  }
+
   void *p = m_freelists[index].maybePop();
   if (UNLIKELY(p == nullptr)) {
     p = mallocSmallSizeSlow(bytes, index);
@@ -18,7 +18,10 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <mutex>
+#include <unordered_map>
 
+#include "hphp/runtime/base/array-data-defs.h"
 #include "hphp/runtime/base/builtin-functions.h"
 #include "hphp/runtime/base/exceptions.h"
 #include "hphp/runtime/base/ini-setting.h"
@@ -30,14 +33,17 @@
 #include "hphp/runtime/base/req-root.h"
 #include "hphp/runtime/base/heap-graph.h"
 #include "hphp/runtime/server/http-server.h"
+#include "hphp/runtime/vm/vm-regs.h"
 
 #include "hphp/util/alloc.h"
 #include "hphp/util/logger.h"
+#include "hphp/util/numa.h"
 #include "hphp/util/process.h"
 #include "hphp/util/ptr-map.h"
 #include "hphp/util/timer.h"
 #include "hphp/util/trace.h"
 
+#include <folly/Hash.h>
 #include <folly/Random.h>
 #include <folly/ScopeGuard.h>
 #include <folly/portability/SysMman.h>
@@ -180,6 +186,10 @@ void MemoryManager::traceStats(const char* event) {
 // be used between requests when the whole heap is being reset.
 void MemoryManager::resetAllStats() {
   traceStats("resetAllStats pre");
+  // Usage threshold callbacks may capture request state; drop any
+  // leftovers so nothing dangles into the next request.
+  m_usageThresholds.clear();
+  m_nextUsageThreshold = SIZE_MAX;
   m_statsIntervalActive = false;
   m_stats.mmUsage = 0;
   m_stats.extUsage = 0;
@@ -239,6 +249,38 @@ void MemoryManager::setMemThresholdCallback(size_t threshold) {
   m_memThresholdCallbackPeakUsage = threshold;
 }
 
+void MemoryManager::addUsageThresholdCallback(size_t threshold,
+                                              std::function<void()> fn) {
+  m_usageThresholds.emplace_back(threshold, std::move(fn));
+  m_nextUsageThreshold = std::min(m_nextUsageThreshold, threshold);
+}
+
+/*
+ * Fire and retire every registered callback whose threshold has been
+ * reached, then recompute the lowest outstanding threshold.  Only called
+ * from the slab refill path once the cheap per-slab compare has seen a
+ * crossing.
+ */
+void MemoryManager::checkUsageThresholds() {
+  auto const usage = size_t(std::max<int64_t>(m_stats.usage(), 0));
+  std::vector<std::function<void()>> fired;
+  size_t next = SIZE_MAX;
+  for (size_t i = 0; i < m_usageThresholds.size();) {
+    if (m_usageThresholds[i].first <= usage) {
+      fired.emplace_back(std::move(m_usageThresholds[i].second));
+      m_usageThresholds[i] = std::move(m_usageThresholds.back());
+      m_usageThresholds.pop_back();
+    } else {
+      next = std::min(next, m_usageThresholds[i].first);
+      ++i;
+    }
+  }
+  // Set the cached minimum before running callbacks: they may register
+  // new thresholds, and addUsageThresholdCallback only lowers it.
+  m_nextUsageThreshold = next;
+  for (auto& fn : fired) fn();
+}
+
 /*
  * Refresh stats to reflect directly malloc()ed memory, and determine
  * whether the request memory limit has been exceeded.
@@ -326,12 +368,25 @@ void MemoryManager::sweep() {
   tl_sweeping = true;
   DEBUG_ONLY size_t num_sweepables = 0, num_natives = 0;
 
+  // Anything still queued for deferred release goes down with the heap
+  // wholesale in resetAllocator(); drop the references so nothing
+  // dangles into the next request.
+  m_deferredReleases.clear();
+
+  // Most requests register nothing; skip the list walks and logging.
+  if (m_sweepables.empty() && m_natives.empty() && m_apc_arrays.empty()) {
+    return;
+  }
+
   // iterate until both sweep lists are empty. Entries can be added or
   // removed from either list during sweeping.
   do {
     while (!m_sweepables.empty()) {
       num_sweepables++;
       auto obj = m_sweepables.next();
+      // List nodes are cold by request end; overlap the fetch of the
+      // following node with this object's sweep.
+      __builtin_prefetch(obj->next());
       obj->unregister();
       obj->sweep();
     }
@@ -368,6 +423,32 @@ void MemoryManager::sweep() {
   if (debug) checkHeap("after MM::sweep");
 }
 
+void MemoryManager::deferArrayRelease(ArrayData* ad) {
+  // Outside of a request there's no surprise machinery to drain the
+  // queue; release inline as if the option were off.
+  if (UNLIKELY(!rds::header())) {
+    ad->release();
+    return;
+  }
+  if (m_deferredReleases.empty()) setSurpriseFlag(DeferredReleaseFlag);
+  m_deferredReleases.push_back(ad);
+}
+
+void MemoryManager::drainDeferredReleases() {
+  // Releasing an array whose elements are themselves dead arrays queues
+  // them right back here, so a deep tree unwinds iteratively in this
+  // loop rather than recursively.
+  while (!m_deferredReleases.empty()) {
+    auto const ad = m_deferredReleases.back();
+    m_deferredReleases.pop_back();
+    ad->release();
+  }
+}
+
+void deferredReleaseArray(void* ptr) {
+  MM().deferArrayRelease(static_cast<ArrayData*>(ptr));
+}
+
 void MemoryManager::resetAllocator() {
   assert(m_natives.empty() && m_sweepables.empty() && tl_sweeping);
   // decref apc strings referenced by this request
@@ -665,6 +746,9 @@ inline void MemoryManager::splitTail(void* tail, uint32_t tailBytes,
  */
 NEVER_INLINE void* MemoryManager::newSlab(uint32_t nbytes) {
   refreshStats();
+  if (UNLIKELY(size_t(m_stats.usage()) >= m_nextUsageThreshold)) {
+    checkUsageThresholds();
+  }
   requestGC();
   storeTail(m_front, (char*)m_limit - (char*)m_front);
   auto mem = m_heap.allocSlab(kSlabSize, m_stats);
@@ -767,6 +851,10 @@ void* MemoryManager::mallocBigSize(size_t bytes, HeaderKind kind,
   auto block = Mode == Zeroed ? m_heap.callocBig(bytes, kind, ty, m_stats) :
                m_heap.allocBig(bytes, kind, ty, m_stats);
   updateBigStats();
+  if (UNLIKELY(m_allocSampleCountdown != 0) &&
+      (m_allocSampleCountdown -= bytes) <= 0) {
+    recordAllocSample(bytes);
+  }
   FTRACE(3, "mallocBigSize: {} ({} requested, {} usable)\n",
          block.ptr, bytes, block.size);
   return block.ptr;
@@ -943,6 +1031,97 @@ void MemoryManager::resetCouldOOM(bool state) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Sampling allocation profiler.
+
+namespace {
+
+struct AllocSampleKey {
+  std::string func;
+  size_t sizeClass;
+  bool operator==(const AllocSampleKey& o) const {
+    return sizeClass == o.sizeClass && func == o.func;
+  }
+};
+
+struct AllocSampleKeyHash {
+  size_t operator()(const AllocSampleKey& k) const {
+    return folly::hash::hash_combine(k.func, k.sizeClass);
+  }
+};
+
+struct AllocSampleVal {
+  uint64_t samples{0};
+  uint64_t bytes{0};
+};
+
+std::atomic<int64_t> s_allocSampleInterval{0};
+std::mutex s_allocSampleLock;
+std::unordered_map<AllocSampleKey, AllocSampleVal, AllocSampleKeyHash>
+  s_allocSamples;
+
+}
+
+void MemoryManager::setAllocSamplingInterval(int64_t bytes) {
+  s_allocSampleInterval.store(std::max<int64_t>(bytes, 0),
+                              std::memory_order_relaxed);
+}
+
+int64_t MemoryManager::allocSamplingInterval() {
+  return s_allocSampleInterval.load(std::memory_order_relaxed);
+}
+
+std::vector<MemoryManager::AllocSampleRow> MemoryManager::getAllocSamples() {
+  std::vector<AllocSampleRow> rows;
+  std::lock_guard<std::mutex> lock(s_allocSampleLock);
+  rows.reserve(s_allocSamples.size());
+  for (auto const& kv : s_allocSamples) {
+    rows.push_back(AllocSampleRow{
+      kv.first.func, kv.first.sizeClass,
+      kv.second.samples, kv.second.bytes
+    });
+  }
+  return rows;
+}
+
+void MemoryManager::clearAllocSamples() {
+  std::lock_guard<std::mutex> lock(s_allocSampleLock);
+  s_allocSamples.clear();
+}
+
+NEVER_INLINE
+void MemoryManager::recordAllocSample(size_t sizeClassBytes) {
+  auto const interval = s_allocSampleInterval.load(std::memory_order_relaxed);
+  if (interval <= 0) {
+    // Sampling has been switched off; disarm this thread.
+    m_allocSampleCountdown = 0;
+    return;
+  }
+  do {
+    m_allocSampleCountdown += interval;
+  } while (m_allocSampleCountdown <= 0);
+
+  // Attribute the sample to the function on top of the VM stack when the
+  // registers are clean; inside translated code they are not walkable
+  // without a fixup, so those samples land in a catch-all bucket.  Copy
+  // the name out: Func pointers held across requests would race with the
+  // treadmill.  All containers here are untracked malloc memory, so this
+  // never re-enters the request heap.
+  AllocSampleKey key;
+  key.sizeClass = sizeClassBytes;
+  if (tl_regState == VMRegState::CLEAN && rds::header() && vmfp() &&
+      vmfp()->func()) {
+    key.func = vmfp()->func()->fullName()->toCppString();
+  } else {
+    key.func = "(unattributed)";
+  }
+
+  std::lock_guard<std::mutex> lock(s_allocSampleLock);
+  auto& val = s_allocSamples[key];
+  ++val.samples;
+  val.bytes += sizeClassBytes;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Request profiling.
 
@@ -963,6 +1142,10 @@ bool MemoryManager::triggerProfiling(const std::string& filename) {
 void MemoryManager::requestInit() {
   MM().m_req_start_micros = HPHP::Timer::GetThreadCPUTimeNanos() / 1000;
 
+  // Arm (or disarm) allocation sampling for this request.
+  MM().m_allocSampleCountdown =
+    s_allocSampleInterval.load(std::memory_order_relaxed);
+
   // If the trigger has already been claimed, do nothing.
   auto trigger = s_trigger.exchange(nullptr);
   if (trigger == nullptr) return;
@@ -1039,7 +1222,7 @@ void BigHeap::reset() {
         t_heap_id, m_slabs.size(), m_bigs.size());
   auto const do_free = [&](void* ptr, size_t size) {
     if (RuntimeOption::EvalTrashFillOnRequestExit) {
-      memset(ptr, size, kSmallFreeFill);
+      memset(ptr, kSmallFreeFill, size);
     }
 #ifdef USE_JEMALLOC
     dallocx(ptr, 0);
@@ -1047,7 +1230,19 @@ void BigHeap::reset() {
     free(ptr);
 #endif
   };
-  for (auto slab : m_slabs) do_free(slab.ptr, slab.size);
+  auto const retainLimit = RuntimeOption::EvalSlabRetainLimit;
+  for (auto slab : m_slabs) {
+    if (slab.size == kSlabSize && m_retainedSlabs.size() < retainLimit) {
+      // Keep the slab mapped and faulted in; the next request's
+      // allocSlab() picks it up without any page-fault churn.
+      if (RuntimeOption::EvalTrashFillOnRequestExit) {
+        memset(slab.ptr, kSmallFreeFill, slab.size);
+      }
+      m_retainedSlabs.push_back(slab);
+      continue;
+    }
+    do_free(slab.ptr, slab.size);
+  }
   m_slabs.clear();
   for (auto n : m_bigs) do_free(n, n->nbytes);
   m_bigs.clear();
@@ -1055,11 +1250,27 @@ void BigHeap::reset() {
 
 void BigHeap::flush() {
   assert(empty());
+  for (auto slab : m_retainedSlabs) {
+#ifdef USE_JEMALLOC
+    dallocx(slab.ptr, 0);
+#else
+    free(slab.ptr);
+#endif
+  }
+  m_retainedSlabs = std::vector<MemBlock>{};
   m_slabs = std::vector<MemBlock>{};
   m_bigs = std::vector<MallocNode*>{};
 }
 
 MemBlock BigHeap::allocSlab(size_t size, MemoryUsageStats& stats) {
+  if (!m_retainedSlabs.empty() && size == kSlabSize) {
+    auto const slab = m_retainedSlabs.back();
+    m_retainedSlabs.pop_back();
+    m_slabs.push_back(slab);
+    stats.capacity += slab.size;
+    stats.peakCap = std::max(stats.peakCap, stats.capacity);
+    return slab;
+  }
 #ifdef USE_JEMALLOC
   void* slab = mallocx(size, 0);
   auto usable = sallocx(slab, 0);
@@ -1067,6 +1278,11 @@ MemBlock BigHeap::allocSlab(size_t size, MemoryUsageStats& stats) {
   void* slab = safe_malloc(size);
   auto usable = size;
 #endif
+  // Keep the request heap node-local: worker threads are pinned to numa
+  // nodes in AsyncFunc::threadFuncImpl, so bind fresh slabs to the node
+  // this thread runs on. Retained slabs never migrate between threads,
+  // so the pool above stays local without extra bookkeeping.
+  numa_bind_to(slab, size, s_numaNode);
   m_slabs.push_back({slab, size});
   stats.capacity += usable;
   stats.peakCap = std::max(stats.peakCap, stats.capacity);
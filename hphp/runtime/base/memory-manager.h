@@ -18,6 +18,8 @@
 #define incl_HPHP_MEMORY_MANAGER_H_
 
 #include <array>
+#include <functional>
+#include <string>
 #include <vector>
 #include <utility>
 #include <set>
@@ -44,6 +46,8 @@
 namespace HPHP {
 
 struct APCLocalArray;
+struct ArrayData;
+struct Class;
 struct MemoryManager;
 struct ObjectData;
 struct ResourceData;
@@ -552,6 +556,11 @@ struct BigHeap {
  protected:
   std::vector<MemBlock> m_slabs;
   std::vector<MallocNode*> m_bigs;
+
+  // Full-size slabs kept mapped (and faulted in) across requests, up
+  // to Eval.SlabRetainLimit; allocSlab() consumes these before going
+  // back to the underlying allocator.
+  std::vector<MemBlock> m_retainedSlabs;
 };
 
 /*
@@ -955,6 +964,25 @@ struct MemoryManager {
   template<class Fn> void sweepApcArrays(Fn fn);
   template<class Fn> void sweepApcStrings(Fn fn);
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Deferred release.
+
+  /*
+   * When Eval.DeferArrayRelease is set, arrays whose refcount hits zero
+   * on the generic decref paths are queued here instead of being
+   * destroyed inline, and the queue is drained at the next surprise
+   * check (see handle_request_surprise).  Releasing an array during the
+   * drain queues its nested arrays through the same path, so a big tree
+   * unwinds iteratively off the critical path that dropped the root.
+   *
+   * deferArrayRelease() takes ownership of `ad', whose count is zero.
+   * drainDeferredReleases() destroys everything queued, including
+   * entries added while it runs.
+   */
+  void deferArrayRelease(ArrayData* ad);
+  void drainDeferredReleases();
+  bool hasDeferredReleases() const { return !m_deferredReleases.empty(); }
+
   /////////////////////////////////////////////////////////////////////////////
   // Request profiling.
 
@@ -974,6 +1002,18 @@ struct MemoryManager {
    */
   void setMemThresholdCallback(size_t threshold);
 
+  /*
+   * Register a one-shot native callback to run the first time request usage
+   * reaches `threshold' bytes.  The continuously-maintained usage counter is
+   * compared against the lowest outstanding threshold on the slab refill
+   * path, so detection costs one compare per slab rather than a stats poll.
+   *
+   * Callbacks run inside the allocator: they must not allocate request
+   * memory or run PHP code.  Set a surprise flag for anything heavier.
+   * All registrations are dropped at request end.
+   */
+  void addUsageThresholdCallback(size_t threshold, std::function<void()> fn);
+
   /*
    * Do per-request initialization.
    *
@@ -998,6 +1038,28 @@ struct MemoryManager {
   static void setupProfiling();
   static void teardownProfiling();
 
+  /*
+   * Sampling allocation profiler.
+   *
+   * When an interval is set, roughly every `interval' bytes allocated
+   * through the request heap records one sample attributed to the
+   * currently executing function and the allocation's size class, into a
+   * process-wide table.  Threads pick up interval changes at their next
+   * requestInit(), so the disabled fast path costs a single compare per
+   * allocation.  Samples survive requests; the admin server exposes
+   * enable/disable/dump.
+   */
+  struct AllocSampleRow {
+    std::string func;
+    size_t sizeClass;
+    uint64_t samples;
+    uint64_t bytes;
+  };
+  static void setAllocSamplingInterval(int64_t bytes); // 0 disables
+  static int64_t allocSamplingInterval();
+  static std::vector<AllocSampleRow> getAllocSamples();
+  static void clearAllocSamples();
+
   /////////////////////////////////////////////////////////////////////////////
   // Garbage collection.
 
@@ -1017,6 +1079,21 @@ struct MemoryManager {
   bool isGCEnabled();
   void setGCEnabled(bool isGCEnabled);
 
+  /*
+   * Per-class live-object counters, refreshed by each collection's sweep
+   * pass when Eval.GCClassCounters is set. Bytes are per-allocation heap
+   * sizes, not objprof's deep sizes, and reflect the heap as of the most
+   * recent collection in this request. hasGCClassCounts() is false until
+   * a collection has run with the counters enabled.
+   */
+  struct ClassCount {
+    const Class* cls;
+    uint64_t instances;
+    uint64_t bytes;
+  };
+  static bool hasGCClassCounts();
+  static std::vector<ClassCount> getGCClassCounts();
+
   struct FreeList {
     void* maybePop();
     void push(void*);
@@ -1074,6 +1151,7 @@ private:
   void* newSlab(uint32_t nbytes);
   void* mallocSmallSizeSlow(size_t bytes, size_t index);
   void  updateBigStats();
+  void  recordAllocSample(size_t sizeClassBytes);
 
   static size_t bsrq(size_t x);
 
@@ -1082,6 +1160,7 @@ private:
   void refreshStats();
   void refreshStatsImpl(MemoryUsageStats& stats);
   void refreshStatsHelperExceeded();
+  void checkUsageThresholds();
   void resetAllStats();
   void traceStats(const char* when);
 
@@ -1099,14 +1178,19 @@ private:
 
   void* m_front{nullptr};
   void* m_limit{nullptr};
+  // Bytes left until the next allocation sample; 0 means sampling is off
+  // for this thread.
+  int64_t m_allocSampleCountdown{0};
   FreelistArray m_freelists;
   StringDataNode m_strings; // in-place node is head of circular list
   std::vector<APCLocalArray*> m_apc_arrays;
   int64_t m_nextGc; // request gc when heap usage reaches this size
+  int64_t m_gcTriggerScale{1}; // backoff multiplier when gc reclaims little
   int64_t m_usageLimit; // OOM when m_stats.usage() > m_usageLimit
   MemoryUsageStats m_stats;
   HeapImpl m_heap;
   std::vector<NativeNode*> m_natives;
+  std::vector<ArrayData*> m_deferredReleases;
   SweepableList m_sweepables;
 
   mutable std::vector<req::root_handle*> m_root_handles;
@@ -1124,6 +1208,12 @@ private:
   // Peak memory threshold callback (installed via setMemThresholdCallback)
   size_t m_memThresholdCallbackPeakUsage{SIZE_MAX};
 
+  // One-shot usage threshold callbacks (installed via
+  // addUsageThresholdCallback); m_nextUsageThreshold caches the lowest
+  // outstanding threshold for the per-slab check.
+  std::vector<std::pair<size_t, std::function<void()>>> m_usageThresholds;
+  size_t m_nextUsageThreshold{SIZE_MAX};
+
   static void* TlsInitSetup;
 
   // pointers to jemalloc-maintained allocation counters
@@ -1144,6 +1234,17 @@ private:
 
 //////////////////////////////////////////////////////////////////////
 
+/*
+ * Destructor-table/JIT entry point for deferred array release: queues
+ * `ptr' (an ArrayData whose count just hit zero) on the current
+ * thread's MemoryManager.  Installed over the array entries of
+ * g_destructors, and emitted by decref lowering, when
+ * Eval.DeferArrayRelease is set.
+ */
+void deferredReleaseArray(void* ptr);
+
+//////////////////////////////////////////////////////////////////////
+
 }
 
 #include "hphp/runtime/base/memory-manager-inl.h"
@@ -188,6 +188,95 @@ MixedArray* MixedArray::MakeStruct(uint32_t size, const StringData* const* keys,
   return ad;
 }
 
+struct MixedArray::StructLayout {
+  struct Key {
+    const StringData* key;
+    strhash_t hash;
+  };
+
+  uint32_t size;
+  uint32_t scale;
+
+  // Trailing data: HashSize(scale) hash-table entries, then `size' keys.
+  const int32_t* table() const {
+    return reinterpret_cast<const int32_t*>(this + 1);
+  }
+  const Key* keys() const {
+    return reinterpret_cast<const Key*>(table() + HashSize(scale));
+  }
+};
+
+const MixedArray::StructLayout*
+MixedArray::MakeStructLayout(uint32_t size, const StringData* const* keys) {
+  assert(size > 0);
+
+  auto const scale = computeScaleFromSize(size);
+  auto const layout = static_cast<StructLayout*>(
+    malloc(sizeof(StructLayout) +
+           HashSize(scale) * sizeof(int32_t) +
+           size * sizeof(StructLayout::Key))
+  );
+  layout->size  = size;
+  layout->scale = scale;
+
+  auto const table = const_cast<int32_t*>(layout->table());
+  auto const lkeys = const_cast<StructLayout::Key*>(layout->keys());
+  InitHash(table, scale);
+  auto const mask = Mask(scale);
+
+  for (uint32_t i = 0; i < size; i++) {
+    assert(keys[i]->isStatic());
+    auto const h = keys[i]->hash();
+    lkeys[i].key  = keys[i];
+    lkeys[i].hash = h;
+    // Same quadratic probe as findForNewInsert().  Keys are distinct
+    // static strings, so we only ever stop on an empty slot.
+    uint64_t probe = (uint32_t)h & mask;
+    for (uint64_t j = 1; validPos(table[probe]); ++j) {
+      probe = (probe + j) & mask;
+    }
+    table[probe] = i;
+  }
+  return layout;
+}
+
+MixedArray* MixedArray::MakeStructFromLayout(const StructLayout* layout,
+                                             const TypedValue* values) {
+  auto const size  = layout->size;
+  auto const scale = layout->scale;
+  auto const ad    = reqAlloc(scale);
+
+  ad->m_sizeAndPos       = size; // pos=0
+  ad->initHeader(HeaderKind::Mixed, 1);
+  ad->m_scale_used       = scale | uint64_t{size} << 32; // used=size
+  ad->m_nextKI           = 0;
+
+  CopyHash(ad->hashTab(), layout->table(), scale);
+
+  // Append values by moving -- Caller assumes we update refcount.
+  // Values are in reverse order since they come from the stack, which
+  // grows down.
+  auto const data = ad->data();
+  auto const lkeys = layout->keys();
+  for (uint32_t i = 0; i < size; i++) {
+    data[i].setStaticKey(const_cast<StringData*>(lkeys[i].key),
+                         lkeys[i].hash);
+    const auto& tv = values[size - i - 1];
+    data[i].data.m_data = tv.m_data;
+    data[i].data.m_type = tv.m_type;
+  }
+
+  assert(ad->m_size == size);
+  assert(ad->m_pos == 0);
+  assert(ad->kind() == kMixedKind);
+  assert(ad->m_scale == scale);
+  assert(ad->hasExactlyOneRef());
+  assert(ad->m_used == size);
+  assert(ad->m_nextKI == 0);
+  assert(ad->checkInvariants());
+  return ad;
+}
+
 MixedArray* MixedArray::MakeMixed(uint32_t size,
                                   const TypedValue* keysAndValues) {
   assert(size > 0);
@@ -332,7 +421,8 @@ ArrayData* MixedArray::MakeUncounted(ArrayData* array, size_t extra) {
   auto const scale = a->scale();
   auto const allocSize = extra + computeAllocBytes(scale);
   auto const mem = static_cast<char*>(
-    UncountedMixedArrayOnHugePage() ? malloc_huge(allocSize) : malloc(allocSize)
+    UncountedMixedArrayOnHugePage() ? malloc_huge(allocSize)
+                                    : shared_malloc(allocSize)
   );
   auto const ad = reinterpret_cast<MixedArray*>(mem + extra);
   auto const used = a->m_used;
@@ -432,7 +522,7 @@ void MixedArray::ReleaseUncounted(ArrayData* in, size_t extra) {
   if (UncountedMixedArrayOnHugePage()) {
     free_huge(reinterpret_cast<char*>(ad) - extra);
   } else {
-    free(reinterpret_cast<char*>(ad) - extra);
+    shared_free(reinterpret_cast<char*>(ad) - extra);
   }
   if (APCStats::IsCreated()) {
     APCStats::getAPCStats().removeAPCUncountedBlock();
@@ -1884,6 +1974,103 @@ void MixedArray::MemoSet(TypedValue* startBase,
   p.found ? cellSet(val, *tvAssertCell(&p.tv)) : cellDup(val, p.tv);
 }
 
+Cell MixedArray::MemoGetIntKey(const TypedValue* base,
+                               const Cell* keys,
+                               uint32_t nkeys) {
+  assertx(nkeys == 1);
+  assertx(keys->m_type == KindOfInt64);
+
+  auto const arr = tvToCell(base);
+  assertx(cellIsPlausible(*arr));
+  assertx(tvIsDict(arr));
+  auto const ad = asMixed(arr->m_data.parr);
+  assertx(ad->isDict());
+
+  auto const idx = keys->m_data.num;
+  auto const pos = ad->find(idx, hash_int64(idx));
+  if (UNLIKELY(!validPos(pos))) return make_tv<KindOfUninit>();
+  Cell out;
+  cellDup(ad->data()[pos].data, out);
+  assertx(cellIsPlausible(out));
+  return out;
+}
+
+Cell MixedArray::MemoGetStrKey(const TypedValue* base,
+                               const Cell* keys,
+                               uint32_t nkeys) {
+  assertx(nkeys == 1);
+  assertx(tvIsString(keys));
+
+  auto const arr = tvToCell(base);
+  assertx(cellIsPlausible(*arr));
+  assertx(tvIsDict(arr));
+  auto const ad = asMixed(arr->m_data.parr);
+  assertx(ad->isDict());
+
+  auto const str = keys->m_data.pstr;
+  auto const pos = ad->find(str, str->hash());
+  if (UNLIKELY(!validPos(pos))) return make_tv<KindOfUninit>();
+  Cell out;
+  cellDup(ad->data()[pos].data, out);
+  assertx(cellIsPlausible(out));
+  return out;
+}
+
+namespace {
+
+// Shared tail of the single-key MemoSet variants: cow the cache dict if
+// needed (updating the base), then store the value at the insert position
+// found by the caller-supplied probe.
+template <typename Insert>
+ALWAYS_INLINE
+void memoSetOneImpl(TypedValue* startBase, Cell val, Insert insert) {
+  assertx(cellIsPlausible(val));
+
+  auto const base = tvToCell(startBase);
+  assertx(cellIsPlausible(*base));
+  assertx(tvIsDict(base));
+
+  auto current = MixedArray::MemoPrepare(
+    base,
+    tvIsDict(&val) ? val.m_data.parr : nullptr
+  );
+  auto const p = insert(current);
+  p.found ? cellSet(val, *tvAssertCell(&p.tv)) : cellDup(val, p.tv);
+}
+
+}
+
+MixedArray* MixedArray::MemoPrepare(Cell* base, const ArrayData* val) {
+  auto const current = asMixed(base->m_data.parr);
+  assertx(current->isDict());
+  auto const copied =
+    current->prepareForInsert(current->cowCheck() || val == current);
+  if (copied != current) {
+    cellMove(make_tv<KindOfDict>(copied), *base);
+  }
+  return copied;
+}
+
+void MixedArray::MemoSetIntKey(TypedValue* startBase,
+                               const Cell* keys, uint32_t nkeys,
+                               Cell val) {
+  assertx(nkeys == 1);
+  assertx(keys->m_type == KindOfInt64);
+  memoSetOneImpl(startBase, val, [&](MixedArray* a) {
+    return a->insert(keys->m_data.num);
+  });
+}
+
+void MixedArray::MemoSetStrKey(TypedValue* startBase,
+                               const Cell* keys, uint32_t nkeys,
+                               Cell val) {
+  assertx(nkeys == 1);
+  assertx(tvIsString(keys));
+  memoSetOneImpl(startBase, val, [&](MixedArray* a) {
+    return a->insert(keys->m_data.pstr);
+  });
+}
+
 /////////////////////////////////////////////////////////////////////
 
 }
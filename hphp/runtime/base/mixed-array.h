@@ -231,6 +231,19 @@ struct MixedArray final : ArrayData,
   static MixedArray* MakeStruct(uint32_t size, const StringData* const* keys,
                                const TypedValue* values);
 
+  /*
+   * A StructLayout captures the key shape of a MakeStruct array: the
+   * scale, the fully-probed hash table, and the static keys with their
+   * hashes.  The JIT builds one per NewStructArray translation, so the
+   * runtime helper just copies the table and stores the values; no
+   * hashing or probing happens per construction.
+   */
+  struct StructLayout;
+  static const StructLayout* MakeStructLayout(uint32_t size,
+                                              const StringData* const* keys);
+  static MixedArray* MakeStructFromLayout(const StructLayout* layout,
+                                          const TypedValue* values);
+
   /*
    * Allocate an uncounted MixedArray and copy the values from the
    * input 'array' into the uncounted one. All values copied are made
@@ -269,6 +282,25 @@ struct MixedArray final : ArrayData,
   static Cell MemoGet(const TypedValue*, const Cell*, uint32_t);
   static void MemoSet(TypedValue*, const Cell*, uint32_t, Cell);
 
+  /*
+   * Specialized single-key variants of MemoGet/MemoSet, used by the JIT
+   * when a memoize wrapper has exactly one key whose type is known at
+   * translation time. These have the same signatures as the generic
+   * versions (so the call lowering is shared), but skip the nested-dict
+   * walk and the per-key type dispatch.
+   */
+  static Cell MemoGetIntKey(const TypedValue*, const Cell*, uint32_t);
+  static Cell MemoGetStrKey(const TypedValue*, const Cell*, uint32_t);
+  static void MemoSetIntKey(TypedValue*, const Cell*, uint32_t, Cell);
+  static void MemoSetStrKey(TypedValue*, const Cell*, uint32_t, Cell);
+
+  /*
+   * Helper for the single-key MemoSet variants: cow the cache dict at the
+   * given base if needed (also when val aliases it), updating the base in
+   * place, and return the writable array.
+   */
+  static MixedArray* MemoPrepare(Cell* base, const ArrayData* val);
+
   using ArrayData::decRefCount;
   using ArrayData::hasMultipleRefs;
   using ArrayData::hasExactlyOneRef;
@@ -533,9 +565,11 @@ public:
   static void IterateV(const MixedArray* arr, F fn) {
     assert(arr->hasMixedLayout());
     auto elm = arr->data();
+    auto const end = elm + arr->m_used;
     if (inc) arr->incRefCount();
     SCOPE_EXIT { if (inc) decRefArr(const_cast<MixedArray*>(arr)); };
     for (auto i = arr->m_used; i--; elm++) {
+      prefetchElm(elm, end);
       if (LIKELY(!elm->isTombstone())) {
         if (ArrayData::call_helper(fn, elm->data)) break;
       }
@@ -545,9 +579,11 @@ public:
   static void IterateKV(const MixedArray* arr, F fn) {
     assert(arr->hasMixedLayout());
     auto elm = arr->data();
+    auto const end = elm + arr->m_used;
     if (inc) arr->incRefCount();
     SCOPE_EXIT { if (inc) decRefArr(const_cast<MixedArray*>(arr)); };
     for (auto i = arr->m_used; i--; elm++) {
+      prefetchElm(elm, end);
       if (LIKELY(!elm->isTombstone())) {
         TypedValue key;
         key.m_data.num = elm->ikey;
@@ -557,6 +593,23 @@ public:
     }
   }
 
+  /*
+   * The element slab itself streams in linearly under the hardware
+   * prefetcher; bulk iteration stalls on chasing the key and value
+   * payloads.  Warm those a few elements ahead of the visit.
+   */
+  static constexpr uint32_t kIterPrefetchDist = 4;
+  ALWAYS_INLINE
+  static void prefetchElm(const Elm* elm, const Elm* end) {
+    auto const pf = elm + kIterPrefetchDist;
+    if (pf < end && !pf->isTombstone()) {
+      if (pf->hasStrKey()) __builtin_prefetch(pf->skey);
+      if (isRefcountedType(pf->data.m_type)) {
+        __builtin_prefetch(pf->data.m_data.pstr);
+      }
+    }
+  }
+
 private:
   static Cell getElmKey(const Elm& e);
 
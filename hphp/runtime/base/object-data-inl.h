@@ -137,7 +137,7 @@ inline void ObjectData::instanceInit(Class* cls) {
         memcpy16_inline(propVec(),
                         &(*propInitVec)[0], nProps * sizeof(TypedValue));
       } else {
-        deepInitHelper(propVec(), &(*propInitVec)[0], nProps);
+        deepInitHelper(propVec(), &(*propInitVec)[0], nProps, cls);
       }
     } else {
       assert(nProps == cls->declPropInit().size());
@@ -24,6 +24,7 @@
 #include "hphp/runtime/base/externals.h"
 #include "hphp/runtime/base/runtime-error.h"
 #include "hphp/runtime/base/req-containers.h"
+#include "hphp/runtime/base/tv-comparisons.h"
 #include "hphp/runtime/base/tv-refcount.h"
 #include "hphp/runtime/base/tv-type.h"
 #include "hphp/runtime/base/variable-serializer.h"
@@ -44,6 +45,8 @@
 
 #include "hphp/system/systemlib.h"
 
+#include "hphp/util/word-mem.h"
+
 #include <folly/Hash.h>
 #include <folly/ScopeGuard.h>
 
@@ -770,13 +773,34 @@ ObjectData* ObjectData::clone() {
   Object clone = Object::attach(obj);
   auto const nProps = m_cls->numDeclProperties();
   auto const clonePropVec = clone->propVec();
-  auto const props = m_cls->declProperties();
-  for (auto i = Slot{0}; i < nProps; i++) {
-    if (props[i].attrs & AttrNoSerialize) {
-      continue;
+  if (nProps > 0 && !m_cls->hasNoSerializeProps()) {
+    // Every slot is copied: drop the freshly-initialized values (only
+    // deep-init slots are actually counted), bulk-copy the property image,
+    // then bump refcounts in a second pass.
+    for (auto i = Slot{0}; i < nProps; ++i) {
+      tvDecRefGen(&clonePropVec[i]);
+    }
+    memcpy16_inline(clonePropVec, propVec(), nProps * sizeof(TypedValue));
+    for (auto i = Slot{0}; i < nProps; ++i) {
+      auto const tv = &clonePropVec[i];
+      if (UNLIKELY(tv->m_type == KindOfRef)) {
+        // tvDupWithRef decides whether the ref is preserved or its value
+        // copied; redo this slot from the source (the raw copy took no
+        // refcount, so nothing to release).
+        tvDupWithRef(propVec()[i], *tv);
+      } else {
+        tvIncRefGen(tv);
+      }
+    }
+  } else {
+    auto const props = m_cls->declProperties();
+    for (auto i = Slot{0}; i < nProps; i++) {
+      if (props[i].attrs & AttrNoSerialize) {
+        continue;
+      }
+      tvDecRefGen(&clonePropVec[i]);
+      tvDupWithRef(propVec()[i], clonePropVec[i]);
     }
-    tvDecRefGen(&clonePropVec[i]);
-    tvDupWithRef(propVec()[i], clonePropVec[i]);
   }
   if (UNLIKELY(getAttribute(HasDynPropArr))) {
     clone->setAttribute(HasDynPropArr);
@@ -820,6 +844,26 @@ bool ObjectData::equal(const ObjectData& other) const {
     // First comparison already proves they are different
     return false;
   }
+  if (!m_cls->hasNoSerializeProps() &&
+      !getAttribute(HasDynPropArr) && !other.getAttribute(HasDynPropArr)) {
+    // Same class and no dynamic properties: compare the declared property
+    // vectors slot by slot instead of materializing array copies.
+    auto const nProps = m_cls->numDeclProperties();
+    auto const lhsProps = propVec();
+    auto const rhsProps = other.propVec();
+    for (auto i = Slot{0}; i < nProps; ++i) {
+      auto const& tv1 = lhsProps[i];
+      auto const& tv2 = rhsProps[i];
+      if (tv1.m_type == KindOfUninit || tv2.m_type == KindOfUninit) {
+        // Unset properties are absent from the array representation, so
+        // both must be unset to compare equal.
+        if (tv1.m_type != tv2.m_type) return false;
+        continue;
+      }
+      if (!tvEqual(tv1, tv2)) return false;
+    }
+    return true;
+  }
   return toArray()->equal(other.toArray().get(), false);
 }
 
@@ -898,16 +942,16 @@ const StaticString
   s___wakeup("__wakeup");
 
 void deepInitHelper(TypedValue* propVec, const TypedValueAux* propData,
-                    size_t nProps) {
-  auto* dst = propVec;
-  auto* src = propData;
-  for (; src != propData + nProps; ++src, ++dst) {
-    *dst = *src;
-    // m_aux.u_deepInit is true for properties that need "deep" initialization
-    if (src->deepInit()) {
-      tvIncRefGen(dst);
-      collections::deepCopy(dst);
-    }
+                    size_t nProps, const Class* cls) {
+  // Copy the whole image in one shot, then fix up only the slots that need
+  // "deep" initialization; everything else was promoted to static by
+  // initProps() and needs no refcounting.
+  memcpy16_inline(propVec, propData, nProps * sizeof(TypedValue));
+  for (auto const slot : cls->deepInitSlots()) {
+    auto const tv = &propVec[slot];
+    assert(propData[slot].deepInit());
+    tvIncRefGen(tv);
+    collections::deepCopy(tv);
   }
 }
 
@@ -57,7 +57,7 @@ struct TypedValue;
 #define INVOKE_FEW_ARGS_DECL_ARGS INVOKE_FEW_ARGS(DECL,INVOKE_FEW_ARGS_COUNT)
 
 void deepInitHelper(TypedValue* propVec, const TypedValueAux* propData,
-                    size_t nProps);
+                    size_t nProps, const Class* cls);
 
 struct InvokeResult {
   TypedValue val;
@@ -294,6 +294,19 @@ bool PackedArray::CopyPackedHelper(const ArrayData* adIn, ArrayData* ad) {
 
   // Copy counted types correctly, especially RefData.
   for (auto elm = packedData(ad), end = elm + size; elm < end; ++elm) {
+    // Skip over whole blocks with no refcounted member (the common case
+    // for feeds of ints, doubles, and persistent strings).  All the
+    // refcounted types (including KindOfRef) compare greater than the
+    // threshold, so a max over the block is a single well-predicted
+    // branch per four elements; the payload copy above already went
+    // through the vectorized memcpy16_inline kernel.
+    while (elm + 4 <= end &&
+           !isRefcountedType(std::max(std::max(elm[0].m_type, elm[1].m_type),
+                                      std::max(elm[2].m_type,
+                                               elm[3].m_type)))) {
+      elm += 4;
+    }
+    if (elm == end) break;
     if (UNLIKELY(elm->m_type == KindOfRef)) {
       assert(!adIn->isVecArray());
       auto ref = elm->m_data.pref;
@@ -335,6 +348,47 @@ ArrayData* PackedArray::Copy(const ArrayData* adIn) {
   return ad;
 }
 
+ArrayData* PackedArray::Slice(const ArrayData* adIn, uint32_t offset,
+                              uint32_t len) {
+  assert(checkInvariants(adIn));
+  assert(len > 0);
+  assert(offset + len <= adIn->m_size);
+
+  auto const ad = MakeReserve(len);
+  ad->m_sizeAndPos = len; // pos=0
+
+  auto const data = packedData(ad);
+  memcpy16_inline(data, packedData(adIn) + offset, size_t{len} * 16);
+
+  // Same refcount maintenance as CopyPackedHelper: blocks with no
+  // refcounted member are skipped, and unreferenced refs are flattened
+  // as tvDupWithRef would.
+  for (auto elm = data, end = elm + len; elm < end; ++elm) {
+    while (elm + 4 <= end &&
+           !isRefcountedType(std::max(std::max(elm[0].m_type, elm[1].m_type),
+                                      std::max(elm[2].m_type,
+                                               elm[3].m_type)))) {
+      elm += 4;
+    }
+    if (elm == end) break;
+    if (UNLIKELY(elm->m_type == KindOfRef)) {
+      auto ref = elm->m_data.pref;
+      if (!ref->isReferenced() && ref->tv()->m_data.parr != adIn) {
+        cellDup(*ref->tv(), *elm);
+        continue;
+      }
+    }
+    tvIncRefGen(elm);
+  }
+
+  assert(ad->isPacked());
+  assert(ad->m_size == len);
+  assert(ad->m_pos == 0);
+  assert(ad->hasExactlyOneRef());
+  assert(checkInvariants(ad));
+  return ad;
+}
+
 ArrayData* PackedArray::CopyStatic(const ArrayData* adIn) {
   assert(checkInvariants(adIn));
 
@@ -111,6 +111,15 @@ struct PackedArray final : type_scan::MarkCountable<PackedArray> {
   static bool AdvanceMArrayIter(ArrayData*, MArrayIter& fp);
   static ArrayData* Copy(const ArrayData* ad);
   static ArrayData* CopyStatic(const ArrayData*);
+
+  /*
+   * Make a new packed array holding a copy of [offset, offset+len) of
+   * `adIn'.  The slice is bulk-copied; only refcounted elements in the
+   * range are touched afterwards.  Pre: len > 0 and the range is within
+   * adIn's size.
+   */
+  static ArrayData* Slice(const ArrayData* adIn, uint32_t offset,
+                          uint32_t len);
   static ArrayData* EscalateForSort(ArrayData*, SortFunction);
   static void Ksort(ArrayData*, int, bool);
   static void Sort(ArrayData*, int, bool);
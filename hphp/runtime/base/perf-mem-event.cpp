@@ -35,6 +35,7 @@
 #include "hphp/runtime/vm/vm-regs.h"
 
 #include "hphp/runtime/vm/jit/mcgen.h"
+#include "hphp/runtime/vm/jit/perf-jit-profile.h"
 #include "hphp/runtime/vm/jit/tc.h"
 #include "hphp/runtime/vm/jit/tc-internal.h"
 
@@ -366,6 +367,9 @@ void record_perf_mem_event(PerfEvent kind, const perf_event_sample* sample) {
   perf_event_pause();
   SCOPE_EXIT { perf_event_resume(); };
 
+  // Attribute the sample to the translation its IP hit, if any.
+  recordPerfJitSample(kind, sample);
+
   auto const addr = reinterpret_cast<const void*>(sample->addr);
 
   auto record = StructuredLogEntry{};
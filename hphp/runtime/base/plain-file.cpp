@@ -16,9 +16,12 @@
 #include "hphp/runtime/base/plain-file.h"
 
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "hphp/runtime/base/request-local.h"
+#include "hphp/runtime/base/runtime-option.h"
 
 #include <folly/portability/Fcntl.h>
 #include <folly/portability/Stdio.h>
@@ -176,10 +179,60 @@ int PlainFile::getc() {
   return File::getc();
 }
 
-// This definition is needed to avoid triggering a gcc compiler error about
-// an overloaded virtual when only overriding the one parameter version from
-// File.
+// The zero parameter version of read() must be defined here as well to avoid
+// triggering a gcc compiler error about an overloaded virtual when only
+// overriding the one parameter version from File.
 String PlainFile::read() {
+  // Fast path: for an unfiltered regular file we can size the result from
+  // fstat() and read into a single allocation, instead of growing a
+  // StringBuffer one chunk at a time.  Buffered read-ahead from an earlier
+  // partial read and user stream filters take the generic path.
+  if (getFd() >= 0 && bufferedLen() == 0 && !hasReadFilters()) {
+    struct stat sb;
+    auto const pos = ::lseek(getFd(), 0, SEEK_CUR);
+    if (pos != (off_t)-1 && ::fstat(getFd(), &sb) == 0 &&
+        S_ISREG(sb.st_mode) && sb.st_size > pos &&
+        sb.st_size - pos < StringData::MaxSize) {
+      auto const remaining = int64_t(sb.st_size - pos);
+      String s(remaining, ReserveString);
+      auto const buf = s.mutableData();
+      int64_t copied = 0;
+
+      // For large files, optionally copy straight out of the page cache
+      // instead of issuing read(2)s.  Off by default: a file truncated while
+      // we're copying turns the loads into SIGBUS, where the read path just
+      // returns short.
+      auto const threshold = RuntimeOption::EvalFileReadMmapThreshold;
+      if (threshold > 0 && remaining >= (int64_t)threshold) {
+        auto const pageSize = sysconf(_SC_PAGESIZE);
+        auto const mapOff = pos & ~off_t(pageSize - 1);
+        auto const delta = size_t(pos - mapOff);
+        auto const base = ::mmap(nullptr, remaining + delta, PROT_READ,
+                                 MAP_SHARED, getFd(), mapOff);
+        if (base != MAP_FAILED) {
+          memcpy(buf, (const char*)base + delta, remaining);
+          ::munmap(base, remaining + delta);
+          // mmap doesn't consume the descriptor offset; catch it up.
+          ::lseek(getFd(), pos + remaining, SEEK_SET);
+          copied = remaining;
+        }
+      }
+
+      while (copied < remaining) {
+        auto const n = ::read(getFd(), buf + copied, remaining - copied);
+        if (n <= 0) {
+          if (n < 0 && errno == EINTR) continue;
+          break;
+        }
+        copied += n;
+      }
+
+      s.setSize(copied);
+      setPosition(getPosition() + copied);
+      if (copied == remaining) setEof(true);
+      return s;
+    }
+  }
   return File::read();
 }
 
@@ -198,6 +251,43 @@ int64_t PlainFile::writeImpl(const char *buffer, int64_t length) {
   return written < 0 ? 0 : written;
 }
 
+int64_t PlainFile::writevImpl(const iovec* iov, int count) {
+  assert(valid());
+  assert(count > 0);
+
+  // Stack batch, so a partially written element can be adjusted without
+  // touching the caller's array.
+  constexpr int kMaxIovecs = 64;
+  iovec batch[kMaxIovecs];
+
+  int64_t total = 0;
+  int i = 0;
+  size_t off = 0;  // bytes of iov[i] already written
+  while (i < count) {
+    int n = 0;
+    for (int j = i; j < count && n < kMaxIovecs; ++j, ++n) {
+      auto const skip = j == i ? off : 0;
+      batch[n].iov_base = (char*)iov[j].iov_base + skip;
+      batch[n].iov_len = iov[j].iov_len - skip;
+    }
+    auto const written = ::writev(getFd(), batch, n);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (written == 0) break;
+    total += written;
+    auto advance = size_t(written);
+    while (i < count && advance >= iov[i].iov_len - off) {
+      advance -= iov[i].iov_len - off;
+      ++i;
+      off = 0;
+    }
+    off += advance;
+  }
+  return total;
+}
+
 bool PlainFile::seek(int64_t offset, int whence /* = SEEK_SET */) {
   assert(valid());
 
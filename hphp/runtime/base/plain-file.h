@@ -51,6 +51,7 @@ struct PlainFile : File {
   String read() override;
   String read(int64_t length) override;
   int64_t writeImpl(const char *buffer, int64_t length) override;
+  int64_t writevImpl(const iovec* iov, int count) override;
   bool seekable() override { return true;}
   bool seek(int64_t offset, int whence = SEEK_SET) override;
   int64_t tell() override;
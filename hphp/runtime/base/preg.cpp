@@ -21,6 +21,7 @@
 #include <mutex>
 #include <pcre.h>
 #include <onigposix.h>
+#include <unordered_map>
 #include <utility>
 
 #include <folly/AtomicHashArray.h>
@@ -48,6 +49,7 @@
 
 #include "hphp/compiler/json.h"
 
+#include "hphp/util/functional.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/concurrent-scalable-cache.h"
 
@@ -179,6 +181,19 @@ public:
       return m_u.smart_ptr;
     }
 
+    // The entry's shared owner, if it has one. Static-cache entries are
+    // owned by the table itself (and kept alive by the treadmill after a
+    // clear), so they return null here.
+    EntryPtr ownedPtr() const {
+      switch (m_kind) {
+        case Kind::Empty:
+        case Kind::Ptr:          return nullptr;
+        case Kind::SmartPtr:     return m_u.smart_ptr;
+        case Kind::AccessorKind: return *m_u.accessor;
+      }
+      always_assert(false);
+    }
+
    private:
     enum class Kind : uint8_t {
       Empty,
@@ -244,6 +259,23 @@ static PCRECache s_pcreCache;
 // The last pcre error code is available for the whole thread.
 static __thread int tl_last_error_code;
 
+// A request-local view of the shared pattern cache, so a loop matching
+// the same pattern touches no shared state after its first iteration.
+// Only static pattern strings are cached: their pointers are stable for
+// the process lifetime, which makes lookups a pointer-keyed hash probe
+// with no string comparison. Entries either carry a shared owner in
+// the guard, or point into the static cache, whose tables outlive every
+// in-flight request via the treadmill. Flushed by pcre_session_exit()
+// at the end of each request, so nothing dangles across requests.
+struct LocalCacheEntry {
+  const pcre_cache_entry* entry;
+  PCRECache::EntryPtr guard;
+};
+using LocalPCRECache =
+  std::unordered_map<const StringData*, LocalCacheEntry,
+                     pointer_hash<StringData>>;
+static __thread LocalPCRECache* tl_localCache;
+
 ///////////////////////////////////////////////////////////////////////////////
 // pcre_cache_entry implementation
 
@@ -571,6 +603,11 @@ void pcre_reinit() {
 void pcre_init() {
 }
 
+void pcre_session_exit() {
+  delete tl_localCache;
+  tl_localCache = nullptr;
+}
+
 void pcre_dump_cache(const std::string& filename) {
   s_pcreCache.dump(filename);
 }
@@ -685,14 +722,34 @@ static bool get_pcre_fullinfo(pcre_cache_entry* pce) {
   return true;
 }
 
+static void pcre_cache_locally(PCRECache::Accessor& accessor,
+                               const StringData* regex) {
+  assert(regex->isStatic());
+  if (!tl_localCache) tl_localCache = new LocalPCRECache();
+  (*tl_localCache)[regex] = LocalCacheEntry{accessor.get(),
+                                            accessor.ownedPtr()};
+}
+
 static bool
 pcre_get_compiled_regex_cache(PCRECache::Accessor& accessor,
                               const StringData* regex) {
   PCRECache::TempKeyCache tkc;
 
+  /* A literal pattern's StringData is static, so it can be found in the
+     request-local cache by pointer without touching the shared table. */
+  auto const localCacheable = regex->isStatic();
+  if (localCacheable && tl_localCache) {
+    auto const it = tl_localCache->find(regex);
+    if (it != tl_localCache->end()) {
+      accessor = it->second.entry;
+      return true;
+    }
+  }
+
   /* Try to lookup the cached regex entry, and if successful, just pass
      back the compiled pattern, otherwise go on and compile it. */
   if (s_pcreCache.find(accessor, regex, tkc)) {
+    if (localCacheable) pcre_cache_locally(accessor, regex);
     return true;
   }
 
@@ -899,6 +956,7 @@ pcre_get_compiled_regex_cache(PCRECache::Accessor& accessor,
   }
 
   s_pcreCache.insert(accessor, regex, tkc, new_entry);
+  if (localCacheable) pcre_cache_locally(accessor, regex);
   return true;
 }
 
@@ -64,6 +64,7 @@
 #include "hphp/runtime/server/replay-transport.h"
 #include "hphp/runtime/server/server-note.h"
 #include "hphp/runtime/server/server-stats.h"
+#include "hphp/runtime/server/warmup-request-handler.h"
 #include "hphp/runtime/server/xbox-server.h"
 #include "hphp/runtime/vm/debug/debug.h"
 #include "hphp/runtime/vm/jit/code-cache.h"
@@ -1050,47 +1051,21 @@ static int start_server(const std::string &username, int xhprof) {
     profileWarmupEnd();
   }
 
+  if (RuntimeOption::RepoAuthoritative &&
+      RuntimeOption::RepoBackgroundPrefetch) {
+    // Returns immediately; units keep loading while the server warms up
+    // and starts taking traffic.
+    prefetchRepo();
+  }
+
   // If we have any warmup requests, replay them before listening for
   // real connections
   {
     Logger::Info("Warming up");
     if (!RuntimeOption::EvalJitProfileWarmupRequests) profileWarmupStart();
     SCOPE_EXIT { profileWarmupEnd(); };
-    std::map<std::string, int> seen;
-    for (auto& file : RuntimeOption::ServerWarmupRequests) {
-      HttpServer::CheckMemAndWait();
-      // Take only the last part
-      folly::StringPiece f(file);
-      auto pos = f.rfind('/');
-      std::string str(pos == f.npos ? file : f.subpiece(pos + 1).str());
-      auto count = seen[str];
-      BootStats::Block timer(folly::sformat("warmup:{}:{}", str, count++));
-      seen[str] = count;
-
-      HttpRequestHandler handler(0);
-      ReplayTransport rt;
-      timespec start;
-      Timer::GetMonotonicTime(start);
-      std::string error;
-      Logger::Info("Replaying warmup request %s", file.c_str());
-
-      try {
-        rt.onRequestStart(start);
-        rt.replayInput(Hdf(file));
-        handler.run(&rt);
-
-        timespec stop;
-        Timer::GetMonotonicTime(stop);
-        Logger::Info("Finished successfully in %ld seconds",
-                     stop.tv_sec - start.tv_sec);
-      } catch (std::exception& e) {
-        error = e.what();
-      }
-
-      if (error.size()) {
-        Logger::Info("Got exception during warmup: %s", error.c_str());
-      }
-    }
+    replayWarmupRequests(RuntimeOption::ServerWarmupRequests,
+                         RuntimeOption::ServerWarmupConcurrency);
   }
   BootStats::mark("warmup");
 
@@ -1989,14 +1964,36 @@ static int execute_program_impl(int argc, char** argv) {
     set_execution_mode("server");
     HttpServer server; // so we initialize runtime properly
     HttpRequestHandler handler(0);
+    int64_t totalUsec = 0;
+    int64_t totalInstrs = 0;
+    int requests = 0;
     for (int i = 0; i < po.count; i++) {
       for (unsigned int j = 0; j < po.args.size(); j++) {
         ReplayTransport rt;
         rt.replayInput(po.args[j].c_str());
+        timespec start;
+        Timer::GetMonotonicTime(start);
+        HardwareCounter::Reset();
         handler.run(&rt);
+        auto const instrs = HardwareCounter::GetInstructionCount();
+        timespec stop;
+        Timer::GetMonotonicTime(stop);
+        auto const usec = gettime_diff_us(start, stop);
         printf("%s\n", rt.getResponse().c_str());
+        fprintf(stderr, "%s: %" PRId64 " us, %" PRId64 " instrs\n",
+                po.args[j].c_str(), usec, instrs);
+        totalUsec += usec;
+        totalInstrs += instrs;
+        ++requests;
       }
     }
+    if (requests > 1) {
+      fprintf(stderr,
+              "%d requests: %" PRId64 " us, %" PRId64 " instrs"
+              " (avg %" PRId64 " us, %" PRId64 " instrs)\n",
+              requests, totalUsec, totalInstrs,
+              totalUsec / requests, totalInstrs / requests);
+    }
     return 0;
   }
 
@@ -2226,6 +2223,11 @@ void hphp_process_init() {
   // in ini files (e.g., E_ALL) and sync some other options
   update_constants_and_options();
 
+  if (!RuntimeOption::EvalRdsLayoutProfileFile.empty()) {
+    rds::loadLayoutProfile(RuntimeOption::EvalRdsLayoutProfileFile);
+    BootStats::mark("rds::loadLayoutProfile");
+  }
+
   InitFiniNode::ProcessInit();
   BootStats::mark("extra_process_init");
   {
@@ -2550,6 +2552,12 @@ void hphp_process_exit() noexcept {
   LOG_AND_IGNORE(Xenon::getInstance().stop())
   LOG_AND_IGNORE(jit::mcgen::joinWorkerThreads())
   LOG_AND_IGNORE(jit::tc::processExit())
+  if (!RuntimeOption::EvalRdsLayoutProfileFile.empty()) {
+    // Refresh the layout profile with anything bound since retranslateAll
+    // saved it.
+    LOG_AND_IGNORE(
+      rds::saveLayoutProfile(RuntimeOption::EvalRdsLayoutProfileFile))
+  }
   LOG_AND_IGNORE(PageletServer::Stop())
   LOG_AND_IGNORE(XboxServer::Stop())
   // Debugger::Stop() needs an execution context
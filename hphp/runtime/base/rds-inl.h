@@ -30,6 +30,9 @@ Handle allocUnlocked(Mode mode, size_t numBytes, size_t align,
                      type_scan::Index tyIndex);
 Handle bindImpl(Symbol key, Mode mode, size_t sizeBytes,
                 size_t align, type_scan::Index tyIndex);
+void bindBatchImpl(const Symbol* keys, Handle* handles, size_t n,
+                   Mode mode, size_t sizeBytes, size_t align,
+                   type_scan::Index tyIndex);
 Handle attachImpl(Symbol key);
 void bindOnLinkImpl(std::atomic<Handle>& handle, Mode mode,
                     size_t sizeBytes, size_t align,
@@ -185,6 +188,14 @@ Link<T,N> bind(Symbol key, Mode mode, size_t extraSize) {
   );
 }
 
+template<class T, size_t Align>
+void bindBatch(const Symbol* keys, Handle* handles, size_t n, Mode mode) {
+  detail::bindBatchImpl(
+    keys, handles, n, mode, sizeof(T),
+    Align, type_scan::getIndexForScan<T>()
+  );
+}
+
 template<class T>
 Link<T> attach(Symbol key) {
   return Link<T>(detail::attachImpl(key));
@@ -16,8 +16,10 @@
 #include "hphp/runtime/base/rds.h"
 #include "hphp/runtime/vm/vm-regs.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <fstream>
 #include <mutex>
 #include <atomic>
 #include <vector>
@@ -34,14 +36,19 @@
 
 #include <tbb/concurrent_hash_map.h>
 
+#include "hphp/util/build-info.h"
+#include "hphp/util/hugetlb.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/maphuge.h"
 #include "hphp/util/numa.h"
 #include "hphp/util/type-scan.h"
 
 #include "hphp/runtime/base/rds-header.h"
+#include "hphp/runtime/base/rds-util.h"
+#include "hphp/runtime/base/static-string-table.h"
 #include "hphp/runtime/vm/debug/debug.h"
 #include "hphp/runtime/vm/treadmill.h"
+#include "hphp/runtime/vm/jit/target-cache.h"
 #include "hphp/runtime/vm/jit/vm-protect.h"
 
 namespace HPHP { namespace rds {
@@ -106,6 +113,33 @@ struct SymbolRep : boost::static_visitor<std::string> {
   }
 };
 
+/*
+ * Text representation used by the RDS layout profile.  Only symbols whose
+ * keys can be reconstructed by name in a later process are represented:
+ * StaticLocal keys embed a FuncId and SPropCache keys a Class*, neither of
+ * which is stable across processes, and Profile data lives in the local
+ * section, whose layout we don't try to reproduce.  The unrepresentable
+ * symbols yield an empty string and are skipped.
+ */
+struct SymbolLayoutRep : boost::static_visitor<std::string> {
+  std::string operator()(StaticLocal /*k*/) const { return {}; }
+
+  std::string operator()(ClsConstant k) const {
+    return folly::format("ClsConstant {} {}",
+                         k.clsName->data(), k.cnsName->data()).str();
+  }
+
+  std::string operator()(StaticMethod k) const {
+    return folly::format("StaticMethod {}", k.name->data()).str();
+  }
+  std::string operator()(StaticMethodF k) const {
+    return folly::format("StaticMethodF {}", k.name->data()).str();
+  }
+
+  std::string operator()(Profile /*k*/) const { return {}; }
+  std::string operator()(SPropCache /*k*/) const { return {}; }
+};
+
 struct SymbolEq : boost::static_visitor<bool> {
   template<class T, class U>
   typename std::enable_if<
@@ -213,6 +247,12 @@ using FreeLists = folly::sorted_vector_map<unsigned,
 FreeLists s_normal_free_lists;
 FreeLists s_persistent_free_lists;
 
+/*
+ * Bind order of the normal section's named symbols, recorded when
+ * Eval.RdsLayoutProfileFile is set.  Protected by s_allocMutex.
+ */
+std::vector<Symbol> s_bindOrder;
+
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -400,6 +440,11 @@ Handle bindImpl(Symbol key, Mode mode, size_t sizeBytes,
   auto const handle = alloc(mode, sizeBytes, align, tyIndex);
   recordRds(handle, sizeBytes, key);
 
+  if (mode == Mode::Normal &&
+      !RuntimeOption::EvalRdsLayoutProfileFile.empty()) {
+    s_bindOrder.push_back(key);
+  }
+
   LinkTable::const_accessor insert_acc;
   // insert_acc lives until after s_handleTable is updated
   if (!s_linkTable.insert(insert_acc, LinkTable::value_type(key, handle))) {
@@ -411,6 +456,63 @@ Handle bindImpl(Symbol key, Mode mode, size_t sizeBytes,
   return handle;
 }
 
+void bindBatchImpl(const Symbol* keys, Handle* handles, size_t n,
+                   Mode mode, size_t sizeBytes, size_t align,
+                   type_scan::Index tyIndex) {
+  // Contiguous layout requires each element to be self-aligned.
+  assert(sizeBytes % folly::nextPowTwo(align) == 0);
+
+  Guard g(s_allocMutex);
+
+  // Figure out which symbols still need an allocation; everything else gets
+  // its existing handle, the same as bindImpl.
+  size_t numNew = 0;
+  for (size_t i = 0; i < n; ++i) {
+    LinkTable::const_accessor acc;
+    if (s_linkTable.find(acc, keys[i])) {
+      handles[i] = acc->second;
+    } else {
+      handles[i] = kInvalidHandle;
+      ++numNew;
+    }
+  }
+  if (!numNew) return;
+
+  // Normal-mode elements each carry their own generation number prefix, so
+  // they can't share one block; allocating them under a single lock
+  // acquisition is still a win.
+  auto block = mode != Mode::Normal
+    ? alloc(mode, sizeBytes * numNew, align, tyIndex)
+    : kInvalidHandle;
+
+  for (size_t i = 0; i < n; ++i) {
+    if (handles[i] != kInvalidHandle) continue;
+
+    Handle handle;
+    if (mode == Mode::Normal) {
+      handle = alloc(mode, sizeBytes, align, tyIndex);
+      if (!RuntimeOption::EvalRdsLayoutProfileFile.empty()) {
+        s_bindOrder.push_back(keys[i]);
+      }
+    } else {
+      handle = block;
+      block += sizeBytes;
+    }
+    recordRds(handle, sizeBytes, keys[i]);
+
+    LinkTable::const_accessor insert_acc;
+    // insert_acc lives until after s_handleTable is updated
+    if (!s_linkTable.insert(insert_acc,
+                            LinkTable::value_type(keys[i], handle))) {
+      always_assert(0);
+    }
+    if (type_scan::hasScanner(tyIndex)) {
+      s_handleTable.insert(std::make_pair(handle, keys[i]));
+    }
+    handles[i] = handle;
+  }
+}
+
 Handle attachImpl(Symbol key) {
   LinkTable::const_accessor acc;
   if (s_linkTable.find(acc, key)) return acc->second;
@@ -437,6 +539,74 @@ void unbind(Symbol key, Handle handle) {
   s_handleTable.erase(handle);
 }
 
+void saveLayoutProfile(const std::string& filename) {
+  std::vector<Symbol> order;
+  {
+    Guard g(s_allocMutex);
+    order = s_bindOrder;
+  }
+
+  std::ofstream out(filename);
+  if (!out.is_open()) {
+    Logger::Warning("Unable to write RDS layout profile to %s",
+                    filename.c_str());
+    return;
+  }
+  out << folly::format("RdsLayoutProfile 1 {}\n", repoSchemaId());
+
+  size_t written = 0;
+  for (auto const& sym : order) {
+    auto const rep = boost::apply_visitor(SymbolLayoutRep(), sym);
+    if (rep.empty()) continue;
+    out << rep << '\n';
+    ++written;
+  }
+  Logger::Info("Saved %lu symbols to RDS layout profile %s",
+               (unsigned long)written, filename.c_str());
+}
+
+void loadLayoutProfile(const std::string& filename) {
+  std::ifstream in(filename);
+  // A missing profile just means this is the first run with the option set.
+  if (!in.is_open()) return;
+
+  std::string header;
+  std::vector<std::string> hparts;
+  if (std::getline(in, header)) folly::split(' ', header, hparts);
+  if (hparts.size() != 3 ||
+      hparts[0] != "RdsLayoutProfile" ||
+      hparts[1] != "1" ||
+      hparts[2] != repoSchemaId().str()) {
+    Logger::Warning("Ignoring RDS layout profile %s: unrecognized header or "
+                    "repo schema mismatch", filename.c_str());
+    return;
+  }
+
+  size_t bound = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::vector<std::string> parts;
+    folly::split(' ', line, parts);
+    if (parts.size() == 3 && parts[0] == "ClsConstant") {
+      bindClassConstant(makeStaticString(parts[1]),
+                        makeStaticString(parts[2]));
+      ++bound;
+    } else if (parts.size() == 2 && parts[0] == "StaticMethod") {
+      bind<jit::StaticMethodCache>(
+        StaticMethod { makeStaticString(parts[1]) }
+      );
+      ++bound;
+    } else if (parts.size() == 2 && parts[0] == "StaticMethodF") {
+      bind<jit::StaticMethodFCache>(
+        StaticMethodF { makeStaticString(parts[1]) }
+      );
+      ++bound;
+    }
+  }
+  Logger::Info("Pre-bound %lu symbols from RDS layout profile %s",
+               (unsigned long)bound, filename.c_str());
+}
+
 using namespace detail;
 
 //////////////////////////////////////////////////////////////////////
@@ -458,6 +628,11 @@ static size_t s_next_bit;
 static size_t s_bits_to_go;
 static int s_tc_fd;
 
+// Process-wide budget of explicit 2M huge pages for the thread-local RDS
+// portion, claimed first-come by request threads; see
+// Eval.RDSNumHuge2MPages. Set in initPersistentCache().
+static std::atomic<int64_t> s_rdsHuge2MBudget{0};
+
 // Mapping from names to targetcache locations.
 typedef tbb::concurrent_hash_map<const StringData*, Handle,
         StringDataHashICompare>
@@ -630,6 +805,48 @@ static void initPersistentCache() {
   ftruncate(s_tc_fd,
             RuntimeOption::EvalJitTargetCacheSize - s_persistent_base);
   s_local_frontier = s_persistent_frontier = s_persistent_base;
+  s_rdsHuge2MBudget.store(RuntimeOption::EvalRDSNumHuge2MPages,
+                          std::memory_order_release);
+}
+
+/*
+ * Number of explicit 2M huge pages this thread should try to claim for the
+ * start of its thread-local RDS portion (where the hottest handles live).
+ * Bounded by the process-wide budget and by the thread-local portion itself;
+ * the shared persistent portion is mapped over with MAP_FIXED later and
+ * would waste any huge pages placed under it.
+ */
+static size_t claimableHuge2MPages() {
+#ifndef NDEBUG
+  // Like the THP hint in threadInit(), explicitly huge-backed RDS is
+  // incompatible with VMProtect in vm-regs.cpp.
+  return 0;
+#else
+  auto const budget = s_rdsHuge2MBudget.load(std::memory_order_acquire);
+  if (budget <= 0) return 0;
+  return std::min<size_t>(budget, s_persistent_base / size2m);
+#endif
+}
+
+/*
+ * mmap a 2M-aligned JitTargetCacheSize region by over-allocating and
+ * trimming the slack, so the start can be remapped with explicit huge
+ * pages. Returns MAP_FAILED on failure, like mmap.
+ */
+static void* mmapAligned2m(size_t size) {
+  auto const raw = mmap(nullptr, size + size2m, PROT_READ | PROT_WRITE,
+                        MAP_ANON | MAP_PRIVATE, -1, 0);
+  if (raw == MAP_FAILED) return raw;
+  auto const addr = reinterpret_cast<uintptr_t>(raw);
+  auto const aligned = (addr + size2m - 1) & ~(size2m - 1);
+  if (aligned != addr) {
+    munmap(raw, aligned - addr);
+  }
+  auto const tailSlack = size2m - (aligned - addr);
+  if (tailSlack) {
+    munmap(reinterpret_cast<void*>(aligned + size), tailSlack);
+  }
+  return reinterpret_cast<void*>(aligned);
 }
 
 void threadInit(bool shouldRegister) {
@@ -639,13 +856,34 @@ void threadInit(bool shouldRegister) {
     initPersistentCache();
   }
 
-  tl_base = mmap(nullptr, RuntimeOption::EvalJitTargetCacheSize,
-                 PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+  auto const wantHugePages = claimableHuge2MPages();
+  tl_base = wantHugePages
+    ? mmapAligned2m(RuntimeOption::EvalJitTargetCacheSize)
+    : mmap(nullptr, RuntimeOption::EvalJitTargetCacheSize,
+           PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
   always_assert_flog(
     tl_base != MAP_FAILED,
     "Failed to mmap persistent RDS region. errno = {}",
     folly::errnoStr(errno).c_str()
   );
+  size_t hugeBytes = 0;
+  if (wantHugePages) {
+    // Remap the start of the region with explicit 2M pages, stopping as
+    // soon as the reserved pool runs dry; whatever we cannot claim simply
+    // stays on 4K pages (possibly promoted by the THP hint below). The
+    // region is still all zeros here, so the wipe mmap_2m does is fine.
+    size_t mapped = 0;
+    while (mapped < wantHugePages) {
+      auto const addr = reinterpret_cast<char*>(tl_base) + mapped * size2m;
+      if (!mmap_2m(addr, PROT_READ | PROT_WRITE, s_numaNode,
+                   false /* shared */, true /* fixed */)) {
+        break;
+      }
+      ++mapped;
+    }
+    s_rdsHuge2MBudget.fetch_sub(mapped, std::memory_order_acq_rel);
+    hugeBytes = mapped * size2m;
+  }
 #ifdef _MSC_VER
   // MapViewOfFileEx() requires "the specified memory region is not already in
   // use by the calling process" when mapping the shared area below. Otherwise
@@ -659,11 +897,13 @@ void threadInit(bool shouldRegister) {
                        -1, 0);
   always_assert(tl_same == tl_base);
 #endif
-  numa_bind_to(tl_base, s_persistent_base, s_numaNode);
+  numa_bind_to(reinterpret_cast<char*>(tl_base) + hugeBytes,
+               s_persistent_base - hugeBytes, s_numaNode);
 #ifdef NDEBUG
   // A huge-page RDS is incompatible with VMProtect in vm-regs.cpp
   if (RuntimeOption::EvalMapTgtCacheHuge) {
-    hintHuge(tl_base, RuntimeOption::EvalJitTargetCacheSize);
+    hintHuge(reinterpret_cast<char*>(tl_base) + hugeBytes,
+             RuntimeOption::EvalJitTargetCacheSize - hugeBytes);
   }
 #endif
 
@@ -127,6 +127,25 @@ void threadExit(bool shouldUnregister = true);
  */
 void flush();
 
+/*
+ * Save the first-bind order of the normal section's named symbols to
+ * `filename', and pre-bind the symbols recorded in such a file, respectively.
+ *
+ * Symbols bind lazily, on first access, so by the time the profiling phase
+ * ends the bind order is a good proxy for access frequency.  Replaying it at
+ * process start packs the previous run's hot handles into a dense region at
+ * the front of the normal section instead of wherever a cold request
+ * happened to first touch them.  Only symbols whose keys are stable across
+ * processes (class constants and static-method caches) are recorded;
+ * everything else keeps first-touch order.
+ *
+ * The file carries the repo schema id it was produced under;
+ * loadLayoutProfile() ignores files saved by a binary with a different
+ * schema, so a stale profile left over from before a deploy is harmless.
+ */
+void saveLayoutProfile(const std::string& filename);
+void loadLayoutProfile(const std::string& filename);
+
 /*
  * Return the number of bytes that have been allocated from either
  * persistent, local, or non-persistent RDS.
@@ -367,6 +386,24 @@ private:
 template<class T, bool N = false, size_t Align = alignof(T)>
 Link<T,N> bind(Symbol key, Mode mode = Mode::Normal, size_t extraSize = 0);
 
+/*
+ * Bind a batch of distinct Symbols at once, each mapped to a value of type
+ * `T'.
+ *
+ * Equivalent to calling bind<T>() on each element of `keys', except that the
+ * allocation lock is taken only once, and symbols that aren't already bound
+ * are laid out contiguously in a single allocation (except in normal mode,
+ * where each element needs its own generation number prefix).  The handle
+ * for keys[i] is written to handles[i].
+ *
+ * This is for callers that bind a large run of related symbols in one go,
+ * e.g. a Class binding every static property handle at initialization time,
+ * where taking the lock per symbol turns into a first-use latency step.
+ */
+template<class T, size_t Align = alignof(T)>
+void bindBatch(const Symbol* keys, Handle* handles, size_t n,
+               Mode mode = Mode::Normal);
+
 /*
  * Remove a bound link from RDS metadata. The actual space in RDS is
  * not reclaimed.
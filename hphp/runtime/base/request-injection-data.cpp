@@ -31,10 +31,12 @@
 #include "hphp/util/logger.h"
 #include "hphp/runtime/base/file.h"
 #include "hphp/runtime/base/ini-setting.h"
+#include "hphp/runtime/base/memory-manager.h"
 #include "hphp/runtime/base/rds-header.h"
 #include "hphp/runtime/base/runtime-option.h"
 #include "hphp/runtime/base/thread-info.h"
 #include "hphp/runtime/ext/string/ext_string.h"
+#include "hphp/runtime/server/server-stats.h"
 #include "hphp/runtime/vm/debugger-hook.h"
 #include "hphp/runtime/ext/std/ext_std_file.h"
 
@@ -560,6 +562,15 @@ void RequestInjectionData::onSessionInit() {
     folly::Random::rand32(
       RuntimeOption::EvalFunctionCallSampleRate
     ) == 0;
+
+  if (auto const softLimit = RuntimeOption::EvalRequestMemorySoftLimit) {
+    MM().addUsageThresholdCallback(softLimit, [softLimit] {
+      Logger::Warning("Request exceeded soft memory limit (%" PRIu64
+                      " bytes)", softLimit);
+      ServerStats::Log("mem.soft_limit_exceeded", 1);
+    });
+  }
+
   reset();
 }
 
@@ -31,6 +31,7 @@
 #include <folly/portability/Unistd.h>
 
 #include "hphp/util/arch.h"
+#include "hphp/util/async-log-writer.h"
 #include "hphp/util/atomic-vector.h"
 #include "hphp/util/build-info.h"
 #include "hphp/util/cpuid.h"
@@ -167,6 +168,8 @@ int RuntimeOption::ServerPortFd = -1;
 int RuntimeOption::ServerBacklog = 128;
 int RuntimeOption::ServerConnectionLimit = 0;
 int RuntimeOption::ServerThreadCount = 50;
+bool RuntimeOption::ServerThreadAutoScale = false;
+int RuntimeOption::ServerThreadScaleFloor = 0;
 int RuntimeOption::QueuedJobsReleaseRate = 3;
 int RuntimeOption::ServerWarmupThrottleRequestCount = 0;
 int RuntimeOption::ServerThreadDropCacheTimeoutSeconds = 0;
@@ -180,6 +183,7 @@ bool RuntimeOption::ServerFixPathInfo = false;
 bool RuntimeOption::ServerAddVaryEncoding = true;
 bool RuntimeOption::ServerLogSettingsOnStartup = false;
 std::vector<std::string> RuntimeOption::ServerWarmupRequests;
+int RuntimeOption::ServerWarmupConcurrency = 0;
 std::string RuntimeOption::ServerCleanupRequest;
 int RuntimeOption::ServerInternalWarmupThreads = 0;
 boost::container::flat_set<std::string>
@@ -189,6 +193,7 @@ int RuntimeOption::PageletServerThreadCount = 0;
 int RuntimeOption::PageletServerThreadDropCacheTimeoutSeconds = 0;
 int RuntimeOption::PageletServerQueueLimit = 0;
 bool RuntimeOption::PageletServerThreadDropStack = false;
+int RuntimeOption::PageletServerPipelineBufferKb = 0;
 int RuntimeOption::RequestTimeoutSeconds = 0;
 int RuntimeOption::PspTimeoutSeconds = 0;
 int RuntimeOption::PspCpuTimeoutSeconds = 0;
@@ -234,6 +239,9 @@ std::string RuntimeOption::OutputHandler;
 bool RuntimeOption::ImplicitFlush = false;
 bool RuntimeOption::EnableEarlyFlush = true;
 bool RuntimeOption::ForceChunkedEncoding = false;
+int64_t RuntimeOption::OutputCoalesceBytes = 0;
+int64_t RuntimeOption::OutputCoalesceWindowMicros = 1000;
+int64_t RuntimeOption::OutputEagerFirstBytes = 8 << 10;
 int64_t RuntimeOption::MaxPostSize = 100;
 int64_t RuntimeOption::LowestMaxPostSize = LLONG_MAX;
 bool RuntimeOption::AlwaysPopulateRawPostData = false;
@@ -259,6 +267,7 @@ int RuntimeOption::SSLPortFd = -1;
 std::string RuntimeOption::SSLCertificateFile;
 std::string RuntimeOption::SSLCertificateKeyFile;
 std::string RuntimeOption::SSLCertificateDir;
+std::string RuntimeOption::SSLTicketSeedFile;
 bool RuntimeOption::TLSDisableTLS1_2 = false;
 std::string RuntimeOption::TLSClientCipherSpec;
 bool RuntimeOption::EnableSSLWithPlainText = false;
@@ -271,6 +280,7 @@ std::vector<std::shared_ptr<SatelliteServerInfo>>
 bool RuntimeOption::AllowRunAsRoot = false; // Allow running hhvm as root.
 
 int RuntimeOption::XboxServerThreadCount = 10;
+int RuntimeOption::XboxServerScaleMinThreadCount = 0;
 int RuntimeOption::XboxServerMaxQueueLength = INT_MAX;
 int RuntimeOption::XboxServerPort = 0;
 int RuntimeOption::XboxDefaultLocalTimeoutMilliSeconds = 500;
@@ -306,6 +316,8 @@ std::string RuntimeOption::RequestInitDocument;
 std::string RuntimeOption::AutoPrependFile;
 std::string RuntimeOption::AutoAppendFile;
 
+std::string RuntimeOption::AutoloadNativeMapPath;
+
 bool RuntimeOption::SafeFileAccess = false;
 std::vector<std::string> RuntimeOption::AllowedDirectories;
 std::set<std::string> RuntimeOption::AllowedFiles;
@@ -343,6 +355,10 @@ bool RuntimeOption::AlwaysUseRelativePath = false;
 
 int RuntimeOption::HttpDefaultTimeout = 30;
 int RuntimeOption::HttpSlowQueryThreshold = 5000; // ms
+std::string RuntimeOption::HttpConnectionPool;
+int RuntimeOption::HttpConnectionPoolSize = 5;
+int RuntimeOption::HttpConnectionPoolWaitTimeout = 5000; // ms
+int RuntimeOption::HttpConnectionPoolReuseLimit = 500;
 
 bool RuntimeOption::NativeStackTrace = false;
 bool RuntimeOption::ServerErrorMessage = false;
@@ -588,6 +604,9 @@ int32_t RuntimeOption::RepoCentralFileMode;
 std::string RuntimeOption::RepoCentralFileUser;
 std::string RuntimeOption::RepoCentralFileGroup;
 bool RuntimeOption::RepoAllowFallbackPath = true;
+std::string RuntimeOption::RepoFlatPath;
+std::string RuntimeOption::RepoShmPath = "/dev/shm/hhvm-units";
+int64_t RuntimeOption::RepoShmBytes = 0;
 std::string RuntimeOption::RepoEvalMode;
 std::string RuntimeOption::RepoJournal = "delete";
 bool RuntimeOption::RepoCommit = true;
@@ -595,6 +614,7 @@ bool RuntimeOption::RepoDebugInfo = true;
 // Missing: RuntimeOption::RepoAuthoritative's physical location is
 // perf-sensitive.
 bool RuntimeOption::RepoPreload;
+bool RuntimeOption::RepoBackgroundPrefetch;
 int64_t RuntimeOption::RepoLocalReadaheadRate = 0;
 bool RuntimeOption::RepoLocalReadaheadConcurrent = false;
 
@@ -658,6 +678,7 @@ double RuntimeOption::XenonPeriodSeconds = 0.0;
 bool RuntimeOption::XenonForceAlwaysOn = false;
 bool RuntimeOption::XenonTraceUnitLoad = false;
 std::string RuntimeOption::XenonStructLogDest;
+bool RuntimeOption::XenonCompactStacks = false;
 bool RuntimeOption::TrackPerUnitMemory = false;
 
 std::map<std::string, std::string> RuntimeOption::CustomSettings;
@@ -897,6 +918,8 @@ void RuntimeOption::Load(
     ));
 
     Config::Bind(Logger::UseLogFile, ini, config, "Log.UseLogFile", true);
+    Config::Bind(AsyncLogWriter::Enabled, ini, config,
+                 "Log.UseAsyncWriter", false);
     Config::Bind(LogFile, ini, config, "Log.File");
     Config::Bind(LogFileSymLink, ini, config, "Log.SymLink");
     Config::Bind(LogFilePeriodMultiplier, ini,
@@ -1109,6 +1132,12 @@ void RuntimeOption::Load(
     Config::Bind(RepoAllowFallbackPath, ini, config, "Repo.AllowFallbackPath",
                  RepoAllowFallbackPath);
 
+    Config::Bind(RepoFlatPath, ini, config, "Repo.Flat.Path");
+
+    // Repo - Shm (host-wide shared-memory unit cache; 0 bytes = disabled)
+    Config::Bind(RepoShmPath, ini, config, "Repo.Shm.Path", RepoShmPath);
+    Config::Bind(RepoShmBytes, ini, config, "Repo.Shm.Bytes", RepoShmBytes);
+
     // Repo - Eval
     Config::Bind(RepoEvalMode, ini, config, "Repo.Eval.Mode");
     if (RepoEvalMode.empty()) {
@@ -1128,6 +1157,8 @@ void RuntimeOption::Load(
     Config::Bind(RepoAuthoritative, ini, config, "Repo.Authoritative",
                  RepoAuthoritative);
     Config::Bind(RepoPreload, ini, config, "Repo.Preload", false);
+    Config::Bind(RepoBackgroundPrefetch, ini, config,
+                 "Repo.BackgroundPrefetch", false);
     Config::Bind(RepoLocalReadaheadRate, ini, config,
                  "Repo.LocalReadaheadRate", 0);
     Config::Bind(RepoLocalReadaheadConcurrent, ini, config,
@@ -1395,6 +1426,10 @@ void RuntimeOption::Load(
                  "Server.ConnectionLimit", 0);
     Config::Bind(ServerThreadCount, ini, config, "Server.ThreadCount",
                  Process::GetCPUCount() * 2);
+    Config::Bind(ServerThreadAutoScale, ini, config,
+                 "Server.ThreadAutoScale", false);
+    Config::Bind(ServerThreadScaleFloor, ini, config,
+                 "Server.ThreadScaleFloor", Process::GetCPUCount());
     Config::Bind(ServerWarmupThrottleRequestCount, ini, config,
                  "Server.WarmupThrottleRequestCount",
                  ServerWarmupThrottleRequestCount);
@@ -1417,6 +1452,8 @@ void RuntimeOption::Load(
     Config::Bind(ServerLogSettingsOnStartup, ini, config,
                  "Server.LogSettingsOnStartup", false);
     Config::Bind(ServerWarmupRequests, ini, config, "Server.WarmupRequests");
+    Config::Bind(ServerWarmupConcurrency, ini, config,
+                 "Server.WarmupConcurrency", 0);  // <= 1 = replay serially
     Config::Bind(ServerCleanupRequest, ini, config, "Server.CleanupRequest");
     Config::Bind(ServerInternalWarmupThreads, ini, config,
                  "Server.InternalWarmupThreads", 0);  // 0 = skip
@@ -1499,6 +1536,12 @@ void RuntimeOption::Load(
                  true);
     Config::Bind(ForceChunkedEncoding, ini, config,
                  "Server.ForceChunkedEncoding");
+    Config::Bind(OutputCoalesceBytes, ini, config,
+                 "Server.OutputCoalesceBytes", 0);
+    Config::Bind(OutputCoalesceWindowMicros, ini, config,
+                 "Server.OutputCoalesceWindowMicros", 1000);
+    Config::Bind(OutputEagerFirstBytes, ini, config,
+                 "Server.OutputEagerFirstBytes", 8 << 10);
     Config::Bind(MaxPostSize, ini, config, "Server.MaxPostSize", 100);
     MaxPostSize <<= 20;
     Config::Bind(AlwaysPopulateRawPostData, ini, config,
@@ -1517,6 +1560,7 @@ void RuntimeOption::Load(
     Config::Bind(SSLCertificateKeyFile, ini, config,
                  "Server.SSLCertificateKeyFile");
     Config::Bind(SSLCertificateDir, ini, config, "Server.SSLCertificateDir");
+    Config::Bind(SSLTicketSeedFile, ini, config, "Server.SSLTicketSeedFile");
     Config::Bind(TLSDisableTLS1_2, ini, config, "Server.TLSDisableTLS1_2",
                  false);
     Config::Bind(TLSClientCipherSpec, ini, config,
@@ -1565,6 +1609,8 @@ void RuntimeOption::Load(
                  "Server.RequestInitFunction");
     Config::Bind(RequestInitDocument, ini, config,
                  "Server.RequestInitDocument");
+    Config::Bind(AutoloadNativeMapPath, ini, config,
+                 "Autoload.NativeMapPath");
     Config::Bind(SafeFileAccess, ini, config, "Server.SafeFileAccess");
     Config::Bind(AllowedDirectories, ini, config, "Server.AllowedDirectories");
     Config::Bind(WhitelistExec, ini, config, "Server.WhitelistExec");
@@ -1665,6 +1711,8 @@ void RuntimeOption::Load(
     // Xbox
     Config::Bind(XboxServerThreadCount, ini, config,
                  "Xbox.ServerInfo.ThreadCount", 10);
+    Config::Bind(XboxServerScaleMinThreadCount, ini, config,
+                 "Xbox.ServerInfo.ScaleMinThreadCount", 0);
     Config::Bind(XboxServerMaxQueueLength, ini, config,
                  "Xbox.ServerInfo.MaxQueueLength", INT_MAX);
     if (XboxServerMaxQueueLength < 0) XboxServerMaxQueueLength = INT_MAX;
@@ -1700,6 +1748,8 @@ void RuntimeOption::Load(
                  "PageletServer.ThreadDropCacheTimeoutSeconds", 0);
     Config::Bind(PageletServerQueueLimit, ini, config,
                  "PageletServer.QueueLimit", 0);
+    Config::Bind(PageletServerPipelineBufferKb, ini, config,
+                 "PageletServer.PipelineBufferKb", 0);
   }
   {
     // Static File
@@ -1761,6 +1811,13 @@ void RuntimeOption::Load(
     Config::Bind(HttpDefaultTimeout, ini, config, "Http.DefaultTimeout", 30);
     Config::Bind(HttpSlowQueryThreshold, ini, config, "Http.SlowQueryThreshold",
                  5000);
+    Config::Bind(HttpConnectionPool, ini, config, "Http.ConnectionPool");
+    Config::Bind(HttpConnectionPoolSize, ini, config,
+                 "Http.ConnectionPoolSize", 5);
+    Config::Bind(HttpConnectionPoolWaitTimeout, ini, config,
+                 "Http.ConnectionPoolWaitTimeout", 5000);
+    Config::Bind(HttpConnectionPoolReuseLimit, ini, config,
+                 "Http.ConnectionPoolReuseLimit", 500);
   }
   {
     // Debug
@@ -1887,6 +1944,8 @@ void RuntimeOption::Load(
     Config::Bind(XenonForceAlwaysOn, ini, config, "Xenon.ForceAlwaysOn", false);
     Config::Bind(XenonTraceUnitLoad, ini, config, "Xenon.TraceUnitLoad", false);
     Config::Bind(XenonStructLogDest, ini, config, "Xenon.StructLogDest", "");
+    Config::Bind(XenonCompactStacks, ini, config, "Xenon.CompactStacks",
+                 false);
   }
   {
     // We directly read zend.assertions here, so that we can get its INI value
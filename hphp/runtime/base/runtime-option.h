@@ -137,6 +137,8 @@ struct RuntimeOption {
   static int ServerBacklog;
   static int ServerConnectionLimit;
   static int ServerThreadCount;
+  static bool ServerThreadAutoScale;
+  static int ServerThreadScaleFloor;
   static int QueuedJobsReleaseRate;
   static int ServerWarmupThrottleRequestCount;
   static int ServerThreadDropCacheTimeoutSeconds;
@@ -150,6 +152,7 @@ struct RuntimeOption {
   static bool ServerAddVaryEncoding;
   static bool ServerLogSettingsOnStartup;
   static std::vector<std::string> ServerWarmupRequests;
+  static int ServerWarmupConcurrency;
   static std::string ServerCleanupRequest;
   static int ServerInternalWarmupThreads;
   static boost::container::flat_set<std::string> ServerHighPriorityEndPoints;
@@ -158,6 +161,10 @@ struct RuntimeOption {
   static int PageletServerThreadDropCacheTimeoutSeconds;
   static int PageletServerQueueLimit;
   static bool PageletServerThreadDropStack;
+  // > 0 bounds how much intermediate pagelet output (in KB) may sit in
+  // the pipeline; a pagelet thread that runs ahead of its consumer
+  // blocks until the parent drains some of it.
+  static int PageletServerPipelineBufferKb;
 
   static int RequestTimeoutSeconds;
   static int PspTimeoutSeconds;
@@ -214,6 +221,9 @@ struct RuntimeOption {
   static bool ImplicitFlush;
   static bool EnableEarlyFlush;
   static bool ForceChunkedEncoding;
+  static int64_t OutputCoalesceBytes;
+  static int64_t OutputCoalesceWindowMicros;
+  static int64_t OutputEagerFirstBytes;
   static int64_t MaxPostSize;
   static int64_t LowestMaxPostSize;
   static bool AlwaysPopulateRawPostData;
@@ -245,11 +255,15 @@ struct RuntimeOption {
   static std::string SSLCertificateFile;
   static std::string SSLCertificateKeyFile;
   static std::string SSLCertificateDir;
+  static std::string SSLTicketSeedFile;
   static bool TLSDisableTLS1_2;
   static std::string TLSClientCipherSpec;
   static bool EnableSSLWithPlainText;
 
   static int XboxServerThreadCount;
+  // > 0 subscribes the xbox dispatcher to the host health monitor and
+  // lets it scale its worker pool between this floor and ThreadCount.
+  static int XboxServerScaleMinThreadCount;
   static int XboxServerMaxQueueLength;
   static int XboxServerPort;
   static int XboxDefaultLocalTimeoutMilliSeconds;
@@ -285,6 +299,11 @@ struct RuntimeOption {
   static std::string AutoPrependFile;
   static std::string AutoAppendFile;
 
+  // Path to a binary symbol->path table built offline by
+  // NativeAutoloadMap::build(); mmap'd read-only at process init and
+  // consulted before any PHP autoload machinery runs.
+  static std::string AutoloadNativeMapPath;
+
   static bool SafeFileAccess;
   static std::vector<std::string> AllowedDirectories;
   static std::set<std::string> AllowedFiles;
@@ -328,6 +347,13 @@ struct RuntimeOption {
 
   static int  HttpDefaultTimeout;
   static int  HttpSlowQueryThreshold;
+  // When non-empty, HttpClient draws its curl handles from this named
+  // process-wide connection pool (created on first use), keeping
+  // connections and TLS sessions warm across requests.
+  static std::string HttpConnectionPool;
+  static int  HttpConnectionPoolSize;
+  static int  HttpConnectionPoolWaitTimeout;
+  static int  HttpConnectionPoolReuseLimit;
 
   static bool NativeStackTrace;
   static bool ServerErrorMessage;
@@ -462,6 +488,12 @@ struct RuntimeOption {
   F(uint64_t, JitMatureSize,           25 << 20)                        \
   F(double, JitMaturityExponent,       1.)                              \
   F(bool, JitTimer,                    kJitTimerDefault)                \
+  /* Record a per-translation, per-pass compile-time profile (needs
+   * JitTimer); dump it via the admin server's /vm-jittime. */           \
+  F(bool, JitTimeProfile,              false)                           \
+  /* Repeat each region's HHIR and vasm lowering this many extra times,
+   * to amplify compile-time signal when benchmarking offline. */        \
+  F(uint32_t, JitTimeProfileRepeats,   0)                               \
   F(int, JitConcurrently,              1)                               \
   F(int, JitThreads,                   4)                               \
   F(int, JitWorkerThreads,             Process::GetCPUCount() / 2)      \
@@ -472,12 +504,24 @@ struct RuntimeOption {
   F(bool, DisassemblerDocComments,     true)                            \
   F(bool, DisassemblerPropDocComments, true)                            \
   F(bool, LoadFilepathFromUnitCache,   false)                           \
+  /* In non-RepoAuthoritative mode, record the RDS writes of a unit's
+     first clean merge and replay them as a batch on later requests,
+     skipping per-definition checks whose outcome cannot change. */     \
+  F(bool, UnitMergeSnapshots,          true)                            \
+  /* Read whole plain files at least this large via mmap() rather than
+     read(2).  0 disables: a file truncated while mapped raises SIGBUS,
+     so only enable this when readers and writers are coordinated. */   \
+  F(uint64_t, FileReadMmapThreshold,   0)                               \
   /* Whether to use hh_single_compile by default if available. */       \
   F(bool, HackCompilerDefault,         false)                           \
   /* The command to invoke to spawn hh_single_compile in server mode. */\
   F(string, HackCompilerCommand,       "")                              \
   /* The number of hh_single_compile daemons to keep alive. */          \
   F(uint64_t, HackCompilerWorkers,     Process::GetCPUCount() / 2)      \
+  /* The number of requests that may be in flight to a single
+     hh_single_compile daemon at once.  Responses come back in request
+     order, so values above one pipeline compiles through each daemon. */\
+  F(uint64_t, HackCompilerPipelineDepth, 2)                             \
   /* The number of times to retry after an infra failure communicating
      with a compiler process. */                                        \
   F(uint64_t, HackCompilerMaxRetries,  0)                               \
@@ -540,6 +584,14 @@ struct RuntimeOption {
   F(bool, ProfileHWExcludeKernel,      false)                           \
   F(bool, ProfileHWStructLog,          false)                           \
   F(bool, JitAlwaysInterpOne,          false)                           \
+  /* Fuse hot adjacent bytecode pairs (e.g. CGetL;IsTypeC) in the       \
+   * interpreter, executing both before returning to the dispatch loop. \
+   * Automatically disabled under the debugger, code coverage, and      \
+   * instruction-count profiling. */                                    \
+  F(bool, InterpFuseHotPairs,          true)                            \
+  /* Cache interpreted FPushObjMethodD and ClsCnsD lookups per call     \
+   * site in request-local RDS, analogous to the JIT's target caches. */\
+  F(bool, InterpInlineCaches,          true)                            \
   F(int32_t, JitNopInterval,           0)                               \
   F(uint32_t, JitMaxTranslations,      10)                              \
   F(uint32_t, JitMaxProfileTranslations, 30)                            \
@@ -554,6 +606,16 @@ struct RuntimeOption {
   F(uint32_t, JitProfileBCSize,        profileBCSizeDefault())          \
   F(uint32_t, JitResetProfCountersRequest, resetProfCountersDefault())  \
   F(uint32_t, JitRetranslateAllRequest, retranslateAllRequestDefault()) \
+  /* After the initial instance-bit assignment, keep profiling instanceof\
+   * checks against classes that didn't get a bit, and hand leftover bits\
+   * to late-hot classes every this many additional profiled checks.  0  \
+   * disables late assignment. */                                        \
+  F(uint32_t, InstanceBitsUpdateThreshold, 200000)                       \
+  /* If set, save the bind order of named normal-section RDS symbols to  \
+   * this file when retranslateAll finishes, and replay a file saved by  \
+   * a previous run at process start so its hot symbols get packed at    \
+   * the front of the section. */                                        \
+  F(string, RdsLayoutProfileFile,      "")                               \
   F(double,   JitLayoutHotThreshold,   0.05)                            \
   F(int32_t,  JitLayoutMainFactor,     1000)                            \
   F(int32_t,  JitLayoutColdFactor,     5)                               \
@@ -574,11 +636,20 @@ struct RuntimeOption {
   F(uint32_t, JitWriteLeaseExpiration, 1500) /* in microseconds */      \
   F(int, JitRetargetJumps,             1)                               \
   F(bool, HHIRLICM,                    false)                           \
+  F(bool, HHIRConsolidateSurpriseChecks, true)                          \
   F(bool, HHIRSimplification,          true)                            \
   F(bool, HHIRGenOpts,                 true)                            \
   F(bool, HHIRRefcountOpts,            true)                            \
   F(bool, HHIREnableGenTimeInlining,   true)                            \
   F(uint32_t, HHIRInliningMaxVasmCost, 370)                             \
+  /* Scale HHIRInliningMaxVasmCost up for hot calls: by the profile      \
+   * counts of the caller translation and the callee entry relative to   \
+   * JitPGOThreshold, clamped to at most this factor.  0 disables the    \
+   * scaling. */                                                         \
+  F(uint32_t, HHIRInliningMaxCostScale, 4)                              \
+  /* Always inline callees whose estimated translation cost is at most   \
+   * this, regardless of the accumulated cost of the inlining stack. */  \
+  F(uint32_t, HHIRAlwaysInlineVasmCostLimit, 80)                        \
   F(uint32_t, HHIRInliningMaxReturnDecRefs, 12)                         \
   F(uint32_t, HHIRInliningMaxReturnLocals, 20)                          \
   F(bool, HHIRInlineFrameOpts,         true)                            \
@@ -605,6 +676,10 @@ struct RuntimeOption {
   F(string,   JitPGORegionSelector,    "hotcfg")                        \
   F(uint64_t, JitPGOThreshold,         pgoThresholdDefault())           \
   F(bool,     JitPGOOnly,              false)                           \
+  /* With JitPGOOnly, bytes of main code that Live translations of */   \
+  /* functions that missed the profiling window may occupy; 0 keeps */  \
+  /* those functions interpreted. */                                    \
+  F(uint64_t, JitPGOOnlyLiveBudget,    0)                               \
   F(bool,     JitPGOHotOnly,           false)                           \
   F(bool,     JitPGOUsePostConditions, true)                            \
   F(uint32_t, JitPGOUnlikelyDecRefReleasePercent, 5)                    \
@@ -617,12 +692,32 @@ struct RuntimeOption {
   F(double,   JitPGOMinArcProbability, 0.0)                             \
   F(uint32_t, JitPGOMaxFuncSizeDupBody, 80)                             \
   F(uint32_t, JitPGORelaxPercent,      100)                             \
+  /* During optimized retranslation, drop retranslations whose guards
+   * passed for less than this percentage of the chain's profiling
+   * weight; the corresponding inputs side-exit instead.  0 disables. */ \
+  F(uint32_t, JitPGODropColdRetransPercent, 0)                          \
   F(uint32_t, JitPGORelaxUncountedToGenPercent, 20)                     \
   F(uint32_t, JitPGORelaxCountedToGenPercent, 75)                       \
   F(bool,     JitPGODumpCallGraph,     false)                           \
+  /* Use the iTLB-aware hfsort+ clustering instead of the baseline
+   * hfsort when laying out code.hot after retranslateAll. */           \
+  F(bool,     JitPGOHfsortPlus,        false)                           \
+  /* At polymorphic method call sites where profiling found no unique
+   * method, base class, or interface, dispatch through a chain of exact
+   * class checks when a few receiver classes cover nearly all calls. */ \
+  F(bool,     JitPGOPolyMethodCache,   true)                            \
+  /* After retranslateAll, batch the per-request static-prop init of
+   * scalar-only persistent classes at request start so optimized code
+   * can drop their CheckInitSProps guards. Server mode only. */        \
+  F(bool,     JitPGOBatchSPropInit,    true)                            \
   F(uint64_t, FuncCountHint,           10000)                           \
   F(uint64_t, PGOFuncCountHint,        1000)                            \
   F(uint32_t, HotFuncCount,            4100)                            \
+  /* If set, the function hotness profile behind AttrHot is written to
+   * this file once profiling concludes and read back at the next boot,
+   * so a freshly restarted server places the same functions in
+   * code.hot without waiting to re-learn them. */                      \
+  F(string, JitHotFuncsFile,           "")                              \
   F(bool, RegionRelaxGuards,           true)                            \
   /* DumpBytecode =1 dumps user php, =2 dumps systemlib & user php */   \
   F(int32_t, DumpBytecode,             0)                               \
@@ -637,6 +732,7 @@ struct RuntimeOption {
   F(bool, DumpAst,                     false)                           \
   F(bool, DumpTargetProfiles,          false)                           \
   F(bool, MapTgtCacheHuge,             false)                           \
+  F(uint32_t, RDSNumHuge2MPages,       0)                               \
   F(uint32_t, MaxHotTextHugePages,     hugePagesSoundNice() ? 8 : 0)    \
   F(int32_t, MaxLowMemHugePages,       hugePagesSoundNice() ? 8 : 0)    \
   F(bool, LowStaticArrays,             true)                            \
@@ -653,13 +749,43 @@ struct RuntimeOption {
   /* only run eager-gc once at each surprise point (much faster) */     \
   F(bool, FilterGCPoints,              true)                            \
   F(bool, Quarantine,                  eagerGcDefault())                \
+  /* parse heap slabs on multiple threads during the GC init phase */   \
+  F(bool, GCParallelInit,              true)                            \
   F(uint32_t, GCSampleRate,            0)                               \
   F(int64_t, GCMinTrigger,             64L<<20)                         \
   F(double, GCTriggerPct,              0.5)                             \
+  /* Log a warning and bump a server stat the first time a request's */ \
+  /* heap usage reaches this many bytes.  0 disables. */                \
+  F(uint64_t, RequestMemorySoftLimit,  0)                               \
+  /* refresh per-class live-size counters during each collection, for */ \
+  /* objprof_get_gc_data() queries that skip the heap walk */           \
+  F(bool, GCClassCounters,             false)                           \
+  /* After marking, redirect duplicate counted strings of at most this */ \
+  /* many bytes found in surviving arrays to a single instance, */      \
+  /* releasing the displaced copies.  0 disables the pass. */           \
+  F(uint32_t, GCStringDedupMaxSize,    0)                               \
+  /* Queue arrays whose refcount hits zero on a per-request list */     \
+  /* drained at the next surprise check, instead of destroying them */  \
+  /* inline.  Smooths teardown spikes when big structures die at */     \
+  /* scope exit; destructors of objects held by a deferred array run */ \
+  /* at the drain point rather than the decref site. */                 \
+  F(bool, DeferArrayRelease,           false)                           \
+  /* When a persistent class's 86cinit constant evaluates to a value */ \
+  /* with no per-request state, publish it into the class's constant */ \
+  /* table so later requests (and new translations) read it directly. */\
+  /* Only enable when 86cinit initializers don't depend on constants */ \
+  /* define()'d differently per request. */                             \
+  F(bool, ClsCnsPromoteScalarInit,     false)                           \
   F(bool, RaiseMissingThis,            !EnableHipHopSyntax)             \
   F(bool, QuoteEmptyShellArg,          !EnableHipHopSyntax)             \
   F(bool, Verify,                      getenv("HHVM_VERIFY"))           \
   F(bool, VerifyOnly,                  false)                           \
+  /* Check a unit's functions on this many verifier worker threads; */  \
+  /* 0 or 1 verifies serially on the loading thread. */                 \
+  F(uint64_t, VerifyWorkers,           0)                               \
+  /* Skip re-verifying functions whose bytecode fingerprint already */  \
+  /* passed verification earlier in this process. */                    \
+  F(bool, VerifyIncremental,           false)                           \
   F(uint32_t, StaticContentsLogRate,   100)                             \
   F(uint32_t, LogUnitLoadRate,         0)                               \
   F(uint32_t, MaxDeferredErrors,       50)                              \
@@ -679,7 +805,23 @@ struct RuntimeOption {
   F(bool, EnableReusableTC,   reuseTCDefault())                         \
   F(bool, LogServerRestartStats, false)                                 \
   F(uint32_t, ReusableTCPadding, 128)                                   \
+  /* Defer the smashing of bound jumps to a dedicated thread, so that   \
+   * request threads return to the TC without serializing on SrcRec     \
+   * locks.  Ignored when EnableReusableTC is set, since a queued       \
+   * site's code could be reclaimed before it is smashed. */            \
+  F(bool, JitAsyncBindSmash, false)                                     \
   F(int64_t,  StressUnitCacheFreq, 0)                                   \
+  /* Trust the watchman extension to flag changed files under its        \
+   * subscribed roots.  Unit cache lookups for unflagged files under     \
+   * such a root then skip the per-request stat() entirely.  Only        \
+   * meaningful when not RepoAuthoritative. */                           \
+  F(bool, WatchmanUnitInvalidation, false)                               \
+  /* Bound on the estimated memory held by the non-RepoAuthoritative     \
+   * unit cache.  When the bound is exceeded the least-recently-used     \
+   * units are evicted (reclaimed via the treadmill) until usage drops   \
+   * below 3/4 of the bound.  0 means unbounded, the historical          \
+   * behavior. */                                                        \
+  F(int64_t, NonRepoUnitCacheMaxBytes, 0)                                \
   F(int64_t, PerfWarningSampleRate, 1)                                  \
   F(int64_t, FunctionCallSampleRate, 0)                                 \
   F(double, InitialLoadFactor, 1.0)                                     \
@@ -699,6 +841,9 @@ struct RuntimeOption {
   F(std::vector<std::string>, UnixServerAllowedGroups,                  \
                                             std::vector<std::string>()) \
   F(bool, TrashFillOnRequestExit, false)                                \
+  /* Max request-heap slabs each thread keeps mapped across requests   \
+   * to avoid early-request page-fault churn. */                        \
+  F(uint32_t, SlabRetainLimit, 16)                                      \
   /******************                                                   \
    | ARM   Options. |                                                   \
    *****************/                                                   \
@@ -728,6 +873,9 @@ struct RuntimeOption {
   F(uint32_t, PerfMemEventSampleFreq, 80)                               \
   /* Sampling frequency for TC branch profiling. */                     \
   F(uint32_t, ProfBranchSampleFreq, 0)                                  \
+  /* Collect per-branch taken/next counters in Profile translations and
+   * use them for block layout in the optimized translations. */        \
+  F(bool,     ProfBranchCounters, false)                                \
   /* Sampling frequency for profiling packed array accesses. */         \
   F(uint32_t, ProfPackedArraySampleFreq, 0)                             \
   /* */
@@ -756,12 +904,16 @@ public:
   static std::string RepoCentralFileUser;
   static std::string RepoCentralFileGroup;
   static bool RepoAllowFallbackPath;
+  static std::string RepoFlatPath;
+  static std::string RepoShmPath;
+  static int64_t RepoShmBytes;
   static std::string RepoEvalMode;
   static std::string RepoJournal;
   static bool RepoCommit;
   static bool RepoDebugInfo;
   static bool RepoAuthoritative;
   static bool RepoPreload;
+  static bool RepoBackgroundPrefetch;
   static int64_t RepoLocalReadaheadRate;
   static bool RepoLocalReadaheadConcurrent;
 
@@ -830,6 +982,11 @@ public:
   static bool XenonForceAlwaysOn;
   static bool XenonTraceUnitLoad;
   static std::string XenonStructLogDest;
+  // Record raw (Func*, offset) pairs per sample and symbolize lazily,
+  // instead of building full backtrace arrays at sample time. Cuts the
+  // per-sample cost enough to support much higher sample rates, at the
+  // price of losing 86metadata in the samples.
+  static bool XenonCompactStacks;
 };
 static_assert(sizeof(RuntimeOption) == 1, "no instance variables");
 
@@ -168,6 +168,8 @@ public:
     scanner.scan(*elms, m_used * sizeof(*elms));
   }
 
+  uint32_t iterLimit() const { return m_used; }
+
 //////////////////////////////////////////////////////////////////////
 // Initialization, Copies, and Conversions
 
@@ -169,7 +169,7 @@ static std::string realpathLibc(const char* path) {
 
 StatCache::Node::Node(StatCache& statCache, int wd /* = -1 */)
   : m_statCache(statCache),
-    m_lock(false /*reentrant*/, RankStatCacheNode),
+    m_lock(RankStatCacheNode),
     m_wd(wd), m_valid(false), m_inExpirePaths(false) { }
 
 void StatCache::Node::atomicRelease() {
@@ -224,7 +224,7 @@ void StatCache::Node::touchLocked(bool invalidate /* = true */) {
 }
 
 void StatCache::Node::touch(bool invalidate /* = true */) {
-  SimpleLock lock(m_lock);
+  SimpleAdaptiveLock lock(m_lock);
   touchLocked<false>(invalidate);
 }
 
@@ -237,7 +237,7 @@ void StatCache::Node::expirePaths(bool invalidate /* = true */) {
   NameNodeMap children, lChildren;
 
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
 
     if (m_inExpirePaths) {
       // Terminate loop in recursion.
@@ -268,7 +268,7 @@ void StatCache::Node::expirePaths(bool invalidate /* = true */) {
     }
   }
 
-  SimpleLock lock(m_lock);
+  SimpleAdaptiveLock lock(m_lock);
   m_inExpirePaths = false;
 }
 
@@ -329,7 +329,7 @@ int StatCache::Node::stat(const std::string& path, struct stat* buf,
                           time_t lastRefresh /* = 0 */) {
   bool cached;
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
     if (validate(path, cached)) {
       return -1;
     }
@@ -346,7 +346,7 @@ int StatCache::Node::lstat(const std::string& path, struct stat* buf,
                            time_t lastRefresh /* = 0 */) {
   bool cached;
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
     if (validate(path, cached)) {
       return -1;
     }
@@ -365,7 +365,7 @@ bool StatCache::Node::isLinkLocked() {
 }
 
 bool StatCache::Node::isLink() {
-  SimpleLock lock(m_lock);
+  SimpleAdaptiveLock lock(m_lock);
   return isLinkLocked();
 }
 
@@ -375,7 +375,7 @@ std::string StatCache::Node::readlink(const std::string& path,
   bool cached;
   struct stat buf;
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
     if (validate(path, cached) || !isLinkLocked()) {
       return "";
     }
@@ -419,7 +419,7 @@ StatCache::NodePtr StatCache::Node::getChild(const std::string& childName,
 // StatCache.
 
 StatCache::StatCache()
-  : m_lock(false /*reentrant*/, RankStatCache), m_ifd(-1),
+  : m_lock(RankStatCache), m_ifd(-1),
     m_lastRefresh(time(nullptr)) {
 }
 
@@ -445,6 +445,7 @@ bool StatCache::init() {
 }
 
 void StatCache::clear() {
+  m_realpathGeneration.fetch_add(1, std::memory_order_release);
   if (m_ifd != -1) {
     close(m_ifd);
     m_ifd = -1;
@@ -552,6 +553,9 @@ bool StatCache::mergePath(const std::string& path, bool follow) {
 
 #ifdef __linux__
 bool StatCache::handleEvent(const struct inotify_event* event) {
+  // Any event can change what a cached path resolves to; invalidate the
+  // realpath memo wholesale and let entries repopulate lazily.
+  m_realpathGeneration.fetch_add(1, std::memory_order_release);
   if (event->mask & IN_Q_OVERFLOW) {
     // The event queue overflowed, so all bets are off.  Start over.
     TRACE(0, "StatCache: event queue overflowed\n");
@@ -646,7 +650,7 @@ void StatCache::removeLPath(const std::string& path, Node* node) {
 
 void StatCache::refresh() {
 #ifdef __linux__
-  SimpleLock lock(m_lock);
+  SimpleAdaptiveLock lock(m_lock);
 
   if (m_ifd == -1) {
     return;
@@ -677,7 +681,7 @@ void StatCache::refresh() {
 }
 
 time_t StatCache::lastRefresh() {
-  SimpleLock lock(m_lock);
+  SimpleAdaptiveLock lock(m_lock);
 
   return m_lastRefresh;
 }
@@ -699,7 +703,7 @@ int StatCache::statImpl(const std::string& path, struct stat* buf) {
     return p->stat(path, buf);
   }
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
     if (mergePath(path, true)) {
       return statSyscall(path, buf);
     }
@@ -730,7 +734,7 @@ int StatCache::lstatImpl(const std::string& path, struct stat* buf) {
     return p->lstat(path, buf);
   }
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
     if (mergePath(path, false)) {
       return lstatSyscall(path, buf);
     }
@@ -761,7 +765,7 @@ std::string StatCache::readlinkImpl(const std::string& path) {
     return p->readlink(path);
   }
   {
-    SimpleLock lock(m_lock);
+    SimpleAdaptiveLock lock(m_lock);
     if (mergePath(path, false)) {
       return readlinkSyscall(path);
     }
@@ -812,6 +816,34 @@ __FBSDID("$FreeBSD: src/lib/libc/stdlib/realpath.c,v 1.24 2011/11/04 19:56:34 ed
 // Find the real name of path, by removing all ".", ".." and symlink
 // components.  Returns the resolved path on success, or "" on failure,
 std::string StatCache::realpathImpl(const char* path) {
+  // Memoize canonicalization on top of the per-component node cache;
+  // include-heavy workloads resolve the same paths over and over.  An
+  // entry is only trusted while its generation matches the current one,
+  // which advances whenever an inotify event changes the cache, so
+  // invalidation rides the existing machinery.
+  // Relative paths resolve against the current working directory, so
+  // they aren't safe to memoize.
+  if (path[0] != '/') {
+    return realpathResolve(path);
+  }
+  auto const gen = m_realpathGeneration.load(std::memory_order_acquire);
+  {
+    RealpathMap::const_accessor acc;
+    if (m_realpathCache.find(acc, path) && acc->second.generation == gen) {
+      return acc->second.resolved;
+    }
+  }
+  auto const resolved = realpathResolve(path);
+  if (!resolved.empty()) {
+    RealpathMap::accessor acc;
+    m_realpathCache.insert(acc, path);
+    acc->second.resolved = resolved;
+    acc->second.generation = gen;
+  }
+  return resolved;
+}
+
+std::string StatCache::realpathResolve(const char* path) {
   std::string resolved;
   assert(path != nullptr);
   if (path[0] != '/') {
@@ -24,6 +24,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <atomic>
+
 #include <tbb/concurrent_hash_map.h>
 
 #include "hphp/util/hash-map-typedefs.h"
@@ -74,7 +76,7 @@ struct StatCache {
     bool validate(const std::string& path, bool& cached);
 
     StatCache& m_statCache;
-    SimpleMutex m_lock;
+    SimpleAdaptiveMutex m_lock;
     int m_wd;                // Watch descriptor; -1 if a file.
 
     bool m_valid;            // True if m_stat/m_lstat are currently valid.
@@ -119,13 +121,27 @@ struct StatCache {
   int lstatImpl(const std::string& path, struct stat* buf);
   std::string readlinkImpl(const std::string& path);
   std::string realpathImpl(const char* path);
+  std::string realpathResolve(const char* path);
 
   static StatCache s_sc;
 
   NameNodeMap m_path2Node;  // stat() path cache.
   NameNodeMap m_lpath2Node; // lstat() path cache.
 
-  SimpleMutex m_lock;       // Protects the following fields.
+  // Memoized realpath() results.  Entries are only trusted while their
+  // generation matches m_realpathGeneration, which is bumped whenever an
+  // inotify event changes the node cache; stale entries are overwritten
+  // the next time their path is resolved.
+  struct RealpathEntry {
+    std::string resolved;
+    uint64_t generation;
+  };
+  typedef tbb::concurrent_hash_map<std::string, RealpathEntry,
+                                   stringHashCompare> RealpathMap;
+  RealpathMap m_realpathCache;
+  std::atomic<uint64_t> m_realpathGeneration{0};
+
+  SimpleAdaptiveMutex m_lock; // Protects the following fields.
   int m_ifd;
 #ifdef __linux__
   static const size_t kReadBufSize = 10 * (sizeof(struct inotify_event)
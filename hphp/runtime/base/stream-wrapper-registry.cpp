@@ -27,7 +27,10 @@
 #include <set>
 #include <map>
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace HPHP { namespace Stream {
 ///////////////////////////////////////////////////////////////////////////////
@@ -51,21 +54,55 @@ struct RequestWrappers final : RequestEventHandler {
     return m_wrappers.value();
   }
 
+  // Emptiness checks that don't instantiate the containers, so the hot
+  // lookup path can skip the overlay without mutating request state.
+  bool hasDisabled() const {
+    return m_disabled.hasValue() && !m_disabled->empty();
+  }
+  bool hasWrappers() const {
+    return m_wrappers.hasValue() && !m_wrappers->empty();
+  }
+
 private:
   folly::Optional<DisabledSet> m_disabled;
   folly::Optional<WrapperMap> m_wrappers;
 };
 
-// Global registry for wrappers
-static std::map<std::string,Wrapper*> s_wrappers;
+/*
+ * Global registry for wrappers.
+ *
+ * Lookups vastly outnumber registrations---every fopen() and include
+ * consults the table, while registration happens during process startup
+ * and the rare dlopen()ed extension.  Readers therefore load an immutable
+ * snapshot with a single acquire and walk it without synchronization;
+ * each registration copies the current snapshot, adds the new scheme, and
+ * publishes the copy.  Retired snapshots are kept around in case another
+ * thread is still reading one.
+ */
+using WrapperTable = std::map<std::string,Wrapper*>;
+static std::atomic<const WrapperTable*> s_wrappers{nullptr};
+static std::mutex s_wrappers_lock;
 static __thread Wrapper* tl_fileHandler;
 
+static const WrapperTable& wrapperTable() {
+  static const WrapperTable s_empty;
+  auto const table = s_wrappers.load(std::memory_order_acquire);
+  return table ? *table : s_empty;
+}
+
 // Request local registry for user defined wrappers and disabled builtins
 IMPLEMENT_STATIC_REQUEST_LOCAL(RequestWrappers, s_request_wrappers);
 
 bool registerWrapper(const std::string &scheme, Wrapper *wrapper) {
-  assert(s_wrappers.find(scheme) == s_wrappers.end());
-  s_wrappers[scheme] = wrapper;
+  std::lock_guard<std::mutex> g(s_wrappers_lock);
+  static std::vector<std::unique_ptr<const WrapperTable>> s_retired;
+  auto const cur = s_wrappers.load(std::memory_order_relaxed);
+  assert(!cur || cur->find(scheme) == cur->end());
+  auto next = cur ? std::make_unique<WrapperTable>(*cur)
+                  : std::make_unique<WrapperTable>();
+  (*next)[scheme] = wrapper;
+  s_wrappers.store(next.release(), std::memory_order_release);
+  if (cur) s_retired.emplace_back(cur);
   return true;
 }
 
@@ -86,7 +123,8 @@ bool disableWrapper(const String& scheme) {
   }
 
   // Disable builtin wrapper if it exists
-  if (s_wrappers.find(lscheme.data()) == s_wrappers.end()) {
+  auto& table = wrapperTable();
+  if (table.find(lscheme.data()) == table.end()) {
     // No builtin to disable
     return ret;
   }
@@ -131,7 +169,8 @@ bool registerRequestWrapper(const String& scheme,
 
   // Global, non-disabled wrapper
   auto& disabled = s_request_wrappers->disabled();
-  if ((s_wrappers.find(lscheme.data()) != s_wrappers.end()) &&
+  auto& table = wrapperTable();
+  if ((table.find(lscheme.data()) != table.end()) &&
       (disabled.find(lscheme) == disabled.end())) {
     return false;
   }
@@ -151,7 +190,7 @@ Array enumWrappers() {
 
   // Enum global wrappers which are not disabled
   auto& disabled = s_request_wrappers->disabled();
-  for (auto& e : s_wrappers) {
+  for (auto& e : wrapperTable()) {
     if (disabled.find(e.first) == disabled.end()) {
       ret.append(e.first);
     }
@@ -187,8 +226,9 @@ Wrapper* getWrapper(const String& scheme, bool warn /*= false */) {
     return tl_fileHandler;
   }
 
-  // Request local wrapper?
-  if (have_request_wrappers) {
+  // Request local wrapper?  Only touch the overlay when this request
+  // actually registered one.
+  if (have_request_wrappers && s_request_wrappers->hasWrappers()) {
     auto& wrappers = s_request_wrappers->wrappers();
     auto it = wrappers.find(lscheme);
     if (it != wrappers.end()) {
@@ -196,15 +236,16 @@ Wrapper* getWrapper(const String& scheme, bool warn /*= false */) {
     }
   }
 
-  // Global, non-disabled wrapper?
+  // Global, non-disabled wrapper?  The snapshot is immutable, so no
+  // synchronization is needed to walk it.
   {
-    auto disabledWrappers = [] () -> RequestWrappers::DisabledSet& {
-      return s_request_wrappers->disabled();
-    };
-    auto it = s_wrappers.find(lscheme.data());
-    if ((it != s_wrappers.end()) &&
+    auto& table = wrapperTable();
+    auto it = table.find(lscheme.data());
+    if ((it != table.end()) &&
         (!have_request_wrappers ||
-        (disabledWrappers().find(lscheme) == disabledWrappers().end()))) {
+         !s_request_wrappers->hasDisabled() ||
+         (s_request_wrappers->disabled().find(lscheme) ==
+          s_request_wrappers->disabled().end()))) {
       return it->second;
     }
   }
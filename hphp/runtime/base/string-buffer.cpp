@@ -52,6 +52,11 @@ StringBuffer::~StringBuffer() {
 }
 
 const char* StringBuffer::data() const {
+  if (UNLIKELY(m_piecesLen != 0)) {
+    // Rope pieces are spliced in lazily; data() promises a contiguous
+    // null-terminated buffer, so coalesce them now.
+    const_cast<StringBuffer*>(this)->flatten();
+  }
   if (m_buffer && m_len) {
     m_buffer[m_len] = '\0'; // fixup
     return m_buffer;
@@ -60,6 +65,7 @@ const char* StringBuffer::data() const {
 }
 
 String StringBuffer::detach() {
+  if (UNLIKELY(!m_pieces.empty())) flatten();
   if (m_buffer && m_len) {
     assert(m_str && m_str->hasExactlyOneRef());
     auto str = String::attach(m_str);
@@ -78,6 +84,10 @@ String StringBuffer::copy() const {
 }
 
 void StringBuffer::absorb(StringBuffer& buf) {
+  if (UNLIKELY(!m_pieces.empty() || !buf.m_pieces.empty())) {
+    flatten();
+    buf.flatten();
+  }
   if (empty()) {
     StringData* str = m_str;
 
@@ -105,6 +115,8 @@ void StringBuffer::absorb(StringBuffer& buf) {
 
 void StringBuffer::clear() {
   m_len = 0;
+  m_pieces.clear();
+  m_piecesLen = 0;
 }
 
 void StringBuffer::release() {
@@ -118,9 +130,12 @@ void StringBuffer::release() {
   m_str = nullptr;
   m_buffer = nullptr;
   m_len = m_cap = 0;
+  m_pieces.clear();
+  m_piecesLen = 0;
 }
 
 void StringBuffer::resize(uint32_t size) {
+  if (UNLIKELY(!m_pieces.empty())) flatten();
   assert(size <= m_cap);
   if (size <= m_cap) {
     m_len = size;
@@ -128,6 +143,7 @@ void StringBuffer::resize(uint32_t size) {
 }
 
 char* StringBuffer::appendCursor(int size) {
+  if (UNLIKELY(!m_pieces.empty())) flatten();
   if (!m_buffer) {
     makeValid(size);
   } else if (m_cap - m_len < size) {
@@ -222,6 +238,33 @@ void StringBuffer::makeValid(uint32_t minCap) {
   m_cap = m_str->capacity();
 }
 
+void StringBuffer::appendPiece(const String& s) {
+  assert(m_rope);
+  auto const len = uint32_t(s.size());
+  if (m_len + m_piecesLen + len > m_maxBytes) {
+    throw StringBufferLimitException(m_maxBytes, detach());
+  }
+  m_pieces.push_back(s);
+  m_piecesLen += len;
+}
+
+void StringBuffer::flatten() {
+  if (m_pieces.empty()) return;
+  // Move the pieces out first: growBy() may throw a limit exception
+  // whose handler detaches (and hence re-flattens) this buffer.
+  auto pieces = std::move(m_pieces);
+  auto const piecesLen = m_piecesLen;
+  m_pieces.clear();
+  m_piecesLen = 0;
+
+  if (!valid()) makeValid(m_len + piecesLen);
+  if (piecesLen > m_cap - m_len) growBy(piecesLen);
+  for (auto const& p : pieces) {
+    memcpy(m_buffer + m_len, p.data(), p.size());
+    m_len += p.size();
+  }
+}
+
 void StringBuffer::appendHelper(const char *s, int len) {
   if (!valid()) makeValid(len);
 
@@ -18,6 +18,7 @@
 #define incl_HPHP_STRING_BUFFER_H_
 
 #include "hphp/runtime/base/exceptions.h"
+#include "hphp/runtime/base/req-containers.h"
 #include "hphp/runtime/base/type-string.h"
 #include "hphp/runtime/base/req-root.h"
 
@@ -42,6 +43,12 @@ struct StringBufferLimitException : FatalErrorException {
 struct StringBuffer {
   static constexpr uint32_t kDefaultOutputLimit = StringData::MaxSize;
 
+  /*
+   * In rope mode, String appends at least this large are recorded by
+   * reference instead of copied into the contiguous buffer.
+   */
+  static constexpr uint32_t kRopePieceMin = 1024;
+
   /*
    * This class does not need to be swept when used as a NativeData from
    * the StringBuffer HNI class.
@@ -88,13 +95,23 @@ struct StringBuffer {
    * The pointer and size should be considered invalidated after any
    * call to a non-const member function on this class.
    */
-  uint32_t size() const { return m_len; }
+  uint32_t size() const { return m_len + m_piecesLen; }
   const char* data() const;
 
+  /*
+   * Switch this buffer into rope mode: large String appends are
+   * recorded by reference (zero-copy, one incref) and only spliced
+   * into the contiguous buffer when someone needs it---data(), set(),
+   * appendCursor(), or detach().  This turns append-heavy consumers
+   * like the output-buffering stack from copy-per-append into one
+   * coalescing pass over the final size.
+   */
+  void enableRope() { m_rope = true; }
+
   /*
    * Returns whether this string has length zero.
    */
-  bool empty() const { return m_len == 0; }
+  bool empty() const { return size() == 0; }
 
   /*
    * Detach buffer and yield a String.
@@ -152,6 +169,7 @@ struct StringBuffer {
    * Mutate a character in existing buffer.
    */
   void set(uint32_t offset, char c) {
+    if (UNLIKELY(m_piecesLen != 0)) flatten();
     assert(offset < m_len);
     m_buffer[offset] = c;
   }
@@ -160,6 +178,7 @@ struct StringBuffer {
    * Append various types of things to this string.
    */
   void append(char c) {
+    if (UNLIKELY(m_piecesLen != 0)) flatten();
     if (m_buffer && m_len < m_cap) {
       m_buffer[m_len++] = c;
       return;
@@ -168,12 +187,19 @@ struct StringBuffer {
   }
   void append(unsigned char c) { append((char)c);}
   void append(const char* s) { assert(s); append(s, strlen(s)); }
-  void append(const String& s) { append(s.data(), s.size()); }
+  void append(const String& s) {
+    if (m_rope && s.size() >= kRopePieceMin) {
+      appendPiece(s);
+      return;
+    }
+    append(s.data(), s.size());
+  }
   void append(const std::string& s) { append(s.data(), s.size()); }
   void append(const StringData* s) { append(s->data(), s->size()); }
   void append(folly::StringPiece s) { append(s.data(), s.size()); }
   void append(const char* s, int len) {
     assert(len >= 0);
+    if (UNLIKELY(m_piecesLen != 0)) flatten();
     if (m_buffer && len <= m_cap - m_len) {
       memcpy(m_buffer + m_len, s, len);
       m_len += len;
@@ -208,6 +234,8 @@ struct StringBuffer {
 private:
   void appendHelper(const char* s, int len);
   void appendHelper(char c);
+  void appendPiece(const String& s);
+  void flatten();
   void growBy(int spaceRequired);
   void makeValid(uint32_t minCap);
   bool valid() const { return m_buffer != nullptr; }
@@ -219,6 +247,11 @@ private:
   uint32_t m_maxBytes;
   uint32_t m_cap;                    // doesn't include null terminator
   uint32_t m_len;
+
+  // Rope mode state: unflattened pieces and their total length.
+  req::vector<String> m_pieces;
+  uint32_t m_piecesLen{0};
+  bool m_rope{false};
 };
 
 /*
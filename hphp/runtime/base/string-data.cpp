@@ -21,6 +21,7 @@
 
 #include "hphp/util/alloc.h"
 #include "hphp/util/safe-cast.h"
+#include "hphp/util/simd-memmem.h"
 #include "hphp/util/stacktrace-profiler.h"
 
 #include "hphp/runtime/base/apc-handle-defs.h"
@@ -91,7 +92,7 @@ StringData* StringData::MakeShared(folly::StringPiece sl) {
   StringData* sd = reinterpret_cast<StringData*>(
     trueStatic ? low_malloc_data(allocSize)
                : UncountedStringOnHugePage() ? malloc_huge(allocSize)
-               : malloc(allocSize));
+               : shared_malloc(allocSize));
   auto const data = reinterpret_cast<char*>(sd + 1);
 
 #ifndef NO_M_DATA
@@ -164,7 +165,7 @@ void StringData::destructUncounted() {
   if (UncountedStringOnHugePage()) {
     free_huge(this);
   } else {
-    free(this);
+    shared_free(this);
   }
 }
 
@@ -912,6 +913,13 @@ int StringData::numericCompare(const StringData *v2) const {
   return -1;
 }
 
+int StringData::find(folly::StringPiece needle, int pos /* = 0 */) const {
+  if (needle.empty() || pos < 0 || pos > size()) return -1;
+  auto const p = simd_memmem(data() + pos, size() - pos,
+                             needle.data(), needle.size());
+  return p ? p - data() : -1;
+}
+
 int StringData::compare(const StringData *v2) const {
   assert(v2);
 
@@ -379,6 +379,15 @@ struct StringData final : MaybeCountable,
    */
   bool isZero() const;
 
+  /*
+   * Return the offset of the first occurrence of `needle' at or after
+   * byte offset `pos', or -1 if there is none (or pos is out of
+   * range).  This is the case-sensitive search kernel the strpos-family
+   * builtins and str_replace bottom out in; it uses the vectorized
+   * engine from util/simd-memmem.h.
+   */
+  int find(folly::StringPiece needle, int pos = 0) const;
+
   /*
    * Change the character at offset `offset' to `c'.
    *
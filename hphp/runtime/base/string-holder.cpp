@@ -26,6 +26,10 @@ StringHolder::StringHolder(const char* data, uint32_t len, bool free)
     m_output(nullptr)
 {}
 
+StringHolder::StringHolder(const char* data, uint32_t len, Type type)
+  : m_data(data), m_len(len), m_type(type), m_output(nullptr)
+{}
+
 StringHolder::StringHolder(StringHolder&& o)
   : m_len(o.m_len), m_type(o.m_type), m_output(std::move(o.m_output))
 {
@@ -63,6 +67,30 @@ const char* StringHolder::data() const {
   return m_data;
 }
 
+std::unique_ptr<folly::IOBuf> StringHolder::detachIOBuf() {
+  if (m_output) {
+    m_data = nullptr;
+    m_len = 0;
+    return std::move(m_output);
+  }
+  auto const data = m_data;
+  auto const len = m_len;
+  if (m_type == Type::StrFree) {
+    // IOBuf's default free function is free(), matching how we would have
+    // released the buffer ourselves.
+    m_data = nullptr;
+    m_len = 0;
+    return folly::IOBuf::takeOwnership(const_cast<char*>(data), len);
+  }
+  if (m_type == Type::StrImmortal) {
+    // The buffer lives forever; let the socket read straight out of it.
+    m_data = nullptr;
+    m_len = 0;
+    return folly::IOBuf::wrapBuffer(data, len);
+  }
+  return folly::IOBuf::copyBuffer(data, len);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }
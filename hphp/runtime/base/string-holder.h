@@ -28,12 +28,16 @@ namespace HPHP {
  * folly::IOBuf.
  *
  * If it is a (char*, len) pair, the char* is not freed on destruction.
+ * StrImmortal additionally promises the buffer outlives the process'
+ * ability to reference it (e.g. static content cache memory), so it may
+ * be handed to the network layer without a copy.
  */
 struct StringHolder {
 
-  enum Type { StrFree, StrNoFree, IOBuf };
+  enum Type { StrFree, StrNoFree, StrImmortal, IOBuf };
 
   explicit StringHolder(const char* data, uint32_t len, bool free = false);
+  StringHolder(const char* data, uint32_t len, Type type);
   StringHolder(StringHolder&&);
 
   ~StringHolder();
@@ -46,6 +50,14 @@ struct StringHolder {
   uint32_t size() const;
   const char* data() const;
 
+  /*
+   * Detach the buffer as an IOBuf without copying when this holder owns
+   * it (StrFree or IOBuf) or when the buffer can never go away
+   * (StrImmortal).  Borrowed data (StrNoFree) is copied, since the
+   * original owner keeps it.  The holder is empty afterwards.
+   */
+  std::unique_ptr<folly::IOBuf> detachIOBuf();
+
 private:
   const char* m_data;
   uint32_t m_len;
@@ -64,6 +64,13 @@ enum SurpriseFlag : size_t {
    */
   PendingPerfEventFlag = 1ull << 62,
 
+  /*
+   * Set when the MemoryManager's deferred-release queue is non-empty
+   * (Eval.DeferArrayRelease).  Like PendingGCFlag, only handled at
+   * safe points.
+   */
+  DeferredReleaseFlag  = 1ull << 63,
+
   /*
    * Flags that shouldn't be cleared by fetchAndClearSurpriseFlags, because
    * fetchAndClearSurpriseFlags is only supposed to touch flags related to
@@ -74,6 +81,7 @@ enum SurpriseFlag : size_t {
     TimedOutFlag |
     CPUTimedOutFlag |
     PendingGCFlag |
+    DeferredReleaseFlag |
     PendingPerfEventFlag,
 
   StickyFlags =
@@ -91,6 +99,7 @@ enum SurpriseFlag : size_t {
    */
   SafepointFlags =
     PendingGCFlag |
+    DeferredReleaseFlag |
     PendingPerfEventFlag,
 
   NonSafepointFlags = ~SafepointFlags & kSurpriseFlagMask,
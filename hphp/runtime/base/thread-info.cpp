@@ -262,6 +262,14 @@ size_t handle_request_surprise(c_WaitableWaitHandle* wh, size_t mask) {
       pendingException = generate_memory_exceeded_exception(wh);
     }
   }
+  if (flags & DeferredReleaseFlag) {
+    if (StickyFlags & DeferredReleaseFlag) {
+      clearSurpriseFlag(DeferredReleaseFlag);
+    }
+    // Drain before any collection below so the collector never sees the
+    // zero-count arrays parked on the queue.
+    MM().drainDeferredReleases();
+  }
   if (flags & PendingGCFlag) {
     if (StickyFlags & PendingGCFlag) {
       clearSurpriseFlag(PendingGCFlag);
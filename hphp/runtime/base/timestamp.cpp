@@ -34,11 +34,23 @@ namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 // creation
 
+static __thread int64_t tl_replayTime = 0; // 0 means "use the real clock"
+
+void TimeStamp::SetReplayTime(int64_t t) {
+  tl_replayTime = t;
+}
+
+void TimeStamp::ClearReplayTime() {
+  tl_replayTime = 0;
+}
+
 int64_t TimeStamp::Current() {
+  if (UNLIKELY(tl_replayTime != 0)) return tl_replayTime;
   return time(0);
 }
 
 double TimeStamp::CurrentSecond() {
+  if (UNLIKELY(tl_replayTime != 0)) return (double)tl_replayTime;
   auto now_ns = vdso::clock_gettime_ns(CLOCK_REALTIME);
   using DoubleSeconds =
     std::chrono::duration<double, std::chrono::seconds::period>;
@@ -55,6 +67,10 @@ const StaticString
 Array TimeStamp::CurrentTime() {
   struct timeval tp;
   gettimeofday(&tp, nullptr);
+  if (UNLIKELY(tl_replayTime != 0)) {
+    tp.tv_sec = tl_replayTime;
+    tp.tv_usec = 0;
+  }
 
   timelib_time_offset *offset =
     timelib_get_time_zone_info(tp.tv_sec, TimeZone::Current()->get());
@@ -72,6 +88,10 @@ Array TimeStamp::CurrentTime() {
 String TimeStamp::CurrentMicroTime() {
   struct timeval tp;
   gettimeofday(&tp, nullptr);
+  if (UNLIKELY(tl_replayTime != 0)) {
+    tp.tv_sec = tl_replayTime;
+    tp.tv_usec = 0;
+  }
   char ret[100];
   snprintf(ret, 100, "%.8F %ld", (double)tp.tv_usec / 1000000, tp.tv_sec);
   return String(ret, CopyString);
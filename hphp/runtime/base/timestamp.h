@@ -38,6 +38,15 @@ struct TimeStamp {
   static Array CurrentTime();
   static String CurrentMicroTime();
 
+  /**
+   * Replay support: while set on this thread, the current-time queries
+   * above report the given time instead of the real clock, so a replayed
+   * request observes the clock as it was when the request was captured.
+   * See ReplayTransport::primeSessionState().
+   */
+  static void SetReplayTime(int64_t t);
+  static void ClearReplayTime();
+
   static int64_t Get(bool &error, int hour = INT_MAX, int minute = INT_MAX,
                  int second = INT_MAX, int month = INT_MAX, int day = INT_MAX,
                  int year = INT_MAX, bool gmt = false);
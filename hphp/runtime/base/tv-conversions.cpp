@@ -321,6 +321,9 @@ void tvCastToStringInPlace(TypedValue* tv) {
       return persistentString(tv->m_data.num ? s_1.get() : staticEmptyString());
 
     case KindOfInt64:
+      if (auto const sd = String::GetIntegerStringData(tv->m_data.num)) {
+        return persistentString(const_cast<StringData*>(sd));
+      }
       return string(buildStringData(tv->m_data.num));
 
     case KindOfDouble:
@@ -385,6 +388,9 @@ StringData* tvCastToString(TypedValue tv) {
       return tv.m_data.num ? s_1.get() : staticEmptyString();
 
     case KindOfInt64:
+      if (auto const sd = String::GetIntegerStringData(tv.m_data.num)) {
+        return const_cast<StringData*>(sd);
+      }
       return buildStringData(tv.m_data.num);
 
     case KindOfDouble:
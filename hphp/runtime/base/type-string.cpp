@@ -26,6 +26,7 @@
 #include "hphp/util/conv-10.h"
 
 #include <algorithm>
+#include <cstring>
 
 namespace HPHP {
 
@@ -124,9 +125,42 @@ void formatPhpDblStr(char **pbuf, double n) {
   vspprintf(pbuf, 0, "%.*G", 14, n);
 }
 
+namespace {
+
+/*
+ * Formatting a double costs far more than allocating the result, and the
+ * serialization paths convert the same handful of values over and over.
+ * Memoize recent conversions per thread, direct-mapped on the bit pattern
+ * (so -0.0 and NAN don't alias 0.0). Entries are plain bytes, so there is
+ * nothing to clean up at request end.
+ */
+constexpr uint64_t kConvertedDblCacheSize = 256; // power of two
+struct ConvertedDblEntry {
+  uint64_t bits;
+  uint8_t len; // 0 for an empty slot
+  char str[23];
+};
+thread_local ConvertedDblEntry t_convertedDbls[kConvertedDblCacheSize];
+
+}
+
 StringData* buildStringData(double n) {
+  uint64_t bits;
+  memcpy(&bits, &n, sizeof(bits));
+  auto& entry = t_convertedDbls[(bits ^ (bits >> 32)) &
+                                (kConvertedDblCacheSize - 1)];
+  if (entry.len != 0 && entry.bits == bits) {
+    return StringData::Make(folly::StringPiece{entry.str, entry.len},
+                            CopyString);
+  }
   char *buf = nullptr;
   formatPhpDblStr(&buf, n);
+  auto const len = strlen(buf);
+  if (len < sizeof(entry.str)) {
+    entry.bits = bits;
+    entry.len = len;
+    memcpy(entry.str, buf, len);
+  }
   return StringData::Make(buf, AttachString);
 }
 
@@ -74,8 +74,10 @@ protected:
   String(StringData* sd, NoIncRef) : m_str(sd, NoIncRef{}) {}
 
 public:
+  // Integer-keyed conversions are overwhelmingly small non-negative
+  // values, so keep "0".."9999" (plus a few small negatives) precomputed.
   static const int MinPrecomputedInteger = SCHAR_MIN;
-  static const int MaxPrecomputedInteger = 4095 + SCHAR_MIN;
+  static const int MaxPrecomputedInteger = 9999;
   static StringData const **converted_integers_raw;
   static StringData const **converted_integers;
 
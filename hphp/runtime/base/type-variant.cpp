@@ -21,6 +21,7 @@
 #include "hphp/runtime/base/comparisons.h"
 #include "hphp/runtime/base/double-to-int64.h"
 #include "hphp/runtime/base/dummy-resource.h"
+#include "hphp/runtime/base/memory-manager.h"
 #include "hphp/runtime/base/req-root.h"
 #include "hphp/runtime/base/runtime-option.h"
 #include "hphp/runtime/base/tv-arith.h"
@@ -150,6 +151,15 @@ RawDestructor g_destructors[] = {
 };
 
 void tweak_variant_dtors() {
+  if (RuntimeOption::EvalDeferArrayRelease) {
+    // Queue dead arrays on the MemoryManager instead of destroying them
+    // inline; drainDeferredReleases() dispatches each through the normal
+    // per-kind release.
+    g_destructors[typeToDestrIdx(KindOfVec)]    = &deferredReleaseArray;
+    g_destructors[typeToDestrIdx(KindOfDict)]   = &deferredReleaseArray;
+    g_destructors[typeToDestrIdx(KindOfKeyset)] = &deferredReleaseArray;
+    g_destructors[typeToDestrIdx(KindOfArray)]  = &deferredReleaseArray;
+  }
   if (RuntimeOption::EnableObjDestructCall) return;
   g_destructors[typeToDestrIdx(KindOfObject)] =
     (RawDestructor)getMethodPtr(&ObjectData::releaseNoObjDestructCheck);
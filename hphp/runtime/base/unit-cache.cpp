@@ -17,15 +17,23 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <sstream>
 #include <cstdlib>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include <folly/ScopeGuard.h>
 #include <folly/portability/Fcntl.h>
 
 #include "hphp/util/assertions.h"
+#include "hphp/util/job-queue.h"
+#include "hphp/util/logger.h"
 #include "hphp/util/rank.h"
 #include "hphp/util/mutex.h"
 #include "hphp/util/process.h"
@@ -154,18 +162,40 @@ CachedUnit lookupUnitRepoAuth(const StringData* path) {
 //////////////////////////////////////////////////////////////////////
 // Non-repo mode unit caching
 
+/*
+ * Estimated bytes held by live CachedUnitWithFree objects.  Accounting is
+ * O(1): a unit is charged when it enters the cache and credited when the
+ * last cache entry referencing it drops.
+ */
+std::atomic<size_t> s_nonRepoCacheBytes{0};
+
 struct CachedUnitWithFree {
   CachedUnitWithFree() = delete;
   explicit CachedUnitWithFree(const CachedUnitWithFree&) = delete;
   CachedUnitWithFree& operator=(const CachedUnitWithFree&) = delete;
 
-  explicit CachedUnitWithFree(const CachedUnit& src) : cu(src) {}
+  explicit CachedUnitWithFree(const CachedUnit& src) : cu(src) {
+    if (cu.unit) {
+      bytes = cu.unit->memoryUsage();
+      s_nonRepoCacheBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    touch();
+  }
   ~CachedUnitWithFree() {
     if (auto oldUnit = cu.unit) {
+      s_nonRepoCacheBytes.fetch_sub(bytes, std::memory_order_relaxed);
       Treadmill::enqueue([oldUnit] { delete oldUnit; });
     }
   }
+
+  // Stamp the LRU clock; called on every cache hit.
+  void touch() const {
+    lastUse.store(Timer::GetCurrentTimeMicros(), std::memory_order_relaxed);
+  }
+
   CachedUnit cu;
+  size_t bytes{0};
+  mutable std::atomic<int64_t> lastUse{0};
 };
 
 struct CachedUnitNonRepo {
@@ -196,6 +226,77 @@ NonRepoUnitCache s_nonRepoUnitCache;
 using PerUserCache = folly::AtomicHashMap<uid_t, NonRepoUnitCache*>;
 PerUserCache s_perUserUnitCaches(10);
 
+/*
+ * Paths with entries in s_nonRepoUnitCache.  The tbb map doesn't support
+ * iteration concurrent with writers, so the evictor and the admin
+ * per-unit report walk this registry instead and look each path up
+ * individually.  Registered paths are static strings and stay registered
+ * until evicted.
+ */
+std::mutex s_cachedUnitPathsLock;
+std::unordered_set<const StringData*> s_cachedUnitPaths;
+
+void registerCachedUnitPath(const StringData* path) {
+  std::lock_guard<std::mutex> l(s_cachedUnitPathsLock);
+  s_cachedUnitPaths.insert(path);
+}
+
+std::vector<const StringData*> snapshotCachedUnitPaths() {
+  std::lock_guard<std::mutex> l(s_cachedUnitPathsLock);
+  return std::vector<const StringData*>(s_cachedUnitPaths.begin(),
+                                        s_cachedUnitPaths.end());
+}
+
+/*
+ * Evict least-recently-used units once the cache's estimated footprint
+ * exceeds Eval.NonRepoUnitCacheMaxBytes, until it drops below 3/4 of the
+ * bound.  Only one thread scans at a time, and no cache entry lock is
+ * held while the registry lock is.  Erasing an entry drops its reference
+ * to the unit; the actual delete goes through the treadmill (see
+ * CachedUnitWithFree), so requests already holding the raw Unit* are
+ * unaffected.  Symlink aliases share one CachedUnitWithFree and thus one
+ * LRU stamp, so they sort together and get evicted together.
+ */
+std::atomic<bool> s_unitEvictionRunning{false};
+
+void maybeEvictUnits() {
+  auto const maxBytes = RuntimeOption::EvalNonRepoUnitCacheMaxBytes;
+  if (maxBytes <= 0) return;
+  if (s_nonRepoCacheBytes.load(std::memory_order_relaxed) <=
+      static_cast<size_t>(maxBytes)) {
+    return;
+  }
+  if (s_unitEvictionRunning.exchange(true)) return;
+  SCOPE_EXIT { s_unitEvictionRunning.store(false); };
+
+  struct Victim {
+    int64_t lastUse;
+    const StringData* path;
+  };
+  std::vector<Victim> victims;
+  for (auto const path : snapshotCachedUnitPaths()) {
+    NonRepoUnitCache::const_accessor acc;
+    if (!s_nonRepoUnitCache.find(acc, path)) continue;
+    auto const& cached = acc->second.cachedUnit;
+    if (!cached || !cached->cu.unit) continue;
+    victims.push_back(
+      Victim{cached->lastUse.load(std::memory_order_relaxed), path}
+    );
+  }
+  std::sort(victims.begin(), victims.end(),
+            [] (const Victim& a, const Victim& b) {
+              return a.lastUse < b.lastUse;
+            });
+
+  auto const target = static_cast<size_t>(maxBytes - maxBytes / 4);
+  for (auto const& victim : victims) {
+    if (s_nonRepoCacheBytes.load(std::memory_order_relaxed) <= target) break;
+    s_nonRepoUnitCache.erase(victim.path);
+    std::lock_guard<std::mutex> l(s_cachedUnitPathsLock);
+    s_cachedUnitPaths.erase(victim.path);
+  }
+}
+
 #ifndef _MSC_VER
 int64_t timespecCompare(const struct timespec& l,
                         const struct timespec& r) {
@@ -230,6 +331,81 @@ bool isChanged(const CachedUnitNonRepo& cu, const struct stat& s) {
          stressUnitCache();
 }
 
+//////////////////////////////////////////////////////////////////////
+// Event-driven invalidation (see unit-cache.h)
+
+/*
+ * Roots a filesystem watcher has committed to reporting changes under, and
+ * the files it has flagged since we last (re)loaded them.  When
+ * Eval.WatchmanUnitInvalidation is set, findFile() answers for unflagged
+ * files under a watched root straight from the cached stat information, so
+ * the steady state issues no stat syscalls for them at all.
+ *
+ * The flag set is keyed by static strings so the watcher thread's inserts
+ * and request threads' lookups agree regardless of where the path string
+ * came from.  Note that flagging a path never frees its cached unit; the
+ * watcher thread only marks it, and the next request that looks it up takes
+ * the normal stat-and-reload path.
+ */
+std::atomic<bool> s_haveWatchedRoots{false};
+std::mutex s_watchedRootsLock;
+std::vector<std::string> s_watchedRoots;
+
+using InvalidatedPathMap = tbb::concurrent_hash_map<
+  const StringData*,     // must be static
+  bool,
+  StringDataHashCompare
+>;
+InvalidatedPathMap s_invalidatedPaths;
+
+bool isWatchedPath(const StringData* path) {
+  if (!s_haveWatchedRoots.load(std::memory_order_acquire)) return false;
+  std::lock_guard<std::mutex> l(s_watchedRootsLock);
+  for (auto const& root : s_watchedRoots) {
+    if (path->size() > root.size() &&
+        !memcmp(path->data(), root.data(), root.size()) &&
+        (root.back() == '/' || path->data()[root.size()] == '/')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * If we're allowed to trust the watcher for `path', synthesize the stat
+ * information the cache recorded when the unit was loaded.  Returns false
+ * whenever the caller needs to do a real stat: option off, unwatched path,
+ * flagged path, or nothing usable in the cache.
+ */
+bool fillStatFromCache(const StringData* path, struct stat* s) {
+#ifdef _MSC_VER
+  return false;
+#else
+  if (!RuntimeOption::EvalWatchmanUnitInvalidation) return false;
+  if (!isWatchedPath(path)) return false;
+  {
+    InvalidatedPathMap::const_accessor acc;
+    if (s_invalidatedPaths.find(acc, path)) return false;
+  }
+  NonRepoUnitCache::const_accessor acc;
+  if (!s_nonRepoUnitCache.find(acc, path)) return false;
+  auto const& cached = acc->second;
+  if (!cached.cachedUnit || !cached.cachedUnit->cu.unit) return false;
+  s->st_mtim = cached.mtime;
+  s->st_ctim = cached.ctime;
+  s->st_ino  = cached.ino;
+  s->st_dev  = cached.devId;
+  // Only regular files make it into the unit cache.
+  s->st_mode = S_IFREG | 0444;
+  return true;
+#endif
+}
+
+void clearInvalidationFlag(const StringData* path) {
+  if (!s_haveWatchedRoots.load(std::memory_order_acquire)) return;
+  s_invalidatedPaths.erase(path);
+}
+
 folly::Optional<String> readFileAsString(Stream::Wrapper* w,
                                          const StringData* path) {
   if (w) {
@@ -389,6 +565,7 @@ CachedUnit loadUnitNonRepoAuth(StringData* requestedPath,
     if (!cache.insert(rpathAcc, rpath)) {
       if (!isChanged(rpathAcc->second, statInfo)) {
         if (ent) ent->setStr("type", "cache_hit_writelock");
+        rpathAcc->second.cachedUnit->touch();
         return rpathAcc->second.cachedUnit;
       }
       if (ent) ent->setStr("type", "cache_stale");
@@ -416,6 +593,7 @@ CachedUnit loadUnitNonRepoAuth(StringData* requestedPath,
 #endif
     rpathAcc->second.ino        = statInfo.st_ino;
     rpathAcc->second.devId      = statInfo.st_dev;
+    clearInvalidationFlag(rpath);
 
     return rpathAcc->second.cachedUnit;
   }();
@@ -432,6 +610,13 @@ CachedUnit loadUnitNonRepoAuth(StringData* requestedPath,
 #endif
     pathAcc->second.ino        = statInfo.st_ino;
     pathAcc->second.devId      = statInfo.st_dev;
+    clearInvalidationFlag(path);
+  }
+
+  if (&cache == &s_nonRepoUnitCache) {
+    registerCachedUnitPath(rpath);
+    if (path != rpath) registerCachedUnitPath(path);
+    maybeEvictUnits();
   }
 
   return cuptr->cu;
@@ -446,6 +631,7 @@ CachedUnit lookupUnitNonRepoAuth(StringData* requestedPath,
     if (s_nonRepoUnitCache.find(acc, requestedPath)) {
       if (!isChanged(acc->second, statInfo)) {
         if (ent) ent->setStr("type", "cache_hit_readlock");
+        acc->second.cachedUnit->touch();
         return acc->second.cachedUnit->cu;
       }
     }
@@ -473,6 +659,10 @@ bool findFile(const StringData* path, struct stat* s, bool allow_dir,
     return lookupUnitRepoAuth(path).unit != nullptr;
   }
 
+  // If a watcher is covering this path and hasn't flagged it, serve the stat
+  // info the unit cache already holds and skip the syscall.
+  if (fillStatFromCache(path, s)) return true;
+
   if (StatCache::stat(path->data(), s) == 0) {
     // The call explicitly populates the struct for dirs, but returns false for
     // them because it is geared toward file includes.
@@ -661,6 +851,48 @@ size_t numLoadedUnits() {
   return s_nonRepoUnitCache.size();
 }
 
+std::string getUnitCacheMemoryReport() {
+  if (RuntimeOption::RepoAuthoritative) {
+    return "unit cache memory accounting is only available in "
+           "non-RepoAuthoritative mode\n";
+  }
+
+  struct Row {
+    size_t bytes;
+    int64_t lastUse;
+    const StringData* path;
+  };
+  std::vector<Row> rows;
+  std::unordered_set<const void*> seen;
+  for (auto const path : snapshotCachedUnitPaths()) {
+    NonRepoUnitCache::const_accessor acc;
+    if (!s_nonRepoUnitCache.find(acc, path)) continue;
+    auto const& cached = acc->second.cachedUnit;
+    if (!cached || !cached->cu.unit) continue;
+    // Symlink aliases share a cache entry; report each unit once, under
+    // the first path we see for it.
+    if (!seen.insert(cached.get()).second) continue;
+    rows.push_back(Row {
+      cached->bytes,
+      cached->lastUse.load(std::memory_order_relaxed),
+      path
+    });
+  }
+  std::sort(
+    rows.begin(), rows.end(),
+    [] (const Row& a, const Row& b) { return a.bytes > b.bytes; }
+  );
+
+  std::ostringstream out;
+  for (auto const& row : rows) {
+    out << row.bytes << " bytes, last used " << row.lastUse << ": "
+        << row.path->data() << "\n";
+  }
+  out << "total: " << s_nonRepoCacheBytes.load(std::memory_order_relaxed)
+      << " bytes in " << rows.size() << " units\n";
+  return out.str();
+}
+
 String resolveVmInclude(StringData* path,
                         const char* currentDir,
                         struct stat* s,
@@ -789,6 +1021,108 @@ void preloadRepo() {
   }
 }
 
+namespace {
+
+using UnitPrefetchItem = std::pair<std::string,MD5>;
+
+struct UnitPrefetchWorker
+  : JobQueueWorker<const UnitPrefetchItem*, void*, true, true> {
+  void doJob(const UnitPrefetchItem* item) override {
+    hphp_session_init();
+    SCOPE_EXIT {
+      hphp_context_exit();
+      hphp_session_exit();
+    };
+
+    try {
+      lookupUnit(String(RuntimeOption::SourceRoot + item->first).get(),
+                 "", nullptr);
+    } catch (...) {
+      // The load was speculative; if a request actually needs this unit
+      // the error will resurface where it can be handled.
+    }
+  }
+};
+
+}
+
+void prefetchRepo() {
+  assertx(RuntimeOption::RepoAuthoritative);
+
+  auto& repo = Repo::get();
+  // Operator-prioritized units (the repo's preload column, already ordered
+  // by priority) go first, then everything else.
+  auto preload = repo.enumerateUnits(RepoIdLocal, true, false);
+  if (preload.empty()) {
+    preload = repo.enumerateUnits(RepoIdCentral, true, false);
+  }
+  auto all = repo.enumerateUnits(RepoIdLocal, false, false);
+  if (all.empty()) {
+    all = repo.enumerateUnits(RepoIdCentral, false, false);
+  }
+
+  auto units = new std::vector<UnitPrefetchItem>(std::move(preload));
+  {
+    std::unordered_set<std::string> seen;
+    for (auto const& kv : *units) seen.insert(kv.first);
+    for (auto& kv : all) {
+      if (seen.count(kv.first)) continue;
+      units->push_back(std::move(kv));
+    }
+  }
+  if (units->empty()) {
+    delete units;
+    return;
+  }
+
+  auto const threads =
+    std::max(static_cast<int>(Process::GetCPUCount()) / 2, 1);
+  auto dispatcher =
+    new JobQueueDispatcher<UnitPrefetchWorker>(threads, 0, false, nullptr);
+  dispatcher->start();
+  for (auto const& item : *units) {
+    dispatcher->enqueue(&item);
+  }
+
+  // Reap the pool (and the enumerated paths the jobs point into) once the
+  // queue drains; serving proceeds concurrently in the meantime.
+  std::thread([dispatcher, units] {
+    dispatcher->waitEmpty();  // stops the workers once the queue drains
+    Logger::Info("background unit prefetch: %zu units loaded",
+                 units->size());
+    delete dispatcher;
+    delete units;
+  }).detach();
+}
+
+void subscribeUnitInvalidation(const std::string& root) {
+  if (root.empty()) return;
+  std::lock_guard<std::mutex> l(s_watchedRootsLock);
+  if (std::find(s_watchedRoots.begin(), s_watchedRoots.end(), root) ==
+      s_watchedRoots.end()) {
+    s_watchedRoots.push_back(root);
+  }
+  s_haveWatchedRoots.store(true, std::memory_order_release);
+}
+
+void unsubscribeUnitInvalidation(const std::string& root) {
+  std::lock_guard<std::mutex> l(s_watchedRootsLock);
+  s_watchedRoots.erase(
+    std::remove(s_watchedRoots.begin(), s_watchedRoots.end(), root),
+    s_watchedRoots.end()
+  );
+  if (s_watchedRoots.empty()) {
+    s_haveWatchedRoots.store(false, std::memory_order_release);
+  }
+}
+
+void invalidateCachedUnit(const std::string& path) {
+  if (!s_haveWatchedRoots.load(std::memory_order_acquire)) return;
+  InvalidatedPathMap::accessor acc;
+  s_invalidatedPaths.insert(acc, makeStaticString(path));
+  acc->second = true;
+}
+
 //////////////////////////////////////////////////////////////////////
 
 }
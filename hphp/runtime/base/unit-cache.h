@@ -68,6 +68,13 @@ std::string mangleUnitMd5(const std::string& fileMd5);
  */
 size_t numLoadedUnits();
 
+/*
+ * Return a text report of the memory held by each unit in the non-repo
+ * unit cache, sorted by size, plus the total the cache is charged with.
+ * Exported for the admin request handler.
+ */
+std::string getUnitCacheMemoryReport();
+
 /*
  * Resolve an include path, for the supplied path and directory, using the same
  * rules as PHP's fopen() or include.  May return a null String if the path
@@ -86,6 +93,33 @@ String resolveVmInclude(StringData* path,
 
 void preloadRepo();
 
+/*
+ * Speculatively load units from the repo on a background worker pool, so
+ * early requests don't each pay SQLite query latency to materialize them
+ * serially through lookupUnit().  Units the repo marks for preload come
+ * first, then everything else.  Returns as soon as the pool is started;
+ * loading proceeds concurrently with serving.  RepoAuthoritative only;
+ * gated by Repo.BackgroundPrefetch.
+ */
+void prefetchRepo();
+
+/*
+ * Event-driven invalidation of the non-RepoAuthoritative unit cache.
+ *
+ * When Eval.WatchmanUnitInvalidation is set, the watchman extension
+ * registers each subscribed root here and reports every file watchman
+ * flags as changed via invalidateCachedUnit().  lookupUnit() then trusts
+ * cached entries for unflagged files under a registered root without
+ * re-stat()ing them, so steady-state requests touch the filesystem only
+ * for files that actually changed.
+ *
+ * Files under unregistered roots (and everything else when the option is
+ * off) keep going through the normal stat path.
+ */
+void subscribeUnitInvalidation(const std::string& root);
+void unsubscribeUnitInvalidation(const std::string& root);
+void invalidateCachedUnit(const std::string& path);
+
 //////////////////////////////////////////////////////////////////////
 
 }
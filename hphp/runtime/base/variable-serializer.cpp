@@ -38,6 +38,10 @@
 #include "hphp/runtime/ext/std/ext_std_closure.h"
 #include "hphp/runtime/vm/native-data.h"
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -162,6 +166,27 @@ String VariableSerializer::serialize(const Variant& v, bool ret,
   return String();
 }
 
+void VariableSerializer::serializeToOutput(const Variant& v) {
+  StringBuffer buf;
+  m_buf = &buf;
+  buf.setOutputLimit(StringData::MaxSize);
+  m_chunkedOutput = true;
+  m_valueCount = 1;
+  write(v);
+  m_chunkedOutput = false;
+  String str = buf.detach();
+  if (!str.empty()) {
+    g_context->write(str);
+  }
+}
+
+void VariableSerializer::flushChunk() {
+  // Only called between array values, so nothing can rewind the buffer
+  // across what we hand off here (appendJsonEscape's error rewind stays
+  // within the current string, which is always entirely unflushed).
+  g_context->write(m_buf->detach());
+}
+
 String VariableSerializer::serializeValue(const Variant& v, bool limit) {
   StringBuffer buf;
   m_buf = &buf;
@@ -377,14 +402,48 @@ static void appendJsonEscape(StringBuffer& sb,
 
   // Do a fast path for ASCII characters that don't need escaping
   int pos = 0;
-  do {
+#ifdef __x86_64__
+  // Bulk-copy 16-byte runs that contain no byte needing the decoder: the
+  // signed compare against ' ' catches control characters and non-ASCII
+  // at once, and the equality compares cover the printable characters
+  // jsonNoEscape singles out. The first special byte ends the run and
+  // drops us into the byte-at-a-time loop below, which hands the rest of
+  // the string to the decoder exactly as before.
+  while (len - pos >= 16) {
+    auto const chunk =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+    auto const special = _mm_movemask_epi8(_mm_or_si128(
+      _mm_or_si128(
+        _mm_or_si128(_mm_cmplt_epi8(chunk, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"'))),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')),
+                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('/')))),
+      _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')),
+                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>'))),
+        _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('&')),
+                       _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\''))),
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('@')),
+                       _mm_cmpeq_epi8(chunk, _mm_set1_epi8('%')))))));
+    if (special != 0) {
+      auto const run = __builtin_ctz(special);
+      sb.append(s + pos, run);
+      pos += run;
+      break;
+    }
+    sb.append(s + pos, 16);
+    pos += 16;
+  }
+#endif
+  while (pos < len) {
     int c = s[pos];
     if (UNLIKELY((unsigned char)c >= 128 || !jsonNoEscape[c])) {
       goto utf8_decode;
     }
     sb.append((char)c);
     pos++;
-  } while (pos < len);
+  }
   sb.append('"');
   return;
 
@@ -1165,6 +1224,10 @@ void VariableSerializer::writeArrayValue(
 
   ArrayInfo &last_info = m_arrayInfos.back();
   last_info.first_element = false;
+
+  if (UNLIKELY(m_chunkedOutput) && m_buf->size() >= kChunkThreshold) {
+    flushChunk();
+  }
 }
 
 void VariableSerializer::writeArrayFooter(
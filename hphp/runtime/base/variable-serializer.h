@@ -68,6 +68,12 @@ struct VariableSerializer {
   String serialize(const Variant& v, bool ret, bool keepCount = false);
   String serializeValue(const Variant& v, bool limit);
 
+  // Serialize straight into the request's output buffer chain, flushing
+  // chunk by chunk instead of materializing the whole result. The caller
+  // gives up the ability to suppress partial output on error, so this is
+  // opt-in (JSON_FB_STREAM_OUTPUT); check json_last_error() afterwards.
+  void serializeToOutput(const Variant& v);
+
   // Serialize with limit size of output, always return the serialized string.
   // It does not work with Serialize, JSON, APCSerialize, DebuggerSerialize.
   String serializeWithLimit(const Variant& v, int limit);
@@ -121,6 +127,7 @@ private:
    * Helpers.
    */
   void indent();
+  void flushChunk();
   void setReferenced(bool referenced) { m_referenced = referenced;}
   void setRefCount(int count) { m_refCount = count;}
   bool incNestedLevel(const TypedValue& tv);
@@ -186,6 +193,10 @@ private:
   int m_maxLevelDebugger;        // for max level of DebuggerSerialize
   size_t m_currentDepth;         // current depth (nasted objects/arrays)
   size_t m_maxDepth;             // max depth limit before an error (0 -> none)
+  bool m_chunkedOutput{false};   // stream to g_context between array values
+
+  // Flush threshold for serializeToOutput.
+  static constexpr int kChunkThreshold = 64 * 1024;
 
   struct ArrayInfo {
     bool is_object;     // nested arrays or objects
@@ -16,6 +16,7 @@
 #include "hphp/runtime/base/variable-unserializer.h"
 
 #include <algorithm>
+#include <memory>
 #include <utility>
 
 #include <folly/Conv.h>
@@ -47,6 +48,8 @@
 
 #include "hphp/runtime/vm/jit/perf-counters.h"
 
+#include "hphp/util/safe-cast.h"
+
 namespace HPHP {
 
 namespace {
@@ -527,6 +530,14 @@ bool VariableUnserializer::matchString(folly::StringPiece str) {
   return true;
 }
 
+bool VariableUnserializer::matchRawString(folly::StringPiece str) {
+  auto const ss = str.size();
+  if (m_buf + ss > m_end) return false;
+  if (memcmp(m_buf, str.data(), ss)) return false;
+  m_buf += ss;
+  return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // remainingProps should include the current property being unserialized.
@@ -704,6 +715,30 @@ Class* tryAlternateCollectionClass(const StringData* clsName) {
   return altName ? Unit::getClass(altName, /* autoload */ false) : nullptr;
 }
 
+/*
+ * Return the cached UnserializeShape for 'cls', rendering and caching it on
+ * first use.  The rendered token for each declared property is byte-for-byte
+ * what VariableSerializer emits for that property's key, so matching the
+ * input against the shape is a plain memcmp per property.
+ */
+const UnserializeShape* unserializeShapeFor(Class* cls) {
+  if (auto const shape = cls->getUnserializeShape()) return shape;
+  auto shape = std::make_unique<UnserializeShape>();
+  shape->keys.reserve(cls->numDeclProperties());
+  for (auto const& prop : cls->declProperties()) {
+    auto const name = prop.mangledName->slice();
+    auto const offset = shape->tokens.size();
+    shape->tokens += "s:";
+    shape->tokens += std::to_string(name.size());
+    shape->tokens += ":\"";
+    shape->tokens.append(name.data(), name.size());
+    shape->tokens += "\";";
+    shape->keys.push_back({safe_cast<uint32_t>(offset),
+                           safe_cast<uint32_t>(shape->tokens.size() - offset)});
+  }
+  return cls->setUnserializeShape(shape.release());
+}
+
 /*
  * Try to read 'str' while advancing 'cur' without reaching 'end'.
  */
@@ -1007,13 +1042,19 @@ void VariableUnserializer::unserializeVariant(
             Repo::get().global().HardPrivatePropInference;
           Class* objCls = obj->getVMClass();
           auto remainingProps = size;
-          // Try fast case.
+          // Try fast case: match the input against the class's precompiled
+          // key shape, writing each matched value straight into its slot.
           if (size >= objCls->numDeclProperties()) {
             bool mismatch = false;
             auto objProps = obj->propVec();
+            auto const shape = unserializeShapeFor(objCls);
+            auto const tokens = shape->tokens.data();
+            size_t slot = 0;
 
             for (auto prop : objCls->declProperties()) {
-              if (!matchString(prop.mangledName->slice())) {
+              auto const& key = shape->keys[slot++];
+              if (!matchRawString(
+                    folly::StringPiece{tokens + key.offset, key.size})) {
                 mismatch = true;
                 break;
               }
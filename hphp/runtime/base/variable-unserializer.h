@@ -21,11 +21,38 @@
 #include "hphp/runtime/base/type-variant.h"
 #include "hphp/util/compact-tagged-ptrs.h"
 
+#include <string>
+#include <vector>
+
 namespace HPHP {
+struct Class;
 struct StringBuffer;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*
+ * Precompiled unserialization shape for a class.
+ *
+ * 'tokens' holds the exact bytes the serializer emits for each declared
+ * property key, in declared order (e.g. s:4:"name"; with the usual mangling
+ * for private and protected properties), concatenated back to back; 'keys'
+ * records the extent of each property's token within it.  With the shape in
+ * hand, matching the next property key in the input costs one bounds check
+ * and one memcmp, with no per-key length formatting.
+ *
+ * Shapes are built lazily by VariableUnserializer the first time an instance
+ * of a class is unserialized, and cached on the Class; any input that doesn't
+ * match the shape falls back to the generic property-by-property path.
+ */
+struct UnserializeShape {
+  struct Key {
+    uint32_t offset;
+    uint32_t size;
+  };
+  std::string tokens;
+  std::vector<Key> keys; // parallel to Class::declProperties()
+};
+
 enum class UnserializeMode {
   Value = 0,
   Key = 1,
@@ -105,6 +132,13 @@ struct VariableUnserializer {
    */
   bool matchString(folly::StringPiece str);
 
+  /*
+   * Attempt to consume the exact byte sequence str (a pre-rendered token,
+   * including any serialization framing). Return false and rewind the stream
+   * on mismatch.
+   */
+  bool matchRawString(folly::StringPiece str);
+
   /*
    * Accessors.
    */
@@ -28,6 +28,7 @@
 #endif
 
 #include "hphp/util/bstring.h"
+#include "hphp/util/simd-memmem.h"
 #include "hphp/runtime/base/exceptions.h"
 #include "hphp/runtime/base/string-buffer.h"
 #include "hphp/runtime/base/runtime-error.h"
@@ -402,22 +403,7 @@ int string_rfind(const char *input, int len, const char *s, int s_len,
 
 const char *string_memnstr(const char *haystack, const char *needle,
                            int needle_len, const char *end) {
-  const char *p = haystack;
-  char ne = needle[needle_len-1];
-
-  end -= needle_len;
-  while (p <= end) {
-    if ((p = (char *)memchr(p, *needle, (end-p+1))) && ne == p[needle_len-1]) {
-      if (!memcmp(needle, p, needle_len-1)) {
-        return p;
-      }
-    }
-    if (p == nullptr) {
-      return nullptr;
-    }
-    p++;
-  }
-  return nullptr;
+  return simd_memmem(haystack, end - haystack, needle, needle_len);
 }
 
 String string_replace(const char *s, int len, int start, int length,
@@ -21,6 +21,10 @@
 
 #include <folly/portability/String.h>
 
+#ifdef __x86_64__
+#include <emmintrin.h>
+#endif
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -316,31 +320,99 @@ static int php_htoi(char *s) {
 
 static unsigned char hexchars[] = "0123456789ABCDEF";
 
-String url_encode(const char *s, size_t len) {
-  String retString(safe_address(len, 3, 1), ReserveString);
-  register unsigned char c;
-  unsigned char *to, *start;
-  unsigned char const *from, *end;
-
-  from = (unsigned char const *)s;
-  end = (unsigned char const *)s + len;
-  start = to = (unsigned char *)retString.mutableData();
+/*
+ * Offset of the next byte the decoders have to rewrite -- a '%' escape, or
+ * '+' when plusAsSpace -- or len if the whole buffer passes through
+ * unchanged.  Typical URLs are dominated by clean runs, so scanning for the
+ * next candidate and bulk-copying everything in between beats the
+ * byte-at-a-time loop.
+ */
+static size_t find_decode_candidate(const char *data, size_t len,
+                                    bool plusAsSpace) {
+  size_t pos = 0;
+#ifdef __x86_64__
+  const __m128i pct = _mm_set1_epi8('%');
+  const __m128i plus = _mm_set1_epi8('+');
+  while (len - pos >= 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+    __m128i hits = _mm_cmpeq_epi8(chunk, pct);
+    if (plusAsSpace) {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, plus));
+    }
+    unsigned mask = _mm_movemask_epi8(hits);
+    if (mask) return pos + __builtin_ctz(mask);
+    pos += 16;
+  }
+#endif
+  for (; pos < len; pos++) {
+    if (data[pos] == '%' || (plusAsSpace && data[pos] == '+')) break;
+  }
+  return pos;
+}
 
-  while (from < end) {
-    c = *from++;
+/*
+ * Offset of the next byte the encoders can't pass through unchanged --
+ * anything but an alphanumeric, '-', '.', '_', or '~' when raw -- or len.
+ * Bytes >= 0x80 are negative in the signed epi8 compares, so they fall
+ * outside every safe range and classify as candidates, as they should.
+ */
+static size_t find_encode_candidate(const char *data, size_t len, bool raw) {
+  size_t pos = 0;
+#ifdef __x86_64__
+  auto in_range = [] (__m128i c, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(lo - 1)),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), c));
+  };
+  while (len - pos >= 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+    __m128i safe = _mm_or_si128(
+      _mm_or_si128(in_range(chunk, '0', '9'), in_range(chunk, 'A', 'Z')),
+      in_range(chunk, 'a', 'z'));
+    safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('-')));
+    safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.')));
+    safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+    if (raw) {
+      safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('~')));
+    }
+    unsigned mask = ~_mm_movemask_epi8(safe) & 0xffff;
+    if (mask) return pos + __builtin_ctz(mask);
+    pos += 16;
+  }
+#endif
+  for (; pos < len; pos++) {
+    unsigned char c = data[pos];
+    if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') ||
+        (c >= 'a' && c <= 'z') ||
+        c == '-' || c == '.' || c == '_' || (raw && c == '~')) {
+      continue;
+    }
+    break;
+  }
+  return pos;
+}
 
+String url_encode(const char *s, size_t len) {
+  String retString(safe_address(len, 3, 1), ReserveString);
+  unsigned char const *from = (unsigned char const *)s;
+  unsigned char *start = (unsigned char *)retString.mutableData();
+  unsigned char *to = start;
+
+  size_t i = 0;
+  while (i < len) {
+    size_t run = find_encode_candidate(s + i, len - i, false);
+    memcpy(to, from + i, run);
+    to += run;
+    i += run;
+    if (i == len) break;
+
+    unsigned char c = from[i++];
     if (c == ' ') {
       *to++ = '+';
-    } else if ((c < '0' && c != '-' && c != '.') ||
-           (c < 'A' && c > '9') ||
-           (c > 'Z' && c < 'a' && c != '_') ||
-           (c > 'z')) {
+    } else {
       to[0] = '%';
       to[1] = hexchars[c >> 4];
       to[2] = hexchars[c & 15];
       to += 3;
-    } else {
-      *to++ = c;
     }
   }
   retString.setSize(to - start);
@@ -350,23 +422,29 @@ String url_encode(const char *s, size_t len) {
 String url_decode(const char *s, size_t len) {
   String retString(s, len, CopyString);
   char *str = retString.mutableData();
-  char *dest = str;
-  char *data = str;
 
-  while (len--) {
-    if (*data == '+') {
-      *dest = ' ';
-    }
-    else if (*data == '%' && len >= 2 && isxdigit((int) *(data + 1))
-         && isxdigit((int) *(data + 2))) {
-      *dest = (char) php_htoi(data + 1);
-      data += 2;
-      len -= 2;
+  // The copy is already correct up to the first byte needing a rewrite.
+  size_t i = find_decode_candidate(str, len, true);
+  if (i == len) return retString;
+
+  char *dest = str + i;
+  while (i < len) {
+    if (str[i] == '+') {
+      *dest++ = ' ';
+      i++;
+    } else if (str[i] == '%' && len - i >= 3 &&
+               isxdigit((int)(unsigned char)str[i + 1]) &&
+               isxdigit((int)(unsigned char)str[i + 2])) {
+      *dest++ = (char)php_htoi(str + i + 1);
+      i += 3;
     } else {
-      *dest = *data;
+      // A '%' without a valid escape (or a trailing one) stays literal.
+      *dest++ = str[i++];
     }
-    data++;
-    dest++;
+    size_t run = find_decode_candidate(str + i, len - i, true);
+    memmove(dest, str + i, run);
+    dest += run;
+    i += run;
   }
   retString.setSize(dest - str);
   return retString;
@@ -400,41 +478,49 @@ size_t url_decode_ex(char *value, size_t len) {
 
 String url_raw_encode(const char *s, size_t len) {
   String retString(safe_address(len, 3, 1), ReserveString);
-  size_t x, y;
-  unsigned char *str = (unsigned char *)retString.mutableData();
-
-  for (x = 0, y = 0; len--; x++, y++) {
-    str[y] = (unsigned char) s[x];
-    if ((str[y] < '0' && str[y] != '-' && str[y] != '.') ||
-      (str[y] < 'A' && str[y] > '9') ||
-        (str[y] > 'Z' && str[y] < 'a' && str[y] != '_') ||
-      (str[y] > 'z' && str[y] != '~')) {
-      str[y++] = '%';
-      str[y++] = hexchars[(unsigned char) s[x] >> 4];
-      str[y] = hexchars[(unsigned char) s[x] & 15];
-    }
+  unsigned char const *from = (unsigned char const *)s;
+  unsigned char *start = (unsigned char *)retString.mutableData();
+  unsigned char *to = start;
+
+  size_t i = 0;
+  while (i < len) {
+    size_t run = find_encode_candidate(s + i, len - i, true);
+    memcpy(to, from + i, run);
+    to += run;
+    i += run;
+    if (i == len) break;
+
+    unsigned char c = from[i++];
+    to[0] = '%';
+    to[1] = hexchars[c >> 4];
+    to[2] = hexchars[c & 15];
+    to += 3;
   }
-  retString.setSize(y);
+  retString.setSize(to - start);
   return retString;
 }
 
 String url_raw_decode(const char *s, size_t len) {
   String retString(s, len, CopyString);
   char *str = retString.mutableData();
-  char *dest = str;
-  char *data = str;
-
-  while (len--) {
-    if (*data == '%' && len >= 2 && isxdigit((int) *(data + 1))
-        && isxdigit((int) *(data + 2))) {
-      *dest = (char) php_htoi(data + 1);
-      data += 2;
-      len -= 2;
+
+  size_t i = find_decode_candidate(str, len, false);
+  if (i == len) return retString;
+
+  char *dest = str + i;
+  while (i < len) {
+    if (str[i] == '%' && len - i >= 3 &&
+        isxdigit((int)(unsigned char)str[i + 1]) &&
+        isxdigit((int)(unsigned char)str[i + 2])) {
+      *dest++ = (char)php_htoi(str + i + 1);
+      i += 3;
     } else {
-      *dest = *data;
+      *dest++ = str[i++];
     }
-    data++;
-    dest++;
+    size_t run = find_decode_candidate(str + i, len - i, false);
+    memmove(dest, str + i, run);
+    dest += run;
+    i += run;
   }
   retString.setSize(dest - str);
   return retString;
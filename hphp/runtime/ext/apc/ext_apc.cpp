@@ -28,10 +28,12 @@
 #include <type_traits>
 
 #include <folly/portability/SysTime.h>
+#include <folly/portability/Unistd.h>
 
 #include "hphp/util/alloc.h"
 #include "hphp/util/async-job.h"
 #include "hphp/util/boot-stats.h"
+#include "hphp/util/hash-map-typedefs.h"
 #include "hphp/util/hdf.h"
 #include "hphp/util/logger.h"
 
@@ -46,6 +48,9 @@
 #include "hphp/runtime/base/variable-serializer.h"
 #include "hphp/runtime/base/concurrent-shared-store.h"
 #include "hphp/runtime/base/ini-setting.h"
+#include "hphp/runtime/base/rds.h"
+#include "hphp/runtime/base/request-local.h"
+#include "hphp/runtime/base/static-string-table.h"
 #include "hphp/runtime/base/config.h"
 #include "hphp/runtime/base/apc-file-storage.h"
 #include "hphp/runtime/server/cli-server.h"
@@ -191,6 +196,22 @@ void apcExtension::moduleLoad(const IniSetting::Map& ini, Hdf config) {
 
   Config::Bind(NoTTLPrefix, ini, config, "Server.APC.NoTTLPrefix");
 
+  // Opt-in: repeated apc_fetch of an unchanged key within one request
+  // hits a request-local array instead of the shared store. Note that
+  // cached object values keep their identity across fetches in the same
+  // request, unlike the default behavior of materializing a fresh copy.
+  Config::Bind(RequestLocalCache, ini, config,
+               "Server.APC.RequestLocalCache", false);
+
+  // String values of at least CompressionThreshold bytes are stored
+  // LZ4-compressed and decompressed on each fetch; 0 disables. Entries
+  // fetched at least CompressionHotCount times are swapped back to the
+  // plain representation so hot keys don't pay for decompression forever.
+  Config::Bind(CompressionThreshold, ini, config,
+               "Server.APC.CompressionThreshold", 0);
+  Config::Bind(CompressionHotCount, ini, config,
+               "Server.APC.CompressionHotCount", 16);
+
 #ifdef NO_M_DATA
   Config::Bind(UseUncounted, ini, config, "Server.APC.MemModelTreadmill", true);
 #else
@@ -248,6 +269,7 @@ void apcExtension::moduleInit() {
   HHVM_FE(apc_store);
   HHVM_FE(apc_store_as_primed_do_not_use);
   HHVM_FE(apc_fetch);
+  HHVM_FE(apc_bind_local);
   HHVM_FE(apc_delete);
   HHVM_FE(apc_clear_cache);
   HHVM_FE(apc_inc);
@@ -302,6 +324,9 @@ bool apcExtension::UseUncounted = true;
 #else
 bool apcExtension::UseUncounted = false;
 #endif
+bool apcExtension::RequestLocalCache = false;
+int64_t apcExtension::CompressionThreshold = 0;
+int apcExtension::CompressionHotCount = 16;
 bool apcExtension::Stat = true;
 // Different from zend default but matches what we've been returning for years
 bool apcExtension::EnableCLI = true;
@@ -385,32 +410,144 @@ Variant HHVM_FUNCTION(apc_add,
   return apc_store().add(strKey, var, ttl);
 }
 
+namespace {
+
+/*
+ * Request-local cache over single-key apc_fetch, enabled with
+ * Server.APC.RequestLocalCache. Entries are only trusted while the
+ * store's version counter is unchanged; any APC write flushes the
+ * whole cache on the next fetch.
+ */
+struct ApcRequestLocalCache final : RequestEventHandler {
+  void requestInit() override {
+    m_cache.reset();
+    m_version = 0;
+  }
+  void requestShutdown() override {
+    m_cache.reset();
+    m_version = 0;
+  }
+  Array m_cache;
+  uint64_t m_version{0};
+};
+IMPLEMENT_STATIC_REQUEST_LOCAL(ApcRequestLocalCache, s_apc_local_cache);
+
+/*
+ * Per-key second-level caches for apc_bind_local.  Each bound key gets an
+ * anonymous normal-mode RDS entry holding the value the key resolved to and
+ * the store version it was resolved at, so a read on a bound key is a
+ * version compare and a TypedValue copy with no shared-store probe.  Only
+ * values with no request-local ownership are cached (nulls, bools, ints,
+ * doubles, and static or uncounted strings and arrays): those can be copied
+ * without reference counting, and the treadmill keeps uncounted data alive
+ * for the rest of any request that observed it.  RDS generation numbers
+ * invalidate every entry at the start of each request.
+ */
+struct ApcBoundValue {
+  uint64_t version;
+  TypedValue value;  // kInvalidDataType means the key was absent
+};
+
+folly::SharedMutex s_bindLock;
+hphp_hash_map<const StringData*, rds::Link<ApcBoundValue>,
+              string_data_hash, string_data_same> s_boundKeys;
+std::atomic<size_t> s_numBoundKeys{0};
+
+rds::Link<ApcBoundValue> findBoundKey(const StringData* key) {
+  folly::SharedMutex::ReadHolder l(s_bindLock);
+  auto const it = s_boundKeys.find(key);
+  if (it == s_boundKeys.end()) {
+    return rds::Link<ApcBoundValue>(rds::kInvalidHandle);
+  }
+  return it->second;
+}
+
+TypedValue apc_fetch_bound(rds::Link<ApcBoundValue> link,
+                           const String& key, VRefParam success) {
+  // Read the version before probing the store: at worst we stamp a fresher
+  // value with an older version and refetch it next time.
+  auto const version = apc_store().version();
+  if (link.isInit() && link->version == version) {
+    auto const& cached = link->value;
+    if (cached.m_type != kInvalidDataType) {
+      success.assignIfRef(true);
+      return cached;
+    }
+    success.assignIfRef(false);
+    return make_tv<KindOfBoolean>(false);
+  }
+
+  Variant v;
+  auto const found = apc_store().get(key, v);
+  auto const tv = v.asTypedValue();
+  if (!found || !isRefcountedType(tv->m_type)) {
+    link->version = version;
+    if (found) {
+      link->value = *tv;
+    } else {
+      link->value.m_type = kInvalidDataType;
+    }
+    link.markInit();
+  }
+  success.assignIfRef(found);
+  if (!found) return make_tv<KindOfBoolean>(false);
+  return tvReturn(std::move(v));
+}
+
+TypedValue apc_fetch_request_local(const String& key, VRefParam success) {
+  auto& cache = *s_apc_local_cache;
+  auto const version = apc_store().version();
+  if (cache.m_version != version) {
+    cache.m_cache = Array::Create();
+    cache.m_version = version;
+  } else if (cache.m_cache.exists(key, true)) {
+    success.assignIfRef(true);
+    Variant v = cache.m_cache[key];
+    return tvReturn(std::move(v));
+  }
+  Variant v;
+  if (!apc_store().get(key, v)) {
+    success.assignIfRef(false);
+    return make_tv<KindOfBoolean>(false);
+  }
+  cache.m_cache.set(key, v, true);
+  success.assignIfRef(true);
+  return tvReturn(std::move(v));
+}
+
+}
+
 TypedValue HHVM_FUNCTION(apc_fetch, const Variant& key, VRefParam success) {
   if (!apcExtension::Enable) return make_tv<KindOfBoolean>(false);
 
   Variant v;
 
   if (key.isArray()) {
-    bool tmp = false;
     Array keys = key.toArray();
-    ArrayInit init(keys.size(), ArrayInit::Map{});
     for (ArrayIter iter(keys); iter; ++iter) {
-      Variant k = iter.second();
-      if (!k.isString()) {
+      if (!iter.second().isString()) {
         throw_invalid_argument("apc key: (not a string)");
         return make_tv<KindOfBoolean>(false);
       }
-      String strKey = k.toString();
-      if (apc_store().get(strKey, v)) {
-        tmp = true;
-        init.set(strKey, v);
-      }
     }
+    ArrayInit init(keys.size(), ArrayInit::Map{});
+    auto const tmp = apc_store().getMulti(keys, init);
     success.assignIfRef(tmp);
     return tvReturn(init.toVariant());
   }
 
-  if (apc_store().get(key.toString(), v)) {
+  auto const strKey = key.toString();
+
+  if (UNLIKELY(s_numBoundKeys.load(std::memory_order_relaxed) != 0)) {
+    auto const link = findBoundKey(strKey.get());
+    if (link.bound()) return apc_fetch_bound(link, strKey, success);
+  }
+
+  if (UNLIKELY(apcExtension::RequestLocalCache)) {
+    return apc_fetch_request_local(strKey, success);
+  }
+
+  if (apc_store().get(strKey, v)) {
     success.assignIfRef(true);
   } else {
     success.assignIfRef(false);
@@ -419,6 +556,28 @@ TypedValue HHVM_FUNCTION(apc_fetch, const Variant& key, VRefParam success) {
   return tvReturn(std::move(v));
 }
 
+bool HHVM_FUNCTION(apc_bind_local, const String& key) {
+  if (!apcExtension::Enable) return false;
+  if (key.empty()) {
+    throw_invalid_argument("apc key: (empty)");
+    return false;
+  }
+
+  // Bound keys live for the process; intern the key so the registry can
+  // hold it without ownership concerns.
+  auto const sd = makeStaticString(key.get());
+  {
+    folly::SharedMutex::ReadHolder l(s_bindLock);
+    if (s_boundKeys.count(sd)) return true;
+  }
+  auto const link = rds::alloc<ApcBoundValue>(rds::Mode::Normal);
+  folly::SharedMutex::WriteHolder l(s_bindLock);
+  if (s_boundKeys.emplace(sd, link).second) {
+    s_numBoundKeys.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
 Variant HHVM_FUNCTION(apc_delete,
                       const Variant& key) {
   if (!apcExtension::Enable) return false;
@@ -628,6 +787,9 @@ static size_t s_const_map_size = 0;
 
 static SnapshotBuilder s_snapshotBuilder;
 
+// Whether apc_load (or a takeover transfer) has already primed the store.
+static bool s_apc_primed = false;
+
 void apc_load(int thread) {
 #ifndef _MSC_VER
   static void *handle = nullptr;
@@ -638,6 +800,7 @@ void apc_load(int thread) {
   }
   BootStats::Block timer("loading APC data");
   if (apc_store().primeFromSnapshot(apcExtension::PrimeLibrary.c_str())) {
+    s_apc_primed = true;
     return;
   }
   Logger::Info("Fall back to shared object format");
@@ -667,6 +830,7 @@ void apc_load(int thread) {
   }
 
   apc_store().primeDone();
+  s_apc_primed = true;
   if (!upgradeDest.empty()) {
     BootStats::Block block("SnapshotBuilder::writeToFile");
     s_snapshotBuilder.writeToFile(upgradeDest);
@@ -681,6 +845,29 @@ void apc_advise_out() {
   apc_store().adviseOut();
 }
 
+int apc_takeover_snapshot_fd() {
+  return apc_store().snapshotFd();
+}
+
+bool apc_prime_from_fd(int fd) {
+#ifdef _MSC_VER
+  return false;
+#else
+  if (s_apc_primed || !apcExtension::Enable) {
+    // We already have (or were configured not to want) primed data;
+    // don't stack the predecessor's on top of it.
+    close(fd);
+    return false;
+  }
+  BootStats::Block timer("loading APC data from predecessor");
+  if (!apc_store().primeFromSnapshotFd(fd)) {
+    return false;
+  }
+  s_apc_primed = true;
+  return true;
+#endif
+}
+
 size_t get_const_map_size() {
   return s_const_map_size;
 }
@@ -63,6 +63,9 @@ struct apcExtension final : Extension {
   static bool FileStorageKeepFileLinked;
   static std::vector<std::string> NoTTLPrefix;
   static bool UseUncounted;
+  static bool RequestLocalCache;
+  static int64_t CompressionThreshold;
+  static int CompressionHotCount;
   static bool Stat;
   static bool EnableCLI;
 
@@ -88,6 +91,8 @@ bool HHVM_FUNCTION(apc_store_as_primed_do_not_use,
 TypedValue HHVM_FUNCTION(apc_fetch,
                          const Variant& key,
                          VRefParam success = uninit_null());
+bool HHVM_FUNCTION(apc_bind_local,
+                   const String& key);
 Variant HHVM_FUNCTION(apc_delete,
                       const Variant& key);
 bool HHVM_FUNCTION(apc_clear_cache,
@@ -123,6 +128,14 @@ void apc_load(int thread);
 // Evict any file-backed APC values from OS page cache.
 void apc_advise_out();
 
+// The fd of the mapped snapshot we primed from (-1 if none). Used to
+// hand the snapshot to a server taking over our listen socket.
+int apc_takeover_snapshot_fd();
+
+// Prime from a snapshot fd inherited from a predecessor server during
+// takeover. Takes ownership of the fd; a no-op if we already primed.
+bool apc_prime_from_fd(int fd);
+
 // needed by generated apc archive .cpp files
 void apc_load_impl(struct cache_info *info,
                    const char **int_keys, long long *int_values,
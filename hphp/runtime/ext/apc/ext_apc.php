@@ -85,6 +85,21 @@ function apc_store_as_primed_do_not_use(string $key,
 function apc_fetch(mixed $key,
                    mixed &$success = null): mixed;
 
+/**
+ * Binds a key to a per-request local cache slot.  Subsequent apc_fetch()
+ * calls for the key are served from the slot without probing the shared
+ * store, as long as no APC write has happened since the slot was filled.
+ * Intended for keys read on every request, such as feature flags.
+ *
+ * @param string $key - The key to bind.
+ *
+ * @return bool - Returns TRUE if the key is bound, FALSE if APC is
+ *   disabled.
+ *
+ */
+<<__Native>>
+function apc_bind_local(string $key): bool;
+
 /**
  * Removes a stored variable from the cache.
  *
@@ -18,6 +18,7 @@
 #define incl_HPHP_SNAPSHOT_BUILDER_H_
 
 #include <stdio.h>
+#include <deque>
 #include <string>
 #include <utility>
 #include <vector>
@@ -79,19 +80,7 @@ struct SnapshotBuilder {
   void writeToFile(const std::string& filename);
 
  private:
-  void add(StringBasedType type, const String& v, KeyValuePair item) {
-    // Keys of readOnly entries are tagged with an extra NUL byte, for easy
-    // compatibility: an old HHVM reading a snapshot generated with a new HHVM
-    // will simply ignores these extra NULs. Conversely, old snapshots never
-    // have superfluous NUL bytes, so no entries will be considered readOnly.
-    std::string key(item.key);
-    if (item.readOnly) key += '\0';
-    if (item.inMem()) {
-      m_stringMem[type].emplace_back(key, v.slice().toString());
-    } else {
-      m_stringDisk.emplace_back(key, item);
-    }
-  }
+  void add(StringBasedType type, const String& v, KeyValuePair item);
   void add(CharBasedType type, KeyValuePair item) {
     m_chars.emplace_back(item.key, static_cast<char>(type));
   }
@@ -129,6 +118,11 @@ struct SnapshotBuilder {
     m_stringMem{kNumStringBased};
   // Disk.
   std::vector<std::pair<std::string, KeyValuePair> > m_stringDisk;
+  // Backing for Disk entries serialized by the builder itself (in-memory
+  // values demoted to the lazily-loaded Disk section); the KeyValuePairs
+  // in m_stringDisk may point into these. A deque so growth never moves
+  // the strings (small ones store their bytes in-object).
+  std::deque<std::string> m_ownedBlobs;
 
   FILE* m_file{nullptr};
 };
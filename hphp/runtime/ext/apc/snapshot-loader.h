@@ -37,11 +37,20 @@ struct ConcurrentTableSharedStore;
 struct SnapshotLoader {
   // Returns false if unable to read a valid header.
   bool tryInitializeFromFile(const char* filename);
+  // Same, for an already-open descriptor (e.g., one inherited from a
+  // predecessor server during takeover). Takes ownership of 'fd'.
+  bool tryInitializeFromFd(int fd);
   // Loads the contents from the snapshot (and leaves the Disk mapped).
   void load(ConcurrentTableSharedStore& s);
   // Evict the file-backed memory from OS page cache.
   void adviseOut();
+  // The fd backing the mapping (-1 before successful initialization).
+  int fd() const { return m_fd; }
  private:
+  // Validates the header and maps the file in m_fd; 'name' is only
+  // used for log messages. Closes m_fd on failure.
+  bool initialize(const char* name);
+
   const SnapshotHeader& header() const {
     return *reinterpret_cast<const SnapshotHeader*>(m_begin);
   }
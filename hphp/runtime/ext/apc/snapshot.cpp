@@ -30,6 +30,7 @@
 #include "hphp/runtime/base/concurrent-shared-store.h"
 #include "hphp/runtime/base/type-string.h"
 #include "hphp/runtime/base/variable-serializer.h"
+#include "hphp/runtime/ext/apc/ext_apc.h" // apc_serialize
 #include "hphp/runtime/ext/fb/ext_fb.h" // fb_unserialize
 #include "hphp/runtime/vm/repo.h"
 #include "hphp/runtime/vm/repo-global-data.h"
@@ -48,6 +49,55 @@ namespace HPHP {
 
 TRACE_SET_MOD(apc);
 
+void SnapshotBuilder::add(StringBasedType type, const String& v,
+                          KeyValuePair item) {
+  // Keys of readOnly entries are tagged with an extra NUL byte, for easy
+  // compatibility: an old HHVM reading a snapshot generated with a new HHVM
+  // will simply ignores these extra NULs. Conversely, old snapshots never
+  // have superfluous NUL bytes, so no entries will be considered readOnly.
+  std::string key(item.key);
+  if (item.readOnly) key += '\0';
+  if (!item.inMem()) {
+    m_stringDisk.emplace_back(key, item);
+    return;
+  }
+  if (type == kSnapThrift) {
+    // Thrift values need fb_unserialize at load time, which the store's
+    // lazy in-file path can't do; keep them eagerly loaded.
+    m_stringMem[type].emplace_back(key, v.slice().toString());
+    return;
+  }
+  // Serialize the value now so the loader can treat the entry like a
+  // file-backed one: left in the mapped Disk section and unserialized on
+  // first access, instead of being materialized at boot. This mirrors
+  // what constructPrime does when APCFileStorage is enabled, including
+  // the sign convention on sSize for serialized objects.
+  String s;
+  switch (type) {
+    case kSnapString:
+    case kSnapObject:
+      s = apc_serialize(v);
+      break;
+    case kSnapOther: {
+      Variant u = unserialize_from_string(v);
+      if (same(u, false)) {
+        throw Exception("bad apc archive, unserialize_from_string failed");
+      }
+      s = apc_serialize(u);
+      break;
+    }
+    default:
+      assert(false);
+      break;
+  }
+  m_ownedBlobs.emplace_back(s.data(), s.size());
+  auto const& blob = m_ownedBlobs.back();
+  item.value = nullptr;
+  item.sAddr = const_cast<char*>(blob.data());
+  item.sSize = type == kSnapObject ? 0 - blob.size() : blob.size();
+  m_stringDisk.emplace_back(key, item);
+}
+
 void SnapshotBuilder::writeToFile(const std::string& filename) {
   m_file = fopen(filename.c_str(), "w+");
   if (!m_file) {
@@ -87,31 +137,45 @@ bool SnapshotLoader::tryInitializeFromFile(const char* filename) {
     Logger::Error("Failed to open snapshot file %s", filename);
     return false;
   }
+  return initialize(filename);
+}
+
+bool SnapshotLoader::tryInitializeFromFd(int fd) {
+  m_fd = fd;
+  lseek(m_fd, 0, SEEK_SET);
+  return initialize("inherited fd");
+}
+
+bool SnapshotLoader::initialize(const char* name) {
   SnapshotHeader header = SnapshotHeader::makeEmpty();
   auto bytesRead = ::read(m_fd, &header, sizeof(header));
   if (bytesRead != sizeof(header) || !header.isValid()) {
     // Info rather than error, since probing the format is OK.
-    Logger::Info("No valid snapshot header in %s", filename);
+    Logger::Info("No valid snapshot header in %s", name);
     close(m_fd);
+    m_fd = -1;
     return false;
   }
   if (header.version > SnapshotHeader::kLatestVersion) {
     Logger::Error("Unsupported snapshot version %" PRId64 " in %s",
-                  header.version, filename);
+                  header.version, name);
     close(m_fd);
+    m_fd = -1;
     return false;
   }
   m_size = lseek(m_fd, 0, SEEK_END);
   if (m_size != header.totalSize) {
-    Logger::Error("Incorrect file size in %s", filename);
+    Logger::Error("Incorrect file size in %s", name);
     close(m_fd);
+    m_fd = -1;
     return false;
   }
   lseek(m_fd, 0, SEEK_SET);
   m_begin = (char*)mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
   if (m_begin == (char*)-1) {
-    Logger::Error("Failed to mmap %s", filename);
+    Logger::Error("Failed to mmap %s", name);
     close(m_fd);
+    m_fd = -1;
     return false;
   }
   m_cur = m_begin + sizeof(SnapshotHeader);
@@ -243,7 +307,7 @@ void SnapshotLoader::load(ConcurrentTableSharedStore& s) {
                    [&hotness](const KeyValuePair& a, const KeyValuePair& b) {
                      return hotness[a.key] < hotness[b.key];
                    });
-  s.prime(std::move(all));
+  s.prime(std::move(all), true /* parallel */);
   assert(m_cur == m_begin + header().diskOffset);
   // Keys have been copied, so don't need that part any more.
   madvise(const_cast<char*>(m_begin), header().diskOffset, MADV_DONTNEED);
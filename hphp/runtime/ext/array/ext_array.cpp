@@ -27,6 +27,7 @@
 #include "hphp/runtime/base/container-functions.h"
 #include "hphp/runtime/base/double-to-int64.h"
 #include "hphp/runtime/base/mixed-array.h"
+#include "hphp/runtime/base/packed-array.h"
 #include "hphp/runtime/base/req-containers.h"
 #include "hphp/runtime/base/request-event-handler.h"
 #include "hphp/runtime/base/request-local.h"
@@ -474,6 +475,22 @@ TypedValue HHVM_FUNCTION(array_map,
         return tvReturn(arr1.toArray());
       }
     }
+    if (isArrayLikeType(cell_arr1.m_type) &&
+        cell_arr1.m_data.parr->hasPackedLayout()) {
+      // Fast path for packed arrays: the keys are 0..n-1, so the result
+      // is packed as well and we can walk the values directly instead of
+      // going through ArrayIter and per-element key handling.
+      PackedArrayInit ret(cell_arr1.m_data.parr->size());
+      PackedArray::IterateV(
+        cell_arr1.m_data.parr,
+        [&](TypedValue v) {
+          ret.append(Variant::attach(
+            g_context->invokeFuncFew(ctx, 1, tvToCell(&v))
+          ));
+        }
+      );
+      return tvReturn(ret.toVariant());
+    }
     ArrayInit ret(getContainerSize(cell_arr1), ArrayInit::Map{});
     bool keyConverted = isArrayLikeType(cell_arr1.m_type);
     if (!keyConverted) {
@@ -961,6 +978,15 @@ TypedValue HHVM_FUNCTION(array_slice,
     return tvReturn(cell_input.m_data.pobj->toArray());
   }
 
+  // Vanilla packed arrays can be sliced with one bulk copy; everything
+  // else falls back to the iterator walk below.
+  if (input_is_packed && (offset == 0 || !preserve_keys) &&
+      isArrayType(cell_input.m_type) &&
+      cell_input.m_data.parr->isPacked()) {
+    return tvReturn(Array::attach(
+      PackedArray::Slice(cell_input.m_data.parr, offset, len)));
+  }
+
   int pos = 0;
   ArrayIter iter(cell_input);
   for (; pos < offset && iter; ++pos, ++iter) {}
@@ -1850,18 +1876,28 @@ TypedValue HHVM_FUNCTION(array_diff_key,
   if (!moreThanTwo &&
       isArrayLikeType(c1.m_type) &&
       isArrayLikeType(c2.m_type)) {
-    auto ad2 = c2.m_data.parr;
-    for (ArrayIter iter(container1); iter; ++iter) {
-      auto key = iter.first();
-      const auto& c = *key.asCell();
-      if (c.m_type == KindOfInt64) {
-        if (ad2->exists(c.m_data.num)) continue;
+    auto const ad2 = c2.m_data.parr;
+    auto const ad2Mixed = ad2->hasMixedLayout();
+    // Walk the first array's element slab directly, and when the second
+    // has mixed layout probe it with the non-virtual lookups (which
+    // bottom out in the CRC hash kernels from hash-crc-x64.S) instead
+    // of per-element virtual dispatch.
+    IterateKV(c1.m_data.parr, [&](Cell k, TypedValue v) {
+      if (k.m_type == KindOfInt64) {
+        auto const present = ad2Mixed
+          ? bool(MixedArray::NvGetInt(ad2, k.m_data.num))
+          : ad2->exists(k.m_data.num);
+        if (present) return false;
       } else {
-        assert(isStringType(c.m_type));
-        if (ad2->exists(c.m_data.pstr)) continue;
+        assert(isStringType(k.m_type));
+        auto const present = ad2Mixed
+          ? bool(MixedArray::NvGetStr(ad2, k.m_data.pstr))
+          : ad2->exists(k.m_data.pstr);
+        if (present) return false;
       }
-      ret.setWithRef(key, iter.secondValPlus(), true);
-    }
+      ret.setWithRef(k, v);
+      return false;
+    });
     return tvReturn(std::move(ret));
   }
   // Put all of the keys from all the containers (except container1) into a
@@ -2234,18 +2270,26 @@ TypedValue HHVM_FUNCTION(array_intersect_key,
   if (!moreThanTwo &&
       isArrayLikeType(c1.m_type) &&
       isArrayLikeType(c2.m_type)) {
-    auto ad2 = c2.m_data.parr;
-    for (ArrayIter iter(container1); iter; ++iter) {
-      auto key = iter.first();
-      const auto& c = *key.asCell();
-      if (c.m_type == KindOfInt64) {
-        if (!ad2->exists(c.m_data.num)) continue;
+    auto const ad2 = c2.m_data.parr;
+    auto const ad2Mixed = ad2->hasMixedLayout();
+    // Same batch walk as array_diff_key above: direct element iteration
+    // over the first array, non-virtual CRC-hash probes into the second.
+    IterateKV(c1.m_data.parr, [&](Cell k, TypedValue v) {
+      if (k.m_type == KindOfInt64) {
+        auto const present = ad2Mixed
+          ? bool(MixedArray::NvGetInt(ad2, k.m_data.num))
+          : ad2->exists(k.m_data.num);
+        if (!present) return false;
       } else {
-        assert(isStringType(c.m_type));
-        if (!ad2->exists(c.m_data.pstr)) continue;
+        assert(isStringType(k.m_type));
+        auto const present = ad2Mixed
+          ? bool(MixedArray::NvGetStr(ad2, k.m_data.pstr))
+          : ad2->exists(k.m_data.pstr);
+        if (!present) return false;
       }
-      ret.setWithRef(key, iter.secondValPlus(), true);
-    }
+      ret.setWithRef(k, v);
+      return false;
+    });
     return tvReturn(std::move(ret));
   }
   // Build up a Set containing the keys that are present in all the containers
@@ -58,6 +58,18 @@ namespace {
     }
   }
 
+  // Like exitContextQueue, but the entries own no extra reference;
+  // exitContext() consumes the one transferred at schedule time.
+  template<class TWaitHandle>
+  void exitContextFifo(context_idx_t ctx_idx,
+                       req::deque<TWaitHandle*> &queue) {
+    while (!queue.empty()) {
+      auto wait_handle = queue.front();
+      queue.pop_front();
+      wait_handle->exitContext(ctx_idx);
+    }
+  }
+
   inline void onIOWaitEnter(AsioSession* session) {
     if (UNLIKELY(session->hasOnIOWaitEnter())) {
       session->onIOWaitEnter();
@@ -90,8 +102,8 @@ namespace {
 void AsioContext::exit(context_idx_t ctx_idx) {
   assert(AsioSession::Get()->getContext(ctx_idx) == this);
 
-  exitContextVector(ctx_idx, m_runnableQueue);
-  exitContextVector(ctx_idx, m_fastRunnableQueue);
+  exitContextFifo(ctx_idx, m_runnableQueue);
+  exitContextFifo(ctx_idx, m_fastRunnableQueue);
 
   for (auto& it : m_priorityQueueDefault) {
     exitContextQueue(ctx_idx, it.second);
@@ -121,8 +133,8 @@ c_AsyncFunctionWaitHandle* AsioContext::maybePopFast() {
   assertx(this == AsioSession::Get()->getCurrentContext());
 
   while (!m_fastRunnableQueue.empty()) {
-    auto wh = m_fastRunnableQueue.back();
-    m_fastRunnableQueue.pop_back();
+    auto wh = m_fastRunnableQueue.front();
+    m_fastRunnableQueue.pop_front();
 
     if (wh->getState() == c_ResumableWaitHandle::STATE_READY &&
         wh->isFastResumable()) {
@@ -136,7 +148,7 @@ c_AsyncFunctionWaitHandle* AsioContext::maybePopFast() {
       return wh;
     } else {
       // `wh' is blocked or finished in some other context.
-      m_fastRunnableQueue.push_back(wh);
+      m_fastRunnableQueue.push_front(wh);
       return nullptr;
     }
   }
@@ -155,10 +167,13 @@ void AsioContext::runUntil(c_WaitableWaitHandle* wait_handle) {
   }
 
   while (!wait_handle->isFinished()) {
-    // Run queue of ready async functions once.
+    // Run queue of ready async functions once, in the order they were
+    // unblocked. Running newest-first would let a burst of cheap ready
+    // handles (e.g. a completed prefetch batch) starve a latency-critical
+    // chain that became runnable before them.
     if (!m_runnableQueue.empty()) {
-      auto wh = m_runnableQueue.back();
-      m_runnableQueue.pop_back();
+      auto wh = m_runnableQueue.front();
+      m_runnableQueue.pop_front();
       if (wh->getState() != c_ResumableWaitHandle::STATE_READY) {
         // may happen if wh was scheduled in multiple contexts
         decRefObj(wh);
@@ -169,8 +184,8 @@ void AsioContext::runUntil(c_WaitableWaitHandle* wait_handle) {
     }
 
     if (!m_fastRunnableQueue.empty()) {
-      auto wh = m_fastRunnableQueue.back();
-      m_fastRunnableQueue.pop_back();
+      auto wh = m_fastRunnableQueue.front();
+      m_fastRunnableQueue.pop_front();
       if (wh->getState() != c_ResumableWaitHandle::STATE_READY) {
         // may happen if wh was scheduled in multiple contexts
         decRefObj(wh);
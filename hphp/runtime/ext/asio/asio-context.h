@@ -85,11 +85,13 @@ private:
   // Frame pointer to the ActRec of the \HH\Asio\join() call.
   ActRec* m_savedFP;
 
-  // stack of ResumableWaitHandles ready for immediate execution
-  req::vector<c_ResumableWaitHandle*> m_runnableQueue;
+  // FIFO queue of ResumableWaitHandles ready for immediate execution.
+  // Fairness matters here: running in unblock order bounds how long a
+  // burst of cheap ready handles can delay an earlier-unblocked chain.
+  req::deque<c_ResumableWaitHandle*> m_runnableQueue;
 
-  // stack of AsyncFunctionWaitHandles ready for immediate execution
-  req::vector<c_AsyncFunctionWaitHandle*> m_fastRunnableQueue;
+  // FIFO queue of AsyncFunctionWaitHandles ready for immediate execution
+  req::deque<c_AsyncFunctionWaitHandle*> m_fastRunnableQueue;
 
   // queue of RescheduleWaitHandles scheduled in default mode
   reschedule_priority_queue_t m_priorityQueueDefault;
@@ -169,6 +169,25 @@ struct AsioExternalThreadEvent {
      */
     bool cancel();
 
+    /**
+     * Notify that the result is no longer wanted. Overridden by subclasses.
+     *
+     * This is called from the web request thread immediately before the
+     * event is canceled, while the event is still in the Waiting state
+     * (e.g. when the request abandons the wait handle or dies with the
+     * operation still in flight). Subclasses that are able to abort their
+     * in-flight work -- cancel a pending query, close a socket -- should
+     * do so here so that doomed work stops consuming backend resources.
+     *
+     * Note that the processing thread may be running concurrently with
+     * this call; implementations must only perform operations that are
+     * safe against their own processing thread, and must not assume the
+     * work has stopped when this returns. The default implementation
+     * does nothing, which preserves the previous behavior of letting the
+     * operation run to completion and discarding the result.
+     */
+    virtual void cancellationRequested() {}
+
     /**
      * Destroy the object. INTERNAL USE ONLY. DO NOT CALL.
      *
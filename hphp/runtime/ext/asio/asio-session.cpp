@@ -342,7 +342,46 @@ void AsioSession::enqueueSleepEvent(c_SleepWaitHandle* h) {
   std::push_heap(m_sleepEvents.begin(), m_sleepEvents.end(), sleep_compare);
 }
 
+/**
+ * Drop cancelled sleep events that surfaced at the front of the heap.
+ *
+ * Cancelled events are deleted lazily, so a dead entry could otherwise sit
+ * at the front until its original wake time, causing spurious wakeups from
+ * I/O waits that cut their timeout at sleepWakeTime().
+ */
+void AsioSession::pruneCancelledSleepEvents() {
+  while (!m_sleepEvents.empty() && m_sleepEvents.front()->isFailed()) {
+    auto wh = m_sleepEvents.front();
+    std::pop_heap(m_sleepEvents.begin(), m_sleepEvents.end(), sleep_compare);
+    m_sleepEvents.pop_back();
+    decRefObj(wh);
+    assert(m_numCancelledSleepEvents > 0);
+    --m_numCancelledSleepEvents;
+  }
+}
+
+void AsioSession::markSleepEventCancelled() {
+  ++m_numCancelledSleepEvents;
+
+  // Timeouts armed around outbound RPCs are almost always cancelled before
+  // they fire. When dead entries start to dominate the heap, compact it so
+  // they don't pile up for the rest of the request.
+  if (m_numCancelledSleepEvents >= 16 &&
+      m_numCancelledSleepEvents > m_sleepEvents.size() / 2) {
+    auto const live = std::partition(
+      m_sleepEvents.begin(), m_sleepEvents.end(),
+      [](const c_SleepWaitHandle* wh) { return !wh->isFailed(); });
+    for (auto it = live; it != m_sleepEvents.end(); ++it) {
+      decRefObj(*it);
+    }
+    m_sleepEvents.erase(live, m_sleepEvents.end());
+    std::make_heap(m_sleepEvents.begin(), m_sleepEvents.end(), sleep_compare);
+    m_numCancelledSleepEvents = 0;
+  }
+}
+
 bool AsioSession::processSleepEvents() {
+  pruneCancelledSleepEvents();
   if (m_sleepEvents.empty()) {
     return false;
   }
@@ -352,11 +391,15 @@ bool AsioSession::processSleepEvents() {
 
   while (!m_sleepEvents.empty()) {
     auto wh = m_sleepEvents.front();
-    if (wh->getWakeTime() > now) {
+    if (!wh->isFailed() && wh->getWakeTime() > now) {
       break;
     }
+    // process() is a no-op on cancelled events; this just drops the entry.
     if (wh->process()) {
       woken = true;
+    } else if (wh->isFailed()) {
+      assert(m_numCancelledSleepEvents > 0);
+      --m_numCancelledSleepEvents;
     }
     decRefObj(wh);
     std::pop_heap(m_sleepEvents.begin(), m_sleepEvents.end(), sleep_compare);
@@ -367,11 +410,20 @@ bool AsioSession::processSleepEvents() {
 }
 
 AsioSession::TimePoint AsioSession::sleepWakeTime() {
+  pruneCancelledSleepEvents();
   auto const timeout = getLatestWakeTime();
   return m_sleepEvents.empty() ? timeout :
          min(timeout, m_sleepEvents.front()->getWakeTime());
 }
 
+Object& AsioSession::getStaticWaitHandleCache(Cell result) {
+  assert(result.m_type == KindOfNull || result.m_type == KindOfBoolean);
+  if (result.m_type == KindOfNull) {
+    return m_succeededNullWH;
+  }
+  return result.m_data.num ? m_succeededTrueWH : m_succeededFalseWH;
+}
+
 c_SleepWaitHandle* AsioSession::nextSleepEvent() {
   if (m_sleepEvents.empty()) {
     return nullptr;
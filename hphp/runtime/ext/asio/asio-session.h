@@ -84,12 +84,18 @@ struct AsioSession final {
   // Sleep event management.
   void enqueueSleepEvent(c_SleepWaitHandle* h);
   bool processSleepEvents();
-  // Wakeup time of next sleep wait handle or request timeout time.
-  // The returned timestamp may correspond to canceled wait handle.
+  // Called when a queued sleep wait handle is cancelled; its queue entry
+  // is deleted lazily or by compaction, see pruneCancelledSleepEvents().
+  void markSleepEventCancelled();
+  // Wakeup time of next live sleep wait handle or request timeout time.
   TimePoint sleepWakeTime();
   // The next wait handle to wake up. The wait handle may be cancled
   c_SleepWaitHandle* nextSleepEvent();
 
+  // Shared succeeded StaticWaitHandle for a constant result; filled lazily
+  // by c_StaticWaitHandle::CreateSucceeded().
+  Object& getStaticWaitHandleCache(Cell result);
+
   // Abrupt interrupt exception.
   ObjectData* getAbruptInterruptException() {
     return m_abruptInterruptException.get();
@@ -158,12 +164,22 @@ private:
   AsioSession();
   friend AsioSession* req::make_raw<AsioSession>();
 
+  void pruneCancelledSleepEvents();
+
 private:
   static DECLARE_THREAD_LOCAL_PROXY(AsioSession, false, s_current);
   req::vector<AsioContext*> m_contexts;
   req::vector<c_SleepWaitHandle*> m_sleepEvents;
+  uint32_t m_numCancelledSleepEvents{0};
   AsioExternalThreadEventQueue m_externalThreadEventQueue;
 
+  // Cached succeeded StaticWaitHandles for null/true/false results.
+  // Finished wait handles are immutable, so eagerly-completing async code
+  // can share one instance per request instead of allocating a new one.
+  Object m_succeededNullWH;
+  Object m_succeededTrueWH;
+  Object m_succeededFalseWH;
+
   Object m_abruptInterruptException;
   Object m_onIOWaitEnter;
   Object m_onIOWaitExit;
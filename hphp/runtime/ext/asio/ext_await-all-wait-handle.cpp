@@ -232,7 +232,7 @@ void c_AwaitAllWaitHandle::initialize(context_idx_t ctx_idx) {
   setContextIdx(ctx_idx);
 
   if (UNLIKELY(AsioSession::Get()->hasOnAwaitAllCreate())) {
-    auto vector = req::make<c_Vector>();
+    auto vector = req::make<c_Vector>(m_cap);
     for (int32_t idx = m_cap - 1; idx >= 0; --idx) {
       auto const child = make_tv<KindOfObject>(m_children[idx].m_child);
       vector->add(child);
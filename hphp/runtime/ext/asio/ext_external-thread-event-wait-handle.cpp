@@ -50,6 +50,10 @@ void HHVM_STATIC_METHOD(ExternalThreadEventWaitHandle, setOnFailCallback,
 void c_ExternalThreadEventWaitHandle::sweep() {
   assert(getState() == STATE_WAITING);
 
+  // give the event a chance to abort its in-flight work; the request is
+  // dying, so nobody will consume the result
+  m_event->cancellationRequested();
+
   if (m_event->cancel()) {
     // canceled; the processing thread will take care of cleanup
     return;
@@ -125,6 +129,11 @@ bool c_ExternalThreadEventWaitHandle::cancel(const Object& exception) {
     return false;               // already finished
   }
 
+  // give the event a chance to abort its in-flight work before we stop
+  // waiting for the result; this must happen while the event is still
+  // alive, i.e. before cancel() hands it off to the processing thread
+  m_event->cancellationRequested();
+
   if (!m_event->cancel()) {
     return false;
   }
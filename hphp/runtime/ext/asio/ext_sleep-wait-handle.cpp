@@ -87,8 +87,11 @@ bool c_SleepWaitHandle::cancel(const Object& exception) {
   tvWriteObject(exception.get(), &m_resultOrException);
   parentChain.unblock();
 
-  // this is technically a lie, since sleep failed
+  // let the session reclaim our entry in the sleep event queue
   auto session = AsioSession::Get();
+  session->markSleepEventCancelled();
+
+  // this is technically a lie, since sleep failed
   if (UNLIKELY(session->hasOnSleepSuccess())) {
     session->onSleepSuccess(
       this,
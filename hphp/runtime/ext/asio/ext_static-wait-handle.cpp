@@ -17,6 +17,7 @@
 
 #include "hphp/runtime/ext/asio/ext_static-wait-handle.h"
 
+#include "hphp/runtime/ext/asio/asio-session.h"
 #include "hphp/system/systemlib.h"
 
 namespace HPHP {
@@ -32,6 +33,22 @@ namespace HPHP {
  * guarantee.
  */
 c_StaticWaitHandle* c_StaticWaitHandle::CreateSucceeded(const Cell result) {
+  // Finished wait handles are immutable, so constant results can share one
+  // instance per request. Eagerly-completing async functions return null,
+  // true or false most of the time, and this path is their fixed cost.
+  if (result.m_type == KindOfNull || result.m_type == KindOfBoolean) {
+    auto& cache = AsioSession::Get()->getStaticWaitHandleCache(result);
+    if (UNLIKELY(cache.isNull())) {
+      auto waitHandle = req::make<c_StaticWaitHandle>();
+      waitHandle->setState(STATE_SUCCEEDED);
+      cellCopy(result, waitHandle->m_resultOrException);
+      cache = Object::attach(waitHandle.detach());
+    }
+    auto waitHandle = static_cast<c_StaticWaitHandle*>(cache.get());
+    waitHandle->incRefCount();
+    return waitHandle;
+  }
+
   auto waitHandle = req::make<c_StaticWaitHandle>();
   waitHandle->setState(STATE_SUCCEEDED);
   cellCopy(result, waitHandle->m_resultOrException);
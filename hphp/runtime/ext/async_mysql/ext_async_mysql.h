@@ -274,6 +274,10 @@ struct AsyncMysqlConnectEvent final : AsioExternalThreadEvent {
 
   void opFinished() { markAsFinished(); }
 
+  // The request no longer wants the result; stop the connection attempt.
+  // Operation::cancel() is safe to call from off the client thread.
+  void cancellationRequested() override { m_op->cancel(); }
+
   void setClientStats(db::ClientPerfStats stats) {
     m_clientStats = std::move(stats);
   }
@@ -295,6 +299,9 @@ struct AsyncMysqlQueryEvent final : AsioExternalThreadEvent {
 
   void opFinished() { markAsFinished(); }
 
+  // Abort the in-flight query; the request abandoned the wait handle.
+  void cancellationRequested() override { m_query_op->cancel(); }
+
   void setClientStats(db::ClientPerfStats stats) {
     m_clientStats = std::move(stats);
   }
@@ -322,6 +329,11 @@ struct AsyncMysqlMultiQueryEvent final : AsioExternalThreadEvent {
 
   void opFinished() { markAsFinished(); }
 
+  // Abort the in-flight queries; the request abandoned the wait handle.
+  void cancellationRequested() override {
+    if (m_multi_op) m_multi_op->cancel();
+  }
+
   void setClientStats(db::ClientPerfStats stats) {
     m_clientStats = std::move(stats);
   }
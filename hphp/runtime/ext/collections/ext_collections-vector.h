@@ -24,6 +24,18 @@ struct VectorIterator;
 ///////////////////////////////////////////////////////////////////////////////
 //// class BaseVector: encapsulates functionality that is common to both
 //// c_Vector and c_ImmVector. It doesn't map to any PHP-land class.
+////
+//// The element storage is always a real vec ArrayData of TypedValues.
+//// This is a deliberate representation choice, not an oversight: it is
+//// what makes toVArray/toArray and the imm-copy handshake O(1) handle
+//// swaps, lets the iterator and serializer code paths reuse the array
+//// implementations verbatim, and is the layout the JIT's specialized
+//// collection access (LdColVec et al.) compiles against.  A secondary
+//// unboxed mode for homogeneous int/double contents (8-byte slots plus
+//// a container-level tag) would halve memory for numeric vectors, but
+//// every raw-array escape point above would need a materializing rebox,
+//// turning the common exits into O(n) copies; with the current uses the
+//// trade has not been worth it.
 
 struct BaseVector : ObjectData {
 protected:
@@ -39,12 +39,36 @@ struct CurlTimeoutHandler : AsioTimeoutHandler {
   CurlMultiAwait* m_curlMultiAwait;
 };
 
+/////////////////////////////////////////////////////////////////////////////
+// CurlSocketHandler
+
+void CurlSocketHandler::handlerReady(uint16_t /*events*/) noexcept {
+  // Notify at most once per await; the registration is one-shot, so there's
+  // nothing to disarm here.
+  auto awaiter = m_awaiter;
+  m_awaiter = nullptr;
+  if (awaiter) {
+    awaiter->setFinished(m_sock);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // CurlMultiAwait
 
 CurlMultiAwait::CurlMultiAwait(req::ptr<CurlMultiResource> multi,
                                double timeout) {
- if ((addLowHandles(multi) + addHighHandles(multi)) == 0) {
+  // Prefer the persistent socket watchers maintained by libcurl's socket
+  // callback; fall back to rebuilding the fd set when the callback isn't
+  // available, or before it has reported any sockets for this multi handle.
+  size_t count = 0;
+  if (multi->startSocketWatchers()) {
+    m_multi = multi;
+    count = multi->attachWatchers(this);
+  }
+  if (!count) {
+    count = addLowHandles(multi) + addHighHandles(multi);
+  }
+  if (!count) {
     // Nothing to do
     markAsFinished();
     return;
@@ -64,6 +88,9 @@ CurlMultiAwait::CurlMultiAwait(req::ptr<CurlMultiResource> multi,
 }
 
 CurlMultiAwait::~CurlMultiAwait() {
+  if (m_multi) {
+    m_multi->detachWatchers(this);
+  }
   for (auto handler : m_handlers) {
     handler->unregisterHandler();
   }
@@ -2,6 +2,7 @@
 #define incl_HPHP_CURL_MULTI_AWAIT_H
 
 #include "hphp/runtime/ext/asio/asio-external-thread-event.h"
+#include "hphp/runtime/ext/asio/socket-event.h"
 #include "hphp/runtime/ext/curl/curl-multi-resource.h"
 
 namespace HPHP {
@@ -18,6 +19,7 @@ struct CurlMultiAwait : AsioExternalThreadEvent {
 
  private:
   friend struct CurlEventHandler;
+  friend struct CurlSocketHandler;
   friend struct CurlTimeoutHandler;
   void setFinished(int fd);
 
@@ -25,12 +27,36 @@ struct CurlMultiAwait : AsioExternalThreadEvent {
   int addLowHandles(req::ptr<CurlMultiResource> multi);
   int addHighHandles(req::ptr<CurlMultiResource> multi);
 
+  req::ptr<CurlMultiResource> m_multi;
   req::shared_ptr<CurlTimeoutHandler> m_timeout;
   req::vector<req::shared_ptr<CurlEventHandler>> m_handlers;
   int m_result{-1};
   bool m_finished{false};
 };
 
+/////////////////////////////////////////////////////////////////////////////
+// CurlSocketHandler
+
+// One transfer socket of a multi handle. Unlike CurlEventHandler, these
+// live on the CurlMultiResource for as long as libcurl uses the socket;
+// each CurlMultiAwait arms them one-shot for the events libcurl last asked
+// for and points m_awaiter at itself for the duration of the await.
+
+struct CurlSocketHandler : AsioEventHandler {
+  CurlSocketHandler(AsioEventBase* base, curl_socket_t sock):
+    AsioEventHandler(base, sock), m_sock(sock) {}
+
+  void handlerReady(uint16_t events) noexcept override;
+
+  TYPE_SCAN_IGNORE_BASES(folly::EventHandler);
+
+ private:
+  friend struct CurlMultiResource;
+  CurlMultiAwait* m_awaiter{nullptr};
+  curl_socket_t m_sock;
+  uint16_t m_events{0};
+};
+
 /////////////////////////////////////////////////////////////////////////////
 }
 #endif
@@ -1,8 +1,11 @@
 #include "hphp/runtime/ext/curl/curl-multi-resource.h"
+#include "hphp/runtime/ext/curl/curl-multi-await.h"
 #include "hphp/runtime/ext/curl/curl-resource.h"
 #include "hphp/runtime/base/array-iterator.h"
 #include "hphp/runtime/base/builtin-functions.h"
 
+#include "hphp/util/compatibility.h"
+
 #include <curl/easy.h>
 #include <curl/multi.h>
 
@@ -10,6 +13,15 @@ namespace {
 const HPHP::StaticString
   s_exception("exception"),
   s_previous("previous");
+
+#if LIBCURL_VERSION_NUM >= 0x071000 /* 7.16.0 */
+int socket_callback(CURL* /*easy*/, curl_socket_t sock, int what,
+                    void* userp, void* /*socketp*/) {
+  static_cast<HPHP::CurlMultiResource*>(userp)
+    ->updateSocketWatcher(sock, what);
+  return 0;
+}
+#endif
 }
 
 namespace HPHP {
@@ -22,6 +34,7 @@ CurlMultiResource::CurlMultiResource() {
 void CurlMultiResource::close() {
   if (m_multi) {
     curl_multi_cleanup(m_multi);
+    removeSocketWatchers();
     m_easyh.clear();
     m_multi = nullptr;
   }
@@ -30,7 +43,83 @@ void CurlMultiResource::close() {
 void CurlMultiResource::sweep() {
   if (m_multi) {
     curl_multi_cleanup(m_multi);
+    removeSocketWatchers();
+  }
+}
+
+bool CurlMultiResource::startSocketWatchers() {
+#if LIBCURL_VERSION_NUM >= 0x071000 /* 7.16.0 */
+  if (m_usingSocketWatchers) return true;
+  if (!m_multi) return false;
+  if ((curl_multi_setopt(m_multi, CURLMOPT_SOCKETFUNCTION,
+                         socket_callback) != CURLM_OK) ||
+      (curl_multi_setopt(m_multi, CURLMOPT_SOCKETDATA, this) != CURLM_OK)) {
+    return false;
+  }
+  m_usingSocketWatchers = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CurlMultiResource::updateSocketWatcher(curl_socket_t sock, int what) {
+  if (what == CURL_POLL_REMOVE) {
+    auto it = m_sockWatchers.find(sock);
+    if (it != m_sockWatchers.end()) {
+      it->second->unregisterHandler();
+      m_sockWatchers.erase(it);
+    }
+    return;
+  }
+  auto it = m_sockWatchers.find(sock);
+  if (it == m_sockWatchers.end()) {
+    auto asio_event_base = getSingleton<AsioEventBase>();
+    it = m_sockWatchers.emplace(
+      sock,
+      req::make_shared<CurlSocketHandler>(asio_event_base.get(), sock)
+    ).first;
+  }
+  // Record the events libcurl wants; the watcher is armed by the next
+  // CurlMultiAwait, never while we're in curl_multi_exec.
+  uint16_t events = 0;
+  if (what == CURL_POLL_IN  || what == CURL_POLL_INOUT) {
+    events |= AsioEventHandler::READ;
+  }
+  if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) {
+    events |= AsioEventHandler::WRITE;
+  }
+  it->second->m_events = events;
+}
+
+size_t CurlMultiResource::attachWatchers(CurlMultiAwait* awaiter) {
+  size_t count = 0;
+  for (auto& watcher : m_sockWatchers) {
+    auto& handler = watcher.second;
+    if (!handler->m_events) continue;
+    handler->m_awaiter = awaiter;
+    handler->registerHandler(handler->m_events);
+    ++count;
+  }
+  return count;
+}
+
+void CurlMultiResource::detachWatchers(CurlMultiAwait* awaiter) {
+  for (auto& watcher : m_sockWatchers) {
+    auto& handler = watcher.second;
+    if (handler->m_awaiter != awaiter) continue;
+    handler->m_awaiter = nullptr;
+    handler->unregisterHandler();
+  }
+}
+
+void CurlMultiResource::removeSocketWatchers() {
+  for (auto& watcher : m_sockWatchers) {
+    watcher.second->m_awaiter = nullptr;
+    watcher.second->unregisterHandler();
   }
+  m_sockWatchers.clear();
+  m_usingSocketWatchers = false;
 }
 
 bool CurlMultiResource::setOption(int option, const Variant& value) {
@@ -3,6 +3,7 @@
 
 #include "hphp/runtime/ext/extension.h"
 
+#include "hphp/runtime/base/req-containers.h"
 #include "hphp/util/type-scan.h"
 
 #include <curl/curl.h>
@@ -12,6 +13,8 @@ namespace HPHP {
 // CurlMultiResource
 
 struct CurlResource;
+struct CurlMultiAwait;
+struct CurlSocketHandler;
 
 struct CurlMultiResource : SweepableResourceData {
   DECLARE_RESOURCE_ALLOCATION(CurlMultiResource)
@@ -33,11 +36,26 @@ struct CurlMultiResource : SweepableResourceData {
   CURLM* get();
   void check_exceptions();
 
+  // Persistent socket watchers, kept in sync with the transfer sockets by
+  // libcurl's socket callback as curl_multi_exec runs, so curl_multi_await
+  // doesn't have to rebuild the fd set on every call. startSocketWatchers
+  // installs the callback (once) and returns false on libcurls without it.
+  // Each CurlMultiAwait arms the current watchers with attachWatchers and
+  // disarms them with detachWatchers when it completes.
+  bool startSocketWatchers();
+  void updateSocketWatcher(curl_socket_t sock, int what);
+  size_t attachWatchers(CurlMultiAwait* awaiter);
+  void detachWatchers(CurlMultiAwait* awaiter);
+
  private:
+  void removeSocketWatchers();
+
   CURLM *m_multi;
   // CURLM is a typedef to void
   TYPE_SCAN_IGNORE_FIELD(m_multi);
   Array m_easyh;
+  req::hash_map<int, req::shared_ptr<CurlSocketHandler>> m_sockWatchers;
+  bool m_usingSocketWatchers{false};
 };
 
 /////////////////////////////////////////////////////////////////////////////
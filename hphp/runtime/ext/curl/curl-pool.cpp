@@ -31,6 +31,12 @@ CURL* PooledCurlHandle::useHandle() {
     m_numUsages = 0;
   }
 
+  // Attach the pool-wide share on every use: curl_easy_reset() detaches
+  // it, and a recycled handle starts fresh anyway.
+  if (m_share != nullptr) {
+    curl_easy_setopt(m_handle, CURLOPT_SHARE, m_share);
+  }
+
   m_numUsages++;
   return m_handle;
 }
@@ -50,21 +56,47 @@ CurlHandlePool::CurlHandlePool(int size,
 : m_size(size),
   m_connGetTimeout(connGetTimeout),
   m_reuseLimit(reuseLimit) {
+  m_share = curl_share_init();
+  if (m_share != nullptr) {
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  }
   for (int i = 0; i < size; i++) {
-    m_handleStack.push(new PooledCurlHandle(reuseLimit));
+    m_handleStack.push(new PooledCurlHandle(reuseLimit, m_share));
   }
   pthread_cond_init(&m_cond, nullptr);
 }
 
 CurlHandlePool::~CurlHandlePool() {
-  Lock lock(m_mutex);
-  while (!m_handleStack.empty()) {
-    PooledCurlHandle *handle = m_handleStack.top();
-    m_handleStack.pop();
-    delete handle;
+  {
+    Lock lock(m_mutex);
+    while (!m_handleStack.empty()) {
+      PooledCurlHandle *handle = m_handleStack.top();
+      m_handleStack.pop();
+      delete handle;
+    }
+  }
+  // The share must outlive every easy handle attached to it.
+  if (m_share != nullptr) {
+    curl_share_cleanup(m_share);
   }
 }
 
+void CurlHandlePool::lockShare(CURL* /*handle*/, curl_lock_data data,
+                               curl_lock_access /*access*/, void* userptr) {
+  auto pool = static_cast<CurlHandlePool*>(userptr);
+  pool->m_shareLocks[data].lock();
+}
+
+void CurlHandlePool::unlockShare(CURL* /*handle*/, curl_lock_data data,
+                                 void* userptr) {
+  auto pool = static_cast<CurlHandlePool*>(userptr);
+  pool->m_shareLocks[data].unlock();
+}
+
 PooledCurlHandle* CurlHandlePool::fetch() {
   struct timespec ts;
   gettime(CLOCK_REALTIME, &ts);
@@ -105,6 +137,35 @@ void CurlHandlePool::store(PooledCurlHandle* handle) {
   pthread_cond_signal(&m_cond);
 }
 
+int CurlHandlePool::available() {
+  Lock lock(m_mutex);
+  return m_handleStack.size();
+}
+
+CurlHandlePoolPtr CurlHandlePool::getNamedPool(const std::string& name) {
+  ReadLock lock(namedPoolsMutex);
+  auto it = namedPools.find(name);
+  return it != namedPools.end() ? it->second : nullptr;
+}
+
+CurlHandlePoolPtr CurlHandlePool::getOrCreateNamedPool(const std::string& name,
+                                                       int poolSize,
+                                                       int waitTimeout,
+                                                       int numConnReuses) {
+  {
+    ReadLock lock(namedPoolsMutex);
+    auto it = namedPools.find(name);
+    if (it != namedPools.end()) return it->second;
+  }
+  WriteLock lock(namedPoolsMutex);
+  auto& pool = namedPools[name];
+  if (!pool) {
+    pool = std::make_shared<CurlHandlePool>(poolSize, waitTimeout,
+                                            numConnReuses);
+  }
+  return pool;
+}
+
 ReadWriteMutex CurlHandlePool::namedPoolsMutex;
 std::map<std::string, CurlHandlePoolPtr> CurlHandlePool::namedPools;
 
@@ -5,6 +5,7 @@
 
 #include <curl/curl.h>
 
+#include <array>
 #include <map>
 #include <stack>
 #include <string>
@@ -18,8 +19,9 @@ namespace HPHP {
  * Operations on this class are _NOT_ thread safe!
  */
 struct PooledCurlHandle {
-  explicit PooledCurlHandle(int connRecycleAfter)
-  : m_handle(nullptr), m_numUsages(0), m_connRecycleAfter(connRecycleAfter) { }
+  PooledCurlHandle(int connRecycleAfter, CURLSH* share)
+  : m_handle(nullptr), m_share(share), m_numUsages(0),
+    m_connRecycleAfter(connRecycleAfter) { }
   ~PooledCurlHandle();
 
   CURL* useHandle();
@@ -27,6 +29,7 @@ struct PooledCurlHandle {
 
  private:
   CURL* m_handle;
+  CURLSH* m_share;
   int m_numUsages;
   int m_connRecycleAfter;
 };
@@ -37,6 +40,9 @@ struct PooledCurlHandle {
 /* This is a helper class used to implement a process-wide pool of libcurl
  * handles. This provides very large performance benefits, as libcurl handles
  * hold connections open and cache SSL session ids over their lifetimes.
+ * Handles in a pool additionally share one TLS session cache and DNS cache,
+ * so a session ticket negotiated on any handle lets every other handle in
+ * the pool resume abbreviated handshakes against the same destination.
  * All operations on this class are thread safe.
  */
 struct CurlHandlePool;
@@ -48,19 +54,36 @@ struct CurlHandlePool {
   PooledCurlHandle* fetch();
   void store(PooledCurlHandle* handle);
   int size() { return m_size; }
+  int available();
   int connGetTimeout() { return m_connGetTimeout; }
   int reuseLimit() { return m_reuseLimit; }
   unsigned long statsFetches() { return m_statsFetches; }
   unsigned long statsEmpty() { return m_statsEmpty; }
   unsigned long long statsFetchUs() { return m_statsFetchUs; }
 
+  /*
+   * Look up a named pool, returning nullptr when none exists.  The
+   * getOrCreate variant creates the pool with the given parameters on
+   * first use instead.
+   */
+  static CurlHandlePoolPtr getNamedPool(const std::string& name);
+  static CurlHandlePoolPtr getOrCreateNamedPool(const std::string& name,
+                                                int poolSize,
+                                                int waitTimeout,
+                                                int numConnReuses);
+
   static ReadWriteMutex namedPoolsMutex;
   static std::map<std::string, CurlHandlePoolPtr> namedPools;
 
 private:
+  static void lockShare(CURL*, curl_lock_data, curl_lock_access, void*);
+  static void unlockShare(CURL*, curl_lock_data, void*);
+
   std::stack<PooledCurlHandle*> m_handleStack;
   Mutex m_mutex;
   pthread_cond_t m_cond;
+  CURLSH* m_share;
+  std::array<Mutex, CURL_LOCK_DATA_LAST> m_shareLocks;
   const int m_size;
   const int m_connGetTimeout;
   const int m_reuseLimit;
@@ -117,6 +117,7 @@ bool HHVM_FUNCTION(curl_destroy_pool, const String& poolName) {
 
 const StaticString
   s_size("size"),
+  s_available("available"),
   s_connGetTimeout("connGetTimeout"),
   s_reuseLimit("reuseLimit"),
   s_stats("stats"),
@@ -136,6 +137,7 @@ Array HHVM_FUNCTION(curl_list_pools) {
                                 s_empty, pool->statsEmpty(),
                                 s_fetchMs, pool->statsFetchUs() / 1000);
     ret.set(String(it.first), make_map_array(s_size, pool->size(),
+                                             s_available, pool->available(),
                                              s_connGetTimeout,
                                              pool->connGetTimeout(),
                                              s_reuseLimit,
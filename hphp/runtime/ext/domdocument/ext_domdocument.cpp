@@ -1525,19 +1525,28 @@ struct cmpdpa {
  */
 template <class Derived>
 struct DOMPropHandler: Native::BasePropHandler {
+  // Each accessor resolves the property with a single probe of the map.
+  static constexpr bool resolvesProps = true;
+
   static Variant getProp(const Object& this_, const String& name) {
-    return Derived::map.getter(name)(this_);
+    auto const pa = Derived::map.lookup(name, "Accessing");
+    if (!pa) return Native::prop_not_handled();
+    return (pa->getter ? pa->getter : dummy_getter)(this_);
   }
 
   static Variant setProp(const Object& this_,
                          const String& name,
                          const Variant& value) {
-    Derived::map.setter(name)(this_, value);
+    auto const pa = Derived::map.lookup(name, "Setting");
+    if (!pa) return Native::prop_not_handled();
+    (pa->setter ? pa->setter : dummy_setter)(this_, value);
     return true;
   }
 
   static Variant issetProp(const Object& this_, const String& name) {
-    return Derived::map.isset(this_, name);
+    auto const pa = Derived::map.lookup(name, "Accessing");
+    if (!pa) return Native::prop_not_handled();
+    return pa->getter && !pa->getter(this_).isNull();
   }
 
   static bool isPropSupported(const String& name, const String& /*op*/) {
@@ -1568,49 +1577,22 @@ struct DOMPropertyAccessorMap :
     return iter != end();
   }
 
-  Variant (*getter(const String& name))(const Object&) {
-    auto dpa = DOMPropertyAccessor {
-      name.data(), nullptr, nullptr
-    };
-    const_iterator iter = find(&dpa);
-    if (iter != end() && (*iter)->getter) {
-      if (strcmp(dpa.name, (*iter)->name)) {
-        raise_warning("Accessing DOMNode derived property '%s' with the "
-                      "incorrect casing", dpa.name);
-      }
-      return (*iter)->getter;
-    }
-    return dummy_getter;
-  }
-
-  void (*setter(const String& name))(const Object&, const Variant&) {
-    auto dpa = DOMPropertyAccessor {
-      name.data(), nullptr, nullptr
-    };
-    const_iterator iter = find(&dpa);
-    if (iter != end() && (*iter)->setter) {
-      if (strcmp(dpa.name, (*iter)->name)) {
-        raise_warning("Setting DOMNode derived property '%s' with the "
-                      "incorrect casing", dpa.name);
-      }
-      return (*iter)->setter;
-    }
-    return dummy_setter;
-  }
-
-  bool isset(const Object& obj, const String& name) {
+  /*
+   * Resolve a property with a single probe; returns nullptr when the
+   * property is unknown.  `act' names the operation for the casing
+   * warning ("Accessing" or "Setting").
+   */
+  const DOMPropertyAccessor* lookup(const String& name, const char* act) {
     auto dpa = DOMPropertyAccessor {
       name.data(), nullptr, nullptr
     };
     const_iterator iter = find(&dpa);
-    if (iter != end() && (*iter)->getter) {
-      if (strcmp(dpa.name, (*iter)->name)) {
-        raise_warning("Accessing DOMNode derived property '%s' with the "
-                      "incorrect casing", dpa.name);
-      }
-      return !(*iter)->getter(obj).isNull();
+    if (iter == end()) return nullptr;
+    if (strcmp(dpa.name, (*iter)->name)) {
+      raise_warning("%s DOMNode derived property '%s' with the "
+                    "incorrect casing", act, dpa.name);
     }
-    return false;
+    return *iter;
   }
 
   Array debugInfo(const Object& obj) {
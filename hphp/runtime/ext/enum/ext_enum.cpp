@@ -40,11 +40,25 @@ static Array HHVM_STATIC_METHOD(BuiltinEnum, getNames) {
   return values->names;
 }
 
+/*
+ * Probe the names array with an already-normalized key, applying the
+ * same int-like string coercion the generic array path would.  The
+ * names array of a static enum is an uncounted scalar array, so this is
+ * a single hash probe with no request-heap traffic.
+ */
+static bool enumHasValue(const EnumValues* values, const Variant& value) {
+  auto const ad = values->names.get();
+  if (value.isInteger()) return ad->exists(value.toInt64());
+  auto const sd = value.getStringData();
+  int64_t num;
+  return sd->isStrictlyInteger(num) ? ad->exists(num) : ad->exists(sd);
+}
+
 static bool HHVM_STATIC_METHOD(BuiltinEnum, isValid, const Variant &value) {
   if (UNLIKELY(!value.isInteger() && !value.isString())) return false;
 
   const EnumValues* values = EnumCache::getValuesBuiltin(self_);
-  return values->names.exists(value);
+  return enumHasValue(values, value);
 }
 
 static Variant HHVM_STATIC_METHOD(BuiltinEnum, coerce, const Variant &value) {
@@ -68,7 +82,7 @@ static Variant HHVM_STATIC_METHOD(BuiltinEnum, coerce, const Variant &value) {
   // and the underlying type is a string, convert it to a string so
   // the output type is right.
   const EnumValues* values = EnumCache::getValuesBuiltin(self_);
-  if (!values->names.exists(value)) {
+  if (!enumHasValue(values, value)) {
     res = Variant(Variant::NullInit{});
   } else if (base && isStringType(*base) && value.isInteger()) {
     res = Variant(value.toString());
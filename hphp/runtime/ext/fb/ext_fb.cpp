@@ -39,11 +39,14 @@
 #include "hphp/runtime/base/plain-file.h"
 #include "hphp/runtime/base/unit-cache.h"
 #include "hphp/runtime/base/intercept.h"
+#include "hphp/runtime/base/packed-array.h"
+#include "hphp/runtime/base/req-containers.h"
 #include "hphp/runtime/base/runtime-option.h"
 #include "hphp/runtime/base/stat-cache.h"
 #include "hphp/runtime/base/string-buffer.h"
 #include "hphp/runtime/base/string-util.h"
 #include "hphp/runtime/base/thread-info.h"
+#include "hphp/runtime/base/tv-refcount.h"
 #include "hphp/runtime/base/tv-type.h"
 #include "hphp/runtime/ext/std/ext_std_function.h"
 #include "hphp/runtime/ext/fb/FBSerialize/FBSerialize.h"
@@ -695,8 +698,26 @@ int fb_compact_unserialize_from_buffer(
     case FB_CS_LIST_MAP:
     case FB_CS_VECTOR:
     {
-      Array arr = Array::Create();
-      int64_t i = 0;
+      // Decode elements into a flat value buffer and build the packed
+      // array in one shot, rather than growing an array with a keyed set
+      // per element. A SKIP leaves a hole, so from the first one onward
+      // the result is no longer packed and we fall back to keyed sets.
+      req::vector<TypedValue> vals;
+      while (p < n && buf[p] != (char)(kCodePrefix | FB_CS_STOP) &&
+             buf[p] != (char)(kCodePrefix | FB_CS_SKIP)) {
+        Variant value;
+        int err = fb_compact_unserialize_from_buffer(value, buf, n, p);
+        if (err) {
+          for (auto& tv : vals) tvDecRefGen(&tv);
+          return err;
+        }
+        vals.push_back(value.detach());
+      }
+      Array arr = vals.empty()
+        ? Array::Create()
+        : Array::attach(
+            PackedArray::MakePackedNatural(vals.size(), vals.data()));
+      int64_t i = vals.size();
       while (p < n && buf[p] != (char)(kCodePrefix | FB_CS_STOP)) {
         if (buf[p] == (char)(kCodePrefix | FB_CS_SKIP)) {
           ++i;
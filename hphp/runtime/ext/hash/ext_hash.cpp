@@ -18,6 +18,7 @@
 #include "hphp/runtime/ext/hash/ext_hash.h"
 #include <algorithm>
 #include <memory>
+#include "hphp/runtime/base/array-iterator.h"
 #include "hphp/runtime/base/comparisons.h"
 #include "hphp/runtime/ext/std/ext_std_file.h"
 #include "hphp/runtime/ext/string/ext_string.h"
@@ -50,6 +51,7 @@ static struct HashExtension final : Extension {
   void moduleInit() override {
     HHVM_FE(hash);
     HHVM_FE(hash_algos);
+    HHVM_FE(hash_batch);
     HHVM_FE(hash_file);
     HHVM_FE(hash_final);
     HHVM_FE(hash_init);
@@ -275,6 +277,34 @@ Variant HHVM_FUNCTION(hash, const String& algo, const String& data,
   return php_hash_do_hash(algo, data, false, raw_output);
 }
 
+Variant HHVM_FUNCTION(hash_batch, const String& algo, const Array& data,
+                                  bool raw_output /* = false */) {
+  HashEnginePtr ops = php_hash_fetch_ops(algo);
+  if (!ops) {
+    raise_warning("Unknown hashing algorithm: %s", algo.data());
+    return false;
+  }
+
+  /* One algorithm lookup and one context allocation for the whole batch;
+     the context is re-initialized per input. */
+  void *context = malloc(ops->context_size);
+  Array ret = Array::Create();
+  for (ArrayIter iter(data); iter; ++iter) {
+    String sdata = iter.second().toString();
+    ops->hash_init(context);
+    ops->hash_update(context, (unsigned char *)sdata.data(), sdata.size());
+
+    String raw = String(ops->digest_size, ReserveString);
+    ops->hash_final((unsigned char *)raw.mutableData(), context);
+    raw.setSize(ops->digest_size);
+
+    ret.set(iter.first(),
+            raw_output ? Variant(raw) : Variant(HHVM_FN(bin2hex)(raw)));
+  }
+  free(context);
+  return ret;
+}
+
 Variant HHVM_FUNCTION(hash_file, const String& algo, const String& filename,
                                  bool raw_output /* = false */) {
   if (filename.size() != strlen(filename.data())) {
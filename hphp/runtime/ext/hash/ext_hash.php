@@ -19,6 +19,24 @@
 function hash(string $algo, string $data,
               bool $raw_output = false): mixed;
 
+/**
+ * hash_batch() - Hash several strings with a single algorithm lookup
+ *                and hashing context.
+ *
+ * @param string $algo     - Name of selected hashing algorithm
+ *                           (i.e. "md5", "sha256", "haval160,4", etc..)
+ * @param array $data      - Messages to be hashed.
+ * @param bool $raw_output - When set to TRUE, outputs raw binary data.
+ *                           FALSE outputs lowercase hexits.
+ *
+ * @return array - The calculated message digests, keyed the same way
+ *                 as the input array.
+ *                 On error, FALSE is returned.
+ */
+<<__Native,__IsFoldable>>
+function hash_batch(string $algo, array<string> $data,
+                    bool $raw_output = false): mixed;
+
 /**
  * hash_algos() - http://php.net/function.hash-algos
  *
@@ -17,6 +17,11 @@
 
 #include "hphp/runtime/ext/hash/hash_sha.h"
 
+#ifdef __x86_64__
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -107,6 +112,17 @@ static void SHADecode32(unsigned int *output, const unsigned char *input,
       (((unsigned int) input[j]) << 24);
 }
 
+#ifdef __x86_64__
+/* SHA extensions: CPUID.(EAX=07H,ECX=0):EBX.SHA[bit 29]. */
+static bool cpu_supports_sha() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, nullptr) < 7) return false;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  return (ebx & (1u << 29)) != 0;
+}
+static const bool s_sha_ni = cpu_supports_sha();
+#endif
+
 /* F, G, H and I are basic SHA1 functions.
  */
 #define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
@@ -433,6 +449,141 @@ static void SHA256Transform(unsigned int state[8],
   memset((unsigned char*) x, 0, sizeof(x));
 }
 
+#ifdef __x86_64__
+/*
+  SHA256 transformation using the SHA-NI instructions. The sha256rnds2
+  instruction performs two rounds at a time on an (A,B,E,F)/(C,D,G,H)
+  split of the state; sha256msg1/msg2 compute the message schedule. Each
+  round group below consumes four K constants, loaded straight from
+  SHA256_K, whose layout matches the lane order the instruction expects.
+*/
+__attribute__((__target__("sha,ssse3,sse4.1")))
+static void SHA256TransformNI(unsigned int state[8],
+                              const unsigned char *input,
+                              size_t nblocks) {
+  __m128i MSG, TMP, MSG0, MSG1, MSG2, MSG3;
+
+  /* Interleave state into the ABEF/CDGH form the instructions use. */
+  TMP = _mm_loadu_si128((const __m128i*) &state[0]);            /* DCBA */
+  __m128i STATE1 = _mm_loadu_si128((const __m128i*) &state[4]); /* HGFE */
+  TMP = _mm_shuffle_epi32(TMP, 0xB1);                           /* CDAB */
+  STATE1 = _mm_shuffle_epi32(STATE1, 0x1B);                     /* EFGH */
+  __m128i STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);             /* ABEF */
+  STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);                  /* CDGH */
+
+  /* Big-to-little-endian byte shuffle for message loads. */
+  const __m128i MASK =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  const __m128i *K = (const __m128i*) SHA256_K;
+
+  while (nblocks-- > 0) {
+    const __m128i ABEF_SAVE = STATE0;
+    const __m128i CDGH_SAVE = STATE1;
+
+    /* Rounds 0-3 */
+    MSG0 = _mm_shuffle_epi8(
+      _mm_loadu_si128((const __m128i*) (input + 0)), MASK);
+    MSG = _mm_add_epi32(MSG0, _mm_loadu_si128(K + 0));
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+    MSG = _mm_shuffle_epi32(MSG, 0x0E);
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+    /* Rounds 4-7 */
+    MSG1 = _mm_shuffle_epi8(
+      _mm_loadu_si128((const __m128i*) (input + 16)), MASK);
+    MSG = _mm_add_epi32(MSG1, _mm_loadu_si128(K + 1));
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+    MSG = _mm_shuffle_epi32(MSG, 0x0E);
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+    MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+
+    /* Rounds 8-11 */
+    MSG2 = _mm_shuffle_epi8(
+      _mm_loadu_si128((const __m128i*) (input + 32)), MASK);
+    MSG = _mm_add_epi32(MSG2, _mm_loadu_si128(K + 2));
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+    MSG = _mm_shuffle_epi32(MSG, 0x0E);
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+    MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+
+    /* Rounds 12-15 */
+    MSG3 = _mm_shuffle_epi8(
+      _mm_loadu_si128((const __m128i*) (input + 48)), MASK);
+    MSG = _mm_add_epi32(MSG3, _mm_loadu_si128(K + 3));
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+    TMP = _mm_alignr_epi8(MSG3, MSG2, 4);
+    MSG0 = _mm_add_epi32(MSG0, TMP);
+    MSG0 = _mm_sha256msg2_epu32(MSG0, MSG3);
+    MSG = _mm_shuffle_epi32(MSG, 0x0E);
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+    MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+
+    /* Rounds 16-51: the schedule rotates through MSG0..MSG3. */
+    #define SHA256_NI_4ROUNDS(E, EP, T2, T3, k, last_msg1)              \
+      MSG = _mm_add_epi32(E, _mm_loadu_si128(K + (k)));                 \
+      STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);              \
+      TMP = _mm_alignr_epi8(E, EP, 4);                                  \
+      T2 = _mm_add_epi32(T2, TMP);                                      \
+      T2 = _mm_sha256msg2_epu32(T2, E);                                 \
+      MSG = _mm_shuffle_epi32(MSG, 0x0E);                               \
+      STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);              \
+      if (last_msg1) T3 = _mm_sha256msg1_epu32(T3, E);
+
+    SHA256_NI_4ROUNDS(MSG0, MSG3, MSG1, MSG3,  4, true);
+    SHA256_NI_4ROUNDS(MSG1, MSG0, MSG2, MSG0,  5, true);
+    SHA256_NI_4ROUNDS(MSG2, MSG1, MSG3, MSG1,  6, true);
+    SHA256_NI_4ROUNDS(MSG3, MSG2, MSG0, MSG2,  7, true);
+    SHA256_NI_4ROUNDS(MSG0, MSG3, MSG1, MSG3,  8, true);
+    SHA256_NI_4ROUNDS(MSG1, MSG0, MSG2, MSG0,  9, true);
+    SHA256_NI_4ROUNDS(MSG2, MSG1, MSG3, MSG1, 10, true);
+    SHA256_NI_4ROUNDS(MSG3, MSG2, MSG0, MSG2, 11, true);
+    SHA256_NI_4ROUNDS(MSG0, MSG3, MSG1, MSG3, 12, true);
+
+    /* Rounds 52-55 and 56-59: no further msg1 feeding needed. */
+    SHA256_NI_4ROUNDS(MSG1, MSG0, MSG2, MSG0, 13, false);
+    SHA256_NI_4ROUNDS(MSG2, MSG1, MSG3, MSG1, 14, false);
+
+    #undef SHA256_NI_4ROUNDS
+
+    /* Rounds 60-63 */
+    MSG = _mm_add_epi32(MSG3, _mm_loadu_si128(K + 15));
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG);
+    MSG = _mm_shuffle_epi32(MSG, 0x0E);
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+    STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+    STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+    input += 64;
+  }
+
+  /* Deinterleave back to linear state. */
+  TMP = _mm_shuffle_epi32(STATE0, 0x1B);                        /* FEBA */
+  STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);                     /* DCHG */
+  STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0);                  /* DCBA */
+  STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);                     /* HGFE */
+  _mm_storeu_si128((__m128i*) &state[0], STATE0);
+  _mm_storeu_si128((__m128i*) &state[4], STATE1);
+}
+#endif
+
+/*
+  Transform a run of contiguous 64-byte blocks, using the SHA-NI path
+  when the CPU has it.
+*/
+static void SHA256TransformBlocks(unsigned int state[8],
+                                  const unsigned char *input,
+                                  size_t nblocks) {
+#ifdef __x86_64__
+  if (s_sha_ni) {
+    SHA256TransformNI(state, input, nblocks);
+    return;
+  }
+#endif
+  for (; nblocks > 0; --nblocks, input += 64) {
+    SHA256Transform(state, input);
+  }
+}
+
 /*
   SHA256 block update operation. Continues an SHA256 message-digest
   operation, processing another message block, and updating the
@@ -460,11 +611,13 @@ void hash_sha256::hash_update(void *context_, const unsigned char *input,
   if (inputLen >= partLen) {
     memcpy((unsigned char*) & context->buffer[index],
            (unsigned char*) input, partLen);
-    SHA256Transform(context->state, context->buffer);
+    SHA256TransformBlocks(context->state, context->buffer, 1);
 
-    for (i = partLen; i + 63 < inputLen; i += 64) {
-      SHA256Transform(context->state, &input[i]);
+    unsigned int blocks = (inputLen - partLen) >> 6;
+    if (blocks > 0) {
+      SHA256TransformBlocks(context->state, &input[partLen], blocks);
     }
+    i = partLen + (blocks << 6);
 
     index = 0;
   } else {
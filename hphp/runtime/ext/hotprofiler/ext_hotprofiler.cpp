@@ -33,6 +33,7 @@
 #include "hphp/runtime/vm/jit/translator-inline.h"
 #include "hphp/util/alloc.h"
 #include "hphp/util/cycles.h"
+#include "hphp/util/tsc-clock.h"
 #include "hphp/util/vdso.h"
 
 #include <iostream>
@@ -341,7 +342,15 @@ Profiler::Profiler(bool needCPUAffinity) : m_successful(true),
       srand(math_generate_seed());
     }
 
-    if (m_has_affinity) {
+    if (TscClock::invariant()) {
+      //
+      // The TSC ticks at one constant rate on every core, so there is no
+      // need to pin the thread to a cpu, and the per-boot calibrated rate
+      // is more trustworthy than /proc/cpuinfo's current P-state frequency.
+      //
+      m_has_affinity = false;
+      m_MHz = TscClock::tickRateMHz();
+    } else if (m_has_affinity) {
       //
       // Bind to a random cpu so that we can use rdtsc instruction.
       //
@@ -3,6 +3,11 @@
 #include "hphp/runtime/base/zend-collator.h"
 #include "hphp/runtime/base/zend-qsort.h"
 
+#include <folly/SharedMutex.h>
+
+#include <string>
+#include <unordered_map>
+
 namespace HPHP { namespace Intl {
 /////////////////////////////////////////////////////////////////////////////
 // class Collator
@@ -15,6 +20,41 @@ enum CollatorSort {
 
 const StaticString s_Collator("Collator");
 
+/* Process-wide cache of opened collators, keyed by the locale passed to
+ * ucol_open().  Opening a collator loads tailoring data and is far more
+ * expensive than ucol_safeClone() of an already-open one.  Masters are
+ * published once, never mutated, and never closed, so lookups only take
+ * the shared lock; each Collator object works on its own clone, keeping
+ * setAttribute()/setStrength() local to the object. */
+static folly::SharedMutex s_masterLock;
+static std::unordered_map<std::string, const UCollator*> s_masterCols;
+
+static UCollator* cloneMasterCollator(const char* locale) {
+  folly::SharedMutex::ReadHolder lock(s_masterLock);
+  auto const it = s_masterCols.find(locale);
+  if (it == s_masterCols.end()) {
+    return nullptr;
+  }
+  UErrorCode error = U_ZERO_ERROR;
+  int32_t bufSize = 1; /* force heap allocation on older ICU */
+  auto const col = ucol_safeClone(it->second, nullptr, &bufSize, &error);
+  return U_SUCCESS(error) ? col : nullptr;
+}
+
+static void publishMasterCollator(const char* locale, const UCollator* col) {
+  UErrorCode error = U_ZERO_ERROR;
+  int32_t bufSize = 1;
+  auto const master = ucol_safeClone(col, nullptr, &bufSize, &error);
+  if (U_FAILURE(error)) {
+    return;
+  }
+  folly::SharedMutex::WriteHolder lock(s_masterLock);
+  if (!s_masterCols.emplace(locale, master).second) {
+    /* Lost the publish race; the other master is equivalent. */
+    ucol_close(master);
+  }
+}
+
 #define FETCH_COL(dest, src, ret) \
   auto dest = Collator::Get(src); \
   if (!dest) { \
@@ -26,21 +66,34 @@ static void HHVM_METHOD(Collator, __construct, const String& locale) {
   auto data = Native::data<Collator>(this_);
   data->clearError();
   if (!locale.empty()) {
+    if (auto const col = cloneMasterCollator(locale.c_str())) {
+      data->setCollator(col);
+      return;
+    }
     UErrorCode error = U_ZERO_ERROR;
     data->setCollator(ucol_open(locale.c_str(), &error));
     if (U_SUCCESS(error)) {
+      publishMasterCollator(locale.c_str(), data->collator());
       return;
     }
     /* Fallthrough and use default collator */
   }
   data->setError(U_USING_FALLBACK_WARNING);
+  /* Key the cache by the resolved default name: the per-request default
+   * locale may differ between requests. */
+  auto const defLocale = uloc_getDefault();
+  if (auto const col = cloneMasterCollator(defLocale)) {
+    data->setCollator(col);
+    return;
+  }
   UErrorCode error = U_ZERO_ERROR;
-  data->setCollator(ucol_open(uloc_getDefault(), &error));
+  data->setCollator(ucol_open(defLocale, &error));
   if (U_FAILURE(error)) {
     data->setError(error, "collator_create: unable to open ICU collator");
     data->setCollator(nullptr);
     return;
   }
+  publishMasterCollator(defLocale, data->collator());
 }
 
 static bool HHVM_METHOD(Collator, asort, VRefParam arr, int64_t flag) {
@@ -20,6 +20,11 @@
 #include "hphp/runtime/ext/icu/ext_icu_calendar.h"
 #include <math.h>
 
+#include <folly/SharedMutex.h>
+
+#include <string>
+#include <unordered_map>
+
 namespace HPHP { namespace Intl {
 //////////////////////////////////////////////////////////////////////////////
 // Internal Resource Data
@@ -38,6 +43,30 @@ const StaticString
 
 Class* IntlDateFormatter::c_IntlDateFormatter = nullptr;
 
+/* Process-wide cache of opened date formatters, keyed by the arguments
+ * passed to udat_open().  Opening one loads locale and pattern data and is
+ * far more expensive than udat_clone() of an already-open formatter.
+ * Masters are published once, never mutated, and never closed, so lookups
+ * only take the shared lock; every construction works on its own clone,
+ * including the calendar/timezone adoption below. */
+static folly::SharedMutex s_masterLock;
+static std::unordered_map<std::string, const UDateFormat*> s_masterFmts;
+
+static const UDateFormat* lookupMasterFormatter(const std::string& key) {
+  folly::SharedMutex::ReadHolder lock(s_masterLock);
+  auto const it = s_masterFmts.find(key);
+  return (it != s_masterFmts.end()) ? it->second : nullptr;
+}
+
+static void publishMasterFormatter(const std::string& key,
+                                   const UDateFormat* fmt) {
+  folly::SharedMutex::WriteHolder lock(s_masterLock);
+  if (!s_masterFmts.emplace(key, fmt).second) {
+    /* Lost the publish race; the other master is equivalent. */
+    udat_close(const_cast<UDateFormat*>(fmt));
+  }
+}
+
 void IntlDateFormatter::setDateFormatter(const String& locale,
                                          int64_t datetype, int64_t timetype,
                                          const Variant& timezone, const Variant& calendar,
@@ -69,16 +98,50 @@ void IntlDateFormatter::setDateFormatter(const String& locale,
   error = U_ZERO_ERROR;
   if (m_date_fmt) {
     udat_close(m_date_fmt);
+    m_date_fmt = nullptr;
+  }
+
+  /* Only explicit locales are cacheable: the default locale may be changed
+   * per request via Locale::setDefault().  The key mirrors exactly what is
+   * handed to udat_open() below. */
+  std::string key;
+  if (!locale.empty()) {
+    key.reserve(locale.size() + pattern.size() + 8);
+    key.append(std::to_string(datetype));
+    key.push_back('\0');
+    key.append(std::to_string(timetype));
+    key.push_back('\0');
+    key.append(locale.data(), locale.size());
+    key.push_back('\0');
+    key.append(pattern.data(), pattern.size());
+    if (auto const master = lookupMasterFormatter(key)) {
+      m_date_fmt = udat_clone(master, &error);
+      if (U_FAILURE(error)) {
+        /* Fall through and open from scratch. */
+        m_date_fmt = nullptr;
+        error = U_ZERO_ERROR;
+      }
+    }
   }
-  m_date_fmt = udat_open(pat.isEmpty()?(UDateFormatStyle)timetype:UDAT_IGNORE,
-                         pat.isEmpty()?(UDateFormatStyle)datetype:UDAT_IGNORE,
-                         locale.c_str(), nullptr, 0,
-                         pat.getBuffer(), pat.length(),
-                         &error);
-  if (U_FAILURE(error)) {
-    s_intl_error->setError(error, "datefmt_create: date "
-                                  "formatter creation failed");
-    return;
+
+  if (!m_date_fmt) {
+    m_date_fmt = udat_open(pat.isEmpty()?(UDateFormatStyle)timetype:UDAT_IGNORE,
+                           pat.isEmpty()?(UDateFormatStyle)datetype:UDAT_IGNORE,
+                           locale.c_str(), nullptr, 0,
+                           pat.getBuffer(), pat.length(),
+                           &error);
+    if (U_FAILURE(error)) {
+      s_intl_error->setError(error, "datefmt_create: date "
+                                    "formatter creation failed");
+      return;
+    }
+    if (!key.empty()) {
+      UErrorCode cloneError = U_ZERO_ERROR;
+      auto const master = udat_clone(m_date_fmt, &cloneError);
+      if (U_SUCCESS(cloneError)) {
+        publishMasterFormatter(key, master);
+      }
+    }
   }
 
   icu::DateFormat *obj = datefmtObject();
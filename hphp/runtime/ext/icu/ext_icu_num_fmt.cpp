@@ -15,9 +15,15 @@
    +----------------------------------------------------------------------+
 */
 #include "hphp/runtime/ext/icu/ext_icu_num_fmt.h"
+#include "hphp/runtime/base/array-iterator.h"
 #include "hphp/runtime/base/exceptions.h"
 #include "hphp/runtime/ext/string/ext_string.h"
 
+#include <folly/SharedMutex.h>
+
+#include <string>
+#include <unordered_map>
+
 namespace HPHP { namespace Intl {
 //////////////////////////////////////////////////////////////////////////////
 // Internal resource data
@@ -38,6 +44,31 @@ static const int64_t k_UNUM_TYPE_INT64 = 2;
 static const int64_t k_UNUM_TYPE_DOUBLE = 3;
 static const int64_t k_UNUM_TYPE_CURRENCY = 4;
 
+/* Process-wide cache of opened formatters, keyed by the arguments passed
+ * to unum_open().  Opening a formatter parses locale data and the pattern
+ * and costs tens of microseconds; unum_clone() of an already-open one is
+ * cheap.  Masters are published once, never mutated, and never closed, so
+ * lookups only take the shared lock.  Each construction still gets its own
+ * clone: later setAttribute()/setPattern() calls stay local to the object.
+ */
+static folly::SharedMutex s_masterLock;
+static std::unordered_map<std::string, const UNumberFormat*> s_masterFmts;
+
+static const UNumberFormat* lookupMasterFormatter(const std::string& key) {
+  folly::SharedMutex::ReadHolder lock(s_masterLock);
+  auto const it = s_masterFmts.find(key);
+  return (it != s_masterFmts.end()) ? it->second : nullptr;
+}
+
+static void publishMasterFormatter(const std::string& key,
+                                   const UNumberFormat* fmt) {
+  folly::SharedMutex::WriteHolder lock(s_masterLock);
+  if (!s_masterFmts.emplace(key, fmt).second) {
+    /* Lost the publish race; the other master is equivalent. */
+    unum_close(const_cast<UNumberFormat*>(fmt));
+  }
+}
+
 void NumberFormatter::setNumberFormatter(const String& locale,
                                          int64_t style,
                                          const String& pattern) {
@@ -51,6 +82,27 @@ void NumberFormatter::setNumberFormatter(const String& locale,
 
   const String loc(localeOrDefault(locale));
 
+  /* Only explicit locales are cacheable: the default locale may be changed
+   * per request via Locale::setDefault().  The key mirrors exactly what is
+   * handed to unum_open() below. */
+  std::string key;
+  if (!locale.empty()) {
+    key.reserve(locale.size() + pattern.size() + 4);
+    key.append(std::to_string(style));
+    key.push_back('\0');
+    key.append(locale.data(), locale.size());
+    key.push_back('\0');
+    key.append(pattern.data(), pattern.size());
+    if (auto const master = lookupMasterFormatter(key)) {
+      error = U_ZERO_ERROR;
+      m_formatter = unum_clone(master, &error);
+      if (U_SUCCESS(error)) {
+        return;
+      }
+      /* Fall through and open from scratch. */
+    }
+  }
+
   error = U_ZERO_ERROR;
   m_formatter = unum_open((UNumberFormatStyle)style,
                           pat.getBuffer(), pat.length(),
@@ -61,6 +113,14 @@ void NumberFormatter::setNumberFormatter(const String& locale,
         "numfmt_create: number formatter creation failed");
     throwException("%s", s_intl_error->getErrorMessage().c_str());
   }
+
+  if (!key.empty()) {
+    error = U_ZERO_ERROR;
+    auto const master = unum_clone(m_formatter, &error);
+    if (U_SUCCESS(error)) {
+      publishMasterFormatter(key, master);
+    }
+  }
 }
 
 void NumberFormatter::setNumberFormatter(const NumberFormatter *orig) {
@@ -212,6 +272,28 @@ static Variant HHVM_METHOD(NumberFormatter, format, const Variant& value,
   }
 }
 
+/* Format an array of numbers through a single formatter acquisition,
+ * avoiding the per-call object fetch and dispatch of format().  Keys are
+ * preserved.  Returns false if any element fails to format. */
+static Variant HHVM_METHOD(NumberFormatter, formatBatch, const Array& values) {
+  NUMFMT_GET(obj, this_, false);
+  Array ret = Array::Create();
+  for (ArrayIter iter(values); iter; ++iter) {
+    Variant num(iter.second());
+    int64_t ival = 0;
+    double dval = 0.0;
+    DataType dt = num.toNumeric(ival, dval, true);
+    auto const formatted = (dt == KindOfDouble)
+      ? doFormat(obj, dval)
+      : doFormat(obj, (dt == KindOfInt64) ? ival : num.toInt64());
+    if (!formatted.isString()) {
+      return false;
+    }
+    ret.set(iter.first(), formatted);
+  }
+  return ret;
+}
+
 static Variant HHVM_METHOD(NumberFormatter, getAttribute, int64_t attr) {
   NUMFMT_GET(obj, this_, false);
   switch (attr) {
@@ -475,6 +557,7 @@ void IntlExtension::initNumberFormatter() {
   HHVM_ME(NumberFormatter, __construct);
   HHVM_ME(NumberFormatter, formatCurrency);
   HHVM_ME(NumberFormatter, format);
+  HHVM_ME(NumberFormatter, formatBatch);
   HHVM_ME(NumberFormatter, getAttribute);
   HHVM_ME(NumberFormatter, getErrorCode);
   HHVM_ME(NumberFormatter, getErrorMessage);
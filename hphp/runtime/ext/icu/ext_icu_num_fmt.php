@@ -84,6 +84,18 @@ class NumberFormatter {
   public function format(mixed $value,
                          int $type = NumberFormatter::TYPE_DEFAULT): mixed;
 
+  /**
+   * Format an array of numbers through a single formatter acquisition
+   *
+   * @param array $values - The values to format. Each can be integer or
+   *   float, other values will be converted to a numeric value.
+   *
+   * @return mixed - Array of formatted strings with the input keys
+   *   preserved, or FALSE on error.
+   */
+  <<__Native>>
+  public function formatBatch(array $values): mixed;
+
   /**
    * Get an attribute
    *
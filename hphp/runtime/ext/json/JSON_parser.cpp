@@ -34,6 +34,10 @@ SOFTWARE.
 
 #include <vector>
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #include "hphp/runtime/base/builtin-functions.h"
 #include "hphp/runtime/base/collections.h"
 #include "hphp/runtime/base/string-buffer.h"
@@ -359,6 +363,7 @@ struct SimpleParser {
  private:
   SimpleParser(const char* input, int length, TypedValue* buffer)
       : p(input),
+        end(input + length),
         top(buffer),
         array_depth(-kMaxArrayDepth) /* Start negative to simplify check. */ {
     assert(input[length] == 0);  // Parser relies on sentinel to avoid checks.
@@ -383,7 +388,9 @@ struct SimpleParser {
   NEVER_INLINE
   void skipSpace() { while (isSpace(*p)) p++; }
   bool isSpace(char ch) const {
-    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\f';
+    // Matches S_WSP/S_SPA in both transition tables; notably '\f' is a
+    // control-character error there, not whitespace.
+    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r';
   }
 
   bool parseValue() {
@@ -434,6 +441,32 @@ struct SimpleParser {
   bool parseString() {
     int len = 0;
     auto const charTop = reinterpret_cast<signed char*>(top);
+#ifdef __x86_64__
+    // Scan and copy 16 input bytes per iteration, stopping at the first
+    // byte that ends the simple case: the closing quote, an escape, a
+    // quote character, a control character, or non-ASCII (the signed
+    // compare against ' ' catches the last two at once, mirroring the
+    // scalar loop below).  Unconditionally storing the whole chunk is
+    // safe: the stack buffer reserves 8 bytes per input character, which
+    // always covers the at most 15 bytes written past the string's end.
+    while (end - p >= 16) {
+      auto const chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(charTop + len), chunk);
+      auto const special = _mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"')),
+                     _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')),
+                     _mm_cmplt_epi8(chunk, _mm_set1_epi8(' ')))));
+      if (special != 0) {
+        auto const idx = __builtin_ctz(special);
+        len += idx;
+        p += idx;
+        break;
+      }
+      len += 16;
+      p += 16;
+    }
+#endif
     for (signed char ch = *p++; ch != '\"'; ch = *p++) {
       charTop[len++] = ch;
       // Signed char means less than ' ' also catches non-ASCII.
@@ -508,6 +541,15 @@ struct SimpleParser {
       x = firstChar - '0';  // first digit
     }
     // Parse maximal digit sequence into x (non-negative).
+#if defined(__x86_64__) || defined(__aarch64__)
+    // Bulk-parse eight digits at a time; accumulating mod 2^64 gives the
+    // same result as the per-digit loop, so the overflow handling below
+    // is unaffected.
+    while (end - p >= 8 && isEightDigits(p)) {
+      x = (x * 100000000) + parseEightDigits(p);
+      p += 8;
+    }
+#endif
     while (*p >= '0' && *p <= '9') {
       x = (x * 10) + (*p - '0');
       ++p;
@@ -528,6 +570,28 @@ struct SimpleParser {
     return true;
   }
 
+#if defined(__x86_64__) || defined(__aarch64__)
+  /*
+   * SWAR digit parsing; the byte-order tricks assume little-endian, which
+   * holds for every architecture admitted by the guard.
+   */
+  static bool isEightDigits(const char* chars) {
+    uint64_t val;
+    memcpy(&val, chars, 8);
+    return ((val & 0xf0f0f0f0f0f0f0f0ULL) |
+            (((val + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+  }
+
+  static uint32_t parseEightDigits(const char* chars) {
+    uint64_t val;
+    memcpy(&val, chars, 8);
+    val = (val & 0x0f0f0f0f0f0f0f0fULL) * 2561 >> 8;
+    val = (val & 0x00ff00ff00ff00ffULL) * 6553601 >> 16;
+    return (val & 0x0000ffff0000ffffULL) * 42949672960001ULL >> 32;
+  }
+#endif
+
   /*
    * Assuming 'len' characters ('0'-'9', maybe prefix '-') have been read,
    * re-parse and push as an int64_t if possible, otherwise as a double.
@@ -570,6 +634,7 @@ struct SimpleParser {
   }
 
   const char* p;
+  const char* end;
   TypedValue* top;
   int array_depth;
 };
@@ -989,7 +1054,7 @@ bool JSON_parser(Variant &z, const char *p, int length, bool const assoc,
   // if its array nesting depth check is *more* restrictive than what the user
   // asks for, to ensure that the precise semantics of the general case is
   // applied for all nesting overflows.
-  if (assoc && options == k_JSON_FB_LOOSE &&
+  if (assoc && (options == 0 || options == k_JSON_FB_LOOSE) &&
       depth >= SimpleParser::kMaxArrayDepth &&
       length <= RuntimeOption::EvalSimpleJsonMaxLength &&
       SimpleParser::TryParse(p, length, json->tl_buffer.tv, z)) {
@@ -55,6 +55,7 @@ const int64_t k_JSON_FB_EXTRA_ESCAPES  = 1<<22;
 const int64_t k_JSON_FB_COLLECTIONS    = 1<<23;
 const int64_t k_JSON_FB_STABLE_MAPS    = 1<<24;
 const int64_t k_JSON_FB_HACK_ARRAYS    = 1<<25;
+const int64_t k_JSON_FB_STREAM_OUTPUT  = 1<<26;
 
 const int64_t k_JSON_ERROR_NONE
   = json_error_codes::JSON_ERROR_NONE;
@@ -119,6 +120,16 @@ TypedValue HHVM_FUNCTION(json_encode, const Variant& value,
   VariableSerializer vs(VariableSerializer::Type::JSON, options);
   vs.setDepthLimit(depth);
 
+  if (options & k_JSON_FB_STREAM_OUTPUT) {
+    // Write straight into the request's output buffer chain instead of
+    // materializing multi-MB results. Anything encoded before an error is
+    // already in the buffer, so this behaves like partial output; returns
+    // whether encoding completed cleanly.
+    vs.serializeToOutput(value);
+    return make_tv<KindOfBoolean>(
+      json_get_last_error_code() == json_error_codes::JSON_ERROR_NONE);
+  }
+
   String json = vs.serializeValue(value, !(options & k_JSON_FB_UNLIMITED));
   assertx(json.get() != nullptr);
   if (UNLIKELY(StructuredLog::coinflip(RuntimeOption::EvalSerDesSampleRate))) {
@@ -260,6 +271,7 @@ struct JsonExtension final : Extension {
     HHVM_RC_INT(JSON_FB_COLLECTIONS, k_JSON_FB_COLLECTIONS);
     HHVM_RC_INT(JSON_FB_HACK_ARRAYS, k_JSON_FB_HACK_ARRAYS);
     HHVM_RC_INT(JSON_FB_STABLE_MAPS, k_JSON_FB_STABLE_MAPS);
+    HHVM_RC_INT(JSON_FB_STREAM_OUTPUT, k_JSON_FB_STREAM_OUTPUT);
     HHVM_RC_INT(JSON_ERROR_NONE, k_JSON_ERROR_NONE);
     HHVM_RC_INT(JSON_ERROR_DEPTH, k_JSON_ERROR_DEPTH);
     HHVM_RC_INT(JSON_ERROR_STATE_MISMATCH, k_JSON_ERROR_STATE_MISMATCH);
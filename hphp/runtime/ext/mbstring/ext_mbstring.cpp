@@ -27,6 +27,7 @@
 #include "hphp/runtime/base/zend-string.h"
 #include "hphp/runtime/base/ini-setting.h"
 #include "hphp/runtime/base/request-event-handler.h"
+#include "hphp/util/utf8-scan.h"
 
 #include <map>
 
@@ -1180,6 +1181,17 @@ bool HHVM_FUNCTION(mb_check_encoding,
     }
   }
 
+  /* Strictly valid UTF-8 round-trips unchanged through libmbfl's UTF-8
+   * filter, so a vectorized validation pass can accept the common case
+   * without building a converter.  Anything the strict validator rejects
+   * still goes through the converter below, which owns the final verdict
+   * and the illegalchars bookkeeping.
+   */
+  if (no_encoding == mbfl_no_encoding_utf8 &&
+      utf8_is_valid(var.data(), var.size())) {
+    return true;
+  }
+
   convd = mbfl_buffer_converter_new(no_encoding, no_encoding, 0);
   if (convd == nullptr) {
     raise_warning("Unable to create converter");
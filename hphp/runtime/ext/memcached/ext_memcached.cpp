@@ -19,11 +19,17 @@
 #include "hphp/runtime/base/array-init.h"
 #include "hphp/runtime/ext/extension.h"
 #include "hphp/runtime/vm/native-data.h"
+#include "hphp/runtime/ext/asio/asio-external-thread-event.h"
 #include "hphp/runtime/ext/memcached/libmemcached_portability.h"
 #include "hphp/runtime/base/builtin-functions.h"
+#include "hphp/runtime/base/tv-mutate.h"
 #include "hphp/runtime/ext/json/ext_json.h"
+#include "hphp/util/job-queue.h"
+#include "hphp/util/lock.h"
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <fastlz.h>
 #include <zlib.h>
@@ -121,10 +127,19 @@ struct MemcachedData {
       memcached_create(&memcached);
     };
     ~Impl() {
+      if (async_memcached) {
+        memcached_free(async_memcached);
+      }
       memcached_free(&memcached);
     }
 
     memcached_st memcached;
+    // Connection used by the async multiget workers, cloned lazily from
+    // the main handle so awaited multigets never share sockets with
+    // synchronous calls issued from the request thread. Guarded by
+    // async_mutex, which also serializes the workers.
+    memcached_st* async_memcached{nullptr};
+    std::mutex async_mutex;
     bool compression;
     int serializer;
     int rescode;
@@ -193,10 +208,12 @@ struct MemcachedData {
                    encoded.data(), encoded.data() + encoded.length());
   }
   bool toObject(Variant& value, const memcached_result_st &result) {
-    const char *payload  = memcached_result_value(&result);
-    size_t payloadLength = memcached_result_length(&result);
-    uint32_t flags       = memcached_result_flags(&result);
-
+    return decodePayload(memcached_result_value(&result),
+                         memcached_result_length(&result),
+                         memcached_result_flags(&result), value);
+  }
+  static bool decodePayload(const char *payload, size_t payloadLength,
+                            uint32_t flags, Variant& value) {
     String decompPayload;
     if (flags & MEMC_VAL_COMPRESSED) {
       bool done = false;
@@ -457,6 +474,170 @@ struct MemcachedData {
   static DECLARE_THREAD_LOCAL(ImplMap, s_persistentMap);
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// Asynchronous multiget
+
+namespace {
+
+struct MultigetEvent final : AsioExternalThreadEvent {
+  MultigetEvent(MemcachedData::ImplPtr impl, const String& server_key,
+                const Array& keys)
+    : m_impl(std::move(impl))
+    , m_serverKey(server_key.data(), server_key.size()) {
+    m_keys.reserve(keys.size());
+    for (ArrayIter iter(keys); iter; ++iter) {
+      Variant vKey = iter.second();
+      if (!vKey.isString()) continue;
+      StringData *key = vKey.getStringData();
+      if (key->empty()) continue;
+      m_keys.emplace_back(key->data(), key->size());
+    }
+  }
+
+  // Runs on a multiget worker thread: one blocking mget and drain on the
+  // impl's dedicated async connection, with raw payloads stashed in
+  // non-request memory for unserialize() to decode.
+  void fetch() {
+    std::lock_guard<std::mutex> lock(m_impl->async_mutex);
+    auto mc = m_impl->async_memcached;
+    if (!mc) {
+      m_status = MEMCACHED_FAILURE;
+    } else if (m_keys.empty()) {
+      m_status = MEMCACHED_BAD_KEY_PROVIDED;
+    } else {
+      std::vector<const char*> keys;
+      std::vector<size_t> lengths;
+      keys.reserve(m_keys.size());
+      lengths.reserve(m_keys.size());
+      for (auto& key : m_keys) {
+        keys.push_back(key.data());
+        lengths.push_back(key.size());
+      }
+      const char *serverKey = m_serverKey.empty() ? nullptr
+                                                  : m_serverKey.data();
+      m_status = memcached_mget_by_key(mc, serverKey, m_serverKey.size(),
+                                       keys.data(), lengths.data(),
+                                       keys.size());
+      if (m_status == MEMCACHED_SUCCESS) {
+        memcached_result_st result;
+        memcached_result_create(mc, &result);
+        memcached_return status;
+        while (memcached_fetch_result(mc, &result, &status)) {
+          if (status != MEMCACHED_SUCCESS) {
+            m_status = MEMCACHED_SOME_ERRORS;
+            continue;
+          }
+          m_hits.emplace_back();
+          auto& hit = m_hits.back();
+          hit.key.assign(memcached_result_key_value(&result),
+                         memcached_result_key_length(&result));
+          hit.payload.assign(memcached_result_value(&result),
+                             memcached_result_length(&result));
+          hit.flags = memcached_result_flags(&result);
+        }
+        memcached_result_free(&result);
+      }
+    }
+    markAsFinished();
+  }
+
+  // Back on the request thread: decode the payloads into request-local
+  // values. Errors surface the same way as the synchronous API: a false
+  // result with the code available from getResultCode().
+  void unserialize(Cell& result) override {
+    if (m_status != MEMCACHED_SUCCESS && m_status != MEMCACHED_SOME_ERRORS) {
+      m_impl->rescode = m_status;
+      cellCopy(make_tv<KindOfBoolean>(false), result);
+      return;
+    }
+    Array ret = Array::Create();
+    for (auto& hit : m_hits) {
+      Variant value;
+      if (!MemcachedData::decodePayload(hit.payload.data(),
+                                        hit.payload.size(),
+                                        hit.flags, value)) {
+        m_impl->rescode = q_Memcached$$RES_PAYLOAD_FAILURE;
+        cellCopy(make_tv<KindOfBoolean>(false), result);
+        return;
+      }
+      ret.set(String(hit.key.data(), hit.key.size(), CopyString), value);
+    }
+    m_impl->rescode = m_status;
+    cellCopy(make_tv<KindOfArray>(ret.detach()), result);
+  }
+
+ private:
+  struct Hit {
+    std::string key;
+    std::string payload;
+    uint32_t flags;
+  };
+
+  MemcachedData::ImplPtr m_impl;
+  std::string m_serverKey;
+  std::vector<std::string> m_keys;
+  std::vector<Hit> m_hits;
+  memcached_return m_status{MEMCACHED_FAILURE};
+};
+
+struct MultigetWorker : JobQueueWorker<MultigetEvent*, void*, false, false> {
+  void doJob(MultigetEvent *job) override {
+    job->fetch();
+  }
+};
+
+const int kMultigetThreadCount = 4;
+JobQueueDispatcher<MultigetWorker> *s_multigetDispatcher;
+Mutex s_multigetMutex;
+
+void enqueueMultiget(MultigetEvent* event) {
+  Lock l(s_multigetMutex);
+  if (!s_multigetDispatcher) {
+    s_multigetDispatcher = new JobQueueDispatcher<MultigetWorker>
+      (kMultigetThreadCount, 0, false, nullptr);
+    s_multigetDispatcher->start();
+  }
+  s_multigetDispatcher->enqueue(event);
+}
+
+Object getMultiAsyncImpl(ObjectData* this_, const String& server_key,
+                         const Array& keys) {
+  auto data = Native::data<MemcachedData>(this_);
+  data->m_impl->rescode = MEMCACHED_SUCCESS;
+  {
+    // Create the async connection here on the request thread, where the
+    // main handle is quiescent; workers only ever touch the clone.
+    std::lock_guard<std::mutex> lock(data->m_impl->async_mutex);
+    if (!data->m_impl->async_memcached) {
+      auto clone = memcached_clone(nullptr, &data->m_impl->memcached);
+      if (clone) {
+        memcached_behavior_set(clone, MEMCACHED_BEHAVIOR_SUPPORT_CAS, 0);
+      }
+      data->m_impl->async_memcached = clone;
+    }
+  }
+  auto event = new MultigetEvent(data->m_impl, server_key, keys);
+  try {
+    enqueueMultiget(event);
+  } catch (...) {
+    // Never made it onto the queue; no worker will ever finish it.
+    event->abandon();
+    throw;
+  }
+  return Object{event->getWaitHandle()};
+}
+
+} // namespace
+
+Object HHVM_METHOD(Memcached, getmultiasync, const Array& keys) {
+  return getMultiAsyncImpl(this_, empty_string(), keys);
+}
+
+Object HHVM_METHOD(Memcached, getmultibykeyasync, const String& server_key,
+                              const Array& keys) {
+  return getMultiAsyncImpl(this_, server_key, keys);
+}
+
 void HHVM_METHOD(Memcached, __construct,
                             const Variant& persistent_id /*= null*/) {
   auto data = Native::data<MemcachedData>(this_);
@@ -1214,6 +1395,8 @@ struct MemcachedExtension final : Extension {
     HHVM_ME(Memcached, getallkeys);
     HHVM_ME(Memcached, getbykey);
     HHVM_ME(Memcached, getmultibykey);
+    HHVM_ME(Memcached, getmultiasync);
+    HHVM_ME(Memcached, getmultibykeyasync);
     HHVM_ME(Memcached, getdelayedbykey);
     HHVM_ME(Memcached, fetch);
     HHVM_ME(Memcached, fetchall);
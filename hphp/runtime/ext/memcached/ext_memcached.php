@@ -432,6 +432,35 @@ class Memcached {
                                 mixed &$cas_tokens = null,
                                 int $flags = 0): mixed;
 
+  /**
+   * Retrieve multiple items without blocking the request thread. The
+   * multiget is issued from a background thread over a dedicated
+   * connection, so awaiting the result overlaps the memcache round trip
+   * with other work in the request.
+   *
+   * @param array $keys - Array of keys to retrieve.
+   *
+   * @return Awaitable - The array of found items, or FALSE on error
+   *   (check getResultCode()).
+   */
+  <<__Native>>
+  public function getMultiAsync(array $keys): Awaitable<mixed>;
+
+  /**
+   * Retrieve multiple items from a specific server without blocking the
+   * request thread.
+   *
+   * @param string $server_key - The key identifying the server to fetch
+   *   from.
+   * @param array $keys - Array of keys to retrieve.
+   *
+   * @return Awaitable - The array of found items, or FALSE on error
+   *   (check getResultCode()).
+   */
+  <<__Native>>
+  public function getMultiByKeyAsync(string $server_key,
+                                     array $keys): Awaitable<mixed>;
+
   /**
    * Retrieve a Memcached option value
    *
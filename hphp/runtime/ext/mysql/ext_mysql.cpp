@@ -714,6 +714,11 @@ static Variant HHVM_FUNCTION(mysql_fetch_array, const Resource& result,
   return php_mysql_fetch_hash(result, result_type);
 }
 
+static Variant HHVM_FUNCTION(mysql_fetch_all, const Resource& result,
+                                         int result_type /* = 3 */) {
+  return php_mysql_fetch_all(result, result_type);
+}
+
 static Variant HHVM_FUNCTION(mysql_fetch_object,
                       const Variant& var_result,
                       const String& class_name /* = "stdClass" */,
@@ -994,6 +999,7 @@ void mysqlExtension::moduleInit() {
   HHVM_FE(mysql_list_processes);
   HHVM_FE(mysql_data_seek);
   HHVM_FE(mysql_fetch_array);
+  HHVM_FE(mysql_fetch_all);
   HHVM_FE(mysql_fetch_object);
   HHVM_FE(mysql_fetch_lengths);
   HHVM_FE(mysql_result);
@@ -258,6 +258,23 @@ function mysql_escape_string(string $unescaped_string): string;
 function mysql_fetch_array(resource $result,
                            int $result_type = MYSQL_BOTH): mixed;
 
+/**
+ * Fetch all remaining result rows in one call (HHVM extension)
+ *
+ * @param resource $result -
+ * @param int $result_type - result_type   The type of array to produce
+ *   for each row, as for mysql_fetch_array(): MYSQL_ASSOC, MYSQL_NUM,
+ *   or MYSQL_BOTH.
+ *
+ * @return mixed - Returns an array containing one array per remaining
+ *   result row, or FALSE on failure. Materializing the whole result set
+ *   natively is considerably cheaper than calling mysql_fetch_array()
+ *   in a loop.
+ */
+<<__Native>>
+function mysql_fetch_all(resource $result,
+                         int $result_type = MYSQL_BOTH): mixed;
+
 /**
  * Fetch a result row as an associative array
  *
@@ -981,11 +981,14 @@ class mysqli_result {
    *   holding result rows.
    */
   public function fetch_all(int $resulttype = MYSQLI_NUM): mixed {
-    $result = array();
-    while (($row = $this->fetch_array($resulttype)) !== null) {
-      $result[] = $row;
+    $result = mysql_fetch_all(
+      $this->__result,
+      $this->__mysqli_to_mysql_resulttype($resulttype),
+    );
+    if ($result === false) {
+      return array();
     }
-
+    $this->__done = true;
     return $result;
   }
 
@@ -33,6 +33,7 @@
 
 #include "hphp/system/systemlib.h"
 
+#include "hphp/runtime/base/array-init.h"
 #include "hphp/runtime/base/builtin-functions.h"
 #include "hphp/runtime/base/comparisons.h"
 #include "hphp/runtime/base/extended-logger.h"
@@ -1772,6 +1773,107 @@ Variant php_mysql_fetch_hash(const Resource& result, int result_type) {
   return ret;
 }
 
+/*
+ * Materialize an entire result set in one call.  This is what
+ * fetch_all-style APIs want: compared to looping php_mysql_fetch_hash
+ * from PHP it converts the field names exactly once, preallocates the
+ * outer array from the row count and each row array from the field
+ * count, and skips the per-row field cursor reset.
+ */
+Variant php_mysql_fetch_all(const Resource& result, int result_type) {
+  if ((result_type & PHP_MYSQL_BOTH) == 0) {
+    throw_invalid_argument("result_type: %d", result_type);
+    return false;
+  }
+
+  auto res = php_mysql_extract_result(result);
+  if (!res) return false;
+
+  auto const num_fields = res->getFieldCount();
+  auto const slots = (result_type & PHP_MYSQL_NUM ? num_fields : 0) +
+                     (result_type & PHP_MYSQL_ASSOC ? num_fields : 0);
+
+  // Associative keys, converted from the field names up front.  Numeric
+  // column aliases become integer keys, just as Array::set would make
+  // them in the row-at-a-time path.
+  req::vector<Variant> keys;
+  auto const addKey = [&] (const String& name) {
+    int64_t n;
+    if (name.get()->isStrictlyInteger(n)) {
+      keys.push_back(n);
+    } else {
+      keys.push_back(name);
+    }
+  };
+
+  PackedArrayInit rows(std::max<int64_t>(res->getRowCount(), 0));
+
+  if (res->isLocalized()) {
+    if (result_type & PHP_MYSQL_ASSOC) {
+      keys.reserve(num_fields);
+      for (int64_t i = 0; i < num_fields; i++) {
+        addKey(res->getFieldInfo(i)->name);
+      }
+    }
+    while (res->fetchRow()) {
+      if (result_type == PHP_MYSQL_NUM) {
+        PackedArrayInit row(num_fields);
+        for (int64_t i = 0; i < num_fields; i++) {
+          row.append(res->getField(i));
+        }
+        rows.append(row.toArray());
+      } else {
+        ArrayInit row(slots, ArrayInit::Mixed{});
+        for (int64_t i = 0; i < num_fields; i++) {
+          auto const data = res->getField(i);
+          if (result_type & PHP_MYSQL_NUM) row.set(i, data);
+          if (result_type & PHP_MYSQL_ASSOC) row.setValidKey(keys[i], data);
+        }
+        rows.append(row.toArray());
+      }
+    }
+    return rows.toArray();
+  }
+
+  MYSQL_RES *mysql_result = res->get();
+  MYSQL_FIELD *mysql_fields = mysql_fetch_fields(mysql_result);
+  if (result_type & PHP_MYSQL_ASSOC) {
+    keys.reserve(num_fields);
+    for (int64_t i = 0; i < num_fields; i++) {
+      addKey(String(mysql_fields[i].name, CopyString));
+    }
+  }
+
+  MYSQL_ROW mysql_row;
+  while ((mysql_row = mysql_fetch_row(mysql_result)) != nullptr) {
+    unsigned long *mysql_row_lengths = mysql_fetch_lengths(mysql_result);
+    if (!mysql_row_lengths) {
+      return false;
+    }
+    auto const cell = [&] (int64_t i) -> Variant {
+      if (!mysql_row[i]) return init_null();
+      return mysql_makevalue(String(mysql_row[i], mysql_row_lengths[i],
+                                    CopyString), mysql_fields + i);
+    };
+    if (result_type == PHP_MYSQL_NUM) {
+      PackedArrayInit row(num_fields);
+      for (int64_t i = 0; i < num_fields; i++) {
+        row.append(cell(i));
+      }
+      rows.append(row.toArray());
+    } else {
+      ArrayInit row(slots, ArrayInit::Mixed{});
+      for (int64_t i = 0; i < num_fields; i++) {
+        auto const data = cell(i);
+        if (result_type & PHP_MYSQL_NUM) row.set(i, data);
+        if (result_type & PHP_MYSQL_ASSOC) row.setValidKey(keys[i], data);
+      }
+      rows.append(row.toArray());
+    }
+  }
+  return rows.toArray();
+}
+
 /* The mysql_*_nonblocking calls are Facebook extensions to
    libmysqlclient; for now, protect with an ifdef.  Once open sourced,
    the client will be detectable via its own ifdef. */
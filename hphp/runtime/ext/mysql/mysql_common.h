@@ -495,6 +495,7 @@ Variant php_mysql_do_query_and_get_result(
 #define PHP_MYSQL_BOTH   (PHP_MYSQL_ASSOC|PHP_MYSQL_NUM)
 
 Variant php_mysql_fetch_hash(const Resource& result, int result_type);
+Variant php_mysql_fetch_all(const Resource& result, int result_type);
 
 Variant mysql_makevalue(const String& data, MYSQL_FIELD *mysql_field);
 Variant mysql_makevalue(const String& data, enum_field_types field_type);
@@ -1055,6 +1055,30 @@ Array HHVM_FUNCTION(objprof_get_data,
   return objs.toArray();
 }
 
+/*
+ * Read the per-class live counters the GC refreshed at its last collection
+ * (Eval.GCClassCounters) instead of walking the heap. Bytes here are
+ * per-allocation heap sizes rather than the deep sizes objprof_get_data
+ * computes, and the numbers are only as fresh as the last collection, but
+ * the query itself is O(distinct classes) so it's safe in production.
+ * Returns an empty array if no collection has run with counters enabled.
+ */
+Array HHVM_FUNCTION(objprof_get_gc_data) {
+  if (!MemoryManager::hasGCClassCounts()) {
+    return Array::Create();
+  }
+  auto const counts = MemoryManager::getGCClassCounts();
+  ArrayInit objs(counts.size(), ArrayInit::Map{});
+  for (auto const& it : counts) {
+    auto metrics_val = make_map_array(
+      s_instances, Variant(it.instances),
+      s_bytes, Variant(it.bytes)
+    );
+    objs.set(it.cls->nameStr(), Variant(metrics_val));
+  }
+  return objs.toArray();
+}
+
 Array HHVM_FUNCTION(objprof_get_paths,
   int flags = ObjprofFlags::DEFAULT,
   const Array& exclude_list = Array()
@@ -1279,6 +1303,7 @@ struct objprofExtension final : Extension {
 
   void moduleInit() override {
     HHVM_FALIAS(HH\\objprof_get_data, objprof_get_data);
+    HHVM_FALIAS(HH\\objprof_get_gc_data, objprof_get_gc_data);
     HHVM_FALIAS(HH\\objprof_get_strings, objprof_get_strings);
     HHVM_FALIAS(HH\\objprof_get_paths, objprof_get_paths);
     HHVM_FALIAS(HH\\thread_memory_stats, thread_memory_stats);
@@ -34,6 +34,14 @@ function objprof_get_data(
   array<string> $exclude_list = array(),
 ): array<string, ObjprofObjectStats>;
 
+type ObjprofGcStats = shape(
+  'instances' => int,
+  'bytes'     => int,
+);
+
+<<__Native>>
+function objprof_get_gc_data(): array<string, ObjprofGcStats>;
+
 <<__Native>>
 function objprof_get_paths(
   int $flags = OBJPROF_FLAGS_DEFAULT,
@@ -337,6 +337,10 @@ struct PcreExtension final : Extension {
                      &tl_pcre_globals->preg_recursion_limit);
   }
 
+  void requestShutdown() override {
+    pcre_session_exit();
+  }
+
 } s_pcre_extension;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2892,6 +2892,22 @@ static Variant HHVM_METHOD(PDOStatement, fetchall, int64_t how /* = 0 */,
     how |= self->m_stmt->default_fetch_type & ~PDO_FETCH_FLAGS;
   }
 
+  /* For plain row fetches, let the driver hydrate every remaining row
+   * straight into arrays rather than cycling through do_fetch per row. */
+  if (!error && flags == 0) {
+    auto const simpleHow = how & ~PDO_FETCH_FLAGS;
+    if (simpleHow == PDO_FETCH_NUM || simpleHow == PDO_FETCH_ASSOC ||
+        simpleHow == PDO_FETCH_BOTH) {
+      setPDOErrorNone(self->m_stmt->error_code);
+      Array rows;
+      if (self->m_stmt->fetchAllRows((PDOFetchType)simpleHow, rows)) {
+        self->m_stmt->fetch.clsname = old_clsname;
+        self->m_stmt->fetch.ctor_args = old_ctor_args;
+        return rows;
+      }
+    }
+  }
+
   Variant *return_all = NULL;
   Variant return_value;
   Variant data;
@@ -313,6 +313,11 @@ bool PDOStatement::fetcher(PDOFetchOrientation /*ori*/, long /*offset*/) {
   return false;
 }
 
+bool PDOStatement::fetchAllRows(PDOFetchType /*how*/, Array& /*rows*/) {
+  /* No bulk fetch; callers fall back to the row-by-row path. */
+  return false;
+}
+
 bool PDOStatement::describer(int /*colno*/) {
   throw_pdo_exception(uninit_null(), uninit_null(),
                       "This driver doesn't support %s", __func__);
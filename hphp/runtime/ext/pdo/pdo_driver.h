@@ -569,6 +569,13 @@ public:
    * if the stmt represents a scrollable cursor */
   virtual bool fetcher(PDOFetchOrientation ori, long offset);
 
+  /* optional bulk fetch: hydrate every remaining row directly into `rows'
+   * (an array of arrays), bypassing the per-row fetcher/getColumn cycle.
+   * Only consulted for plain FETCH_NUM/FETCH_ASSOC/FETCH_BOTH fetchAll()
+   * calls with no fetch flags.  Return false to fall back to the generic
+   * row-by-row path; the base implementation always does. */
+  virtual bool fetchAllRows(PDOFetchType how, Array& rows);
+
   /* queries information about the type of a column, by index (0 based).
    * Driver should populate stmt->columns[colno] with appropriate info */
   virtual bool describer(int colno);
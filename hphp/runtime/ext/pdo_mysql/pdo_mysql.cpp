@@ -26,6 +26,9 @@
 #include "mysql.h"
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #ifdef PHP_MYSQL_UNIX_SOCK_ADDR
 #ifdef MYSQL_UNIX_ADDR
@@ -78,10 +81,25 @@ struct PDOMySqlConnection : PDOConnection {
   unsigned long max_buffer_size() const { return m_max_buffer_size; }
   bool fetch_table_names() const { return m_fetch_table_names; }
 
+  /*
+   * Prepared-statement reuse.  A MYSQL_STMT is a server-side object tied
+   * to its connection, so retired statement handles are cached here, on
+   * the connection, keyed by the (rewritten) SQL text.  Persistent
+   * connections are thread-affine (see s_connections in ext_pdo.cpp),
+   * which makes this reuse connection-affine and lock-free; the cache
+   * outlives requests along with the connection, so a steady query mix
+   * stops re-preparing after the first request.
+   */
+  bool stmtCacheEnabled() const { return is_persistent; }
+  MYSQL_STMT* fetchCachedStmt(const std::string& sql);
+  void stashStmt(const std::string& sql, MYSQL_STMT* stmt);
+
   int handleError(const char *file, int line,
                   PDOMySqlStatement *stmt = nullptr);
 
 private:
+  void clearStmtCache();
+
   MYSQL* m_server;
   unsigned m_attached : 1;
   unsigned m_buffered : 1;
@@ -89,6 +107,7 @@ private:
   unsigned m_fetch_table_names : 1;
   unsigned long m_max_buffer_size;
   PDOMySqlError m_einfo;
+  std::unordered_map<std::string, MYSQL_STMT*> m_stmtCache;
 };
 
 struct PDOMySqlResource : PDOResource {
@@ -112,6 +131,7 @@ struct PDOMySqlStatement : PDOStatement {
   bool support(SupportedMethod method) override;
   bool executer() override;
   bool fetcher(PDOFetchOrientation ori, long offset) override;
+  bool fetchAllRows(PDOFetchType how, Array& rows) override;
   bool describer(int colno) override;
   bool getColumn(int colno, Variant &value) override;
   bool paramHook(PDOBoundParam* param, PDOParamEvent event_type) override;
@@ -139,6 +159,7 @@ private:
   unsigned long* m_out_length;
   unsigned int m_params_given;
   unsigned m_max_length:1;
+  std::string m_cacheKey;  // set iff the handle may be stashed on sweep
 
   void setRowCount();
   bool executePrepared();
@@ -172,6 +193,7 @@ PDOMySqlConnection::PDOMySqlConnection()
 }
 
 PDOMySqlConnection::~PDOMySqlConnection() {
+  clearStmtCache();
   if (m_server) {
     mysql_close(m_server);
   }
@@ -180,6 +202,34 @@ PDOMySqlConnection::~PDOMySqlConnection() {
   }
 }
 
+void PDOMySqlConnection::clearStmtCache() {
+  for (auto& pair : m_stmtCache) {
+    mysql_stmt_close(pair.second);
+  }
+  m_stmtCache.clear();
+}
+
+MYSQL_STMT* PDOMySqlConnection::fetchCachedStmt(const std::string& sql) {
+  auto const it = m_stmtCache.find(sql);
+  if (it == m_stmtCache.end()) return nullptr;
+  auto const stmt = it->second;
+  m_stmtCache.erase(it);
+  return stmt;
+}
+
+void PDOMySqlConnection::stashStmt(const std::string& sql, MYSQL_STMT* stmt) {
+  /* A same-keyed statement may already be parked if the request prepared
+   * the query twice; keep the resident one.  The cap is generous for a
+   * typical application's query mix while bounding server-side handles
+   * on long-lived persistent connections. */
+  constexpr size_t kMaxCachedStmts = 256;
+  if (m_stmtCache.count(sql) || m_stmtCache.size() >= kMaxCachedStmts) {
+    mysql_stmt_close(stmt);
+    return;
+  }
+  m_stmtCache.emplace(sql, stmt);
+}
+
 const StaticString s_localhost("localhost");
 const std::string s_default_socket_option("pdo_mysql.default_socket");
 
@@ -421,6 +471,7 @@ bool PDOMySqlConnection::support(SupportedMethod /*method*/) {
 }
 
 bool PDOMySqlConnection::closer() {
+  clearStmtCache();
   if (m_server) {
     mysql_close(m_server);
     m_server = NULL;
@@ -852,6 +903,21 @@ PDOMySqlStatement::~PDOMySqlStatement() {
 }
 
 void PDOMySqlStatement::sweep() {
+  if (m_stmt) {
+    /* Park the server-side handle on the connection for reuse rather than
+     * tearing it down, as long as we know the SQL it was prepared against
+     * and no extra result sets are pending.  Freeing the result here is a
+     * client-side operation; mysql_stmt_reset would cost a round trip. */
+    if (!m_cacheKey.empty() && m_conn &&
+        (!m_server || !mysql_more_results(m_server))) {
+      mysql_stmt_free_result(m_stmt);
+      m_conn->stashStmt(m_cacheKey, m_stmt);
+    } else {
+      mysql_stmt_close(m_stmt);
+    }
+    m_stmt = NULL;
+  }
+
   // Release the connection
   m_conn.reset();
 
@@ -864,10 +930,6 @@ void PDOMySqlStatement::sweep() {
     free(m_einfo.errmsg);
     m_einfo.errmsg = NULL;
   }
-  if (m_stmt) {
-    mysql_stmt_close(m_stmt);
-    m_stmt = NULL;
-  }
 
   if (m_params) {
     free(m_params);
@@ -917,6 +979,28 @@ bool PDOMySqlStatement::create(const String& sql, const Array& options) {
     nsql = sql;
   }
 
+  /* On persistent connections, a statement retired by a previous request
+   * for the same (rewritten) SQL can be reused without re-preparing.  The
+   * cache key is only recorded once the handle is known to be prepared, so
+   * sweep() never parks a handle the server hasn't seen. */
+  if (m_conn->stmtCacheEnabled()) {
+    auto key = nsql.toCppString();
+    if (auto const cached = m_conn->fetchCachedStmt(key)) {
+      m_cacheKey = std::move(key);
+      m_stmt = cached;
+      m_num_params = mysql_stmt_param_count(m_stmt);
+      if (m_num_params) {
+        m_params_given = 0;
+        m_params = (MYSQL_BIND*)calloc(m_num_params, sizeof(MYSQL_BIND));
+        m_in_null = (my_bool*)calloc(m_num_params, sizeof(my_bool));
+        m_in_length = (unsigned long*)calloc(m_num_params,
+                                             sizeof(unsigned long));
+      }
+      m_max_length = pdo_attr_lval(options, PDO_ATTR_MAX_COLUMN_LEN, 0);
+      return true;
+    }
+  }
+
   if (!(m_stmt = mysql_stmt_init(m_server))) {
     handleError(__FILE__, __LINE__);
     return false;
@@ -933,6 +1017,10 @@ bool PDOMySqlStatement::create(const String& sql, const Array& options) {
     return false;
   }
 
+  if (m_conn->stmtCacheEnabled()) {
+    m_cacheKey = nsql.toCppString();
+  }
+
   m_num_params = mysql_stmt_param_count(m_stmt);
   if (m_num_params) {
     m_params_given = 0;
@@ -1036,6 +1124,54 @@ bool PDOMySqlStatement::fetcher(PDOFetchOrientation /*ori*/, long /*offset*/) {
   return true;
 }
 
+bool PDOMySqlStatement::fetchAllRows(PDOFetchType how, Array& rows) {
+  /* Only the plain-query path is hydrated in bulk; prepared statements
+   * keep the generic bound-buffer fetch. */
+  if (m_stmt || !m_result || !m_fields) {
+    return false;
+  }
+
+  std::vector<String> names;
+  if (how != PDO_FETCH_NUM) {
+    names.reserve(column_count);
+    for (int i = 0; i < column_count; i++) {
+      if (m_conn->fetch_table_names()) {
+        names.push_back(String(m_fields[i].table) + "." +
+                        String(m_fields[i].name));
+      } else {
+        names.push_back(String(m_fields[i].name, CopyString));
+      }
+    }
+  }
+
+  rows = Array::Create();
+  MYSQL_ROW row;
+  while ((row = mysql_fetch_row(m_result)) != NULL) {
+    auto const lengths = mysql_fetch_lengths(m_result);
+    Array r = Array::Create();
+    for (int i = 0; i < column_count; i++) {
+      Variant v;
+      if (row[i]) {
+        v = String(row[i], lengths[i], CopyString);
+      }
+      if (how != PDO_FETCH_ASSOC) {
+        r.set((int64_t)i, v);
+      }
+      if (how != PDO_FETCH_NUM) {
+        r.set(names[i], v);
+      }
+    }
+    rows.append(r);
+  }
+  m_current_data = NULL;
+
+  if (mysql_errno(m_server)) {
+    handleError(__FILE__, __LINE__);
+    return false;
+  }
+  return true;
+}
+
 bool PDOMySqlStatement::describer(int colno) {
   if (!m_result) {
     return false;
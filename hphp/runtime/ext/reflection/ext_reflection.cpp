@@ -40,8 +40,12 @@
 
 #include "hphp/runtime/vm/native-prop-handler.h"
 
+#include "hphp/util/hash.h"
+
 #include <functional>
+#include <memory>
 #include <boost/algorithm/string/predicate.hpp>
+#include <tbb/concurrent_hash_map.h>
 
 namespace HPHP {
 
@@ -1282,8 +1286,51 @@ static Variant HHVM_METHOD(ReflectionClass, getDocComment) {
   }
 }
 
-static Array HHVM_METHOD(ReflectionClass, getRequirementNames) {
-  auto const cls = ReflectionClassHandle::GetClassFor(this_);
+static void addClassConstantNames(const Class* cls,
+                                  const req::ptr<c_Set>& st,
+                                  size_t limit);
+
+namespace {
+
+/*
+ * Materialized per-Class reflection info.
+ *
+ * The arrays returned by several ReflectionClass methods are a pure
+ * function of the class definition, yet they used to be rebuilt from the
+ * Class metadata on every call. Instead we build them once, on the first
+ * request that asks, turn them into uncounted scalar arrays and share the
+ * snapshot across all requests; the methods then hand the arrays out
+ * copy-free. Snapshots are dropped from Class::~Class (see
+ * Reflection::onClassDestruct); the treadmill guarantees no request can
+ * still be reading one at that point.
+ */
+struct ClassInfoSnapshot {
+  Array requirementNames;
+  Array interfaceNames;
+  Array traitNames;
+  Array abstractConstantNames;
+  Array typeConstantNames;
+  // name => value map for getConstants(). Left null when the class has
+  // dynamically initialized constants, whose values may differ between
+  // requests; getOrderedConstants falls back to rebuilding per call.
+  Array orderedConstants;
+};
+
+struct clsPointerHashCompare {
+  bool equal(const Class* c1, const Class* c2) const { return c1 == c2; }
+  size_t hash(const Class* cls) const {
+    return static_cast<size_t>(hash_int64(reinterpret_cast<intptr_t>(cls)));
+  }
+};
+
+using ClassInfoSnapshotMap = tbb::concurrent_hash_map<
+  const Class*,
+  const ClassInfoSnapshot*,
+  clsPointerHashCompare>;
+
+ClassInfoSnapshotMap s_classInfoSnapshots;
+
+Array buildRequirementNames(const Class* cls) {
   if (!(cls->attrs() & (AttrTrait | AttrInterface))) {
     // requirements are applied to abstract/concrete classes when they use
     // a trait / implement an interface
@@ -1304,9 +1351,7 @@ static Array HHVM_METHOD(ReflectionClass, getRequirementNames) {
   return pai.toArray();
 }
 
-static Array HHVM_METHOD(ReflectionClass, getInterfaceNames) {
-  auto const cls = ReflectionClassHandle::GetClassFor(this_);
-
+Array buildInterfaceNames(const Class* cls) {
   auto st = req::make<c_Set>();
   auto const& allIfaces = cls->allInterfaces();
   st->reserve(allIfaces.size());
@@ -1328,8 +1373,7 @@ static Array HHVM_METHOD(ReflectionClass, getInterfaceNames) {
   return ai.toArray();
 }
 
-static Array HHVM_METHOD(ReflectionClass, getTraitNames) {
-  auto const cls = ReflectionClassHandle::GetClassFor(this_);
+Array buildTraitNames(const Class* cls) {
   auto const& traits = cls->preClass()->usedTraits();
   PackedArrayInit ai(traits.size());
   for (const StringData* traitName : traits) {
@@ -1338,6 +1382,147 @@ static Array HHVM_METHOD(ReflectionClass, getTraitNames) {
   return ai.toArray();
 }
 
+Array buildAbstractConstantNames(const Class* cls) {
+  size_t numConsts = cls->numConstants();
+  if (!numConsts) {
+    return Array::Create();
+  }
+
+  auto st = req::make<c_Set>();
+  st->reserve(numConsts);
+
+  const Class::Const* consts = cls->constants();
+  for (size_t i = 0; i < numConsts; i++) {
+    if (consts[i].isAbstract() && !consts[i].isType()) {
+      st->add(const_cast<StringData*>(consts[i].name.get()));
+    }
+  }
+
+  assert(st->size() <= numConsts);
+  return st->toArray();
+}
+
+Array buildTypeConstantNames(const Class* cls) {
+  size_t numConsts = cls->numConstants();
+  if (!numConsts) {
+    return Array::Create();
+  }
+
+  auto st = req::make<c_Set>();
+  st->reserve(numConsts);
+
+  const Class::Const* consts = cls->constants();
+  for (size_t i = 0; i < numConsts; i++) {
+    if (consts[i].isType()) {
+      st->add(const_cast<StringData*>(consts[i].name.get()));
+    }
+  }
+
+  assert(st->size() <= numConsts);
+  return st->toArray();
+}
+
+Array buildOrderedConstants(const Class* cls) {
+  size_t numConsts = cls->numConstants();
+  if (!numConsts) {
+    return Array::Create();
+  }
+
+  auto st = req::make<c_Set>();
+  st->reserve(numConsts);
+
+  addClassConstantNames(cls, st, numConsts);
+  assert(st->size() <= numConsts);
+
+  ArrayInit ai(numConsts, ArrayInit::Mixed{});
+  for (ArrayIter iter(st.get()); iter; ++iter) {
+    auto constName = iter.first().getStringData();
+    Cell value = cls->clsCnsGet(constName);
+    assert(value.m_type != KindOfUninit);
+    ai.add(constName, cellAsCVarRef(value));
+  }
+  return ai.toArray();
+}
+
+// True iff every non-abstract, non-type constant of the class has a
+// statically known value. Constants initialized by 86cinit get fresh
+// values in every request and must not be cached across them.
+bool constantsArePersistent(const Class* cls) {
+  auto const consts = cls->constants();
+  for (size_t i = 0, n = cls->numConstants(); i < n; i++) {
+    if (consts[i].isAbstract() || consts[i].isType()) continue;
+    if (consts[i].val.m_type == KindOfUninit) return false;
+  }
+  return true;
+}
+
+const ClassInfoSnapshot* buildClassInfoSnapshot(const Class* cls) {
+  std::unique_ptr<ClassInfoSnapshot> snap(new ClassInfoSnapshot());
+  snap->requirementNames =
+    ArrayData::GetScalarArray(buildRequirementNames(cls).get());
+  snap->interfaceNames =
+    ArrayData::GetScalarArray(buildInterfaceNames(cls).get());
+  snap->traitNames =
+    ArrayData::GetScalarArray(buildTraitNames(cls).get());
+  snap->abstractConstantNames =
+    ArrayData::GetScalarArray(buildAbstractConstantNames(cls).get());
+  snap->typeConstantNames =
+    ArrayData::GetScalarArray(buildTypeConstantNames(cls).get());
+  if (constantsArePersistent(cls)) {
+    snap->orderedConstants =
+      ArrayData::GetScalarArray(buildOrderedConstants(cls).get());
+  }
+
+  ClassInfoSnapshotMap::accessor acc;
+  if (!s_classInfoSnapshots.insert(acc, cls)) {
+    // lost the race; hand out the winner's snapshot
+    return acc->second;
+  }
+  acc->second = snap.release();
+  return acc->second;
+}
+
+const ClassInfoSnapshot* getClassInfoSnapshot(const Class* cls) {
+  {
+    ClassInfoSnapshotMap::const_accessor acc;
+    if (s_classInfoSnapshots.find(acc, cls)) {
+      return acc->second;
+    }
+  }
+  return buildClassInfoSnapshot(cls);
+}
+
+}
+
+void Reflection::onClassDestruct(const Class* cls) {
+  // most classes are never reflected on, so probe before taking the
+  // write lock
+  {
+    ClassInfoSnapshotMap::const_accessor acc;
+    if (!s_classInfoSnapshots.find(acc, cls)) return;
+  }
+  ClassInfoSnapshotMap::accessor acc;
+  if (s_classInfoSnapshots.find(acc, cls)) {
+    delete acc->second;
+    s_classInfoSnapshots.erase(acc);
+  }
+}
+
+static Array HHVM_METHOD(ReflectionClass, getRequirementNames) {
+  auto const cls = ReflectionClassHandle::GetClassFor(this_);
+  return getClassInfoSnapshot(cls)->requirementNames;
+}
+
+static Array HHVM_METHOD(ReflectionClass, getInterfaceNames) {
+  auto const cls = ReflectionClassHandle::GetClassFor(this_);
+  return getClassInfoSnapshot(cls)->interfaceNames;
+}
+
+static Array HHVM_METHOD(ReflectionClass, getTraitNames) {
+  auto const cls = ReflectionClassHandle::GetClassFor(this_);
+  return getClassInfoSnapshot(cls)->traitNames;
+}
+
 static Array get_trait_alias_info(const Class* cls) {
   auto const& aliases = cls->traitAliases();
 
@@ -1503,74 +1688,25 @@ void addClassConstantNames(const Class* cls,
 // helper for getConstants
 static Array HHVM_METHOD(ReflectionClass, getOrderedConstants) {
   auto const cls = ReflectionClassHandle::GetClassFor(this_);
-
-  size_t numConsts = cls->numConstants();
-  if (!numConsts) {
-    return Array::Create();
-  }
-
-  auto st = req::make<c_Set>();
-  st->reserve(numConsts);
-
-  addClassConstantNames(cls, st, numConsts);
-  assert(st->size() <= numConsts);
-
-  ArrayInit ai(numConsts, ArrayInit::Mixed{});
-  for (ArrayIter iter(st.get()); iter; ++iter) {
-    auto constName = iter.first().getStringData();
-    Cell value = cls->clsCnsGet(constName);
-    assert(value.m_type != KindOfUninit);
-    ai.add(constName, cellAsCVarRef(value));
+  auto const snap = getClassInfoSnapshot(cls);
+  if (LIKELY(!snap->orderedConstants.isNull())) {
+    return snap->orderedConstants;
   }
-  return ai.toArray();
+  // the class has dynamically initialized constants; rebuild the map with
+  // this request's values
+  return buildOrderedConstants(cls);
 }
 
 // helper for getAbstractConstantNames
 static Array HHVM_METHOD(ReflectionClass, getOrderedAbstractConstants) {
   auto const cls = ReflectionClassHandle::GetClassFor(this_);
-
-  size_t numConsts = cls->numConstants();
-  if (!numConsts) {
-    return Array::Create();
-  }
-
-  auto st = req::make<c_Set>();
-  st->reserve(numConsts);
-
-  const Class::Const* consts = cls->constants();
-  for (size_t i = 0; i < numConsts; i++) {
-    if (consts[i].isAbstract() && !consts[i].isType()) {
-      st->add(const_cast<StringData*>(consts[i].name.get()));
-    }
-  }
-
-  assert(st->size() <= numConsts);
-  return st->toArray();
+  return getClassInfoSnapshot(cls)->abstractConstantNames;
 }
 
-
-
 // helper for getTypeConstants/hasTypeConstant
 static Array HHVM_METHOD(ReflectionClass, getOrderedTypeConstants) {
   auto const cls = ReflectionClassHandle::GetClassFor(this_);
-
-  size_t numConsts = cls->numConstants();
-  if (!numConsts) {
-    return Array::Create();
-  }
-
-  auto st = req::make<c_Set>();
-  st->reserve(numConsts);
-
-  const Class::Const* consts = cls->constants();
-  for (size_t i = 0; i < numConsts; i++) {
-    if (consts[i].isType()) {
-      st->add(const_cast<StringData*>(consts[i].name.get()));
-    }
-  }
-
-  assert(st->size() <= numConsts);
-  return st->toArray();
+  return getClassInfoSnapshot(cls)->typeConstantNames;
 }
 
 static Array HHVM_METHOD(ReflectionClass, getAttributes) {
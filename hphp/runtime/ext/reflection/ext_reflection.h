@@ -45,6 +45,11 @@ struct Reflection {
   static HPHP::Class* s_ReflectionExceptionClass;
   [[noreturn]]
   static void ThrowReflectionExceptionObject(const Variant& message);
+
+  /* Drop the materialized reflection info snapshot built for the given
+   * class, if there is one. Called from Class::~Class; a no-op for the
+   * (common) classes that were never reflected on. */
+  static void onClassDestruct(const Class* cls);
 };
 
 /* A ReflectionFuncHandle is a NativeData object wrapping a Func*
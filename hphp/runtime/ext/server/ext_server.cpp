@@ -27,6 +27,7 @@
 #include "hphp/runtime/server/pagelet-server.h"
 #include "hphp/runtime/server/rpc-request-handler.h"
 #include "hphp/runtime/server/satellite-server.h"
+#include "hphp/runtime/server/server-task-event.h"
 #include "hphp/runtime/server/xbox-server.h"
 #include "hphp/util/boot-stats.h"
 
@@ -50,6 +51,7 @@ static struct ServerExtension final : Extension {
     HHVM_FE(xbox_send_message);
     HHVM_FE(xbox_post_message);
     HHVM_FE(xbox_task_start);
+    HHVM_FE(xbox_task_start_async);
     HHVM_FE(xbox_task_status);
     HHVM_FE(xbox_task_result);
     HHVM_FE(xbox_process_call_message);
@@ -175,6 +177,20 @@ Resource HHVM_FUNCTION(xbox_task_start,
   return XboxServer::TaskStart(message);
 }
 
+Object HHVM_FUNCTION(xbox_task_start_async,
+                     const String& message) {
+  auto event = new ServerTaskEvent<XboxServer, XboxTransport>();
+  try {
+    XboxServer::TaskStart(message, "", event);
+  } catch (...) {
+    // The task never made it onto the queue, so the event will never be
+    // finished by a worker.
+    event->abandon();
+    throw;
+  }
+  return Object{event->getWaitHandle()};
+}
+
 bool HHVM_FUNCTION(xbox_task_status,
                    const Resource& task) {
   return XboxServer::TaskStatus(task);
@@ -58,6 +58,8 @@ bool HHVM_FUNCTION(xbox_post_message,
                    const String& host = "localhost");
 Resource HHVM_FUNCTION(xbox_task_start,
                        const String& message);
+Object HHVM_FUNCTION(xbox_task_start_async,
+                     const String& message);
 bool HHVM_FUNCTION(xbox_task_status,
                    const Resource& task);
 int64_t HHVM_FUNCTION(xbox_task_result,
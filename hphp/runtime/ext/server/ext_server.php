@@ -138,6 +138,21 @@ function xbox_post_message(string $msg, string $host = "localhost"): bool;
 <<__HipHopSpecific, __Native>>
 function xbox_task_start(string $message): resource;
 
+/**
+ * Starts a local xbox task and returns an awaitable for its result. The
+ *   awaitable completes when the task finishes, without any polling; the
+ *   result is the unserialized return value of xbox's message processing
+ *   function. A non-200 response is raised as an exception.
+ *
+ * @param string $message - A message to send to xbox's message processing
+ *   function.
+ *
+ * @return Awaitable<mixed> - An awaitable yielding the task's result.
+ *
+ */
+<<__HipHopSpecific, __Native>>
+function xbox_task_start_async(string $message): Awaitable<mixed>;
+
 /**
  * Checks an xbox task's status.
  *
@@ -22,6 +22,8 @@
 #include <fcntl.h>
 #include <signal.h>
 
+#include <vector>
+
 #if HAVE_IF_NAMETOINDEX
 #include <net/if.h>
 #endif
@@ -1383,6 +1385,191 @@ Variant HHVM_FUNCTION(socket_recvfrom,
   return retval;
 }
 
+const int k_MMSG_MAX_BATCH = 1024;
+
+Variant HHVM_FUNCTION(socket_sendmmsg,
+                      const Resource& socket,
+                      const Array& messages,
+                      int flags /* = 0 */,
+                      const String& addr /* = null_string */,
+                      int port /* = -1 */) {
+  auto sock = cast<Socket>(socket);
+  if (messages.empty()) {
+    return 0;
+  }
+  if (messages.size() > k_MMSG_MAX_BATCH) {
+    raise_warning("socket_sendmmsg(): batch larger than %d messages",
+                  k_MMSG_MAX_BATCH);
+    return false;
+  }
+
+  struct sockaddr_storage sa_storage;
+  struct sockaddr *sa_ptr = nullptr;
+  size_t sa_size = 0;
+  if (!addr.empty()) {
+    if (!set_sockaddr(sa_storage, sock, addr.c_str(), port,
+                      sa_ptr, sa_size)) {
+      return false;
+    }
+  }
+
+  // Count segments up front so the iovec array never reallocates while the
+  // msghdrs point into it, and hold a reference on every segment for the
+  // duration of the syscall. Each message is either a string or an array of
+  // string segments; segments are gathered by the kernel, not concatenated.
+  size_t niov = 0;
+  for (ArrayIter iter(messages); iter; ++iter) {
+    auto const& msg = iter.secondRef();
+    niov += msg.isArray() ? msg.toArray().size() : 1;
+  }
+  std::vector<String> segments;
+  segments.reserve(niov);
+  std::vector<struct iovec> iovs(niov);
+  std::vector<struct msghdr> hdrs(messages.size());
+
+  size_t msg_i = 0;
+  size_t iov_i = 0;
+  for (ArrayIter iter(messages); iter; ++iter) {
+    struct msghdr &hdr = hdrs[msg_i++];
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = sa_ptr;
+    hdr.msg_namelen = sa_size;
+    hdr.msg_iov = &iovs[iov_i];
+
+    auto const& msg = iter.secondRef();
+    if (msg.isArray()) {
+      Array parts = msg.toArray();
+      hdr.msg_iovlen = parts.size();
+      for (ArrayIter piter(parts); piter; ++piter) {
+        segments.push_back(piter.second().toString());
+        const String& seg = segments.back();
+        iovs[iov_i].iov_base = const_cast<char*>(seg.data());
+        iovs[iov_i].iov_len = seg.size();
+        ++iov_i;
+      }
+    } else {
+      segments.push_back(msg.toString());
+      const String& seg = segments.back();
+      hdr.msg_iovlen = 1;
+      iovs[iov_i].iov_base = const_cast<char*>(seg.data());
+      iovs[iov_i].iov_len = seg.size();
+      ++iov_i;
+    }
+  }
+
+#ifdef __linux__
+  std::vector<struct mmsghdr> mhdrs(hdrs.size());
+  for (size_t i = 0; i < hdrs.size(); i++) {
+    mhdrs[i].msg_hdr = hdrs[i];
+    mhdrs[i].msg_len = 0;
+  }
+  int retval = sendmmsg(sock->fd(), mhdrs.data(), mhdrs.size(), flags);
+  if (retval == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      sock->setError(errno);
+    } else {
+      SOCKET_ERROR(sock, "unable to write to socket", errno);
+    }
+    return false;
+  }
+  return retval;
+#else
+  // No sendmmsg() on this platform; one sendmsg() per message with the same
+  // return convention.
+  int sent = 0;
+  for (auto& hdr : hdrs) {
+    if (sendmsg(sock->fd(), &hdr, flags) == -1) {
+      if (sent > 0) break;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        sock->setError(errno);
+      } else {
+        SOCKET_ERROR(sock, "unable to write to socket", errno);
+      }
+      return false;
+    }
+    ++sent;
+  }
+  return sent;
+#endif
+}
+
+Variant HHVM_FUNCTION(socket_recvmmsg,
+                      const Resource& socket,
+                      int count,
+                      int len,
+                      int flags /* = 0 */) {
+  if (count <= 0 || len <= 0) {
+    return false;
+  }
+  if (count > k_MMSG_MAX_BATCH) {
+    count = k_MMSG_MAX_BATCH;
+  }
+  auto sock = cast<Socket>(socket);
+
+  std::vector<String> bufs;
+  bufs.reserve(count);
+  std::vector<struct iovec> iovs(count);
+  std::vector<struct msghdr> hdrs(count);
+  for (int i = 0; i < count; i++) {
+    bufs.push_back(String(len, ReserveString));
+    iovs[i].iov_base = bufs[i].mutableData();
+    iovs[i].iov_len = len;
+    memset(&hdrs[i], 0, sizeof(hdrs[i]));
+    hdrs[i].msg_iov = &iovs[i];
+    hdrs[i].msg_iovlen = 1;
+  }
+
+#ifdef __linux__
+  std::vector<struct mmsghdr> mhdrs(count);
+  for (int i = 0; i < count; i++) {
+    mhdrs[i].msg_hdr = hdrs[i];
+    mhdrs[i].msg_len = 0;
+  }
+  // MSG_WAITFORONE: block for the first datagram only, then drain whatever
+  // else is already queued. MSG_DONTWAIT makes the whole call non-blocking.
+  int received = recvmmsg(sock->fd(), mhdrs.data(), count,
+                          flags | MSG_WAITFORONE, nullptr);
+  if (received == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      sock->setError(errno);
+    } else {
+      SOCKET_ERROR(sock, "unable to read from socket", errno);
+    }
+    return false;
+  }
+  PackedArrayInit ret(received);
+  for (int i = 0; i < received; i++) {
+    bufs[i].setSize(mhdrs[i].msg_len);
+    ret.append(bufs[i]);
+  }
+  return ret.toVariant();
+#else
+  // No recvmmsg() on this platform; block for the first datagram, then keep
+  // reading non-blocking until the queue is empty or the batch is full.
+  int received = 0;
+  for (int i = 0; i < count; i++) {
+    int rflags = (i == 0) ? flags : (flags | MSG_DONTWAIT);
+    ssize_t nbytes = recvmsg(sock->fd(), &hdrs[i], rflags);
+    if (nbytes == -1) {
+      if (received > 0) break;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        sock->setError(errno);
+      } else {
+        SOCKET_ERROR(sock, "unable to read from socket", errno);
+      }
+      return false;
+    }
+    bufs[i].setSize(nbytes);
+    ++received;
+  }
+  PackedArrayInit ret(received);
+  for (int i = 0; i < received; i++) {
+    ret.append(bufs[i]);
+  }
+  return ret.toVariant();
+#endif
+}
+
 bool HHVM_FUNCTION(socket_shutdown,
                    const Resource& socket,
                    int how /* = 0 */) {
@@ -1764,6 +1951,8 @@ struct SocketsExtension final : Extension {
     HHVM_FE(socket_sendto);
     HHVM_FE(socket_recv);
     HHVM_FE(socket_recvfrom);
+    HHVM_FE(socket_sendmmsg);
+    HHVM_FE(socket_recvmmsg);
     HHVM_FE(socket_shutdown);
     HHVM_FE(socket_close);
     HHVM_FE(socket_strerror);
@@ -117,6 +117,17 @@ Variant HHVM_FUNCTION(socket_recvfrom,
                       int flags,
                       VRefParam name,
                       VRefParam port = -1);
+Variant HHVM_FUNCTION(socket_sendmmsg,
+                      const Resource& socket,
+                      const Array& messages,
+                      int flags = 0,
+                      const String& addr = null_string,
+                      int port = -1);
+Variant HHVM_FUNCTION(socket_recvmmsg,
+                      const Resource& socket,
+                      int count,
+                      int len,
+                      int flags = 0);
 bool HHVM_FUNCTION(socket_shutdown,
                    const Resource& socket,
                    int how = 0);
@@ -555,6 +555,61 @@ function socket_recvfrom(resource $socket,
                          mixed &$name,
                          mixed &$port = -1): mixed;
 
+/**
+ * The socket_sendmmsg() function hands a whole batch of datagrams to the
+ *   kernel in a single sendmmsg(2) syscall. Each element of msgs is either a
+ *   string or an array of string segments; segments are gathered by the
+ *   kernel, so callers never have to concatenate. To await writability before
+ *   draining a batch, use stream_await() on the socket.
+ *
+ * @param resource $socket - A valid socket resource created using
+ *   socket_create().
+ * @param array $msgs - The datagrams to send. Each element is a string, or
+ *   an array of strings to be sent as the segments of one datagram.
+ * @param int $flags - The value of flags can be any combination of the
+ *   flags accepted by socket_send().
+ * @param string $addr - IP address of the remote host. May be omitted for
+ *   connected sockets.
+ * @param int $port - port is the remote port number at which the data will
+ *   be sent. Required when addr is given on AF_INET/AF_INET6 sockets.
+ *
+ * @return mixed - socket_sendmmsg() returns the number of messages sent,
+ *   which may be less than count(msgs), or FALSE if an error occurred before
+ *   any message was sent.
+ *
+ */
+<<__Native>>
+function socket_sendmmsg(resource $socket,
+                         array $msgs,
+                         int $flags = 0,
+                         string $addr = "",
+                         int $port = -1): mixed;
+
+/**
+ * The socket_recvmmsg() function receives up to count datagrams in a single
+ *   recvmmsg(2) syscall. It blocks until the first datagram arrives, then
+ *   drains whatever else is already queued; pass MSG_DONTWAIT to never
+ *   block. To await readability before draining, use stream_await() on the
+ *   socket.
+ *
+ * @param resource $socket - The socket must be a socket resource previously
+ *   created by socket_create().
+ * @param int $count - The maximum number of datagrams to receive.
+ * @param int $len - Up to len bytes will be fetched for each datagram.
+ * @param int $flags - The value of flags can be any combination of the
+ *   flags accepted by socket_recv().
+ *
+ * @return mixed - socket_recvmmsg() returns an array of the datagram
+ *   payloads received, or FALSE if there was an error. The actual error code
+ *   can be retrieved by calling socket_last_error().
+ *
+ */
+<<__Native>>
+function socket_recvmmsg(resource $socket,
+                         int $count,
+                         int $len,
+                         int $flags = 0): mixed;
+
 /**
  * The socket_shutdown() function allows you to stop incoming, outgoing or all
  *   data (the default) from being sent through the socket
@@ -57,6 +57,7 @@
 #include <folly/portability/SysFile.h>
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #ifndef _MSC_VER
 #include <glob.h>
@@ -695,15 +696,25 @@ Variant HHVM_FUNCTION(file_put_contents,
     case KindOfPersistentArray:
     case KindOfArray: {
       Array arr = data.toArray();
+      // Gather the chunks and hand them to the stream as one scatter-gather
+      // write.  The String vector keeps the chunk memory alive for the call.
+      std::vector<String> chunks;
+      std::vector<iovec> iov;
+      chunks.reserve(arr.size());
+      iov.reserve(arr.size());
       for (ArrayIter iter(arr); iter; ++iter) {
-        auto const value = iter.second().toString();
-        if (!value.empty()) {
-          numbytes += value.size();
-          int written = file->writeImpl(value.data(), value.size());
-          if (written != value.size()) {
-            numbytes = -1;
-            break;
-          }
+        auto value = iter.second().toString();
+        if (value.empty()) continue;
+        numbytes += value.size();
+        iov.emplace_back();
+        iov.back().iov_base = (void*)value.data();
+        iov.back().iov_len = value.size();
+        chunks.push_back(std::move(value));
+      }
+      if (!iov.empty()) {
+        int64_t written = file->writevImpl(iov.data(), iov.size());
+        if (written != numbytes) {
+          numbytes = -1;
         }
       }
       break;
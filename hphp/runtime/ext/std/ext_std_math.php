@@ -542,7 +542,7 @@ function sqrt(float $arg): float;
  * @return int - The largest possible random value returned by rand()
  *
  */
-<<__IsFoldable, __Native>>
+<<__IsFoldable, __Native("Leaf")>>
 function getrandmax(): int;
 
 /**
@@ -571,7 +571,7 @@ function rand(int $min = 0, ?int $max = null): int;
  * @return int - Returns the maximum random value returned by mt_rand()
  *
  */
-<<__IsFoldable, __Native>>
+<<__IsFoldable, __Native("Leaf")>>
 function mt_getrandmax(): int;
 
 /**
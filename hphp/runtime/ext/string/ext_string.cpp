@@ -48,6 +48,10 @@
 #include <folly/Unicode.h>
 #include <locale.h>
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 namespace HPHP {
 
 static Mutex s_mutex;
@@ -100,6 +104,45 @@ String stringForEachFast(const String& str, Op action) {
   return stringForEach<false>(str.size(), str, action);
 }
 
+#ifdef __x86_64__
+// In the C locale tolower/toupper map nothing but A-Z and a-z, so case
+// conversion reduces to a branchless range test. XORing 0x20 flips the
+// case either way; `base` selects the range being mapped ('A' lowers,
+// 'a' uppers). Bytes >= 0x80 compare as negative and fall outside both
+// ranges, so they pass through untouched, matching the scalar loop.
+template <char base> ALWAYS_INLINE
+String asciiCaseConv(const String& str) {
+  auto const len = str.size();
+  String ret(len, ReserveString);
+  auto const src = str.data();
+  auto const dst = ret.mutableData();
+
+  int i = 0;
+  auto const lo = _mm_set1_epi8(base - 1);
+  auto const hi = _mm_set1_epi8(base + 26);
+  for (; len - i >= 16; i += 16) {
+    auto chunk =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    auto const mask = _mm_and_si128(_mm_cmpgt_epi8(chunk, lo),
+                                    _mm_cmplt_epi8(chunk, hi));
+    chunk = _mm_xor_si128(chunk, _mm_and_si128(mask, _mm_set1_epi8(0x20)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), chunk);
+  }
+  for (; i < len; ++i) {
+    auto const c = static_cast<unsigned char>(src[i]);
+    dst[i] = static_cast<unsigned>(c - base) < 26 ? c ^ 0x20 : c;
+  }
+
+  ret.setSize(len);
+  return ret;
+}
+
+ALWAYS_INLINE bool ctypeIsCLocale() {
+  auto const loc = setlocale(LC_CTYPE, nullptr);
+  return loc && (!strcmp(loc, "C") || !strcmp(loc, "POSIX"));
+}
+#endif
+
 String HHVM_FUNCTION(addcslashes,
                      const String& str,
                      const String& charlist) {
@@ -421,11 +464,21 @@ String HHVM_FUNCTION(strrev,
 
 String HHVM_FUNCTION(strtolower,
                      const String& str) {
+#ifdef __x86_64__
+  if (str.size() >= 16 && ctypeIsCLocale()) {
+    return asciiCaseConv<'A'>(str);
+  }
+#endif
   return stringForEachFast(str, tolower);
 }
 
 String HHVM_FUNCTION(strtoupper,
                      const String& str) {
+#ifdef __x86_64__
+  if (str.size() >= 16 && ctypeIsCLocale()) {
+    return asciiCaseConv<'a'>(str);
+  }
+#endif
   return stringForEachFast(str, toupper);
 }
 
@@ -1055,6 +1055,34 @@ struct CompactReader {
     }
 
     uint64_t readVarint(void) {
+      // Fast path: decode directly from the transport buffer. Nearly all
+      // varints are one byte (field deltas, small sizes), and when the full
+      // 10-byte maximum is buffered the unrolled loop below never has to
+      // bounds-check or refill.
+      auto const avail = transport.buffered();
+      if (LIKELY(avail > 0)) {
+        auto const p = reinterpret_cast<const uint8_t*>(transport.peekBuffer());
+        if (LIKELY(!(p[0] & 0x80))) {
+          transport.advance(1);
+          return p[0];
+        }
+        if (LIKELY(avail >= 10)) {
+          uint64_t result = 0;
+          size_t len = 0;
+          uint8_t byte;
+          do {
+            byte = p[len];
+            result |= (uint64_t)(byte & 0x7f) << (7 * len);
+            ++len;
+          } while ((byte & 0x80) && len < 10);
+          if (UNLIKELY(byte & 0x80)) {
+            thrift_error("Variable-length int over 10 bytes", ERR_INVALID_DATA);
+          }
+          transport.advance(len);
+          return result;
+        }
+      }
+
       uint64_t result = 0;
       uint8_t shift = 0;
 
@@ -1079,6 +1107,15 @@ struct CompactReader {
       uint32_t size = readVarint();
 
       if (size && (size + 1)) {
+        if (LIKELY(size <= transport.buffered())) {
+          // The whole payload is already buffered: build the string straight
+          // from the buffer in a single copy. Adopting the slice without a
+          // copy would be unsafe: the transport buffer String is recycled on
+          // the next refill()/putBack().
+          String s = String(transport.peekBuffer(), size, CopyString);
+          transport.advance(size);
+          return s;
+        }
         String s = String(size, ReserveString);
         char* buf = s.mutableData();
 
@@ -239,11 +239,28 @@ struct PHPInputTransport {
   }
 
   int8_t readI8() {
+    if (LIKELY(buffer_used != 0)) {
+      int8_t c = *buffer_ptr;
+      ++buffer_ptr;
+      --buffer_used;
+      return c;
+    }
     int8_t c;
     readBytes(&c, 1);
     return c;
   }
 
+  // Expose the internal buffer so protocol decoders can consume buffered
+  // bytes in place instead of paying a readBytes() call per byte. Callers
+  // must not advance() past buffered().
+  const char* peekBuffer() const { return buffer_ptr; }
+  size_t buffered() const { return buffer_used; }
+  void advance(size_t len) {
+    assert(len <= buffer_used);
+    buffer_ptr += len;
+    buffer_used -= len;
+  }
+
   int16_t readI16() {
     int16_t c;
     readBytes(&c, 2);
@@ -46,6 +46,7 @@
 #include "hphp/runtime/base/builtin-functions.h"
 #include "hphp/runtime/base/execution-context.h"
 #include "hphp/runtime/base/program-functions.h"
+#include "hphp/runtime/base/runtime-option.h"
 #include "hphp/runtime/base/tv-refcount.h"
 #include "hphp/runtime/base/unit-cache.h"
 #include "hphp/runtime/ext/asio/asio-external-thread-event.h"
@@ -200,6 +201,30 @@ struct WatchmanThreadEventBase : folly::Executor {
 
 WatchmanThreadEventBase* WatchmanThreadEventBase::s_wmTEB{nullptr};
 
+// (ASYNC) Flag each changed file in a subscription update for the unit
+// cache, so it re-stats and reloads on its next use.  `sub_path' is the
+// root the subscription was established on, used when the update carries
+// no "root" of its own.  See Eval.WatchmanUnitInvalidation.
+void invalidateUnitsFromUpdate(
+  const folly::dynamic& data,
+  const std::string& sub_path
+) {
+  if (!RuntimeOption::EvalWatchmanUnitInvalidation) return;
+  auto const files = data.get_ptr("files");
+  if (!files || !files->isArray()) return;
+  auto const root_ptr = data.get_ptr("root");
+  auto const& root = root_ptr && root_ptr->isString()
+    ? root_ptr->getString()
+    : sub_path;
+  for (auto const& file : *files) {
+    // Entries are plain names or objects with a "name" field, depending on
+    // the fields the subscription query asked for.
+    auto const name = file.isObject() ? file.get_ptr("name") : &file;
+    if (!name || !name->isString()) continue;
+    invalidateCachedUnit(root + "/" + name->getString());
+  }
+}
+
 struct ActiveSubscription {
   // There should only be exaclty one instance of a given ActiveSubscription
   // and this should live in s_activeSubscriptions.
@@ -248,6 +273,7 @@ struct ActiveSubscription {
             error_data["connection_error"] = data.exception().what().c_str();
           m_unprocessedCallbackData.emplace_front(std::move(error_data));
         } else {
+          invalidateUnitsFromUpdate(*data, m_path);
           m_unprocessedCallbackData.emplace_front(std::move(*data));
         }
         // Existing callbacks will drain the data queue
@@ -257,6 +283,7 @@ struct ActiveSubscription {
       })
       .then([this](watchman::SubscriptionPtr wm_sub) { // (ASYNC)
         m_subscriptionPtr = wm_sub;
+        subscribeUnitInvalidation(m_path);
         return folly::unit;
       });
   }
@@ -277,6 +304,10 @@ struct ActiveSubscription {
         m_query, m_path, m_name, m_socketPath));
     }
 
+    // Once the watcher stops reporting for this root, the unit cache has to
+    // go back to stat()ing files under it.
+    unsubscribeUnitInvalidation(m_path);
+
     m_unprocessedCallbackData.clear();
     m_unsubcribeInProgress = true;
 
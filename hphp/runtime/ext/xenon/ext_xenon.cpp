@@ -271,10 +271,14 @@ Array XenonRequestLocalData::createResponse() {
   PackedArrayInit stacks(m_stackSnapshots.size());
   for (ArrayIter it(m_stackSnapshots); it; ++it) {
     const auto& frame = it.second().toArray();
+    // Compact snapshots store raw (Func*, offset) pairs; symbolize them now.
+    auto const bt = frame[s_stack].isResource()
+      ? cast<CompactTrace>(frame[s_stack].toResource())->extract()
+      : frame[s_stack].toArray();
     stacks.append(make_map_array(
       s_time, frame[s_time],
-      s_stack, frame[s_stack].toArray(),
-      s_phpStack, parsePhpStack(frame[s_stack].toArray()),
+      s_stack, bt,
+      s_phpStack, parsePhpStack(bt),
       s_isWait, frame[s_isWait]
     ));
   }
@@ -286,13 +290,41 @@ void XenonRequestLocalData::log(Xenon::SampleType t,
                                 c_WaitableWaitHandle* wh) {
   TRACE(1, "XenonRequestLocalData::log\n");
   time_t now = time(nullptr);
+  auto logDest = RuntimeOption::XenonStructLogDest;
+
+  if (RuntimeOption::XenonCompactStacks) {
+    // Fast mode: walk the ActRec chain recording raw (Func*, offset) pairs
+    // and defer symbolization until the data is actually pulled.  For the
+    // struct-log destination we symbolize here, but CompactTrace::extract
+    // caches symbolized stacks process-wide, so each distinct stack pays
+    // the full cost only once.  Compact samples carry no 86metadata.
+    auto ct = createCompactBacktrace(wh, t == Xenon::EnterSample);
+    if (!logDest.empty()) {
+      StructuredLogEntry cols;
+      cols.setStr("type", Xenon::show(t));
+      if (info) {
+        cols.setStr("info", info);
+      }
+      addBacktraceToStructLog(ct->extract(), cols);
+      StructuredLog::log(logDest, cols);
+    } else {
+      m_stackSnapshots.append(make_map_array(
+        s_time, now,
+        s_stack, Variant{std::move(ct)},
+        s_isWait, !Xenon::isCPUTime(t),
+        s_type, Xenon::show(t),
+        s_info, info ? info : ""
+      ));
+    }
+    return;
+  }
+
   auto bt = createBacktrace(BacktraceArgs()
                              .skipTop(t == Xenon::EnterSample)
                              .skipInlined(t == Xenon::EnterSample)
                              .fromWaitHandle(wh)
                              .withMetadata()
                              .ignoreArgs());
-  auto logDest = RuntimeOption::XenonStructLogDest;
   if (!logDest.empty()) {
     StructuredLogEntry cols;
     cols.setStr("type", Xenon::show(t));
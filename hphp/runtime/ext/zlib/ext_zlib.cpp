@@ -515,6 +515,194 @@ String HHVM_METHOD(ChunkedInflator,
   return data->inflateChunk(chunk);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Streaming deflate contexts
+
+const StaticString
+  s_level("level"),
+  s_memory("memory"),
+  s_strategy("strategy"),
+  s_dictionary("dictionary");
+
+struct DeflateContext : SweepableResourceData {
+  DeflateContext() {
+    memset(&m_stream, 0, sizeof(m_stream));
+    m_stream.zalloc = (alloc_func) hhvm_zlib_alloc;
+    m_stream.zfree = (free_func) hhvm_zlib_free;
+  }
+
+  ~DeflateContext() {
+    if (m_inited) {
+      deflateEnd(&m_stream);
+    }
+  }
+
+  bool isInvalid() const override {
+    return !m_inited;
+  }
+
+  CLASSNAME_IS("Deflate Context")
+  DECLARE_RESOURCE_ALLOCATION(DeflateContext)
+
+  // overriding ResourceData
+  const String& o_getClassNameHook() const override { return classnameof(); }
+
+  ::z_stream m_stream;
+  // Preset dictionary, re-applied when the stream is reset after a
+  // ZLIB_FINISH so the context stays primed for the next payload.
+  String m_dict;
+  bool m_inited{false};
+
+  // z_stream contains void* that we don't care about.
+  TYPE_SCAN_IGNORE_FIELD(m_stream);
+};
+
+IMPLEMENT_RESOURCE_ALLOCATION(DeflateContext)
+
+static req::ptr<DeflateContext> get_deflate_context(const Resource& context) {
+  auto ctx = dyn_cast_or_null<DeflateContext>(context);
+  if (!ctx || ctx->isInvalid()) {
+    raise_warning(
+      "supplied resource is not a valid Deflate Context resource");
+    return nullptr;
+  }
+  return ctx;
+}
+
+Variant HHVM_FUNCTION(deflate_init, int64_t encoding,
+                      const Array& options /* = null_array */) {
+  int64_t level = -1;
+  int64_t memory = MAX_MEM_LEVEL;
+  int64_t strategy = Z_DEFAULT_STRATEGY;
+  String dict;
+
+  if (options.exists(s_level)) {
+    level = options[s_level].toInt64();
+    if ((level < -1) || (level > 9)) {
+      raise_warning("compression level (%" PRId64 ") must be within -1..9",
+                    level);
+      return false;
+    }
+  }
+  if (options.exists(s_memory)) {
+    memory = options[s_memory].toInt64();
+    if ((memory < 1) || (memory > MAX_MEM_LEVEL)) {
+      raise_warning("compression memory level (%" PRId64 ") must be within "
+                    "1..%d", memory, MAX_MEM_LEVEL);
+      return false;
+    }
+  }
+  if (options.exists(s_strategy)) {
+    strategy = options[s_strategy].toInt64();
+    switch (strategy) {
+      case Z_FILTERED:
+      case Z_HUFFMAN_ONLY:
+      case Z_RLE:
+      case Z_FIXED:
+      case Z_DEFAULT_STRATEGY:
+        break;
+      default:
+        raise_warning("strategy must be one of ZLIB_FILTERED, "
+                      "ZLIB_HUFFMAN_ONLY, ZLIB_RLE, ZLIB_FIXED or "
+                      "ZLIB_DEFAULT_STRATEGY");
+        return false;
+    }
+  }
+  if (options.exists(s_dictionary)) {
+    dict = options[s_dictionary].toString();
+  }
+
+  switch (encoding) {
+    case k_ZLIB_ENCODING_RAW:
+    case k_ZLIB_ENCODING_GZIP:
+    case k_ZLIB_ENCODING_DEFLATE:
+      break;
+    default:
+      raise_warning("encoding mode must be either ZLIB_ENCODING_RAW, "
+                    "ZLIB_ENCODING_GZIP or ZLIB_ENCODING_DEFLATE");
+      return false;
+  }
+
+  auto ctx = req::make<DeflateContext>();
+  int status = deflateInit2(&ctx->m_stream, level, Z_DEFLATED, encoding,
+                            memory, strategy);
+  if (status != Z_OK) {
+    raise_warning("%s", zError(status));
+    return false;
+  }
+  ctx->m_inited = true;
+
+  if (!dict.empty()) {
+    status = deflateSetDictionary(&ctx->m_stream,
+                                  (const Bytef *) dict.data(), dict.size());
+    if (status != Z_OK) {
+      raise_warning("%s", zError(status));
+      return false;
+    }
+    ctx->m_dict = dict;
+  }
+
+  return Variant(std::move(ctx));
+}
+
+Variant HHVM_FUNCTION(deflate_add, const Resource& context,
+                      const String& data,
+                      int64_t flush_mode /* = Z_SYNC_FLUSH */) {
+  auto ctx = get_deflate_context(context);
+  if (!ctx) {
+    return false;
+  }
+
+  switch (flush_mode) {
+    case Z_NO_FLUSH:
+    case Z_PARTIAL_FLUSH:
+    case Z_SYNC_FLUSH:
+    case Z_FULL_FLUSH:
+    case Z_BLOCK:
+    case Z_FINISH:
+      break;
+    default:
+      raise_warning("flush mode must be one of ZLIB_NO_FLUSH, "
+                    "ZLIB_PARTIAL_FLUSH, ZLIB_SYNC_FLUSH, ZLIB_FULL_FLUSH, "
+                    "ZLIB_BLOCK or ZLIB_FINISH");
+      return false;
+  }
+
+  z_stream* Z = &ctx->m_stream;
+
+  /* deflateBound() covers a whole stream; pad for the flush marker and
+     gzip trailer so a single deflate() call always has room. */
+  size_t outlen = deflateBound(Z, data.size()) + 64;
+  String ret(outlen, ReserveString);
+
+  Z->next_in = (Bytef *) data.data();
+  Z->avail_in = data.size();
+  Z->next_out = (Bytef *) ret.mutableData();
+  Z->avail_out = outlen;
+
+  int status = deflate(Z, flush_mode);
+  /* Z_BUF_ERROR just means there was nothing to produce (e.g. empty
+     input with ZLIB_NO_FLUSH); the context is still healthy. */
+  if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+    raise_warning("%s", zError(status));
+    return false;
+  }
+  ret.setSize(outlen - Z->avail_out);
+
+  if (status == Z_STREAM_END) {
+    /* Keep the context reusable for the next payload: reset the stream
+       and re-prime the preset dictionary so small payloads keep their
+       ratio win. */
+    deflateReset(Z);
+    if (!ctx->m_dict.empty()) {
+      deflateSetDictionary(Z, (const Bytef *) ctx->m_dict.data(),
+                           ctx->m_dict.size());
+    }
+  }
+
+  return ret;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 struct ZlibExtension final : Extension {
@@ -530,6 +718,19 @@ struct ZlibExtension final : Extension {
     HHVM_RC_INT(FORCE_GZIP, k_FORCE_GZIP);
     HHVM_RC_INT(FORCE_DEFLATE, k_FORCE_DEFLATE);
 
+    HHVM_RC_INT(ZLIB_NO_FLUSH, Z_NO_FLUSH);
+    HHVM_RC_INT(ZLIB_PARTIAL_FLUSH, Z_PARTIAL_FLUSH);
+    HHVM_RC_INT(ZLIB_SYNC_FLUSH, Z_SYNC_FLUSH);
+    HHVM_RC_INT(ZLIB_FULL_FLUSH, Z_FULL_FLUSH);
+    HHVM_RC_INT(ZLIB_BLOCK, Z_BLOCK);
+    HHVM_RC_INT(ZLIB_FINISH, Z_FINISH);
+
+    HHVM_RC_INT(ZLIB_FILTERED, Z_FILTERED);
+    HHVM_RC_INT(ZLIB_HUFFMAN_ONLY, Z_HUFFMAN_ONLY);
+    HHVM_RC_INT(ZLIB_RLE, Z_RLE);
+    HHVM_RC_INT(ZLIB_FIXED, Z_FIXED);
+    HHVM_RC_INT(ZLIB_DEFAULT_STRATEGY, Z_DEFAULT_STRATEGY);
+
     HHVM_FE(zlib_encode);
     HHVM_FE(gzdeflate);
     HHVM_FE(gzcompress);
@@ -562,6 +763,9 @@ struct ZlibExtension final : Extension {
     HHVM_FE(nzcompress);
     HHVM_FE(nzuncompress);
 
+    HHVM_FE(deflate_init);
+    HHVM_FE(deflate_add);
+
     HHVM_NAMED_ME(__SystemLib\\ChunkedInflator, eof,
                   HHVM_MN(ChunkedInflator, eof));
     HHVM_NAMED_ME(__SystemLib\\ChunkedInflator, inflateChunk,
@@ -54,6 +54,11 @@ Variant HHVM_FUNCTION(qlzuncompress, const String& data, int level = 1);
 #endif
 Variant HHVM_FUNCTION(nzcompress, const String& uncompressed);
 Variant HHVM_FUNCTION(nzuncompress, const String& compressed);
+Variant HHVM_FUNCTION(deflate_init, int64_t encoding,
+                                    const Array& options = null_array);
+Variant HHVM_FUNCTION(deflate_add, const Resource& context,
+                                   const String& data,
+                                   int64_t flush_mode = 2 /* SYNC_FLUSH */);
 
 ///////////////////////////////////////////////////////////////////////////////
 // stream functions
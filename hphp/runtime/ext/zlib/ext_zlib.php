@@ -352,6 +352,44 @@ function nzcompress(string $uncompressed): mixed;
 <<__Native, __HipHopSpecific, __IsFoldable>>
 function nzuncompress(string $compressed): mixed;
 
+/**
+ * ( excerpt from http://php.net/manual/en/function.deflate-init.php )
+ *
+ * Initialize an incremental deflate context using the specified encoding.
+ * The context can be reused for many payloads, keeping the compression
+ * state (and any preset dictionary) warm between them.
+ *
+ * @param int $encoding - One of ZLIB_ENCODING_RAW, ZLIB_ENCODING_GZIP or
+ *   ZLIB_ENCODING_DEFLATE.
+ * @param array $options - An associative array which may contain 'level',
+ *   'memory', 'strategy' and 'dictionary'. The dictionary primes the
+ *   compression window, which improves ratios for small payloads that
+ *   resemble the supplied sample.
+ *
+ * @return resource - A deflate context resource, or FALSE on failure.
+ */
+<<__Native>>
+function deflate_init(int $encoding, array $options = []): mixed;
+
+/**
+ * ( excerpt from http://php.net/manual/en/function.deflate-add.php )
+ *
+ * Incrementally deflate data in the given context.
+ *
+ * @param resource $context - A context created with deflate_init().
+ * @param string $data - A chunk of data to compress.
+ * @param int $flush_mode - One of ZLIB_BLOCK, ZLIB_NO_FLUSH,
+ *   ZLIB_PARTIAL_FLUSH, ZLIB_SYNC_FLUSH (default), ZLIB_FULL_FLUSH or
+ *   ZLIB_FINISH. After ZLIB_FINISH the context can be reused for a new
+ *   stream.
+ *
+ * @return string - A chunk of compressed data, or FALSE on failure.
+ */
+<<__Native>>
+function deflate_add(resource $context,
+                     string $data,
+                     int $flush_mode = ZLIB_SYNC_FLUSH): mixed;
+
 /**
  * Implementation detail for zlib.inflate stream filter.
  *
@@ -32,6 +32,7 @@
 #include "hphp/runtime/server/server-note.h"
 #include "hphp/runtime/server/server-stats.h"
 #include "hphp/runtime/server/request-uri.h"
+#include "hphp/util/async-log-writer.h"
 #include "hphp/util/process.h"
 #include "hphp/util/atomic.h"
 #include "hphp/util/compatibility.h"
@@ -158,6 +159,9 @@ void AccessLog::onNewRequest() {
 
 void AccessLog::flushAllWriters() {
   if (!m_initialized) return;
+  if (AsyncLogWriter::Enabled) {
+    AsyncLogWriter::Get()->flush();
+  }
   m_defaultWriter->flush();
   for (auto& file : m_files) file->flush();
 }
@@ -173,6 +177,47 @@ void AccessLog::clearThreadLog() {
   threadLog = nullptr;
 }
 
+void LogWriter::openFiles(const AccessLogFileData& logdata,
+                          const std::string& username) {
+  if (m_channel == LogChannel::CRONOLOG) {
+    assert(!logdata.file.empty());
+    m_cronolog = std::make_unique<Cronolog>();
+    if (logdata.file.find('%') != std::string::npos) {
+      m_cronolog->m_template = logdata.file;
+      m_cronolog->setPeriodicity();
+      if (logdata.periodMultiplier) {
+        m_cronolog->m_periodMultiple = logdata.periodMultiplier;
+      }
+
+      m_cronolog->m_linkName = logdata.symLink;
+      Cronolog::changeOwner(username, logdata.symLink);
+    } else {
+      m_cronolog->m_file = fopen(logdata.file.c_str(), "a");
+    }
+  } else if (m_channel == LogChannel::REGULAR) {
+    assert(!logdata.file.empty());
+    if (logdata.file[0] == '|') {
+      std::string plog = logdata.file.substr(1);
+      m_filelog = popen(plog.c_str(), "w");
+    } else {
+      m_filelog = fopen(logdata.file.c_str(), "a");
+    }
+    if (!m_filelog) {
+      Logger::Error("Couldn't open access log file %s", logdata.file.c_str());
+    }
+  }
+}
+
+void LogWriter::closeFiles(const AccessLogFileData& logdata) {
+  if (m_channel == LogChannel::REGULAR) {
+    if (logdata.file[0] == '|') {
+      pclose(m_filelog);
+    } else {
+      fclose(m_filelog);
+    }
+  }
+}
+
 FILE* LogWriter::getOutputFile() const {
   FILE* outfile = nullptr;
   switch (m_channel) {
@@ -105,6 +105,11 @@ protected:
 protected:
   FILE* getOutputFile() const;
   void recordWriteAndMaybeDropCaches(FILE* out, int bytes);
+  // Open (or close) this writer's output according to its channel: a
+  // Cronolog for CRONOLOG, a file or pipe for REGULAR, nothing for
+  // THREADLOCAL. Shared by the concrete writers' init()/destructors.
+  void openFiles(const AccessLogFileData& logdata, const std::string& username);
+  void closeFiles(const AccessLogFileData& logdata);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
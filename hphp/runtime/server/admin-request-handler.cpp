@@ -32,10 +32,13 @@
 #include "hphp/runtime/base/thread-hooks.h"
 #include "hphp/runtime/base/unit-cache.h"
 
+#include "hphp/runtime/vm/cpu-profile.h"
 #include "hphp/runtime/vm/jit/cg-meta.h"
+#include "hphp/runtime/vm/jit/compile-time-profile.h"
 #include "hphp/runtime/vm/jit/fixup.h"
 #include "hphp/runtime/vm/debug/debug.h"
 #include "hphp/runtime/vm/jit/mcgen.h"
+#include "hphp/runtime/vm/jit/perf-jit-profile.h"
 #include "hphp/runtime/vm/jit/prof-data.h"
 #include "hphp/runtime/vm/jit/relocation.h"
 #include "hphp/runtime/vm/jit/tc.h"
@@ -45,6 +48,7 @@
 #include "hphp/runtime/vm/type-profile.h"
 
 #include "hphp/runtime/ext/apc/ext_apc.h"
+#include "hphp/runtime/ext/curl/curl-pool.h"
 #include "hphp/runtime/ext/json/ext_json.h"
 #include "hphp/runtime/ext/xenon/ext_xenon.h"
 
@@ -54,13 +58,16 @@
 #include "hphp/runtime/server/pagelet-server.h"
 #include "hphp/runtime/server/rpc-request-handler.h"
 #include "hphp/runtime/server/server-stats.h"
+#include "hphp/runtime/server/writer.h"
 
 #include "hphp/util/alloc.h"
 #include "hphp/util/hphp-config.h"
+#include "hphp/util/lock.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/managed-arena.h"
 #include "hphp/util/mutex.h"
 #include "hphp/util/process.h"
+#include "hphp/util/ringbuffer.h"
 #include "hphp/util/build-info.h"
 #include "hphp/util/service-data.h"
 #include "hphp/util/stacktrace-profiler.h"
@@ -262,6 +269,9 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
         "/free-mem:        ask allocator to release unused memory to system\n"
         "/prepare-to-stop: ask the server to prepare for stopping\n"
         "/flush-logs:      trigger batching log-writers to flush all content\n"
+        "/reload-tls-ticket-seeds:\n"
+        "                  re-read the TLS session ticket seed file and\n"
+        "                  apply it to the running acceptors\n"
         "/translate:       translate hex encoded stacktrace in 'stack' param\n"
         "    stack         required, stack trace to translate\n"
         "    build-id      optional, if specified, build ID has to match\n"
@@ -312,6 +322,8 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
         "    keys          optional, <key>,<key/hit>,<key/sec>,<:regex:>\n"
         "    url           optional, only stats of this page or URL\n"
         "    code          optional, only stats of pages returning this code\n"
+        "/stats.snapshot:  relaxed-consistency total of all keys in JSON;\n"
+        "                  collection never blocks request threads\n"
 
         "/xenon-snap:      generate a Xenon snapshot, which is logged later\n"
         "/hugepage:        show stats about hugepage usage\n"
@@ -330,9 +342,14 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
         "/random-apc:      dump the key and size of a random APC entry\n"
         "    count         number of entries to return\n"
 
+        "/curl-pools:      JSON utilization stats for the named curl\n"
+        "                  connection pools\n"
         "/pcre-cache-size: get pcre cache map size\n"
         "/dump-pcre-cache: dump cached pcre's to /tmp/pcre_cache\n"
         "/dump-array-info: dump array tracer info to /tmp/array_tracer_dump\n"
+        "/dump-trace-rings: dump structured trace rings to /tmp/trace_rings;\n"
+        "                  decode with hphp/tools/trace-ring-decode.py\n"
+        "    file          absolute path to dump to\n"
 
         "/start-stacktrace-profiler: set enable_stacktrace_profiler to true\n"
         "/relocate:        relocate translations\n"
@@ -353,11 +370,32 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
 #ifdef EXECUTION_PROFILER
         "/prof-exe:        returns sampled execution profile\n"
 #endif
+        "/prof-alloc-on:   turn on sampling allocation profiler\n"
+        "    rate          optional, sample every this many bytes\n"
+        "                  allocated (default: 524288)\n"
+        "/prof-alloc-off:  turn off sampling allocation profiler\n"
+        "/prof-alloc:      dump allocation samples, aggregated by\n"
+        "                  function and size class\n"
+        "    clear         optional, clear accumulated samples\n"
+        "/prof-cpu-sample-on:\n"
+        "                  start SIGPROF PHP-level CPU sampling\n"
+        "    hz            optional, samples per second (default: 100)\n"
+        "/prof-cpu-sample-off:\n"
+        "                  stop SIGPROF CPU sampling\n"
+        "/prof-cpu-sample: dump CPU samples, aggregated by function\n"
+        "                  and line\n"
+        "    clear         optional, clear accumulated samples\n"
         "/vm-tcspace:      show space used by translator caches\n"
         "/vm-tcaddr:       show addresses of translation cache sections\n"
+        "/vm-tcsamples:    show hardware-event samples attributed to\n"
+        "                  translations, aggregated by function\n"
         "/vm-dump-tc:      dump translation cache to /tmp/tc_dump_a and\n"
         "                  /tmp/tc_dump_astub\n"
+        "/vm-jittime:      show per-translation compile-time profile\n"
+        "                  (requires Eval.JitTimeProfile and Eval.JitTimer)\n"
+        "    clear         optional, discard the recorded profile\n"
         "/vm-namedentities:show size of the NamedEntityTable\n"
+        "/vm-unit-cache:   show memory held by each cached unit\n"
         "/thread-mem:      show memory usage per thread\n"
         "/proxy:           set up request proxy\n"
         "    origin        URL to proxy requests to\n"
@@ -521,6 +559,14 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
       RPCRequestHandler::GetAccessLog().flushAllWriters();
       break;
     }
+    if (cmd == "reload-tls-ticket-seeds") {
+      if (HttpServer::Server->getPageServer()->reloadTLSTicketSeeds()) {
+        transport->sendString("OK\n");
+      } else {
+        transport->sendString("Failed to reload TLS ticket seeds\n", 500);
+      }
+      break;
+    }
     if (cmd == "set-log-level") {
       string result("OK\n");
       string level = transport->getParam("level");
@@ -656,6 +702,31 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
       break;
     }
 
+    if (cmd == "curl-pools") {
+      std::ostringstream out;
+      out << "{" << endl;
+      {
+        ReadLock lock(CurlHandlePool::namedPoolsMutex);
+        auto first = true;
+        for (auto const& it : CurlHandlePool::namedPools) {
+          if (!first) out << "," << endl;
+          first = false;
+          auto const& pool = it.second;
+          out << "  \"" << it.first << "\": {"
+              << "\"size\":" << pool->size()
+              << ", \"available\":" << pool->available()
+              << ", \"reuseLimit\":" << pool->reuseLimit()
+              << ", \"fetches\":" << pool->statsFetches()
+              << ", \"empty\":" << pool->statsEmpty()
+              << ", \"fetchMs\":" << pool->statsFetchUs() / 1000
+              << "}";
+        }
+      }
+      out << endl << "}" << endl;
+      transport->sendString(out.str());
+      break;
+    }
+
     if (cmd == "pcre-cache-size") {
       std::ostringstream size;
       size << preg_pcre_cache_size() << endl;
@@ -671,6 +742,17 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
       break;
     }
 
+    if (cmd == "dump-trace-rings") {
+      auto filename = transport->getParam("file");
+      if (filename == "") filename = "/tmp/trace_rings";
+      if (Trace::dumpStructuredRingbuffers(filename.c_str())) {
+        transport->sendString("OK\n");
+      } else {
+        transport->sendString("Error dumping trace rings\n");
+      }
+      break;
+    }
+
     if (cmd == "start-stacktrace-profiler") {
       enable_stacktrace_profiler = true;
       transport->sendString("OK\n");
@@ -1193,6 +1275,13 @@ bool AdminRequestHandler::handleStatsRequest(const std::string &cmd,
   if (cmd == "stats.kvp") {
     return send_report(transport);
   }
+  if (cmd == "stats.snapshot") {
+    string out;
+    ServerStats::ReportSnapshot(out);
+    transport->replaceHeader("Content-Type", "application/json");
+    transport->sendString(out);
+    return true;
+  }
 
   if (cmd == "stats.xsl") {
     string xsl;
@@ -1235,6 +1324,91 @@ bool AdminRequestHandler::handleProfileRequest(const std::string &cmd,
 
     return true;
   }
+  if (cmd == "prof-alloc-on") {
+    auto rate = transport->getInt64Param("rate");
+    if (rate <= 0) rate = 512 * 1024;
+    MemoryManager::setAllocSamplingInterval(rate);
+    transport->sendString("OK\n");
+    return true;
+  }
+  if (cmd == "prof-alloc-off") {
+    MemoryManager::setAllocSamplingInterval(0);
+    transport->sendString("OK\n");
+    return true;
+  }
+  if (cmd == "prof-alloc") {
+    auto rows = MemoryManager::getAllocSamples();
+    std::sort(rows.begin(), rows.end(),
+              [] (const MemoryManager::AllocSampleRow& a,
+                  const MemoryManager::AllocSampleRow& b) {
+                return a.bytes > b.bytes;
+              });
+    std::ostringstream out;
+    out << "{" << endl;
+    out << "\"interval\":" << MemoryManager::allocSamplingInterval()
+        << "," << endl;
+    out << "\"samples\":[" << endl;
+    auto first = true;
+    for (auto const& row : rows) {
+      if (!first) out << "," << endl;
+      first = false;
+      out << "{\"function\":" << Writer::escape_for_json(row.func.c_str())
+          << ",\"size_class\":" << row.sizeClass << ","
+          << "\"samples\":" << row.samples << ","
+          << "\"sampled_bytes\":" << row.bytes << "}";
+    }
+    out << endl << "]" << endl << "}" << endl;
+    if (transport->getParam("clear") == "1") {
+      MemoryManager::clearAllocSamples();
+    }
+    transport->sendString(out.str());
+    return true;
+  }
+  if (cmd == "prof-cpu-sample-on") {
+    auto hz = transport->getInt64Param("hz");
+    if (hz <= 0) hz = 100;
+    if (CpuProfiler::start(hz)) {
+      transport->sendString("OK\n");
+    } else {
+      transport->sendString("Unable to start CPU sampling.\n");
+    }
+    return true;
+  }
+  if (cmd == "prof-cpu-sample-off") {
+    CpuProfiler::stop();
+    transport->sendString("OK\n");
+    return true;
+  }
+  if (cmd == "prof-cpu-sample") {
+    uint64_t native = 0;
+    auto rows = CpuProfiler::getSamples(native);
+    std::sort(rows.begin(), rows.end(),
+              [] (const CpuProfiler::Row& a, const CpuProfiler::Row& b) {
+                return a.self > b.self;
+              });
+    std::ostringstream out;
+    out << "{" << endl;
+    out << "\"hz\":" << CpuProfiler::frequency() << "," << endl;
+    out << "\"total\":" << CpuProfiler::totalSamples() << "," << endl;
+    out << "\"native\":" << native << "," << endl;
+    out << "\"samples\":[" << endl;
+    auto first = true;
+    for (auto const& row : rows) {
+      if (!first) out << "," << endl;
+      first = false;
+      out << "{\"function\":" << Writer::escape_for_json(row.function.c_str())
+          << ",\"file\":" << Writer::escape_for_json(row.file.c_str())
+          << ",\"line\":" << row.line << ","
+          << "\"self\":" << row.self << ","
+          << "\"inclusive\":" << row.inclusive << "}";
+    }
+    out << endl << "]" << endl << "}" << endl;
+    if (transport->getParam("clear") == "1") {
+      CpuProfiler::clearSamples();
+    }
+    transport->sendString(out.str());
+    return true;
+  }
 #ifdef GOOGLE_CPU_PROFILER
   if (handleCPUProfilerRequest(cmd, transport)) {
     return true;
@@ -1366,12 +1540,25 @@ bool AdminRequestHandler::handleVMRequest(const std::string &cmd,
     transport->sendString(jit::tc::getTCAddrs());
     return true;
   }
+  if (cmd == "vm-tcsamples") {
+    transport->sendString(jit::showPerfJitProfile());
+    return true;
+  }
   if (cmd == "vm-namedentities") {
     std::ostringstream result;
     result << NamedEntity::tableSize();
     transport->sendString(result.str());
     return true;
   }
+  if (cmd == "vm-unit-cache") {
+    transport->sendString(getUnitCacheMemoryReport());
+    return true;
+  }
+  if (cmd == "vm-jittime") {
+    auto const clear = !transport->getParam("clear").empty();
+    transport->sendString(jit::showCompileTimeProfile(clear));
+    return true;
+  }
   if (cmd == "vm-dump-tc") {
     if (jit::tc::dump()) {
       transport->sendString("Done");
@@ -84,14 +84,16 @@ system operations.
 
 == Monitor thread
 
-The CLIWorker will spawn a special monitor thread just prior to starting
-the request. This thread will poll() the unix socket and wait for flags that
-indicate the client has hung-up, the socket is in an error state, or the
-file-descriptor is no longer valid. At this point it will set the TimedOutFlag
-on the request and terminate. This ensure that if the client hangs up (by ^C
-for instance), the server does not continue spinning, and promptly releases the
-clients I/O file descriptors (which may remain open if the underlying terminal
-is still active).
+A single monitor thread, shared by all workers, poll()s the unix sockets of
+every in-flight request and waits for flags that indicate a client has
+hung-up, a socket is in an error state, or a file-descriptor is no longer
+valid. At that point it sets the TimedOutFlag on the affected request. This
+ensures that if a client hangs up (by ^C for instance), the server does not
+continue spinning, and promptly releases the client's I/O file descriptors
+(which may remain open if the underlying terminal is still active). Workers
+register their socket with the monitor just prior to starting the request
+and unregister when it completes; multiplexing all of them onto one thread
+avoids a thread spawn and join per invocation.
 
 == CLIWrapper
 
@@ -163,6 +165,9 @@ way to determine how much progress the server made.
 #include <pwd.h>
 #include <utime.h>
 
+#include <algorithm>
+#include <mutex>
+
 TRACE_SET_MOD(clisrv);
 
 namespace HPHP {
@@ -209,6 +214,22 @@ void cli_write_fd(int afdt_fd, int fd) {
   }
 }
 
+void cli_read_fds(int afdt_fd, int* fds, unsigned count) {
+  FTRACE(4, "cli_read_fds({}, {})\n", afdt_fd, count);
+  if (!afdt::recv_fds(afdt_fd, fds, count)) {
+    throw Exception("Failed in afdt::recv_fds: %s",
+                    folly::errnoStr(errno).c_str());
+  }
+}
+
+void cli_write_fds(int afdt_fd, const int* fds, unsigned count) {
+  FTRACE(4, "cli_write_fds({}, {})\n", afdt_fd, count);
+  if (!afdt::send_fds(afdt_fd, fds, count)) {
+    throw Exception("Failed in afdt::send_fds: %s",
+                    folly::errnoStr(errno).c_str());
+  }
+}
+
 #ifdef SCM_CREDENTIALS
 
 template<class F, class R = typename std::result_of<F(msghdr*)>::type>
@@ -791,10 +812,9 @@ Array init_cli_globals(int argc, char** argv, int xhprof, Array& ini,
 }
 
 struct RemoteFile final {
-  explicit RemoteFile(int client, const char* name, const char* mode) {
-    fd =  cli_read_fd(client);
+  RemoteFile(int fd, const char* name, const char* mode) : fd(fd) {
     file = fdopen(fd, mode);
-    FTRACE(2, "CLIWorker::doJob({}): {} = {}\n", client, name, fd);
+    FTRACE(2, "CLIWorker::doJob: {} = {}\n", name, fd);
   }
   ~RemoteFile() { if (file) fclose(file); }
 
@@ -802,72 +822,128 @@ struct RemoteFile final {
   int fd{-1};
 };
 
-struct MonitorThread final {
-  explicit MonitorThread(int client);
-  ~MonitorThread() {
-    if (m_monitor.joinable()) {
-      write(m_wpipe, "stop", 5);
-      m_monitor.join();
+/*
+ * A single thread that poll()s the sockets of every in-flight request,
+ * instead of spawning (and joining) a monitor thread per request. When a
+ * client hangs up the monitor sets the TimedOutFlag on the request.
+ */
+struct CLIMonitor final {
+  static CLIMonitor& get() {
+    static CLIMonitor inst;
+    return inst;
+  }
+
+  void add(int client, std::atomic<size_t>* flags) {
+    {
+      std::lock_guard<std::mutex> g(m_lock);
+      m_watch.emplace_back(client, flags);
+    }
+    wake();
+  }
+
+  void remove(int client) {
+    {
+      std::lock_guard<std::mutex> g(m_lock);
+      m_watch.erase(
+        std::remove_if(m_watch.begin(), m_watch.end(),
+                       [&] (const Entry& e) { return e.first == client; }),
+        m_watch.end());
     }
+    wake();
   }
 
 private:
-  int m_wpipe{-1};
-  std::thread m_monitor;
-};
+  using Entry = std::pair<int, std::atomic<size_t>*>;
 
-MonitorThread::MonitorThread(int client) {
-  int monitor_pipe[2];
-  if (pipe(monitor_pipe) == -1) {
-    throw Exception("Unable to construct pipe for monitor: %s",
-                    folly::errnoStr(errno).c_str());
+  CLIMonitor() {
+    int monitor_pipe[2];
+    if (pipe(monitor_pipe) == -1) {
+      throw Exception("Unable to construct pipe for monitor: %s",
+                      folly::errnoStr(errno).c_str());
+    }
+    m_rpipe = monitor_pipe[0];
+    m_wpipe = monitor_pipe[1];
+
+    // Detached: the thread only touches CLIMonitor state, and the
+    // (leaked) singleton is needed for as long as the process can serve
+    // CLI requests.
+    std::thread([this] { loop(); }).detach();
   }
 
-  int rpipe = monitor_pipe[0];
-  int wpipe = monitor_pipe[1];
-  auto flags = &stackLimitAndSurprise();
-  try {
-    m_monitor = std::thread([wpipe,rpipe,client,flags] {
-      SCOPE_EXIT {
-        close(rpipe);
-        close(wpipe);
-      };
-      int ret = 0;
-      pollfd pfd[] = {{client, 0, 0}, {rpipe, POLLIN, 0}};
-      while ((ret = poll(pfd, 2, -1)) != -1) {
-        if (ret == 0) continue;
-        if (pfd[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
-          FTRACE(2, "CLIWorker::doJob({}): observed socket reset in monitor\n",
-                 client);
-          Logger::Info("CLIWorker::doJob(%i): monitor thread aborting request",
-                       client);
-          break;
-        }
-        if (pfd[1].revents) {
-          FTRACE(2, "CLIWorker::doJob({}): monitor got request completed\n",
-                 client);
-          return;
+  void wake() { write(m_wpipe, "", 1); }
+
+  // Flag the request on fd, but only if (fd, flags) is still being
+  // watched: the worker unregisters before closing the socket, so a
+  // stale event observed after the fd was closed (and possibly reused)
+  // is dropped here rather than aborting an unrelated request.
+  void flagIfWatched(int fd, std::atomic<size_t>* flags) {
+    std::lock_guard<std::mutex> g(m_lock);
+    for (auto it = m_watch.begin(); it != m_watch.end(); ++it) {
+      if (it->first == fd && it->second == flags) {
+        FTRACE(2, "CLIMonitor: observed socket reset on {}\n", fd);
+        Logger::Info("CLI server monitor aborting request on socket %i", fd);
+        flags->fetch_or(TimedOutFlag);
+        m_watch.erase(it);
+        return;
+      }
+    }
+  }
+
+  void loop() {
+    std::vector<pollfd> pfds;
+    std::vector<std::atomic<size_t>*> flags;
+    for (;;) {
+      pfds.clear();
+      flags.clear();
+      pfds.push_back({m_rpipe, POLLIN, 0});
+      flags.push_back(nullptr);
+      {
+        std::lock_guard<std::mutex> g(m_lock);
+        for (auto& e : m_watch) {
+          // POLLHUP/POLLERR/POLLNVAL are always reported; we don't care
+          // about readability of the client socket here.
+          pfds.push_back({e.first, 0, 0});
+          flags.push_back(e.second);
         }
       }
+
+      int ret = poll(&pfds[0], pfds.size(), -1);
       if (ret == -1) {
-        Logger::Warning("CLIWorker::doJob(%i): monitor thread terminated: %s",
-                        client, folly::errnoStr(errno).c_str());
-        FTRACE(2, "CLIWorker::doJob({}): got error in monitor thread: {}",
-               client, folly::errnoStr(errno));
+        if (errno == EINTR) continue;
+        Logger::Warning("CLI server monitor: poll failed: %s",
+                        folly::errnoStr(errno).c_str());
         return;
       }
+      if (ret == 0) continue;
 
-      flags->fetch_or(TimedOutFlag);
-      FTRACE(2, "CLIWorker::doJob({}): monitor exiting...\n", client);
-    });
-  } catch (const std::system_error& err) {
-    close(rpipe);
-    close(wpipe);
-    throw Exception("Could not start monitor thread: %s", err.what());
+      if (pfds[0].revents & POLLIN) {
+        char buf[64];
+        read(m_rpipe, buf, sizeof(buf));
+      }
+      for (size_t i = 1; i < pfds.size(); ++i) {
+        if (pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+          flagIfWatched(pfds[i].fd, flags[i]);
+        }
+      }
+    }
   }
 
-  m_wpipe = wpipe;
-}
+  int m_rpipe{-1};
+  int m_wpipe{-1};
+  std::mutex m_lock;
+  std::vector<Entry> m_watch; // guarded by m_lock
+};
+
+// Registers the request with the shared monitor for the current scope.
+struct MonitorGuard final {
+  explicit MonitorGuard(int client) : m_client(client) {
+    CLIMonitor::get().add(client, &stackLimitAndSurprise());
+  }
+  ~MonitorGuard() { CLIMonitor::get().remove(m_client); }
+
+private:
+  int m_client;
+};
 
 void CLIWorker::doJob(int client) {
   FTRACE(1, "CLIWorker::doJob({}): starting job...\n", client);
@@ -880,7 +956,10 @@ void CLIWorker::doJob(int client) {
     std::string magic;
     cli_read(client, magic);
     FTRACE(2, "CLIWorker::doJob({}): magic = {}\n", client, magic);
-    if (magic != "hello_server") {
+    // v2 clients batch their descriptors into a single message; the
+    // original protocol sent them one message each.
+    bool const batchedFds = magic == "hello_server_v2";
+    if (magic != "hello_server" && !batchedFds) {
       throw Exception("Got bad magic from client: %s", magic.c_str());
     }
 
@@ -891,10 +970,17 @@ void CLIWorker::doJob(int client) {
     std::string iniSettings;
     cli_read(client, iniSettings);
 
-    RemoteFile cli_in(client, "stdin", "r");
-    RemoteFile cli_out(client, "stdout", "w");
-    RemoteFile cli_err(client, "stderr", "w");
-    RemoteFile cli_afdt(client, "afdt", "rw");
+    int fds[4];
+    if (batchedFds) {
+      cli_read_fds(client, fds, 4);
+    } else {
+      for (auto& fd : fds) fd = cli_read_fd(client);
+    }
+
+    RemoteFile cli_in(fds[0], "stdin", "r");
+    RemoteFile cli_out(fds[1], "stdout", "w");
+    RemoteFile cli_err(fds[2], "stderr", "w");
+    RemoteFile cli_afdt(fds[3], "afdt", "rw");
 
     int xhprofFlags;
     std::vector<std::string> args;
@@ -965,7 +1051,7 @@ void CLIWorker::doJob(int client) {
       RID().setSafeFileAccess(false);
       define_stdio_constants();
 
-      MonitorThread monitor(client);
+      MonitorGuard monitor(client);
       FTRACE(1, "CLIWorker::doJob({}): invoking {}...\n", client, args[0]);
       if (hphp_invoke_simple(args[0], false /* warmup only */)) {
         ret = ExitException::ExitCode;
@@ -1559,7 +1645,7 @@ void run_command_on_cli_server(const char* sock_path,
 
   try {
     cli_write_ucred(fd);
-    cli_write(fd, "hello_server");
+    cli_write(fd, "hello_server_v2");
 
     char cwd[PATH_MAX];
     getcwd(cwd, PATH_MAX);
@@ -1575,10 +1661,8 @@ void run_command_on_cli_server(const char* sock_path,
 
     FTRACE(2, "run_command_on_cli_server(): sending fds...\n", fd);
 
-    cli_write_fd(fd, fileno(stdin));
-    cli_write_fd(fd, fileno(stdout));
-    cli_write_fd(fd, fileno(stderr));
-    cli_write_fd(fd, delegate);
+    int fds[] = { fileno(stdin), fileno(stdout), fileno(stderr), delegate };
+    cli_write_fds(fd, fds, 4);
 
     FTRACE(2, "run_command_on_cli_server(): file/args...\n", fd);
     cli_write(fd, 0, args, env_vec);
@@ -205,6 +205,7 @@ void FastCGISession::notifyPendingShutdown() {
 
 void FastCGISession::closeWhenIdle() {
   if (!m_requestId) {
+    flushWrites();     // Hand off any corked management records first
     m_sock->close();   // Flush any pending writes and close, calling close()
                        // will immediately call readEOF and prevent any further
                        // attempts to write data.
@@ -410,6 +411,11 @@ void FastCGISession::ioStop() noexcept {
 void FastCGISession::shutdown() noexcept {
   DestructorGuard dg(this); // close() may call destroy()
 
+  // Hand off anything still corked (e.g. the END_REQUEST for the request
+  // that just completed) before we mark ourselves down; close() below only
+  // flushes writes the socket already owns.
+  flushWrites();
+
   m_shutdown = true;
   m_keepConn = false;
 
@@ -430,6 +436,29 @@ void FastCGISession::enqueueWrite(std::unique_ptr<IOBuf> chain) {
     // socket that has been closed will leave it in a very bad state.
     return;
   }
+  // Cork the record rather than writing it out immediately; every record
+  // enqueued before the end of this event-loop iteration goes to the socket
+  // in one vectored write.
+  m_writeBuf.append(std::move(chain));
+  if (!isLoopCallbackScheduled()) {
+    m_eventBase->runInLoop(this);
+  }
+}
+
+void FastCGISession::runLoopCallback() noexcept {
+  flushWrites();
+}
+
+void FastCGISession::flushWrites() {
+  if (isLoopCallbackScheduled()) {
+    cancelLoopCallback();
+  }
+  auto chain = m_writeBuf.move();
+  if (!chain || m_shutdown || !m_sock->good()) {
+    // Corked data is discarded on error paths, matching the old behavior of
+    // refusing to write once we start shutting down.
+    return;
+  }
   ++m_eventCount;
   m_sock->writeChain(this, std::move(chain));
 }
@@ -25,6 +25,7 @@
 #include <folly/io/IOBuf.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventBase.h>
 #include <wangle/acceptor/ManagedConnection.h>
 
 namespace HPHP {
@@ -179,6 +180,7 @@ struct FastCGISession
   : public  wangle::ManagedConnection
   , private folly::AsyncTransportWrapper::ReadCallback
   , private folly::AsyncTransportWrapper::WriteCallback
+  , private folly::EventBase::LoopCallback
 {
   FastCGISession(
     folly::EventBase* evBase,
@@ -214,6 +216,9 @@ private:
   void writeErr(size_t, const folly::AsyncSocketException&) noexcept override;
   void writeSuccess() noexcept override;
 
+  // Loop callback; flushes writes corked during this event-loop iteration
+  void runLoopCallback() noexcept override;
+
 public:
   // Callbacks to send data back to webserver for FastCGITransport. Ideally
   // these would also be private but the transport needs access to them.
@@ -248,9 +253,16 @@ private:
   // pending
   void shutdown() noexcept;
 
-  // Send data to socket
+  // Cork a record for the socket. All records enqueued during one event-loop
+  // iteration (e.g. a run of stdout chunks plus the END_REQUEST) are flushed
+  // as a single vectored write rather than one syscall per record.
   void enqueueWrite(std::unique_ptr<folly::IOBuf> chain);
 
+  // Hand corked records to the socket. Normally runs at the end of the
+  // current event-loop iteration; called directly before a graceful close so
+  // records enqueued in this iteration are not dropped.
+  void flushWrites();
+
   //////////////////////////////////////////////////////////////////////////////
   // Methods for reading records
   //
@@ -357,6 +369,9 @@ private:
 
   folly::IOBufQueue m_readBuf; // buffer for async socket reads
 
+  // Records corked until the end of the current event-loop iteration
+  folly::IOBufQueue m_writeBuf{folly::IOBufQueue::cacheChainLength()};
+
   uint16_t m_requestId{0}; // the request active on the stream; 0 if no request
   bool m_keepConn{false};  // the webserver asked us to remain open after the
                            // current request completes
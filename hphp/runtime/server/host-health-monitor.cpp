@@ -16,6 +16,7 @@
 
 #include "hphp/runtime/server/host-health-monitor.h"
 
+#include <cstdlib>
 #include <thread>
 #include <folly/Singleton.h>
 
@@ -24,12 +25,17 @@
 #include "hphp/util/compatibility.h"
 #include "hphp/util/health-monitor-types.h"
 #include "hphp/util/logger.h"
+#include "hphp/util/process.h"
 
 namespace HPHP {
 
 namespace {
 bool Enabled;
 int32_t UpdateFreq;
+double CautiousLoadPerCPU;
+double NoMoreLoadPerCPU;
+int64_t CautiousFreeMb;
+int64_t NoMoreFreeMb;
 
 struct HostHealthMonitorExtension final : public Extension {
   HostHealthMonitorExtension() : Extension("hosthealthmonitor", "1.0") {}
@@ -39,11 +45,61 @@ struct HostHealthMonitorExtension final : public Extension {
                  "HealthMonitor.EnableHealthMonitor", true);
     Config::Bind(UpdateFreq, ini, globalConfig,
                  "HealthMonitor.UpdateFreq", 1000 /* miliseconds */);
+    Config::Bind(CautiousLoadPerCPU, ini, globalConfig,
+                 "HealthMonitor.CautiousLoadPerCPU", 0.0);
+    Config::Bind(NoMoreLoadPerCPU, ini, globalConfig,
+                 "HealthMonitor.NoMoreLoadPerCPU", 0.0);
+    Config::Bind(CautiousFreeMb, ini, globalConfig,
+                 "HealthMonitor.CautiousFreeMb", 0);
+    Config::Bind(NoMoreFreeMb, ini, globalConfig,
+                 "HealthMonitor.NoMoreFreeMb", 0);
   }
 } s_host_health_monitor_extension;
 
 folly::Singleton<HostHealthMonitor> s_health_monitor;
 
+// Built-in load signals, off until a deployment configures thresholds.
+// More specialized metrics register themselves through
+// IHealthMonitorMetric::registerSelf().
+struct CPULoadMetric final : IHealthMonitorMetric {
+  bool enabled() override {
+    return CautiousLoadPerCPU > 0 || NoMoreLoadPerCPU > 0;
+  }
+  HealthLevel evaluate() override {
+    double load;
+    if (getloadavg(&load, 1) != 1) return HealthLevel::Bold;
+    auto const perCpu = load / Process::GetCPUCount();
+    if (NoMoreLoadPerCPU > 0 && perCpu >= NoMoreLoadPerCPU) {
+      return HealthLevel::NoMore;
+    }
+    if (CautiousLoadPerCPU > 0 && perCpu >= CautiousLoadPerCPU) {
+      return HealthLevel::Cautious;
+    }
+    return HealthLevel::Bold;
+  }
+} s_cpu_load_metric;
+
+struct MemoryHeadroomMetric final : IHealthMonitorMetric {
+  bool enabled() override {
+    return CautiousFreeMb > 0 || NoMoreFreeMb > 0;
+  }
+  HealthLevel evaluate() override {
+    MemInfo info;
+    if (!Process::GetMemoryInfo(info) || !info.valid()) {
+      return HealthLevel::Bold;
+    }
+    // The page cache can be reclaimed, so count it as headroom.
+    auto const headroomMb = info.freeMb + info.cachedMb + info.buffersMb;
+    if (NoMoreFreeMb > 0 && headroomMb <= NoMoreFreeMb) {
+      return HealthLevel::NoMore;
+    }
+    if (CautiousFreeMb > 0 && headroomMb <= CautiousFreeMb) {
+      return HealthLevel::Cautious;
+    }
+    return HealthLevel::Bold;
+  }
+} s_memory_headroom_metric;
+
 }
 
 void HostHealthMonitor::addMetric(IHealthMonitorMetric* metric) {
@@ -61,6 +117,12 @@ void HostHealthMonitor::start() {
   if (UpdateFreq < 10) UpdateFreq = 10;
   if (UpdateFreq > 10000) UpdateFreq = 10000;
 
+  static std::once_flag builtinMetrics;
+  std::call_once(builtinMetrics, [this] {
+    addMetric(&s_cpu_load_metric);
+    addMetric(&s_memory_headroom_metric);
+  });
+
   m_monitor_func = std::make_unique<AsyncFunc<HostHealthMonitor>>(
     this,
     &HostHealthMonitor::monitor
@@ -107,6 +169,7 @@ HealthLevel HostHealthMonitor::evaluate() {
   HealthLevel res = HealthLevel::Bold;
   std::lock_guard<std::mutex> g(m_lock);
   for (auto metric : m_metrics) {
+    if (!metric->enabled()) continue;
     res = std::max(res, metric->evaluate());
   }
   return res;
@@ -116,13 +179,15 @@ void HostHealthMonitor::notifyObservers(HealthLevel newStatus) {
   if (newStatus != m_status) {
     Logger::Warning("Health level (lower is better) changes from %d to %d.",
                     static_cast<int>(m_status), static_cast<int>(newStatus));
+  }
 
-    std::lock_guard<std::mutex> g(m_lock);
-    for (auto observer : m_observers) {
-      observer->notifyNewStatus(newStatus);
-    }
-    m_status = newStatus;
+  // Observers hear about every tick, not just level changes, so they can
+  // run periodic control loops off the monitor thread.
+  std::lock_guard<std::mutex> g(m_lock);
+  for (auto observer : m_observers) {
+    observer->notifyNewStatus(newStatus);
   }
+  m_status = newStatus;
 }
 
 }
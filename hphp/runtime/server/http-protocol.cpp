@@ -15,6 +15,7 @@
 */
 #include "hphp/runtime/server/http-protocol.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 
@@ -28,7 +29,9 @@
 
 #include "hphp/runtime/base/array-init.h"
 #include "hphp/runtime/base/builtin-functions.h"
+#include "hphp/runtime/base/concurrent-shared-store.h"
 #include "hphp/runtime/base/http-client.h"
+#include "hphp/runtime/base/mixed-array.h"
 #include "hphp/runtime/base/program-functions.h"
 #include "hphp/runtime/base/request-injection-data.h"
 #include "hphp/runtime/base/runtime-option.h"
@@ -54,21 +57,30 @@ namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 // helper functions
 
-static bool read_all_post_data(Transport *transport,
-                               const void *&data, size_t &size) {
-  if (transport->hasMorePostData()) {
-    data = buffer_duplicate(data, size);
-    do {
-      size_t delta = 0;
-      const void *extra = transport->getMorePostData(delta);
-      if (size + delta < VirtualHost::GetMaxPostSize()) {
-        data = buffer_append(data, size, extra, delta);
-        size += delta;
-      }
-    } while (transport->hasMorePostData());
-    return true;
+static String read_all_post_data(Transport *transport,
+                                 const void *data, size_t size,
+                                 int64_t contentLength) {
+  // Coalesce the body straight into a request-heap string: one
+  // allocation reserved from Content-Length and one copy per chunk.
+  // This string later becomes the raw-post data, so building it here
+  // avoids the malloc/realloc staging buffer and the second copy into
+  // the request heap that it used to take.
+  auto const maxPost = VirtualHost::GetMaxPostSize();
+  auto capacity = std::max<int64_t>(
+    size, std::min<int64_t>(contentLength, maxPost));
+  if (capacity >= StringData::MaxSize) {
+    capacity = StringData::MaxSize - 1;
+  }
+  StringBuffer sb(static_cast<uint32_t>(capacity));
+  sb.append(static_cast<const char*>(data), size);
+  while (transport->hasMorePostData()) {
+    size_t delta = 0;
+    const void *extra = transport->getMorePostData(delta);
+    if (delta > 0 && sb.size() + delta < maxPost) {
+      sb.append(static_cast<const char*>(extra), delta);
+    }
   }
-  return false;
+  return sb.detach();
 }
 
 static void CopyParams(Array& dest, Array& src) {
@@ -166,8 +178,8 @@ static auto const s_arraysToUnset = {
   s__SESSION,
 };
 
-static void PrepareEnv(Array& env, Transport *transport) {
-  // $_ENV
+static Array BuildEnvTemplate(bool isServer) {
+  Array env(Array::Create());
   process_env_variables(env);
   env.set(s_HPHP, 1);
   env.set(s_HHVM, 1);
@@ -185,12 +197,28 @@ static void PrepareEnv(Array& env, Transport *transport) {
     env.set(s_HHVM_ARCH, "ppc64");
     break;
   }
+  if (isServer) {
+    env.set(s_HPHP_SERVER, 1);
+    env.set(s_HPHP_HOTPROFILER, 1);
+  }
+  return Array(ArrayData::GetScalarArray(env.get()));
+}
 
+static void PrepareEnv(Array& env, Transport *transport) {
+  // $_ENV: the process environment and our runtime markers never change
+  // after startup (putenv() only updates the request-local table), so
+  // snapshot them into a shared static array once and hand each request
+  // a reference to it; copy-on-write takes care of requests that modify
+  // $_ENV.  CLI-server requests see a different view than server
+  // requests, so each gets its own template.
   bool isServer =
     RuntimeOption::ServerExecutionMode() && !is_cli_mode();
   if (isServer) {
-    env.set(s_HPHP_SERVER, 1);
-    env.set(s_HPHP_HOTPROFILER, 1);
+    static Array serverTemplate = BuildEnvTemplate(true);
+    env = serverTemplate;
+  } else {
+    static Array cliTemplate = BuildEnvTemplate(false);
+    env = cliTemplate;
   }
 
   // Do this last so it can overwrite all the previous settings
@@ -430,7 +458,10 @@ void HttpProtocol::PreparePostVariables(Array& post,
       }
       assert(!transport->getFiles(files_str));
     } else {
-      needDelete = read_all_post_data(transport, data, size);
+      auto const streamed = transport->hasMorePostData();
+      String body = read_all_post_data(transport, data, size, content_length);
+      data = body.data();
+      size = body.size();
 
       bool decodeData = strncasecmp(contentType.c_str(),
                                     DEFAULT_POST_CONTENT_TYPE,
@@ -451,8 +482,17 @@ void HttpProtocol::PreparePostVariables(Array& post,
       if (ret) {
         files = unserialize_from_string(files_str);
       }
+
+      g_context->setRawPostData(body);
+      if (RuntimeOption::AlwaysPopulateRawPostData || !streamed) {
+        // For literal (unstreamed) bodies we disregard
+        // RuntimeOption::AlwaysPopulateRawPostData
+        raw_post = body;
+      }
+      return;
     }
 
+    // Only the multipart path falls through to here.
     if (!data) {
       return;
     }
@@ -806,6 +846,7 @@ std::string HttpProtocol::RecordRequest(Transport *transport) {
 
     ReplayTransport rt;
     rt.recordInput(transport, tmpfile);
+    ConcurrentTableSharedStore::beginReadCapture();
     Logger::Info("request recorded in %s", tmpfile);
     return tmpfile;
   }
@@ -813,9 +854,15 @@ std::string HttpProtocol::RecordRequest(Transport *transport) {
 }
 
 void HttpProtocol::ClearRecord(bool success, const std::string &tmpfile) {
-  if (success && RuntimeOption::ClearInputOnSuccess && !tmpfile.empty()) {
+  auto const apcReads = ConcurrentTableSharedStore::takeReadCapture();
+  if (tmpfile.empty()) return;
+  if (success && RuntimeOption::ClearInputOnSuccess) {
     unlink(tmpfile.c_str());
     Logger::Info("request %s deleted", tmpfile.c_str());
+    return;
+  }
+  if (!apcReads.empty()) {
+    ReplayTransport::appendSessionData(tmpfile, apcReads);
   }
 }
 
@@ -831,6 +878,18 @@ void HttpProtocol::DecodeParameters(Array& variables, const char *data,
   const char *e = s + size;
   const char *p, *val;
 
+  // When filling a fresh $_GET/$_POST, size the array to the number of
+  // '&'-separated pairs up front instead of growing it insert by insert.
+  if (variables.empty()) {
+    uint32_t pairs = 1;
+    const char *q = s;
+    while (q < e && (q = (const char *)memchr(q, '&', e - q))) {
+      pairs++;
+      q++;
+    }
+    variables = Array::attach(MixedArray::MakeReserveMixed(pairs));
+  }
+
   while (s < e && (p = (const char *)memchr(s, '&', (e - s)))) {
   last_value:
     if ((val = (const char *)memchr(s, '=', (p - s)))) {
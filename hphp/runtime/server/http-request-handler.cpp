@@ -26,6 +26,7 @@
 #include "hphp/runtime/base/program-functions.h"
 #include "hphp/runtime/base/resource-data.h"
 #include "hphp/runtime/base/runtime-option.h"
+#include "hphp/runtime/base/timestamp.h"
 #include "hphp/runtime/debugger/debugger.h"
 #include "hphp/runtime/ext/extension-registry.h"
 #include "hphp/runtime/ext/std/ext_std_function.h"
@@ -33,6 +34,7 @@
 #include "hphp/runtime/server/access-log.h"
 #include "hphp/runtime/server/files-match.h"
 #include "hphp/runtime/server/http-protocol.h"
+#include "hphp/runtime/server/replay-transport.h"
 #include "hphp/runtime/server/request-uri.h"
 #include "hphp/runtime/server/server-stats.h"
 #include "hphp/runtime/server/source-root-info.h"
@@ -44,6 +46,7 @@
 #include "hphp/util/lock.h"
 #include "hphp/util/mutex.h"
 #include "hphp/util/network.h"
+#include "hphp/util/ringbuffer.h"
 #include "hphp/util/service-data.h"
 #include "hphp/util/stack-trace.h"
 #include "hphp/util/struct-log.h"
@@ -125,12 +128,15 @@ HttpRequestHandler::HttpRequestHandler(int timeout)
     : RequestHandler(timeout), m_pathTranslation(true)
     , m_requestTimedOutOnQueue(ServiceData::createTimeSeries(
                                  "requests_timed_out_on_queue",
-                                 {ServiceData::StatsType::COUNT})) { }
+                                 {ServiceData::StatsType::COUNT}))
+    , m_requestQueueWaitTime(ServiceData::createStripedHistogram(
+                               "request_queue_wait_us")) { }
 
 void HttpRequestHandler::sendStaticContent(Transport *transport,
                                            const char *data, int len,
                                            time_t mtime,
-                                           bool compressed,
+                                           Transport::CompressionType encoding,
+                                           bool immortal,
                                            const std::string &cmd,
                                            const char *ext) {
   assert(ext);
@@ -186,7 +192,13 @@ void HttpRequestHandler::sendStaticContent(Transport *transport,
   // should not attempt to compress it.
   transport->disableCompression();
 
-  transport->sendRaw((void*)data, len, 200, compressed);
+  if (immortal) {
+    // Cache memory lives for the whole process; the transport can send
+    // it without copying.
+    transport->setStaticResponse(encoding);
+  }
+  transport->sendRaw((void*)data, len, 200,
+                     encoding != Transport::CompressionType::Max);
   transport->onSendEnd();
 }
 
@@ -196,6 +208,11 @@ void HttpRequestHandler::logToAccessLog(Transport* transport) {
 }
 
 void HttpRequestHandler::setupRequest(Transport* transport) {
+  Trace::structuredRingbufferEntry(
+    Trace::RBTypeRequestBegin,
+    reinterpret_cast<uint64_t>(transport),
+    0
+  );
   MemoryManager::requestInit();
   HHProf::Request::Setup(transport);
 
@@ -227,6 +244,11 @@ void HttpRequestHandler::teardownRequest(Transport* transport) noexcept {
 
   MemoryManager::requestShutdown();
   HHProf::Request::Teardown();
+  Trace::structuredRingbufferEntry(
+    Trace::RBTypeRequestEnd,
+    reinterpret_cast<uint64_t>(transport),
+    static_cast<uint64_t>(transport->getResponseCode())
+  );
 }
 
 void HttpRequestHandler::handleRequest(Transport *transport) {
@@ -254,16 +276,19 @@ void HttpRequestHandler::handleRequest(Transport *transport) {
     return;
   }
 
+  // Export how long the request sat in the queue before a worker picked it
+  // up; the striped histogram is cheap enough to update on every request.
+  timespec now;
+  Timer::GetMonotonicTime(now);
+  auto const queueTimeUs = gettime_diff_us(transport->getQueueTime(), now);
+  m_requestQueueWaitTime->addValue(queueTimeUs);
+
   // don't serve the request if it's been sitting in queue for longer than our
   // allowed request timeout.
   int requestTimeoutSeconds =
     vhost->getRequestTimeoutSeconds(getDefaultTimeout());
   if (requestTimeoutSeconds > 0) {
-    timespec now;
-    Timer::GetMonotonicTime(now);
-    const timespec& queueTime = transport->getQueueTime();
-
-    if (gettime_diff_us(queueTime, now) > requestTimeoutSeconds * 1000000) {
+    if (queueTimeUs > requestTimeoutSeconds * 1000000) {
       transport->sendString("Service Unavailable", 503);
       transport->onSendEnd();
       m_requestTimedOutOnQueue->addValue(1);
@@ -317,23 +342,27 @@ void HttpRequestHandler::handleRequest(Transport *transport) {
 
   // If this is not a php file, check the static content cache
   if (treatAsContent) {
-    bool original = compressed;
-    // check against static content cache
-    if (StaticContentCache::TheCache.find(path, data, len, compressed)) {
-      ScopedMem decompressed_data;
+    // check against static content cache, picking the precompressed
+    // variant the client prefers; a client with no usable
+    // Accept-Encoding still falls back to gzip when the response has to
+    // be compressed (ForceCompression).
+    bool const acceptsBrotli = compressed && transport->acceptEncoding("br");
+    bool const acceptsGzip = compressed &&
+      (transport->acceptEncoding("gzip") || !acceptsBrotli);
+    StaticContentCache::Encoding encoding;
+    if (StaticContentCache::TheCache.find(path, acceptsGzip, acceptsBrotli,
+                                          data, len, encoding)) {
       // (qigao) not calling stat at this point because the timestamp of
       // local cache file is not valuable, maybe misleading. This way
       // the Last-Modified header will not show in response.
       // stat(RuntimeOption::FileCache.c_str(), &st);
-      if (!original && compressed) {
-        data = gzdecode(data, len);
-        if (data == nullptr) {
-          raise_fatal_error("cannot unzip compressed data");
-        }
-        decompressed_data = const_cast<char*>(data);
-        compressed = false;
-      }
-      sendStaticContent(transport, data, len, 0, compressed, path, ext);
+      auto const type =
+        encoding == StaticContentCache::Encoding::Brotli
+          ? Transport::CompressionType::Brotli
+          : encoding == StaticContentCache::Encoding::Gzip
+            ? Transport::CompressionType::Gzip
+            : Transport::CompressionType::Max;
+      sendStaticContent(transport, data, len, 0, type, true, path, ext);
       ServerStats::LogPage(path, 200);
       return;
     }
@@ -347,7 +376,8 @@ void HttpRequestHandler::handleRequest(Transport *transport) {
           st.st_mtime = 0;
           stat(translated.data(), &st);
           sendStaticContent(transport, sb.data(), sb.size(), st.st_mtime,
-                            false, path, ext);
+                            Transport::CompressionType::Max, false,
+                            path, ext);
           ServerStats::LogPage(path, 200);
           return;
         }
@@ -454,6 +484,14 @@ bool HttpRequestHandler::executePHPRequest(Transport *transport,
     sourceRootInfo.clear();
   }
 
+  // When replaying a recorded request, restore the session state captured
+  // with it (APC reads, random seed, clock) now that the request heap is up.
+  bool replaying = false;
+  if (auto rt = dynamic_cast<ReplayTransport*>(transport)) {
+    replaying = rt->primeSessionState();
+  }
+  SCOPE_EXIT { if (replaying) TimeStamp::ClearReplayTime(); };
+
   int code;
   bool ret = true;
 
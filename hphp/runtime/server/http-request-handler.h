@@ -31,6 +31,7 @@ struct SourceRootInfo;
 struct RequestURI;
 
 namespace ServiceData {
+struct ExportedStripedHistogram;
 struct ExportedTimeSeries;
 }
 
@@ -61,11 +62,13 @@ public:
 private:
   bool m_pathTranslation;
   ServiceData::ExportedTimeSeries* m_requestTimedOutOnQueue;
+  ServiceData::ExportedStripedHistogram* m_requestQueueWaitTime;
   folly::Optional<SourceRootInfo> m_sourceRootInfo;
 
   bool handleProxyRequest(Transport *transport, bool force);
   void sendStaticContent(Transport *transport, const char *data, int len,
-                         time_t mtime, bool compressed,
+                         time_t mtime, Transport::CompressionType encoding,
+                         bool immortal,
                          const std::string &cmd,
                          const char *ext);
   bool executePHPRequest(Transport *transport, RequestURI &reqURI,
@@ -27,6 +27,7 @@
 #include "hphp/runtime/debugger/debugger.h"
 #include "hphp/runtime/ext/apc/ext_apc.h"
 #include "hphp/runtime/server/admin-request-handler.h"
+#include "hphp/runtime/server/host-health-monitor.h"
 #include "hphp/runtime/server/http-request-handler.h"
 #include "hphp/runtime/server/replay-transport.h"
 #include "hphp/runtime/server/server-stats.h"
@@ -37,6 +38,7 @@
 
 #include "hphp/util/alloc.h"
 #include "hphp/util/boot-stats.h"
+#include "hphp/util/compatibility.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/process.h"
 #include "hphp/util/ssl-init.h"
@@ -181,6 +183,10 @@ HttpServer::HttpServer()
 
 // Synchronously stop satellites
 void HttpServer::onServerShutdown() {
+  // Avoid any further scaling or backoff decisions while draining;
+  // stop() resets all observers to Bold.
+  getSingleton<HostHealthMonitor>()->stop();
+
   InitFiniNode::ServerFini();
 
   Eval::Debugger::Stop();
@@ -360,6 +366,8 @@ void HttpServer::runOrExitProcess() {
                      e.what()));
   }
 
+  getSingleton<HostHealthMonitor>()->start();
+
   {
     BootStats::mark("servers started");
     Logger::Info("all servers started");
@@ -17,9 +17,14 @@
 #include "hphp/runtime/server/log-writer.h"
 
 #include <cctype>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
 #include <map>
 
+#include <folly/json.h>
+
+#include "hphp/util/async-log-writer.h"
 #include "hphp/util/logger.h"
 #include "hphp/runtime/base/init-fini-node.h"
 
@@ -52,45 +57,13 @@ std::string FieldGenerator::escapeData(const char* s, int len) {
 }
 
 ClassicWriter::~ClassicWriter() {
-  if (m_channel == LogChannel::REGULAR) {
-    if (m_logdata.file[0] == '|') {
-      pclose(m_filelog);
-    } else {
-      fclose(m_filelog);
-    }
-  }
+  closeFiles(m_logdata);
 }
 
 void ClassicWriter::init(const std::string& username,
                          AccessLog::GetThreadDataFunc fn) {
   m_threadDataFn = fn;
-  if (m_channel == LogChannel::CRONOLOG) {
-    assert(!m_logdata.file.empty());
-    m_cronolog = std::make_unique<Cronolog>();
-    if (m_logdata.file.find('%') != std::string::npos) {
-      m_cronolog->m_template = m_logdata.file;
-      m_cronolog->setPeriodicity();
-      if (m_logdata.periodMultiplier) {
-        m_cronolog->m_periodMultiple = m_logdata.periodMultiplier;
-      }
-
-      m_cronolog->m_linkName = m_logdata.symLink;
-      Cronolog::changeOwner(username, m_logdata.symLink);
-    } else {
-      m_cronolog->m_file = fopen(m_logdata.file.c_str(), "a");
-    }
-  } else if (m_channel == LogChannel::REGULAR) {
-    assert(!m_logdata.file.empty());
-    if (m_logdata.file[0] == '|') {
-      std::string plog = m_logdata.file.substr(1);
-      m_filelog = popen(plog.c_str(), "w");
-    } else {
-      m_filelog = fopen(m_logdata.file.c_str(), "a");
-    }
-    if (!m_filelog) {
-      Logger::Error("Couldn't open access log file %s", m_logdata.file.c_str());
-    }
-  }
+  openFiles(m_logdata, username);
 }
 
 void ClassicWriter::write(Transport* transport, const VirtualHost* vhost) {
@@ -126,6 +99,17 @@ void ClassicWriter::write(Transport* transport, const VirtualHost* vhost) {
   out << std::endl;
 
   auto str = out.str();
+
+  if (AsyncLogWriter::Enabled && m_channel == LogChannel::REGULAR &&
+      m_logdata.file[0] != '|') {
+    // Hand the line to the background flusher instead of paying a write
+    // syscall per request. Cache-dropping bookkeeping is skipped for
+    // async files; the fd's offset only advances on the flusher's
+    // schedule.
+    AsyncLogWriter::Get()->enqueue(fileno(outfile), std::move(str));
+    return;
+  }
+
   int nbytes = fwrite(str.data(), 1, str.size(), outfile);
   fflush(outfile);
 
@@ -187,6 +171,163 @@ void ClassicWriter::skipField(const char*& format) {
   format++;
 }
 
+namespace {
+// Record framing: a little-endian uint32 length covering the type byte and
+// the payload, then the type byte, then the payload. All our supported
+// targets are little-endian, so multi-byte values are written in host order.
+constexpr uint8_t kSchemaRecord = 0;
+constexpr uint8_t kRowRecord = 1;
+
+void appendUint32(std::string& out, uint32_t value) {
+  char buf[sizeof(value)];
+  memcpy(buf, &value, sizeof(value));
+  out.append(buf, sizeof(value));
+}
+
+void appendInt64(std::string& out, int64_t value) {
+  char buf[sizeof(value)];
+  memcpy(buf, &value, sizeof(value));
+  out.append(buf, sizeof(value));
+}
+
+void appendRecord(std::string& out, uint8_t type, const std::string& payload) {
+  appendUint32(out, payload.size() + 1);
+  out.push_back((char)type);
+  out.append(payload);
+}
+}
+
+BinaryStructuredWriter::BinaryStructuredWriter(const AccessLogFileData& alfd,
+                                               LogChannel chan)
+  : LogWriter(chan)
+  , m_logdata(alfd)
+{
+  folly::dynamic spec = nullptr;
+  try {
+    spec = folly::parseJson(m_logdata.format);
+  } catch (const std::exception& e) {
+    throw std::runtime_error(
+      std::string("Invalid binary access log schema: ") + e.what());
+  }
+  if (!spec.isArray()) {
+    throw std::runtime_error("Binary access log schema must be a JSON array");
+  }
+  folly::dynamic columns = folly::dynamic::array;
+  for (auto const& col : spec) {
+    if (!col.isArray() || col.size() != 3) {
+      throw std::runtime_error(
+        "Binary access log columns must be [directive, name, type] triples");
+    }
+    Field field;
+    auto const directive = col[0].asString();
+    auto fmt = folly::StringPiece(directive);
+    fmt.removePrefix('%');
+    if (fmt.removePrefix('{')) {
+      size_t close = fmt.find('}');
+      if (close == fmt.npos) {
+        throw std::runtime_error(
+          "Unterminated argument in binary access log column: " + directive);
+      }
+      field.arg = fmt.subpiece(0, close).str();
+      fmt.advance(close + 1);
+    }
+    if (fmt.size() != 1) {
+      throw std::runtime_error(
+        "Invalid field specifier in binary access log column: " + directive);
+    }
+    field.code = fmt.front();
+    field.name = col[1].asString();
+    auto const type = col[2].asString();
+    if (type == "INT") {
+      field.isInt = true;
+    } else if (type == "STRING") {
+      field.isInt = false;
+    } else {
+      throw std::runtime_error(
+        "Unknown binary access log column type: " + type);
+    }
+    columns.push_back(folly::dynamic::array(field.name, type));
+    m_fields.push_back(std::move(field));
+  }
+  m_schema = folly::toJson(columns);
+}
+
+BinaryStructuredWriter::~BinaryStructuredWriter() {
+  closeFiles(m_logdata);
+}
+
+void BinaryStructuredWriter::init(const std::string& username,
+                                  AccessLog::GetThreadDataFunc fn) {
+  m_threadDataFn = fn;
+  openFiles(m_logdata, username);
+}
+
+void BinaryStructuredWriter::write(Transport* transport,
+                                   const VirtualHost* vhost) {
+  auto outfile = getOutputFile();
+  if (!outfile) return;
+
+  FieldGenerator fieldGen{
+    transport,
+    vhost,
+    (m_threadDataFn ? m_threadDataFn() : nullptr)
+  };
+
+  // A presence bitmap, then the present fields' values in schema order.
+  // Fields not in the schema are never generated at all.
+  std::string payload;
+  payload.resize((m_fields.size() + 7) / 8, '\0');
+  size_t idx = 0;
+  for (auto const& field : m_fields) {
+    bool present = false;
+    if (field.isInt) {
+      int64_t value = 0;
+      try {
+        present = fieldGen.gen<int64_t>(field.code, field.arg, value);
+      } catch (const std::exception&) {
+        // A non-numeric value in an INT column; leave it absent.
+      }
+      if (present) appendInt64(payload, value);
+    } else {
+      std::string value;
+      present = fieldGen.gen<std::string>(field.code, field.arg, value);
+      if (present) {
+        appendUint32(payload, value.size());
+        payload.append(value);
+      }
+    }
+    if (present) payload[idx / 8] |= (1 << (idx % 8));
+    ++idx;
+  }
+
+  std::string out;
+  auto last = m_schemaFile.load(std::memory_order_acquire);
+  if (last != outfile &&
+      m_schemaFile.compare_exchange_strong(last, outfile)) {
+    // First write to this output file (startup or cronolog rotation):
+    // lead with the schema record so consumers can bind columns by name.
+    // A racing thread may still write its row first; consumers tolerate a
+    // few leading rows before the schema by buffering until they see it.
+    appendRecord(out, kSchemaRecord, m_schema);
+  }
+  appendRecord(out, kRowRecord, payload);
+
+  if (AsyncLogWriter::Enabled && m_channel == LogChannel::REGULAR &&
+      m_logdata.file[0] != '|') {
+    AsyncLogWriter::Get()->enqueue(fileno(outfile), std::move(out));
+    return;
+  }
+
+  int nbytes = fwrite(out.data(), 1, out.size(), outfile);
+  fflush(outfile);
+
+  if (m_channel != LogChannel::REGULAR || m_logdata.file[0] != '|') {
+    recordWriteAndMaybeDropCaches(outfile, nbytes);
+  }
+}
+
+const std::string BinaryStructuredWriter::handle = "binary";
+
 static InitFiniNode registerClassicWriter(
   []() { AccessLogFileData::registerWriter(
       ClassicWriter::handle,
@@ -196,5 +337,15 @@ static InitFiniNode registerClassicWriter(
   );},
   InitFiniNode::When::ServerPreInit
 );
+
+static InitFiniNode registerBinaryStructuredWriter(
+  []() { AccessLogFileData::registerWriter(
+      BinaryStructuredWriter::handle,
+      [](const AccessLogFileData& alfd, LogChannel chan) {
+        return std::make_unique<BinaryStructuredWriter>(alfd, chan);
+      }
+  );},
+  InitFiniNode::When::ServerPreInit
+);
 ///////////////////////////////////////////////////////////////////////////////
 }
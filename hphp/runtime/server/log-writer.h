@@ -16,7 +16,9 @@
 #ifndef incl_HPHP_LOG_WRITER_H_
 #define incl_HPHP_LOG_WRITER_H_
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 #include <folly/Conv.h>
 #include <folly/Format.h>
@@ -54,6 +56,43 @@ private:
   static void skipField(const char*& fmt);
 };
 
+/*
+ * Writes length-prefixed binary records instead of formatted text lines, so
+ * the downstream log pipeline extracts columns by offset rather than
+ * re-parsing text. Selected with a ":binary:" format whose body is a JSON
+ * schema of [directive, name, type] triples, e.g.
+ *
+ *   Format = :binary: [["%h", "client_ip", "STRING"], ["%D", "wall_us", "INT"]]
+ *
+ * where the directive is a ClassicWriter-style field specifier. Only fields
+ * named in the schema are ever generated. Each output file starts with a
+ * schema record naming the columns, so consumers bind columns without any
+ * out-of-band agreement with the writer's configuration.
+ */
+struct BinaryStructuredWriter final : LogWriter {
+  BinaryStructuredWriter(const AccessLogFileData& alfd, LogChannel chan);
+  ~BinaryStructuredWriter() override;
+  void init(const std::string& username,
+            AccessLog::GetThreadDataFunc fn) override;
+  void write(Transport* transport, const VirtualHost* vhost) override;
+  const static std::string handle;
+private:
+  // One column of the schema: the field specifier it is generated from, the
+  // name consumers bind to, and how its value serializes.
+  struct Field {
+    char code;
+    bool isInt;
+    std::string arg;
+    std::string name;
+  };
+  const AccessLogFileData m_logdata;
+  std::vector<Field> m_fields;
+  std::string m_schema;
+  // Output file the schema record was last written to; rotation (or the
+  // first write) installs a new file and re-emits the schema.
+  std::atomic<FILE*> m_schemaFile{nullptr};
+};
+
 struct FieldGenerator {
   FieldGenerator(Transport* t, const VirtualHost* vh,
                  AccessLog::ThreadData* tdata)
@@ -47,6 +47,7 @@ PageletTransport::PageletTransport(
       m_timeoutSeconds(timeoutSeconds),
       m_done(false),
       m_code(0),
+      m_pipelineSize(0),
       m_event(nullptr) {
 
   Timer::GetMonotonicTime(m_queueTime);
@@ -130,8 +131,14 @@ void PageletTransport::removeHeaderImpl(const char *name) {
 }
 
 void PageletTransport::sendImpl(const void* data, int size, int code,
-                                bool /*chunked*/, bool eom) {
-  m_response.append((const char*)data, size);
+                                bool chunked, bool eom) {
+  if (chunked && !eom && size > 0) {
+    // A flush() in the pagelet: hand the chunk to the parent right away
+    // instead of sitting on it until the whole request finishes.
+    addToPipeline(std::string((const char*)data, size));
+  } else {
+    m_response.append((const char*)data, size);
+  }
   if (code) {
     m_code = code;
   }
@@ -170,6 +177,19 @@ void PageletTransport::addToPipeline(const std::string &s) {
   if (m_done) return;
 
   Lock lock(this);
+  size_t const limit =
+    (size_t)RuntimeOption::PageletServerPipelineBufferKb * 1024;
+  if (limit > 0) {
+    // Bounded handoff: a pagelet that runs ahead of its consumer waits
+    // here instead of holding an unbounded amount of output.  Stop
+    // waiting if the parent has dropped the task (only our worker's
+    // reference is left); the periodic wakeup guards against that
+    // happening while we sleep.
+    while (m_pipelineSize >= limit && m_refCount.load() > 1) {
+      wait(1, 0);
+    }
+  }
+  m_pipelineSize += s.size();
   m_pipeline.push_back(s);
   if (m_event) {
     m_event->finish();
@@ -195,8 +215,10 @@ bool PageletTransport::getResults(
       std::string &str = m_pipeline.front();
       String response(str.c_str(), str.size(), CopyString);
       results.append(response);
+      m_pipelineSize -= str.size();
       m_pipeline.pop_front();
     }
+    notify(); // a pagelet thread may be waiting for pipeline room
 
     code = m_code;
     if (m_done) {
@@ -234,7 +256,9 @@ String PageletTransport::getResults(
     if (!m_pipeline.empty()) {
       // intermediate results do not have headers and code
       std::string ret = m_pipeline.front();
+      m_pipelineSize -= ret.size();
       m_pipeline.pop_front();
+      notify(); // a pagelet thread may be waiting for pipeline room
       code = 0;
       return ret;
     }
@@ -156,6 +156,7 @@ private:
   int m_code;
 
   std::deque<std::string> m_pipeline; // the intermediate pagelet results
+  size_t m_pipelineSize; // total bytes buffered in m_pipeline
   std::set<std::string> m_rfc1867UploadedFiles;
   std::string m_files; // serialized to use as $_FILES
 
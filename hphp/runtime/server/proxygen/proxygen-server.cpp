@@ -20,6 +20,7 @@
 #include <memory>
 #include <thread>
 #include "hphp/runtime/server/fake-transport.h"
+#include "hphp/runtime/server/host-health-monitor.h"
 #include "hphp/runtime/server/http-server.h"
 #include "hphp/runtime/server/proxygen/proxygen-transport.h"
 #include "hphp/runtime/server/server-name-indication.h"
@@ -29,10 +30,14 @@
 #include "hphp/runtime/base/program-functions.h"
 #include "hphp/runtime/base/url.h"
 #include "hphp/runtime/debugger/debugger.h"
+#include "hphp/runtime/ext/apc/ext_apc.h"
+#include "hphp/runtime/vm/type-profile.h"
 #include "hphp/util/alloc.h"
 #include "hphp/util/compatibility.h"
 #include "hphp/util/process.h"
 
+#include <folly/FileUtil.h>
+#include <folly/json.h>
 #include <folly/portability/Unistd.h>
 #include <proxygen/lib/http/codec/HTTP2Constants.h>
 
@@ -188,6 +193,12 @@ int ProxygenServer::onTakeoverRequest(TakeoverAgent::RequestType type) {
     stopListening(true /*hard*/);
     // No need to do m_takeover_agent->stop(), as the afdt server is
     // going to be closed when this returns.
+  } else if (type == TakeoverAgent::RequestType::APC_SNAPSHOT) {
+    // The fd (if any) is duplicated into the new server; we are about
+    // to be terminated, so we don't bother closing anything here.
+    return apc_takeover_snapshot_fd();
+  } else if (type == TakeoverAgent::RequestType::JIT_PROFILE) {
+    return profileDumpHotFuncs();
   }
   return 0;
 }
@@ -209,6 +220,15 @@ void ProxygenServer::removeTakeoverListener(TakeoverListener* listener) {
 }
 
 void ProxygenServer::start() {
+  // Install session ticket seeds before the acceptors are created, so
+  // every ticket we ever issue is derived from the shared seeds and stays
+  // resumable on any box configured with the same seed file.
+  wangle::TLSTicketKeySeeds seeds;
+  if (loadTLSTicketSeeds(seeds)) {
+    m_httpConfig.initialTicketSeeds = seeds;
+    m_httpsConfig.initialTicketSeeds = seeds;
+  }
+
   m_httpServerSocket.reset(new AsyncServerSocket(m_worker.getEventBase()));
   bool needListen = true;
   auto failedToListen = [](const std::exception& ex,
@@ -237,6 +257,21 @@ void ProxygenServer::start() {
                      m_accept_sock);
         m_httpServerSocket->useExistingSocket(m_accept_sock);
         needListen = false;
+        // Before asking the old server to shut down its satellites,
+        // inherit whatever warmth it can hand over: its mapped APC
+        // prime snapshot and its JIT hot-function profile.  The old
+        // server keeps serving traffic until the TERMINATE request,
+        // so this does not leave the port unattended any longer.
+        auto fd = m_takeover_agent->requestWarmthFd(
+          TakeoverAgent::RequestType::APC_SNAPSHOT);
+        if (fd >= 0) {
+          apc_prime_from_fd(fd);
+        }
+        fd = m_takeover_agent->requestWarmthFd(
+          TakeoverAgent::RequestType::JIT_PROFILE);
+        if (fd >= 0) {
+          profileLoadHotFuncs(fd);
+        }
         m_takeover_agent->requestShutdown();
         takoverSucceeded = true;
       }
@@ -311,6 +346,14 @@ void ProxygenServer::start() {
   folly::AsyncTimeout::attachEventBase(m_worker.getEventBase());
   m_worker.start();
   m_dispatcher.start();
+
+  if (RuntimeOption::ServerThreadAutoScale &&
+      m_port == RuntimeOption::ServerPort) {
+    // Let the host health monitor grow and shrink the worker pool
+    // between the configured floor and Server.ThreadCount.
+    m_dispatcher.enableWorkerScaling(RuntimeOption::ServerThreadScaleFloor);
+    getSingleton<HostHealthMonitor>()->subscribe(&m_dispatcher);
+  }
 }
 
 void ProxygenServer::waitForEnd() {
@@ -354,6 +397,8 @@ void ProxygenServer::stop() {
 
   setStatus(RunStatus::STOPPING);
 
+  getSingleton<HostHealthMonitor>()->unsubscribe(&m_dispatcher);
+
   if (m_takeover_agent) {
     m_worker.getEventBase()->runInEventBaseThread([this] {
         m_takeover_agent->stop();
@@ -667,6 +712,53 @@ bool ProxygenServer::sniNoMatchHandler(const char *server_name) {
   return false;
 }
 
+bool ProxygenServer::loadTLSTicketSeeds(wangle::TLSTicketKeySeeds& seeds) {
+  if (RuntimeOption::SSLTicketSeedFile.empty()) return false;
+  std::string json;
+  if (!folly::readFile(RuntimeOption::SSLTicketSeedFile.c_str(), json)) {
+    Logger::Error("Failed to read TLS ticket seed file %s",
+                  RuntimeOption::SSLTicketSeedFile.c_str());
+    return false;
+  }
+  try {
+    auto const conf = folly::parseJson(json);
+    auto const read = [&](const char* name, std::vector<std::string>& out) {
+      if (auto const list = conf.get_ptr(name)) {
+        for (auto const& seed : *list) {
+          out.push_back(seed.asString());
+        }
+      }
+    };
+    read("old", seeds.oldSeeds);
+    read("current", seeds.currentSeeds);
+    read("new", seeds.newSeeds);
+  } catch (const std::exception& ex) {
+    Logger::Error("Failed to parse TLS ticket seed file %s: %s",
+                  RuntimeOption::SSLTicketSeedFile.c_str(), ex.what());
+    return false;
+  }
+  return !seeds.currentSeeds.empty();
+}
+
+bool ProxygenServer::reloadTLSTicketSeeds() {
+  wangle::TLSTicketKeySeeds seeds;
+  if (!loadTLSTicketSeeds(seeds)) return false;
+  // The acceptors live on the I/O thread; hand the new seeds over there.
+  // Tickets issued under the old seeds keep resuming as long as the
+  // rotation keeps the previous seed in "old".
+  m_worker.getEventBase()->runInEventBaseThread([this, seeds] {
+    if (m_httpAcceptor) {
+      m_httpAcceptor->setTLSTicketSecrets(
+        seeds.oldSeeds, seeds.currentSeeds, seeds.newSeeds);
+    }
+    if (m_httpsAcceptor) {
+      m_httpsAcceptor->setTLSTicketSecrets(
+        seeds.oldSeeds, seeds.currentSeeds, seeds.newSeeds);
+    }
+  });
+  return true;
+}
+
 bool ProxygenServer::enableSSL(int port) {
   if (port == 0) {
     return false;
@@ -24,6 +24,7 @@
 #include <proxygen/lib/http/session/HTTPSessionAcceptor.h>
 #include <proxygen/lib/services/WorkerThread.h>
 #include <wangle/ssl/SSLContextConfig.h>
+#include <wangle/ssl/TLSTicketKeySeeds.h>
 #include <folly/io/async/NotificationQueue.h>
 
 #include <algorithm>
@@ -113,6 +114,7 @@ struct ProxygenServer : Server,
   int getLibEventConnectionCount() override;
   bool enableSSL(int port) override;
   bool enableSSLWithPlainText() override;
+  bool reloadTLSTicketSeeds() override;
 
   folly::EventBase *getEventBase() {
     return m_eventBaseManager.getEventBase();
@@ -210,6 +212,8 @@ struct ProxygenServer : Server,
 
   wangle::SSLContextConfig createContextConfig();
 
+  bool loadTLSTicketSeeds(wangle::TLSTicketKeySeeds& seeds);
+
   // Forbidden copy constructor and assignment operator
   ProxygenServer(ProxygenServer const &) = delete;
   ProxygenServer& operator=(ProxygenServer const &) = delete;
@@ -660,8 +660,15 @@ void ProxygenTransport::messageAvailable(ResponseMessage&& message) noexcept {
 
 void ProxygenTransport::sendImpl(const void *data, int size, int code,
                                  bool chunked, bool eom) {
-  assert(data);
+  sendImpl(StringHolder(static_cast<const char*>(data), size),
+           code, chunked, eom);
+}
+
+void ProxygenTransport::sendImpl(StringHolder&& data, int code,
+                                 bool chunked, bool eom) {
+  assert(data.data());
   assert(!m_sendStarted || chunked);
+  auto const size = data.size();
   if (m_sendEnded) {
     // This should never happen, but when it does we have to bail out,
     // since there's no sensible way to send data at this point and
@@ -696,13 +703,13 @@ void ProxygenTransport::sendImpl(const void *data, int size, int code,
     m_server->putResponseMessage(
       ResponseMessage(shared_from_this(),
                       ResponseMessage::Type::HEADERS, 0,
-                      chunked, data, size, eom));
+                      chunked, std::move(data), eom));
     m_sendStarted = true;
   } else {
     m_server->putResponseMessage(
       ResponseMessage(shared_from_this(),
                       ResponseMessage::Type::BODY, 0,
-                      chunked, data, size, eom));
+                      chunked, std::move(data), eom));
   }
 
   if (eom) {
@@ -770,7 +777,9 @@ int64_t ProxygenTransport::pushResource(const char *host, const char *path,
   m_server->putResponseMessage(
     ResponseMessage(shared_from_this(),
                     ResponseMessage::Type::HEADERS,
-                    pushId, false, data, size, eom));
+                    pushId, false,
+                    StringHolder(static_cast<const char*>(data), size),
+                    eom));
   return pushId;
 }
 
@@ -781,7 +790,9 @@ void ProxygenTransport::pushResourceBody(int64_t id, const void *data,
   }
   m_server->putResponseMessage(
     ResponseMessage(shared_from_this(), ResponseMessage::Type::BODY,
-                    id, false, data, size, eom));
+                    id, false,
+                    StringHolder(static_cast<const char*>(data), size),
+                    eom));
 }
 
 void ProxygenTransport::beginPartialPostEcho() {
@@ -49,16 +49,18 @@ struct ResponseMessage {
 
   explicit ResponseMessage(std::shared_ptr<ProxygenTransport> transport,
                            Type t, uint64_t pushId = 0, bool chunked = true,
-                           const void *data = nullptr, int size = 0,
+                           StringHolder&& data = StringHolder(nullptr, 0),
                            bool eom = false)
     : m_transport(transport),
       m_type(t),
       m_pushId(pushId),
       m_chunked(chunked),
       m_eom(eom) {
-    if (size > 0 && (m_type == Type::BODY || m_type == Type::HEADERS)) {
-        // sad panda copy.  TODO (t4362832): change sendImpl to take IOBuf
-        m_chunk = folly::IOBuf::copyBuffer(data, size);
+    if (data.size() > 0 && (m_type == Type::BODY || m_type == Type::HEADERS)) {
+        // Take the buffer without copying when the holder owns it.  Borrowed
+        // buffers are still copied here, since the dispatch thread keeps
+        // ownership of them.
+        m_chunk = data.detachIOBuf();
       }
     };
 
@@ -184,6 +186,13 @@ struct ProxygenTransport final
   void sendImpl(const void *data, int size, int code,
                 bool chunked, bool eom) override;
 
+  /**
+   * Send back a response, taking ownership of the buffer so it crosses to
+   * the I/O thread without being copied.
+   */
+  void sendImpl(StringHolder&& data, int code, bool chunked,
+                bool eom) override;
+
   /**
    * Override to implement more send end logic.
    */
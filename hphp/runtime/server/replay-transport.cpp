@@ -17,9 +17,12 @@
 #include <folly/Conv.h>
 
 #include "hphp/runtime/base/string-util.h"
+#include "hphp/runtime/base/timestamp.h"
 #include "hphp/runtime/base/zend-functions.h"
+#include "hphp/runtime/base/zend-math.h"
 #include "hphp/runtime/base/zend-string.h"
 #include "hphp/runtime/base/config.h"
+#include "hphp/runtime/ext/apc/ext_apc.h"
 #include "hphp/runtime/server/http-protocol.h"
 #include "hphp/util/process.h"
 #include "hphp/util/safe-cast.h"
@@ -40,6 +43,9 @@ void ReplayTransport::recordInput(Transport* transport, const char *filename) {
   snprintf(buf, sizeof(buf), "%u", Process::GetThreadPid());
   hdf["tpid"] = std::string(buf);
 
+  hdf["time"] = TimeStamp::Current();
+  hdf["rand_seed"] = math_generate_seed();
+
   hdf["cmd"] = static_cast<int>(transport->getMethod());
   hdf["url"] = transport->getUrl();
   hdf["remote_host"] = transport->getRemoteHost();
@@ -68,6 +74,45 @@ void ReplayTransport::recordInput(Transport* transport, const char *filename) {
   hdf.write(filename);
 }
 
+void ReplayTransport::appendSessionData(
+    const std::string &filename,
+    const std::vector<std::pair<std::string,std::string>> &apcReads) {
+  Hdf hdf(filename);
+  int index = 0;
+  for (auto const& read : apcReads) {
+    Hdf entry = hdf["apc"][index++];
+    entry["key"] = read.first;
+    entry["value"] = read.second;
+  }
+  hdf.write(filename);
+}
+
+bool ReplayTransport::primeSessionState() {
+  auto& store = apc_store();
+  auto apc_callback = [&](const IniSetting::Map& ini_a, const Hdf& hdf_a,
+                          const std::string& /*ini_a_key*/) {
+    auto const key = Config::GetString(ini_a, hdf_a, "key", "", false);
+    String data = StringUtil::UUDecode(
+      Config::GetString(ini_a, hdf_a, "value", "", false));
+    // add() rather than set(): if the request read the same key more than
+    // once, the value it observed first wins.
+    store.add(String(key), apc_unserialize(data.data(), data.size()), 0);
+  };
+  Config::Iterate(apc_callback, m_ini, m_hdf, "apc", false);
+
+  auto const seed = Config::GetInt64(m_ini, m_hdf, "rand_seed", -1, false);
+  if (seed >= 0) {
+    math_mt_srand(static_cast<uint32_t>(seed));
+  }
+
+  auto const time = Config::GetInt64(m_ini, m_hdf, "time", 0, false);
+  if (time > 0) {
+    TimeStamp::SetReplayTime(time);
+    return true;
+  }
+  return false;
+}
+
 void ReplayTransport::replayInput(const char *filename) {
   std::string fname = filename;
   Config::ParseConfigFile(fname, m_ini, m_hdf);
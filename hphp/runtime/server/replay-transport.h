@@ -17,6 +17,9 @@
 #ifndef incl_HPHP_REPLAY_TRANSPORT_H_
 #define incl_HPHP_REPLAY_TRANSPORT_H_
 
+#include <utility>
+#include <vector>
+
 #include "hphp/runtime/server/transport.h"
 #include "hphp/runtime/base/ini-setting.h"
 #include "hphp/runtime/base/req-root.h"
@@ -40,6 +43,20 @@ struct ReplayTransport final : Transport {
   void replayInput(const char *filename);
   void replayInput(Hdf hdf);
 
+  /**
+   * Session-state capture and replay. appendSessionData() adds the APC
+   * reads captured while recording a request to its bundle (a key plus a
+   * uuencoded serialized value per entry). primeSessionState() restores
+   * that state before replaying the request: primes the captured values
+   * into APC, reseeds the random generator, and pins this thread's clock
+   * to the recorded time. Returns true if the clock was pinned; the
+   * caller must TimeStamp::ClearReplayTime() once the request finishes.
+   */
+  static void appendSessionData(
+    const std::string &filename,
+    const std::vector<std::pair<std::string,std::string>> &apcReads);
+  bool primeSessionState();
+
   /**
    * Implementing Transport...
    */
@@ -354,6 +354,7 @@ void ServerStats::GetKeys(string& out) {
   CollectSlots(slots);
   set<string> allKeys;
   GetAllKeys(allKeys, slots);
+  FreeSlots(slots);
   for (auto const& iter : allKeys) {
     out += iter;
     out += "\n";
@@ -372,6 +373,29 @@ void ServerStats::Report(string& out,
   FreeSlots(slots);
 }
 
+void ServerStats::ReportSnapshot(string& out) {
+  list<TimeSlot*> slots;
+  CollectSlots(slots);
+
+  TimeSlot total;
+  total.m_time = 0;
+  total.m_hits = 0;
+  for (auto const& s : slots) {
+    total.m_hits += s->m_hits;
+    Merge(total.m_values, s->m_values);
+  }
+  FreeSlots(slots);
+
+  std::ostringstream o;
+  o << "{\"hit\": " << total.m_hits;
+  for (auto const& kvpair : total.m_values) {
+    o << ", " << Writer::escape_for_json(kvpair.first.c_str())
+      << ": " << kvpair.second;
+  }
+  o << "}\n";
+  out = o.str();
+}
+
 void ServerStats::Report(string& output,
                          const list<TimeSlot*>& slots,
                          const std::string& prefix) {
@@ -594,7 +618,7 @@ ServerStats::ThreadStatus::ThreadStatus()
   memset(m_vhost, 0, sizeof(m_vhost));
 }
 
-ServerStats::ServerStats() : m_last(0), m_min(0), m_max(0) {
+ServerStats::ServerStats() : m_last(0), m_min(0), m_max(0), m_pendingHits(0) {
   m_slots.resize(RuntimeOption::StatsMaxSlot);
   clear();
 
@@ -639,8 +663,15 @@ void ServerStats::logPage(const string& /*url*/, int /*code*/) {
   int64_t now = time(nullptr) / RuntimeOption::StatsSlotDuration;
   int slot = now % RuntimeOption::StatsMaxSlot;
 
-  {
-    Lock lock(m_lock, false);
+  if (!m_lock.tryLock()) {
+    // A monitoring scrape (collect()/clear()) holds our lock.  Never
+    // make a request thread wait for it: park this page's counters and
+    // fold them into a slot on a later page, accepting that they may
+    // land in a slightly newer time bucket.  Only this thread touches
+    // the pending buffer, so no lock is needed for it.
+    Merge(m_pendingValues, m_values);
+    m_pendingHits++;
+  } else {
     int count = 0;
     for (int64_t t = m_last + 1; t < now; t++) {
       m_slots[t % RuntimeOption::StatsMaxSlot].m_time = 0;
@@ -657,16 +688,22 @@ void ServerStats::logPage(const string& /*url*/, int /*code*/) {
       ts.m_hits = 0;
       ts.m_values.clear();
     }
-    ts.m_hits++;
+    ts.m_hits += 1 + m_pendingHits;
+    m_pendingHits = 0;
+    if (!m_pendingValues.empty()) {
+      Merge(ts.m_values, m_pendingValues);
+      m_pendingValues.clear();
+    }
     Merge(ts.m_values, m_values);
-  }
+    m_lock.unlock();
 
-  m_last = now;
-  if (m_min == 0) {
-    m_min = now;
-  }
-  if (m_max < now) {
-    m_max = now;
+    m_last = now;
+    if (m_min == 0) {
+      m_min = now;
+    }
+    if (m_max < now) {
+      m_max = now;
+    }
   }
 
   m_threadStatus.m_mode = ThreadMode::Idling;
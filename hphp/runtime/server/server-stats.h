@@ -51,6 +51,14 @@ public:
                      const std::string& keys,
                      const std::string& prefix);
 
+  /**
+   * One flat JSON object totalling every key over all slots.  Collection
+   * never blocks request threads (see logPage()), so this is safe to
+   * scrape aggressively; the numbers are only as consistent as the
+   * per-thread merges that have already landed.
+   */
+  static void ReportSnapshot(std::string& out);
+
   // thread status functions
   static void LogBytes(int64_t bytes);
   static void StartRequest(const char *url, const char *clientIP,
@@ -122,6 +130,12 @@ private:
   int64_t m_max;  // latest timepoint
   CounterMap m_values;  // current page's name value pairs
 
+  // Pages whose counters couldn't be folded into a slot because a
+  // monitoring scrape held m_lock; owned by this thread only, merged on
+  // the next page that gets the lock.
+  CounterMap m_pendingValues;
+  int m_pendingHits;
+
   // general health-level of local server
   static HealthLevel m_ServerHealthLevel;
 
@@ -65,7 +65,7 @@ struct ServerTaskEvent final : AsioExternalThreadEvent {
   }
 
  private:
-  TTransport *m_job;
+  TTransport *m_job{nullptr};
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -44,7 +44,8 @@ private:
 
 template <typename JobPtr, typename TransportTraits>
 struct ServerWorker
-  : JobQueueWorker<JobPtr,Server*,true,false,JobQueueDropVMStack>
+  : JobQueueWorker<JobPtr,Server*,true,false,JobQueueDropVMStack,
+                   true /* stealing */>
 {
   ServerWorker() {}
   ~ServerWorker() override {}
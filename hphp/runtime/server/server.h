@@ -295,6 +295,16 @@ public:
     return false;
   }
 
+  /**
+   * Re-read the TLS session ticket seed file and apply the new seeds to
+   * the running acceptors, so tickets issued fleet-wide stay mutually
+   * resumable across seed rotation.  Returns false if the server doesn't
+   * support ticket seeds or the file couldn't be loaded.
+   */
+  virtual bool reloadTLSTicketSeeds() {
+    return false;
+  }
+
 protected:
   std::string m_address;
   int m_port;
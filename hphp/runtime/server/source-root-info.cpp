@@ -26,6 +26,12 @@
 #include "hphp/runtime/server/http-request-handler.h"
 #include "hphp/runtime/server/transport.h"
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 using std::map;
 
 namespace HPHP {
@@ -36,6 +42,101 @@ IMPLEMENT_THREAD_LOCAL_NO_CHECK(std::string, SourceRootInfo::s_phproot);
 
 const StaticString s_default("default");
 const StaticString s___builtin("__builtin");
+
+namespace {
+
+/*
+ * Parsed per-sandbox configuration, shared across requests.
+ *
+ * Sandbox mode used to read and re-parse the user's conf file on every
+ * request even though it almost never changes. Instead we keep one
+ * immutable snapshot per (home dir, sandbox) that requests pick up by
+ * shared_ptr; the snapshot is revalidated against the conf file's mtime
+ * and size, so an edit still shows up on the next request. Per-request
+ * state (thread logs, $_SERVER additions) is derived from the snapshot
+ * each time.
+ */
+struct SandboxConfig {
+  time_t mtime{0};
+  off_t fileSize{0};
+  bool error{false};
+  std::string userOverride;
+  std::string path;
+  std::string logPath;
+  std::string accessLogPath;
+  std::vector<std::pair<std::string, std::string>> serverVars;
+};
+
+std::mutex s_sandbox_config_mutex;
+std::unordered_map<std::string, std::shared_ptr<const SandboxConfig>>
+  s_sandbox_configs;
+
+std::shared_ptr<const SandboxConfig>
+parseSandboxConfig(const String& homePath, const std::string& confFileName,
+                   const String& sandbox, time_t mtime, off_t fileSize) {
+  auto config = std::make_shared<SandboxConfig>();
+  config->mtime = mtime;
+  config->fileSize = fileSize;
+
+  IniSetting::Map ini = IniSetting::Map::object;
+  Hdf hdf;
+  String sp, lp, alp, userOverride;
+  try {
+    // These settings are NOT system settings.
+    Config::ParseConfigFile(confFileName, ini, hdf, false);
+    // Do not prepend "hhvm." to these when accessing.
+    userOverride = Config::Get(ini, hdf, "user_override", "", false);
+    sp = Config::Get(ini, hdf, (sandbox + ".path").c_str(), "", false);
+    lp = Config::Get(ini, hdf, (sandbox + ".log").c_str(), "", false);
+    alp = Config::Get(ini, hdf, (sandbox + ".accesslog").c_str(), "", false);
+  } catch (HdfException &e) {
+    Logger::Error("%s ignored: %s", confFileName.c_str(),
+                  e.getMessage().c_str());
+  }
+  auto sandbox_servervars_callback = [&] (const IniSetting::Map &ini_ss,
+                                          const Hdf &hdf_ss,
+                                          const std::string &ini_ss_key) {
+    std::string name = hdf_ss.exists() && !hdf_ss.isEmpty()
+                     ? hdf_ss.getName()
+                     : ini_ss_key;
+    config->serverVars.emplace_back(std::move(name),
+                                    Config::GetString(ini_ss, hdf_ss));
+  };
+  Config::Iterate(sandbox_servervars_callback, ini, hdf,
+                  (sandbox + ".ServerVars").c_str());
+  if (!userOverride.empty()) {
+    config->userOverride = userOverride.toCppString();
+  }
+  if (sandbox == s_default) {
+    if (sp.isNull()) {
+      sp = "www/";
+    }
+  }
+  if (sp.isNull()) {
+    config->error = true;
+    return config;
+  }
+  String path = sp.charAt(0) == '/' ? sp : homePath + sp;
+  if (path.charAt(path.size() - 1) != '/') {
+    path += "/";
+  }
+  config->path = path.toCppString();
+  if (!lp.isNull()) {
+    if (lp.charAt(0) != '/') {
+      lp = homePath + lp;
+    }
+    config->logPath = lp.toCppString();
+  }
+  if (!alp.isNull()) {
+    if (alp.charAt(0) != '/') {
+      alp = homePath + alp;
+    }
+    config->accessLogPath = alp.toCppString();
+  }
+  return config;
+}
+
+}
 SourceRootInfo::SourceRootInfo(Transport* transport)
     : m_sandboxCond(RuntimeOption::SandboxMode ? SandboxCondition::On :
                                                  SandboxCondition::Off) {
@@ -132,69 +233,60 @@ void SourceRootInfo::createFromUserConfig() {
 
   std::string confFileName = std::string(homePath.c_str()) +
     RuntimeOption::SandboxConfFile;
-  IniSetting::Map ini = IniSetting::Map::object;
-  Hdf config;
-  String sp, lp, alp, userOverride;
-  try {
-    // These settings are NOT system settings.
-    Config::ParseConfigFile(confFileName, ini, config, false);
-    // Do not prepend "hhvm." to these when accessing.
-    userOverride = Config::Get(ini, config, "user_override", "", false);
-    sp = Config::Get(ini, config, (m_sandbox + ".path").c_str(), "", false);
-    lp = Config::Get(ini, config, (m_sandbox + ".log").c_str(), "", false);
-    alp = Config::Get(
-        ini, config, (m_sandbox + ".accesslog").c_str(), "", false
-    );
-  } catch (HdfException &e) {
-    Logger::Error("%s ignored: %s", confFileName.c_str(),
-                  e.getMessage().c_str());
-  }
-  auto sandbox_servervars_callback = [&] (const IniSetting::Map &ini_ss,
-                                          const Hdf &hdf_ss,
-                                          const std::string &ini_ss_key) {
-    std::string name = hdf_ss.exists() && !hdf_ss.isEmpty()
-                     ? hdf_ss.getName()
-                     : ini_ss_key;
-    m_serverVars.set(String(name), String(Config::GetString(ini_ss, hdf_ss)));
-  };
-  Config::Iterate(sandbox_servervars_callback, ini, config,
-                  (m_sandbox + ".ServerVars").c_str());
-  if (!userOverride.empty()) {
-    m_user = std::move(userOverride);
+
+  time_t mtime = 0;
+  off_t fileSize = 0;
+  {
+    struct stat cstat;
+    if (stat(confFileName.c_str(), &cstat) == 0) {
+      mtime = cstat.st_mtime;
+      fileSize = cstat.st_size;
+    }
   }
-  if (m_sandbox == s_default) {
-    if (sp.isNull()) {
-      sp = "www/";
+
+  // Reuse the published snapshot for this sandbox unless the conf file
+  // changed underneath it.
+  auto const cacheKey = std::string(homePath.c_str()) +
+    std::string(m_sandbox.c_str());
+  std::shared_ptr<const SandboxConfig> config;
+  {
+    std::lock_guard<std::mutex> lock(s_sandbox_config_mutex);
+    auto it = s_sandbox_configs.find(cacheKey);
+    if (it != s_sandbox_configs.end() &&
+        it->second->mtime == mtime &&
+        it->second->fileSize == fileSize) {
+      config = it->second;
     }
   }
-  if (sp.isNull()) {
-    m_sandboxCond = SandboxCondition::Error;
-    return;
+  if (!config) {
+    config = parseSandboxConfig(homePath, confFileName, m_sandbox,
+                                mtime, fileSize);
+    std::lock_guard<std::mutex> lock(s_sandbox_config_mutex);
+    s_sandbox_configs[cacheKey] = config;
   }
-  if (sp.charAt(0) == '/') {
-    m_path = std::move(sp);
-  } else {
-    m_path = homePath + sp;
+
+  for (auto& var : config->serverVars) {
+    m_serverVars.set(String(var.first), String(var.second));
   }
-  if (m_path.charAt(m_path.size() - 1) != '/') {
-    m_path += "/";
+  if (!config->userOverride.empty()) {
+    m_user = String(config->userOverride);
   }
-  if (!lp.isNull()) {
-    if (lp.charAt(0) != '/') {
-      lp = homePath + lp;
-    }
-    if (!Logger::SetThreadLog(lp.c_str(), false)) {
+  if (config->error) {
+    m_sandboxCond = SandboxCondition::Error;
+    return;
+  }
+  m_path = String(config->path);
+  if (!config->logPath.empty()) {
+    if (!Logger::SetThreadLog(config->logPath.c_str(), false)) {
       Logger::Warning("Sandbox error log %s could not be opened",
-                      lp.c_str());
+                      config->logPath.c_str());
     }
   }
-  if (!alp.isNull()) {
-    if (alp.charAt(0) != '/') {
-      alp = homePath + alp;
-    }
-    if (!HttpRequestHandler::GetAccessLog().setThreadLog(alp.c_str())) {
+  if (!config->accessLogPath.empty()) {
+    if (!HttpRequestHandler::GetAccessLog().setThreadLog(
+          config->accessLogPath.c_str())) {
       Logger::Warning("Sandbox access log %s could not be opened",
-                      alp.c_str());
+                      config->accessLogPath.c_str());
     }
   }
 }
@@ -15,8 +15,15 @@
 */
 
 #include "hphp/runtime/server/static-content-cache.h"
+
+#include <algorithm>
+
+#include <enc/encode.h>
+#include <folly/Bits.h>
+
 #include "hphp/runtime/base/runtime-option.h"
 #include "hphp/util/boot-stats.h"
+#include "hphp/util/brotli.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/process.h"
 #include "hphp/util/compression.h"
@@ -27,6 +34,72 @@ namespace HPHP {
 StaticContentCache StaticContentCache::TheCache;
 std::shared_ptr<FileCache> StaticContentCache::TheFileCache;
 
+namespace {
+
+// Matches the compression level FileCache used when it gzipped the entry.
+const int kGzipLevel = 9;
+
+// Keep a variant only if it actually pays for itself, using the same
+// rule FileCache applies at archive build time.
+bool sufficientlyCompressed(int origSize, int newSize) {
+  return newSize < origSize * 0.75;
+}
+
+std::shared_ptr<std::string> buildPlain(const char* gzipped, int len) {
+  int plainLen = len;
+  char* plain = gzdecode(gzipped, plainLen);
+  if (!plain) {
+    Logger::Error("cannot unzip precompressed static content");
+    return nullptr;
+  }
+  auto ret = std::make_shared<std::string>(plain, plainLen);
+  free(plain);
+  return ret;
+}
+
+std::shared_ptr<std::string> buildGzip(const char* plain, int len) {
+  int gzLen = len;
+  char* gz = gzencode(plain, gzLen, kGzipLevel, CODING_GZIP);
+  if (!gz) return nullptr;
+  if (!sufficientlyCompressed(len, gzLen)) {
+    free(gz);
+    return nullptr;
+  }
+  auto ret = std::make_shared<std::string>(gz, gzLen);
+  free(gz);
+  return ret;
+}
+
+std::shared_ptr<std::string> buildBrotli(const char* plain, int len) {
+  if (len <= 0) return nullptr;
+  brotli::BrotliParams params;
+  params.mode =
+      (brotli::BrotliParams::Mode)RuntimeOption::BrotliCompressionMode;
+  params.quality = RuntimeOption::BrotliCompressionQuality;
+  // The whole entry is one block, so cap the window at what the reader
+  // will ever need (see Transport::compressBrotli).
+  params.lgwin = std::min(
+      static_cast<unsigned int>(RuntimeOption::BrotliCompressionLgWindowSize),
+      folly::findLastSet(static_cast<unsigned int>(len) - 1));
+  brotli::BrotliCompressor compressor(params);
+
+  size_t brLen = len;
+  auto br = HPHP::compressBrotli(&compressor, plain, brLen, true);
+  if (!br) {
+    Logger::Error("cannot compress static content to brotli: len=%d", len);
+    return nullptr;
+  }
+  if (!sufficientlyCompressed(len, static_cast<int>(brLen))) {
+    free((void*)br);
+    return nullptr;
+  }
+  auto ret = std::make_shared<std::string>(br, brLen);
+  free((void*)br);
+  return ret;
+}
+
+}
+
 void StaticContentCache::load() {
   BootStats::Block timer("loading static content");
 
@@ -48,5 +121,97 @@ bool StaticContentCache::find(const std::string &name, const char *&data,
   return false;
 }
 
+const std::string *StaticContentCache::getPlain(const std::string &name,
+                                                const char *gzipped,
+                                                int len) const {
+  {
+    VariantMap::const_accessor acc;
+    if (m_plainVariants.find(acc, name)) return acc->second.get();
+  }
+  VariantMap::accessor acc;
+  if (m_plainVariants.insert(acc, name)) {
+    acc->second = buildPlain(gzipped, len);
+  }
+  return acc->second.get();
+}
+
+const std::string *StaticContentCache::getGzip(const std::string &name,
+                                               const char *plain,
+                                               int len) const {
+  {
+    VariantMap::const_accessor acc;
+    if (m_gzipVariants.find(acc, name)) return acc->second.get();
+  }
+  VariantMap::accessor acc;
+  if (m_gzipVariants.insert(acc, name)) {
+    acc->second = buildGzip(plain, len);
+  }
+  return acc->second.get();
+}
+
+const std::string *StaticContentCache::getBrotli(const std::string &name,
+                                                 const char *plain,
+                                                 int len) const {
+  {
+    VariantMap::const_accessor acc;
+    if (m_brotliVariants.find(acc, name)) return acc->second.get();
+  }
+  VariantMap::accessor acc;
+  if (m_brotliVariants.insert(acc, name)) {
+    acc->second = buildBrotli(plain, len);
+  }
+  return acc->second.get();
+}
+
+bool StaticContentCache::find(const std::string &name, bool acceptsGzip,
+                              bool acceptsBrotli, const char *&data,
+                              int &len, Encoding &encoding) const {
+  const char *raw;
+  int rawLen;
+  bool rawCompressed = false;
+  if (!find(name, raw, rawLen, rawCompressed)) return false;
+
+  // The archive stores at most one gzipped copy of each entry; other
+  // encodings are derived from it on first use.  Resolve the plain bytes
+  // once, since both the brotli variant and identity responses need them.
+  const char *plain = raw;
+  int plainLen = rawLen;
+  if (rawCompressed) {
+    auto const p = getPlain(name, raw, rawLen);
+    if (!p) return false;
+    plain = p->data();
+    plainLen = p->size();
+  }
+
+  if (acceptsBrotli) {
+    if (auto const v = getBrotli(name, plain, plainLen)) {
+      data = v->data();
+      len = v->size();
+      encoding = Encoding::Brotli;
+      return true;
+    }
+  }
+
+  if (acceptsGzip) {
+    if (rawCompressed) {
+      data = raw;
+      len = rawLen;
+      encoding = Encoding::Gzip;
+      return true;
+    }
+    if (auto const v = getGzip(name, plain, plainLen)) {
+      data = v->data();
+      len = v->size();
+      encoding = Encoding::Gzip;
+      return true;
+    }
+  }
+
+  data = plain;
+  len = plainLen;
+  encoding = Encoding::None;
+  return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 }
@@ -18,6 +18,9 @@
 #define incl_HPHP_STATIC_CONTENT_CACHE_H_
 
 #include <memory>
+#include <string>
+
+#include <tbb/concurrent_hash_map.h>
 
 #include "hphp/runtime/base/string-buffer.h"
 #include "hphp/util/file-cache.h"
@@ -30,6 +33,8 @@ struct StaticContentCache {
   static std::shared_ptr<FileCache> TheFileCache;
 
 public:
+  enum class Encoding { None, Gzip, Brotli };
+
   /**
    * Load all registered static files from RuntimeOption::DocumentRoot.
    */
@@ -40,6 +45,34 @@ public:
    */
   bool find(const std::string &name, const char *&data, int &len,
             bool &compressed) const;
+
+  /**
+   * Find a file, preferring whichever precompressed variant the client
+   * accepts (brotli over gzip, mirroring the transport's preference).
+   * Variants are built the first time they are needed and kept forever;
+   * the backing cache is write-once, so they can never go stale, and the
+   * returned pointer stays valid for the life of the process.
+   */
+  bool find(const std::string &name, bool acceptsGzip, bool acceptsBrotli,
+            const char *&data, int &len, Encoding &encoding) const;
+
+private:
+  // Memoized alternate encodings of cache entries, keyed by name.  A
+  // nullptr value records that building the variant failed (or wasn't
+  // worthwhile), so we don't retry on every request.
+  using VariantMap = tbb::concurrent_hash_map<std::string,
+                                              std::shared_ptr<std::string>>;
+
+  const std::string *getPlain(const std::string &name,
+                              const char *gzipped, int len) const;
+  const std::string *getGzip(const std::string &name,
+                             const char *plain, int len) const;
+  const std::string *getBrotli(const std::string &name,
+                               const char *plain, int len) const;
+
+  mutable VariantMap m_plainVariants;
+  mutable VariantMap m_gzipVariants;
+  mutable VariantMap m_brotliVariants;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
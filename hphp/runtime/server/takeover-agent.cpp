@@ -53,6 +53,11 @@
 #define C_TERM_OK  "\x05"
 #define C_TERM_BAD "\x06"
 #define C_UNKNOWN  "\x07"
+// Warmth transfer requests; both are answered with C_FD_RESP.  Old
+// servers that predate them answer C_UNKNOWN, which the new server
+// treats as "nothing to inherit".
+#define C_APC_REQ  "\x08"
+#define C_JIT_REQ  "\x09"
 
 namespace HPHP {
 
@@ -94,7 +99,9 @@ TakeoverAgent::TakeoverAgent(const std::string &fname)
 const StaticString
   s_ver_C_FD_REQ(P_VERSION C_FD_REQ),
   s_ver_C_TERM_REQ(P_VERSION C_TERM_REQ),
-  s_ver_C_TERM_OK(P_VERSION C_TERM_OK);
+  s_ver_C_TERM_OK(P_VERSION C_TERM_OK),
+  s_ver_C_APC_REQ(P_VERSION C_APC_REQ),
+  s_ver_C_JIT_REQ(P_VERSION C_JIT_REQ);
 
 int TakeoverAgent::afdtRequest(String request, String* response) {
 #ifdef _MSC_VER
@@ -107,6 +114,15 @@ int TakeoverAgent::afdtRequest(String request, String* response) {
     m_takeover_state = TakeoverState::Started;
     m_callback->onTakeoverRequest(RequestType::LISTEN_SOCKET);
     return m_sock;
+  } else if (request == s_ver_C_APC_REQ) {
+    Logger::Info("takeover: request is an APC snapshot request");
+    // Read-only from our side; doesn't commit us to a takeover.
+    *response = P_VERSION C_FD_RESP;
+    return m_callback->onTakeoverRequest(RequestType::APC_SNAPSHOT);
+  } else if (request == s_ver_C_JIT_REQ) {
+    Logger::Info("takeover: request is a JIT profile request");
+    *response = P_VERSION C_FD_RESP;
+    return m_callback->onTakeoverRequest(RequestType::JIT_PROFILE);
   } else if (request == s_ver_C_TERM_REQ) {
     Logger::Info("takeover: request is a terminate request");
     // It is a little bit of a hack to use an AFDT request/response
@@ -212,6 +228,52 @@ int TakeoverAgent::takeover(std::chrono::seconds timeoutSec) {
 #endif
 }
 
+int TakeoverAgent::requestWarmthFd(RequestType type,
+                                   std::chrono::seconds timeoutSec) {
+#ifdef _MSC_VER
+  return -1;
+#else
+  assert(m_took_over);
+  const uint8_t* request;
+  const char* what;
+  switch (type) {
+    case RequestType::APC_SNAPSHOT:
+      request = (const uint8_t*)P_VERSION C_APC_REQ;
+      what = "APC snapshot";
+      break;
+    case RequestType::JIT_PROFILE:
+      request = (const uint8_t*)P_VERSION C_JIT_REQ;
+      what = "JIT profile";
+      break;
+    default:
+      return -1;
+  }
+
+  Logger::Info("takeover: requesting %s from old server", what);
+  uint8_t response[3] = {0,0,0};
+  uint32_t response_len = sizeof(response);
+  int fd = -1;
+  afdt_error_t err = AFDT_ERROR_T_INIT;
+  struct timeval timeout = { timeoutSec.count() , 0 };
+  int ret = afdt_sync_client(m_transfer_fname.c_str(),
+                             request,
+                             2, // P_VERSION plus the code byte
+                             response,
+                             &response_len,
+                             &fd,
+                             &timeout,
+                             &err);
+  if (ret < 0 || fd < 0) {
+    // This includes old servers that predate the warmth protocol; the
+    // new server just warms up from scratch, as before.
+    Logger::Info("takeover: old server has no %s for us", what);
+    return -1;
+  }
+  Logger::Info("takeover: inherited %s fd %d", what, fd);
+  return fd;
+#endif
+}
+
 void TakeoverAgent::requestShutdown() {
 #ifndef _MSC_VER
   if (m_took_over) {
@@ -46,12 +46,18 @@ struct TakeoverAgent {
   enum class RequestType {
     LISTEN_SOCKET,
     TERMINATE,
+    // Warmth transfer: fds the old server hands over so the new one
+    // can skip part of its warmup.
+    APC_SNAPSHOT,   // the mapped APC prime snapshot
+    JIT_PROFILE,    // the serialized hot-function profile
    };
 
   struct Callback {
     virtual ~Callback() {}
-    // Called by the TakeoverAgent when it receives a request for takeover
-    // Returns non zero on error, which terminates the takeover action
+    // Called by the TakeoverAgent when it receives a request for takeover.
+    // For LISTEN_SOCKET and TERMINATE, returns non zero on error, which
+    // terminates the takeover action.  For the warmth request types, the
+    // return value is the fd to send to the new server (-1 for none).
     virtual int onTakeoverRequest(RequestType type) = 0;
 
     // Called by the TakeoverAgent when it is shutdown mid-way through a
@@ -64,6 +70,12 @@ struct TakeoverAgent {
   // execute a takeover and return the fd.  -1 if an fd could not be acquired
   int takeover(std::chrono::seconds timeout = std::chrono::seconds(2));
 
+  // ask the old server for a warmth fd (APC_SNAPSHOT or JIT_PROFILE).
+  // Only valid after a successful takeover().  Returns -1 if the old
+  // server has nothing to offer (or predates the warmth protocol).
+  int requestWarmthFd(RequestType type,
+                      std::chrono::seconds timeout = std::chrono::seconds(2));
+
   // instruct the old server to shutdown
   void requestShutdown();
 
@@ -31,6 +31,7 @@
 #include "hphp/runtime/base/tv-type.h"
 #include "hphp/runtime/server/access-log.h"
 #include "hphp/runtime/server/http-protocol.h"
+#include "hphp/runtime/server/virtual-host.h"
 #include "hphp/runtime/ext/openssl/ext_openssl.h"
 #include "hphp/runtime/ext/string/ext_string.h"
 #include "hphp/util/brotli.h"
@@ -59,8 +60,11 @@ Transport::Transport()
     m_chunkedEncoding(false), m_headerSent(false),
     m_responseCode(-1), m_firstHeaderSet(false), m_firstHeaderLine(0),
     m_responseSize(0), m_responseTotalSize(0), m_responseSentSize(0),
-    m_flushTimeUs(0), m_sendEnded(false), m_sendContentType(true),
-    m_encodingType(CompressionType::Max), m_isSSL(false),
+    m_flushTimeUs(0), m_sendEnded(false),
+    m_coalescedDeadline(0), m_rawBytesSent(0), m_coalescedCode(200),
+    m_sendContentType(true),
+    m_encodingType(CompressionType::Max), m_staticResponse(false),
+    m_staticEncoding(CompressionType::Max), m_isSSL(false),
     m_compressionDecision(CompressionDecision::NotDecidedYet),
     m_threadType(ThreadType::RequestThread) {
   memset(&m_queueTime, 0, sizeof(m_queueTime));
@@ -853,7 +857,9 @@ StringHolder Transport::prepareResponse(const void* data,
                                         int size,
                                         bool& compressed,
                                         bool last) {
-  StringHolder response((const char*)data, size);
+  StringHolder response((const char*)data, size,
+                        m_staticResponse ? StringHolder::StrImmortal
+                                         : StringHolder::StrNoFree);
 
   // we don't use chunk encoding to send anything pre-compressed
   assert(!compressed || !m_chunkedEncoding);
@@ -863,8 +869,10 @@ StringHolder Transport::prepareResponse(const void* data,
   }
 
   if (compressed) {
-    // pre-compressed responses are always gzip
-    m_encodingType = CompressionType::Gzip;
+    // pre-compressed responses are gzip unless the sender told us
+    // otherwise via setStaticResponse()
+    m_encodingType = m_staticResponse ? m_staticEncoding
+                                      : CompressionType::Gzip;
     return response;
   }
 
@@ -1038,9 +1046,49 @@ void Transport::sendRaw(void *data, int size, int code /* = 200 */,
     assert(!compressed);
   }
 
+  if (chunked && coalesceOutput(data, size, code)) {
+    return;
+  }
+
   sendRawInternal(data, size, code, compressed, codeInfo);
 }
 
+bool Transport::coalesceOutput(const void *data, int size, int code) {
+  auto const vhost = VirtualHost::GetCurrent();
+  if (!vhost) return false;
+  auto const threshold = vhost->getOutputCoalesceBytes();
+  if (threshold <= 0) return false;
+
+  // Time-to-first-byte priority: the head of the response always goes
+  // straight to the wire.
+  if (m_rawBytesSent < vhost->getOutputEagerFirstBytes() ||
+      size >= threshold) {
+    flushCoalesced();
+    return false;
+  }
+
+  auto const now = Timer::GetCurrentTimeMicros();
+  if (m_coalescedOutput.empty()) {
+    m_coalescedDeadline = now + vhost->getOutputCoalesceWindowMicros();
+    m_coalescedCode = code;
+  }
+  m_coalescedOutput.append(static_cast<const char*>(data), size);
+  if ((int64_t)m_coalescedOutput.size() >= threshold ||
+      now >= m_coalescedDeadline) {
+    flushCoalesced();
+  }
+  return true;
+}
+
+void Transport::flushCoalesced() {
+  if (m_coalescedOutput.empty()) return;
+  // Swap out first: sendRawInternal can reenter output handling through the
+  // header callback.
+  std::string out;
+  out.swap(m_coalescedOutput);
+  sendRawInternal(out.data(), out.size(), m_coalescedCode);
+}
+
 void Transport::sendRawInternal(const void *data, int size,
                                 int code /* = 200 */,
                                 bool compressed /* = false */,
@@ -1048,6 +1096,7 @@ void Transport::sendRawInternal(const void *data, int size,
                                ) {
 
   bool chunked = m_chunkedEncoding;
+  m_rawBytesSent += size;
 
   if (!g_context->m_headerCallbackDone &&
       !cellIsNull(&g_context->m_headerCallback)) {
@@ -1081,24 +1130,26 @@ void Transport::sendRawInternal(const void *data, int size,
   }
 
   m_responseSize += response.size();
+  auto const responseSize = response.size();
   ServerStats::SetThreadMode(ServerStats::ThreadMode::Writing);
-  sendImpl(response.data(), response.size(), m_responseCode, chunked, false);
+  sendImpl(std::move(response), m_responseCode, chunked, false);
   ServerStats::SetThreadMode(ServerStats::ThreadMode::Processing);
 
   ServerStats::LogBytes(size);
   if (RuntimeOption::EnableStats && RuntimeOption::EnableWebStats) {
     ServerStats::Log("network.uncompressed", size);
-    ServerStats::Log("network.compressed", response.size());
+    ServerStats::Log("network.compressed", responseSize);
   }
 }
 
 void Transport::onSendEnd() {
+  flushCoalesced();
   bool eomSent = false;
   if ((m_compressor || m_brotliCompressor) && m_chunkedEncoding) {
     assert(m_headerSent);
     bool compressed = false;
     StringHolder response = prepareResponse("", 0, compressed, true);
-    sendImpl(response.data(), response.size(), m_responseCode, true, true);
+    sendImpl(std::move(response), m_responseCode, true, true);
     eomSent = true;
   } else if (!m_headerSent) {
     m_compressionDecision = CompressionDecision::ShouldNot;
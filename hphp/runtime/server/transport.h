@@ -94,6 +94,14 @@ struct Transport : IDebuggable {
     RpcThread,
   };
 
+  // Supported compression types.
+  enum CompressionType {
+    Brotli,
+    BrotliChunked,
+    Gzip,
+    Max,
+  };
+
 public:
   Transport();
   ~Transport() override;
@@ -216,6 +224,18 @@ public:
   void disableCompression();
   bool isCompressionEnabled() const;
 
+  /**
+   * The next response body is a static, process-lifetime buffer that is
+   * already encoded as `encoding' (Max means identity).  The transport
+   * skips its compressors, labels the body with the matching
+   * Content-Encoding, and may hand the buffer to the socket without
+   * copying it, since it never goes away.
+   */
+  void setStaticResponse(CompressionType encoding) {
+    m_staticResponse = true;
+    m_staticEncoding = encoding;
+  }
+
   /**
    * Set cookie response header.
    */
@@ -251,6 +271,17 @@ public:
   virtual void sendImpl(const void *data, int size, int code,
                         bool chunked, bool eom) = 0;
 
+  /**
+   * Ownership-transferring flavor of the above.  Transports that ship the
+   * response off to another thread should override this to take the buffer
+   * without copying it; the default forwards to the raw-pointer flavor
+   * while the holder keeps the buffer alive.
+   */
+  virtual void sendImpl(StringHolder&& response, int code,
+                        bool chunked, bool eom) {
+    sendImpl(response.data(), response.size(), code, chunked, eom);
+  }
+
   /**
    * Override to implement more send end logic.
    */
@@ -391,6 +422,14 @@ private:
   void sendRawInternal(const void *data, int size, int code = 200,
                        bool compressed = false,
                        const char *codeInfo = nullptr);
+  /**
+   * Adaptive flushing of chunked output.  Returns true if the write was
+   * absorbed into the coalescing buffer; the buffer is pushed out once it
+   * reaches the coalescing threshold or its time window expires, and always
+   * before any direct write or the end of the response.
+   */
+  bool coalesceOutput(const void *data, int size, int code);
+  void flushCoalesced();
 public:
   void sendString(const char *data, int code = 200, bool compressed = false,
                   bool chunked = false,
@@ -476,15 +515,14 @@ protected:
   int64_t m_flushTimeUs;
   bool m_sendEnded;
 
+  // coalescing of sub-threshold chunked writes (see coalesceOutput())
+  std::string m_coalescedOutput;
+  int64_t m_coalescedDeadline;
+  int64_t m_rawBytesSent;
+  int m_coalescedCode;
+
   std::vector<int> m_chunksSentSizes;
 
-  // Supported compression types.
-  enum CompressionType {
-    Brotli,
-    BrotliChunked,
-    Gzip,
-    Max,
-  };
   static const char* ENCODING_TYPE_TO_NAME[CompressionType::Max + 1];
   const char* compressionName(CompressionType type);
 
@@ -498,6 +536,10 @@ protected:
   bool m_acceptedEncodings[CompressionType::Max];
   // encoding we decided to use
   CompressionType m_encodingType;
+  // the response body is a process-lifetime buffer, precompressed as
+  // m_staticEncoding (see setStaticResponse())
+  bool m_staticResponse;
+  CompressionType m_staticEncoding;
   std::unique_ptr<StreamCompressor> m_compressor;
   std::unique_ptr<brotli::BrotliCompressor> m_brotliCompressor;
 
@@ -16,6 +16,7 @@
 
 #include "hphp/runtime/server/virtual-host.h"
 
+#include <cstring>
 #include <stdexcept>
 
 #include "hphp/runtime/base/comparisons.h"
@@ -176,6 +177,15 @@ void VirtualHost::initRuntimeOption(const IniSetting::Map& ini, const Hdf& vh) {
       ini,
       vh, "overwrite.ResourceLimit.SerializationSizeLimit",
       StringData::MaxSize, false);
+  int64_t outputCoalesceBytes =
+    Config::GetInt64(ini, vh, "overwrite.Server.OutputCoalesceBytes", -1,
+                     false);
+  int64_t outputCoalesceWindowMicros =
+    Config::GetInt64(ini, vh, "overwrite.Server.OutputCoalesceWindowMicros",
+                     -1, false);
+  int64_t outputEagerFirstBytes =
+    Config::GetInt64(ini, vh, "overwrite.Server.OutputEagerFirstBytes", -1,
+                     false);
   m_runtimeOption.allowedDirectories = Config::GetVector(
     ini,
     vh, "overwrite.Server.AllowedDirectories",
@@ -184,6 +194,9 @@ void VirtualHost::initRuntimeOption(const IniSetting::Map& ini, const Hdf& vh) {
   m_runtimeOption.maxPostSize = maxPostSize;
   m_runtimeOption.uploadMaxFileSize = uploadMaxFileSize;
   m_runtimeOption.serializationSizeLimit = serializationSizeLimit;
+  m_runtimeOption.outputCoalesceBytes = outputCoalesceBytes;
+  m_runtimeOption.outputCoalesceWindowMicros = outputCoalesceWindowMicros;
+  m_runtimeOption.outputEagerFirstBytes = outputEagerFirstBytes;
 
   m_documentRoot = RuntimeOption::SourceRoot + m_pathTranslation;
   if (m_documentRoot.length() > 1 &&
@@ -209,6 +222,23 @@ int VirtualHost::getRequestTimeoutSeconds(int defaultTimeout) const {
     defaultTimeout : m_runtimeOption.requestTimeoutSeconds;
 }
 
+int64_t VirtualHost::getOutputCoalesceBytes() const {
+  return m_runtimeOption.outputCoalesceBytes < 0 ?
+    RuntimeOption::OutputCoalesceBytes : m_runtimeOption.outputCoalesceBytes;
+}
+
+int64_t VirtualHost::getOutputCoalesceWindowMicros() const {
+  return m_runtimeOption.outputCoalesceWindowMicros < 0 ?
+    RuntimeOption::OutputCoalesceWindowMicros :
+    m_runtimeOption.outputCoalesceWindowMicros;
+}
+
+int64_t VirtualHost::getOutputEagerFirstBytes() const {
+  return m_runtimeOption.outputEagerFirstBytes < 0 ?
+    RuntimeOption::OutputEagerFirstBytes :
+    m_runtimeOption.outputEagerFirstBytes;
+}
+
 VirtualHost::VirtualHost() : m_disabled(false) {
   IniSetting::Map ini = IniSetting::Map::object;
   Hdf empty;
@@ -223,6 +253,34 @@ VirtualHost::VirtualHost(const IniSetting::Map& ini, const Hdf& vh,
   init(ini, vh, ini_key);
 }
 
+/*
+ * Extract the literal prefix any subject matching `pattern' must start
+ * with.  `pattern' is a '#'-delimited PCRE produced by format_pattern().
+ * Returns an empty string for unanchored patterns or patterns beginning
+ * with a regex construct, in which case no prefiltering is possible.
+ */
+static std::string literal_prefix(const StringData* pattern) {
+  auto const data = pattern->data();
+  auto const len = pattern->size();
+  if (len < 3 || data[0] != '#' || data[1] != '^') return std::string();
+  std::string prefix;
+  for (auto i = 2; i < len; i++) {
+    switch (data[i]) {
+      case '\\': case '.': case '[': case ']': case '(': case ')':
+      case '|': case '$': case '^': case '+': case '#':
+        return prefix;
+      case '*': case '?': case '{':
+        /* The quantifier applies to the previous character, which is
+         * therefore optional. */
+        if (!prefix.empty()) prefix.pop_back();
+        return prefix;
+      default:
+        prefix.push_back(data[i]);
+    }
+  }
+  return prefix;
+}
+
 void VirtualHost::init(const IniSetting::Map& ini, const Hdf& vh,
                        const std::string& ini_key /* = "" */) {
   m_name = vh.exists() && !vh.isEmpty() ? vh.getName() : ini_key;
@@ -276,6 +334,7 @@ void VirtualHost::init(const IniSetting::Map& ini, const Hdf& vh,
     if (rule.pattern->empty() || rule.to.empty()) {
       throw std::runtime_error("Invalid rewrite rule: (empty pattern or to)");
     }
+    rule.prefix = literal_prefix(rule.pattern);
 
     auto rc_callback = [&](const IniSetting::Map& ini_rc, const Hdf& hdf_rc,
                            const std::string& /*ini_rc_key*/) {
@@ -389,6 +448,16 @@ bool VirtualHost::rewriteURL(const String& host, String &url, bool &qsa,
   for (unsigned int i = 0; i < m_rewriteRules.size(); i++) {
     const RewriteRule &rule = m_rewriteRules[i];
 
+    /* Cheap prefilter: if the URL doesn't carry the pattern's literal
+     * prefix the regex can't match, so neither the conditions nor the
+     * pattern need to be evaluated. */
+    if (!rule.prefix.empty() &&
+        (size_t(normalized.size()) < rule.prefix.size() ||
+         memcmp(normalized.data(), rule.prefix.data(),
+                rule.prefix.size()) != 0)) {
+      continue;
+    }
+
     bool passed = true;
     for (auto it = rule.rewriteConds.begin();
         it != rule.rewriteConds.end(); ++it) {
@@ -49,6 +49,11 @@ public:
   int getRequestTimeoutSeconds(int defaultTimeout) const;
   int64_t getMaxPostSize() const;
 
+  // adaptive output flushing policy (see Transport::sendRaw())
+  int64_t getOutputCoalesceBytes() const;
+  int64_t getOutputCoalesceWindowMicros() const;
+  int64_t getOutputEagerFirstBytes() const;
+
   const std::string &getName() const { return m_name;}
   const std::string &getPathTranslation() const { return m_pathTranslation;}
   const std::string &getDocumentRoot() const { return m_documentRoot;}
@@ -93,6 +98,10 @@ private:
 
   struct RewriteRule {
     StringData* pattern;
+    // Literal prefix every matching URL must start with, precomputed at
+    // config load so non-candidate rules are skipped without running the
+    // regex.  Empty when the pattern is unanchored.
+    std::string prefix;
     std::string to;
     bool qsa = false; // whether to append original query string
     bool encode_backrefs = false;
@@ -111,6 +120,9 @@ private:
     int requestTimeoutSeconds = -1;
     int64_t maxPostSize = -1;
     int64_t uploadMaxFileSize = -1;
+    int64_t outputCoalesceBytes = -1;
+    int64_t outputCoalesceWindowMicros = -1;
+    int64_t outputEagerFirstBytes = -1;
     std::vector<std::string> allowedDirectories;
     int64_t serializationSizeLimit = StringData::MaxSize;
   };
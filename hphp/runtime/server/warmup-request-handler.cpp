@@ -18,8 +18,20 @@
 
 #include "hphp/runtime/base/memory-manager.h"
 #include "hphp/runtime/base/program-functions.h"
+#include "hphp/runtime/server/http-server.h"
+#include "hphp/runtime/server/replay-transport.h"
 
+#include "hphp/util/async-job.h"
+#include "hphp/util/boot-stats.h"
+#include "hphp/util/hdf.h"
+#include "hphp/util/logger.h"
+#include "hphp/util/timer.h"
+
+#include <folly/Format.h>
 #include <folly/Memory.h>
+#include <folly/Range.h>
+
+#include <map>
 
 using std::make_unique;
 
@@ -55,6 +67,85 @@ std::unique_ptr<RequestHandler> WarmupRequestHandlerFactory::createHandler() {
     std::make_unique<WarmupRequestHandler>(m_timeout, shared_from_this());
 }
 
+namespace {
+
+struct WarmupJob {
+  const std::string hdfFile;
+  const unsigned index;
+};
+
+// Take only the last part of the file name, for boot stats keys.
+std::string basename(const std::string& file) {
+  folly::StringPiece f(file);
+  auto const pos = f.rfind('/');
+  return pos == f.npos ? file : f.subpiece(pos + 1).str();
+}
+
+void replayWarmupRequest(const WarmupJob& job) {
+  BootStats::Block timer(
+    folly::sformat("warmup:{}:{}", basename(job.hdfFile), job.index));
+
+  HttpRequestHandler handler(0);
+  ReplayTransport rt;
+  timespec start;
+  Timer::GetMonotonicTime(start);
+  std::string error;
+  Logger::Info("Replaying warmup request %s", job.hdfFile.c_str());
+
+  try {
+    rt.onRequestStart(start);
+    rt.replayInput(Hdf(job.hdfFile));
+    handler.run(&rt);
+
+    timespec stop;
+    Timer::GetMonotonicTime(stop);
+    Logger::Info("Finished successfully in %ld seconds",
+                 stop.tv_sec - start.tv_sec);
+  } catch (std::exception& e) {
+    error = e.what();
+  }
+
+  if (error.size()) {
+    Logger::Info("Got exception during warmup: %s", error.c_str());
+  }
+}
+
+struct WarmupReplayWorker {
+  void onThreadEnter() {}
+  void doJob(std::shared_ptr<WarmupJob> job) {
+    HttpServer::CheckMemAndWait();
+    replayWarmupRequest(*job);
+  }
+  void onThreadExit() {}
+};
+
+}
+
+void replayWarmupRequests(const std::vector<std::string>& files,
+                          int threadCount) {
+  // Distinguish repeated replays of the same document in boot stats.
+  std::map<std::string, unsigned> seen;
+  std::vector<std::shared_ptr<WarmupJob>> jobs;
+  jobs.reserve(files.size());
+  for (auto const& file : files) {
+    jobs.push_back(
+      std::make_shared<WarmupJob>(WarmupJob{file, seen[basename(file)]++}));
+  }
+
+  if (threadCount > 1 && jobs.size() > 1) {
+    // Replay concurrently; the worker threads are hphp-initialized by
+    // AsyncFunc's thread hooks.  Replay order is unspecified in this mode.
+    JobDispatcher<WarmupJob, WarmupReplayWorker>(
+      std::move(jobs), threadCount).run();
+    return;
+  }
+
+  for (auto const& job : jobs) {
+    HttpServer::CheckMemAndWait();
+    replayWarmupRequest(*job);
+  }
+}
+
 void WarmupRequestHandlerFactory::bumpReqCount() {
   // Bump the request count.  When we hit m_warmupReqThreshold,
   // add additional threads to the server.
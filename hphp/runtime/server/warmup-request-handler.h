@@ -18,6 +18,8 @@
 #define incl_HPHP_WARMUP_REQUEST_HANDLER_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "hphp/runtime/server/server.h"
 #include "hphp/runtime/server/http-request-handler.h"
@@ -75,6 +77,16 @@ private:
   Server *m_server;
 };
 
+/**
+ * Replay the warmup request corpus in `files' before the server starts
+ * accepting traffic.  With threadCount > 1 the requests are replayed on
+ * that many worker threads concurrently; otherwise they run serially on
+ * the calling thread, in configuration order.  Blocks until every
+ * request has finished.
+ */
+void replayWarmupRequests(const std::vector<std::string>& files,
+                          int threadCount);
+
 ///////////////////////////////////////////////////////////////////////////////
 }
 
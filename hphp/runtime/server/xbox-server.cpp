@@ -18,11 +18,13 @@
 #include "hphp/runtime/base/builtin-functions.h"
 #include "hphp/runtime/base/comparisons.h"
 #include "hphp/runtime/base/runtime-option.h"
+#include "hphp/runtime/server/host-health-monitor.h"
 #include "hphp/runtime/server/rpc-request-handler.h"
 #include "hphp/runtime/server/satellite-server.h"
 #include "hphp/runtime/base/libevent-http-client.h"
 #include "hphp/runtime/server/job-queue-vm-stack.h"
 #include "hphp/runtime/server/server-task-event.h"
+#include "hphp/util/compatibility.h"
 #include "hphp/util/job-queue.h"
 #include "hphp/util/lock.h"
 #include "hphp/util/logger.h"
@@ -70,10 +72,12 @@ void XboxTransport::sendImpl(const void* data, int size, int code,
 
 void XboxTransport::onSendEndImpl() {
   Lock lock(this);
-  if (m_done) {
+  if (m_done.load(std::memory_order_relaxed)) {
     return;
   }
-  m_done = true;
+  // Response and code are fully written; publish completion before waking
+  // anybody who checks m_done without the lock.
+  m_done.store(true, std::memory_order_release);
   if (m_event) {
     m_event->finish();
   }
@@ -81,9 +85,12 @@ void XboxTransport::onSendEndImpl() {
 }
 
 String XboxTransport::getResults(int &code, int timeout_ms /* = 0 */) {
-  {
+  // Once the job is done the response is immutable, so when we get here
+  // via the asio event (or a status poll that saw completion) there is no
+  // need for the lock at all.
+  if (!m_done.load(std::memory_order_acquire)) {
     Lock lock(this);
-    while (!m_done) {
+    while (!m_done.load(std::memory_order_acquire)) {
       if (timeout_ms > 0) {
         long long seconds = timeout_ms / 1000;
         long long nanosecs = (timeout_ms - seconds * 1000) * 1000;
@@ -122,7 +129,8 @@ static IMPLEMENT_THREAD_LOCAL(XboxRequestHandler, s_xbox_request_handler);
 ///////////////////////////////////////////////////////////////////////////////
 
 struct XboxWorker
-  : JobQueueWorker<XboxTransport*,Server*,true,false,JobQueueDropVMStack>
+  : JobQueueWorker<XboxTransport*,Server*,true,false,JobQueueDropVMStack,
+                   true /* stealing */>
 {
   virtual void doJob(XboxTransport *job) {
     try {
@@ -180,6 +188,15 @@ void XboxServer::Restart() {
          RuntimeOption::ServerThreadDropCacheTimeoutSeconds,
          RuntimeOption::ServerThreadDropStack,
          nullptr);
+
+      if (RuntimeOption::XboxServerScaleMinThreadCount > 0) {
+        // Xbox tasks are background work: let the host health monitor
+        // throttle the pool so they yield to foreground requests when
+        // the host is under pressure.
+        s_dispatcher->enableWorkerScaling(
+          RuntimeOption::XboxServerScaleMinThreadCount);
+        getSingleton<HostHealthMonitor>()->subscribe(s_dispatcher);
+      }
     }
     if (RuntimeOption::XboxServerLogInfo) {
       Logger::Info("xbox server started");
@@ -190,6 +207,9 @@ void XboxServer::Restart() {
 
 void XboxServer::Stop() {
   if (s_dispatcher) {
+    if (RuntimeOption::XboxServerScaleMinThreadCount > 0) {
+      getSingleton<HostHealthMonitor>()->unsubscribe(s_dispatcher);
+    }
     s_dispatcher->stop();
 
     Lock l(s_dispatchMutex);
@@ -144,7 +144,7 @@ struct XboxTransport final : Transport, Synchronizable {
   /**
    * Task interface.
    */
-  bool isDone() { return m_done; }
+  bool isDone() { return m_done.load(std::memory_order_acquire); }
   String getResults(int &code, int timeout_ms = 0);
 
   void setHost(const std::string &host) { m_host = host;}
@@ -168,7 +168,9 @@ private:
 
   std::string m_message;
 
-  bool m_done;
+  // Set with release semantics after the response is complete, so
+  // isDone() and the getResults() fast path need no lock.
+  std::atomic<bool> m_done;
   std::string m_response;
   int m_code;
   std::string m_host;
@@ -148,6 +148,16 @@ struct BlobEncoder {
     std::copy(sd->data(), sd->data() + sz, &m_blob[start]);
   }
 
+  void encode(const std::string& s) {
+    uint32_t sz = s.size();
+    encode(sz);
+    if (!sz) return;
+
+    const size_t start = m_blob.size();
+    m_blob.resize(start + sz);
+    std::copy(s.begin(), s.end(), &m_blob[start]);
+  }
+
   void encode(const RepoAuthType::Array* ar) {
     if (!ar) return encode(std::numeric_limits<uint32_t>::max());
     encode(ar->id());
@@ -217,6 +227,16 @@ struct BlobEncoder {
     return *this;
   }
 
+  /*
+   * Append raw bytes to the end of the blob, with no size prefix.  The
+   * decoder must know how many bytes to expect.
+   */
+  void writeRaw(const char* vp, size_t sz) {
+    const size_t start = m_blob.size();
+    m_blob.resize(start + sz);
+    std::copy(vp, vp + sz, &m_blob[start]);
+  }
+
   size_t size() const { return m_blob.size(); }
   const void* data() const { return &m_blob[0]; }
 
@@ -290,6 +310,14 @@ struct BlobDecoder {
     s = sd;
   }
 
+  void decode(std::string& s) {
+    uint32_t sz;
+    decode(sz);
+    assert(m_last - m_p >= sz);
+    s.assign(reinterpret_cast<const char*>(m_p), sz);
+    m_p += sz;
+  }
+
   void decode(const RepoAuthType::Array*& ar) {
     uint32_t id;
     decode(id);
@@ -391,6 +419,17 @@ struct BlobDecoder {
     return *this;
   }
 
+  /*
+   * Read raw bytes written with BlobEncoder::writeRaw.  data() is the
+   * current read position; advance() skips past bytes consumed from it.
+   */
+  const unsigned char* data() const { return m_p; }
+
+  void advance(size_t sz) {
+    assert(size_t(m_last - m_p) >= sz);
+    m_p += sz;
+  }
+
 private:
   String decodeString() {
     uint32_t sz;
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iostream>
@@ -25,6 +26,7 @@
 #include <cinttypes>
 
 #include <boost/filesystem.hpp>
+#include <tbb/concurrent_hash_map.h>
 
 #include <folly/String.h>
 #include <folly/portability/SysMman.h>
@@ -54,6 +56,7 @@
 #include "hphp/runtime/base/set-array.h"
 #include "hphp/runtime/base/program-functions.h"
 #include "hphp/runtime/base/rds.h"
+#include "hphp/runtime/base/rds-util.h"
 #include "hphp/runtime/base/repo-auth-type-codec.h"
 #include "hphp/runtime/base/runtime-error.h"
 #include "hphp/runtime/base/runtime-option.h"
@@ -1794,6 +1797,102 @@ static inline TypedValue* ratchetRefs(TypedValue* result, TypedValue& tvRef,
  * details.
  */
 
+/*
+ * Set while an interpOne entry point is executing; see allowInterpFusion().
+ */
+static __thread bool tl_interpOneActive{false};
+
+/*
+ * Whether the interpreter may execute a fused pair of adjacent bytecodes
+ * without returning to the dispatch loop in between.  Fusion skips the
+ * per-opcode debugger, code-coverage, and instruction-count hooks for the
+ * second instruction, so it must be off whenever any of those is active.  It
+ * must also be off under interpOne, whose jitted callers resume at the
+ * following bytecode and would re-execute a fused instruction.
+ */
+OPTBLD_INLINE bool allowInterpFusion() {
+  if (!RuntimeOption::EvalInterpFuseHotPairs) return false;
+  if (UNLIKELY(tl_interpOneActive)) return false;
+  if (UNLIKELY(RID().getCoverage())) return false;
+  if (UNLIKELY(isDebuggerAttached())) return false;
+  if (UNLIKELY(Stats::enableInstrCount())) return false;
+  return true;
+}
+
+/*
+ * Interpreter inline caches.
+ *
+ * An interpreted FPushObjMethodD site repeats the same full method lookup on
+ * every execution.  Analogously to what jit/target-cache.cpp gives translated
+ * call sites, each interpreted site gets a request-local RDS entry caching the
+ * last lookup result; the side table below maps sites to their (lazily
+ * allocated) entries.  The RDS handles are never freed, but a destroyed
+ * Unit's rows are dropped (see clearInterpCaches()) so a recycled bytecode
+ * address can't alias a stale site.
+ */
+struct InterpMethodCacheEntry {
+  static constexpr uintptr_t kMagicBit  = 0x1;
+  static constexpr uintptr_t kNoThisBit = 0x2;
+
+  const Class* cls;
+  /*
+   * Both the receiver's class and the calling context have to match: closure
+   * bodies are shared by their per-scope clones, so different ActRecs can
+   * execute the same bytecode with different context classes.
+   */
+  const Class* ctx;
+  uintptr_t funcAndFlags;
+
+  const Func* func() const {
+    return reinterpret_cast<const Func*>(
+      funcAndFlags & ~(kMagicBit | kNoThisBit)
+    );
+  }
+};
+
+using InterpCacheTable = std::unordered_map<Offset, rds::Handle>;
+using InterpCacheMap = tbb::concurrent_hash_map<const Unit*, InterpCacheTable>;
+static InterpCacheMap s_interpCaches;
+
+static InterpMethodCacheEntry* interpMethodCache(PC pc) {
+  if (!RuntimeOption::EvalInterpInlineCaches) return nullptr;
+  auto const unit = vmfp()->m_func->unit();
+  auto const off = unit->offsetOf(pc);
+
+  auto const toEntry = [] (rds::Handle handle) {
+    auto& mce = rds::handleToRef<InterpMethodCacheEntry>(handle);
+    if (!rds::isHandleInit(handle, rds::NormalTag{})) {
+      mce.cls = nullptr;
+      mce.ctx = nullptr;
+      mce.funcAndFlags = 0;
+      rds::initHandle(handle);
+    }
+    return &mce;
+  };
+
+  {
+    InterpCacheMap::const_accessor acc;
+    if (s_interpCaches.find(acc, unit)) {
+      auto const it = acc->second.find(off);
+      if (it != acc->second.end()) return toEntry(it->second);
+    }
+  }
+
+  InterpCacheMap::accessor acc;
+  s_interpCaches.insert(acc, unit);
+  auto const res = acc->second.emplace(
+    off,
+    rds::alloc<InterpMethodCacheEntry,
+               alignof(InterpMethodCacheEntry),
+               true>().handle()
+  );
+  return toEntry(res.first->second);
+}
+
+void clearInterpCaches(const Unit* unit) {
+  s_interpCaches.erase(unit);
+}
+
 OPTBLD_INLINE void iopNop() {
 }
 
@@ -2162,6 +2261,22 @@ OPTBLD_INLINE void iopClsCns(const StringData* clsCnsName, clsref_slot slot) {
 OPTBLD_INLINE void iopClsCnsD(const StringData* clsCnsName, Id classId) {
   const NamedEntityPair& classNamedEntity =
     vmfp()->m_func->unit()->lookupNamedEntityPairId(classId);
+  if (RuntimeOption::EvalInterpInlineCaches) {
+    // Share the JIT's per-(class, constant) RDS cache of resolved values;
+    // see cgLdClsCns/cgInitClsCns in jit/irlower-cns.cpp.
+    auto const link = rds::bindClassConstant(classNamedEntity.first,
+                                             clsCnsName);
+    if (link.isInit()) {
+      cellDup(*link, *vmStack().allocC());
+      return;
+    }
+    auto const clsCns = g_context->lookupClsCns(classNamedEntity.second,
+                                         classNamedEntity.first, clsCnsName);
+    cellDup(clsCns, *link);
+    link.markInit();
+    cellDup(clsCns, *vmStack().allocC());
+    return;
+  }
   auto const clsCns = g_context->lookupClsCns(classNamedEntity.second,
                                        classNamedEntity.first, clsCnsName);
   auto const c1 = vmStack().allocC();
@@ -3052,7 +3167,23 @@ OPTBLD_INLINE void cgetl_body(ActRec* fp,
   }
 }
 
-OPTBLD_FLT_INLINE void iopCGetL(local_var fr) {
+OPTBLD_INLINE static bool isTypeHelper(TypedValue* tv, IsTypeOp op);
+
+OPTBLD_FLT_INLINE void iopCGetL(PC& pc, local_var fr) {
+  // CGetL;IsTypeC runs are hot enough to be worth fusing: test the local in
+  // place instead of pushing a copy and immediately consuming it, which saves
+  // the refcounting on the copy as well as a dispatch round trip.  Uninit
+  // locals take the unfused path so the undefined-variable notice and the
+  // pushed null keep their exact unfused behavior.
+  if (peek_op(pc) == Op::IsTypeC && allowInterpFusion() &&
+      LIKELY(fr.ptr->m_type != KindOfUninit)) {
+    auto next = pc;
+    decode_op(next);
+    auto const op = decode_oa<IsTypeOp>(next);
+    vmStack().pushBool(isTypeHelper(tvToCell(fr.ptr), op));
+    pc = next;
+    return;
+  }
   Cell* to = vmStack().allocC();
   cgetl_body(vmfp(), fr.ptr, to, fr.index, true);
 }
@@ -4402,16 +4533,38 @@ OPTBLD_INLINE void iopFPushFuncU(intva_t numArgs, Id nsFunc, Id globalFunc) {
   ar->trashThis();
 }
 
-void fPushObjMethodImpl(StringData* name, ObjectData* obj, int numArgs) {
+void fPushObjMethodImpl(StringData* name, ObjectData* obj, int numArgs,
+                        InterpMethodCacheEntry* mce) {
   const Func* f;
   LookupResult res;
   auto cls = obj->getVMClass();
-  try {
-    res = lookupObjMethod(
-      f, cls, name, arGetContextClass(vmfp()), true);
-  } catch (...) {
-    decRefObj(obj);
-    throw;
+  auto const ctx = arGetContextClass(vmfp());
+  if (mce && mce->cls == cls && mce->ctx == ctx) {
+    f = mce->func();
+    res = mce->funcAndFlags & InterpMethodCacheEntry::kMagicBit
+      ? LookupResult::MagicCallFound
+      : mce->funcAndFlags & InterpMethodCacheEntry::kNoThisBit
+        ? LookupResult::MethodFoundNoThis
+        : LookupResult::MethodFoundWithThis;
+  } else {
+    try {
+      res = lookupObjMethod(f, cls, name, ctx, true);
+    } catch (...) {
+      decRefObj(obj);
+      throw;
+    }
+    assert(f);
+    if (mce) {
+      auto flags = uintptr_t{0};
+      if (res == LookupResult::MagicCallFound) {
+        flags |= InterpMethodCacheEntry::kMagicBit;
+      } else if (res == LookupResult::MethodFoundNoThis) {
+        flags |= InterpMethodCacheEntry::kNoThisBit;
+      }
+      mce->cls = cls;
+      mce->ctx = ctx;
+      mce->funcAndFlags = reinterpret_cast<uintptr_t>(f) | flags;
+    }
   }
   assert(f);
   ActRec* ar = vmStack().allocA();
@@ -4476,7 +4629,7 @@ OPTBLD_INLINE void iopFPushObjMethod(intva_t numArgs, ObjMethodOp op) {
   StringData* name = c1->m_data.pstr;
   // We handle decReffing obj and name in fPushObjMethodImpl
   vmStack().ndiscard(2);
-  fPushObjMethodImpl(name, obj, numArgs);
+  fPushObjMethodImpl(name, obj, numArgs, nullptr);
 }
 
 OPTBLD_INLINE void
@@ -4494,7 +4647,8 @@ iopFPushObjMethodD(intva_t numArgs, const StringData* name, ObjMethodOp op) {
   ObjectData* obj = c1->m_data.pobj;
   // We handle decReffing obj in fPushObjMethodImpl
   vmStack().discard();
-  fPushObjMethodImpl(const_cast<StringData*>(name), obj, numArgs);
+  fPushObjMethodImpl(const_cast<StringData*>(name), obj, numArgs,
+                     interpMethodCache(vmpc()));
 }
 
 template<bool forwarding>
@@ -6517,6 +6671,13 @@ iopWrapper(Op /*op*/, void (*fn)(PC&, intva_t), PC& pc) {
   return nullptr;
 }
 
+OPTBLD_INLINE static TCA
+iopWrapper(Op /*op*/, void (*fn)(PC&, local_var), PC& pc) {
+  auto var = decode_local(pc);
+  fn(pc, var);
+  return nullptr;
+}
+
 OPTBLD_INLINE static TCA
 iopWrapper(Op /*op*/, void (*fn)(intva_t, const StringData*, Id), PC& pc) {
   auto n = decode_intva(pc);
@@ -6818,6 +6979,29 @@ iopWrapper(Op /*op*/, void (*fn)(intva_t, SetOpOp, MemberKey), PC& pc) {
   return nullptr;
 }
 
+/*
+ * Repo mode emits AssertRAT{L,Stk} in runs, and each one is a release no-op.
+ * Consume the rest of a run in one go rather than paying a dispatch round
+ * trip per assertion.  Only called in release builds, where the assertions
+ * don't need to be evaluated.
+ */
+OPTBLD_INLINE void skipAssertRATRun(PC& pc) {
+  if (!allowInterpFusion()) return;
+  while (true) {
+    auto const next = peek_op(pc);
+    if (next == Op::AssertRATL) {
+      decode_op(pc);
+      decode_local(pc);
+    } else if (next == Op::AssertRATStk) {
+      decode_op(pc);
+      decode_intva(pc);
+    } else {
+      return;
+    }
+    pc += encodedRATSize(pc);
+  }
+}
+
 OPTBLD_INLINE static TCA
 iopWrapper(Op /*op*/, void (*fn)(local_var, RepoAuthType), PC& pc) {
   auto var = decode_local(pc);
@@ -6827,6 +7011,7 @@ iopWrapper(Op /*op*/, void (*fn)(local_var, RepoAuthType), PC& pc) {
   } else {
     RepoAuthType rat; pc += encodedRATSize(pc);
     fn(var, rat);
+    skipAssertRATRun(pc);
   }
   return nullptr;
 }
@@ -6840,6 +7025,7 @@ iopWrapper(Op /*op*/, void (*fn)(intva_t, RepoAuthType), PC& pc) {
   } else {
     RepoAuthType rat; pc += encodedRATSize(pc);
     fn(n, rat);
+    skipAssertRATRun(pc);
   }
   return nullptr;
 }
@@ -6973,6 +7159,9 @@ TCA iopWrapper(Op op,
           Trace::trace("op"#opcode" offset: %d\n", offset));            \
   assert(peek_op(pc) == Op::opcode);                                    \
   pc += encoded_op_size(Op::opcode);                                    \
+  auto const wasInterpOne = tl_interpOneActive;                         \
+  tl_interpOneActive = true;                                            \
+  SCOPE_EXIT { tl_interpOneActive = wasInterpOne; };                    \
   auto const retAddr = iopWrapper(Op::opcode, iop##opcode, pc);         \
   vmpc() = pc;                                                          \
   COND_STACKTRACE("op"#opcode" post: ");                                \
@@ -6995,6 +7184,21 @@ OPCODES
 #undef O
 };
 
+/*
+ * Notes on dispatch:
+ *
+ * Dispatch is direct-threaded over the raw bytecode: each handler tail-jumps
+ * through one of the optabs below via computed goto, and immediates are
+ * decoded by the iopWrapper overloads as the handler is entered.  We
+ * deliberately do not keep a per-Func pre-decoded instruction image.  The
+ * handler labels are local to this function and can't be pre-resolved into
+ * Func-lifetime storage, and everything outside this loop -- the unwinder,
+ * the debugger, exception-handler entry, and resumables -- identifies resume
+ * points by raw bytecode PC, so a side representation would need a
+ * translation layer on every entry and exit.  The variable-width decodes
+ * that remain per-execution (decode_op, decode_iva) are a byte test and
+ * branch each; the fat in this loop is elsewhere.
+ */
 template <bool breakOnCtlFlow>
 TCA dispatchImpl() {
   // Unfortunately, MSVC doesn't support computed
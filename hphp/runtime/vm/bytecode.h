@@ -890,6 +890,13 @@ visitStackElems(const ActRec* const fp,
 
 void resetCoverageCounters();
 
+/*
+ * Drop any interpreter inline-cache entries for call sites in `unit'.  Called
+ * when the Unit is destroyed, so a recycled bytecode address can't alias a
+ * stale cache entry.
+ */
+void clearInterpCaches(const Unit* unit);
+
 // The interpOne*() methods implement individual opcode handlers.
 using InterpOneFunc = jit::TCA (*) (ActRec*, TypedValue*, Offset);
 extern InterpOneFunc interpOneEntryPoints[];
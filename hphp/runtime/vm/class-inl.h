@@ -263,6 +263,14 @@ inline bool Class::hasDeepInitProps() const {
   return m_hasDeepInitProps;
 }
 
+inline const FixedVector<Slot>& Class::deepInitSlots() const {
+  return m_deepInitSlots;
+}
+
+inline bool Class::hasNoSerializeProps() const {
+  return m_hasNoSerializeProps;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Property initialization.
 
@@ -278,6 +286,10 @@ inline const FixedVector<const Func*>& Class::pinitVec() const {
   return m_pinitVec;
 }
 
+inline const FixedVector<const Func*>& Class::sinitVec() const {
+  return m_sinitVec;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Property storage.
 
@@ -365,7 +377,7 @@ inline const Class::TraitAliasVec& Class::traitAliases() const {
 }
 
 inline const Class::RequirementMap& Class::allRequirements() const {
-  return m_requirements;
+  return m_extra->m_requirements;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -432,6 +444,10 @@ inline EnumValues* Class::getEnumValues() const {
   return m_extra->m_enumValues.load(std::memory_order_relaxed);
 }
 
+inline UnserializeShape* Class::getUnserializeShape() const {
+  return m_extra->m_unserializeShape.load(std::memory_order_relaxed);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // ExtraData.
 
@@ -23,6 +23,7 @@
 #include "hphp/runtime/base/strings.h"
 #include "hphp/runtime/base/tv-refcount.h"
 #include "hphp/runtime/base/type-structure.h"
+#include "hphp/runtime/base/variable-unserializer.h"
 #include "hphp/runtime/vm/jit/translator.h"
 #include "hphp/runtime/vm/globals-array.h"
 #include "hphp/runtime/vm/instance-bits.h"
@@ -32,6 +33,7 @@
 #include "hphp/runtime/vm/treadmill.h"
 
 #include "hphp/runtime/ext/collections/ext_collections.h"
+#include "hphp/runtime/ext/reflection/ext_reflection.h"
 #include "hphp/runtime/ext/string/ext_string.h"
 #include "hphp/runtime/ext/std/ext_std_closure.h"
 
@@ -44,6 +46,7 @@
 #include <folly/Optional.h>
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 
 TRACE_SET_MOD(class_load);
@@ -209,9 +212,11 @@ struct assert_sizeof_class {
 template struct assert_sizeof_class<sizeof_Class>;
 
 /*
- * R/W lock for caching scopings of closures.
+ * R/W lock for caching scopings of closures.  Reads (cache hits on every
+ * rescoping after the first) vastly outnumber writes, so use the
+ * read-mostly shared mutex.
  */
-ReadWriteMutex s_scope_cache_mutex;
+SharedReadWriteMutex s_scope_cache_mutex;
 
 }
 
@@ -294,7 +299,7 @@ Class* Class::rescope(Class* ctx, Attr attrs /* = AttrNone */) {
   };
 
   { // Return the cached clone if we have one.
-    ReadLock l(s_scope_cache_mutex);
+    SharedReadLock l(s_scope_cache_mutex);
 
     // If this succeeds, someone raced us to scoping the template.  We may have
     // unnecessarily allocated an ExtraData, but whatever.
@@ -314,7 +319,7 @@ Class* Class::rescope(Class* ctx, Attr attrs /* = AttrNone */) {
     template_cls->m_scoped ? cloneClass() : template_cls
   };
 
-  WriteLock l(s_scope_cache_mutex);
+  SharedWriteLock l(s_scope_cache_mutex);
 
   if (fermeture->m_scoped) {
     // We raced with someone who scoped the template_cls just as we were about
@@ -324,7 +329,7 @@ Class* Class::rescope(Class* ctx, Attr attrs /* = AttrNone */) {
     // This race should be far less likely than a race between two attempted
     // first-scopings for `template_cls', which is why we don't do an test-and-
     // set when we first check `m_scoped' before acquiring the lock.
-    s_scope_cache_mutex.release();
+    s_scope_cache_mutex.releaseWrite();
     SCOPE_EXIT { s_scope_cache_mutex.acquireWrite(); };
     fermeture = ClassPtr { cloneClass() };
   }
@@ -379,8 +384,22 @@ EnumValues* Class::setEnumValues(EnumValues* values) {
   }
 }
 
+UnserializeShape* Class::setUnserializeShape(UnserializeShape* shape) {
+  auto extra = m_extra.ensureAllocated();
+  UnserializeShape* expected = nullptr;
+  if (!extra->m_unserializeShape.compare_exchange_strong(
+        expected, shape, std::memory_order_relaxed)) {
+    // Already set by someone else, use theirs.
+    delete shape;
+    return expected;
+  } else {
+    return shape;
+  }
+}
+
 Class::ExtraData::~ExtraData() {
   delete m_enumValues.load(std::memory_order_relaxed);
+  delete m_unserializeShape.load(std::memory_order_relaxed);
 }
 
 void Class::destroy() {
@@ -463,6 +482,9 @@ Class::~Class() {
   // clean enum cache
   EnumCache::deleteValues(this);
 
+  // drop any materialized reflection info
+  Reflection::onClassDestruct(this);
+
   low_free_data(m_vtableVec.get());
 
 #ifdef DEBUG
@@ -505,14 +527,14 @@ void Class::releaseRefs() {
 
   m_numDeclInterfaces = 0;
   m_declInterfaces.reset();
-  m_requirements.clear();
 
   if (m_extra) {
     auto xtra = m_extra.raw();
     xtra->m_usedTraits.clear();
+    xtra->m_requirements.clear();
 
     if (xtra->m_clonesWithThisScope.size() > 0) {
-      WriteLock l(s_scope_cache_mutex);
+      SharedWriteLock l(s_scope_cache_mutex);
 
       // Purge all references to scoped closure clones that are scoped to
       // `this'---there is no way anyone can find them at this point.
@@ -845,7 +867,10 @@ void Class::initSPropHandles() const {
     }
   }
 
-  // Bind all the static prop handles.
+  // Bind all the static prop handles.  Fresh local bindings are deferred and
+  // done below in one batched pass, so that a class with many static
+  // properties takes the RDS allocation lock once rather than per property.
+  std::vector<Slot> batchSlots;
   for (Slot slot = 0, n = m_staticProperties.size(); slot < n; ++slot) {
     auto& propHandle = m_sPropCache[slot];
     auto const& sProp = m_staticProperties[slot];
@@ -858,9 +883,10 @@ void Class::initSPropHandles() const {
           rds::recordRds(propHandle.handle(), sizeof(StaticPropData),
                          rds::SPropCache{this, slot});
         } else {
-          propHandle = rds::bind<StaticPropData>(
-              rds::SPropCache{this, slot}, rds::Mode::Local
-          );
+          // Local handles are never persistent.
+          batchSlots.push_back(slot);
+          allPersistentHandles = false;
+          continue;
         }
       } else {
         auto realSlot = sProp.cls->lookupSProp(sProp.name);
@@ -881,6 +907,21 @@ void Class::initSPropHandles() const {
     }
   }
 
+  if (!batchSlots.empty()) {
+    std::vector<rds::Symbol> keys;
+    keys.reserve(batchSlots.size());
+    for (auto const slot : batchSlots) {
+      keys.emplace_back(rds::SPropCache{this, slot});
+    }
+    std::vector<rds::Handle> handles(batchSlots.size());
+    rds::bindBatch<StaticPropData>(
+      keys.data(), handles.data(), keys.size(), rds::Mode::Local
+    );
+    for (size_t i = 0; i < batchSlots.size(); ++i) {
+      m_sPropCache[batchSlots[i]] = rds::Link<StaticPropData>(handles[i]);
+    }
+  }
+
   // Bind the init handle; this indicates that all handles are bound.
   if (allPersistentHandles) {
     // We must make sure the value stored at the handle is correct before
@@ -1197,6 +1238,26 @@ Cell Class::clsCnsGet(const StringData* clsCnsName, bool includeTypeCns) const {
   );
 
   assertx(tvAsCVarRef(&ret).isAllowedAsConstantValue());
+
+  if (UNLIKELY(RuntimeOption::EvalClsCnsPromoteScalarInit) &&
+      isPersistent() &&
+      ret.m_type != KindOfResource && ret.m_type != KindOfObject) {
+    // The initializer produced a value with no per-request state, so publish
+    // it into the constant table and skip the 86cinit on every later request.
+    // As with resolved type constants above, racing threads will all store
+    // identical static values, so the duplicated work during warmup is
+    // harmless.
+    tvAsVariant(&ret).setEvalScalar();
+    clsCnsData.set(StrNR(clsCnsName), tvAsCVarRef(&ret), true /* isKey */);
+    auto& mut = const_cast<TypedValueAux&>(cns.val);
+    mut.m_data = ret.m_data;
+    // Publish the type last; readers treat m_type != KindOfUninit as "fully
+    // initialized" without taking any lock.
+    std::atomic_thread_fence(std::memory_order_release);
+    mut.m_type = ret.m_type;
+    return ret;
+  }
+
   clsCnsData.set(StrNR(clsCnsName), cellAsCVarRef(ret), true /* isKey */);
 
   // The caller will inc-ref the returned value, so undo the inc-ref caused by
@@ -1266,22 +1327,25 @@ bool Class::verifyPersistent() const {
 }
 
 void Class::setInstanceBits() {
-  setInstanceBitsImpl<false>();
+  setInstanceBitsImpl<false, false>();
 }
 void Class::setInstanceBitsAndParents() {
-  setInstanceBitsImpl<true>();
+  setInstanceBitsImpl<true, false>();
+}
+void Class::recomputeInstanceBitsAndParents() {
+  setInstanceBitsImpl<true, true>();
 }
 
-template<bool setParents>
+template<bool setParents, bool recompute>
 void Class::setInstanceBitsImpl() {
   // Bit 0 is reserved to indicate whether or not the rest of the bits
   // are initialized yet.
-  if (m_instanceBits.test(0)) return;
+  if (!recompute && m_instanceBits.test(0)) return;
 
   InstanceBits::BitSet bits;
   bits.set(0);
   auto setBits = [&](Class* c) {
-    if (setParents) c->setInstanceBitsAndParents();
+    if (setParents) c->setInstanceBitsImpl<true, recompute>();
     bits |= c->m_instanceBits;
   };
   if (m_parent.get()) setBits(m_parent.get());
@@ -1290,9 +1354,12 @@ void Class::setInstanceBitsImpl() {
   for (int i = 0; i < numIfaces; i++) setBits(m_interfaces[i]);
 
   // XXX: this assert fails on the initFlag; oops.
-  if (unsigned bit = InstanceBits::lookup(m_preClass->name())) {
+  if (unsigned bit = InstanceBits::lookupLocked(m_preClass->name())) {
     bits.set(bit);
   }
+  // The new set can only ever add bits: concurrently running translations
+  // only test bits that were published before they were emitted, and those
+  // have the same value in the old and new sets, so the plain store is safe.
   m_instanceBits = bits;
 }
 
@@ -1860,9 +1927,23 @@ void Class::setODAttributes() {
 
   if (m_dtor == nullptr) m_ODAttrs |= ObjectData::NoDestructor;
 
-  if ((isBuiltin() && Native::getNativePropHandler(name())) ||
-      (m_parent && m_parent->hasNativePropHandler())) {
+  // Resolve the native prop handler once at load time, so property access
+  // doesn't redo the name lookup and parent walk per access.
+  auto const nativePropHandler = [&]() -> const Native::NativePropHandler* {
+    if (isBuiltin()) {
+      if (auto const handler = Native::getNativePropHandler(name())) {
+        return handler;
+      }
+    }
+    if (m_parent && m_parent->hasNativePropHandler()) {
+      return m_parent->getNativePropHandler();
+    }
+    return nullptr;
+  }();
+  if (nativePropHandler) {
     m_ODAttrs |= ObjectData::HasNativePropHandler;
+    allocExtraData();
+    m_extra.raw()->m_nativePropHandler = nativePropHandler;
   }
 }
 
@@ -2315,6 +2396,28 @@ void Class::setProperties() {
   m_declProperties.create(curPropMap);
   m_staticProperties.create(curSPropMap);
 
+  if (m_hasDeepInitProps) {
+    // Record which slots actually carry AttrDeepInit, so that object
+    // construction can bulk-copy the property image and then deep-copy just
+    // these slots.  (m_hasDeepInitProps may be set with no such slots; see
+    // above.)
+    std::vector<Slot> deepInitSlots;
+    for (Slot slot = 0; slot < m_declProperties.size(); ++slot) {
+      if (m_declProperties[slot].attrs & AttrDeepInit) {
+        deepInitSlots.push_back(slot);
+      }
+    }
+    m_deepInitSlots = std::move(deepInitSlots);
+  }
+
+  m_hasNoSerializeProps = false;
+  for (Slot slot = 0; slot < m_declProperties.size(); ++slot) {
+    if (m_declProperties[slot].attrs & AttrNoSerialize) {
+      m_hasNoSerializeProps = true;
+      break;
+    }
+  }
+
   m_sPropCache = (rds::Link<StaticPropData>*)
     malloc_huge(numStaticProperties() * sizeof(*m_sPropCache));
   for (unsigned i = 0, n = numStaticProperties(); i < n; ++i) {
@@ -2813,7 +2916,10 @@ void Class::setRequirements() {
     }
   }
 
-  m_requirements.create(reqBuilder);
+  if (reqBuilder.size()) {
+    allocExtraData();
+    m_extra.raw()->m_requirements.create(reqBuilder);
+  }
   checkRequirementConstraints();
 }
 
@@ -2849,15 +2955,8 @@ bool Class::hasNativePropHandler() const {
 
 const Native::NativePropHandler* Class::getNativePropHandler() const {
   assert(hasNativePropHandler());
-
-  for (auto cls = this; cls; cls = cls->parent()) {
-    auto propHandler = Native::getNativePropHandler(cls->name());
-    if (propHandler != nullptr) {
-      return propHandler;
-    }
-  }
-
-  not_reached();
+  assert(m_extra->m_nativePropHandler);
+  return m_extra->m_nativePropHandler;
 }
 
 void Class::raiseUnsatisfiedRequirement(const PreClass::ClassRequirement* req)  const {
@@ -2933,7 +3032,7 @@ void Class::raiseUnsatisfiedRequirement(const PreClass::ClassRequirement* req)
 void Class::checkRequirementConstraints() const {
   if (attrs() & (AttrInterface | AttrTrait)) return;
 
-  for (auto const& req : m_requirements.range()) {
+  for (auto const& req : allRequirements().range()) {
     auto const reqName = req->name();
     if (req->is_implements()) {
       if (UNLIKELY(!ifaceofDirect(reqName))) {
@@ -52,6 +52,7 @@ struct ClassInfo;
 struct EnumValues;
 struct Func;
 struct StringData;
+struct UnserializeShape;
 struct c_WaitHandle;
 
 namespace collections {
@@ -651,6 +652,22 @@ public:
    */
   bool hasDeepInitProps() const;
 
+  /*
+   * Slots of declared properties which have the AttrDeepInit attribute.
+   *
+   * Only computed when hasDeepInitProps() is true.  Lets object construction
+   * bulk-copy the property image and then deep-copy just these slots.
+   */
+  const FixedVector<Slot>& deepInitSlots() const;
+
+  /*
+   * Whether any declared property carries AttrNoSerialize.
+   *
+   * When false, every slot participates in clones and comparisons, so
+   * ObjectData can bulk-copy or pairwise-compare the property vector.
+   */
+  bool hasNoSerializeProps() const;
+
 
   /////////////////////////////////////////////////////////////////////////////
   // Property initialization.                                           [const]
@@ -697,6 +714,13 @@ public:
    */
   const FixedVector<const Func*>& pinitVec() const;
 
+  /*
+   * Vector of 86sinit non-scalar static property initializer functions.
+   *
+   * These are invoked during initSProps() after scalar initialization.
+   */
+  const FixedVector<const Func*>& sinitVec() const;
+
 
   /////////////////////////////////////////////////////////////////////////////
   // Property storage.                                                  [const]
@@ -890,6 +914,14 @@ public:
   EnumValues* setEnumValues(EnumValues* values);
   EnumValues* getEnumValues() const;
 
+  /*
+   * Store a precompiled unserialization shape. Takes ownership of 'shape'.
+   *
+   * @see: variable-unserializer.h
+   */
+  UnserializeShape* setUnserializeShape(UnserializeShape* shape);
+  UnserializeShape* getUnserializeShape() const;
+
   /////////////////////////////////////////////////////////////////////////////
   // Objects.                                                           [const]
 
@@ -987,6 +1019,14 @@ public:
    */
   void setInstanceBits();
   void setInstanceBitsAndParents();
+
+  /*
+   * Like setInstanceBitsAndParents(), but recomputes the bits even if they
+   * have already been set.  Used when InstanceBits::update() assigns leftover
+   * bits after the initial assignment; bits are only ever added, so the
+   * republished set is always a superset of the old one.
+   */
+  void recomputeInstanceBitsAndParents();
   bool checkInstanceBit(unsigned int bit) const;
 
   /*
@@ -1083,16 +1123,36 @@ private:
      */
     std::vector<ScopedCloneBackref> m_clonesWithThisScope;
 
+    /*
+     * Trait and interface `require' constraints imposed on this class.  Most
+     * classes have none, so the map lives out here rather than taking up
+     * space in every Class.
+     */
+    RequirementMap m_requirements;
+
     /*
      * Objects with the <<__NativeData("T")>> UA are allocated with extra space
      * prior to the ObjectData structure itself.
      */
     const Native::NativeDataInfo *m_nativeDataInfo{nullptr};
 
+    /*
+     * Handler of native magic props, resolved when the class is loaded.
+     * Only set for classes with ObjectData::HasNativePropHandler.
+     */
+    const Native::NativePropHandler* m_nativePropHandler{nullptr};
+
     /*
      * Cache of persistent enum values, managed by EnumCache.
      */
     std::atomic<EnumValues*> m_enumValues{nullptr};
+
+    /*
+     * Cache of the precompiled unserialization shape, built lazily by
+     * VariableUnserializer the first time an instance of this class is
+     * unserialized.
+     */
+    std::atomic<UnserializeShape*> m_unserializeShape{nullptr};
   };
 
   /*
@@ -1250,7 +1310,7 @@ private:
   void raiseUnsatisfiedRequirement(const PreClass::ClassRequirement*) const;
   void setNativeDataInfo();
 
-  template<bool setParents> void setInstanceBitsImpl();
+  template<bool setParents, bool recompute> void setInstanceBitsImpl();
   void addInterfacesFromUsedTraits(InterfaceMap::Builder& builder) const;
 
 
@@ -1283,7 +1343,6 @@ private:
 
   friend struct collections::CollectionsExtension;
 
-  RequirementMap m_requirements;
   std::unique_ptr<ClassPtr[]> m_declInterfaces;
   uint32_t m_numDeclInterfaces{0};
   mutable rds::Link<Array, true /* normal_only */>
@@ -1320,6 +1379,11 @@ private:
   LowPtr<Func> m_dtor;
   PropInitVec m_declPropInit;
   FixedVector<const Func*> m_pinitVec;
+
+  /*
+   * Slots of declared properties with AttrDeepInit; see deepInitSlots().
+   */
+  FixedVector<Slot> m_deepInitSlots;
   SPropMap m_staticProperties;
   PreClassPtr m_preClass;
   InterfaceMap m_interfaces;
@@ -1376,6 +1440,13 @@ private:
   bool m_needsInitThrowable : 1;
   bool m_hasDeepInitProps : 1;
 
+  /*
+   * Whether any declared property carries AttrNoSerialize.  Such properties
+   * are skipped by clones and comparisons, forcing the generic per-slot
+   * paths in ObjectData.
+   */
+  bool m_hasNoSerializeProps : 1;
+
   /*
    * Cache of m_preClass->attrs().
    */
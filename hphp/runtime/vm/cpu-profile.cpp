@@ -0,0 +1,230 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/runtime/vm/cpu-profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <sys/time.h>
+
+#include "hphp/runtime/base/rds-header.h"
+#include "hphp/runtime/base/types.h"
+#include "hphp/runtime/vm/act-rec.h"
+#include "hphp/runtime/vm/func.h"
+#include "hphp/runtime/vm/unit.h"
+#include "hphp/runtime/vm/vm-regs.h"
+
+namespace HPHP {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr int kMaxDepth = 16;
+constexpr size_t kNumEntries = size_t{1} << 15;
+
+struct SampleFrame {
+  FuncId funcId;
+  Offset offset;
+};
+
+/*
+ * depth == 0 records a sample that couldn't be attributed to PHP execution.
+ * Entries are written without synchronization, so readers must treat every
+ * field as potentially torn and validate before use.
+ */
+struct SampleEntry {
+  int32_t depth;
+  SampleFrame frames[kMaxDepth];
+};
+
+std::atomic<bool> s_enabled{false};
+std::atomic<uint64_t> s_cursor{0};
+SampleEntry* s_entries = nullptr;
+int s_hz = 0;
+
+void cpu_profile_signal_handler(int /*signo*/, siginfo_t* /*info*/,
+                                void* /*context*/) {
+  if (!s_enabled.load(std::memory_order_relaxed) || !s_entries) return;
+
+  auto& entry =
+    s_entries[s_cursor.fetch_add(1, std::memory_order_relaxed) % kNumEntries];
+
+  /*
+   * Only walk the VM frame chain when this thread has VM state and the
+   * in-RDS registers are sync'd; anything else is recorded as a native
+   * sample.  Nothing below takes a lock or allocates.
+   */
+  int depth = 0;
+  if (rds::header() && tl_regState == VMRegState::CLEAN) {
+    auto const& regs = vmRegsUnsafe();
+    auto fp = regs.fp;
+    if (fp && fp->m_func) {
+      // Leaf frame: the current pc.
+      entry.frames[depth].funcId = fp->m_func->getFuncId();
+      entry.frames[depth].offset = fp->m_func->unit()->offsetOf(regs.pc);
+      ++depth;
+
+      /*
+       * Caller frames: each ActRec saves the offset of the call from its
+       * caller's bytecode base.  The m_sfp chain only links frames within
+       * the current VM nesting level, which is fine for a sampling profile.
+       */
+      auto soff = fp->m_soff;
+      for (fp = fp->m_sfp; fp && fp->m_func && depth < kMaxDepth;
+           fp = fp->m_sfp) {
+        entry.frames[depth].funcId = fp->m_func->getFuncId();
+        entry.frames[depth].offset = fp->m_func->base() + soff;
+        soff = fp->m_soff;
+        ++depth;
+      }
+    }
+  }
+  entry.depth = depth;
+}
+
+/*
+ * Resolve a recorded frame to a line number, or -1 if the frame doesn't
+ * validate (e.g. it was torn by the ring wrapping during the read).
+ */
+int resolveLine(const Func* func, Offset offset) {
+  auto const unit = func->unit();
+  if (offset >= unit->bclen()) return -1;
+  return unit->getLineNumber(offset);
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CpuProfiler::start(int hz) {
+  if (s_enabled.load(std::memory_order_acquire)) return false;
+  if (hz <= 0) hz = 100;
+
+  if (!s_entries) {
+    s_entries = static_cast<SampleEntry*>(
+      calloc(kNumEntries, sizeof(SampleEntry))
+    );
+    if (!s_entries) return false;
+  }
+  s_cursor.store(0, std::memory_order_relaxed);
+  s_hz = hz;
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = cpu_profile_signal_handler;
+  sa.sa_flags = SA_RESTART | SA_SIGINFO;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGPROF, &sa, nullptr) != 0) return false;
+
+  s_enabled.store(true, std::memory_order_release);
+
+  itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = 1000000 / hz;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    s_enabled.store(false, std::memory_order_release);
+    return false;
+  }
+  return true;
+}
+
+void CpuProfiler::stop() {
+  if (!s_enabled.exchange(false, std::memory_order_acq_rel)) return;
+  itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+bool CpuProfiler::enabled() {
+  return s_enabled.load(std::memory_order_acquire);
+}
+
+int CpuProfiler::frequency() {
+  return s_hz;
+}
+
+uint64_t CpuProfiler::totalSamples() {
+  return s_cursor.load(std::memory_order_acquire);
+}
+
+std::vector<CpuProfiler::Row> CpuProfiler::getSamples(uint64_t& native) {
+  native = 0;
+  std::vector<Row> rows;
+  if (!s_entries) return rows;
+
+  auto const total = s_cursor.load(std::memory_order_acquire);
+  auto const n = std::min<uint64_t>(total, kNumEntries);
+
+  struct Counts { uint64_t self; uint64_t inclusive; };
+  std::map<std::pair<FuncId, int>, Counts> agg;
+
+  std::vector<std::pair<FuncId, int>> seen;
+  for (uint64_t i = 0; i < n; ++i) {
+    auto const& entry = s_entries[i];
+    auto const depth = std::min(std::max(entry.depth, 0), kMaxDepth);
+    if (depth == 0) {
+      ++native;
+      continue;
+    }
+
+    // Count each (func, line) at most once per sample for the inclusive
+    // tally, so recursion doesn't inflate it.
+    seen.clear();
+    for (int j = 0; j < depth; ++j) {
+      auto const& frame = entry.frames[j];
+      if (!Func::isFuncIdValid(frame.funcId)) continue;
+      auto const func = Func::fromFuncId(frame.funcId);
+      auto const line = resolveLine(func, frame.offset);
+
+      auto const key = std::make_pair(frame.funcId, line);
+      auto& counts = agg[key];
+      if (j == 0) ++counts.self;
+      if (std::find(seen.begin(), seen.end(), key) == seen.end()) {
+        ++counts.inclusive;
+        seen.push_back(key);
+      }
+    }
+  }
+
+  rows.reserve(agg.size());
+  for (auto const& kv : agg) {
+    if (!Func::isFuncIdValid(kv.first.first)) continue;
+    auto const func = Func::fromFuncId(kv.first.first);
+    Row row;
+    row.function = func->fullName()->data();
+    row.file = func->unit()->filepath()->data();
+    row.line = kv.first.second;
+    row.self = kv.second.self;
+    row.inclusive = kv.second.inclusive;
+    rows.push_back(std::move(row));
+  }
+  return rows;
+}
+
+void CpuProfiler::clearSamples() {
+  s_cursor.store(0, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
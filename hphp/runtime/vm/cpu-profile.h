@@ -0,0 +1,85 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_VM_CPU_PROFILE_H_
+#define incl_HPHP_VM_CPU_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HPHP {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A SIGPROF-driven sampling CPU profiler that attributes samples to PHP
+ * functions and lines, without relying on external perf tooling.
+ *
+ * On each profiling tick the signal handler walks the current VM frame chain
+ * (when the in-RDS registers are sync'd) and records FuncIds and bytecode
+ * offsets into a preallocated ring buffer.  The handler takes no locks and
+ * performs no allocation; all symbolization and aggregation is deferred to
+ * getSamples(), which runs on the admin thread.  Samples taken while a thread
+ * is in the JIT or in native code with dirty VM registers are counted in a
+ * separate native bucket.
+ *
+ * Controlled from the admin server:
+ *   /prof-cpu-sample-on   start sampling (optional "hz" parameter)
+ *   /prof-cpu-sample-off  stop sampling
+ *   /prof-cpu-sample      dump aggregated samples by function/line
+ */
+struct CpuProfiler {
+  struct Row {
+    std::string function;
+    std::string file;
+    int line;
+    uint64_t self;       // samples with this line at the top of the stack
+    uint64_t inclusive;  // samples with this line anywhere on the stack
+  };
+
+  /*
+   * Start delivering SIGPROF at `hz' samples per second of consumed CPU
+   * time.  Returns false if the profiler is already running or the timer
+   * can't be installed.
+   */
+  static bool start(int hz);
+
+  /*
+   * Stop the profiling timer.  Recorded samples stay available until
+   * clearSamples().
+   */
+  static void stop();
+
+  static bool enabled();
+  static int frequency();
+  static uint64_t totalSamples();
+
+  /*
+   * Aggregate the ring buffer into per-(function, line) rows.  `native' is
+   * set to the number of samples that couldn't be attributed to PHP
+   * execution.
+   */
+  static std::vector<Row> getSamples(uint64_t& native);
+
+  static void clearSamples();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif
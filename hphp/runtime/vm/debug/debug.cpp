@@ -17,6 +17,7 @@
 #include "hphp/runtime/vm/debug/debug.h"
 #include "hphp/runtime/vm/debug/gdb-jit.h"
 #include "hphp/runtime/vm/jit/mcgen.h"
+#include "hphp/runtime/vm/jit/relocation.h"
 
 #include "hphp/runtime/base/execution-context.h"
 
@@ -213,6 +214,8 @@ void DebugInfo::generatePidMapOverlay() {
     if (!size) continue;
     fprintf(m_perfMap, "%lx %x %s\n",
             long(sym.addr), size, demangled.c_str());
+    m_perfMapRecords[sym.addr] =
+      PerfMapRecord{size, 0, demangled.toStdString()};
   }
 
   return;
@@ -241,9 +244,55 @@ void DebugInfo::recordPerfMap(TCRange range, SrcKey /*sk*/, const Func* func,
   fflush(m_perfMap);
 
   //Dump the object code into the specified file
+  uint64_t codeIndex = 0;
   if (m_perfJitDump) {
-    perfJitDumpTrace(range.begin(), range.size(), name.c_str());
+    codeIndex = perfJitDumpTrace(range.begin(), range.size(), name.c_str());
   }
+
+  m_perfMapRecords[reinterpret_cast<uintptr_t>(range.begin())] =
+    PerfMapRecord{range.size(), codeIndex, name};
+}
+
+void DebugInfo::relocatePerfMap(const jit::RelocationInfo& rel) {
+  if (!m_perfMap && !m_perfJitDump) return;
+  if (m_perfMapRecords.empty()) return;
+
+  bool moved = false;
+  std::map<uintptr_t, PerfMapRecord> updated;
+
+  for (auto& kv : m_perfMapRecords) {
+    auto const start = reinterpret_cast<TCA>(kv.first);
+    auto const newStart = rel.adjustedAddressAfter(start);
+    if (!newStart) {
+      updated.emplace(kv.first, std::move(kv.second));
+      continue;
+    }
+    moved = true;
+
+    auto rec = std::move(kv.second);
+    if (auto const newEnd = rel.adjustedAddressBefore(start + rec.size)) {
+      rec.size = newEnd - newStart;
+    }
+    if (m_perfJitDump && rec.codeIndex) {
+      perfJitDumpMove(newStart, start, rec.size, rec.codeIndex);
+    }
+    updated.emplace(reinterpret_cast<uintptr_t>(newStart), std::move(rec));
+  }
+
+  if (!moved) return;
+  m_perfMapRecords = std::move(updated);
+
+  if (!m_perfMap) return;
+
+  // Rewrite the whole map, so that stale records can't shadow relocated code
+  // or anything later emitted at the vacated addresses.
+  m_perfMap = freopen(m_perfMapName.c_str(), "w", m_perfMap);
+  if (!m_perfMap) return;
+  for (auto const& kv : m_perfMapRecords) {
+    fprintf(m_perfMap, "%lx %x %s\n",
+            long(kv.first), kv.second.size, kv.second.name.c_str());
+  }
+  fflush(m_perfMap);
 }
 
 void DebugInfo::recordBCInstr(TCRange range, uint32_t op) {
@@ -16,13 +16,18 @@
 #ifndef TRANSLATOR_DEBUG_H_
 #define TRANSLATOR_DEBUG_H_
 
+#include <map>
 #include <string>
 
 #include "hphp/runtime/vm/jit/translator.h"
 #include "hphp/runtime/vm/hhbc.h"
 #include "hphp/runtime/vm/debug/dwarf.h"
 
-namespace HPHP { namespace Debug {
+namespace HPHP {
+
+namespace jit { struct RelocationInfo; }
+
+namespace Debug {
 
 //////////////////////////////////////////////////////////////////////
 
@@ -39,6 +44,15 @@ struct DebugInfo {
                      bool inPrologue, std::string stub = "");
   void recordBCInstr(TCRange range, uint32_t op);
 
+  /*
+   * Update the perf map and jitdump file after live relocation: move every
+   * record whose code was relocated by `rel', rewrite /tmp/perf-<pid>.map
+   * with the adjusted addresses, and emit JIT_CODE_MOVE jitdump records.
+   *
+   * The caller must own the code lock, like the writers above.
+   */
+  void relocatePerfMap(const jit::RelocationInfo& rel);
+
   static void recordDataMap(const void* from, const void* to,
                             const std::string& desc);
   void recordRelocMap(void* from, void* to, const std::string& desc);
@@ -60,9 +74,13 @@ struct DebugInfo {
   void generatePidMapOverlay();
   void initPerfJitDump();
   void closePerfJitDump();
-  int perfJitDumpTrace(const void* startAddr,
-                       const unsigned int size,
-                       const char* symName);
+  uint64_t perfJitDumpTrace(const void* startAddr,
+                            const unsigned int size,
+                            const char* symName);
+  int perfJitDumpMove(const void* newAddr,
+                      const void* oldAddr,
+                      const unsigned int size,
+                      uint64_t codeIndex);
 
   /* maintain separate dwarf info for a and acold, so that we
    * don't emit dwarf info for the two in the same ELF file.
@@ -78,6 +96,19 @@ struct DebugInfo {
   FILE* m_perfMap{nullptr};
   std::string m_perfMapName;
 
+  /*
+   * Everything written to the perf map, keyed by start address, so that the
+   * map can be rewritten when code is relocated.  codeIndex is the jitdump
+   * index of the record's JIT_CODE_LOAD (0 if none), which a JIT_CODE_MOVE
+   * has to repeat.
+   */
+  struct PerfMapRecord {
+    uint32_t size;
+    uint64_t codeIndex;
+    std::string name;
+  };
+  std::map<uintptr_t, PerfMapRecord> m_perfMapRecords;
+
   /*
    * jitdump file will store the generated code in /tmp/jit-<pid>.dump
    * perf record will create perf.data
@@ -229,11 +229,11 @@ void DebugInfo::closePerfJitDump() {
  * it holds the write lease, hence there is no need to acquire
  * the lock when writing to jit-<pid>.dump
  */
-int DebugInfo::perfJitDumpTrace(const void* startAddr,
-                                const unsigned int size,
-                                const char* symName)  {
+uint64_t DebugInfo::perfJitDumpTrace(const void* startAddr,
+                                     const unsigned int size,
+                                     const char* symName)  {
 
-  if (!startAddr || !size) return -1;
+  if (!startAddr || !size) return 0;
 
   static int code_generation = 1;
   JitRecCodeLoad rec;
@@ -268,6 +268,36 @@ int DebugInfo::perfJitDumpTrace(const void* startAddr,
   /* write the code generated for the tracelet */
   fwrite(startAddr, size, 1, m_perfJitDump);
 
+  fflush(m_perfJitDump);
+  return rec.code_index;
+}
+
+/*
+ * Record that previously dumped code has been relocated, repeating the
+ * code_index of its JIT_CODE_LOAD so that perf inject can associate the two.
+ */
+int DebugInfo::perfJitDumpMove(const void* newAddr,
+                               const void* oldAddr,
+                               const unsigned int size,
+                               uint64_t codeIndex)  {
+
+  if (!newAddr || !oldAddr || !size) return -1;
+
+  JitRecCodeMove rec;
+
+  rec.p.id          = JitRecordType::JIT_CODE_MOVE;
+  rec.p.total_size  = sizeof(rec);
+  rec.p.timestamp   = perfGetTimestamp();
+
+  rec.pid           = getpid();
+  rec.tid           = (pid_t)syscall(FOLLY_SYS_gettid);
+  rec.vma           = reinterpret_cast<uintptr_t>(newAddr);
+  rec.old_code_addr = reinterpret_cast<uintptr_t>(oldAddr);
+  rec.new_code_addr = reinterpret_cast<uintptr_t>(newAddr);
+  rec.code_size     = size;
+  rec.code_index    = codeIndex;
+
+  fwrite(&rec, sizeof(rec), 1, m_perfJitDump);
   fflush(m_perfJitDump);
   return 0;
 }
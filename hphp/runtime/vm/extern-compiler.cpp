@@ -19,13 +19,15 @@
 #include "hphp/runtime/vm/as.h"
 #include "hphp/runtime/vm/repo.h"
 #include "hphp/runtime/vm/verifier/check.h"
-#include "hphp/util/atomic-vector.h"
 #include "hphp/util/light-process.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/md5.h"
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <vector>
+
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -51,14 +53,15 @@ struct CompilerOptions {
   bool verifyUnit;
   uint64_t maxRetries;
   uint64_t workers;
+  uint64_t pipelineDepth;
   std::string command;
 };
 
 struct ExternCompiler {
   explicit ExternCompiler(const CompilerOptions& options)
     : m_options(options) {}
-  ExternCompiler(ExternCompiler&&) = default;
-  ExternCompiler& operator=(ExternCompiler&&) = default;
+  ExternCompiler(ExternCompiler&&) = delete;
+  ExternCompiler& operator=(ExternCompiler&&) = delete;
   ~ExternCompiler() { if (isRunning()) stop(); }
 
   std::unique_ptr<Unit> compile(
@@ -66,19 +69,10 @@ struct ExternCompiler {
     const MD5& md5,
     folly::StringPiece code
   ) {
-    if (RuntimeOption::EvalHackCompilerReset &&
-        m_compilations > RuntimeOption::EvalHackCompilerReset) {
-      stop();
-    }
-
-    if (!isRunning()) start();
-
     std::string prog;
     std::unique_ptr<Unit> u;
     try {
-      m_compilations++;
-      writeProgram(filename, md5, code);
-      prog = readProgram();
+      prog = sendAndWait(filename, md5, code);
       auto ue = assemble_string(
         prog.data(),
         prog.length(),
@@ -97,7 +91,8 @@ struct ExternCompiler {
 
       return u;
     } catch (CompilerException& ex) {
-      stop();
+      // The pipeline has been marked broken; the process is restarted by
+      // whichever request next finds it broken and fully drained.
       if (m_options.verboseErrors) {
         Logger::FError("ExternCompiler Error: {}", ex.what());
       }
@@ -132,6 +127,92 @@ private:
   void stop();
   bool isRunning() const { return m_pid != -1; }
 
+  /*
+   * Write one request and wait for its response.
+   *
+   * Multiple requests may be in flight to the compiler at once; the daemon
+   * answers them in request order over its stdout pipe, so each request
+   * takes a ticket when its program is written and responses are read
+   * strictly in ticket order.  Writes are serialized by m_lock; the read
+   * itself happens with the lock dropped so later requests can be written
+   * while an earlier one waits on its response.
+   *
+   * If the pipe fails, the pipeline is marked broken: every in-flight
+   * request fails with a CompilerException, and the process is restarted
+   * once the last of them has drained out.
+   */
+  std::string sendAndWait(
+    const char* filename,
+    const MD5& md5,
+    folly::StringPiece code
+  ) {
+    uint64_t ticket;
+    {
+      std::unique_lock<std::mutex> l(m_lock);
+      // A broken pipeline can only be torn down once every in-flight
+      // request has seen the failure.
+      m_cv.wait(l, [&] { return !m_broken || !m_inflight; });
+      if (m_broken) stop();
+      if (RuntimeOption::EvalHackCompilerReset &&
+          m_compilations > RuntimeOption::EvalHackCompilerReset &&
+          !m_inflight) {
+        stop();
+      }
+      if (!isRunning()) start();
+
+      m_compilations++;
+      ticket = m_nextTicket++;
+      ++m_inflight;
+      try {
+        writeProgram(filename, md5, code);
+      } catch (...) {
+        m_broken = true;
+        --m_inflight;
+        m_cv.notify_all();
+        throw;
+      }
+    }
+
+    SCOPE_EXIT {
+      std::unique_lock<std::mutex> l(m_lock);
+      --m_inflight;
+      m_cv.notify_all();
+    };
+    return readResult(ticket);
+  }
+
+  std::string readResult(uint64_t ticket) {
+    std::unique_lock<std::mutex> l(m_lock);
+    m_cv.wait(l, [&] { return m_nextRead == ticket || m_broken; });
+    if (m_broken) {
+      throw CompilerException(
+        "compiler failed while this request was in flight"
+      );
+    }
+
+    // Only the ticket's owner reaches this point, so it's safe to read with
+    // the lock dropped while later requests are being written.
+    l.unlock();
+    try {
+      auto ret = readProgram();
+      l.lock();
+      ++m_nextRead;
+      m_cv.notify_all();
+      return ret;
+    } catch (const std::runtime_error&) {
+      // A per-file compile error; the pipeline is still healthy.
+      l.lock();
+      ++m_nextRead;
+      m_cv.notify_all();
+      throw;
+    } catch (...) {
+      l.lock();
+      m_broken = true;
+      m_cv.notify_all();
+      throw;
+    }
+  }
+
   void writeProgram(const char* filename, MD5 md5, folly::StringPiece code);
   std::string readProgram() const;
 
@@ -139,6 +220,13 @@ private:
   FILE* m_in{nullptr};
   FILE* m_out{nullptr};
 
+  std::mutex m_lock;
+  std::condition_variable m_cv;
+  uint64_t m_nextTicket{0};
+  uint64_t m_nextRead{0};
+  unsigned m_inflight{0};
+  bool m_broken{false};
+
   unsigned m_compilations{0};
   const CompilerOptions& m_options;
 };
@@ -151,41 +239,60 @@ struct CompilerPool {
     : m_options(options) {}
 
   std::pair<size_t, ExternCompiler*> getCompiler();
-  void releaseCompiler(size_t id, ExternCompiler* ptr);
+  void releaseCompiler(size_t id);
   void start();
   void shutdown();
   CompilerResult compile(const char* code, int len,
       const char* filename, const MD5& md5);
 
  private:
-  std::atomic<size_t> m_freeCount{0};
   std::mutex m_compilerLock;
   std::condition_variable m_compilerCv;
-  AtomicVector<ExternCompiler*> m_compilers{0, nullptr};
+  std::vector<std::unique_ptr<ExternCompiler>> m_compilers;
+  std::vector<unsigned> m_outstanding;
+  unsigned m_pipelineDepth{1};
   CompilerOptions m_options;
 };
 
+/*
+ * The compiler this thread last used.  Compiles from one thread tend to be
+ * related (e.g. a request loading a tree of includes), so sending them to
+ * the same daemon keeps its caches warm.  An index can refer to a
+ * different pool than the one that set it; getCompiler() only treats it as
+ * a hint and validates it against its own pool.
+ */
+thread_local ssize_t tl_lastCompiler = -1;
+
 std::pair<size_t, ExternCompiler*> CompilerPool::getCompiler() {
   std::unique_lock<std::mutex> l(m_compilerLock);
 
-  m_compilerCv.wait(l, [&] {
-    return m_freeCount.load(std::memory_order_relaxed) != 0;
-  });
-  m_freeCount -= 1;
-
-  for (size_t id = 0; id < m_compilers.size(); ++id) {
-    auto ret = m_compilers.exchange(id, nullptr);
-    if (ret) return std::make_pair(id, ret);
-  }
+  auto const pick = [&]() -> ssize_t {
+    // Sticky: prefer the compiler this thread used last time when it still
+    // has pipeline capacity.
+    if (tl_lastCompiler >= 0 &&
+        size_t(tl_lastCompiler) < m_compilers.size() &&
+        m_outstanding[tl_lastCompiler] < m_pipelineDepth) {
+      return tl_lastCompiler;
+    }
+    ssize_t best = -1;
+    for (size_t i = 0; i < m_compilers.size(); ++i) {
+      if (m_outstanding[i] >= m_pipelineDepth) continue;
+      if (best < 0 || m_outstanding[i] < m_outstanding[best]) best = i;
+    }
+    return best;
+  };
 
-  not_reached();
+  ssize_t id = -1;
+  m_compilerCv.wait(l, [&] { return (id = pick()) >= 0; });
+  ++m_outstanding[id];
+  tl_lastCompiler = id;
+  return std::make_pair(size_t(id), m_compilers[id].get());
 }
 
-void CompilerPool::releaseCompiler(size_t id, ExternCompiler* ptr) {
+void CompilerPool::releaseCompiler(size_t id) {
   std::unique_lock<std::mutex> l(m_compilerLock);
 
-  m_compilers[id].store(ptr, std::memory_order_relaxed);
-  m_freeCount += 1;
+  --m_outstanding[id];
 
   l.unlock();
   m_compilerCv.notify_one();
@@ -193,19 +300,18 @@ void CompilerPool::releaseCompiler(size_t id, ExternCompiler* ptr) {
 
 void CompilerPool::start() {
   auto const nworkers = m_options.workers;
-  m_freeCount.store(nworkers, std::memory_order_relaxed);
-  UnsafeReinitEmptyAtomicVector(m_compilers, nworkers);
-  for (int i = 0; i < nworkers; ++i) {
-    m_compilers[i].store(new ExternCompiler(m_options),
-        std::memory_order_relaxed);
+  m_pipelineDepth = std::max<uint64_t>(1, m_options.pipelineDepth);
+  std::unique_lock<std::mutex> l(m_compilerLock);
+  for (uint64_t i = 0; i < nworkers; ++i) {
+    m_compilers.push_back(std::make_unique<ExternCompiler>(m_options));
   }
+  m_outstanding.assign(m_compilers.size(), 0);
 }
 
 void CompilerPool::shutdown() {
-  for (int i = 0; i < m_compilers.size(); ++i) {
-    auto c = m_compilers.exchange(i, nullptr);
-    delete c;
-  }
+  std::unique_lock<std::mutex> l(m_compilerLock);
+  m_compilers.clear();
+  m_outstanding.clear();
 }
 
 struct CompilerGuard final {
@@ -215,7 +321,7 @@ struct CompilerGuard final {
   }
 
   ~CompilerGuard() {
-    m_pool.releaseCompiler(m_index, m_ptr);
+    m_pool.releaseCompiler(m_index);
   }
 
   CompilerGuard(CompilerGuard&&) = delete;
@@ -340,6 +446,8 @@ void ExternCompiler::stop() {
   };
 
   m_compilations = 0;
+  m_nextTicket = m_nextRead = 0;
+  m_broken = false;
 
   int status, code;
   kill(m_pid, SIGTERM);
@@ -425,6 +533,7 @@ folly::Optional<CompilerOptions> hackcConfiguration() {
     RuntimeOption::EvalHackCompilerVerify,
     RuntimeOption::EvalHackCompilerMaxRetries,
     RuntimeOption::EvalHackCompilerWorkers,
+    RuntimeOption::EvalHackCompilerPipelineDepth,
     RuntimeOption::EvalHackCompilerCommand
   };
 }
@@ -439,6 +548,7 @@ folly::Optional<CompilerOptions> php7Configuration() {
     true, // verifyUnit
     0, // maxRetries
     1, // workers
+    1, // pipelineDepth
     RuntimeOption::EvalPHP7CompilerCommand, // command
   };
 }
@@ -23,7 +23,17 @@ struct Func;
 
 namespace FSM {
 
-extern const StringData* null_key;
+/*
+ * Shared table for empty maps: a zero displacement entry immediately followed
+ * by a null key, so that find() can run its normal lookup sequence against a
+ * map with no elements.
+ */
+struct EmptyMap {
+  uint16_t pad[3];
+  uint16_t disp;
+  const StringData* null_key;
+};
+extern EmptyMap empty_map;
 
 template<bool CaseSensitive>
 inline bool strEqual(const StringData* sd1, const StringData* sd2) {
@@ -33,13 +43,25 @@ inline bool strEqual(const StringData* sd1, const StringData* sd2) {
 
 }
 
+/*
+ * Default-constructed maps are usable empty maps: m_table points into the
+ * shared empty-map sentinel, so find() runs its normal probe sequence and
+ * misses.  This lets a FixedStringMap that is never init()ed (e.g. one living
+ * in a shared default-constructed structure) be queried safely.
+ */
+template<class V, bool CaseSensitive, class E>
+inline FixedStringMap<V,CaseSensitive,E>::FixedStringMap()
+  : m_mask(0)
+  , m_table((Elm*)&FSM::empty_map.null_key + 1)
+{}
+
 template<class V, bool CaseSensitive, class E>
 NEVER_INLINE
 void FixedStringMap<V,CaseSensitive,E>::clear() {
-  if (m_table && m_table != (Elm*)&FSM::null_key + 1) {
-    free_huge(m_table - m_mask - 1);
+  if (m_table && m_table != (Elm*)&FSM::empty_map.null_key + 1) {
+    free_huge((char*)(m_table - m_mask - 1) - dispByteSize(m_mask + 1));
   }
-  m_table = nullptr;
+  m_table = (Elm*)&FSM::empty_map.null_key + 1;
   m_mask = 0;
 }
 
@@ -47,7 +69,7 @@ template<class V, bool CaseSensitive, class E>
 NEVER_INLINE
 void FixedStringMap<V,CaseSensitive,E>::init(int num, uint32_t numExtraBytes) {
   if (!num && !numExtraBytes) {
-    m_table = (Elm*)&FSM::null_key + 1;
+    m_table = (Elm*)&FSM::empty_map.null_key + 1;
     m_mask = 0;
     return;
   }
@@ -58,11 +80,12 @@ void FixedStringMap<V,CaseSensitive,E>::init(int num, uint32_t numExtraBytes) {
     capac *= 2;
   }
   TRACE_MOD(Trace::runtime, 1, "FixedStringMap::init: %d -> %d\n", num, capac);
-  assert(!m_table);
-  auto const allocSize = capac * sizeof(Elm) + numExtraBytes;
+  assert(!m_table || m_table == (Elm*)&FSM::empty_map.null_key + 1);
+  auto const dispBytes = dispByteSize(capac);
+  auto const allocSize = dispBytes + capac * sizeof(Elm) + numExtraBytes;
   auto ptr = malloc_huge(allocSize);
   std::memset(ptr, 0, allocSize);
-  m_table = (Elm*)ptr + capac;
+  m_table = (Elm*)((char*)ptr + dispBytes) + capac;
   assert(m_table);
   m_mask = capac - 1;
 }
@@ -72,7 +95,8 @@ NEVER_INLINE
 void FixedStringMap<V,CaseSensitive,E>::add(const StringData* sd, const V& v) {
   assert(sd->isStatic());
 
-  Elm* elm = &m_table[-1 - int32_t(sd->hash() & m_mask)];
+  auto const h = sd->hash();
+  Elm* elm = &m_table[-1 - int32_t((h + dispTable()[bucketFor(h)]) & m_mask)];
   UNUSED unsigned numProbes = 0;
   while (elm->sd) {
     assert(numProbes++ < m_mask + 1);
@@ -87,7 +111,8 @@ void FixedStringMap<V,CaseSensitive,E>::add(const StringData* sd, const V& v) {
 template<class V, bool CaseSensitive, class E>
 NEVER_INLINE
 V* FixedStringMap<V,CaseSensitive,E>::find(const StringData* sd) const {
-  Elm* elm = &m_table[-1 - int32_t(sd->hash() & m_mask)];
+  auto const h = sd->hash();
+  Elm* elm = &m_table[-1 - int32_t((h + dispTable()[bucketFor(h)]) & m_mask)];
   UNUSED unsigned numProbes = 0;
   for(;;) {
     assert(numProbes++ < m_mask + 1);
@@ -97,6 +122,83 @@ V* FixedStringMap<V,CaseSensitive,E>::find(const StringData* sd) const {
   }
 }
 
+template<class V, bool CaseSensitive, class E>
+template<class Iter>
+NEVER_INLINE
+void FixedStringMap<V,CaseSensitive,E>::setDisplacements(Iter first,
+                                                         Iter last) {
+  if (!m_mask) return;
+  auto const capac = m_mask + 1;
+
+  // Group the keys' hashes by displacement bucket.
+  std::vector<std::vector<strhash_t>> buckets(capac);
+  for (auto it = first; it != last; ++it) {
+    auto const h = it->first->hash();
+    buckets[bucketFor(h)].push_back(h);
+  }
+
+  std::vector<uint32_t> multi;
+  std::vector<uint32_t> single;
+  for (uint32_t b = 0; b < capac; ++b) {
+    if (buckets[b].size() > 1) {
+      multi.push_back(b);
+    } else if (buckets[b].size() == 1) {
+      single.push_back(b);
+    }
+  }
+  std::sort(multi.begin(), multi.end(), [&](uint32_t a, uint32_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  constexpr auto kMaxDisp = std::numeric_limits<uint16_t>::max();
+  std::vector<bool> used(capac, false);
+  auto const disp = dispTable();
+
+  // Hardest buckets first: find a displacement under which every key in the
+  // bucket gets its own free slot.
+  for (auto const b : multi) {
+    auto const& keys = buckets[b];
+    auto const tries = std::min<uint32_t>(capac, uint32_t(kMaxDisp) + 1);
+    for (uint32_t d = 0; d < tries; ++d) {
+      bool ok = true;
+      for (size_t i = 0; i < keys.size() && ok; ++i) {
+        auto const slot = uint32_t(keys[i] + d) & m_mask;
+        if (used[slot]) {
+          ok = false;
+          break;
+        }
+        for (size_t j = 0; j < i; ++j) {
+          if ((uint32_t(keys[j] + d) & m_mask) == slot) {
+            ok = false;
+            break;
+          }
+        }
+      }
+      if (!ok) continue;
+      disp[b] = d;
+      for (auto const h : keys) used[uint32_t(h + d) & m_mask] = true;
+      break;
+    }
+  }
+
+  // Singleton buckets just need any free slot.
+  uint32_t cursor = 0;
+  for (auto const b : single) {
+    auto const h = buckets[b][0];
+    if (!used[uint32_t(h) & m_mask]) {
+      // Already in place with displacement 0.
+      used[uint32_t(h) & m_mask] = true;
+      continue;
+    }
+    while (cursor < capac && used[cursor]) ++cursor;
+    if (cursor == capac) break;
+    auto const d = (cursor - uint32_t(h)) & m_mask;
+    if (d > kMaxDisp) continue;
+    disp[b] = d;
+    used[cursor++] = true;
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 template<class T, class V, bool case_sensitive, class E>
@@ -139,6 +241,7 @@ void FixedStringMapBuilder<T,V,case_sensitive,E>::create(FSMap& map) {
   if (!size()) {
     return;
   }
+  map.setDisplacements(begin(), end());
   for (const_iterator it = begin(); it != end(); ++it) {
     map.add(it->first, it->second);
   }
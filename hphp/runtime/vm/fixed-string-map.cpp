@@ -19,7 +19,7 @@
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
-namespace FSM { const StringData* null_key; }
+namespace FSM { EmptyMap empty_map; }
 
 ///////////////////////////////////////////////////////////////////////////////
 }
@@ -17,6 +17,7 @@
 #ifndef incl_HPHP_FIXED_STRING_MAP_H_
 #define incl_HPHP_FIXED_STRING_MAP_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <limits>
 #include <vector>
@@ -33,7 +34,7 @@ namespace HPHP {
 template<class V, bool case_sensitive, class ExtraType = int32_t>
 struct FixedStringMap {
   explicit FixedStringMap(int num) : m_table(nullptr) { init(num); }
-  FixedStringMap() : m_mask(0), m_table(nullptr) {}
+  FixedStringMap();
   ~FixedStringMap() { clear(); }
 
   FixedStringMap(const FixedStringMap&) = delete;
@@ -44,6 +45,20 @@ struct FixedStringMap {
   void add(const StringData* s, const V& v);
   V* find(const StringData* s) const;
 
+  /*
+   * Precompute perfect-hash displacements for a fixed key set, so that each
+   * key is placed exactly at its displaced slot and find() hits it on the
+   * first element probe.  Must be called after init() and before the keys are
+   * add()ed.  Buckets that can't be perfectly placed (e.g. two keys with
+   * identical hashes) keep displacement 0 and their keys fall back to linear
+   * probing, so this is strictly best-effort.
+   *
+   * Maps that are filled without calling this (or with keys not known up
+   * front) leave every displacement 0 and behave exactly like a plain
+   * open-addressed table.
+   */
+  template<class Iter> void setDisplacements(Iter first, Iter last);
+
   void* extraData() { return m_table; }
   const void* extraData() const { return m_table; }
   ExtraType& extra() { return m_extra; }
@@ -66,6 +81,25 @@ private:
     V data;
   };
 
+  /*
+   * A uint16_t displacement array of m_mask + 1 entries sits immediately
+   * before the element table; a key's slot is (hash + displacement) & m_mask,
+   * where the displacement is selected by a different slice of the hash.  See
+   * setDisplacements().
+   */
+  uint32_t bucketFor(strhash_t h) const {
+    // Mix so the bucket isn't correlated with the index bits (h & m_mask).
+    return (uint32_t(h) * 0x9e3779b9u >> 16) & m_mask;
+  }
+  uint16_t* dispTable() const {
+    return (uint16_t*)(m_table - (m_mask + 1)) - (m_mask + 1);
+  }
+  static size_t dispByteSize(uint32_t capac) {
+    // Padded so the element table that follows keeps Elm's alignment.
+    return (capac * sizeof(uint16_t) + alignof(Elm) - 1) &
+           ~(alignof(Elm) - 1);
+  }
+
   /*
    * The fields we need here are just m_mask and m_table.  This would leave 4
    * byte padding hole, though, which some users (e.g. IndexedStringMap) might
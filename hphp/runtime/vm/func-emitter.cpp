@@ -468,6 +468,8 @@ void FuncEmitter::setEHTabIsSorted() {
  *      Note that systemlib declaration must still be hack annotated
  *  "NoFCallBuiltin": Prevent FCallBuiltin optimization
  *      Effectively forces functions to generate an ActRec
+ *  "Leaf": Function cannot raise errors, throw, or reenter the VM,
+ *      so JITed calls to it skip the catch trace and VM register sync
  *  "NoInjection": Do not include this frame in backtraces
  *  "ZendCompat": Use zend compat wrapper
  *  "ReadsCallerFrame": Function might read from the caller's frame
@@ -479,6 +481,7 @@ static const StaticString
   s_native("__Native"),
   s_actrec("ActRec"),
   s_nofcallbuiltin("NoFCallBuiltin"),
+  s_leaf("Leaf"),
   s_variadicbyref("VariadicByRef"),
   s_noinjection("NoInjection"),
   s_zendcompat("ZendCompat"),
@@ -503,6 +506,8 @@ int FuncEmitter::parseNativeAttributes(Attr& attrs_) const {
         attrs_ |= AttrMayUseVV;
       } else if (userAttrStrVal.get()->isame(s_nofcallbuiltin.get())) {
         attrs_ |= AttrNoFCallBuiltin;
+      } else if (userAttrStrVal.get()->isame(s_leaf.get())) {
+        attrs_ |= AttrLeafBuiltin;
       } else if (userAttrStrVal.get()->isame(s_variadicbyref.get())) {
         attrs_ |= AttrVariadicByRef;
       } else if (userAttrStrVal.get()->isame(s_noinjection.get())) {
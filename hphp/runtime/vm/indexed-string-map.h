@@ -74,6 +74,7 @@ struct IndexedStringMap {
     }
 
     std::copy(b.m_list.begin(), b.m_list.end(), mutableAccessList());
+    m_map.setDisplacements(b.begin(), b.end());
     for (typename Builder::const_iterator it = b.begin();
         it != b.end();
         ++it) {
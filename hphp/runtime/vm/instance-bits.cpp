@@ -55,7 +55,14 @@ Mutex s_initLock(RankInstanceBitsInit);
 
 constexpr size_t kNumInstanceBits = sizeof(BitSet) * CHAR_BIT;
 
-// Tracked just for an assertion in lookup().
+// First unallocated bit; only accessed with s_initLock held.
+unsigned s_nextBit = 1;
+
+// Profiled checks accumulated since the last (re)assignment of bits, used to
+// trigger update().
+std::atomic<uint64_t> s_profiledSinceUpdate{0};
+
+// Tracked just for an assertion in lookupLocked().
 std::atomic<pthread_t> s_initThread;
 
 }
@@ -84,12 +91,25 @@ void profile(const StringData* name) {
     inc = 250;
   }
 
-  // The extra layer of locking is here so that InstanceBits::init can safely
-  // iterate over s_instanceCounts while building its map of names to bits.
-  SharedMutex::ReadHolder l(s_instanceCountsLock);
-  InstanceCounts::accessor acc;
-  if (!s_instanceCounts.insert(acc, InstanceCounts::value_type(name, inc))) {
-    acc->second += inc;
+  {
+    // The extra layer of locking is here so that InstanceBits::init can safely
+    // iterate over s_instanceCounts while building its map of names to bits.
+    SharedMutex::ReadHolder l(s_instanceCountsLock);
+    InstanceCounts::accessor acc;
+    if (!s_instanceCounts.insert(acc, InstanceCounts::value_type(name, inc))) {
+      acc->second += inc;
+    }
+  }
+
+  // After the initial assignment, profiling only remains enabled while
+  // unallocated bits remain; periodically hand them out to classes that got
+  // hot late.
+  auto const threshold = RuntimeOption::EvalInstanceBitsUpdateThreshold;
+  if (threshold && g_initFlag.load(std::memory_order_acquire) &&
+      s_profiledSinceUpdate.fetch_add(inc, std::memory_order_relaxed) + inc >=
+        threshold) {
+    s_profiledSinceUpdate.store(0, std::memory_order_relaxed);
+    update();
   }
 }
 
@@ -151,6 +171,7 @@ void init() {
       ++i;
     }
   }
+  s_nextBit = i;
 
   // Print out stats about what we ended up using
   if (Trace::moduleEnabledRelease(Trace::instancebits, 1)) {
@@ -190,6 +211,70 @@ void init() {
     s_initThread.store(pthread_t{}, std::memory_order_release);
   }
   g_initFlag.store(true, std::memory_order_release);
+
+  // If any bits are left unallocated, keep profiling so that update() can
+  // hand them out to classes that only get hot after warmup.
+  if (RuntimeOption::EvalInstanceBitsUpdateThreshold &&
+      s_nextBit < kNumInstanceBits) {
+    g_profileDoneFlag.store(false, std::memory_order_release);
+  }
+}
+
+void update() {
+  if (!g_initFlag.load(std::memory_order_acquire)) return;
+
+  Lock l(s_initLock);
+  if (s_nextBit >= kNumInstanceBits) return;
+
+  // Stop profiling while we iterate over s_instanceCounts, for the same
+  // starvation reasons as in init().
+  g_profileDoneFlag.store(true, std::memory_order_release);
+
+  typedef std::pair<const StringData*, unsigned> Count;
+  std::vector<Count> counts;
+  {
+    SharedMutex::WriteHolder l(s_instanceCountsLock);
+    for (auto& pair : s_instanceCounts) {
+      counts.push_back(pair);
+    }
+  }
+  std::sort(counts.begin(), counts.end(), [&](const Count& a, const Count& b) {
+    return a.second > b.second;
+  });
+
+  {
+    // Assign leftover bits to the hottest names that missed out on the
+    // initial assignment.  Existing assignments never change, so translations
+    // that already test a bit stay correct; we only ever add bits, and
+    // republish them on every live Class before dropping the lock that
+    // serializes us against Class creation.
+    SharedMutex::WriteHolder clsLocker(g_clsInitLock);
+    unsigned added = 0;
+    for (auto& item : counts) {
+      if (s_nextBit >= kNumInstanceBits) break;
+      if (folly::get_ptr(s_instanceBitsMap, item.first)) continue;
+      auto const cls = Unit::lookupUniqueClassInContext(item.first, nullptr);
+      if (cls) {
+        assertx(cls->attrs() & AttrUnique);
+        s_instanceBitsMap[item.first] = s_nextBit++;
+        ++added;
+      }
+    }
+    if (added) {
+      if (Trace::moduleEnabledRelease(Trace::instancebits, 1)) {
+        Trace::traceRelease("%s: assigned %u more bits, %u in use\n",
+                            __FUNCTION__, added, s_nextBit - 1);
+      }
+
+      NamedEntity::foreach_class([&](Class* cls) {
+        cls->recomputeInstanceBitsAndParents();
+      });
+    }
+  }
+
+  if (s_nextBit < kNumInstanceBits) {
+    g_profileDoneFlag.store(false, std::memory_order_release);
+  }
 }
 
 bool initted() {
@@ -197,6 +282,11 @@ bool initted() {
 }
 
 unsigned lookup(const StringData* name) {
+  SharedMutex::ReadHolder l(g_clsInitLock);
+  return lookupLocked(name);
+}
+
+unsigned lookupLocked(const StringData* name) {
   assert(g_initFlag.load(std::memory_order_acquire) ||
          pthread_equal(s_initThread.load(std::memory_order_acquire),
                        pthread_self()));
@@ -57,11 +57,11 @@ extern std::atomic<bool> g_initFlag;
  *
  * This mechanism lets us synchronize Class creation with instance bits
  * initialization to ensure that all Classes get correct instance bits set.
+ * The lock is held even once initialization has finished, because update()
+ * may later assign leftover bits and republish them on every live Class.
  */
 template<class Init, class Uninit>
 void ifInitElse(Init init, Uninit uninit) {
-  if (g_initFlag.load(std::memory_order_acquire)) return init();
-
   folly::SharedMutex::ReadHolder l(g_clsInitLock);
 
   if (g_initFlag.load(std::memory_order_acquire)) {
@@ -84,14 +84,30 @@ void profile(const StringData* name);
 bool initted();
 void init();
 
+/*
+ * Assign any bits still unallocated after init() to classes whose instanceof
+ * checks only got hot later on (e.g. in late-loaded units).  Existing
+ * assignments never change, so translations already testing a bit stay
+ * correct; checks against newly assigned names pick up the single-test-bit
+ * path when they are retranslated.
+ *
+ * Called periodically from profile(), as controlled by
+ * Eval.InstanceBitsUpdateThreshold.  No-op until init() has finished and once
+ * all bits have been handed out.
+ */
+void update();
+
 /*
  * Returns: the instance bit for the class or interface `name', or 0 if there
  * is no allocated bit.
  *
  * This function may only be called after init() is finished (i.e. initFlag
- * == true).
+ * == true).  lookup() synchronizes with concurrent bit assignment in
+ * update(); lookupLocked() skips that synchronization and may only be called
+ * with g_clsInitLock held.
  */
 unsigned lookup(const StringData* name);
+unsigned lookupLocked(const StringData* name);
 
 /*
  * Populate a mask and offset for checking instance bits from JIT compiled
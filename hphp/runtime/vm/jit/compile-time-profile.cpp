@@ -0,0 +1,109 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/runtime/vm/jit/compile-time-profile.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <folly/Format.h>
+
+namespace HPHP { namespace jit {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct TransTimeRec {
+  TransID id;
+  TransKind kind;
+  std::string sk;
+  int64_t totalNanos;
+  // Nonzero per-pass deltas, in nanoseconds.  Nested timers (optimize vs.
+  // optimize_dce, say) overlap, so these don't sum to totalNanos.
+  std::vector<std::pair<const char*,int64_t>> passes;
+};
+
+std::mutex s_lock;
+std::vector<TransTimeRec> s_records;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void recordCompileTimeProfile(TransID id, TransKind kind, SrcKey sk,
+                              int64_t totalNanos,
+                              const Timer::CounterVec& before,
+                              const Timer::CounterVec& after) {
+  TransTimeRec rec;
+  rec.id = id;
+  rec.kind = kind;
+  rec.sk = showShort(sk);
+  rec.totalNanos = totalNanos;
+  assertx(before.size() == after.size());
+  for (size_t i = 0; i < after.size(); ++i) {
+    auto const delta = after[i].second.total - before[i].second.total;
+    if (delta <= 0) continue;
+    rec.passes.emplace_back(after[i].first, delta);
+  }
+  std::sort(rec.passes.begin(), rec.passes.end(),
+            [] (const std::pair<const char*,int64_t>& a,
+                const std::pair<const char*,int64_t>& b) {
+              return a.second > b.second;
+            });
+
+  std::lock_guard<std::mutex> g(s_lock);
+  s_records.push_back(std::move(rec));
+}
+
+std::string showCompileTimeProfile(bool clear) {
+  std::vector<TransTimeRec> records;
+  {
+    std::lock_guard<std::mutex> g(s_lock);
+    if (clear) {
+      records.swap(s_records);
+    } else {
+      records = s_records;
+    }
+  }
+
+  std::sort(records.begin(), records.end(),
+            [] (const TransTimeRec& a, const TransTimeRec& b) {
+              return a.totalNanos > b.totalNanos;
+            });
+
+  int64_t total = 0;
+  for (auto const& rec : records) total += rec.totalNanos;
+
+  std::string ret;
+  folly::format(&ret, "{} translation(s), {:,}us total compile time\n\n",
+                records.size(), total / 1000);
+  for (auto const& rec : records) {
+    folly::format(&ret, "TransID {} ({}) {}: {:,}us\n",
+                  rec.id == kInvalidTransID ? -1 : (int64_t)rec.id,
+                  show(rec.kind), rec.sk, rec.totalNanos / 1000);
+    for (auto const& pass : rec.passes) {
+      folly::format(&ret, "  {:<35} {:>10,}us\n",
+                    pass.first, pass.second / 1000);
+    }
+  }
+  return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}
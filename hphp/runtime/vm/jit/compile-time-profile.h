@@ -0,0 +1,61 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_JIT_COMPILE_TIME_PROFILE_H_
+#define incl_HPHP_JIT_COMPILE_TIME_PROFILE_H_
+
+#include "hphp/runtime/vm/jit/timer.h"
+#include "hphp/runtime/vm/jit/types.h"
+#include "hphp/runtime/vm/srckey.h"
+
+#include <string>
+
+namespace HPHP { namespace jit {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Per-translation compile-time profile.
+ *
+ * jit::Timer aggregates pass times per thread and per request, which is too
+ * coarse to see where an individual translation's compile time went.  With
+ * Eval.JitTimeProfile (plus Eval.JitTimer, which enables the underlying
+ * counters), translate() records the per-pass Timer deltas of every
+ * translation here, keyed by TransID, for later inspection through the
+ * admin server's /vm-jittime.
+ */
+
+/*
+ * Record one translation's compile time: the total CPU nanoseconds it took,
+ * and the per-pass Timer counters observed just before and just after it.
+ */
+void recordCompileTimeProfile(TransID id, TransKind kind, SrcKey sk,
+                              int64_t totalNanos,
+                              const Timer::CounterVec& before,
+                              const Timer::CounterVec& after);
+
+/*
+ * Render everything recorded so far, one block per translation sorted by
+ * total compile time, with a per-pass breakdown in each block.  Pass `clear`
+ * to discard the records after rendering them.
+ */
+std::string showCompileTimeProfile(bool clear);
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}
+
+#endif
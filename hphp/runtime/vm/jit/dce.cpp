@@ -30,6 +30,7 @@
 #include "hphp/runtime/vm/jit/mutation.h"
 #include "hphp/runtime/vm/jit/opt.h"
 #include "hphp/runtime/vm/jit/print.h"
+#include "hphp/runtime/vm/jit/scratch-arena.h"
 #include "hphp/runtime/vm/jit/simple-propagation.h"
 #include "hphp/runtime/vm/jit/state-vector.h"
 #include "hphp/runtime/vm/jit/timer.h"
@@ -739,7 +740,7 @@ static_assert(sizeof(DceFlags) == 1, "sizeof(DceFlags) should be 1 byte");
 // DCE state indexed by instr->id().
 typedef StateVector<IRInstruction, DceFlags> DceState;
 typedef StateVector<SSATmp, uint32_t> UseCounts;
-typedef jit::vector<const IRInstruction*> WorkList;
+typedef scratch_vector<const IRInstruction*> WorkList;
 
 void removeDeadInstructions(IRUnit& unit, const DceState& state) {
   postorderWalk(unit, [&](Block* block) {
@@ -1270,6 +1271,9 @@ void fullDCE(IRUnit& unit) {
 
   Timer dceTimer(Timer::optimize_dce);
 
+  // The worklist below lives in the scratch arena.
+  ScratchScope scratchScope;
+
   // kill unreachable code and remove any traces that are now empty
   auto const blocks = prepareBlocks(unit);
 
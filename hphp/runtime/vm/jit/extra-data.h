@@ -618,13 +618,15 @@ struct CallBuiltinData : IRExtraData {
                            int32_t numNonDefault,
                            bool writeLocals,
                            bool readLocals,
-                           bool needsFrame)
+                           bool needsFrame,
+                           bool leaf)
     : spOffset(spOffset)
     , callee{callee}
     , numNonDefault{numNonDefault}
     , writeLocals{writeLocals}
     , readLocals{readLocals}
     , needsCallerFrame{needsFrame}
+    , leaf{leaf}
   {}
 
   std::string show() const {
@@ -633,7 +635,8 @@ struct CallBuiltinData : IRExtraData {
       callee->fullName()->data(),
       writeLocals ? ",writeLocals" : "",
       readLocals ? ",readLocals" : "",
-      needsCallerFrame ? ",needsCallerFrame" : ""
+      needsCallerFrame ? ",needsCallerFrame" : "",
+      leaf ? ",leaf" : ""
     );
   }
 
@@ -643,6 +646,9 @@ struct CallBuiltinData : IRExtraData {
   bool writeLocals;
   bool readLocals;
   bool needsCallerFrame;
+  // The callee cannot raise, throw, or reenter the VM, so this instruction
+  // has no catch trace and its call needs no VM register sync.
+  bool leaf;
 };
 
 struct CallData : IRExtraData {
@@ -810,20 +816,24 @@ struct LdFuncCachedData : IRExtraData {
 struct LdObjMethodData : IRExtraData {
   explicit LdObjMethodData(IRSPRelOffset offset,
                            const StringData* method,
-                           bool fatal)
+                           bool fatal,
+                           bool wideCache)
     : offset(offset)
     , method(method)
     , fatal(fatal)
+    , wideCache(wideCache)
   {}
 
   std::string show() const {
     return folly::to<std::string>(offset.offset, ',', method->data(), ',',
-      fatal ? "fatal" : "warn");
+      fatal ? "fatal" : "warn", wideCache ? ",wide" : "");
   }
 
   IRSPRelOffset offset;
   const StringData* method;
   bool fatal;
+  // Use a two-way MethodCache::WideEntry for bimodal receiver sites.
+  bool wideCache;
 };
 
 struct LdFuncCachedUData : IRExtraData {
@@ -1070,12 +1080,26 @@ struct NewKeysetArrayData : IRExtraData {
 };
 
 struct MemoData : IRExtraData {
-  explicit MemoData(LocalRange locals)
-    : locals(locals) {}
+  /*
+   * Key shape of the memoize cache access, determined at irgen time from
+   * the types of the key locals. Single-key accesses of known type are
+   * lowered to specialized runtime helpers.
+   */
+  enum class KeyShape : uint8_t { Generic, SingleInt, SingleStr };
+
+  explicit MemoData(LocalRange locals, KeyShape shape = KeyShape::Generic)
+    : locals(locals)
+    , shape(shape) {}
 
-  std::string show() const { return HPHP::show(locals); }
+  std::string show() const {
+    auto ret = HPHP::show(locals);
+    if (shape == KeyShape::SingleInt) ret += ",int";
+    if (shape == KeyShape::SingleStr) ret += ",str";
+    return ret;
+  }
 
   LocalRange locals;
+  KeyShape shape;
 };
 
 struct MOpModeData : IRExtraData {
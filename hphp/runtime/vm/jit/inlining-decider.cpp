@@ -38,6 +38,7 @@
 
 #include <folly/RWSpinLock.h>
 #include <folly/Synchronized.h>
+#include <algorithm>
 #include <vector>
 
 namespace HPHP { namespace jit {
@@ -484,8 +485,15 @@ bool InliningDecider::shouldInline(SrcKey callerSk,
   // We measure the cost of inlining each callstack and stop when it exceeds a
   // certain threshold.  (Note that we do not measure the total cost of all the
   // inlined calls for a given caller---just the cost of each nested stack.)
-  const int maxCost = maxTotalCost - m_cost;
   const int cost = computeTranslationCost(callerSk, callerFPushOp, region);
+
+  // Callees this small are always worth inlining, no matter how much the
+  // stack of inlined calls around them has already spent.
+  if (cost <= RuntimeOption::EvalHHIRAlwaysInlineVasmCostLimit) {
+    return accept("cost below always-inline threshold");
+  }
+
+  const int maxCost = maxTotalCost - m_cost;
   if (cost > maxCost) {
     return refuse("too expensive");
   }
@@ -623,6 +631,36 @@ RegionDescPtr selectCalleeCFG(const Func* callee, const int numArgs,
   }
   return r;
 }
+
+/*
+ * Scale the vasm-cost budget for inlining `calleeRegion' by how hot the call
+ * is: the profile counts of the caller's translation and of the callee
+ * region's entry, relative to JitPGOThreshold.  Hot calls get up to
+ * HHIRInliningMaxCostScale times the base budget; everything else keeps it.
+ */
+uint32_t adjustedMaxVasmCost(const irgen::IRGS& irgs,
+                             const RegionDesc& calleeRegion) {
+  auto const base = RuntimeOption::EvalHHIRInliningMaxVasmCost;
+  auto const maxScale = RuntimeOption::EvalHHIRInliningMaxCostScale;
+  if (maxScale <= 1) return base;
+
+  auto const profData = jit::profData();
+  auto const threshold = RuntimeOption::EvalJitPGOThreshold;
+  if (!profData || threshold == 0) return base;
+
+  int64_t count = 0;
+  auto const callerTransID = irgs.context.transID;
+  if (callerTransID != kInvalidTransID) {
+    count = profData->transCounter(callerTransID);
+  }
+  auto const calleeTransID = calleeRegion.entry()->profTransID();
+  if (calleeTransID != kInvalidTransID) {
+    count = std::max(count, profData->transCounter(calleeTransID));
+  }
+
+  auto const scale = std::min(double(count) / threshold, double(maxScale));
+  return scale > 1.0 ? uint32_t(base * scale) : base;
+}
 }
 
 RegionDescPtr selectCalleeRegion(const SrcKey& sk,
@@ -671,9 +709,9 @@ RegionDescPtr selectCalleeRegion(const SrcKey& sk,
     if (profData()) {
       auto region = selectCalleeCFG(callee, numArgs, ctx, argTypes,
                                     maxBCInstrs);
-      auto const maxCost = RuntimeOption::EvalHHIRInliningMaxVasmCost;
-      if (region && inl.shouldInline(sk, fpiInfo.fpushOpc,
-                                     callee, *region, maxCost)) {
+      if (region &&
+          inl.shouldInline(sk, fpiInfo.fpushOpc, callee, *region,
+                           adjustedMaxVasmCost(irgs, *region))) {
         return region;
       }
     }
@@ -689,9 +727,9 @@ RegionDescPtr selectCalleeRegion(const SrcKey& sk,
     maxBCInstrs
   );
 
-  auto const maxCost = RuntimeOption::EvalHHIRInliningMaxVasmCost;
-  if (region && inl.shouldInline(sk, fpiInfo.fpushOpc,
-                                 callee, *region, maxCost)) {
+  if (region &&
+      inl.shouldInline(sk, fpiInfo.fpushOpc, callee, *region,
+                       adjustedMaxVasmCost(irgs, *region))) {
     return region;
   }
 
@@ -62,8 +62,12 @@ inline bool IRInstruction::mayRaiseError() const {
     // AKExistsArr, ArrayIdx, and ArrayIsset are only marked as Er because of
     // EvalHackArrCompatNotices. So, if its not enabled, treat them as if they
     // aren't.
-    return !is(AKExistsArr, ArrayIdx, ArrayIsset) ||
-      RuntimeOption::EvalHackArrCompatNotices;
+    if (is(AKExistsArr, ArrayIdx, ArrayIsset)) {
+      return RuntimeOption::EvalHackArrCompatNotices;
+    }
+    // Calls to leaf builtins can't raise (see CallBuiltinData).
+    if (is(CallBuiltin)) return !extra<CallBuiltin>()->leaf;
+    return true;
   }
   return false;
 }
@@ -25,6 +25,7 @@
 #include "hphp/runtime/vm/vm-regs.h"
 
 #include "hphp/runtime/vm/jit/analysis.h"
+#include "hphp/runtime/vm/jit/fixup.h"
 #include "hphp/runtime/vm/jit/type-constraint.h"
 #include "hphp/runtime/vm/jit/type.h"
 #include "hphp/runtime/vm/jit/vm-protect.h"
@@ -703,6 +704,26 @@ SSATmp* opt_foldable(IRGS& env,
 
 //////////////////////////////////////////////////////////////////////
 
+/*
+ * Builtins whose specialized emitters above key entirely off the
+ * DataType of a single argument.  When the tracelet doesn't pin that
+ * type down, it pays to profile it: a monomorphic CheckType on the
+ * dominant observed type recovers the specialized emitter, with a side
+ * exit running the generic call for the stragglers.
+ */
+bool builtin_wants_monomorphic_arg(const StringData* fname) {
+  return fname->isame(s_count.get()) ||
+         fname->isame(s_sizeof.get()) ||
+         fname->isame(s_sqrt.get()) ||
+         fname->isame(s_strlen.get()) ||
+         fname->isame(s_ceil.get()) ||
+         fname->isame(s_floor.get()) ||
+         fname->isame(s_abs.get()) ||
+         fname->isame(s_ord.get()) ||
+         fname->isame(s_chr.get()) ||
+         fname->isame(s_array_key_cast.get());
+}
+
 SSATmp* optimizedFCallBuiltin(IRGS& env,
                               const Func* func,
                               const ParamPrep& params,
@@ -1349,23 +1370,30 @@ SSATmp* builtinCall(IRGS& env,
     env.irb->exceptionStackBoundary();
   }
 
+  // Leaf builtins can't raise, throw, or reenter the VM, so the call needs
+  // neither a catch trace nor synced VM registers; anything that can still
+  // demand one (argument coercion, surprise checks in an eager-sync callee)
+  // keeps the generic path.
+  auto const leaf = (callee->attrs() & AttrLeafBuiltin) &&
+                    !FixupMap::eagerRecord(callee);
+
   // Make the actual call.
   auto realized = realize_params(env, callee, params, catchMaker);
   SSATmp** const decayedPtr = &realized[0];
-  auto const ret = gen(
-    env,
-    CallBuiltin,
-    CallBuiltinData {
-      spOffBCFromIRSP(env),
-      callee,
-      params.count ? -1 : numNonDefault,
-      funcWritesLocals(callee),
-      funcReadsLocals(callee),
-      funcNeedsCallerFrame(callee)
-    },
-    catchMaker.makeUnusualCatch(),
-    std::make_pair(realized.size(), decayedPtr)
-  );
+  auto const data = CallBuiltinData {
+    spOffBCFromIRSP(env),
+    callee,
+    params.count ? -1 : numNonDefault,
+    funcWritesLocals(callee),
+    funcReadsLocals(callee),
+    funcNeedsCallerFrame(callee),
+    leaf
+  };
+  auto const ret = leaf
+    ? gen(env, CallBuiltin, data,
+          std::make_pair(realized.size(), decayedPtr))
+    : gen(env, CallBuiltin, data, catchMaker.makeUnusualCatch(),
+          std::make_pair(realized.size(), decayedPtr));
 
   if (!params.forNativeImpl) {
     if (params.thiz && params.thiz->type() <= TObj) {
@@ -1497,6 +1525,18 @@ void emitFCallBuiltin(IRGS& env,
     &params
   };
 
+  // For builtins that have a monomorphic fast path keyed on the type of
+  // their sole argument, use the profiled type to recover it when the
+  // incoming value is polymorphic here.  The side exit completes this
+  // call site generically for the off-profile types.
+  if (numArgs == 1 && numNonDefault == 1 &&
+      !params[0].value->type().isKnownDataType() &&
+      builtin_wants_monomorphic_arg(callee->fullName())) {
+    params[0].value = profiledType(env, params[0].value, [&] {
+      push(env, builtinCall(env, callee, params, numNonDefault, catcher));
+    });
+  }
+
   push(env, builtinCall(env, callee, params, numNonDefault, catcher));
 }
 
@@ -133,7 +133,8 @@ void fpushObjMethodUnknown(IRGS& env,
                            SSATmp* obj,
                            const StringData* methodName,
                            uint32_t numParams,
-                           bool shouldFatal) {
+                           bool shouldFatal,
+                           bool twoWayCache) {
   emitIncStat(env, Stats::ObjMethod_cached, 1);
   fpushActRec(env,
               cns(env, TNullptr),  // Will be set by LdObjMethod
@@ -150,7 +151,7 @@ void fpushObjMethodUnknown(IRGS& env,
   gen(env,
       LdObjMethod,
       LdObjMethodData {
-        spOffBCFromIRSP(env), methodName, shouldFatal
+        spOffBCFromIRSP(env), methodName, shouldFatal, twoWayCache
       },
       objCls,
       sp(env));
@@ -282,7 +283,8 @@ void fpushObjMethodWithBaseClass(
   const StringData* methodName,
   uint32_t numParams,
   bool shouldFatal,
-  bool exactClass
+  bool exactClass,
+  bool twoWayCache
 ) {
   bool magicCall = false;
   if (auto const func = lookupImmutableMethod(
@@ -308,7 +310,8 @@ void fpushObjMethodWithBaseClass(
     return;
   }
 
-  fpushObjMethodUnknown(env, obj, methodName, numParams, shouldFatal);
+  fpushObjMethodUnknown(env, obj, methodName, numParams, shouldFatal,
+                        twoWayCache);
 }
 
 const StaticString methProfileKey{ "MethProfile-FPushObjMethod" };
@@ -489,6 +492,58 @@ bool optimizeProfiledPushMethod(IRGS& env,
     return true;
   }
 
+  // The site is polymorphic with no unique method, common base class, or
+  // common interface. If a few receiver classes still cover nearly all the
+  // profiled calls, dispatch through a chain of exact class checks, burning
+  // in each class's callee; anything unseen takes the side exit.
+  if (!isStaticCall && RuntimeOption::EvalJitPGOPolyMethodCache) {
+    MethProfile::ClassCount entries[MethProfile::kMaxPolyClasses];
+    auto const numEntries = data.getPolyClasses(entries);
+
+    struct Arm { const Class* cls; const Func* func; };
+    Arm arms[MethProfile::kMaxPolyClasses];
+    size_t numArms = 0;
+    uint64_t covered = 0;
+    for (size_t i = 0; i < numEntries; ++i) {
+      auto const cls = entries[i].cls;
+      bool magicCall = false;
+      auto const func = lookupImmutableMethod(
+        cls, methodName, magicCall,
+        false /* staticLookup */, curFunc(env), true /* exactClass */);
+      // Magic calls and callees that are static in the prologue would need
+      // per-arm context munging; treat their classes as uncovered instead.
+      if (!func || magicCall || func->isStaticInPrologue()) continue;
+      arms[numArms++] = Arm { cls, func };
+      covered += entries[i].count;
+    }
+
+    auto const total = data.polyTotal();
+    if (numArms >= 2 && covered * 10 >= uint64_t(total) * 9) {
+      auto const clsTmp = gen(env, LdObjClass, objOrCls);
+      auto const emitArms = [&] (size_t i, auto const& self) -> SSATmp* {
+        if (i + 1 == numArms) {
+          auto const eq = gen(env, EqCls, clsTmp, cns(env, arms[i].cls));
+          gen(env, JmpZero, sideExit, eq);
+          return cns(env, arms[i].func);
+        }
+        return cond(
+          env,
+          [&] (Block* taken) {
+            auto const eq = gen(env, EqCls, clsTmp, cns(env, arms[i].cls));
+            gen(env, JmpZero, taken, eq);
+          },
+          [&] { return cns(env, arms[i].func); },
+          [&] { return self(i + 1, self); }
+        );
+      };
+      auto const funcTmp = emitArms(0, emitArms);
+      // All the arms push non-static callees, so the object is the context
+      // for every one of them.
+      fpushActRec(env, funcTmp, objOrCls, numParams, nullptr);
+      return true;
+    }
+  }
+
   return false;
 }
 
@@ -507,11 +562,13 @@ void fpushObjMethod(IRGS& env,
       // use it.
       fpushObjMethodWithBaseClass(
         env, obj, cls, methodName, numParams, shouldFatal,
-        obj->type().clsSpec().exact() || cls->attrs() & AttrNoOverride);
+        obj->type().clsSpec().exact() || cls->attrs() & AttrNoOverride,
+        false);
       return;
     }
   }
 
+  auto twoWayCache = false;
   folly::Optional<TargetProfile<MethProfile>> profile;
   if (RuntimeOption::RepoAuthoritative) {
     profile.emplace(env.context, env.irb->curMarker(), methProfileKey.get());
@@ -520,10 +577,23 @@ void fpushObjMethod(IRGS& env,
                                    obj, sideExit, methodName, numParams)) {
       return;
     }
+
+    if (profile->optimizing()) {
+      // The site stayed polymorphic.  If two receiver classes covered
+      // nearly all the profiled calls, use a two-way method cache so the
+      // pair stops evicting each other's dispatch target.
+      MethProfile::ClassCount entries[MethProfile::kMaxPolyClasses];
+      auto const data = profile->data(MethProfile::reduce);
+      auto const numEntries = data.getPolyClasses(entries);
+      if (numEntries >= 2) {
+        auto const top2 = uint64_t(entries[0].count) + entries[1].count;
+        twoWayCache = top2 * 10 >= uint64_t(data.polyTotal()) * 9;
+      }
+    }
   }
 
   fpushObjMethodWithBaseClass(env, obj, nullptr, methodName, numParams,
-                              shouldFatal, false);
+                              shouldFatal, false, twoWayCache);
 
   if (profile && profile->profiling()) {
     gen(env,
@@ -15,6 +15,8 @@
 */
 #include "hphp/runtime/vm/jit/irgen-create.h"
 
+#include "hphp/runtime/vm/jit/mcgen.h"
+
 #include "hphp/runtime/base/packed-array.h"
 #include "hphp/runtime/ext/std/ext_std_errorfunc.h"
 #include "hphp/runtime/vm/class.h"
@@ -147,6 +149,15 @@ void initThrowable(IRGS& env, const Class* cls, SSATmp* throwable) {
 void initSProps(IRGS& env, const Class* cls) {
   cls->initSPropHandles();
   if (rds::isPersistentHandle(cls->sPropInitHandle())) return;
+  // Batched sprop init: profiling translations report the classes they
+  // guard; once retranslateAll freezes that set, every request initializes
+  // it up front and optimized code can skip the check. See mcgen.h.
+  if (env.context.kind == TransKind::Profile) {
+    mcgen::recordSPropInitClass(cls);
+  } else if (env.context.kind == TransKind::Optimize &&
+             mcgen::shouldElideSPropInitCheck(cls)) {
+    return;
+  }
   ifThen(
     env,
     [&] (Block* taken) {
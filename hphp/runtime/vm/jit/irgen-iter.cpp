@@ -35,6 +35,21 @@ Offset iterBranchTarget(const NormalizedInstruction& i) {
   return i.offset() + i.imm[1].u_BA;
 }
 
+/*
+ * An iterator init over a base that's a constant array with no elements never
+ * enters the loop body: the branch is always taken, and neither IterNext nor
+ * IterFree can run for this iterator on that path.  No iterator state needs to
+ * be materialized at all, so just jump.  Constant arrays are static, so
+ * popping the base doesn't need a decref.
+ */
+bool constEmptyBase(SSATmp* src) {
+  auto const arr = src->hasConstVal(TArr)    ? src->arrVal() :
+                   src->hasConstVal(TVec)    ? src->vecVal() :
+                   src->hasConstVal(TDict)   ? src->dictVal() :
+                   src->hasConstVal(TKeyset) ? src->keysetVal() : nullptr;
+  return arr && arr->empty();
+}
+
 template<class Lambda>
 void implMIterInit(IRGS& env, Offset relOffset, Lambda genFunc) {
   // TODO MIterInit doesn't check iterBranchTarget; this might be bug ...
@@ -65,6 +80,7 @@ void emitIterInit(IRGS& env, int32_t iterId, Offset /*relOffset*/,
   auto const targetOffset = iterBranchTarget(*env.currentNormalizedInstruction);
   auto const src = popC(env);
   if (!src->type().subtypeOfAny(TArrLike, TObj)) PUNT(IterInit);
+  if (constEmptyBase(src)) return jmpImpl(env, targetOffset);
   auto const res = gen(
     env,
     IterInit,
@@ -81,6 +97,7 @@ void emitIterInitK(IRGS& env, int32_t iterId, Offset /*relOffset*/,
   auto const targetOffset = iterBranchTarget(*env.currentNormalizedInstruction);
   auto const src = popC(env);
   if (!src->type().subtypeOfAny(TArrLike, TObj)) PUNT(IterInitK);
+  if (constEmptyBase(src)) return jmpImpl(env, targetOffset);
   auto const res = gen(
     env,
     IterInitK,
@@ -130,6 +147,7 @@ void emitWIterInit(IRGS& env, int32_t iterId, Offset /*relOffset*/,
   auto const targetOffset = iterBranchTarget(*env.currentNormalizedInstruction);
   auto const src = popC(env);
   if (!src->type().subtypeOfAny(TArrLike, TObj)) PUNT(WIterInit);
+  if (constEmptyBase(src)) return jmpImpl(env, targetOffset);
   auto const res = gen(
     env,
     WIterInit,
@@ -146,6 +164,7 @@ void emitWIterInitK(IRGS& env, int32_t iterId, Offset /*relOffset*/,
   auto const targetOffset = iterBranchTarget(*env.currentNormalizedInstruction);
   auto const src = popC(env);
   if (!src->type().subtypeOfAny(TArrLike, TObj)) PUNT(WIterInitK);
+  if (constEmptyBase(src)) return jmpImpl(env, targetOffset);
   auto const res = gen(
     env,
     WIterInitK,
@@ -2191,13 +2191,36 @@ void emitSetWithRefRML(IRGS& env, int32_t keyLoc) {
 
 //////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/*
+ * Classify the key shape of a memoize cache access. The key locals were
+ * just written in this tracelet (from GetMemoKeyL), so single keys of
+ * statically known type are common and can use specialized helpers.
+ */
+MemoData::KeyShape memoKeyShape(IRGS& env, const LocalRange& locals) {
+  if (locals.restCount != 0) return MemoData::KeyShape::Generic;
+  auto const ty = env.irb->local(locals.first, DataTypeSpecific).type;
+  if (ty <= TInt) return MemoData::KeyShape::SingleInt;
+  if (ty <= TStr) return MemoData::KeyShape::SingleStr;
+  return MemoData::KeyShape::Generic;
+}
+
+}
+
 void emitMemoGet(IRGS& env, uint32_t ndiscard, LocalRange locals) {
   assertx(curFunc(env)->isMemoizeWrapper());
   assertx(!curFunc(env)->isReturnRef());
   assertx(locals.first + locals.restCount < curFunc(env)->numLocals());
 
   auto const base = ldMBase(env);
-  auto const ret = gen(env, MemoGet, MemoData { locals }, fp(env), base);
+  auto const ret = gen(
+    env,
+    MemoGet,
+    MemoData { locals, memoKeyShape(env, locals) },
+    fp(env),
+    base
+  );
 
   // The returned type is always the return type of the wrapped function, plus
   // TUninit. HHBBC should always derive the same return type for the wrapper
@@ -2216,7 +2239,14 @@ void emitMemoSet(IRGS& env, uint32_t ndiscard, LocalRange locals) {
   assertx(locals.first + locals.restCount < curFunc(env)->numLocals());
 
   auto const value = topC(env, BCSPRelOffset{0}, DataTypeGeneric);
-  gen(env, MemoSet, MemoData { locals }, fp(env), ldMBase(env), value);
+  gen(
+    env,
+    MemoSet,
+    MemoData { locals, memoKeyShape(env, locals) },
+    fp(env),
+    ldMBase(env),
+    value
+  );
   popC(env, DataTypeGeneric);
   mFinalImpl(env, ndiscard, value);
 }
@@ -107,6 +107,20 @@ SSATmp* implInstanceCheck(IRGS& env, SSATmp* src, const StringData* className,
   auto const ssaClassName = cns(env, className);
   auto const objClass     = gen(env, LdObjClass, src);
 
+  /*
+   * A normal class that's known to have no derived classes (which hhbbc
+   * determines from its subclass index in repo-authoritative mode) can only
+   * match exactly, so dispatch on the class pointer itself rather than on the
+   * classVec or an instance bit. Exposing the equality at the IR level lets a
+   * chain of such checks over one object share a single LdObjClass, and lets
+   * the simplifier decide each comparison outright once the object's class is
+   * known from a guard. These classes don't need instance bits, so skip the
+   * profiling that assigns them.
+   */
+  if (isNormalClass(knownCls) && (knownCls->attrs() & AttrNoOverride)) {
+    return gen(env, EqCls, objClass, checkCls);
+  }
+
   if (env.context.kind == TransKind::Profile && !InstanceBits::initted()) {
     gen(env, ProfileInstanceCheck, cns(env, className));
   } else if (env.context.kind == TransKind::Optimize ||
@@ -115,6 +129,12 @@ SSATmp* implInstanceCheck(IRGS& env, SSATmp* src, const StringData* className,
     if (InstanceBits::lookup(className) != 0) {
       return gen(env, InstanceOfBitmask, objClass, ssaClassName);
     }
+    if (env.context.kind == TransKind::Profile &&
+        RuntimeOption::EvalInstanceBitsUpdateThreshold) {
+      // Keep counting checks against names with no bit, so that
+      // InstanceBits::update() can assign them a leftover bit later.
+      gen(env, ProfileInstanceCheck, cns(env, className));
+    }
   }
 
   // If the class is an interface, we can just hit the class's vtable or
@@ -260,19 +260,16 @@ void cgNewStructArray(IRLS& env, const IRInstruction* inst) {
   auto const extra = inst->extra<NewStructData>();
   auto& v = vmain(env);
 
-  auto table = v.allocData<const StringData*>(extra->numKeys);
-  memcpy(table, extra->keys, extra->numKeys * sizeof(*extra->keys));
-
-  MixedArray* (*f)(uint32_t, const StringData* const*, const TypedValue*) =
-    &MixedArray::MakeStruct;
+  // Precompute the key shape (scale, hash table, key hashes) when we
+  // translate, so the helper just copies the table and stores values.
+  auto const layout = MixedArray::MakeStructLayout(extra->numKeys, extra->keys);
 
   auto const args = argGroup(env, inst)
-    .imm(extra->numKeys)
-    .dataPtr(table)
+    .immPtr(layout)
     .addr(sp, cellsToBytes(extra->offset.offset));
 
-  cgCallHelper(v, env, CallSpec::direct(f), callDest(env, inst),
-               SyncOptions::None, args);
+  cgCallHelper(v, env, CallSpec::direct(MixedArray::MakeStructFromLayout),
+               callDest(env, inst), SyncOptions::None, args);
 }
 
 void cgNewKeysetArray(IRLS& env, const IRInstruction* inst) {
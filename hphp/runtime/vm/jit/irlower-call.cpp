@@ -336,8 +336,11 @@ void cgCallBuiltin(IRLS& env, const IRInstruction* inst) {
       : callDest(env, inst);
   }();
 
+  // Leaf builtins have no catch trace and need no fixup (see
+  // CallBuiltinData); everything else gets a synced call.
   cgCallHelper(v, env, CallSpec::direct(callee->nativeFuncPtr()),
-               dest, SyncOptions::Sync, args);
+               dest, extra->leaf ? SyncOptions::None : SyncOptions::Sync,
+               args);
 
   // For primitive return types (int, bool, double) and returnByValue, the
   // return value is already in dstData/dstType.
@@ -32,6 +32,7 @@
 #include "hphp/runtime/vm/jit/ir-instruction.h"
 #include "hphp/runtime/vm/jit/ir-opcode.h"
 #include "hphp/runtime/vm/jit/ssa-tmp.h"
+#include "hphp/runtime/vm/jit/translator-runtime.h"
 #include "hphp/runtime/vm/jit/type.h"
 #include "hphp/runtime/vm/jit/vasm-gen.h"
 #include "hphp/runtime/vm/jit/vasm-instr.h"
@@ -448,7 +449,37 @@ void cgConvObjToDArr(IRLS& env, const IRInstruction* inst) {
 ///////////////////////////////////////////////////////////////////////////////
 // ConvToStr
 
-IMPL_OPCODE_CALL(ConvIntToStr);
+void cgConvIntToStr(IRLS& env, const IRInstruction* inst) {
+  auto const dst = dstLoc(env, inst, 0).reg();
+  auto const src = srcLoc(env, inst, 0).reg();
+  auto& v = vmain(env);
+
+  auto const diff = v.makeReg();
+  v << subqi{String::MinPrecomputedInteger, src, diff, v.makeReg()};
+
+  auto const sf = v.makeReg();
+  v << cmpqi{String::MaxPrecomputedInteger - String::MinPrecomputedInteger,
+             diff, sf};
+
+  unlikelyCond(v, vcold(env), CC_A, sf, dst,
+    [&] (Vout& v) {
+      auto const d = v.makeReg();
+      cgCallHelper(v, env, CallSpec::direct(convIntToStrHelper),
+                   callDest(d), SyncOptions::None,
+                   argGroup(env, inst).ssa(0));
+      return d;
+    },
+    [&] (Vout& v) {
+      // The table is fully populated over the precomputed range before we
+      // ever translate, so no null check is needed. diff is rebased to
+      // zero, so index the raw (unbiased) table.
+      auto const d = v.makeReg();
+      v << load{v.cns(String::converted_integers_raw)[diff * 8], d};
+      return d;
+    }
+  );
+}
+
 IMPL_OPCODE_CALL(ConvDblToStr);
 IMPL_OPCODE_CALL(ConvObjToStr);
 IMPL_OPCODE_CALL(ConvResToStr);
@@ -65,15 +65,22 @@ void cgLdObjMethod(IRLS& env, const IRInstruction* inst) {
   auto& v = vmain(env);
   auto& vc = vcold(env);
 
-  // Allocate the request-local one-way method cache for this lookup.
-  auto const handle = rds::alloc<Entry, sizeof(Entry)>().handle();
+  // Allocate the request-local method cache for this lookup.  Sites whose
+  // profile showed two receiver classes alternating get a two-way line; the
+  // first-level handlers probe both ways before the full lookup.
+  auto const handle = extra->wideCache
+    ? rds::alloc<WideEntry, sizeof(WideEntry)>().handle()
+    : rds::alloc<Entry, sizeof(Entry)>().handle();
   if (RuntimeOption::EvalPerfDataMap) {
     rds::recordRds(handle, sizeof(TypedValue), "MethodCache",
                    inst->marker().func()->fullName()->toCppString());
   }
 
-  auto const mc_handler = extra->fatal ? tc::ustubs().handlePrimeCacheInitFatal
-                                       : tc::ustubs().handlePrimeCacheInit;
+  auto const mc_handler = extra->wideCache
+    ? (extra->fatal ? tc::ustubs().handlePrimeCacheInitWideFatal
+                    : tc::ustubs().handlePrimeCacheInitWide)
+    : (extra->fatal ? tc::ustubs().handlePrimeCacheInitFatal
+                    : tc::ustubs().handlePrimeCacheInit);
 
   /*
    * The `mcprep' instruction here creates a smashable move, which serves as
@@ -90,7 +97,7 @@ void cgLdObjMethod(IRLS& env, const IRInstruction* inst) {
    * slow path to initialize it.  After initialization, we also smash the slow
    * path call to point instead to a lookup routine for the out-of-line method
    * cache (allocated above).  The inline cache is guaranteed to be set only
-   * once, but the one-way request-local method cache is updated on each miss.
+   * once, but the request-local method cache is updated on each miss.
    */
   auto func_class = v.makeReg();
   v << mcprep{func_class};
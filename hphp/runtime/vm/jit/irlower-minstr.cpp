@@ -1249,8 +1249,19 @@ void cgMemoGet(IRLS& env, const IRInstruction* inst) {
     .ssa(1)
     .addr(fp, localOffset(extra->locals.first))
     .imm(extra->locals.restCount + 1);
+  auto const target = [&] {
+    switch (extra->shape) {
+      case MemoData::KeyShape::SingleInt:
+        return CallSpec::direct(MixedArray::MemoGetIntKey);
+      case MemoData::KeyShape::SingleStr:
+        return CallSpec::direct(MixedArray::MemoGetStrKey);
+      case MemoData::KeyShape::Generic:
+        return CallSpec::direct(MixedArray::MemoGet);
+    }
+    not_reached();
+  }();
   cgCallHelper(
-    v, env, CallSpec::direct(MixedArray::MemoGet),
+    v, env, target,
     callDestTV(env, inst), SyncOptions::None, args
   );
 }
@@ -1265,8 +1276,19 @@ void cgMemoSet(IRLS& env, const IRInstruction* inst) {
     .addr(fp, localOffset(extra->locals.first))
     .imm(extra->locals.restCount + 1)
     .typedValue(2);
+  auto const target = [&] {
+    switch (extra->shape) {
+      case MemoData::KeyShape::SingleInt:
+        return CallSpec::direct(MixedArray::MemoSetIntKey);
+      case MemoData::KeyShape::SingleStr:
+        return CallSpec::direct(MixedArray::MemoSetStrKey);
+      case MemoData::KeyShape::Generic:
+        return CallSpec::direct(MixedArray::MemoSet);
+    }
+    not_reached();
+  }();
   cgCallHelper(
-    v, env, CallSpec::direct(MixedArray::MemoSet),
+    v, env, target,
     kVoidDest, SyncOptions::Sync, args
   );
 }
@@ -153,7 +153,8 @@ void cgInitObjProps(IRLS& env, const IRInstruction* inst) {
                      SyncOptions::None, args.imm(cellsToBytes(nprops)));
       } else {
         cgCallHelper(v, env, CallSpec::direct(deepInitHelper),
-                     kVoidDest, SyncOptions::None, args.imm(nprops));
+                     kVoidDest, SyncOptions::None,
+                     args.imm(nprops).immPtr(cls));
       }
     }
   }
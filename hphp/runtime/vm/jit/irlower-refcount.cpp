@@ -20,6 +20,7 @@
 #include "hphp/runtime/base/array-data.h"
 #include "hphp/runtime/base/countable.h"
 #include "hphp/runtime/base/header-kind.h"
+#include "hphp/runtime/base/memory-manager.h"
 #include "hphp/runtime/base/mixed-array.h"
 #include "hphp/runtime/base/packed-array.h"
 #include "hphp/runtime/base/runtime-option.h"
@@ -221,12 +222,24 @@ CallSpec getDtorCallSpec(DataType type) {
     case KindOfString:
       return CallSpec::method(&StringData::release);
     case KindOfArray:
+      if (RuntimeOption::EvalDeferArrayRelease) {
+        return CallSpec::direct(deferredReleaseArray);
+      }
       return CallSpec::method(&ArrayData::release);
     case KindOfVec:
+      if (RuntimeOption::EvalDeferArrayRelease) {
+        return CallSpec::direct(deferredReleaseArray);
+      }
       return CallSpec::direct(PackedArray::Release);
     case KindOfDict:
+      if (RuntimeOption::EvalDeferArrayRelease) {
+        return CallSpec::direct(deferredReleaseArray);
+      }
       return CallSpec::direct(MixedArray::Release);
     case KindOfKeyset:
+      if (RuntimeOption::EvalDeferArrayRelease) {
+        return CallSpec::direct(deferredReleaseArray);
+      }
       return CallSpec::direct(SetArray::Release);
     case KindOfObject:
       return CallSpec::method(
@@ -249,6 +262,11 @@ CallSpec makeDtorCall(Type ty, Vloc loc, ArgGroup& args) {
   static auto const TMixedArr = Type::Array(ArrayData::kMixedKind);
   static auto const TAPCArr = Type::Array(ArrayData::kApcKind);
 
+  if (ty <= TArr && RuntimeOption::EvalDeferArrayRelease) {
+    // All array kinds queue through the same entry point; the drain
+    // dispatches per kind.
+    return CallSpec::direct(deferredReleaseArray);
+  }
   if (ty <= TPackedArr) return CallSpec::direct(PackedArray::Release);
   if (ty <= TMixedArr)  return CallSpec::direct(MixedArray::Release);
   if (ty <= TAPCArr)    return CallSpec::direct(APCLocalArray::Release);
@@ -19,6 +19,7 @@
 
 #include "hphp/runtime/vm/jit/mcgen.h"
 
+#include "hphp/runtime/vm/jit/compile-time-profile.h"
 #include "hphp/runtime/vm/jit/debugger.h"
 #include "hphp/runtime/vm/jit/irlower.h"
 #include "hphp/runtime/vm/jit/perf-counters.h"
@@ -32,10 +33,13 @@
 #include "hphp/runtime/vm/jit/vtune-jit.h"
 #include "hphp/runtime/vm/jit/write-lease.h"
 
+#include "hphp/runtime/vm/class.h"
 #include "hphp/runtime/vm/runtime.h"
 #include "hphp/runtime/vm/treadmill.h"
 
+#include "hphp/runtime/base/init-fini-node.h"
 #include "hphp/runtime/base/program-functions.h"
+#include "hphp/runtime/base/rds.h"
 
 #include "hphp/util/hfsort.h"
 #include "hphp/util/job-queue.h"
@@ -43,6 +47,10 @@
 #include "hphp/util/match.h"
 #include "hphp/util/trace.h"
 
+#include <folly/portability/Unistd.h>
+
+#include <unordered_set>
+
 TRACE_SET_MOD(mcg);
 
 namespace HPHP { namespace jit { namespace mcgen {
@@ -52,6 +60,59 @@ namespace {
 std::thread s_retranslateAllThread;
 std::atomic<bool> s_retranslateAllComplete{false};
 
+/*
+ * Classes recorded by profiling translations for batched static-prop
+ * initialization; see the comment in mcgen.h. `closed' permanently stops
+ * inserts (so request threads can iterate the set without locking) and
+ * `frozen' additionally enables the request-start batch and guard elision.
+ * If draining pre-freeze requests times out we clear `frozen' and forgo
+ * the optimization; `closed' stays set.
+ */
+std::mutex s_spropInitLock;
+std::unordered_set<const Class*> s_spropInitClasses;
+std::atomic<bool> s_spropInitClosed{false};
+std::atomic<bool> s_spropInitFrozen{false};
+
+int64_t freezeSPropInitClasses() {
+  if (!RuntimeOption::EvalJitPGOBatchSPropInit ||
+      !RuntimeOption::ServerExecutionMode()) {
+    return 0;
+  }
+  auto const freezeTime = time(nullptr);
+  s_spropInitClosed.store(true, std::memory_order_release);
+  // Wait out any inserter already past its `closed' check.
+  { std::lock_guard<std::mutex> g{s_spropInitLock}; }
+  s_spropInitFrozen.store(true, std::memory_order_release);
+  return freezeTime;
+}
+
+void waitForSPropInitDrain(int64_t freezeTime) {
+  if (!freezeTime) return;
+  // Requests that started before the freeze never ran the request-start
+  // batch, so their threads may reach uninitialized sprops through any
+  // guard-free code we publish. Wait for them to finish; if one wedges,
+  // give up on eliding rather than stalling retranslation.
+  while (Treadmill::getOldestStartTime() <= freezeTime) {
+    if (time(nullptr) > freezeTime + 30) {
+      s_spropInitFrozen.store(false, std::memory_order_release);
+      Logger::Info("retranslateAll: old requests did not drain; "
+                   "keeping CheckInitSProps guards");
+      return;
+    }
+    usleep(10000);
+  }
+}
+
+InitFiniNode s_spropBatchInit(
+  [] {
+    if (!s_spropInitFrozen.load(std::memory_order_acquire)) return;
+    for (auto const cls : s_spropInitClasses) {
+      if (cls->needsInitSProps()) cls->initSProps();
+    }
+  },
+  InitFiniNode::When::RequestStart
+);
+
 void optimize(tc::FuncMetaInfo& info) {
   auto const func = info.func;
 
@@ -246,10 +307,18 @@ void print(hfsort::TargetGraph& /*cg*/, const char* fileName,
  *   2) Generate machine code for each of the functions.
  *   3) Select an order for the functions (hfsort to sort the functions).
  *   4) Relocate the functions in the TC according to the selected order.
+ *
+ * Steps 2 and 3 run concurrently: the code generation is handed to the
+ * worker pool and the clustering only needs the call graph, so it runs
+ * on this thread in the meantime.
  */
 void retranslateAll() {
   const bool serverMode = RuntimeOption::ServerExecutionMode();
 
+  // Freeze the batched sprop-init class set now so the drain below can
+  // overlap with building the call graph.
+  auto const spropFreezeTime = freezeSPropInitClasses();
+
   // 1) Create the call graph
 
   if (serverMode) {
@@ -279,12 +348,16 @@ void retranslateAll() {
 
   // 2) Generate machine code for all the profiled functions.
 
+  waitForSPropInitDrain(spropFreezeTime);
+
   auto const initialSize = 512;
   auto const ntargets = cg.targets.size();
   std::vector<OptimizeData> jobs;
   jobs.reserve(ntargets);
   std::unique_ptr<uint8_t[]> codeBuffer(new uint8_t[ntargets * initialSize]);
 
+  std::vector<hfsort::Cluster> clusters;
+
   {
     std::lock_guard<std::mutex> lock{s_dispatcherMutex};
 
@@ -302,6 +375,24 @@ void retranslateAll() {
       }
     }
 
+    // 3) Pass the call graph to hfsort to obtain the order in which things
+    //    should be placed in code.hot. This only depends on the profile
+    //    counters, so it runs on this thread while the workers are busy
+    //    generating the machine code.
+
+    if (RuntimeOption::EvalJitPGOHfsortPlus) {
+      // hfsortPlus models iTLB misses directly and returns the clusters
+      // already sorted by density.
+      clusters = hfsort::hfsortPlus(cg);
+    } else {
+      clusters = hfsort::clusterize(cg);
+      sort(clusters.begin(), clusters.end(), hfsort::compareClustersDensity);
+    }
+
+    if (serverMode) {
+      Logger::Info("retranslateAll: finished clusterizing the functions");
+    }
+
     dispatcher().waitEmpty();
   }
 
@@ -309,16 +400,6 @@ void retranslateAll() {
     Logger::Info("retranslateAll: finished optimizing functions");
   }
 
-  // 3) Pass the call graph to hfsort to obtain the order in which things
-  //    should be placed in code.hot
-
-  auto clusters = hfsort::clusterize(cg);
-  sort(clusters.begin(), clusters.end(), hfsort::compareClustersDensity);
-
-  if (serverMode) {
-    Logger::Info("retranslateAll: finished clusterizing the functions");
-  }
-
   if (RuntimeOption::EvalJitPGODumpCallGraph) {
     Treadmill::Session ts;
 
@@ -356,6 +437,12 @@ void retranslateAll() {
 
   s_retranslateAllComplete.store(true, std::memory_order_release);
 
+  if (!RuntimeOption::EvalRdsLayoutProfileFile.empty()) {
+    // By now the hot named RDS symbols have all been bound at least once, so
+    // the bind order is worth saving for the next process to replay.
+    rds::saveLayoutProfile(RuntimeOption::EvalRdsLayoutProfileFile);
+  }
+
   if (serverMode) {
     ProfData::Session pds;
 
@@ -393,6 +480,15 @@ translate(TransArgs args, FPInvOffset spOff,
 
   if (!tc::shouldTranslate(args.sk.func(), args.kind)) return folly::none;
 
+  // With Eval.JitTimeProfile, attribute this translation's per-pass Timer
+  // deltas to its TransID (the underlying counters need Eval.JitTimer).
+  auto const timeProfile = RuntimeOption::EvalJitTimeProfile &&
+                           RuntimeOption::EvalJitTimer;
+  auto const profileBefore = timeProfile ? Timer::Counters()
+                                         : Timer::CounterVec{};
+  auto const nanosBefore = timeProfile ? HPHP::Timer::GetThreadCPUTimeNanos()
+                                       : 0;
+
   Timer timer(Timer::mcg_translate);
 
   auto const srcRec = tc::findSrcRec(args.sk);
@@ -418,10 +514,33 @@ translate(TransArgs args, FPInvOffset spOff,
     if (env.unit) {
       env.vunit = irlower::lowerUnit(*env.unit);
     }
+
+    // Offline compile-time benchmarking: repeat the HHIR and vasm lowering
+    // of this region so the per-pass profile dominates measurement noise.
+    // The extra units are discarded; emission isn't repeated since it
+    // writes to the TC.
+    if (UNLIKELY(RuntimeOption::EvalJitTimeProfileRepeats > 0) && env.unit) {
+      for (uint32_t i = 0; i < RuntimeOption::EvalJitTimeProfileRepeats; ++i) {
+        PostConditions pconds;
+        Annotations annotations;
+        auto const unit = irGenRegion(*args.region, transContext,
+                                      pconds, annotations);
+        if (unit) irlower::lowerUnit(*unit);
+      }
+    }
   }
 
   timer.stop();
-  return tc::emitTranslation(std::move(env), optView);
+  auto const transID = env.transID;
+  auto result = tc::emitTranslation(std::move(env), optView);
+  if (timeProfile) {
+    recordCompileTimeProfile(
+      transID, args.kind, args.sk,
+      HPHP::Timer::GetThreadCPUTimeNanos() - nanosBefore,
+      profileBefore, Timer::Counters()
+    );
+  }
+  return result;
 }
 
 TCA retranslate(TransArgs args, const RegionContext& ctx) {
@@ -534,6 +653,29 @@ bool retranslateAllEnabled() {
     RuntimeOption::EvalJitRetranslateAllRequest != 0;
 }
 
+void recordSPropInitClass(const Class* cls) {
+  if (!RuntimeOption::EvalJitPGOBatchSPropInit ||
+      s_spropInitClosed.load(std::memory_order_acquire)) {
+    return;
+  }
+  // Only classes whose Class* outlives requests, and whose whole hierarchy
+  // initializes from scalar data, may be initialized from the request-start
+  // batch: running an 86sinit there would execute PHP before the request
+  // proper begins.
+  if (!classHasPersistentRDS(cls)) return;
+  for (auto c = cls; c; c = c->parent()) {
+    if (!c->sinitVec().empty()) return;
+  }
+  std::lock_guard<std::mutex> g{s_spropInitLock};
+  if (s_spropInitClosed.load(std::memory_order_acquire)) return;
+  s_spropInitClasses.insert(cls);
+}
+
+bool shouldElideSPropInitCheck(const Class* cls) {
+  if (!s_spropInitFrozen.load(std::memory_order_acquire)) return false;
+  return s_spropInitClasses.count(cls) != 0;
+}
+
 void checkRetranslateAll() {
   static std::atomic<bool> scheduled(false);
 
@@ -27,6 +27,7 @@
 namespace HPHP {
 
 struct ActRec;
+struct Class;
 
 namespace jit {
 
@@ -115,6 +116,19 @@ bool retranslateOpt(FuncId funcId);
  */
 void checkRetranslateAll();
 
+/*
+ * Batched static-property initialization (Eval.JitPGOBatchSPropInit).
+ *
+ * Profiling translations record classes whose CheckInitSProps guard they
+ * emitted, provided the Class* is persistent and nothing in its hierarchy
+ * has an 86sinit (so initializing it runs no PHP). retranslateAll freezes
+ * the set and waits for all older requests to drain; from then on every
+ * request initializes the whole set up front, and optimized translations
+ * may drop the per-access guard for member classes.
+ */
+void recordSPropInitClass(const Class* cls);
+bool shouldElideSPropInitCheck(const Class* cls);
+
 /*
  * Called once when the JIT is activated to initialize internal mcgen structures
  */
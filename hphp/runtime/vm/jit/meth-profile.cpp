@@ -23,12 +23,43 @@
 
 #include <folly/Format.h>
 
+#include <algorithm>
 #include <string>
 
 namespace HPHP { namespace jit {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void MethProfile::recordPolyClass(const Class* cls, uint32_t n) {
+  m_polyTotal += n;
+  for (size_t i = 0; i < kMaxPolyClasses; ++i) {
+    auto const cur = m_polyClass[i].get();
+    if (cur == cls) {
+      m_polyCount[i] += n;
+      return;
+    }
+    if (!cur) {
+      m_polyClass[i] = cls;
+      m_polyCount[i] = n;
+      return;
+    }
+  }
+  // Table is full: the calls still count towards m_polyTotal, so consumers
+  // see how much of the site the tracked classes cover.
+}
+
+size_t MethProfile::getPolyClasses(ClassCount out[kMaxPolyClasses]) const {
+  size_t n = 0;
+  for (size_t i = 0; i < kMaxPolyClasses; ++i) {
+    auto const cls = m_polyClass[i].get();
+    if (cls && m_polyCount[i]) out[n++] = ClassCount{cls, m_polyCount[i]};
+  }
+  std::sort(out, out + n, [](const ClassCount& a, const ClassCount& b) {
+    return a.count > b.count;
+  });
+  return n;
+}
+
 void MethProfile::reportMethHelper(const Class* cls, const Func* meth) {
   auto val = methValue();
   if (!val) {
@@ -78,6 +109,21 @@ void MethProfile::reportMethHelper(const Class* cls, const Func* meth) {
 }
 
 void MethProfile::reduce(MethProfile& a, const MethProfile& b) {
+  // Merge the receiver class tables first: they stay interesting even after
+  // the tag degrades to Invalid. Slots and counts in b may be sliced by
+  // concurrent reporters; the counts are approximate anyway.
+  uint32_t merged = 0;
+  for (size_t i = 0; i < kMaxPolyClasses; ++i) {
+    auto const cls = b.m_polyClass[i].get();
+    if (!cls) continue;
+    auto const n = b.m_polyCount[i];
+    if (!n) continue;
+    a.recordPolyClass(cls, n);
+    merged += n;
+  }
+  auto const bTotal = b.m_polyTotal;
+  if (bTotal > merged) a.m_polyTotal += bTotal - merged;
+
   if (a.curTag() == Tag::Invalid) return;
 
   uintptr_t bMethVal;
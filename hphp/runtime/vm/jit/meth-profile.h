@@ -42,14 +42,36 @@ struct MethProfile {
     Invalid = 4
   };
 
+  /*
+   * Number of distinct receiver classes tracked per call site. Sites that
+   * see more classes than this are treated as megamorphic.
+   */
+  static constexpr size_t kMaxPolyClasses = 4;
+
+  struct ClassCount {
+    const Class* cls;
+    uint32_t count;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
 
-  MethProfile() : m_curMeth(nullptr), m_curClass(nullptr) {}
+  MethProfile() : m_curMeth(nullptr), m_curClass(nullptr), m_polyTotal(0) {
+    for (size_t i = 0; i < kMaxPolyClasses; ++i) {
+      m_polyClass[i] = nullptr;
+      m_polyCount[i] = 0;
+    }
+  }
 
   MethProfile(const MethProfile& other)
     : m_curMeth(other.m_curMeth)
     , m_curClass(other.m_curClass)
-  {}
+    , m_polyTotal(other.m_polyTotal)
+  {
+    for (size_t i = 0; i < kMaxPolyClasses; ++i) {
+      m_polyClass[i] = other.m_polyClass[i].get();
+      m_polyCount[i] = other.m_polyCount[i];
+    }
+  }
 
   std::string toString() const;
 
@@ -81,9 +103,23 @@ struct MethProfile {
     if (!cls && meth->isMethod()) {
       cls = ar->hasThis() ? ar->getThis()->getVMClass() : ar->getClass();
     }
+    if (cls) recordPolyClass(cls, 1);
     reportMethHelper(cls, meth);
   }
 
+  /*
+   * Collect the receiver classes seen at this call site, sorted by
+   * decreasing count. Returns the number of entries written to `out'.
+   *
+   * Useful when the call site turned out to be polymorphic (none of the
+   * accessors above apply), but a handful of classes still covers most of
+   * the profiled calls. Compare the entry counts against polyTotal() to
+   * see what fraction of calls the table accounts for.
+   */
+  size_t getPolyClasses(ClassCount out[kMaxPolyClasses]) const;
+
+  uint32_t polyTotal() const { return m_polyTotal; }
+
   /*
    * Aggregate two MethProfiles.
    */
@@ -93,6 +129,7 @@ struct MethProfile {
 
 private:
   void reportMethHelper(const Class* cls, const Func* meth);
+  void recordPolyClass(const Class* cls, uint32_t n);
 
   /*
    * m_curMeth munging.
@@ -122,6 +159,16 @@ private:
                std::memory_order_acquire, std::memory_order_release> m_curMeth;
   AtomicLowPtr<const Class,
                std::memory_order_acquire, std::memory_order_release> m_curClass;
+  /*
+   * Receiver class table. Updates are racy like the rest of this profile:
+   * concurrent reporters may clobber each other's slots or counts, so the
+   * counts are approximate and consumers must verify anything they burn in.
+   */
+  AtomicLowPtr<const Class,
+               std::memory_order_acquire,
+               std::memory_order_release> m_polyClass[kMaxPolyClasses];
+  uint32_t m_polyCount[kMaxPolyClasses];
+  uint32_t m_polyTotal;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
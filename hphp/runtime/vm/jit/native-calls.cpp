@@ -206,8 +206,6 @@ static CallMap s_callMap {
 
     {ConvDblToStr,       convDblToStrHelper, DSSA, SNone,
                            {{SSA, 0}}},
-    {ConvIntToStr,       convIntToStrHelper, DSSA, SNone,
-                           {{SSA, 0}}},
     {ConvObjToStr,       convObjToStrHelper, DSSA, SSync,
                            {{SSA, 0}}},
     {ConvResToStr,       convResToStrHelper, DSSA, SSync,
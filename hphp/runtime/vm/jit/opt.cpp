@@ -22,6 +22,7 @@
 #include "hphp/runtime/vm/jit/ir-unit.h"
 #include "hphp/runtime/vm/jit/mutation.h"
 #include "hphp/runtime/vm/jit/print.h"
+#include "hphp/runtime/vm/jit/scratch-arena.h"
 #include "hphp/runtime/vm/jit/simplify.h"
 #include "hphp/runtime/vm/jit/timer.h"
 #include "hphp/runtime/vm/jit/dce.h"
@@ -159,6 +160,10 @@ void fixBlockHints(IRUnit& unit) {
 void optimize(IRUnit& unit, TransKind kind) {
   Timer timer(Timer::optimize, unit.logEntry().get_pointer());
 
+  // Anything the passes below put in the scratch arena is released when
+  // the pipeline finishes.
+  ScratchScope scratchScope;
+
   assertx(checkEverything(unit));
 
   fullDCE(unit);
@@ -210,6 +215,12 @@ void optimize(IRUnit& unit, TransKind kind) {
     printUnit(6, unit, " after optimizeLoopInvariantCode ");
   }
 
+  if (kind != TransKind::Profile &&
+      RuntimeOption::EvalHHIRConsolidateSurpriseChecks) {
+    doPass(unit, consolidateSurpriseChecks, DCE::Minimal);
+    printUnit(6, unit, " after consolidateSurpriseChecks ");
+  }
+
   doPass(unit, simplifyOrdStrIdx, DCE::Minimal);
 
   doPass(unit, removeExitPlaceholders, DCE::Full);
@@ -39,6 +39,7 @@ void optimizeStores(IRUnit&);
 void optimizeLoopInvariantCode(IRUnit&);
 void cleanCfg(IRUnit&);
 bool optimizePhis(IRUnit&);
+void consolidateSurpriseChecks(IRUnit&);
 
 /*
  * For debugging, we can run this pass, which inserts various sanity checking
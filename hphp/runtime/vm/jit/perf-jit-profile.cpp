@@ -0,0 +1,158 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/runtime/vm/jit/perf-jit-profile.h"
+
+#include "hphp/runtime/vm/jit/mcgen.h"
+#include "hphp/runtime/vm/jit/tc.h"
+#include "hphp/runtime/vm/jit/tc-internal.h"
+#include "hphp/runtime/vm/jit/trans-db.h"
+#include "hphp/runtime/vm/jit/trans-rec.h"
+
+#include <folly/Format.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace HPHP { namespace jit {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/*
+ * Per-IP event counts.
+ *
+ * The sampler only delivers load and store events, so those are what we
+ * count; misses are events whose data source resolved to a cache miss.
+ */
+struct SampleCounts {
+  uint64_t loads{0};
+  uint64_t loadMisses{0};
+  uint64_t stores{0};
+  uint64_t storeMisses{0};
+
+  uint64_t total() const { return loads + stores; }
+
+  SampleCounts& operator+=(const SampleCounts& o) {
+    loads += o.loads;
+    loadMisses += o.loadMisses;
+    stores += o.stores;
+    storeMisses += o.storeMisses;
+    return *this;
+  }
+};
+
+/*
+ * Sampled IPs, aggregated process-wide.
+ *
+ * Samples are only collected on requests chosen by PerfMemEventRequestFreq,
+ * and at most PerfMemEventSampleFreq times a second on those, so a simple
+ * lock is plenty.
+ */
+std::mutex s_lock;
+std::map<uintptr_t, SampleCounts> s_samples;
+
+/*
+ * Attribution bucket for reporting: the translation's function name, or the
+ * name of the unique stub the IP hit.
+ */
+std::string describeIP(TCA tca) {
+  if (auto const rec = transdb::getTransRecContaining(tca)) {
+    return rec->funcName.empty() ? "(pseudomain)" : rec->funcName;
+  }
+
+  auto const ustub = tc::ustubs().describe(tca);
+  if (ustub.compare(0, 2, "0x") != 0) {
+    return ustub.substr(0, ustub.find('+'));
+  }
+  return "(unknown)";
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void recordPerfJitSample(PerfEvent kind, const perf_event_sample* sample) {
+  if (!transdb::enabled()) return;
+
+  auto const tca = reinterpret_cast<TCA>(sample->ip);
+  if (!mcgen::initialized() || !tc::code().isValidCodeAddress(tca)) return;
+
+  auto const info = perf_event_data_src(kind, sample->tail()->data_src);
+  auto const miss = info.mem_hit == -1;
+
+  std::lock_guard<std::mutex> l(s_lock);
+  auto& counts = s_samples[sample->ip];
+  switch (kind) {
+    case PerfEvent::Load:
+      ++counts.loads;
+      if (miss) ++counts.loadMisses;
+      break;
+    case PerfEvent::Store:
+      ++counts.stores;
+      if (miss) ++counts.storeMisses;
+      break;
+  }
+}
+
+std::string showPerfJitProfile() {
+  // Take a snapshot of the samples, then resolve the IPs while holding the
+  // code lock, so that the TransDB can't grow out from under us.
+  std::map<uintptr_t, SampleCounts> samples;
+  {
+    std::lock_guard<std::mutex> l(s_lock);
+    samples = s_samples;
+  }
+
+  std::map<std::string, SampleCounts> funcs;
+  {
+    auto codeLock = tc::lockCode();
+    for (auto const& kv : samples) {
+      funcs[describeIP(reinterpret_cast<TCA>(kv.first))] += kv.second;
+    }
+  }
+
+  std::vector<std::pair<std::string, SampleCounts>> rows(
+    funcs.begin(), funcs.end()
+  );
+  std::sort(rows.begin(), rows.end(), [] (auto const& a, auto const& b) {
+    return a.second.total() > b.second.total();
+  });
+
+  std::string ret = folly::format(
+    "{:<11} {:<11} {:<11} {:<12} {}\n",
+    "loads", "load-misses", "stores", "store-misses", "function"
+  ).str();
+
+  for (auto const& row : rows) {
+    folly::format(
+      &ret,
+      "{:<11} {:<11} {:<11} {:<12} {}\n",
+      row.second.loads, row.second.loadMisses,
+      row.second.stores, row.second.storeMisses,
+      row.first
+    );
+  }
+  return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}
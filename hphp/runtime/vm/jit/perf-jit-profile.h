@@ -0,0 +1,52 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_JIT_PERF_JIT_PROFILE_H_
+#define incl_HPHP_JIT_PERF_JIT_PROFILE_H_
+
+#include "hphp/util/perf-event.h"
+
+#include <string>
+
+namespace HPHP { namespace jit {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Record a sampled hardware event whose instruction pointer may lie in the
+ * translation cache.
+ *
+ * Samples are aggregated in-process, keyed by the sampled IP, so that they
+ * can later be attributed to individual translations via the TransDB.  Does
+ * nothing if the TransDB is not enabled (without it, the IPs could never be
+ * resolved), or if the IP is not a TC address.
+ */
+void recordPerfJitSample(PerfEvent kind, const perf_event_sample* sample);
+
+/*
+ * Render the samples recorded so far as a per-function table of event and
+ * miss counts, sorted by sample count.
+ *
+ * Samples that hit a unique stub (or code the TransDB has no record of) are
+ * reported under the stub's name rather than a function's.
+ */
+std::string showPerfJitProfile();
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}
+
+#endif
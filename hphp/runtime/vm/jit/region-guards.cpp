@@ -379,6 +379,44 @@ void updateWeights(const RegionDesc&   region,
   }
 }
 
+/*
+ * Drop retranslations whose guards were satisfied for less than
+ * RuntimeOption::EvalJitPGODropColdRetransPercent of the chain's total
+ * profiling weight.  Such guard combinations (almost) never materialized
+ * while profiling, so inputs requiring them side-exit from the surviving
+ * blocks instead of getting a dedicated translation.  This must run after
+ * updateWeights, so each block's weight reflects all the traffic its
+ * guards would admit.  The heaviest block and the region's entry block
+ * are always kept.
+ */
+void dropColdRetrans(BlockDataVec& blockData, const RegionDesc& region) {
+  const auto pct = RuntimeOption::EvalJitPGODropColdRetransPercent;
+  if (pct == 0) return;
+
+  int64_t totalWgt = 0;
+  const BlockData* heaviest = nullptr;
+  for (auto& bd : blockData) {
+    if (bd.deleted) continue;
+    totalWgt += bd.weight;
+    if (!heaviest || bd.weight > heaviest->weight) heaviest = &bd;
+  }
+  if (totalWgt == 0) return;
+
+  const auto entryId = region.entry()->id();
+  for (auto& bd : blockData) {
+    if (bd.deleted || &bd == heaviest) continue;
+    if (bd.blockId == entryId) continue;
+    // Don't drop blocks that other blocks were merged into; the merged
+    // ids still map to them in the region.
+    if (bd.merged) continue;
+    if (bd.weight * 100 < pct * totalWgt) {
+      FTRACE(2, "dropColdRetrans: dropping Block {} (w: {} / {})\n",
+             bd.blockId, bd.weight, totalWgt);
+      bd.deleted = true;
+    }
+  }
+}
+
 /*
  * This function sorts the `blockData' vector in decreasing order or
  * weight, and keeping the deleted ones at the end.
@@ -545,6 +583,10 @@ void optimizeChain(RegionDesc&         region,
          rootId, show(blockData));
   updateWeights(region, rootId, blockData, profData);
 
+  FTRACE(2, "optimizeGuards(rootId {}): before dropColdRetrans:\n{}\n",
+         rootId, show(blockData));
+  dropColdRetrans(blockData, region);
+
   FTRACE(2, "optimizeGuards(rootId {}): before sortBlockData:\n{}\n",
          rootId, show(blockData));
   sortBlockData(blockData);
@@ -0,0 +1,94 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_JIT_SCRATCH_ARENA_H_
+#define incl_HPHP_JIT_SCRATCH_ARENA_H_
+
+#include "hphp/util/arena.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace HPHP { namespace jit {
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Scratch arena for pass-local side structures.
+ *
+ * The JIT allocates IR itself from IRUnit's arena, but passes build lots
+ * of short-lived worklists, live-sets, and state tables whose lifetimes
+ * all end with the pass.  Routing those through a per-thread bump arena
+ * takes malloc (and free) off the compilation path; slabs stay cached on
+ * the thread, so after warmup a pass's scratch allocations are pointer
+ * bumps.
+ *
+ * ScratchScope marks a frame on the arena and pops everything allocated
+ * inside it, stack-like, when it goes out of scope.  Nothing allocated
+ * from the scratch arena may escape the enclosing ScratchScope, and the
+ * arena never runs destructors, so only containers that fully destroy
+ * themselves (or trivially-destructible payloads) belong here.
+ */
+
+using ScratchArena = ArenaImpl<32 * 1024>;
+
+ScratchArena& scratchArena();
+
+struct ScratchScope {
+  ScratchScope() { scratchArena().beginFrame(); }
+  ~ScratchScope() { scratchArena().endFrame(); }
+
+  ScratchScope(const ScratchScope&) = delete;
+  ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Minimal std-style allocator over the scratch arena.  Deallocation is a
+ * no-op; memory comes back when the enclosing ScratchScope ends.
+ */
+template<class T>
+struct ScratchAllocator {
+  using value_type = T;
+
+  ScratchAllocator() noexcept {}
+  template<class U>
+  /* implicit */ ScratchAllocator(const ScratchAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(scratchArena().alloc(n * sizeof(T)));
+  }
+  void deallocate(T*, std::size_t) noexcept {}
+};
+
+template<class T, class U>
+bool operator==(const ScratchAllocator<T>&, const ScratchAllocator<U>&) {
+  return true;
+}
+template<class T, class U>
+bool operator!=(const ScratchAllocator<T>&, const ScratchAllocator<U>&) {
+  return false;
+}
+
+template<class T>
+using scratch_vector = std::vector<T, ScratchAllocator<T>>;
+
+//////////////////////////////////////////////////////////////////////
+
+}}
+
+#endif
@@ -42,6 +42,7 @@
 #include "hphp/util/overflow.h"
 #include "hphp/util/trace.h"
 
+#include <array>
 #include <limits>
 #include <sstream>
 #include <type_traits>
@@ -1478,6 +1479,21 @@ SSATmp* simplifyEqCls(State& env, const IRInstruction* inst) {
   if (left->hasConstVal() && right->hasConstVal()) {
     return cns(env, left->clsVal() == right->clsVal());
   }
+  // When one side is a known class, the other side's specialization may
+  // already decide the comparison, e.g. in a chain of exact-class checks
+  // once a guard has established the object's class.
+  auto const decide = [&] (SSATmp* cls, SSATmp* other) -> SSATmp* {
+    if (!cls->hasConstVal(TCls)) return nullptr;
+    auto const spec = other->type().clsSpec();
+    if (!spec) return nullptr;
+    if (spec.exact()) return cns(env, spec.cls() == cls->clsVal());
+    // `other' is some subclass of spec.cls(), so it can only be equal to a
+    // class within that hierarchy.
+    if (!cls->clsVal()->classof(spec.cls())) return cns(env, false);
+    return nullptr;
+  };
+  if (auto const result = decide(right, left)) return result;
+  if (auto const result = decide(left, right)) return result;
   return nullptr;
 }
 
@@ -3141,6 +3157,9 @@ SSATmp* simplifyCount(State& env, const IRInstruction* inst) {
 SSATmp* simplifyCountArrayFast(State& env, const IRInstruction* inst) {
   auto const src = inst->src(0);
   if (inst->src(0)->hasConstVal(TArr)) return cns(env, src->arrVal()->size());
+  if (src->inst()->is(NewArray, NewMixedArray)) {
+    return cns(env, 0);
+  }
   auto const arrSpec = src->type().arrSpec();
   auto const at = arrSpec.type();
   if (!at) return nullptr;
@@ -3163,6 +3182,12 @@ SSATmp* simplifyCountArray(State& env, const IRInstruction* inst) {
 
   if (src->hasConstVal()) return cns(env, src->arrVal()->size());
 
+  // A freshly allocated array is empty; the capacity operand of these
+  // opcodes is only a hint, so the size is known without loading it.
+  if (src->inst()->is(NewArray, NewMixedArray)) {
+    return cns(env, 0);
+  }
+
   auto const kind = ty.arrSpec().kind();
 
   if (kind && !arrayKindNeedsVsize(*kind))
@@ -3178,7 +3203,9 @@ SSATmp* simplifyCountVec(State& env, const IRInstruction* inst) {
 
 SSATmp* simplifyCountDict(State& env, const IRInstruction* inst) {
   auto const dict = inst->src(0);
-  return dict->hasConstVal(TDict) ? cns(env, dict->dictVal()->size()) : nullptr;
+  if (dict->hasConstVal(TDict)) return cns(env, dict->dictVal()->size());
+  if (dict->inst()->is(NewDictArray)) return cns(env, 0);
+  return nullptr;
 }
 
 SSATmp* simplifyCountKeyset(State& env, const IRInstruction* inst) {
@@ -3419,15 +3446,19 @@ SSATmp* simplifyStrictlyIntegerConv(State& env, const IRInstruction* inst) {
 
 //////////////////////////////////////////////////////////////////////
 
-SSATmp* simplifyWork(State& env, const IRInstruction* inst) {
-  env.insts.push(inst);
-  SCOPE_EXIT {
-    assertx(env.insts.top() == inst);
-    env.insts.pop();
-  };
+using SimplifyFn = SSATmp* (*)(State&, const IRInstruction*);
 
-#define X(x) case x: return simplify##x(env, inst);
-  switch (inst->op()) {
+/*
+ * Rule dispatch table, expanded from the opcode list below at static
+ * initialization time.  Opcodes with no simplification rule map to nullptr,
+ * so simplifyWork can bail out with a single load and test -- most opcodes
+ * the simplifier visits have no rule -- instead of entering a switch and
+ * maintaining the instruction stack.
+ */
+const std::array<SimplifyFn, kNumOpcodes> s_simplifyDispatch = [] {
+  std::array<SimplifyFn, kNumOpcodes> table;
+  table.fill(nullptr);
+#define X(x) table[x] = simplify##x;
   X(Shl)
   X(Shr)
   X(AbsDbl)
@@ -3657,10 +3688,20 @@ SSATmp* simplifyWork(State& env, const IRInstruction* inst) {
   X(SpillFrame)
   X(GetMemoKey)
   X(StrictlyIntegerConv)
-  default: break;
-  }
 #undef X
-  return nullptr;
+  return table;
+}();
+
+SSATmp* simplifyWork(State& env, const IRInstruction* inst) {
+  auto const simplifyFn = s_simplifyDispatch[inst->op()];
+  if (!simplifyFn) return nullptr;
+
+  env.insts.push(inst);
+  SCOPE_EXIT {
+    assertx(env.insts.top() == inst);
+    env.insts.pop();
+  };
+  return simplifyFn(env, inst);
 }
 
 //////////////////////////////////////////////////////////////////////
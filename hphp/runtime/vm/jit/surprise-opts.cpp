@@ -0,0 +1,105 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/runtime/vm/jit/opt.h"
+
+#include "hphp/runtime/vm/jit/cfg.h"
+#include "hphp/runtime/vm/jit/containers.h"
+#include "hphp/runtime/vm/jit/ir-unit.h"
+#include "hphp/runtime/vm/jit/loop-analysis.h"
+#include "hphp/runtime/vm/jit/pass-tracer.h"
+#include "hphp/runtime/vm/jit/state-vector.h"
+
+namespace HPHP { namespace jit {
+
+TRACE_SET_MOD(hhir_surprise);
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Remove CheckSurpriseFlags instructions that are dominated by another
+ * check in the same innermost loop (or where both are outside any loop).
+ *
+ * Surprise flags are polled cooperatively; the only requirement is that
+ * the work between consecutive polls is bounded.  If B1 contains a check
+ * and dominates B2, and both have the same innermost loop, then any path
+ * that reaches B2 after crossing a back-edge of that loop goes through
+ * the loop header and, by dominance, through B1 again.  So B2's check is
+ * always preceded by B1's within the same iteration and can be dropped
+ * without losing the once-per-iteration poll.  Checks may not be removed
+ * based on a dominator outside the loop: that would leave iterations
+ * with no poll at all.
+ *
+ * irgen emits a check at every conditional back-jump, so loop tails with
+ * multiple exits commonly poll two or three times per iteration; this
+ * pass reduces that to one.
+ */
+void consolidateSurpriseChecks(IRUnit& unit) {
+  PassTracer tracer{&unit, Trace::hhir_surprise, "consolidateSurpriseChecks"};
+
+  auto const blocks = rpoSortCfg(unit);
+  auto const idoms = findDominators(unit, blocks, numberBlocks(unit, blocks));
+  auto const loopAnalysis = identifyLoops(unit, blocks);
+
+  // Depth of each loop in the loop forest.
+  jit::vector<uint32_t> loopDepth(loopAnalysis.loops.size(), 0);
+  for (auto const& loop : loopAnalysis.loops) {
+    auto depth = uint32_t{0};
+    for (auto id = loop.parent; id != kInvalidLoopID;
+         id = loopAnalysis.loops[id].parent) {
+      ++depth;
+    }
+    loopDepth[loop.id] = depth;
+  }
+
+  // Innermost loop containing each block, if any.
+  StateVector<Block, LoopID> innermost(unit, kInvalidLoopID);
+  for (auto const& loop : loopAnalysis.loops) {
+    for (auto const block : loop.blocks) {
+      auto const cur = innermost[block];
+      if (cur == kInvalidLoopID || loopDepth[loop.id] > loopDepth[cur]) {
+        innermost[block] = loop.id;
+      }
+    }
+  }
+
+  // Record the original check locations.  Using these (rather than the
+  // surviving ones) while rewriting is sound: a removed check always has a
+  // same-loop dominating check, so the topmost such check on any dominator
+  // chain survives.
+  StateVector<Block, bool> hadCheck(unit, false);
+  for (auto const block : blocks) {
+    if (!block->empty() && block->back().is(CheckSurpriseFlags)) {
+      hadCheck[block] = true;
+    }
+  }
+
+  for (auto const block : blocks) {
+    if (!hadCheck[block]) continue;
+    for (auto dom = idoms[block]; dom != nullptr; dom = idoms[dom]) {
+      if (!hadCheck[dom] || innermost[dom] != innermost[block]) continue;
+      auto& check = block->back();
+      FTRACE(2, "removing check in B{}, dominated by B{}\n",
+             block->id(), dom->id());
+      unit.replace(&check, Jmp, check.next());
+      break;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+}}
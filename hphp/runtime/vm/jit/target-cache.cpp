@@ -39,6 +39,7 @@
 #include <limits>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace HPHP { namespace jit {
@@ -312,7 +313,7 @@ readPublicStatic(Entry* mce, ActRec* ar, Class* cls, const Func* /*cand*/) {
 ///////////////////////////////////////////////////////////////////////////////
 }
 
-template<bool fatal>
+template<bool fatal, bool wide>
 void handleSlowPath(rds::Handle mce_handle,
                     ActRec* ar,
                     StringData* name,
@@ -327,10 +328,29 @@ void handleSlowPath(rds::Handle mce_handle,
   if (!rds::isHandleInit(mce_handle, rds::NormalTag{})) {
     mce->m_key = 0;
     mce->m_value = nullptr;
+    if (wide) {
+      mce[1].m_key = 0;
+      mce[1].m_value = nullptr;
+    }
     rds::initHandle(mce_handle);
   }
   assertx(IMPLIES(mce->m_key, mce->m_value));
 
+  if (wide && mce->m_key) {
+    // Probe the second way.  On a hit there, swap it to the front so the
+    // rest of this function (and the next fast-path probe) sees it; on a
+    // miss in both ways, save the front way before the code below refills
+    // it, evicting the least recently hit way.
+    auto const rawCls = reinterpret_cast<uintptr_t>(cls);
+    if ((mce->m_key & ~uintptr_t{0x3}) != rawCls) {
+      if ((mce[1].m_key & ~uintptr_t{0x3}) == rawCls) {
+        std::swap(mce[0], mce[1]);
+      } else {
+        mce[1] = mce[0];
+      }
+    }
+  }
+
   // Check for a hit in the request local cache---since we've failed
   // on the immediate smashed in the TC.
   auto const mceKey = mce->m_key;
@@ -461,7 +481,7 @@ void handleSlowPath(rds::Handle mce_handle,
   return lookup<fatal>(mce, ar, name, cls, ctx);
 }
 
-template<bool fatal>
+template<bool fatal, bool wide>
 void handlePrimeCacheInit(rds::Handle mce_handle,
                           ActRec* ar,
                           StringData* name,
@@ -472,6 +492,10 @@ void handlePrimeCacheInit(rds::Handle mce_handle,
   if (!rds::isHandleInit(mce_handle, rds::NormalTag{})) {
     mce->m_key = 0;
     mce->m_value = nullptr;
+    if (wide) {
+      mce[1].m_key = 0;
+      mce[1].m_value = nullptr;
+    }
     rds::initHandle(mce_handle);
   }
 
@@ -555,25 +579,45 @@ void handlePrimeCacheInit(rds::Handle mce_handle,
 
   // Regardless of whether the inline cache was populated, smash the
   // call to start doing real dispatch.
-  smashCall(callAddr, fatal ?
-            tc::ustubs().handleSlowPathFatal : tc::ustubs().handleSlowPath);
+  auto const slowPath = wide
+    ? (fatal ? tc::ustubs().handleSlowPathWideFatal
+             : tc::ustubs().handleSlowPathWide)
+    : (fatal ? tc::ustubs().handleSlowPathFatal
+             : tc::ustubs().handleSlowPath);
+  smashCall(callAddr, slowPath);
 }
 
 template
-void handlePrimeCacheInit<false>(rds::Handle, ActRec*, StringData*,
-                                 Class*, Class*, uintptr_t);
+void handlePrimeCacheInit<false, false>(rds::Handle, ActRec*, StringData*,
+                                        Class*, Class*, uintptr_t);
 
 template
-void handlePrimeCacheInit<true>(rds::Handle, ActRec*, StringData*,
-                                Class*, Class*, uintptr_t);
+void handlePrimeCacheInit<true, false>(rds::Handle, ActRec*, StringData*,
+                                       Class*, Class*, uintptr_t);
 
 template
-void handleSlowPath<false>(rds::Handle, ActRec*, StringData*,
-                           Class*, Class*, uintptr_t);
+void handlePrimeCacheInit<false, true>(rds::Handle, ActRec*, StringData*,
+                                       Class*, Class*, uintptr_t);
 
 template
-void handleSlowPath<true>(rds::Handle, ActRec*, StringData*,
-                          Class*, Class*, uintptr_t);
+void handlePrimeCacheInit<true, true>(rds::Handle, ActRec*, StringData*,
+                                      Class*, Class*, uintptr_t);
+
+template
+void handleSlowPath<false, false>(rds::Handle, ActRec*, StringData*,
+                                  Class*, Class*, uintptr_t);
+
+template
+void handleSlowPath<true, false>(rds::Handle, ActRec*, StringData*,
+                                 Class*, Class*, uintptr_t);
+
+template
+void handleSlowPath<false, true>(rds::Handle, ActRec*, StringData*,
+                                 Class*, Class*, uintptr_t);
+
+template
+void handleSlowPath<true, true>(rds::Handle, ActRec*, StringData*,
+                                Class*, Class*, uintptr_t);
 
 } // namespace MethodCache
 
@@ -107,20 +107,29 @@ struct StaticMethodFCache {
 namespace MethodCache {
 
 /*
- * One-way request-local cache for object method lookups.
+ * Request-local cache for object method lookups.
  *
  * MethodCache entries cache the dispatch target for an object method call.
  * Each line consists of a Class* key (stored as a uintptr_t) and a Func*.  We
  * also pack bits into the key---the low bit is set if the function is a magic
  * call (in which case the cached Func* is, and the second lowest bit is set if
  * the cached Func has AttrStatic.
+ *
+ * Most call sites use a single direct-mapped Entry.  Sites whose MethProfile
+ * shows two receiver classes alternating get a WideEntry instead: two ways
+ * in one cache line, probed by the wide handlers with the most recently hit
+ * way kept first, so bimodal sites stop evicting each other's target.
  */
 struct Entry {
   uintptr_t m_key;
   const Func* m_value;
 };
 
-template<bool fatal>
+struct WideEntry {
+  Entry m_ways[2];
+};
+
+template<bool fatal, bool wide>
 void handlePrimeCacheInit(rds::Handle mce_handle,
                           ActRec* ar,
                           StringData* name,
@@ -128,7 +137,7 @@ void handlePrimeCacheInit(rds::Handle mce_handle,
                           Class* ctx,
                           uintptr_t rawTarget);
 
-template<bool fatal>
+template<bool fatal, bool wide>
 void handleSlowPath(rds::Handle mce_handle,
                     ActRec* ar,
                     StringData* name,
@@ -40,11 +40,23 @@
 #include "hphp/util/ringbuffer.h"
 #include "hphp/util/trace.h"
 
+#include <folly/Optional.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
 TRACE_SET_MOD(mcg);
 
 namespace HPHP { namespace jit { namespace tc {
 
-TCA bindJmp(TCA toSmash, SrcKey destSk, TransFlags /*trflags*/, bool& smashed) {
+namespace {
+
+TCA bindJmpImpl(TCA toSmash, SrcKey destSk, bool& smashed) {
   auto const sr = srcDB().find(destSk);
   always_assert(sr);
   if (sr->getTopTranslation() == nullptr) return nullptr;
@@ -94,8 +106,7 @@ TCA bindJmp(TCA toSmash, SrcKey destSk, TransFlags /*trflags*/, bool& smashed) {
   return tDest;
 }
 
-TCA bindAddr(TCA toSmash, SrcKey destSk, TransFlags /*trflags*/,
-             bool& smashed) {
+TCA bindAddrImpl(TCA toSmash, SrcKey destSk, bool& smashed) {
   auto const sr = srcDB().find(destSk);
   always_assert(sr);
   if (sr->getTopTranslation() == nullptr) return nullptr;
@@ -116,6 +127,122 @@ TCA bindAddr(TCA toSmash, SrcKey destSk, TransFlags /*trflags*/,
   return tDest;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Queue of bind sites waiting to be smashed by the binder thread.
+ *
+ * When Eval.JitAsyncBindSmash is set, request threads only look up the
+ * destination translation and enqueue the site here; the binder thread
+ * performs the actual smashing in batches.  An unsmashed site just re-enters
+ * the service-request stub on its next execution, so deferring is always
+ * safe--provided the site itself can't be reclaimed, which is why this is
+ * disabled together with EnableReusableTC.
+ */
+struct PendingBind {
+  TCA toSmash;
+  SrcKey destSk;
+  bool isAddr;
+};
+
+std::atomic<bool> s_bindRunning{false};
+std::queue<PendingBind> s_bindq;
+std::condition_variable s_bindqcv;
+std::mutex s_bindqlock;
+std::thread s_binder;
+
+bool asyncBindActive() {
+  return s_bindRunning.load(std::memory_order_acquire);
+}
+
+void enqueueBind(TCA toSmash, SrcKey destSk, bool isAddr) {
+  std::unique_lock<std::mutex> l{s_bindqlock};
+  s_bindq.push(PendingBind{toSmash, destSk, isAddr});
+  l.unlock();
+  s_bindqcv.notify_all();
+}
+
+folly::Optional<std::vector<PendingBind>> dequeueBinds() {
+  std::unique_lock<std::mutex> l{s_bindqlock};
+  s_bindqcv.wait(l, [] {
+    return !s_bindRunning.load(std::memory_order_acquire) || !s_bindq.empty();
+  });
+
+  if (s_bindq.empty()) return folly::none;
+
+  std::vector<PendingBind> batch;
+  do {
+    batch.emplace_back(s_bindq.front());
+    s_bindq.pop();
+  } while (!s_bindq.empty());
+  return batch;
+}
+
+void bindWorker() {
+  while (auto batch = dequeueBinds()) {
+    // Smash sites on the same code page back to back.  bindJmpImpl and
+    // bindAddrImpl both recheck the current target under the SrcRec lock, so
+    // duplicate entries for a site are harmless.
+    std::sort(batch->begin(), batch->end(),
+              [] (const PendingBind& a, const PendingBind& b) {
+                return a.toSmash < b.toSmash;
+              });
+    for (auto const& pb : *batch) {
+      bool smashed = false;
+      if (pb.isAddr) {
+        bindAddrImpl(pb.toSmash, pb.destSk, smashed);
+      } else {
+        bindJmpImpl(pb.toSmash, pb.destSk, smashed);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+}
+
+void asyncBindInit() {
+  if (!RuntimeOption::EvalJitAsyncBindSmash ||
+      RuntimeOption::EvalEnableReusableTC) {
+    return;
+  }
+
+  s_bindRunning.store(true, std::memory_order_release);
+  s_binder = std::thread(bindWorker);
+}
+
+void asyncBindStop() {
+  if (!s_bindRunning.load(std::memory_order_acquire)) return;
+  s_bindRunning.store(false, std::memory_order_release);
+  s_bindqcv.notify_all();
+  s_binder.join();
+}
+
+TCA bindJmp(TCA toSmash, SrcKey destSk, TransFlags /*trflags*/, bool& smashed) {
+  if (asyncBindActive()) {
+    auto const sr = srcDB().find(destSk);
+    always_assert(sr);
+    auto const tDest = sr->getTopTranslation();
+    if (tDest == nullptr) return nullptr;
+    enqueueBind(toSmash, destSk, false);
+    return tDest;
+  }
+  return bindJmpImpl(toSmash, destSk, smashed);
+}
+
+TCA bindAddr(TCA toSmash, SrcKey destSk, TransFlags /*trflags*/,
+             bool& smashed) {
+  if (asyncBindActive()) {
+    auto const sr = srcDB().find(destSk);
+    always_assert(sr);
+    auto const tDest = sr->getTopTranslation();
+    if (tDest == nullptr) return nullptr;
+    enqueueBind(toSmash, destSk, true);
+    return tDest;
+  }
+  return bindAddrImpl(toSmash, destSk, smashed);
+}
+
 void bindCall(TCA toSmash, TCA start, Func* callee, int nArgs, bool immutable) {
   if (!start || smashableCallTarget(toSmash) == start) return;
 
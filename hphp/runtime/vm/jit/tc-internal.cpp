@@ -56,6 +56,7 @@ UniqueStubs g_ustubs;
 namespace {
 
 std::atomic<uint64_t> s_numTrans;
+std::atomic<uint64_t> s_liveMainUsage;
 SimpleMutex s_codeLock{false, RankCodeCache};
 SimpleMutex s_metadataLock{false, RankCodeMetadata};
 __thread size_t s_initialTCSize;
@@ -113,9 +114,14 @@ bool shouldTranslateNoSizeLimit(const Func* func, TransKind kind) {
     return false;
   }
 
-  // Refuse to JIT Live translations if Eval.JitPGOOnly is enabled.
+  // Refuse to JIT Live translations if Eval.JitPGOOnly is enabled, except
+  // within the Eval.JitPGOOnlyLiveBudget bytes of main code set aside for
+  // functions that missed the profiling window and would otherwise stay
+  // interpreted forever.
   if (RuntimeOption::EvalJitPGOOnly &&
-      (kind == TransKind::Live || kind == TransKind::LivePrologue)) {
+      (kind == TransKind::Live || kind == TransKind::LivePrologue) &&
+      s_liveMainUsage.load(std::memory_order_relaxed) >=
+        RuntimeOption::EvalJitPGOOnlyLiveBudget) {
     return false;
   }
 
@@ -191,6 +197,10 @@ bool newTranslation() {
   return true;
 }
 
+void recordLiveMainUsage(size_t mainSize) {
+  s_liveMainUsage.fetch_add(mainSize, std::memory_order_relaxed);
+}
+
 std::unique_lock<SimpleMutex> lockCode() {
   return std::unique_lock<SimpleMutex>{s_codeLock};
 }
@@ -253,10 +263,12 @@ void processInit() {
   Disasm::ExcludedAddressRange(g_code->base(), g_code->codeSize());
 
   recycleInit();
+  asyncBindInit();
 }
 
 void processExit() {
   recycleStop();
+  asyncBindStop();
 }
 
 bool isValidCodeAddress(TCA addr) {
@@ -188,6 +188,13 @@ std::unique_lock<SimpleMutex> lockMetadata();
  */
 bool newTranslation();
 
+/*
+ * Record that `mainSize' bytes of main code were published for a Live
+ * translation.  Counted against Eval.JitPGOOnlyLiveBudget when
+ * Eval.JitPGOOnly is set.
+ */
+void recordLiveMainUsage(size_t mainSize);
+
 /*
  * Structure representing the various parts of the TC available to the JIT. The
  * code lock must be acquired before attempting to write into code.
@@ -219,6 +226,18 @@ void recycleInit();
  */
 void recycleStop();
 
+/*
+ * Start the binder thread that drains deferred bind-smash requests. Does
+ * nothing unless EvalJitAsyncBindSmash is set (and EvalEnableReusableTC is
+ * not).
+ */
+void asyncBindInit();
+
+/*
+ * Stop the binder thread, draining any queued bind sites first.
+ */
+void asyncBindStop();
+
 }}}
 
 #endif
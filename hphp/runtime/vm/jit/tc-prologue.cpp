@@ -44,6 +44,8 @@ void updateFuncPrologue(TCA start, ProfTransRec* rec) {
   auto func = rec->func();
   auto nArgs = rec->prologueArgs();
 
+  auto const oldPrologue = TCA(func->getPrologue(nArgs));
+
   auto lock = rec->lockCallerList();
   func->setPrologue(nArgs, start);
 
@@ -61,6 +63,13 @@ void updateFuncPrologue(TCA start, ProfTransRec* rec) {
     }
   }
   rec->clearAllCallers();
+
+  if (RuntimeOption::EvalEnableReusableTC) {
+    // The profiling prologue is now unreachable: the Func's prologue table
+    // points at the new one and all recorded callers have been smashed.
+    // Reclaim its space (deferred to the treadmill for in-flight callers).
+    reclaimFuncPrologue(func, oldPrologue);
+  }
 }
 
 TCA emitFuncPrologueImpl(Func* func, int argc, TransKind kind) {
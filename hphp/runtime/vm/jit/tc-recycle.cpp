@@ -479,6 +479,43 @@ void reclaimTranslations(GrowableVector<TransLoc>&& trans) {
   });
 }
 
+bool reclaimFuncPrologue(const Func* func, TCA start) {
+  auto const stillReachable = [&] (TransLoc loc) {
+    // Magic-call prologues may share code between entries of the Func's
+    // prologue table, so don't free the translation while any entry still
+    // points into it.
+    for (int i = 0, n = func->numPrologues(); i < n; ++i) {
+      if (loc.contains(TCA(func->getPrologue(i)))) return true;
+    }
+    return false;
+  };
+
+  auto const loc = [&] () -> folly::Optional<TransLoc> {
+    auto dataLock = lockData();
+    auto const it = s_funcTCData.find(func->getFuncId());
+    if (it == s_funcTCData.end()) return folly::none;
+    auto& prologues = it->second.prologues;
+    for (auto pit = prologues.begin(); pit != prologues.end(); ++pit) {
+      if (pit->contains(start)) {
+        if (stillReachable(*pit)) return folly::none;
+        auto const found = *pit;
+        prologues.erase(pit);
+        return found;
+      }
+    }
+    return folly::none;
+  }();
+  if (!loc) return false;
+
+  ITRACE(1, "Reclaiming prologue for func {} (id={}) @ {}\n",
+         func->fullName()->data(), func->getFuncId(), start);
+
+  // Threads may still be executing the prologue even though all of its
+  // callers have been smashed; wait for them on the treadmill.
+  Treadmill::enqueue([loc = *loc] { reclaimTranslation(loc); });
+  return true;
+}
+
 
 void recycleInit() {
   if (!RuntimeOption::EvalEnableReusableTC) return;
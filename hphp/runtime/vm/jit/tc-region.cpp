@@ -256,6 +256,11 @@ publishTranslationInternal(TransMetaInfo info, OptView optSrcView) {
         loc.mainStart(), showShort(sk).c_str());
   srcRec->newTranslation(loc, inProgressTailBranches);
 
+  if (info.transKind == TransKind::Live ||
+      info.transKind == TransKind::LivePrologue) {
+    recordLiveMainUsage(loc.mainSize());
+  }
+
   TRACE(1, "mcg: %zd-byte tracelet\n", (ssize_t)loc.mainSize());
   if (Trace::moduleEnabledRelease(Trace::tcspace, 1)) {
     Trace::traceRelease("%s", getTCSpace().c_str());
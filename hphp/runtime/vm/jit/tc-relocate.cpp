@@ -452,6 +452,9 @@ void relocate(std::vector<TransRelocInfo>& relocs, CodeBlock& dest,
   }
   adjustCodeForRelocation(rel, fixups);
 
+  // Keep the perf map and jitdump file pointing at the relocated code.
+  Debug::DebugInfo::Get()->relocatePerfMap(rel);
+
   unlink(Debug::DebugInfo::Get()->getRelocMapName().c_str());
   rename(newRelocMapName.c_str(),
          Debug::DebugInfo::Get()->getRelocMapName().c_str());
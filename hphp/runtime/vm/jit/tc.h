@@ -309,6 +309,19 @@ void reclaimFunction(const Func* func);
  */
 void reclaimTranslations(GrowableVector<TransLoc>&& trans);
 
+/*
+ * Reclaim the recorded prologue of `func' containing the address `start',
+ * if any. Returns true if a prologue was found and scheduled for
+ * reclamation.
+ *
+ * The prologue _must_ be unreachable before this is called, which is
+ * generally achieved by repointing the Func's prologue table and smashing
+ * all recorded callers (see updateFuncPrologue()); the actual free is
+ * deferred to the treadmill to cover callers still executing the old
+ * prologue.
+ */
+bool reclaimFuncPrologue(const Func* func, TCA start);
+
 /*
  * Free an ephemeral stub.
  */
@@ -27,6 +27,7 @@
 #include "hphp/util/struct-log.h"
 #include "hphp/util/timer.h"
 #include "hphp/util/trace.h"
+#include "hphp/util/tsc-clock.h"
 #include "hphp/util/vdso.h"
 
 TRACE_SET_MOD(jittime);
@@ -51,9 +52,10 @@ int64_t getCPUTimeNanos() {
          -1;
 }
 
+// Only ever used in differences, so the calibrated TSC's monotonic time is
+// fine (and much cheaper than gettimeofday).
 int64_t getWallClockMicros() {
-  return RuntimeOption::EvalJitTimer ? HPHP::Timer::GetCurrentTimeMicros() :
-         -1;
+  return RuntimeOption::EvalJitTimer ? TscClock::nowMicros() : -1;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -53,6 +53,28 @@ const TransRec* getTransRec(TCA tca) {
   return &s_translations[it->second];
 }
 
+const TransRec* getTransRecContaining(TCA tca) {
+  if (!enabled()) return nullptr;
+  tc::assertOwnsCodeLock();
+
+  // Since translation ranges never overlap, the range containing `tca', if
+  // any, is the one with the greatest start address not past it.
+  auto it = s_transDB.upper_bound(tca);
+  if (it == s_transDB.begin()) return nullptr;
+  --it;
+  if (it->second >= s_translations.size()) return nullptr;
+
+  auto const rec = &s_translations[it->second];
+  auto const contains = [&] (TCA start, uint32_t len) {
+    return start <= tca && tca < start + len;
+  };
+  if (contains(rec->aStart, rec->aLen) ||
+      contains(rec->acoldStart, rec->acoldLen)) {
+    return rec;
+  }
+  return nullptr;
+}
+
 const TransRec* getTransRec(TransID transId) {
   if (!enabled()) return nullptr;
 
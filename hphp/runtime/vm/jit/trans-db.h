@@ -49,6 +49,17 @@ bool enabled();
 const TransRec* getTransRec(TCA tca);
 const TransRec* getTransRec(TransID transId);
 
+/*
+ * Get the TransRec whose main or cold code range contains `tca' (getTransRec
+ * only matches range starts).  Used to attribute sampled instruction pointers
+ * to translations.
+ *
+ * Return nullptr if the TransDB is not enabled or no translation contains
+ * `tca'.  The caller must own the code lock, since the lookup walks the
+ * TransDB's address map.
+ */
+const TransRec* getTransRecContaining(TCA tca);
+
 /*
  * Add a translation.
  *
@@ -1354,16 +1354,28 @@ void UniqueStubs::emitAll(CodeCache& code, Debug::DebugInfo& dbg) {
 
   ADD(handlePrimeCacheInit,
       emitHelperThunk(code, cold, data,
-                      MethodCache::handlePrimeCacheInit<false>));
+                      MethodCache::handlePrimeCacheInit<false, false>));
   ADD(handlePrimeCacheInitFatal,
       emitHelperThunk(code, cold, data,
-                      MethodCache::handlePrimeCacheInit<true>));
+                      MethodCache::handlePrimeCacheInit<true, false>));
+  ADD(handlePrimeCacheInitWide,
+      emitHelperThunk(code, cold, data,
+                      MethodCache::handlePrimeCacheInit<false, true>));
+  ADD(handlePrimeCacheInitWideFatal,
+      emitHelperThunk(code, cold, data,
+                      MethodCache::handlePrimeCacheInit<true, true>));
   ADD(handleSlowPath,
       emitHelperThunk(code, main, data,
-                      MethodCache::handleSlowPath<false>));
+                      MethodCache::handleSlowPath<false, false>));
   ADD(handleSlowPathFatal,
       emitHelperThunk(code, main, data,
-                      MethodCache::handleSlowPath<true>));
+                      MethodCache::handleSlowPath<true, false>));
+  ADD(handleSlowPathWide,
+      emitHelperThunk(code, main, data,
+                      MethodCache::handleSlowPath<false, true>));
+  ADD(handleSlowPathWideFatal,
+      emitHelperThunk(code, main, data,
+                      MethodCache::handleSlowPath<true, true>));
 
 #undef ADD
 
@@ -445,6 +445,14 @@ struct UniqueStubs {
   TCA handleSlowPath;
   TCA handleSlowPathFatal;
 
+  /*
+   * Same, for call sites using the two-way MethodCache::WideEntry.
+   */
+  TCA handlePrimeCacheInitWide;
+  TCA handlePrimeCacheInitWideFatal;
+  TCA handleSlowPathWide;
+  TCA handleSlowPathWideFatal;
+
   /////////////////////////////////////////////////////////////////////////////
 
   /*
@@ -16,6 +16,7 @@
 
 #include "hphp/runtime/vm/jit/vasm.h"
 
+#include "hphp/runtime/vm/jit/scratch-arena.h"
 #include "hphp/runtime/vm/jit/timer.h"
 #include "hphp/runtime/vm/jit/vasm-instr.h"
 #include "hphp/runtime/vm/jit/vasm-print.h"
@@ -33,7 +34,10 @@ TRACE_SET_MOD(vasm);
 namespace HPHP { namespace jit {
 
 namespace {
-typedef boost::dynamic_bitset<> LiveSet;
+// Live-sets are scratch-arena backed; removeDeadCode can allocate one per
+// block per fixed-point iteration.
+typedef boost::dynamic_bitset<unsigned long,
+                              ScratchAllocator<unsigned long>> LiveSet;
 bool effectful(Vinstr& inst) {
   switch (inst.op) {
     case Vinstr::absdbl:
@@ -298,8 +302,9 @@ bool effectful(Vinstr& inst) {
 // the nearest useful post-dominator.
 void removeDeadCode(Vunit& unit) {
   Timer timer(Timer::vasm_dce);
+  ScratchScope scratchScope;
   auto blocks = sortBlocks(unit);
-  jit::vector<LiveSet> livein(unit.blocks.size());
+  scratch_vector<LiveSet> livein(unit.blocks.size());
   LiveSet live(unit.next_vr);
 
   auto pass = [&](bool mutate) {
@@ -22,6 +22,7 @@
 #include "hphp/runtime/vm/jit/vasm.h"
 #include "hphp/runtime/vm/jit/vasm-instr.h"
 #include "hphp/runtime/vm/jit/vasm-print.h"
+#include "hphp/runtime/vm/jit/vasm-prof.h"
 #include "hphp/runtime/vm/jit/vasm-text.h"
 #include "hphp/runtime/vm/jit/vasm-unit.h"
 #include "hphp/runtime/vm/jit/vasm-visit.h"
@@ -154,15 +155,35 @@ int64_t Scale::findProfCount(Vlabel blk) const {
 void Scale::computeArcWeights() {
   for (auto b : m_blocks) {
     auto succSet = succs(m_unit.blocks[b]);
-    for (auto s : succSet) {
+
+    // For two-way branches, Profile translations may have counted how often
+    // each side was executed (see profBranchCounter()), which lets us split
+    // the block's weight between the arcs by the observed probability.  The
+    // taken target of a jcc is targets[1], i.e. the second successor.
+    folly::Optional<double> takenProb;
+    if (succSet.size() == 2) {
+      auto const& term = m_unit.blocks[b].code.back();
+      if (term.op == Vinstr::jcc && term.origin) {
+        takenProb = profBranchTakenProb(term.origin->func(),
+                                        term.origin->marker().bcOff(),
+                                        term.origin->op());
+      }
+    }
+
+    for (unsigned i = 0; i < succSet.size(); i++) {
+      auto const s = succSet[i];
       // If the arc is non-critical, we can figure out its weight by
-      // looking at its incident blocks.  For critical arcs, we
-      // currently just approximate it as half of the smallest weight
-      // of its incident blocks.
+      // looking at its incident blocks.  For critical arcs, we use the
+      // profiled branch probability when we have one, and otherwise just
+      // approximate it as half of the smallest weight of its incident
+      // blocks.
       auto arcid = arcId(b, s);
       m_arcWgts[arcid] = succSet.size()    == 1 ? weight(b)
                        : m_preds[s].size() == 1 ? weight(s)
-                       : std::min(weight(b), weight(s)) / 2;
+                       : takenProb
+                         ? int64_t(weight(b) *
+                                   (i == 1 ? *takenProb : 1.0 - *takenProb))
+                         : std::min(weight(b), weight(s)) / 2;
       if (m_arcWgts[arcid] < 0) m_arcWgts[arcid] = 0;
       FTRACE(3, "arc({} -> {}) => weight = {}  "
              "[|succs(b)| = {} ; |preds(s)| = {}] "
@@ -408,8 +429,12 @@ void Clusterizer::splitHotColdClusters() {
 
   for (auto cid : m_clusterOrder) {
     if (m_clusters[cid].size() == 0) continue;
-    const AreaIndex area = clusterAvgWgt[cid] >= hotThreshold ? AreaIndex::Main
-                                                              : AreaIndex::Cold;
+    // Clusters that were never reached during profiling go all the way to
+    // frozen; merely colder-than-average ones stay in cold.
+    const AreaIndex area =
+      clusterAvgWgt[cid] >= hotThreshold ? AreaIndex::Main :
+      clusterAvgWgt[cid] == 0            ? AreaIndex::Frozen :
+                                           AreaIndex::Cold;
     FTRACE(3, "  -> C{}: {} (avg wgt = {}): ",
            cid, area_names[unsigned(area)], clusterAvgWgt[cid]);
     for (auto b : m_clusters[cid]) {
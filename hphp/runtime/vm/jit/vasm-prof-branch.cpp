@@ -47,6 +47,8 @@
 
 #include <boost/dynamic_bitset.hpp>
 #include <boost/range/adaptor/reversed.hpp>
+#include <folly/Hash.h>
+#include <tbb/concurrent_hash_map.h>
 
 #include <string>
 #include <vector>
@@ -153,6 +155,69 @@ public:
  */
 constexpr auto kVersion = 1;
 
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * In-process taken/next counters for a branch, used in Profile translations
+ * when Eval.ProfBranchCounters is set.  The increments are racy, so the
+ * counts are approximate.
+ */
+struct BranchCounters {
+  std::atomic<uint64_t> taken{0};
+  std::atomic<uint64_t> next{0};
+};
+
+struct BranchKey {
+  FuncId funcId;
+  Offset bcoff;
+  Opcode op;
+
+  bool operator==(const BranchKey& o) const {
+    return funcId == o.funcId && bcoff == o.bcoff && op == o.op;
+  }
+};
+
+struct BranchKeyHashCompare {
+  static size_t hash(const BranchKey& k) {
+    return folly::hash::hash_combine(k.funcId, k.bcoff, uint16_t(k.op));
+  }
+  static bool equal(const BranchKey& a, const BranchKey& b) { return a == b; }
+};
+
+/*
+ * Counters are allocated once and never freed, so the addresses burned into
+ * Profile translations stay valid for the life of the process.
+ */
+using BranchCounterMap =
+  tbb::concurrent_hash_map<BranchKey, BranchCounters*, BranchKeyHashCompare>;
+BranchCounterMap s_branchCounters;
+
+}
+
+std::atomic<uint64_t>* profBranchCounter(const Func* func, Offset bcoff,
+                                         Opcode op, bool taken) {
+  auto const key = BranchKey { func->getFuncId(), bcoff, op };
+  BranchCounterMap::accessor acc;
+  if (s_branchCounters.insert(acc, key)) {
+    acc->second = new BranchCounters();
+  }
+  return taken ? &acc->second->taken : &acc->second->next;
+}
+
+folly::Optional<double> profBranchTakenProb(const Func* func, Offset bcoff,
+                                            Opcode op) {
+  BranchCounterMap::const_accessor acc;
+  if (!s_branchCounters.find(acc, BranchKey { func->getFuncId(),
+                                              bcoff, op })) {
+    return folly::none;
+  }
+  auto const taken = acc->second->taken.load(std::memory_order_relaxed);
+  auto const next = acc->second->next.load(std::memory_order_relaxed);
+  auto const total = taken + next;
+  // Too few hits make for a noisy estimate; let the caller fall back to its
+  // static heuristics instead.
+  if (total < 128) return folly::none;
+  return double(taken) / total;
 }
 
 /*
@@ -297,6 +362,10 @@ struct Env {
    * Set of Vlabels for which rvmfp() is not valid.
    */
   boost::dynamic_bitset<> fp_invalid;
+  /*
+   * Whether to bump in-process counters instead of logging sampled hits.
+   */
+  bool counters;
 };
 
 /*
@@ -407,7 +476,6 @@ void create_profiling_header(Env& env, BranchID branch, Vlabel to,
   if (!inst.origin) return; // we only want to profile IR control-flow
 
   auto v = vheader(env.unit, to);
-  auto vc = vheader(env.unit, to, AreaIndex::Cold);
   auto const header = Vlabel(v);
 
   auto const live = env.sf_livein[to];
@@ -420,11 +488,19 @@ void create_profiling_header(Env& env, BranchID branch, Vlabel to,
     v << pushf{live};
   }
 
-  // Check the profiling counter, and log a sample if it overflows.
-  auto const sf = check_counter(v);
-  unlikelyIfThen(v, vc, CC_LE, sf, [&] (Vout& v) {
-    sample_branch(v, env, branch, inst.origin->func(), to);
-  });
+  if (env.counters) {
+    // Bump the counter for this side of the branch.
+    auto const ctr = profBranchCounter(inst.origin->func(), branch.from.bcoff,
+                                       branch.from.ir_op, branch.from.taken);
+    v << incqm{v.cns(uintptr_t(ctr))[0], v.makeReg()};
+  } else {
+    // Check the profiling counter, and log a sample if it overflows.
+    auto vc = vheader(env.unit, to, AreaIndex::Cold);
+    auto const sf = check_counter(v);
+    unlikelyIfThen(v, vc, CC_LE, sf, [&] (Vout& v) {
+      sample_branch(v, env, branch, inst.origin->func(), to);
+    });
+  }
 
   if (live.isValid()) {
     // Restore flags, and register that we need to rename the uses.
@@ -480,14 +556,22 @@ void profile(Env& env, jcci& inst, Vlabel b) {
 
   // Profile the `taken' branch...
   auto v = vheader(unit, b);
-  auto vc = vheader(unit, b, AreaIndex::Cold);
   auto const header = Vlabel(v);
 
-  auto const sf = check_counter(v);
-  unlikelyIfThen(v, vc, CC_LE, sf, [&] (Vout& v) {
+  if (env.counters) {
     auto const& vinstr = env.unit.blocks[b].code.back();
-    sample_branch(v, env, branch.take(true), vinstr.origin->func(), b);
-  });
+    auto const ctr = profBranchCounter(vinstr.origin->func(),
+                                       branch.from.bcoff,
+                                       branch.from.ir_op, true);
+    v << incqm{v.cns(uintptr_t(ctr))[0], v.makeReg()};
+  } else {
+    auto vc = vheader(unit, b, AreaIndex::Cold);
+    auto const sf = check_counter(v);
+    unlikelyIfThen(v, vc, CC_LE, sf, [&] (Vout& v) {
+      auto const& vinstr = env.unit.blocks[b].code.back();
+      sample_branch(v, env, branch.take(true), vinstr.origin->func(), b);
+    });
+  }
   v << jmpi{inst.taken};
 
   // ...then replace the jcci{} with a jcc{}.
@@ -717,7 +801,8 @@ void profile_branches(Vunit& unit) {
     unit,
     compute_sf_livein(unit, rpo, preds),
     decltype(Env::sf_renames){},
-    analyze_fp_validity(unit, rpo, preds)
+    analyze_fp_validity(unit, rpo, preds),
+    unit.context && isProfiling(unit.context->kind)
   };
 
   PostorderWalker{unit}.dfs([&] (Vlabel b) {
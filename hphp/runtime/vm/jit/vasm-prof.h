@@ -17,7 +17,19 @@
 #ifndef incl_HPHP_JIT_VASM_PROF_H_
 #define incl_HPHP_JIT_VASM_PROF_H_
 
-namespace HPHP { namespace jit {
+#include "hphp/runtime/base/types.h"
+#include "hphp/runtime/vm/jit/ir-opcode.h"
+
+#include <folly/Optional.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace HPHP {
+
+struct Func;
+
+namespace jit {
 
 struct Vunit;
 
@@ -25,9 +37,36 @@ struct Vunit;
 
 /*
  * Insert code to profile all branches in `unit'.
+ *
+ * In non-profiling translations (with Eval.ProfBranchSampleFreq set), this
+ * logs sampled branch hits via StructuredLog, for offline analysis.  In
+ * Profile translations (with Eval.ProfBranchCounters set), it instead bumps
+ * in-process per-branch counters, which feed block layout when the optimized
+ * translations are generated.
  */
 void profile_branches(Vunit& unit);
 
+/*
+ * Get the counter for one side of the branch identified by (`func', `bcoff',
+ * `op'), creating it if necessary.
+ *
+ * Branches are keyed by the bytecode offset and IR opcode of their origin
+ * instruction, since vasm-level identifiers aren't stable between the Profile
+ * and Optimize translations of a region.  Distinct vasm branches that lower
+ * from the same IR instruction share a counter, so the resulting probability
+ * is a blend---fine for a layout heuristic.
+ */
+std::atomic<uint64_t>* profBranchCounter(const Func* func, Offset bcoff,
+                                         Opcode op, bool taken);
+
+/*
+ * Probability that the branch identified by (`func', `bcoff', `op') was taken
+ * during profiling, or folly::none if we don't have enough samples for a
+ * stable estimate.
+ */
+folly::Optional<double> profBranchTakenProb(const Func* func, Offset bcoff,
+                                            Opcode op);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }}
@@ -85,7 +85,8 @@ bool simplify(Env& env, const cmovq& inst, Vlabel b, size_t i) {
 ///////////////////////////////////////////////////////////////////////////////
 
 bool simplify(Env& env, const loadb& inst, Vlabel b, size_t i) {
-  return if_inst<Vinstr::movzbl>(env, b, i + 1, [&] (const movzbl& mov) {
+  auto const folded = if_inst<Vinstr::movzbl>(env, b, i + 1,
+                                              [&] (const movzbl& mov) {
     // loadb{s, tmp}; movzbl{tmp, d}; -> loadzbl{s, d};
     if (!(env.use_counts[inst.d] == 1 &&
           inst.d == mov.s)) return false;
@@ -95,6 +96,32 @@ bool simplify(Env& env, const loadb& inst, Vlabel b, size_t i) {
       return 2;
     });
   });
+  if (folded) return true;
+
+  return if_inst<Vinstr::movzbq>(env, b, i + 1, [&] (const movzbq& mov) {
+    // loadb{s, tmp}; movzbq{tmp, d}; -> loadzbq{s, d};
+    if (!(env.use_counts[inst.d] == 1 &&
+          inst.d == mov.s)) return false;
+
+    return simplify_impl(env, b, i, [&] (Vout& v) {
+      v << loadzbq{inst.s, mov.d};
+      return 2;
+    });
+  });
+}
+
+bool simplify(Env& env, const loadl& inst, Vlabel b, size_t i) {
+  return if_inst<Vinstr::movzlq>(env, b, i + 1, [&] (const movzlq& mov) {
+    // loadl{s, tmp}; movzlq{tmp, d}; -> loadzlq{s, d};
+    // (ldr w zero-extends, so the extend is free.)
+    if (!(env.use_counts[inst.d] == 1 &&
+          inst.d == mov.s)) return false;
+
+    return simplify_impl(env, b, i, [&] (Vout& v) {
+      v << loadzlq{inst.s, mov.d};
+      return 2;
+    });
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,6 +23,7 @@
 #include "hphp/runtime/vm/jit/code-gen-helpers.h"
 #include "hphp/runtime/vm/jit/print.h"
 #include "hphp/runtime/vm/jit/prof-data.h"
+#include "hphp/runtime/vm/jit/scratch-arena.h"
 #include "hphp/runtime/vm/jit/service-requests.h"
 #include "hphp/runtime/vm/jit/smashable-instr-x64.h"
 #include "hphp/runtime/vm/jit/target-cache.h"
@@ -1051,6 +1052,10 @@ void lowerForX64(Vunit& unit) {
 void optimizeX64(Vunit& unit, const Abi& abi, bool regalloc) {
   Timer timer(Timer::vasm_optimize, unit.log_entry);
 
+  // Scratch memory used by the passes below is released when the pipeline
+  // finishes.
+  ScratchScope scratchScope;
+
   removeTrivialNops(unit);
   optimizePhis(unit);
   fuseBranches(unit);
@@ -1059,12 +1064,15 @@ void optimizeX64(Vunit& unit, const Abi& abi, bool regalloc) {
 
   assertx(checkWidths(unit));
 
-  if (unit.context && !isProfiling(unit.context->kind) && abi.canSpill &&
-      RuntimeOption::EvalProfBranchSampleFreq > 0) {
-    // Even when branch profiling is on, we still only want to profile
-    // non-profiling translations of PHP functions.  We also require that we
-    // can spill, so that we can generate arbitrary profiling code, and also to
-    // ensure we don't profile unique stubs and such.
+  if (unit.context && abi.canSpill &&
+      (isProfiling(unit.context->kind)
+         ? RuntimeOption::EvalProfBranchCounters
+         : RuntimeOption::EvalProfBranchSampleFreq > 0)) {
+    // Sampled branch logging only applies to non-profiling translations of
+    // PHP functions, while the in-process branch counters that feed layout
+    // are only collected in Profile translations.  Either way we require
+    // that we can spill, so that we can generate arbitrary profiling code,
+    // and also to ensure we don't profile unique stubs and such.
     profile_branches(unit);
   }
 
@@ -2466,6 +2466,53 @@ void optimizeSFLiveness(Vunit& unit, const VxlsContext& ctx,
 ///////////////////////////////////////////////////////////////////////////////
 // Copy insertion.
 
+/*
+ * Return a copy of `var's def instruction with its destination replaced by
+ * `dst', if the def can be cheaply re-executed at any reload position;
+ * folly::none otherwise.
+ *
+ * We can only re-execute instructions whose sources are guaranteed to still
+ * hold the same values at every reload of `var'.  rvmtl() is reserved and
+ * never written inside a translation, which covers the common case of RDS
+ * addresses computed with lea.  Neither lea nor copy touches the flags, so
+ * no %sf liveness check is needed.  (Constant loads don't get this far; they
+ * are handled separately by insertLoadsAt.)
+ */
+folly::Optional<Vinstr> reexecutableDef(const Variable* var, Vreg dst) {
+  auto const& inst = var->def_inst;
+  switch (inst.op) {
+    case Vinstr::lea: {
+      auto const& s = inst.lea_.s;
+      if (!s.base.isValid() ||
+          !s.base.isPhys() ||
+          Vreg{s.base} != Vreg{rvmtl()} ||
+          s.index.isValid()) {
+        return folly::none;
+      }
+      auto remat = inst;
+      remat.lea_.d = dst;
+      return remat;
+    }
+    case Vinstr::copy: {
+      auto const s = inst.copy_.s;
+      if (!s.isPhys() || s != Vreg{rvmtl()}) return folly::none;
+      auto remat = inst;
+      remat.copy_.d = dst;
+      return remat;
+    }
+    default:
+      return folly::none;
+  }
+}
+
+/*
+ * Whether every reload of `var' will re-execute its def rather than load
+ * from the spill slot (in which case the spill store can be elided).
+ */
+bool rematerializable(const Variable* var) {
+  return reexecutableDef(var, var->vreg).hasValue();
+}
+
 /*
  * Insert stores for `spills' (with spill space starting at `slots') into
  * `code' before code[j], corresponding to XLS logical position `pos'.
@@ -2480,6 +2527,8 @@ void insertSpillsAt(jit::vector<Vinstr>& code, unsigned& j,
   for (auto src : spills) {
     auto ivl = spills[src];
     if (!ivl) continue;
+    // The slot is never read if every reload re-executes the def.
+    if (rematerializable(ivl->var)) continue;
 
     auto slot = ivl->var->slot;
     assertx(slot >= 0 && src == ivl->reg);
@@ -2550,6 +2599,10 @@ void insertLoadsAt(jit::vector<Vinstr>& code, unsigned& j,
         not_reached();
       }());
     } else if (ivl->spilled()) {
+      if (auto remat = reexecutableDef(ivl->var, dst)) {
+        loads.push_back(std::move(*remat));
+        return;
+      }
       MemoryRef ptr{slots.r + slotOffset(ivl->var->slot)};
       if (!ivl->var->wide) {
         loads.emplace_back(load{ptr, dst});
@@ -14,19 +14,27 @@
    +----------------------------------------------------------------------+
 */
 
+#include "hphp/runtime/vm/litstr-table.h"
 #include "hphp/runtime/vm/unit.h"
 #include "hphp/runtime/vm/repo.h"
 
+#include "hphp/util/safe-cast.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace HPHP {
 
 LitstrRepoProxy::LitstrRepoProxy(Repo& repo)
     : RepoProxy(repo)
-    , m_insertLitstrLocal(repo, RepoIdLocal)
-    , m_insertLitstrCentral(repo, RepoIdCentral)
+    , m_insertLitstrsLocal(repo, RepoIdLocal)
+    , m_insertLitstrsCentral(repo, RepoIdCentral)
     , m_getLitstrsLocal(repo, RepoIdLocal)
     , m_getLitstrsCentral(repo, RepoIdCentral) {
-  m_insertLitstr[RepoIdLocal] = &m_insertLitstrLocal;
-  m_insertLitstr[RepoIdCentral] = &m_insertLitstrCentral;
+  m_insertLitstrs[RepoIdLocal] = &m_insertLitstrsLocal;
+  m_insertLitstrs[RepoIdCentral] = &m_insertLitstrsCentral;
   m_getLitstrs[RepoIdLocal] = &m_getLitstrsLocal;
   m_getLitstrs[RepoIdCentral] = &m_getLitstrsCentral;
 }
@@ -34,8 +42,7 @@ LitstrRepoProxy::LitstrRepoProxy(Repo& repo)
 void LitstrRepoProxy::createSchema(int repoId, RepoTxn& txn) {
   std::stringstream ssCreate;
   ssCreate << "CREATE TABLE " << m_repo.table(repoId, "Litstr")
-           << "(litstrId INTEGER, litstr TEXT,"
-              " PRIMARY KEY (litstrId));";
+           << "(count INTEGER, offsets BLOB, data BLOB);";
   txn.exec(ssCreate.str());
 }
 
@@ -51,18 +58,34 @@ void LitstrRepoProxy::load() {
   // No repos were loadable.  This is normal for non-repo-authoritative repos.
 }
 
-void LitstrRepoProxy::InsertLitstrStmt::insert(RepoTxn& txn,
-                                               Id litstrId,
-                                               const StringData* litstr) {
+void LitstrRepoProxy::InsertLitstrsStmt::insert(RepoTxn& txn,
+                                                LitstrTable& table) {
   if (!prepared()) {
     std::stringstream ssInsert;
     ssInsert << "INSERT INTO " << m_repo.table(m_repoId, "Litstr")
-             << " VALUES(@litstrId, @litstr);";
+             << " VALUES(@count, @offsets, @data);";
     txn.prepare(*this, ssInsert.str());
   }
+
+  // Lay every litstr's raw bytes out back to back, indexed by a vector of
+  // numLitstrs() + 1 offsets, so the runtime can load the whole section with
+  // a single query and intern strings lazily.
+  std::vector<uint32_t> offsets;
+  std::string data;
+  offsets.reserve(table.numLitstrs() + 1);
+  offsets.push_back(0);
+  table.forEachNamedEntity(
+    [&](int /*i*/, const NamedEntityPair& namedEntity) {
+      auto const sd = namedEntity.first;
+      data.append(sd->data(), sd->size());
+      offsets.push_back(safe_cast<uint32_t>(data.size()));
+    });
+
   RepoTxnQuery query(txn, *this);
-  query.bindInt64("@litstrId", litstrId);
-  query.bindStaticString("@litstr", litstr);
+  query.bindInt64("@count", table.numLitstrs());
+  query.bindBlob("@offsets", offsets.data(),
+                 offsets.size() * sizeof(uint32_t));
+  query.bindBlob("@data", data.data(), data.size());
   query.exec();
 }
 
@@ -71,22 +94,38 @@ RepoStatus LitstrRepoProxy::GetLitstrsStmt::get() {
     RepoTxn txn(m_repo);
     if (!prepared()) {
       std::stringstream ssSelect;
-      ssSelect << "SELECT litstrId,litstr FROM "
+      ssSelect << "SELECT count,offsets,data FROM "
                << m_repo.table(m_repoId, "Litstr");
       txn.prepare(*this, ssSelect.str());
     }
     RepoTxnQuery query(txn, *this);
-    NamedEntityPairTable namedInfo;
-    do {
-      query.step();
-      if (query.row()) {
-        StringData* litstr; /**/ query.getStaticString(1, litstr);
-        namedInfo.emplace_back(litstr, nullptr);
-      }
-    } while (!query.done());
-    namedInfo.shrink_to_fit();
-    LitstrTable::get().setNamedEntityPairTable(std::move(namedInfo));
+    query.step();
+    if (!query.row()) {
+      return RepoStatus::error;
+    }
+
+    int64_t count;
+    query.getInt64(0, count);
+
+    const void* offsetsBlob;
+    size_t offsetsSize;
+    query.getBlob(1, offsetsBlob, offsetsSize);
+    always_assert(offsetsSize == (count + 1) * sizeof(uint32_t));
+    auto const offsetsBegin = static_cast<const uint32_t*>(offsetsBlob);
+    std::vector<uint32_t> offsets(offsetsBegin, offsetsBegin + count + 1);
+
+    const void* dataBlob;
+    size_t dataSize;
+    query.getBlob(2, dataBlob, dataSize);
+    always_assert(dataSize == offsets.back());
+
+    // One contiguous copy of the raw bytes; individual strings are interned
+    // lazily, on first use, rather than up front.
+    auto data = std::make_unique<char[]>(dataSize);
+    memcpy(data.get(), dataBlob, dataSize);
     txn.commit();
+
+    LitstrTable::get().setLazyLitstrs(std::move(offsets), std::move(data));
   } catch (RepoExc& re) {
     return RepoStatus::error;
   }
@@ -24,16 +24,21 @@
 
 namespace HPHP {
 
+struct LitstrTable;
+
 struct LitstrRepoProxy : RepoProxy {
   explicit LitstrRepoProxy(Repo& repo);
   ~LitstrRepoProxy() {}
   void createSchema(int repoId, RepoTxn& txn); // throws(RepoExc)
   void load();
 
-  struct InsertLitstrStmt : RepoProxy::Stmt {
-    InsertLitstrStmt(Repo& repo, int repoId) : Stmt(repo, repoId) {}
-    void insert(RepoTxn& txn, Id litstrId, const StringData* litstr);
-    // throws(RepoExc)
+  struct InsertLitstrsStmt : RepoProxy::Stmt {
+    InsertLitstrsStmt(Repo& repo, int repoId) : Stmt(repo, repoId) {}
+    /*
+     * Write the whole litstr table as one flat section: the strings' raw
+     * bytes laid out back to back, plus an offset index.
+     */
+    void insert(RepoTxn& txn, LitstrTable& table); // throws(RepoExc)
   };
 
   struct GetLitstrsStmt : RepoProxy::Stmt {
@@ -42,13 +47,15 @@ struct LitstrRepoProxy : RepoProxy {
   };
 
 public:
-  InsertLitstrStmt& insertLitstr(int repoId) { return *m_insertLitstr[repoId]; }
+  InsertLitstrsStmt& insertLitstrs(int repoId) {
+    return *m_insertLitstrs[repoId];
+  }
   GetLitstrsStmt& getLitstrs(int repoId) { return *m_getLitstrs[repoId]; }
 
 private:
-  InsertLitstrStmt m_insertLitstrLocal;
-  InsertLitstrStmt m_insertLitstrCentral;
-  InsertLitstrStmt* m_insertLitstr[RepoIdCount];
+  InsertLitstrsStmt m_insertLitstrsLocal;
+  InsertLitstrsStmt m_insertLitstrsCentral;
+  InsertLitstrsStmt* m_insertLitstrs[RepoIdCount];
 
   GetLitstrsStmt m_getLitstrsLocal;
   GetLitstrsStmt m_getLitstrsCentral;
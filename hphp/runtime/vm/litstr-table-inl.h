@@ -47,17 +47,21 @@ inline bool LitstrTable::contains(Id id) const {
 
 inline StringData* LitstrTable::lookupLitstrId(Id id) const {
   assert(m_safeToRead);
-  return m_namedInfo.lookupLitstr(id);
+  if (auto const sd = m_namedInfo.lookupLitstr(id)) return sd;
+  // A null entry means the table was loaded lazily from the repo's flat
+  // litstr section and this string hasn't been interned yet.
+  return loadLitstrId(id);
 }
 
 inline const NamedEntity* LitstrTable::lookupNamedEntityId(Id id) const {
-  assert(m_safeToRead);
-  return m_namedInfo.lookupNamedEntity(id);
+  return lookupNamedEntityPairId(id).second;
 }
 
 inline
 const NamedEntityPair& LitstrTable::lookupNamedEntityPairId(Id id) const {
   assert(m_safeToRead);
+  // Materialize the litstr first; lookupNamedEntityPair() requires it.
+  lookupLitstrId(id);
   return m_namedInfo.lookupNamedEntityPair(id);
 }
 
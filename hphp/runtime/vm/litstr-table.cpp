@@ -16,6 +16,7 @@
 
 #include "hphp/runtime/vm/litstr-table.h"
 
+#include "hphp/runtime/base/static-string-table.h"
 #include "hphp/runtime/vm/unit.h"
 
 namespace HPHP {
@@ -44,6 +45,36 @@ Id LitstrTable::mergeLitstr(const StringData* litstr) {
   return id;
 }
 
+void LitstrTable::setLazyLitstrs(std::vector<uint32_t>&& offsets,
+                                 std::unique_ptr<char[]> data) {
+  assert(!offsets.empty());
+  m_lazyOffsets = std::move(offsets);
+  m_lazyData = std::move(data);
+
+  NamedEntityPairTable namedInfo;
+  namedInfo.resize(m_lazyOffsets.size() - 1);
+  // LowPtr's default constructor leaves its storage uninitialized, and both
+  // the lazy-intern check here and the lazy NamedEntity fill in
+  // NamedEntityPairTable key off null.
+  for (auto& nep : namedInfo) {
+    nep = NamedEntityPair { nullptr, nullptr };
+  }
+  m_namedInfo = std::move(namedInfo);
+}
+
+StringData* LitstrTable::loadLitstrId(Id id) const {
+  assert(m_lazyData);
+  assert(id >= 0 && id < Id(m_lazyOffsets.size()) - 1);
+  auto const begin = m_lazyOffsets[id];
+  auto const end   = m_lazyOffsets[id + 1];
+  auto const sd = makeStaticString(m_lazyData.get() + begin, end - begin);
+  // Concurrent lookups of the same id all intern the same static string, so
+  // the racy publish always stores the same value; this mirrors the lazy
+  // NamedEntity fill in NamedEntityPairTable.
+  const_cast<NamedEntityPair&>(m_namedInfo[id]).first = sd;
+  return sd;
+}
+
 void LitstrTable::forEachNamedEntity(
   std::function<void (int i, const NamedEntityPair& namedEntity)> onItem) {
   for (int i = 0; i < m_namedInfo.size(); ++i) {
@@ -23,6 +23,7 @@
 #include "hphp/util/hash-map-typedefs.h"
 #include "hphp/util/mutex.h"
 
+#include <memory>
 #include <vector>
 #include <tbb/concurrent_unordered_map.h>
 
@@ -94,6 +95,15 @@ struct LitstrTable {
    */
   void setNamedEntityPairTable(NamedEntityPairTable&& namedInfo);
 
+  /*
+   * Install the flat litstr section loaded from the repo: the raw bytes of
+   * every litstr laid out back to back, plus an index of numLitstrs() + 1
+   * offsets into it.  Individual strings are interned lazily, on first
+   * lookup.  Not thread-safe; called once at startup, before setReading().
+   */
+  void setLazyLitstrs(std::vector<uint32_t>&& offsets,
+                      std::unique_ptr<char[]> data);
+
   /*
    * Add an entry for `litstr' to the table.
    *
@@ -134,6 +144,12 @@ struct LitstrTable {
 private:
   LitstrTable() {}
 
+  /*
+   * Intern the litstr given by `id' from the flat section and publish it in
+   * m_namedInfo.
+   */
+  StringData* loadLitstrId(Id id) const;
+
 
   /////////////////////////////////////////////////////////////////////////////
   // Data members.
@@ -151,6 +167,9 @@ private:
   NamedEntityPairTable m_namedInfo;
   LitstrMap m_litstr2id;
 
+  std::unique_ptr<char[]> m_lazyData;
+  std::vector<uint32_t> m_lazyOffsets;
+
   Mutex m_mutex;
   std::atomic<bool> m_safeToRead;
 };
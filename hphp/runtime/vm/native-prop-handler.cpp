@@ -66,6 +66,11 @@ bool PropAccessorMap::isPropSupported(const String& name) {
   return lookupProp(name) != end();
 }
 
+const PropAccessor* PropAccessorMap::lookup(const String& name) {
+  auto it = lookupProp(name);
+  return it != end() ? *it : nullptr;
+}
+
 Variant (*PropAccessorMap::get(const String& name))(const Object& this_) {
   return (*lookupProp(name))->get;
 }
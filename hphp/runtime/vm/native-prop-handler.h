@@ -78,11 +78,14 @@ void registerNativePropHandler(const String& className,
     return Native::prop_not_handled();                                         \
   }
 
-// Default getProp.
+// Default getProp.  Handlers that resolve the property themselves (see
+// `resolvesProps') skip the separate isPropSupported probe.
 
 template<class T>
 Variant nativePropHandlerGet(const Object& obj, const String& name) {
-  CHECK_NATIVE_PROP_SUPPORTED(name, "get")
+  if (!T::resolvesProps) {
+    CHECK_NATIVE_PROP_SUPPORTED(name, "get")
+  }
   return T::getProp(obj, name);
 }
 
@@ -92,7 +95,9 @@ template<class T>
 Variant nativePropHandlerSet(const Object& obj,
                              const String& name,
                              const Variant& value) {
-  CHECK_NATIVE_PROP_SUPPORTED(name, "set")
+  if (!T::resolvesProps) {
+    CHECK_NATIVE_PROP_SUPPORTED(name, "set")
+  }
   return T::setProp(obj, name, value);
 }
 
@@ -100,7 +105,9 @@ Variant nativePropHandlerSet(const Object& obj,
 
 template<class T>
 Variant nativePropHandlerIsset(const Object& obj, const String& name) {
-  CHECK_NATIVE_PROP_SUPPORTED(name, "isset")
+  if (!T::resolvesProps) {
+    CHECK_NATIVE_PROP_SUPPORTED(name, "isset")
+  }
   return T::issetProp(obj, name);
 }
 
@@ -108,7 +115,9 @@ Variant nativePropHandlerIsset(const Object& obj, const String& name) {
 
 template<class T>
 Variant nativePropHandlerUnset(const Object& obj, const String& name) {
-  CHECK_NATIVE_PROP_SUPPORTED(name, "unset")
+  if (!T::resolvesProps) {
+    CHECK_NATIVE_PROP_SUPPORTED(name, "unset")
+  }
   return T::unsetProp(obj, name);
 }
 
@@ -133,6 +142,13 @@ void registerNativePropHandler(const String& className) {
  * child classes.
  */
 struct BasePropHandler {
+  /*
+   * Handlers that return `prop_not_handled' from their accessors when the
+   * property is unknown may set this to true; the nativePropHandler*
+   * wrappers then skip the redundant isPropSupported probe per access.
+   */
+  static constexpr bool resolvesProps = false;
+
   static Variant getProp(const Object& /*this_*/, const String& /*name*/) {
     return Native::prop_not_handled();
   }
@@ -164,37 +180,44 @@ struct BasePropHandler {
 template <class Derived>
 struct MapPropHandler : BasePropHandler {
 
+  // Each accessor resolves the property with a single probe of the map and
+  // dispatches through the accessor table entry.
+  static constexpr bool resolvesProps = true;
+
   static Variant getProp(const Object& this_, const String& name) {
-    auto get = Derived::map.get(name);
-    CHECK_ACCESSOR(get, "get", this_->getVMClass()->name(), name)
-    return get(this_);
+    auto const pa = Derived::map.lookup(name);
+    if (!pa) return Native::prop_not_handled();
+    CHECK_ACCESSOR(pa->get, "get", this_->getVMClass()->name(), name)
+    return pa->get(this_);
   }
 
   static Variant setProp(const Object& this_,
                          const String& name,
                          const Variant& value) {
-    auto set = Derived::map.set(name);
-    CHECK_ACCESSOR(set, "set", this_->getVMClass()->name(), name);
-    set(this_, value);
+    auto const pa = Derived::map.lookup(name);
+    if (!pa) return Native::prop_not_handled();
+    CHECK_ACCESSOR(pa->set, "set", this_->getVMClass()->name(), name);
+    pa->set(this_, value);
     return true;
   }
 
   static Variant issetProp(const Object& this_, const String& name) {
-    auto isset = Derived::map.isset(name);
+    auto const pa = Derived::map.lookup(name);
+    if (!pa) return Native::prop_not_handled();
     // If there is special `isset`, call it.
-    if (isset) {
-      return isset(this_);
+    if (pa->isset) {
+      return pa->isset(this_);
     }
     // Otherwise, fallback to `null` check of the result from `get`.
-    auto get = Derived::map.get(name);
-    CHECK_ACCESSOR(get, "get", this_->getVMClass()->name(), name)
-    return !get(this_).isNull();
+    CHECK_ACCESSOR(pa->get, "get", this_->getVMClass()->name(), name)
+    return !pa->get(this_).isNull();
   }
 
   static Variant unsetProp(const Object& this_, const String& name) {
-    auto unset = Derived::map.unset(name);
-    CHECK_ACCESSOR(unset, "unset", this_->getVMClass()->name(), name);
-    unset(this_);
+    auto const pa = Derived::map.lookup(name);
+    if (!pa) return Native::prop_not_handled();
+    CHECK_ACCESSOR(pa->unset, "unset", this_->getVMClass()->name(), name);
+    pa->unset(this_);
     return true;
   }
 
@@ -245,6 +268,12 @@ struct PropAccessorMap :
 
   bool isPropSupported(const String& name);
 
+  /*
+   * Resolve a property with a single probe; returns nullptr when the
+   * property has no accessors.
+   */
+  const PropAccessor* lookup(const String& name);
+
   Variant (*get(const String& name))(const Object& this_);
 
   void    (*set(const String& name))(const Object& this_,
@@ -42,7 +42,9 @@ struct Repo::GlobalData {
   bool EnableHipHopSyntax = false;
 
   /*
-   * Copy of InitialNamedEntityTableSize for hhbbc to use.
+   * Size of the program's symbol universe, counted by hhbbc.  The runtime
+   * uses it to pre-size the NamedEntity table so the table never has to
+   * grow while serving requests.
    */
   uint32_t InitialNamedEntityTableSize = 0;
 
@@ -16,11 +16,15 @@
 #include "hphp/runtime/vm/repo.h"
 
 #include <folly/Format.h>
+#include <folly/ScopeGuard.h>
 #include <folly/Singleton.h>
+#include <folly/String.h>
 
 #include "hphp/hhbbc/options.h"
+#include "hphp/runtime/base/program-functions.h"
 #include "hphp/runtime/vm/blob-helper.h"
 #include "hphp/runtime/vm/repo-global-data.h"
+#include "hphp/runtime/vm/shm-unit-cache.h"
 #include "hphp/runtime/server/xbox-server.h"
 
 #include "hphp/util/assertions.h"
@@ -31,8 +35,16 @@
 #include "hphp/util/process.h"
 #include "hphp/util/trace.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <fcntl.h>
 #include <grp.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 namespace HPHP {
@@ -139,6 +151,10 @@ void Repo::loadGlobalData(bool allowFailure /* = false */) {
 
   if (!RuntimeOption::RepoAuthoritative) return;
 
+  if (!RuntimeOption::RepoFlatPath.empty()) {
+    loadFlatUnitFile(RuntimeOption::RepoFlatPath);
+  }
+
   std::vector<std::string> failures;
 
   /*
@@ -196,6 +212,15 @@ void Repo::loadGlobalData(bool allowFailure /* = false */) {
     HHBBC::options.ElideAutoloadInvokes   = s_globalData.ElideAutoloadInvokes;
     RuntimeOption::EvalPromoteEmptyObject = s_globalData.PromoteEmptyObject;
 
+    if (s_globalData.InitialNamedEntityTableSize) {
+      // The symbol universe is closed in RepoAuthoritative mode, and hhbbc
+      // recorded its size.  Pre-sizing the NamedEntity table to it means
+      // lookups never pay for AtomicHashMap submap growth at runtime.
+      RuntimeOption::EvalInitialNamedEntityTableSize =
+        std::max(RuntimeOption::EvalInitialNamedEntityTableSize,
+                 s_globalData.InitialNamedEntityTableSize);
+    }
+
     if (HHBBC::options.HardReturnTypeHints) {
       RuntimeOption::EvalCheckReturnTypeHints = 3;
     }
@@ -249,20 +274,172 @@ void Repo::saveGlobalData(GlobalData newData) {
   query.bindBlob("@data", encoder, /* static */ true);
   query.exec();
 
-  // TODO(#3521039): we could just put the litstr table in the same
-  // blob as the above and delete LitstrRepoProxy.
-  LitstrTable::get().forEachNamedEntity(
-    [this, &txn, repoId](int i, const NamedEntityPair& namedEntity) {
-      lsrp().insertLitstr(repoId).insert(txn, i, namedEntity.first);
-    });
+  lsrp().insertLitstrs(repoId).insert(txn, LitstrTable::get());
 
   txn.commit();
 }
 
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Flat unit files.
+ *
+ * Layout: a FlatUnitHeader, then each unit's serialized blob (see
+ * UnitEmitter::serializeFlat), then an index of FlatUnitIndexEntry sorted
+ * by md5 so lookups can binary search.  The file is mapped read-only once
+ * at process initialization and never unmapped; pages of units that are
+ * never requested stay untouched.
+ */
+
+namespace {
+
+struct FlatUnitHeader {
+  char magic[8];
+  uint64_t version;
+  char schema[40];
+  uint64_t indexOff;
+  uint64_t unitCount;
+};
+
+struct FlatUnitIndexEntry {
+  MD5 md5;
+  uint64_t offset;
+  uint64_t size;
+};
+
+const char kFlatUnitMagic[8] = { 'H', 'H', 'B', 'C', 'F', 'L', 'A', 'T' };
+constexpr uint64_t kFlatUnitVersion = 1;
+
+const char* s_flatUnitBase = nullptr;
+const FlatUnitIndexEntry* s_flatUnitIndex = nullptr;
+uint64_t s_flatUnitCount = 0;
+
+std::unique_ptr<Unit> loadFlatUnit(const std::string& name, const MD5& md5) {
+  if (!s_flatUnitIndex) return nullptr;
+  auto const begin = s_flatUnitIndex;
+  auto const end = begin + s_flatUnitCount;
+  auto const it = std::lower_bound(
+    begin, end, md5,
+    [] (const FlatUnitIndexEntry& e, const MD5& m) { return e.md5 < m; }
+  );
+  if (it == end || !(it->md5 == md5)) return nullptr;
+
+  auto ue = std::make_unique<UnitEmitter>(md5);
+  BlobDecoder blob(s_flatUnitBase + it->offset, it->size);
+  ue->deserializeFlat(name, blob);
+  TRACE(3, "Flat unit file hit for '%s'\n", name.c_str());
+  return ue->create();
+}
+
+}
+
+bool Repo::loadFlatUnitFile(const std::string& path) {
+  auto const fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  SCOPE_EXIT { close(fd); };
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 || size_t(sb.st_size) < sizeof(FlatUnitHeader)) {
+    Logger::Warning("Ignoring truncated flat unit file %s", path.c_str());
+    return false;
+  }
+  auto const base = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    Logger::Warning("Failed to mmap flat unit file %s: %s",
+                    path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+
+  auto const header = static_cast<const FlatUnitHeader*>(base);
+  auto const schema = repoSchemaId();
+  if (memcmp(header->magic, kFlatUnitMagic, sizeof kFlatUnitMagic) != 0 ||
+      header->version != kFlatUnitVersion ||
+      schema.size() > sizeof header->schema ||
+      memcmp(header->schema, schema.data(), schema.size()) != 0 ||
+      header->indexOff + header->unitCount * sizeof(FlatUnitIndexEntry) >
+        size_t(sb.st_size)) {
+    Logger::Warning("Ignoring flat unit file %s: "
+                    "unrecognized header or repo schema mismatch",
+                    path.c_str());
+    munmap(base, sb.st_size);
+    return false;
+  }
+
+  s_flatUnitBase = static_cast<const char*>(base);
+  s_flatUnitIndex = reinterpret_cast<const FlatUnitIndexEntry*>(
+    s_flatUnitBase + header->indexOff);
+  s_flatUnitCount = header->unitCount;
+  Logger::Info("Mapped flat unit file %s (%lu units)",
+               path.c_str(), (unsigned long)s_flatUnitCount);
+  return true;
+}
+
+bool Repo::exportFlatUnits(const std::string& path) {
+  auto const units = enumerateUnits(RepoIdCentral, false, true);
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    Logger::Error("Failed to open flat unit file %s for writing",
+                  path.c_str());
+    return false;
+  }
+
+  FlatUnitHeader header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, kFlatUnitMagic, sizeof kFlatUnitMagic);
+  header.version = kFlatUnitVersion;
+  auto const schema = repoSchemaId();
+  always_assert(schema.size() <= sizeof header.schema);
+  memcpy(header.schema, schema.data(), schema.size());
+  // Rewritten below once the index offset is known.
+  out.write(reinterpret_cast<const char*>(&header), sizeof header);
+
+  std::vector<FlatUnitIndexEntry> index;
+  index.reserve(units.size());
+  uint64_t offset = sizeof header;
+  for (auto const& kv : units) {
+    auto const ue = urp().loadEmitter(kv.first, kv.second);
+    if (!ue) continue;
+    BlobEncoder blob;
+    ue->serializeFlat(blob);
+    out.write(static_cast<const char*>(blob.data()), blob.size());
+    index.push_back(FlatUnitIndexEntry { kv.second, offset, blob.size() });
+    offset += blob.size();
+  }
+
+  std::sort(index.begin(), index.end(),
+            [] (const FlatUnitIndexEntry& a, const FlatUnitIndexEntry& b) {
+              return a.md5 < b.md5;
+            });
+  if (!index.empty()) {
+    out.write(reinterpret_cast<const char*>(&index[0]),
+              index.size() * sizeof(FlatUnitIndexEntry));
+  }
+  header.indexOff = offset;
+  header.unitCount = index.size();
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof header);
+  out.flush();
+  if (!out.good()) {
+    Logger::Error("Failed writing flat unit file %s", path.c_str());
+    return false;
+  }
+  Logger::Info("Wrote %lu units to flat unit file %s",
+               (unsigned long)index.size(), path.c_str());
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 std::unique_ptr<Unit> Repo::loadUnit(const std::string& name, const MD5& md5) {
   if (m_dbc == nullptr) {
     return nullptr;
   }
+  if (auto unit = loadFlatUnit(name, md5)) {
+    return unit;
+  }
+  if (auto unit = ShmUnitCache::load(name, md5)) {
+    return unit;
+  }
   return m_urp.load(name, md5);
 }
 
@@ -513,6 +690,10 @@ RepoStatus Repo::insertUnit(UnitEmitter* ue, UnitOrigin unitOrigin,
 }
 
 void Repo::commitUnit(UnitEmitter* ue, UnitOrigin unitOrigin) {
+  // Publish to the host-wide shared cache regardless of Repo.Commit;
+  // the two stores are gated independently.
+  ShmUnitCache::store(*ue);
+
   if (!RuntimeOption::RepoCommit) return;
 
   try {
@@ -1068,6 +1249,37 @@ bool Repo::writable(int repoId) {
 void batchCommit(std::vector<std::unique_ptr<UnitEmitter>> ues) {
   auto& repo = Repo::get();
 
+  /*
+   * The line table and scalar array literals each unit commits are
+   * serialized from plain data, independent of the repo connection, so run
+   * that for all units in parallel before taking the write transaction;
+   * the single-writer SQLite phase is then mostly statement execution.
+   * Insertion order below is unchanged, so the resulting repo is identical
+   * to a serial commit.
+   */
+  auto const nThreads = std::min<size_t>(ues.size(), Process::GetCPUCount());
+  if (nThreads > 1) {
+    std::atomic<size_t> index{0};
+    std::vector<std::thread> workers;
+    for (auto t = size_t{0}; t < nThreads; ++t) {
+      workers.emplace_back([&] {
+        hphp_thread_init();
+        hphp_session_init();
+        SCOPE_EXIT {
+          hphp_context_exit();
+          hphp_session_exit();
+          hphp_thread_exit();
+        };
+        for (;;) {
+          auto const i = index.fetch_add(1, std::memory_order_relaxed);
+          if (i >= ues.size()) break;
+          ues[i]->prepareCommit();
+        }
+      });
+    }
+    for (auto& worker : workers) worker.join();
+  }
+
   // Attempt batch commit.  This can legitimately fail due to multiple input
   // files having identical contents.
   bool err = false;
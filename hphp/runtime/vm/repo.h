@@ -112,6 +112,20 @@ struct Repo : RepoProxy {
   std::vector<std::pair<std::string,MD5>> enumerateUnits(
     int repoId, bool preloadOnly, bool warn);
 
+  /*
+   * Flat unit files: a single mmap-able file holding every unit in a repo
+   * as one serialized blob apiece, plus an md5-keyed offset index.  Units
+   * found in a mapped flat file are created straight from the mapped bytes,
+   * skipping the per-unit SQLite queries loadUnit() would otherwise issue.
+   *
+   * exportFlatUnits() writes such a file from the central repo's contents.
+   * loadFlatUnitFile() maps an existing file for use by subsequent
+   * loadUnit() calls; the mapping is process-wide and is set up once during
+   * process initialization (see loadGlobalData()).
+   */
+  bool exportFlatUnits(const std::string& path);
+  static bool loadFlatUnitFile(const std::string& path);
+
   /*
    * Load the repo-global metadata table, including the global litstr
    * table.  Normally called during process initialization.
@@ -0,0 +1,254 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/runtime/vm/shm-unit-cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <folly/Bits.h>
+#include <folly/Format.h>
+#include <folly/ScopeGuard.h>
+#include <folly/String.h>
+
+#include "hphp/runtime/base/runtime-option.h"
+#include "hphp/runtime/vm/blob-helper.h"
+#include "hphp/runtime/vm/unit-emitter.h"
+#include "hphp/util/build-info.h"
+#include "hphp/util/logger.h"
+#include "hphp/util/trace.h"
+
+namespace HPHP {
+
+TRACE_SET_MOD(hhbc);
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/*
+ * File layout: one Header at offset zero, then the slot table, then
+ * the blob arena.  The creating process initializes the header under
+ * flock(); every later process validates it under the same lock before
+ * first use, so nothing past initialization needs the lock.
+ */
+struct Header {
+  char magic[8];
+  uint64_t version;
+  char schema[40];
+  uint64_t fileSize;
+  uint64_t slotCount;
+  uint64_t arenaOff;
+  std::atomic<uint64_t> arenaUsed;
+};
+
+/*
+ * Slot lifecycle: kEmpty -> kWriting (claimed by CAS) -> kReady.  The
+ * md5/offset/size fields are immutable once the state is kReady.  A
+ * published slot never returns to kEmpty, so a reader that probes onto
+ * an empty slot can stop: its key was never inserted.  A slot claimed
+ * for a blob that no longer fits in the arena stays in kWriting; that
+ * only happens once the cache is full, at which point it stops
+ * accepting new units anyway.
+ */
+enum SlotState : uint32_t { kEmpty = 0, kWriting = 1, kReady = 2 };
+
+struct Slot {
+  std::atomic<uint32_t> state;
+  uint32_t size;
+  uint64_t offset;
+  MD5 md5;
+};
+
+const char kMagic[8] = { 'H', 'H', 'B', 'C', 'S', 'H', 'M', 'U' };
+constexpr uint64_t kVersion = 1;
+constexpr unsigned kProbeLimit = 16;
+
+char* s_base = nullptr;
+Header* s_header = nullptr;
+Slot* s_slots = nullptr;
+
+bool initialize() {
+  auto const bytes = uint64_t(RuntimeOption::RepoShmBytes);
+  auto const schema = repoSchemaId();
+  auto const slotCount =
+    folly::nextPowTwo(std::max<uint64_t>(bytes / 65536, 1024));
+  auto const arenaOff =
+    (sizeof(Header) + slotCount * sizeof(Slot) + 15) & ~uint64_t{15};
+  if (arenaOff >= bytes) {
+    Logger::Warning("Repo.Shm.Bytes=%llu is too small; "
+                    "disabling the shared unit cache",
+                    (unsigned long long)bytes);
+    return false;
+  }
+
+  // Embed the schema id in the name so hhvm builds with incompatible
+  // bytecode formats never share a mapping.
+  auto const path =
+    folly::sformat("{}.{}", RuntimeOption::RepoShmPath, schema);
+
+  auto const fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+  if (fd < 0) {
+    Logger::Warning("Failed to open shared unit cache %s: %s",
+                    path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+  SCOPE_EXIT { close(fd); };
+  if (flock(fd, LOCK_EX) != 0) {
+    Logger::Warning("Failed to lock shared unit cache %s: %s",
+                    path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+  SCOPE_EXIT { flock(fd, LOCK_UN); };
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0) {
+    Logger::Warning("Failed to stat shared unit cache %s: %s",
+                    path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+  auto const fresh = sb.st_size == 0;
+  if (fresh) {
+    if (ftruncate(fd, bytes) != 0) {
+      Logger::Warning("Failed to size shared unit cache %s: %s",
+                      path.c_str(), folly::errnoStr(errno).c_str());
+      return false;
+    }
+  } else if (uint64_t(sb.st_size) != bytes) {
+    Logger::Warning("Ignoring shared unit cache %s: size %llu does not "
+                    "match Repo.Shm.Bytes",
+                    path.c_str(), (unsigned long long)sb.st_size);
+    return false;
+  }
+
+  auto const base =
+    mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    Logger::Warning("Failed to mmap shared unit cache %s: %s",
+                    path.c_str(), folly::errnoStr(errno).c_str());
+    return false;
+  }
+
+  auto const header = static_cast<Header*>(base);
+  if (fresh) {
+    // The file is zero-filled, which is the empty state for the slot
+    // table and arena; only the header needs real values.  No other
+    // process can get past the flock() until we are done, so ordinary
+    // stores suffice here.
+    memcpy(header->magic, kMagic, sizeof kMagic);
+    header->version = kVersion;
+    always_assert(schema.size() <= sizeof header->schema);
+    memcpy(header->schema, schema.data(), schema.size());
+    header->fileSize = bytes;
+    header->slotCount = slotCount;
+    header->arenaOff = arenaOff;
+    header->arenaUsed.store(0, std::memory_order_relaxed);
+    Logger::Info("Created shared unit cache %s (%llu bytes)",
+                 path.c_str(), (unsigned long long)bytes);
+  } else if (memcmp(header->magic, kMagic, sizeof kMagic) != 0 ||
+             header->version != kVersion ||
+             schema.size() > sizeof header->schema ||
+             memcmp(header->schema, schema.data(), schema.size()) != 0 ||
+             header->fileSize != bytes ||
+             header->slotCount != slotCount ||
+             header->arenaOff != arenaOff) {
+    Logger::Warning("Ignoring shared unit cache %s: unrecognized header",
+                    path.c_str());
+    munmap(base, bytes);
+    return false;
+  }
+
+  s_base = static_cast<char*>(base);
+  s_header = header;
+  s_slots = reinterpret_cast<Slot*>(s_base + sizeof(Header));
+  return true;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool ShmUnitCache::enabled() {
+  static bool const ready =
+    RuntimeOption::RepoShmBytes > 0 && initialize();
+  return ready;
+}
+
+std::unique_ptr<Unit> ShmUnitCache::load(const std::string& name,
+                                         const MD5& md5) {
+  if (!enabled()) return nullptr;
+
+  auto const mask = s_header->slotCount - 1;
+  for (unsigned i = 0; i < kProbeLimit; ++i) {
+    auto const& slot = s_slots[(md5.hash() + i) & mask];
+    auto const state = slot.state.load(std::memory_order_acquire);
+    if (state == kEmpty) return nullptr;
+    if (state != kReady || !(slot.md5 == md5)) continue;
+    if (slot.offset + slot.size > s_header->fileSize) return nullptr;
+
+    auto ue = std::make_unique<UnitEmitter>(md5);
+    BlobDecoder blob(s_base + slot.offset, slot.size);
+    ue->deserializeFlat(name, blob);
+    TRACE(3, "Shared unit cache hit for '%s'\n", name.c_str());
+    return ue->create();
+  }
+  return nullptr;
+}
+
+void ShmUnitCache::store(UnitEmitter& ue) {
+  if (!enabled()) return;
+
+  BlobEncoder blob;
+  ue.serializeFlat(blob);
+  if (blob.size() > std::numeric_limits<uint32_t>::max()) return;
+
+  auto const& md5 = ue.md5();
+  auto const mask = s_header->slotCount - 1;
+  auto const capacity = s_header->fileSize - s_header->arenaOff;
+
+  for (unsigned i = 0; i < kProbeLimit; ++i) {
+    auto& slot = s_slots[(md5.hash() + i) & mask];
+    auto state = slot.state.load(std::memory_order_acquire);
+    if (state == kEmpty &&
+        slot.state.compare_exchange_strong(state, kWriting,
+                                           std::memory_order_acq_rel)) {
+      auto const need = (blob.size() + 15) & ~size_t{15};
+      auto const off =
+        s_header->arenaUsed.fetch_add(need, std::memory_order_relaxed);
+      if (off + need > capacity) return;  // arena exhausted; see SlotState
+
+      memcpy(s_base + s_header->arenaOff + off, blob.data(), blob.size());
+      slot.offset = s_header->arenaOff + off;
+      slot.size = blob.size();
+      slot.md5 = md5;
+      slot.state.store(kReady, std::memory_order_release);
+      return;
+    }
+    if (state == kReady && slot.md5 == md5) return;  // someone beat us to it
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,79 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_VM_SHM_UNIT_CACHE_H_
+#define incl_HPHP_VM_SHM_UNIT_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "hphp/util/md5.h"
+
+namespace HPHP {
+
+struct Unit;
+struct UnitEmitter;
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Host-wide shared-memory cache of compiled units.
+ *
+ * Sandbox and CLI tiers run many hhvm processes side by side, each of
+ * which would otherwise compile and cache the same files privately.
+ * When Repo.Shm.Bytes is set, freshly compiled units are serialized
+ * (UnitEmitter::serializeFlat) into a fixed-size shared mapping keyed
+ * by content md5, and Repo::loadUnit() consults the mapping before
+ * querying SQLite, so each unique file body is compiled at most once
+ * per host and the serialized form is shared by every process through
+ * the page cache.
+ *
+ * The mapping is a plain file (Repo.Shm.Path, under /dev/shm by
+ * default) with the repo schema id appended to its name, so hhvm
+ * builds with incompatible bytecode formats never share a cache.  The
+ * index is a fixed open-addressed table and the payload arena is
+ * append-only; when either fills up the cache simply stops accepting
+ * new units until the file is removed.  The hot paths take no
+ * cross-process lock: slots are claimed and published with atomic
+ * state transitions, and the creating process initializes the header
+ * under flock() before any other process can get past its own
+ * initialization.
+ */
+struct ShmUnitCache {
+  /*
+   * True if Repo.Shm.Bytes is set and the mapping was set up
+   * successfully.  The first call does the setup.
+   */
+  static bool enabled();
+
+  /*
+   * Look up a unit by content md5.  `name' becomes the unit's filepath,
+   * as in Repo::loadUnit().  Returns nullptr on miss.
+   */
+  static std::unique_ptr<Unit> load(const std::string& name, const MD5& md5);
+
+  /*
+   * Publish a freshly compiled unit.  Best effort: quietly does nothing
+   * if the cache is disabled or full, or the unit is already present.
+   */
+  static void store(UnitEmitter& ue);
+};
+
+//////////////////////////////////////////////////////////////////////
+
+}
+
+#endif
@@ -18,6 +18,8 @@
 
 #include <list>
 #include <atomic>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -30,6 +32,7 @@
 #include <folly/portability/SysTime.h>
 
 #include "hphp/runtime/base/runtime-option.h"
+#include "hphp/util/atomic-vector.h"
 #include "hphp/util/logger.h"
 #include "hphp/util/process.h"
 #include "hphp/util/trace.h"
@@ -57,25 +60,47 @@ namespace {
 
 const int64_t ONE_SEC_IN_MICROSEC = 1000000;
 
-struct RequestInfo {
-  GenCount  startTime;
-  pthread_t pthreadId;
-};
-
+/*
+ * s_genLock only covers the pending work queues; requests publish their
+ * start times without taking it.  Each thread owns the slot at its
+ * threadIdx() in s_inflightRequests and stores its current start time
+ * there (kIdleGenCount when it isn't processing a request), so computing
+ * the oldest request in flight is a lock-free scan over the slots.
+ */
 pthread_mutex_t s_genLock = PTHREAD_MUTEX_INITIALIZER;
 const GenCount kIdleGenCount = 0; // not processing any requests.
-std::vector<RequestInfo> s_inflightRequests;
-GenCount s_latestCount = 0;
+AtomicVector<GenCount> s_inflightRequests{1024, kIdleGenCount};
+std::atomic<GenCount> s_latestCount{0};
 std::atomic<GenCount> s_oldestRequestInFlight(0);
 
+/*
+ * The pthreadId for each thread index, so checkOldest() can signal the
+ * thread running the oldest request.  Written at most once per thread,
+ * and only read on the rare abort-the-server path, so a plain mutex is
+ * fine here.
+ */
+std::mutex s_threadIdsLock;
+std::vector<pthread_t> s_threadIds;
+__thread bool tl_threadIdRecorded{false};
+
+void recordThreadId(int64_t threadIdx) {
+  if (tl_threadIdRecorded) return;
+  std::lock_guard<std::mutex> g(s_threadIdsLock);
+  if (threadIdx >= static_cast<int64_t>(s_threadIds.size())) {
+    s_threadIds.resize(threadIdx + 1, pthread_t{});
+  }
+  s_threadIds[threadIdx] = Process::GetThreadId();
+  tl_threadIdRecorded = true;
+}
+
 //////////////////////////////////////////////////////////////////////
 
 /*
  * The next 2 functions should be used to manage the generation count/time
  * in the treadmill for both the requests and the work items.
- * The pattern is to call getTime() outside of the lock and correctTime()
- * while holding the lock.
- * That pattern guarantees a monotonically increasing counter.
+ * getTime() reads the clock; correctTime() folds the result into a
+ * compare-exchange on the last recorded count, so the counter is
+ * monotonically increasing no matter how calls interleave.
  * The resolution being microseconds should give us all the room we need
  * to accommodate requests and work items at any conceivable rate and
  * correctTime() should give us correct behavior at any granularity of
@@ -84,7 +109,6 @@ std::atomic<GenCount> s_oldestRequestInFlight(0);
 
 /*
  * Return the current time in microseconds.
- * Usually called outside of the lock.
  */
 GenCount getTime() {
   struct timeval time;
@@ -94,11 +118,15 @@ GenCount getTime() {
 
 /*
  * Return a monotonically increasing time given the last time recorded.
- * This must be called while holding the lock.
  */
 GenCount correctTime(GenCount time) {
-  s_latestCount = time <= s_latestCount ? s_latestCount + 1 : time;
-  return s_latestCount;
+  auto prev = s_latestCount.load(std::memory_order_relaxed);
+  GenCount next;
+  do {
+    next = time <= prev ? prev + 1 : time;
+  } while (!s_latestCount.compare_exchange_weak(prev, next,
+                                                std::memory_order_relaxed));
+  return next;
 }
 
 struct GenCountGuard {
@@ -113,16 +141,30 @@ struct GenCountGuard {
   }
 };
 
-//////////////////////////////////////////////////////////////////////
-
-pthread_t getOldestRequestThreadId() {
-  int64_t oldestStart = s_oldestRequestInFlight.load(std::memory_order_relaxed);
-  for (auto& req : s_inflightRequests) {
-    if (req.startTime == oldestStart) return req.pthreadId;
+/*
+ * Scan the inflight table for the oldest active request.  Returns
+ * kIdleGenCount if no requests are running.
+ *
+ * The loads are sequentially consistent, matching the stores in
+ * startRequest()/finishRequest(): finishRequest() relies on the total
+ * order to hand drain responsibility off without losing it (see the
+ * rescan loop there).
+ */
+GenCount oldestInflightStart() {
+  GenCount oldest = kIdleGenCount;
+  auto const size = s_inflightRequests.size();
+  for (auto i = size_t{0}; i < size; ++i) {
+    auto const start = s_inflightRequests[i].load();
+    if (start != kIdleGenCount &&
+        (oldest == kIdleGenCount || start < oldest)) {
+      oldest = start;
+    }
   }
-  not_reached();
+  return oldest;
 }
 
+//////////////////////////////////////////////////////////////////////
+
 void checkOldest() {
   int64_t limit =
     RuntimeOption::MaxRequestAgeFactor * RuntimeOption::RequestTimeoutSeconds;
@@ -130,11 +172,25 @@ void checkOldest() {
 
   int64_t ageOldest = getAgeOldestRequest();
   if (ageOldest > limit) {
-    auto msg = folly::format("Oldest request has been running for {} "
-                             "seconds. Aborting the server.", ageOldest).str();
-    Logger::Error(msg);
-    pthread_t oldestTid = getOldestRequestThreadId();
-    pthread_kill(oldestTid, SIGABRT);
+    auto const oldestStart =
+      s_oldestRequestInFlight.load(std::memory_order_relaxed);
+    auto const size = s_inflightRequests.size();
+    for (auto i = size_t{0}; i < size; ++i) {
+      if (s_inflightRequests[i].load() != oldestStart) continue;
+      auto msg = folly::format("Oldest request has been running for {} "
+                               "seconds. Aborting the server.",
+                               ageOldest).str();
+      Logger::Error(msg);
+      pthread_t oldestTid;
+      {
+        std::lock_guard<std::mutex> g(s_threadIdsLock);
+        oldestTid = s_threadIds[i];
+      }
+      pthread_kill(oldestTid, SIGABRT);
+      return;
+    }
+    // The offending request finished while we were looking at it;
+    // nothing to abort.
   }
 }
 
@@ -153,8 +209,17 @@ struct PendingTriggers : std::list<std::unique_ptr<WorkItem>> {
   static bool s_destroyed;
 };
 
+// Deferred frees are segregated from general WorkItems: they're nothing
+// but a free() call each, so a drain can knock them all out up front
+// instead of interleaving them behind arbitrarily expensive items (Class
+// destruction and the like), and enqueueing one doesn't have to allocate
+// a WorkItem.  Declared before s_tq so it outlives it; deferredFree()
+// checks s_destroyed like enqueueInternal() does.
+static std::list<std::pair<GenCount, void*>> s_fq;
+
 static PendingTriggers s_tq;
 bool PendingTriggers::s_destroyed = false;
+
 void enqueueInternal(std::unique_ptr<WorkItem> gt) {
   if (PendingTriggers::s_destroyed) {
     return;
@@ -170,67 +235,80 @@ void enqueueInternal(std::unique_ptr<WorkItem> gt) {
 void startRequest() {
   auto const threadIdx = Treadmill::threadIdx();
 
-  GenCount startTime = getTime();
-  {
-    GenCountGuard g;
-    refreshStats();
-    checkOldest();
-    if (threadIdx >= s_inflightRequests.size()) {
-      s_inflightRequests.resize(threadIdx + 1, {kIdleGenCount, 0});
-    } else {
-      assert(s_inflightRequests[threadIdx].startTime == kIdleGenCount);
-    }
-    s_inflightRequests[threadIdx].startTime = correctTime(startTime);
-    s_inflightRequests[threadIdx].pthreadId = Process::GetThreadId();
-    FTRACE(1, "threadIdx {} pthreadId {} start @gen {}\n", threadIdx,
-           s_inflightRequests[threadIdx].pthreadId,
-           s_inflightRequests[threadIdx].startTime);
-    if (s_oldestRequestInFlight.load(std::memory_order_relaxed) == 0) {
-      s_oldestRequestInFlight = s_inflightRequests[threadIdx].startTime;
-    }
-  }
+  refreshStats();
+  checkOldest();
+  s_inflightRequests.ensureSize(threadIdx + 1);
+  recordThreadId(threadIdx);
+  assert(s_inflightRequests[threadIdx].load() == kIdleGenCount);
+
+  auto const startTime = correctTime(getTime());
+  s_inflightRequests[threadIdx].store(startTime);
+  FTRACE(1, "threadIdx {} pthreadId {} start @gen {}\n", threadIdx,
+         Process::GetThreadId(), startTime);
+
+  // Only a finishing oldest request publishes non-zero values, so if the
+  // treadmill currently has no oldest request we might be it.  Losing the
+  // race is fine: the winner's start time is necessarily valid too.
+  GenCount expected = 0;
+  s_oldestRequestInFlight.compare_exchange_strong(expected, startTime);
 }
 
 void finishRequest() {
   auto const threadIdx = Treadmill::threadIdx();
   assert(threadIdx != -1);
   FTRACE(1, "tid {} finish\n", threadIdx);
+
+  auto const finishedRequest =
+    s_inflightRequests[threadIdx].exchange(kIdleGenCount);
+  assert(finishedRequest != kIdleGenCount);
+
+  // After finishing a request, check to see if we've allowed any triggers
+  // to fire and update the time of the oldest request in flight.
+  // However if the request just finished is not the current oldest we
+  // don't need to check anything as there cannot be any WorkItem to run.
+  if (s_oldestRequestInFlight.load() != finishedRequest) return;
+
+  std::vector<void*> toFree;
   std::vector<std::unique_ptr<WorkItem>> toFire;
+  GenCount limit;
   {
     GenCountGuard g;
-    assert(s_inflightRequests[threadIdx].startTime != kIdleGenCount);
-    GenCount finishedRequest = s_inflightRequests[threadIdx].startTime;
-    s_inflightRequests[threadIdx].startTime = kIdleGenCount;
-
-    // After finishing a request, check to see if we've allowed any triggers
-    // to fire and update the time of the oldest request in flight.
-    // However if the request just finished is not the current oldest we
-    // don't need to check anything as there cannot be any WorkItem to run.
-    if (s_oldestRequestInFlight.load(std::memory_order_relaxed) ==
-        finishedRequest) {
-      GenCount limit = s_latestCount + 1;
-      for (auto& val : s_inflightRequests) {
-        if (val.startTime != kIdleGenCount && val.startTime < limit) {
-          limit = val.startTime;
-        }
-      }
-      // update "oldest in flight" or kill it if there are no running requests
-      s_oldestRequestInFlight = limit == s_latestCount + 1 ? 0 : limit;
-
-      // collect WorkItem to run
-      auto it = s_tq.begin();
-      auto end = s_tq.end();
-      while (it != end) {
-        TRACE(2, "considering delendum %d\n", int((*it)->m_gen));
-        if ((*it)->m_gen >= limit) {
-          TRACE(2, "not unreachable! %d\n", int((*it)->m_gen));
-          break;
-        }
-        toFire.emplace_back(std::move(*it));
-        it = s_tq.erase(it);
+    // Recompute and republish the oldest request in flight.  The rescan
+    // loop closes the race where the request we're about to publish as
+    // oldest finishes concurrently: it read the previous oldest value,
+    // saw it wasn't responsible for draining, and went away, so we must
+    // notice its slot went idle and take over.  Likewise a request that
+    // started during our scan may have lost its publish race against our
+    // stale value.
+    for (;;) {
+      auto const oldest = oldestInflightStart();
+      s_oldestRequestInFlight.store(oldest);
+      limit = oldest == kIdleGenCount
+        ? s_latestCount.load(std::memory_order_relaxed) + 1
+        : oldest;
+      if (oldestInflightStart() == oldest) break;
+    }
+
+    // collect the deferred frees and WorkItems to run
+    while (!s_fq.empty() && s_fq.front().first < limit) {
+      toFree.emplace_back(s_fq.front().second);
+      s_fq.pop_front();
+    }
+    auto it = s_tq.begin();
+    auto end = s_tq.end();
+    while (it != end) {
+      TRACE(2, "considering delendum %d\n", int((*it)->m_gen));
+      if ((*it)->m_gen >= limit) {
+        TRACE(2, "not unreachable! %d\n", int((*it)->m_gen));
+        break;
       }
+      toFire.emplace_back(std::move(*it));
+      it = s_tq.erase(it);
     }
   }
+  for (auto p : toFree) {
+    free(p);
+  }
   for (unsigned i = 0; i < toFire.size(); ++i) {
     toFire[i]->run();
   }
@@ -257,7 +335,14 @@ int64_t getAgeOldestRequest() {
 }
 
 void deferredFree(void* p) {
-  enqueue([p] { free(p); });
+  if (PendingTriggers::s_destroyed) {
+    return;
+  }
+  GenCount time = getTime();
+  {
+    GenCountGuard g;
+    s_fq.emplace_back(correctTime(time), p);
+  }
 }
 
 }}
@@ -16,11 +16,20 @@
 
 #include "hphp/runtime/vm/type-profile.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <queue>
+#include <sstream>
+#include <string>
 #include <utility>
 
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/portability/Unistd.h>
+
 #include <tbb/concurrent_hash_map.h>
 
 #include "hphp/util/lock.h"
@@ -40,6 +49,7 @@
 
 #include "hphp/util/atomic-vector.h"
 #include "hphp/util/boot-stats.h"
+#include "hphp/util/hash-map-typedefs.h"
 #include "hphp/util/struct-log.h"
 
 namespace HPHP {
@@ -98,6 +108,28 @@ static InitFiniNode s_func_counters_reinit([]{
   UnsafeReinitEmptyAtomicVector(
     s_func_counters, RuntimeOption::EvalFuncCountHint);
 }, InitFiniNode::When::PostRuntimeOptions, "s_func_counters reinit");
+
+/*
+ * Function hotness carried over from a previous run of this server,
+ * keyed by full function name since FuncIds are not stable across
+ * restarts. Loaded once at startup, merged into the live counters by
+ * profileSetHotFuncAttr, and written back out from there so the file
+ * tracks the most recent profile.
+ */
+hphp_string_map<uint32_t> s_saved_func_counters;
+static InitFiniNode s_saved_func_counters_load([]{
+  auto const& file = RuntimeOption::EvalJitHotFuncsFile;
+  if (file.empty()) return;
+  std::ifstream in(file);
+  if (!in) return;
+  uint32_t count;
+  std::string name;
+  while (in >> count >> name) {
+    s_saved_func_counters[name] = count;
+  }
+  Logger::FInfo("JitHotFuncsFile: loaded {} hot functions from {}",
+                s_saved_func_counters.size(), file);
+}, InitFiniNode::When::PostRuntimeOptions, "s_saved_func_counters load");
 }
 
 void profileWarmupStart() {
@@ -113,6 +145,43 @@ static bool comp(const FuncHotness& a, const FuncHotness& b) {
   return a.second > b.second;
 }
 
+using FuncHotnessQueue =
+  std::priority_queue<FuncHotness,
+                      std::vector<FuncHotness>,
+                      bool(*)(const FuncHotness& a, const FuncHotness& b)>;
+
+/*
+ * Collect the top Eval.HotFuncCount functions by profile counter, merged
+ * with the profile carried over from the previous server. The caller must
+ * have set Func::s_treadmill to keep the Funcs alive while we iterate.
+ */
+static FuncHotnessQueue collectHotFuncs() {
+  FuncHotnessQueue queue(comp);
+  Func::getFuncVec().foreach([&](const Func* f) {
+    if (!f) return;
+    auto profCounter = [&]() -> uint32_t {
+      auto const id = f->getFuncId();
+      if (id < s_func_counters.size()) {
+        return s_func_counters[id].load(std::memory_order_relaxed);
+      }
+      return 0;
+    }();
+    if (!s_saved_func_counters.empty()) {
+      auto const it = s_saved_func_counters.find(f->fullName()->data());
+      if (it != s_saved_func_counters.end()) {
+        profCounter = std::max(profCounter, it->second);
+      }
+    }
+    auto fh = FuncHotness(f, profCounter);
+    if (queue.size() >= RuntimeOption::EvalHotFuncCount) {
+      if (!comp(fh, queue.top())) return;
+      queue.pop();
+    }
+    queue.push(fh);
+  });
+  return queue;
+}
+
 /*
  * Set AttrHot on hot functions. Sort all functions by their profile count, and
  * set AttrHot to the top Eval.HotFuncCount functions.
@@ -136,32 +205,21 @@ void profileSetHotFuncAttr() {
   };
 
   if (RuntimeOption::EvalHotFuncCount) {
-    std::priority_queue<FuncHotness,
-                        std::vector<FuncHotness>,
-                        bool(*)(const FuncHotness& a, const FuncHotness& b)>
-      queue(comp);
-
-    Func::getFuncVec().foreach([&](const Func* f) {
-      if (!f) return;
-      auto const profCounter = [&]() -> uint32_t {
-        auto const id = f->getFuncId();
-        if (id < s_func_counters.size()) {
-          return s_func_counters[id].load(std::memory_order_relaxed);
-        }
-        return 0;
-      }();
-      auto fh = FuncHotness(f, profCounter);
-      if (queue.size() >= RuntimeOption::EvalHotFuncCount) {
-        if (!comp(fh, queue.top())) return;
-        queue.pop();
-      }
-      queue.push(fh);
-    });
+    auto queue = collectHotFuncs();
 
+    std::ofstream out;
+    if (!RuntimeOption::EvalJitHotFuncsFile.empty()) {
+      out.open(RuntimeOption::EvalJitHotFuncsFile,
+               std::ios::out | std::ios::trunc);
+    }
     while (queue.size()) {
       auto f = queue.top().first;
+      auto count = queue.top().second;
       queue.pop();
       const_cast<Func*>(f)->setAttrs(f->attrs() | AttrHot);
+      if (out.is_open()) {
+        out << count << " " << f->fullName()->data() << "\n";
+      }
     }
   }
 
@@ -176,6 +234,65 @@ void profileSetHotFuncAttr() {
   synced = true;
 }
 
+int profileDumpHotFuncs() {
+#ifdef _MSC_VER
+  return -1;
+#else
+  if (!RuntimeOption::EvalHotFuncCount) return -1;
+
+  std::string data;
+  {
+    Lock lock(syncLock);
+    Func::s_treadmill = true;
+    SCOPE_EXIT {
+      Func::s_treadmill = false;
+    };
+    // If profileSetHotFuncAttr has already synced, the live counters are
+    // gone and this degrades to the profile we ourselves inherited; that
+    // is still the best information we have.
+    auto queue = collectHotFuncs();
+    while (queue.size()) {
+      folly::toAppend(queue.top().second, " ",
+                      queue.top().first->fullName()->data(), "\n", &data);
+      queue.pop();
+    }
+  }
+
+  char path[] = "/tmp/hhvm.hotfuncs.XXXXXX";
+  auto const fd = mkstemp(path);
+  if (fd < 0) {
+    Logger::Error("profileDumpHotFuncs: mkstemp failed");
+    return -1;
+  }
+  unlink(path);
+  if (folly::writeFull(fd, data.data(), data.size()) !=
+      static_cast<ssize_t>(data.size()) ||
+      lseek(fd, 0, SEEK_SET) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+#endif
+}
+
+void profileLoadHotFuncs(int fd) {
+  std::string data;
+  auto const ok = folly::readFile(fd, data);
+  close(fd);
+  if (!ok) return;
+  uint32_t count;
+  std::string name;
+  size_t merged = 0;
+  std::istringstream in(data);
+  while (in >> count >> name) {
+    auto& saved = s_saved_func_counters[name];
+    saved = std::max(saved, count);
+    ++merged;
+  }
+  Logger::FInfo("takeover: merged {} hot functions from the old server",
+                merged);
+}
+
 void profileIncrementFuncCounter(const Func* f) {
   s_func_counters.ensureSize(f->getFuncId() + 1);
   s_func_counters[f->getFuncId()].fetch_add(1, std::memory_order_relaxed);
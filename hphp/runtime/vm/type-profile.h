@@ -48,6 +48,21 @@ int singleJitRequestCount();
  */
 void profileIncrementFuncCounter(const Func*);
 
+/*
+ * Write the current hot-function profile to an unlinked temporary file
+ * in the Eval.JitHotFuncsFile format ("<count> <name>" per line).
+ * Returns an fd positioned at the start of the data, or -1. Used to
+ * hand the profile to a server taking over our listen socket.
+ */
+int profileDumpHotFuncs();
+
+/*
+ * Merge a hot-function profile in Eval.JitHotFuncsFile format, read
+ * from fd, into the saved profile. Takes ownership of the fd. Must be
+ * called before the server starts taking requests.
+ */
+void profileLoadHotFuncs(int fd);
+
 extern __thread RequestKind requestKind;
 inline bool isProfileRequest() {
   return requestKind == RequestKind::Profile;
@@ -116,6 +116,14 @@ void UnitEmitter::setBc(const unsigned char* bc, size_t bclen) {
   m_bclen = bclen;
 }
 
+void UnitEmitter::rollbackBc(Offset pos) {
+  assert(size_t(pos) <= m_bclen);
+  m_bclen = pos;
+  while (!m_sourceLocTab.empty() && m_sourceLocTab.back().first >= pos) {
+    m_sourceLocTab.pop_back();
+  }
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Litstrs and Arrays.
@@ -432,6 +440,19 @@ void UnitEmitter::commit(UnitOrigin unitOrigin) {
   }
 }
 
+void UnitEmitter::prepareCommit() {
+  if (m_preparedCommit) return;
+  m_lineTable = createLineTable(m_sourceLocTab, m_bclen);
+  m_serializedArrays.reserve(m_arrays.size());
+  for (auto const arr : m_arrays) {
+    VariableSerializer vs(VariableSerializer::Type::Serialize);
+    m_serializedArrays.emplace_back(
+      vs.serializeValue(VarNR(arr), false /* limit */).toCppString()
+    );
+  }
+  m_preparedCommit = true;
+}
+
 RepoStatus UnitEmitter::insert(UnitOrigin unitOrigin, RepoTxn& txn) {
   Repo& repo = Repo::get();
   UnitRepoProxy& urp = repo.urp();
@@ -442,22 +463,16 @@ RepoStatus UnitEmitter::insert(UnitOrigin unitOrigin, RepoTxn& txn) {
   m_repoId = repoId;
 
   try {
-    {
-      m_lineTable = createLineTable(m_sourceLocTab, m_bclen);
-      urp.insertUnit[repoId].insert(*this, txn, m_sn, m_md5, m_bc,
-                                    m_bclen);
-    }
+    prepareCommit();
+    urp.insertUnit[repoId].insert(*this, txn, m_sn, m_md5, m_bc,
+                                  m_bclen);
     int64_t usn = m_sn;
     urp.insertUnitLineTable(repoId, txn, usn, m_lineTable);
     for (unsigned i = 0; i < m_litstrs.size(); ++i) {
       urp.insertUnitLitstr[repoId].insert(txn, usn, i, m_litstrs[i]);
     }
     for (unsigned i = 0; i < m_arrays.size(); ++i) {
-      VariableSerializer vs(VariableSerializer::Type::Serialize);
-      urp.insertUnitArray[repoId].insert(
-        txn, usn, i,
-        vs.serializeValue(VarNR(m_arrays[i]), false /* limit */).toCppString()
-      );
+      urp.insertUnitArray[repoId].insert(txn, usn, i, m_serializedArrays[i]);
     }
     for (auto& fe : m_fes) {
       fe->commit(txn);
@@ -766,6 +781,196 @@ void UnitEmitter::serdeMetaData(SerDe& sd) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Flat serialization.
+
+void UnitEmitter::serializeFlat(BlobEncoder& enc) {
+  /*
+   * The blob carries the same data insert() spreads across the individual
+   * repo tables, in the order loadHelper() reads it back.
+   */
+  if (m_lineTable.empty()) {
+    m_lineTable = createLineTable(m_sourceLocTab, m_bclen);
+  }
+
+  enc(m_sn)(m_preloadPriority);
+  serdeMetaData(enc);
+  enc(uint32_t(m_bclen));
+  enc.writeRaw(reinterpret_cast<const char*>(m_bc), m_bclen);
+
+  enc(m_litstrs);
+
+  enc(uint32_t(m_arrays.size()));
+  for (auto const arr : m_arrays) {
+    VariableSerializer vs(VariableSerializer::Type::Serialize);
+    enc(vs.serializeValue(VarNR(arr), false /* limit */).toCppString());
+  }
+
+  enc(uint32_t(m_pceVec.size()));
+  for (auto const pce : m_pceVec) {
+    enc(std::string(pce->name()->data(), pce->name()->size()));
+    enc(int(pce->hoistability()));
+    pce->serdeMetaData(enc);
+  }
+
+  uint32_t numMergeables = 0;
+  for (auto const& ms : m_mergeableStmts) {
+    if (ms.first != MergeKind::Class) ++numMergeables;
+  }
+  enc(numMergeables);
+  for (int i = 0, n = m_mergeableStmts.size(); i < n; ++i) {
+    auto const kind = m_mergeableStmts[i].first;
+    switch (kind) {
+      case MergeKind::Done:
+      case MergeKind::UniqueDefinedClass:
+        not_reached();
+      case MergeKind::Class:
+        break;
+      case MergeKind::TypeAlias:
+      case MergeKind::ReqDoc:
+        enc(i)(kind)(m_mergeableStmts[i].second);
+        break;
+      case MergeKind::Define:
+      case MergeKind::PersistentDefine:
+      case MergeKind::Global: {
+        auto const ix = m_mergeableStmts[i].second;
+        enc(i)(kind)(m_mergeableValues[ix].first);
+        enc(m_mergeableValues[ix].second);
+        break;
+      }
+    }
+  }
+
+  enc(m_lineTable);
+
+  // GetFuncsStmt reads funcs back in funcSn order, interleaving top-level
+  // functions with methods; reproduce that here.
+  auto fes = m_fes;
+  for (auto const pce : m_pceVec) {
+    for (auto const fe : pce->methods()) fes.push_back(fe);
+  }
+  std::sort(fes.begin(), fes.end(),
+            [] (FuncEmitter* a, FuncEmitter* b) { return a->sn() < b->sn(); });
+  enc(uint32_t(fes.size()));
+  for (auto const fe : fes) {
+    enc(fe->pce() ? fe->pce()->id() : Id(-1));
+    enc(fe->name.get());
+    enc(fe->top);
+    fe->serdeMetaData(enc);
+  }
+}
+
+void UnitEmitter::deserializeFlat(const std::string& name, BlobDecoder& dec) {
+  if (!RuntimeOption::EvalLoadFilepathFromUnitCache) {
+    m_filepath = makeStaticString(name);
+  }
+  // Flat files are exported from the central repo, so the unit's sn is still
+  // valid there; this keeps demand-loaded data (source locs) working.
+  m_repoId = RepoIdCentral;
+
+  dec(m_sn)(m_preloadPriority);
+  serdeMetaData(dec);
+  uint32_t bclen;
+  dec(bclen);
+  setBc(dec.data(), bclen);
+  dec.advance(bclen);
+
+  {
+    std::vector<const StringData*> litstrs;
+    dec(litstrs);
+    for (auto const litstr : litstrs) mergeUnitLitstr(litstr);
+  }
+
+  uint32_t numArrays;
+  dec(numArrays);
+  for (uint32_t i = 0; i < numArrays; ++i) {
+    std::string key;
+    dec(key);
+    Variant v = unserialize_from_buffer(key.data(), key.size());
+    Id id UNUSED = mergeArray(
+      v.asArrRef().get(),
+      ArrayData::GetScalarArrayKey(key.c_str(), key.size()));
+    assert(id == i);
+  }
+
+  uint32_t numPreClasses;
+  dec(numPreClasses);
+  for (uint32_t i = 0; i < numPreClasses; ++i) {
+    std::string pceName;
+    int hoistable;
+    dec(pceName);
+    dec(hoistable);
+    auto const pce = newPreClassEmitter(pceName,
+                                        (PreClass::Hoistable)hoistable);
+    pce->serdeMetaData(dec);
+  }
+
+  uint32_t numMergeables;
+  dec(numMergeables);
+  for (uint32_t i = 0; i < numMergeables; ++i) {
+    int mergeableIx;
+    MergeKind k;
+    Id mergeableId;
+    dec(mergeableIx);
+    dec(k);
+    dec(mergeableId);
+    if (UNLIKELY(!RuntimeOption::RepoAuthoritative)) {
+      // See GetUnitMergeablesStmt::get for why requires are dropped when a
+      // WholeProgram repo is used without RepoAuthoritative.
+      if ((k != MergeKind::PersistentDefine && k != MergeKind::TypeAlias)
+          || SystemLib::s_inited) {
+        m_mergeOnly = false;
+      }
+    }
+    switch (k) {
+      case MergeKind::TypeAlias:
+        insertMergeableTypeAlias(mergeableIx, k, mergeableId);
+        break;
+      case MergeKind::ReqDoc:
+        insertMergeableInclude(mergeableIx, k, mergeableId);
+        break;
+      case MergeKind::PersistentDefine:
+      case MergeKind::Define:
+      case MergeKind::Global: {
+        TypedValue mergeableValue;
+        dec(mergeableValue);
+        insertMergeableDef(mergeableIx, k, mergeableId, mergeableValue);
+        break;
+      }
+      default: break;
+    }
+  }
+
+  dec(m_lineTable);
+
+  uint32_t numFuncs;
+  dec(numFuncs);
+  for (uint32_t i = 0; i < numFuncs; ++i) {
+    Id preClassId;
+    const StringData* funcName;
+    bool top;
+    dec(preClassId);
+    dec(funcName);
+    dec(top);
+
+    FuncEmitter* fe;
+    if (preClassId < 0) {
+      fe = newFuncEmitter(funcName);
+    } else {
+      PreClassEmitter* pce = this->pce(preClassId);
+      fe = newMethodEmitter(funcName, pce);
+      bool added UNUSED = pce->addMethod(fe);
+      assert(added);
+    }
+    fe->top = top;
+    fe->serdeMetaData(dec);
+    fe->setEHTabIsSorted();
+    fe->finish(fe->past, true);
+    recordFunction(fe);
+  }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // UnitRepoProxy.
 
@@ -40,6 +40,8 @@
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
+struct BlobDecoder;
+struct BlobEncoder;
 struct FuncEmitter;
 struct PreClassEmitter;
 struct StringData;
@@ -76,6 +78,15 @@ struct UnitEmitter {
    */
   RepoStatus insert(UnitOrigin unitOrigin, RepoTxn& txn);
 
+  /*
+   * Precompute the commit-time serialization work that doesn't need the
+   * repo connection (the line table and the scalar array literals), so
+   * batchCommit() can run it for many units in parallel before taking
+   * the write transaction.  Idempotent; insert() calls it on demand if
+   * it hasn't already run.
+   */
+  void prepareCommit();
+
   /*
    * Instatiate a runtime Unit*.
    */
@@ -83,6 +94,18 @@ struct UnitEmitter {
 
   template<class SerDe> void serdeMetaData(SerDe&);
 
+  /*
+   * Serialize the unit's complete contents into a single blob, and the
+   * reverse.  The blob carries everything UnitRepoProxy::loadHelper would
+   * otherwise reassemble from the individual repo tables, so a unit stored
+   * this way can be created from one contiguous byte range with no SQLite
+   * involvement.  `name' plays the same role it does in loadHelper: it
+   * becomes the unit's filepath unless Eval.LoadFilepathFromUnitCache is
+   * set.
+   */
+  void serializeFlat(BlobEncoder& enc);
+  void deserializeFlat(const std::string& name, BlobDecoder& dec);
+
 
   /////////////////////////////////////////////////////////////////////////////
   // Basic data.
@@ -107,6 +130,13 @@ struct UnitEmitter {
    */
   void setBc(const unsigned char* bc, size_t bclen);
 
+  /*
+   * Drop all bytecode at or after `pos', along with any source location
+   * information recorded for it.  Used to discard a just-emitted function
+   * body in favor of an identical earlier one (see HHBBC's emitter).
+   */
+  void rollbackBc(Offset pos);
+
 
   /////////////////////////////////////////////////////////////////////////////
   // Litstrs and Arrays.
@@ -450,6 +480,12 @@ private:
   std::vector<std::pair<Offset,SourceLoc>> m_sourceLocTab;
   std::vector<std::pair<Offset,const FuncEmitter*>> m_feTab;
   LineTable m_lineTable;
+
+  /*
+   * Commit-time serializations precomputed by prepareCommit().
+   */
+  std::vector<std::string> m_serializedArrays;
+  bool m_preparedCommit{false};
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -22,8 +22,10 @@
 #include <cstring>
 #include <iomanip>
 #include <map>
+#include <memory>
 #include <ostream>
 #include <sstream>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/container/flat_map.hpp>
@@ -194,6 +196,15 @@ Unit::Unit()
   , m_mainReturn(make_tv<KindOfUninit>())
 {}
 
+/*
+ * The RDS writes a clean merge of this Unit performs, recorded once so
+ * later requests can replay them as a batch.  See tryBuildMergeSnapshot().
+ */
+struct Unit::MergeSnapshot {
+  std::vector<std::pair<rds::Handle,Func*>> funcs;
+  std::vector<std::pair<rds::Handle,Class*>> classes;
+};
+
 Unit::~Unit() {
   if (RuntimeOption::EvalEnableReverseDataMap &&
       m_mergeState != MergeState::Unmerged) {
@@ -205,6 +216,8 @@ Unit::~Unit() {
   s_lineTables.erase(this);
   s_lineInfo.erase(this);
 
+  clearInterpCaches(this);
+
   if (!RuntimeOption::RepoAuthoritative) {
     if (debug) {
       // poison released bytecode
@@ -232,6 +245,7 @@ Unit::~Unit() {
   }
 
   free(m_mergeInfo);
+  delete m_mergeSnapshot.load(std::memory_order_relaxed);
 
   if (m_pseudoMainCache) {
     for (auto& kv : *m_pseudoMainCache) {
@@ -249,6 +263,18 @@ void Unit::operator delete(void* p, size_t /*sz*/) {
   low_free_data(p);
 }
 
+size_t Unit::memoryUsage() const {
+  auto size = sizeof(Unit) + m_bclen;
+  size += m_namedInfo.size() * sizeof(NamedEntityPair);
+  size += m_arrays.size() * sizeof(const ArrayData*);
+  size += m_typeAliases.size() * sizeof(TypeAlias);
+  size += m_preClasses.size() * sizeof(PreClassPtr);
+  if (m_mergeInfo) {
+    size += sizeof(MergeInfo) + m_mergeInfo->m_mergeablesSize * sizeof(void*);
+  }
+  return size;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Code locations.
@@ -1399,8 +1425,113 @@ void Unit::merge() {
 
   if (UNLIKELY(isDebuggerAttached())) {
     mergeImpl<true>(rds::tl_base, m_mergeInfo);
-  } else {
-    mergeImpl<false>(rds::tl_base, m_mergeInfo);
+    return;
+  }
+
+  if (auto const snap = m_mergeSnapshot.load(std::memory_order_acquire)) {
+    mergeFromSnapshot(rds::tl_base, snap);
+    return;
+  }
+
+  mergeImpl<false>(rds::tl_base, m_mergeInfo);
+
+  if (RuntimeOption::EvalUnitMergeSnapshots &&
+      !RuntimeOption::RepoAuthoritative &&
+      !(m_mergeState & (MergeState::NeedsCompact | MergeState::SnapshotDone))) {
+    tryBuildMergeSnapshot();
+  }
+}
+
+/*
+ * Decide whether every mergeable in this Unit can be merged with a plain
+ * RDS write, and if so record those writes.
+ *
+ * A definition qualifies when the work mergeImpl would do for it is exactly
+ * "store the pointer and mark the handle initialized", and the checks
+ * guarding that work are guaranteed to repeat their first outcome: unique
+ * functions, and unique defined classes all of whose ancestors (parent,
+ * declared interfaces, used traits) are either persistent or defined
+ * earlier by this same snapshot.  Units with defines, globals, requires,
+ * type aliases, or non-unique definitions keep the generic path.
+ *
+ * Runs after the MergeInfo has been compacted, so unique classes appear as
+ * tagged Class*'s and persistent definitions have already been dropped.
+ */
+void Unit::tryBuildMergeSnapshot() {
+  SimpleLock lock(unitInitLock);
+  if (m_mergeState & (MergeState::SnapshotDone | MergeState::NeedsCompact)) {
+    return;
+  }
+  // One attempt per Unit, whether or not it qualifies.
+  m_mergeState |= MergeState::SnapshotDone;
+
+  auto const mi = m_mergeInfo;
+  auto snap = std::make_unique<MergeSnapshot>();
+  std::unordered_set<rds::Handle> written;
+
+  Func** it = mi->funcHoistableBegin();
+  Func** fend = mi->funcEnd();
+  if (it != fend && !(m_mergeState & MergeState::UniqueFuncs)) return;
+  for (; it != fend; ++it) {
+    Func* func = *it;
+    snap->funcs.emplace_back(func->funcHandle(), func);
+    written.insert(func->funcHandle());
+  }
+
+  auto const stable = [&](const Class* cls) {
+    auto const handle = cls->classHandle();
+    return rds::isPersistentHandle(handle) || written.count(handle);
+  };
+  auto const recordClass = [&](Class* cls) {
+    if (Class* parent = cls->parent()) {
+      if (!stable(parent)) return false;
+    }
+    for (auto const& di : cls->declInterfaces()) {
+      if (!stable(di.get())) return false;
+    }
+    for (auto const& ut : cls->usedTraitClasses()) {
+      if (!stable(ut.get())) return false;
+    }
+    snap->classes.emplace_back(cls->classHandle(), cls);
+    written.insert(cls->classHandle());
+    return true;
+  };
+
+  unsigned ix = mi->m_firstHoistablePreClass;
+  unsigned end = mi->m_firstMergeablePreClass;
+  for (; ix < end; ++ix) {
+    void* obj = mi->mergeableObj(ix);
+    // Hoistable classes get rewritten to tagged Class*'s by the first merge
+    // when they turn out to be unique and defined; anything still a
+    // PreClass* needs its per-request checks.
+    if (!(uintptr_t(obj) & 1)) return;
+    if (!recordClass((Class*)(uintptr_t(obj) & ~1))) return;
+  }
+
+  end = mi->m_mergeablesSize;
+  while (ix < end) {
+    void* obj = mi->mergeableObj(ix++);
+    auto const k = MergeKind(uintptr_t(obj) & 7);
+    if (k != MergeKind::UniqueDefinedClass) return;
+    if (!recordClass((Class*)((char*)obj - (int)k))) return;
+  }
+
+  m_mergeSnapshot.store(snap.release(), std::memory_order_release);
+}
+
+void Unit::mergeFromSnapshot(void* tcbase, const MergeSnapshot* snap) {
+  assert(m_mergeState & MergeState::Merged);
+  autoTypecheck(this);
+
+  // setUniqueFunc() was done by the first merge; the NamedEntity is
+  // process-global, so only the RDS writes recur per request.
+  for (auto const& e : snap->funcs) {
+    getDataRef<LowPtr<Func>>(tcbase, e.first) = e.second;
+    if (rds::isNormalHandle(e.first)) rds::initHandle(e.first);
+  }
+  for (auto const& e : snap->classes) {
+    getDataRef<LowPtr<Class>>(tcbase, e.first) = e.second;
+    if (rds::isNormalHandle(e.first)) rds::initHandle(e.first);
   }
 }
 
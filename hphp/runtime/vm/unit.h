@@ -35,6 +35,7 @@
 #include "hphp/util/mutex.h"
 #include "hphp/util/service-data.h"
 
+#include <atomic>
 #include <map>
 #include <ostream>
 #include <string>
@@ -224,9 +225,20 @@ private:
     Merged        = 1 << 1,
     UniqueFuncs   = 1 << 2,
     NeedsCompact  = 1 << 3,
+    SnapshotDone  = 1 << 4,
     Empty         = 1 << 5
   };
 
+  /*
+   * Snapshot of the RDS writes performed by a clean merge of this Unit.
+   *
+   * Built at most once, after the Unit's MergeInfo has been compacted, and
+   * only when every mergeable's per-definition checks are guaranteed to
+   * repeat their first outcome (see tryBuildMergeSnapshot()).  Subsequent
+   * requests then merge the Unit with a batch of plain RDS writes.
+   */
+  struct MergeSnapshot;
+
 public:
   /*
    * Information on all the mergeable defs within a Unit.
@@ -347,6 +359,13 @@ public:
   const StringData* filepath() const;
   const StringData* dirpath() const;
 
+  /*
+   * Estimate of the Unit's own malloced footprint: bytecode plus the
+   * litstr, scalar array, type alias, and merge tables.  Used by the unit
+   * cache's memory accounting; it is a weight, not an exact size.
+   */
+  size_t memoryUsage() const;
+
 
   /////////////////////////////////////////////////////////////////////////////
   // Bytecode.                                                          [const]
@@ -851,6 +870,8 @@ private:
   void initialMerge();
   template<bool debugger>
   void mergeImpl(void* tcbase, MergeInfo* mi);
+  void tryBuildMergeSnapshot();
+  void mergeFromSnapshot(void* tcbase, const MergeSnapshot* snap);
 
 
   /////////////////////////////////////////////////////////////////////////////
@@ -863,6 +884,11 @@ private:
   Offset m_bclen{0};
   LowStringPtr m_filepath{nullptr};
   MergeInfo* m_mergeInfo{nullptr};
+  /*
+   * Written at most once, under unitInitLock; read without a lock on every
+   * merge.
+   */
+  std::atomic<MergeSnapshot*> m_mergeSnapshot{nullptr};
 
   int8_t m_repoId{-1};
   /*
@@ -16,11 +16,20 @@
 
 #include <stdio.h>
 #include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#include "hphp/runtime/base/runtime-option.h"
 #include "hphp/runtime/vm/verifier/check.h"
 #include "hphp/runtime/vm/verifier/cfg.h"
 #include "hphp/runtime/vm/verifier/util.h"
 #include "hphp/runtime/vm/verifier/pretty.h"
+#include "hphp/util/async-job.h"
+#include "hphp/util/hash.h"
+#include "hphp/util/hash-map-typedefs.h"
+#include "hphp/util/lock.h"
 
 namespace HPHP {
 namespace Verifier {
@@ -361,12 +370,87 @@ bool UnitChecker::checkBytecode() {
   // 2. Its not an error for an abstract function to have zero size.
 }
 
+namespace {
+
+/*
+ * Process-lifetime set of fingerprints for functions that already passed
+ * checkFunc().  With Eval.VerifyIncremental set, a function whose
+ * fingerprint is present is not re-verified.  The fingerprint covers the
+ * bytecode bytes and is mixed with the owning unit's md5 and the function's
+ * base offset, since bytecode validity also depends on the unit's litstr
+ * and array tables and on per-func metadata (local and iterator counts).
+ */
+Mutex s_verified_lock;
+hphp_hash_set<uint64_t> s_verified;
+
+uint64_t funcFingerprint(const Func* func) {
+  auto const unit = func->unit();
+  auto const bc = unit->at(func->base());
+  auto const len = func->past() - func->base();
+  auto const md5 = unit->md5();
+  uint64_t hash = hash_string_cs(reinterpret_cast<const char*>(bc), len);
+  hash = hash_int64_pair(hash, md5.q[0]);
+  hash = hash_int64_pair(hash, md5.q[1]);
+  return hash_int64_pair(hash, func->base());
+}
+
+bool alreadyVerified(const Func* func) {
+  Lock lock(s_verified_lock);
+  return s_verified.count(funcFingerprint(func)) != 0;
+}
+
+void markVerified(const Func* func) {
+  Lock lock(s_verified_lock);
+  s_verified.insert(funcFingerprint(func));
+}
+
+} // anonymous namespace
+
+/*
+ * Job/worker pair for checking a unit's functions on a JobDispatcher.
+ * Each FuncChecker owns all of its analysis state, so workers share
+ * nothing but their own job slots.  In kThrow mode errors are captured
+ * here and rethrown on the dispatching thread.
+ */
+struct VerifyFuncJob {
+  VerifyFuncJob(const Func* func, ErrorMode mode)
+    : func(func), mode(mode) {}
+
+  const Func* func;
+  ErrorMode mode;
+  bool ok{false};
+  std::string error;
+};
+
+struct VerifyFuncWorker {
+  void onThreadEnter() {}
+  void doJob(std::shared_ptr<VerifyFuncJob> job) {
+    try {
+      job->ok = checkFunc(job->func, job->mode);
+    } catch (const std::exception& e) {
+      job->error = e.what();
+    }
+  }
+  void onThreadExit() {}
+};
+
+} // namespace Verifier
+
+// Verifier worker threads are pure analysis; don't give them full
+// hphp_thread_init/fini treatment.
+template<> struct WorkerInfo<Verifier::VerifyFuncJob> {
+  enum { DoInitFini = false };
+};
+
+namespace Verifier {
+
 bool UnitChecker::checkFuncs() {
   const Func* pseudo = nullptr;
   bool multi = false;
   bool ok = true;
   bool nonTops = true;
 
+  std::vector<const Func*> work;
   m_unit->forEachFunc([&](const Func* func) {
     if (func->isPseudoMain()) {
       if(func->isMemoizeWrapper()) {
@@ -394,7 +478,10 @@ bool UnitChecker::checkFuncs() {
       ok &= checkNativeFunc(func, m_errmode);
     }
 
-    ok &= checkFunc(func, m_errmode);
+    if (RuntimeOption::EvalVerifyIncremental && alreadyVerified(func)) {
+      return;
+    }
+    work.push_back(func);
   });
 
   if (!multi && m_unit->getMain(nullptr) != pseudo) {
@@ -402,6 +489,42 @@ bool UnitChecker::checkFuncs() {
     ok = false;
   }
 
+  auto const workers =
+    std::min<size_t>(RuntimeOption::EvalVerifyWorkers, work.size());
+  if (workers < 2) {
+    for (auto const func : work) {
+      auto const fok = checkFunc(func, m_errmode);
+      if (fok && RuntimeOption::EvalVerifyIncremental) markVerified(func);
+      ok &= fok;
+    }
+    return ok;
+  }
+
+  std::vector<std::shared_ptr<VerifyFuncJob>> jobs;
+  jobs.reserve(work.size());
+  for (auto const func : work) {
+    jobs.push_back(std::make_shared<VerifyFuncJob>(func, m_errmode));
+  }
+  auto const results = jobs;
+  JobDispatcher<VerifyFuncJob, VerifyFuncWorker>(
+    std::move(jobs), workers).run();
+
+  std::string firstError;
+  for (auto const& job : results) {
+    if (job->ok) {
+      if (RuntimeOption::EvalVerifyIncremental) markVerified(job->func);
+      continue;
+    }
+    ok = false;
+    if (firstError.empty() && !job->error.empty()) {
+      firstError = job->error;
+    }
+  }
+  if (!firstError.empty()) {
+    assert(m_errmode == kThrow);
+    throw std::runtime_error(firstError);
+  }
+
   return ok;
 }
 
@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+
+"""
+Decode a structured trace-ring dump produced by the dump-trace-rings admin
+command (see HPHP::Trace::dumpStructuredRingbuffers() in
+hphp/util/ringbuffer.cpp).
+
+The dump is self-describing: it embeds the RingBufferType name table, so
+this script does not need to match the hhvm binary that wrote it. Records
+from all threads are merged and printed in global sequence order:
+
+  SEQ THREAD TYPE SK DATA
+
+Entries that were torn by concurrent writers (or never written) are
+silently discarded.
+
+Usage: trace-ring-decode.py /tmp/trace_rings
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import struct
+import sys
+
+MAGIC = b'HHVMRBUF'
+VERSION = 1
+
+
+def read_u32(f):
+    return struct.unpack('<I', f.read(4))[0]
+
+
+def decode(path):
+    with open(path, 'rb') as f:
+        if f.read(8) != MAGIC:
+            sys.exit('%s: not a trace-ring dump' % path)
+        version = read_u32(f)
+        if version != VERSION:
+            sys.exit('%s: unsupported version %d' % (path, version))
+        entry_size = read_u32(f)
+
+        num_types = read_u32(f)
+        type_names = []
+        for _ in range(num_types):
+            name_len = read_u32(f)
+            type_names.append(f.read(name_len).decode('ascii'))
+
+        records = []
+        num_rings = read_u32(f)
+        for _ in range(num_rings):
+            num_entries = read_u32(f)
+            for _ in range(num_entries):
+                raw = f.read(entry_size)
+                if len(raw) < entry_size:
+                    sys.exit('%s: truncated dump' % path)
+                # Matches HPHP::Trace::RingBufferEntry: two uint64 payload
+                # words, uint32 thread id, uint32 sequence number, uint8
+                # type, then padding out to entry_size.
+                sk, data, tid, seq, rbtype = struct.unpack_from(
+                    '<QQIIB', raw)
+                if rbtype >= num_types:
+                    continue  # torn entry
+                if rbtype == 0 and seq == 0 and sk == 0 and data == 0:
+                    continue  # never-written slot
+                records.append((seq, tid, rbtype, sk, data))
+
+    records.sort()
+    for seq, tid, rbtype, sk, data in records:
+        print('%10d %#010x %-16s %#018x %#018x' %
+              (seq, tid, type_names[rbtype], sk, data))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip())
+    decode(sys.argv[1])
+
+
+if __name__ == '__main__':
+    main()
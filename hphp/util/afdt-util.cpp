@@ -105,5 +105,59 @@ int recv_fd(int afdt_fd) {
   return fd;
 }
 
+bool send_fds(int afdt_fd, const int* fds, unsigned count) {
+  // libafdt only carries one fd per message, so build the SCM_RIGHTS
+  // payload ourselves.
+  char data = 1;
+  iovec iov;
+  iov.iov_base = &data;
+  iov.iov_len = sizeof(data);
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  std::vector<char> control(CMSG_SPACE(count * sizeof(int)), 0);
+  msg.msg_control = &control[0];
+  msg.msg_controllen = control.size();
+
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(count * sizeof(int));
+  memcpy(CMSG_DATA(cmsg), fds, count * sizeof(int));
+
+  return sendmsg(afdt_fd, &msg, 0) >= 0;
+}
+
+bool recv_fds(int afdt_fd, int* fds, unsigned count) {
+  char data;
+  iovec iov;
+  iov.iov_base = &data;
+  iov.iov_len = sizeof(data);
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  std::vector<char> control(CMSG_SPACE(count * sizeof(int)), 0);
+  msg.msg_control = &control[0];
+  msg.msg_controllen = control.size();
+
+  if (recvmsg(afdt_fd, &msg, MSG_WAITALL) <= 0) return false;
+
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg ||
+      cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(count * sizeof(int))) {
+    return false;
+  }
+  memcpy(fds, CMSG_DATA(cmsg), count * sizeof(int));
+  return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 }}
@@ -237,6 +237,12 @@ int recvRaw(int afdt_fd, Head& h, Tail&... args) {
 bool send_fd(int afdt_fd, int fd);
 int recv_fd(int afdt_fd);
 
+// Transfer several descriptors in a single SCM_RIGHTS message. Both
+// sides must agree on the count. Cheaper than repeated send_fd calls:
+// one sendmsg/recvmsg round trip instead of one per descriptor.
+bool send_fds(int afdt_fd, const int* fds, unsigned count);
+bool recv_fds(int afdt_fd, int* fds, unsigned count);
+
 ///////////////////////////////////////////////////////////////////////////////
 }
 }
@@ -231,6 +231,7 @@ void set_numa_binding(int node) {}
 
 #ifdef USE_JEMALLOC
 unsigned low_arena = 0;
+unsigned shared_arena = 0;
 unsigned low_huge1g_arena = 0;
 unsigned high_huge1g_arena = 0;
 std::atomic<int> low_huge_pages(0);
@@ -501,6 +502,14 @@ struct JEMallocInitializer {
       return;
     }
 
+    // Create an arena for process-lifetime shared data (uncounted APC
+    // values, class tables). Keeping that slowly-churning data out of
+    // the regular arenas avoids fragmenting them over days of uptime;
+    // on failure shared_malloc falls back to plain malloc.
+    if (mallctlRead(JEMALLOC_NEW_ARENA_CMD, &shared_arena, true) != 0) {
+      shared_arena = 0;
+    }
+
     // We normally maintain the invariant that the region surrounding the
     // current brk is mapped huge, but we don't know yet whether huge pages
     // are enabled for low memory. Round up to the start of a huge page,
@@ -612,6 +621,12 @@ void* low_malloc_impl(size_t size) {
   return ptr;
 }
 
+void* shared_malloc_impl(size_t size) {
+  if (size == 0) return nullptr;
+  if (shared_arena == 0) return malloc(size);
+  return mallocx(size, shared_mallocx_flags());
+}
+
 void low_malloc_skip_huge(void* start, void* end) {
   if (low_huge_pages.load()) {
     low_malloc_hugify((char*)start - 1);
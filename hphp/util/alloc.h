@@ -153,6 +153,28 @@ inline int low_dallocx_flags() {
 #endif
 }
 
+extern unsigned shared_arena;
+
+inline int shared_mallocx_flags() {
+  // Allocate process-lifetime shared data (APC values, class tables) from a
+  // dedicated arena, so its slow churn doesn't fragment the arenas serving
+  // transient allocations.
+#ifdef MALLOCX_TCACHE_NONE
+  return MALLOCX_ARENA(shared_arena) | MALLOCX_TCACHE_NONE;
+#else
+  return MALLOCX_ARENA(shared_arena);
+#endif
+}
+
+inline int shared_dallocx_flags() {
+#ifdef MALLOCX_TCACHE_NONE
+  // Bypass the implicit tcache for this deallocation.
+  return MALLOCX_TCACHE_NONE;
+#else
+  return MALLOCX_ARENA(shared_arena);
+#endif
+}
+
 #ifdef USE_JEMALLOC_CUSTOM_HOOKS
 extern unsigned low_huge1g_arena;
 extern unsigned high_huge1g_arena;
@@ -220,9 +242,26 @@ inline void low_free_data(void* ptr) {
 #endif
 }
 
+inline void* shared_malloc(size_t size) {
+#ifndef USE_JEMALLOC
+  return malloc(size);
+#else
+  extern void* shared_malloc_impl(size_t);
+  return shared_malloc_impl(size);
+#endif
+}
+
+inline void shared_free(void* ptr) {
+#ifndef USE_JEMALLOC
+  free(ptr);
+#else
+  if (ptr) dallocx(ptr, shared_dallocx_flags());
+#endif
+}
+
 inline void* malloc_huge(size_t size) {
 #ifndef USE_JEMALLOC_CUSTOM_HOOKS
-  return malloc(size);
+  return shared_malloc(size);
 #else
   extern void* malloc_huge1g_impl(size_t);
   return malloc_huge1g_impl(size);
@@ -231,7 +270,7 @@ inline void* malloc_huge(size_t size) {
 
 inline void free_huge(void* ptr) {
 #ifndef USE_JEMALLOC_CUSTOM_HOOKS
-  free(ptr);
+  shared_free(ptr);
 #else
   if (ptr) dallocx(ptr, dallocx_huge1g_flags());
 #endif
@@ -127,6 +127,16 @@ struct AsyncFuncImpl {
    */
   bool waitForEnd(int seconds = 0);
 
+  /**
+   * Non-blocking check of whether the function has finished running.  The
+   * underlying thread still needs a waitForEnd() to get joined, but that
+   * returns immediately once this is true.
+   */
+  bool finished() {
+    Lock lock(m_stopMonitor.getMutex());
+    return m_stopped;
+  }
+
   /**
    * Starts and waits until this thread finishes running.
    */
@@ -203,6 +213,8 @@ struct AsyncFunc : AsyncFuncImpl {
     (p->m_obj->*(p->m_memberFunc))();
   }
 
+  T *getObject() const { return m_obj; }
+
 private:
   T *m_obj;
   void (T::*m_memberFunc)();
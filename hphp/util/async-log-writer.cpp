@@ -0,0 +1,132 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include "hphp/util/async-log-writer.h"
+
+#include <chrono>
+
+#include <sys/uio.h>
+
+#include <folly/portability/Unistd.h>
+
+#include "hphp/util/portability.h"
+#include "hphp/util/service-data.h"
+
+namespace HPHP {
+
+//////////////////////////////////////////////////////////////////////
+
+bool AsyncLogWriter::Enabled = false;
+
+namespace {
+
+ServiceData::ExportedCounter* s_droppedLines =
+  ServiceData::createCounter("log_writer_dropped_lines");
+
+}
+
+AsyncLogWriter* AsyncLogWriter::Get() {
+  // Intentionally leaked; see the singleton notes on ServiceData's Impl
+  // for why loggers must outlive static destruction.
+  static AsyncLogWriter* s_writer = new AsyncLogWriter();
+  return s_writer;
+}
+
+AsyncLogWriter::AsyncLogWriter() {
+  std::thread([this] { flusherMain(); }).detach();
+}
+
+void AsyncLogWriter::enqueue(int fd, std::string&& line) {
+  // Reserve a slot first; on overflow, drop and count. Producers only ever
+  // do relaxed counter updates and a CAS push, so they cannot block.
+  if (m_pending.fetch_add(1, std::memory_order_relaxed) >= kMaxPendingLines) {
+    m_pending.fetch_sub(1, std::memory_order_relaxed);
+    s_droppedLines->increment();
+    return;
+  }
+  auto const entry = new Entry{nullptr, fd, std::move(line)};
+  auto head = m_queue.load(std::memory_order_relaxed);
+  do {
+    entry->m_next = head;
+  } while (!m_queue.compare_exchange_weak(head, entry,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
+
+void AsyncLogWriter::drain() {
+  auto entry = m_queue.exchange(nullptr, std::memory_order_acquire);
+  if (!entry) return;
+
+  // The list comes off the queue newest-first; reverse it so lines reach
+  // the file in enqueue order.
+  Entry* head = nullptr;
+  uint32_t count = 0;
+  while (entry) {
+    auto const next = entry->m_next;
+    entry->m_next = head;
+    head = entry;
+    entry = next;
+    ++count;
+  }
+
+  constexpr int kMaxIov = 64;
+  iovec iov[kMaxIov];
+  while (head) {
+    auto const fd = head->m_fd;
+    int niov = 0;
+    auto batchEnd = head;
+    while (batchEnd && batchEnd->m_fd == fd && niov < kMaxIov) {
+      iov[niov].iov_base = const_cast<char*>(batchEnd->m_line.data());
+      iov[niov].iov_len = batchEnd->m_line.size();
+      ++niov;
+      batchEnd = batchEnd->m_next;
+    }
+    // There is nothing useful to do on error; the lines are lost either
+    // way, and logging about it here could recurse.
+    UNUSED auto written = writev(fd, iov, niov);
+    while (head != batchEnd) {
+      auto const next = head->m_next;
+      delete head;
+      head = next;
+    }
+  }
+  m_pending.fetch_sub(count, std::memory_order_relaxed);
+}
+
+void AsyncLogWriter::flusherMain() {
+  std::unique_lock<std::mutex> lock(m_lock);
+  while (true) {
+    lock.unlock();
+    drain();
+    lock.lock();
+    ++m_drainPasses;
+    m_wakeup.notify_all();
+    m_wakeup.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs));
+  }
+}
+
+void AsyncLogWriter::flush() {
+  std::unique_lock<std::mutex> lock(m_lock);
+  // The pass in progress when we took the lock may have already swapped
+  // out the queue, so our lines are only guaranteed to be on disk after
+  // two further complete passes.
+  auto const target = m_drainPasses + 2;
+  m_wakeup.notify_all();
+  m_wakeup.wait(lock, [&] { return m_drainPasses >= target; });
+}
+
+//////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,88 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#ifndef incl_HPHP_ASYNC_LOG_WRITER_H_
+#define incl_HPHP_ASYNC_LOG_WRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace HPHP {
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * AsyncLogWriter moves log file I/O off the threads producing it.
+ *
+ * Producers hand over fully formatted lines with enqueue(), which pushes
+ * onto a lock-free list and never blocks: when the flusher falls behind and
+ * the backlog reaches kMaxPendingLines, further lines are dropped and
+ * counted (exported as "log_writer_dropped_lines") instead of queued. A
+ * single dedicated thread drains the list periodically and writes runs of
+ * consecutive same-fd lines with one writev(2) each.
+ *
+ * Producers do not signal the flusher -- that would reintroduce a mutex on
+ * the request path -- so a line can sit in the queue for up to
+ * kFlushIntervalMs before reaching the file. Call flush() where that
+ * matters (shutdown, log rotation); it blocks until everything enqueued
+ * before the call has been written.
+ *
+ * Lines enqueued for the same fd are written in enqueue order; lines for
+ * different fds may be reordered relative to each other.
+ */
+struct AsyncLogWriter {
+  // Set from Log.UseAsyncWriter; checked by callers deciding whether to
+  // hand lines to the writer or write synchronously.
+  static bool Enabled;
+
+  static AsyncLogWriter* Get();
+
+  void enqueue(int fd, std::string&& line);
+  void flush();
+
+  static constexpr uint32_t kMaxPendingLines = 64 * 1024;
+  static constexpr int kFlushIntervalMs = 50;
+
+private:
+  AsyncLogWriter();
+  ~AsyncLogWriter() = delete; // singleton; never destroyed
+
+  struct Entry {
+    Entry* m_next;
+    int m_fd;
+    std::string m_line;
+  };
+
+  void flusherMain();
+  void drain();
+
+  std::atomic<Entry*> m_queue{nullptr};
+  std::atomic<uint32_t> m_pending{0};
+
+  // Flusher parking and flush() rendezvous; never touched by enqueue().
+  std::mutex m_lock;
+  std::condition_variable m_wakeup;
+  uint64_t m_drainPasses{0};
+};
+
+//////////////////////////////////////////////////////////////////////
+
+}
+
+#endif
@@ -0,0 +1,414 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_UTIL_CONCURRENT_CLOCK_CACHE_H
+#define incl_HPHP_UTIL_CONCURRENT_CLOCK_CACHE_H
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <tbb/concurrent_hash_map.h>
+
+namespace HPHP {
+
+/**
+ * ConcurrentClockCache is a drop-in alternative to ConcurrentLRUCache that
+ * replaces the mutex-protected LRU list with CLOCK replacement. It exposes
+ * the same template interface (ConstAccessor, find(), insert(), clear(),
+ * snapshotKeys(), size()), so callers can switch between the two by
+ * changing a typedef.
+ *
+ * The difference is how recency is tracked. ConcurrentLRUCache promotes an
+ * entry to the head of a shared doubly-linked list on every hit, which
+ * requires a global mutex; under heavy read concurrency that mutex becomes
+ * the dominant point of contention. Here each entry instead owns a slot in
+ * a fixed ring of reference bits. A hit does a single relaxed atomic store
+ * to its slot, so the read path takes no locks beyond the TBB hash map's
+ * per-bucket read lock. Eviction sweeps a clock hand around the ring,
+ * clearing reference bits and reclaiming the first slot found unreferenced
+ * since the last sweep. This yields a rougher approximation of LRU than
+ * the list does, but one whose quality degrades gracefully rather than
+ * its throughput.
+ *
+ * The find() operation fills a ConstAccessor object, which is a smart
+ * pointer similar to TBB's const_accessor. After eviction, destruction of
+ * the value is deferred until all ConstAccessor objects are destroyed.
+ *
+ * The capacity is strict: unlike ConcurrentLRUCache there is no transient
+ * overfill, since an insert into a full cache claims its victim slot
+ * before publishing the new entry.
+ *
+ * As with ConcurrentLRUCache, the hash value of each key is requested
+ * multiple times, so you should use a key with a memoized hash function.
+ * clear() is not thread-safe.
+ */
+template <class TKey, class TValue, class THash = tbb::tbb_hash_compare<TKey>>
+struct ConcurrentClockCache {
+private:
+  /**
+   * A slot in the clock ring. m_state holds the occupancy/reference state;
+   * m_key is only written while the slot is exclusively claimed and only
+   * read by the evicting thread, so it needs no synchronization of its own.
+   */
+  struct Slot {
+    Slot() : m_state(kEmpty) {}
+
+    std::atomic<uint8_t> m_state;
+    TKey m_key;
+  };
+
+  // Slot states. A hit ORs kReferenced into an occupied slot; the clock
+  // hand strips it again as it sweeps past. kClaimed marks a slot owned
+  // exclusively by one inserting thread while it swaps keys.
+  static constexpr uint8_t kEmpty = 0;
+  static constexpr uint8_t kOccupied = 1;
+  static constexpr uint8_t kClaimed = 2;
+  static constexpr uint8_t kReferenced = 4;
+
+  /**
+   * The value that we store in the hashtable. Holds the slot index so a
+   * hit can set the entry's reference bit without touching shared state.
+   */
+  struct HashMapValue {
+    HashMapValue() : m_slot(0) {}
+
+    HashMapValue(const TValue& value, size_t slot)
+      : m_value(value)
+      , m_slot(slot)
+    {}
+
+    TValue m_value;
+    size_t m_slot;
+  };
+
+  typedef tbb::concurrent_hash_map<TKey, HashMapValue, THash> HashMap;
+  typedef typename HashMap::const_accessor HashMapConstAccessor;
+  typedef typename HashMap::accessor HashMapAccessor;
+  typedef typename HashMap::value_type HashMapValuePair;
+
+public:
+  /**
+   * The proxy object for TBB::CHM::const_accessor. Provides direct access
+   * to the user's value by dereferencing, thus hiding implementation
+   * details.
+   */
+  struct ConstAccessor {
+    ConstAccessor() {}
+
+    const TValue& operator*() const {
+      return *get();
+    }
+
+    const TValue* operator->() const {
+      return get();
+    }
+
+    const TValue* get() const {
+      return &m_hashAccessor->second.m_value;
+    }
+
+    bool empty() const {
+      return m_hashAccessor.empty();
+    }
+
+  private:
+    friend struct ConcurrentClockCache;
+    HashMapConstAccessor m_hashAccessor;
+  };
+
+  /**
+   * Create a container with a fixed maximum size.
+   */
+  explicit ConcurrentClockCache(size_t maxSize);
+
+  ConcurrentClockCache(const ConcurrentClockCache& other) = delete;
+  ConcurrentClockCache& operator=(const ConcurrentClockCache&) = delete;
+
+  ~ConcurrentClockCache() {
+    clear();
+  }
+
+  /**
+   * Find a value by key, and return it by filling the ConstAccessor, which
+   * will keep the returned value alive even if the entry is evicted
+   * concurrently. Returns true if the element was found, false otherwise.
+   * On a hit, sets the entry's reference bit; this is the only recency
+   * bookkeeping and involves no locks.
+   */
+  bool find(ConstAccessor& ac, const TKey& key);
+
+  /**
+   * Insert a value into the container. Both the key and value will be
+   * copied. If the cache is full, a victim chosen by the clock hand is
+   * evicted first. Returns false (without inserting) if the key is
+   * already present.
+   */
+  bool insert(const TKey& key, const TValue& value);
+
+  /**
+   * Clear the container. NOT THREAD SAFE -- do not use while other threads
+   * are accessing the container.
+   */
+  void clear();
+
+  /**
+   * Get a snapshot of the keys in the container by copying them into the
+   * supplied vector. The keys are not given in any particular order.
+   */
+  void snapshotKeys(std::vector<TKey>& keys);
+
+  /**
+   * Get the approximate size of the container. May be slightly too low
+   * when insertion is in progress.
+   */
+  size_t size() const {
+    return m_size.load(std::memory_order_relaxed);
+  }
+
+private:
+  /**
+   * Claim a slot for a new entry, evicting its previous occupant from the
+   * hash map if there was one. Returns the claimed slot's index; the slot
+   * is left in state kClaimed with m_key unset.
+   */
+  size_t claimSlot();
+
+  /**
+   * The maximum number of elements in the container; also the size of the
+   * clock ring.
+   */
+  size_t m_maxSize;
+
+  /**
+   * The current number of occupied slots.
+   */
+  std::atomic<size_t> m_size;
+
+  /**
+   * The underlying TBB hash map.
+   */
+  HashMap m_map;
+
+  /**
+   * The clock ring, one slot per cache entry.
+   */
+  std::vector<Slot> m_slots;
+
+  /**
+   * The clock hand. Monotonically increasing; taken modulo m_maxSize to
+   * index the ring.
+   */
+  std::atomic<size_t> m_clockHand;
+};
+
+template <class TKey, class TValue, class THash>
+ConcurrentClockCache<TKey, TValue, THash>::
+ConcurrentClockCache(size_t maxSize)
+  : m_maxSize(maxSize ? maxSize : 1)
+  , m_size(0)
+  , m_map(std::thread::hardware_concurrency() * 4) // it will automatically grow
+  , m_slots(m_maxSize)
+  , m_clockHand(0)
+{
+}
+
+template <class TKey, class TValue, class THash>
+bool ConcurrentClockCache<TKey, TValue, THash>::
+find(ConstAccessor& ac, const TKey& key) {
+  HashMapConstAccessor& hashAccessor = ac.m_hashAccessor;
+  if (!m_map.find(hashAccessor, key)) {
+    return false;
+  }
+
+  // Mark the entry as recently used. Unlike the LRU list promotion this is
+  // a single relaxed store; a stale slot index (the entry being evicted
+  // under us) at worst sets a spurious reference bit on the slot's new
+  // occupant.
+  auto& slot = m_slots[hashAccessor->second.m_slot];
+  auto state = slot.m_state.load(std::memory_order_relaxed);
+  if ((state & kReferenced) == 0) {
+    slot.m_state.fetch_or(kReferenced, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+template <class TKey, class TValue, class THash>
+size_t ConcurrentClockCache<TKey, TValue, THash>::claimSlot() {
+  // Sweep the clock hand. Each pass over a referenced slot strips its
+  // reference bit, so after at most one full revolution every slot has
+  // been given its "second chance" and some slot must be claimable --
+  // unless concurrent hits keep re-referencing everything. Past two
+  // revolutions we stop honoring reference bits to guarantee progress.
+  size_t iters = 0;
+  while (true) {
+    auto const idx = m_clockHand.fetch_add(1, std::memory_order_relaxed)
+                     % m_maxSize;
+    auto& slot = m_slots[idx];
+    auto state = slot.m_state.load(std::memory_order_relaxed);
+
+    if (state == kEmpty) {
+      if (slot.m_state.compare_exchange_strong(state, kClaimed,
+                                               std::memory_order_acq_rel)) {
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return idx;
+      }
+      continue;
+    }
+
+    if (state & kClaimed) {
+      continue;
+    }
+
+    if ((state & kReferenced) && iters++ < m_maxSize * 2) {
+      slot.m_state.fetch_and(uint8_t(~kReferenced),
+                             std::memory_order_relaxed);
+      continue;
+    }
+
+    if (slot.m_state.compare_exchange_strong(state, kClaimed,
+                                             std::memory_order_acq_rel)) {
+      // Evict the previous occupant. erase() takes the bucket's write
+      // lock, so destruction of the value is deferred until concurrent
+      // readers release their accessors.
+      m_map.erase(slot.m_key);
+      return idx;
+    }
+  }
+}
+
+template <class TKey, class TValue, class THash>
+bool ConcurrentClockCache<TKey, TValue, THash>::
+insert(const TKey& key, const TValue& value) {
+  HashMapAccessor hashAccessor;
+  HashMapValuePair hashMapValue(key, HashMapValue(value, 0));
+  if (!m_map.insert(hashAccessor, hashMapValue)) {
+    return false;
+  }
+
+  // We hold the new entry's write lock, so no reader can observe the slot
+  // index until it is final.
+  auto const idx = claimSlot();
+  auto& slot = m_slots[idx];
+  slot.m_key = key;
+  slot.m_state.store(kOccupied, std::memory_order_release);
+  hashAccessor->second.m_slot = idx;
+  return true;
+}
+
+template <class TKey, class TValue, class THash>
+void ConcurrentClockCache<TKey, TValue, THash>::clear() {
+  m_map.clear();
+  for (auto& slot : m_slots) {
+    slot.m_state.store(kEmpty, std::memory_order_relaxed);
+    slot.m_key = TKey();
+  }
+  m_size.store(0, std::memory_order_relaxed);
+  m_clockHand.store(0, std::memory_order_relaxed);
+}
+
+template <class TKey, class TValue, class THash>
+void ConcurrentClockCache<TKey, TValue, THash>::
+snapshotKeys(std::vector<TKey>& keys) {
+  for (auto& slot : m_slots) {
+    if (slot.m_state.load(std::memory_order_acquire) & kOccupied) {
+      keys.push_back(slot.m_key);
+    }
+  }
+}
+
+/**
+ * ConcurrentScalableClockCache shards a keyspace over a set of
+ * ConcurrentClockCaches, mirroring ConcurrentScalableCache. With CLOCK
+ * replacement the read path is already lock-free, so sharding mainly
+ * spreads insert/eviction traffic and the TBB bucket locks.
+ */
+template <class TKey, class TValue, class THash = tbb::tbb_hash_compare<TKey>>
+struct ConcurrentScalableClockCache {
+  using Shard = ConcurrentClockCache<TKey, TValue, THash>;
+  typedef typename Shard::ConstAccessor ConstAccessor;
+
+  /**
+   * Constructor
+   *   - maxSize: the maximum number of items in the container
+   *   - numShards: the number of child containers. If this is zero, the
+   *     "hardware concurrency" will be used (typically the logical
+   *     processor count).
+   */
+  explicit ConcurrentScalableClockCache(size_t maxSize, size_t numShards = 0)
+    : m_numShards(numShards)
+  {
+    if (m_numShards == 0) {
+      m_numShards = std::thread::hardware_concurrency();
+    }
+    for (size_t i = 0; i < m_numShards; i++) {
+      size_t s = maxSize / m_numShards;
+      if (i == 0) {
+        s += maxSize % m_numShards;
+      }
+      m_shards.emplace_back(std::make_shared<Shard>(s));
+    }
+  }
+
+  ConcurrentScalableClockCache(const ConcurrentScalableClockCache&) = delete;
+  ConcurrentScalableClockCache&
+  operator=(const ConcurrentScalableClockCache&) = delete;
+
+  Shard& getShard(const TKey& key) {
+    THash hashObj;
+    constexpr int shift = std::numeric_limits<size_t>::digits - 16;
+    size_t h = (hashObj.hash(key) >> shift) % m_numShards;
+    return *m_shards.at(h);
+  }
+
+  bool find(ConstAccessor& ac, const TKey& key) {
+    return getShard(key).find(ac, key);
+  }
+
+  bool insert(const TKey& key, const TValue& value) {
+    return getShard(key).insert(key, value);
+  }
+
+  void clear() {
+    for (size_t i = 0; i < m_numShards; i++) {
+      m_shards.at(i)->clear();
+    }
+  }
+
+  void snapshotKeys(std::vector<TKey>& keys) {
+    for (size_t i = 0; i < m_numShards; i++) {
+      m_shards.at(i)->snapshotKeys(keys);
+    }
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (size_t i = 0; i < m_numShards; i++) {
+      size += m_shards.at(i)->size();
+    }
+    return size;
+  }
+
+private:
+  size_t m_numShards;
+  std::vector<std::shared_ptr<Shard>> m_shards;
+};
+
+} // namespace HPHP
+
+#endif // incl_HPHP_UTIL_CONCURRENT_CLOCK_CACHE_H
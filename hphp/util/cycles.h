@@ -54,6 +54,26 @@ inline uint64_t cpuCycles() {
 #endif
 }
 
+/*
+ * Like cpuCycles(), but serialized against earlier instructions: the read
+ * cannot be hoisted above loads and stores that precede it in program
+ * order. Use this when bracketing a measured region; the plain read is
+ * cheaper when a few cycles of skew don't matter.
+ */
+inline uint64_t cpuCyclesSerialized() {
+#ifdef __x86_64__
+  uint64_t lo, hi;
+  uint32_t aux;
+  asm volatile("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux));
+  return lo | (hi << 32);
+#elif _MSC_VER
+  unsigned int aux;
+  return (uint64_t)__rdtscp(&aux);
+#else
+  return cpuCycles();
+#endif
+}
+
 inline void cpuRelax() {
   folly::asm_volatile_pause();
 }
@@ -17,9 +17,14 @@
 #ifndef incl_HPHP_UTIL_JOB_QUEUE_H_
 #define incl_HPHP_UTIL_JOB_QUEUE_H_
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <time.h>
+#include <type_traits>
 #include <vector>
 
 #include <boost/range/adaptors.hpp>
@@ -184,6 +189,20 @@ public:
   void waitEmpty() {}
   void signalEmpty() {}
 
+  /**
+   * Ask up to n idle workers to leave their dequeue loop by throwing
+   * StopSignal, without stopping the queue.  Workers in the middle of a
+   * job are unaffected; if fewer than n workers are idle right now, the
+   * remaining requests are picked up by the next workers that find the
+   * queue empty.
+   */
+  void retireWorkers(int n) {
+    if (n <= 0) return;
+    Lock lock(this);
+    m_retireCount += n;
+    notifyAll();
+  }
+
   /**
    * Keeps track of how many active workers are working on the queue.
    */
@@ -218,7 +237,7 @@ public:
     return iter;
   }
 
- private:
+ protected:
   friend class JobQueue_Expiration_Test;
   TJob dequeueMaybeExpiredImpl(int id, int q, bool inc, const timespec& now,
                                bool* expired, bool highPri = false) {
@@ -238,6 +257,9 @@ public:
       if (m_stopped) {
         throw StopSignal();
       }
+      if (m_jobCount == 0 && tryRetire()) {
+        throw StopSignal();
+      }
       if (highPri) {
         wait(id, q, Priority::High);
       } else {
@@ -340,9 +362,19 @@ public:
     throw StopSignal();
   }
 
-  int m_jobCount;
+  // Claim one of the outstanding retirement requests, if any.
+  bool tryRetire() {
+    auto count = m_retireCount.load();
+    while (count > 0) {
+      if (m_retireCount.compare_exchange_weak(count, count - 1)) return true;
+    }
+    return false;
+  }
+
+  std::atomic<int> m_jobCount;
   std::vector<std::deque<std::pair<TJob, timespec>>> m_jobQueues;
-  bool m_stopped;
+  std::atomic<bool> m_stopped;
+  std::atomic<int> m_retireCount{0};
   std::atomic<int> m_workerCount;
   const int m_dropCacheTimeout;
   const bool m_dropStack;
@@ -393,6 +425,275 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * A work-stealing variant of JobQueue for queues with very high
+ * enqueue/dequeue rates.
+ *
+ * Each worker owns a small bounded deque with its own mutex and condition
+ * variable.  Normal-priority jobs are placed directly into a worker's deque
+ * and wake only that worker, so in the common case both ends of the queue
+ * touch an uncontended lock and nobody else's condition variable.  When
+ * every local deque is full or busy, jobs overflow into the inherited
+ * shared queue, and idle workers pull from the overflow or steal the
+ * oldest job from a sibling before going to sleep.
+ *
+ * Expiry, LIFO switching, health-based backoff, drop-cache flushing, and
+ * the waitable interface all behave as in the base class.  Two caveats:
+ * jobs sitting in a local deque are invisible to the job reaper until a
+ * worker touches them (the small deque bound keeps that window short), and
+ * the wakeup-priority hint is ignored since wakeups are targeted.
+ */
+template<typename TJob,
+         bool waitable = false,
+         class DropCachePolicy = detail::NoDropCachePolicy>
+struct StealingJobQueue : JobQueue<TJob, waitable, DropCachePolicy> {
+  using Base = JobQueue<TJob, waitable, DropCachePolicy>;
+
+  // Keep local deques short so almost all queueing under load happens in
+  // the shared queue, where the reaper and expiry logic can see it.
+  static constexpr unsigned kLocalQueueCap = 4;
+
+  StealingJobQueue(int maxThreadCount, int dropCacheTimeout,
+                   bool dropStack, int lifoSwitchThreshold=INT_MAX,
+                   int maxJobQueuingMs = -1, int numPriorities = 1,
+                   int queuedJobsReleaseRate = 3,
+                   IHostHealthObserver* healthStatus = nullptr)
+    : Base(maxThreadCount, dropCacheTimeout, dropStack, lifoSwitchThreshold,
+           maxJobQueuingMs, numPriorities, queuedJobsReleaseRate,
+           healthStatus),
+      m_slots(maxThreadCount) {
+  }
+
+  /**
+   * Put a job into some worker's local deque and wake just that worker,
+   * overflowing to the shared queue when the local deques are full or
+   * contended.
+   */
+  void enqueue(TJob job, int priority = 0) {
+    if (priority != 0) {
+      // Priorities above normal are rare; keep them in the shared queue
+      // where dequeueing scans highest-priority-first.
+      Base::enqueue(job, priority);
+      wakeAnyWorker();
+      return;
+    }
+    timespec enqueueTime;
+    Timer::GetMonotonicTime(enqueueTime);
+    auto const n = m_slots.size();
+    auto const start = m_nextSlot.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      auto& slot = m_slots[(start + i) % n];
+      // Never queue into a slot whose worker hasn't started (workers can
+      // be added lazily); those jobs could strand until it does.
+      if (!slot.attached.load(std::memory_order_acquire)) continue;
+      std::unique_lock<std::mutex> l(slot.mutex, std::try_to_lock);
+      // Recheck attached under the lock: retirement detaches the slot
+      // while holding its mutex, so we can't land a job after the
+      // worker has gone away.
+      if (!l.owns_lock() ||
+          !slot.attached.load(std::memory_order_acquire) ||
+          slot.jobs.size() >= kLocalQueueCap) {
+        continue;
+      }
+      slot.jobs.emplace_back(job, enqueueTime);
+      ++this->m_jobCount;
+      if (slot.sleeping) slot.cv.notify_one();
+      return;
+    }
+    Base::enqueue(job, 0);
+    wakeAnyWorker();
+  }
+
+  TJob dequeueMaybeExpired(int id, int q, bool inc, bool* expired,
+                           bool highpri = false) {
+    if (id == this->m_jobReaperId) {
+      return Base::dequeueMaybeExpired(id, q, inc, expired, highpri);
+    }
+    *expired = false;
+    assert(id >= 0 && id < static_cast<int>(m_slots.size()));
+    auto& slot = m_slots[id];
+    slot.attached.store(true, std::memory_order_release);
+    bool flushed = false;
+    for (;;) {
+      timespec now;
+      Timer::GetMonotonicTime(now);
+      // With a single priority the shared queue serves jobs even in
+      // BackOff (its highest priority queue is the only queue); with
+      // several, BackOff restricts us to the highest one.
+      bool const ableToDeque =
+        this->m_jobQueues.size() == 1 ||
+        this->m_healthStatus == nullptr ||
+        this->m_healthStatus->getHealthLevel() != HealthLevel::BackOff;
+
+      TJob job;
+      bool got = ableToDeque
+        ? (tryPopLocal(slot, now, expired, job) ||
+           tryPopShared(now, expired, job, false) ||
+           trySteal(id, now, expired, job))
+        : tryPopShared(now, expired, job, true);
+      if (got) {
+        if (inc) this->incActiveWorker();
+        return job;
+      }
+
+      if (this->m_stopped) throw typename Base::StopSignal();
+
+      std::unique_lock<std::mutex> l(slot.mutex);
+      if (!slot.jobs.empty()) continue;
+      if (this->m_jobCount.load() == 0 && this->tryRetire()) {
+        // Detach so enqueuers stop targeting this slot; a replacement
+        // worker reusing the id reattaches on its first dequeue.
+        slot.attached.store(false, std::memory_order_release);
+        throw typename Base::StopSignal();
+      }
+      slot.sleeping = true;
+      // Recheck after publishing that we're asleep: enqueuers bump
+      // m_jobCount before they scan for sleepers, so one of the two
+      // sides always notices the other.
+      if (this->m_stopped ||
+          (ableToDeque && this->m_jobCount.load() > 0) ||
+          (!ableToDeque && topPriorityPending())) {
+        slot.sleeping = false;
+        continue;
+      }
+      if (this->m_dropCacheTimeout <= 0 || flushed) {
+        slot.cv.wait(l);
+      } else if (slot.cv.wait_for(
+                   l, std::chrono::seconds(this->m_dropCacheTimeout)) ==
+                 std::cv_status::timeout) {
+        // since we timed out, maybe we can turn idle without holding memory
+        if (this->m_jobCount.load() == 0) {
+          slot.sleeping = false;
+          l.unlock();
+          flush_thread_caches();
+          if (this->m_dropStack && s_stackLimit) {
+            flush_thread_stack();
+          }
+          DropCachePolicy::dropCache();
+          flushed = true;
+          continue;
+        }
+      }
+      slot.sleeping = false;
+    }
+  }
+
+  void stop() {
+    Base::stop();
+    for (auto& slot : m_slots) {
+      std::lock_guard<std::mutex> l(slot.mutex);
+      slot.cv.notify_all();
+    }
+  }
+
+  void retireWorkers(int n) {
+    Base::retireWorkers(n);
+    if (n <= 0) return;
+    for (auto& slot : m_slots) {
+      std::lock_guard<std::mutex> l(slot.mutex);
+      slot.cv.notify_all();
+    }
+  }
+
+  int releaseQueuedJobs() {
+    int toRelease = this->m_queuedJobsReleaser->numOfJobsToRelease();
+    int released = 0;
+    for (auto& slot : m_slots) {
+      if (released >= toRelease ||
+          released >= this->m_jobCount.load()) {
+        break;
+      }
+      std::lock_guard<std::mutex> l(slot.mutex);
+      if (slot.sleeping) {
+        slot.cv.notify_one();
+        ++released;
+      }
+    }
+    return released;
+  }
+
+ private:
+  struct Slot {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<TJob, timespec>> jobs;
+    bool sleeping{false};
+    std::atomic<bool> attached{false};  // has a worker ever serviced this?
+  };
+
+  void wakeAnyWorker() {
+    for (auto& slot : m_slots) {
+      std::lock_guard<std::mutex> l(slot.mutex);
+      if (slot.sleeping) {
+        slot.cv.notify_one();
+        return;
+      }
+    }
+  }
+
+  bool popFrom(std::deque<std::pair<TJob, timespec>>& jobs,
+               const timespec& now, bool* expired, TJob& job,
+               bool allowLifo) {
+    if (jobs.empty()) return false;
+    if (this->m_maxJobQueuingMs > 0 &&
+        gettime_diff_us(jobs.front().second, now) >
+        this->m_maxJobQueuingMs * 1000) {
+      *expired = true;
+      job = jobs.front().first;
+      jobs.pop_front();
+    } else if (allowLifo &&
+               this->m_jobCount.load() >= this->m_lifoSwitchThreshold) {
+      job = jobs.back().first;
+      jobs.pop_back();
+    } else {
+      job = jobs.front().first;
+      jobs.pop_front();
+    }
+    --this->m_jobCount;
+    return true;
+  }
+
+  bool tryPopLocal(Slot& slot, const timespec& now, bool* expired,
+                   TJob& job) {
+    std::lock_guard<std::mutex> l(slot.mutex);
+    return popFrom(slot.jobs, now, expired, job, true);
+  }
+
+  bool tryPopShared(const timespec& now, bool* expired, TJob& job,
+                    bool onlyTopPriority) {
+    Lock lock(this);
+    if (onlyTopPriority) {
+      return popFrom(this->m_jobQueues.back(), now, expired, job, true);
+    }
+    for (auto& jobs : boost::adaptors::reverse(this->m_jobQueues)) {
+      if (popFrom(jobs, now, expired, job, true)) return true;
+    }
+    return false;
+  }
+
+  bool trySteal(int id, const timespec& now, bool* expired, TJob& job) {
+    auto const n = m_slots.size();
+    for (size_t i = 1; i < n; ++i) {
+      auto& victim = m_slots[(id + i) % n];
+      std::unique_lock<std::mutex> l(victim.mutex, std::try_to_lock);
+      if (!l.owns_lock()) continue;
+      // always steal the oldest job, to preserve rough FIFO fairness
+      if (popFrom(victim.jobs, now, expired, job, false)) return true;
+    }
+    return false;
+  }
+
+  bool topPriorityPending() {
+    Lock lock(this);
+    return !this->m_jobQueues.back().empty();
+  }
+
+  std::vector<Slot> m_slots;
+  std::atomic<size_t> m_nextSlot{0};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 /**
  * Base class for a customized worker.
  *
@@ -403,11 +704,15 @@ template<typename TJob,
          typename TContext = void*,
          bool countActive = false,
          bool waitable = false,
-         class Policy = detail::NoDropCachePolicy>
+         class Policy = detail::NoDropCachePolicy,
+         bool stealing = false>
 struct JobQueueWorker {
   typedef TJob JobType;
   typedef TContext ContextType;
-  typedef JobQueue<TJob, waitable, Policy> QueueType;
+  typedef typename std::conditional<
+    stealing,
+    StealingJobQueue<TJob, waitable, Policy>,
+    JobQueue<TJob, waitable, Policy>>::type QueueType;
   typedef Policy DropCachePolicy;
 
   static const bool Waitable = waitable;
@@ -485,6 +790,8 @@ struct JobQueueWorker {
     m_stopped = true;
   }
 
+  int getId() const { return m_id; }
+
 protected:
   int m_id{-1};
   void* m_func{nullptr};
@@ -636,6 +943,37 @@ struct JobQueueDispatcher : IHostHealthObserver {
     }
   }
 
+  /*
+   * Decrease the limit on number of workers by n, keeping at least one,
+   * and ask that many idle workers to exit.  Busy workers finish their
+   * current job first; their threads are reaped on a later scaling tick.
+   */
+  void removeWorkers(int n) {
+    Lock lock(m_mutex);
+    if (m_stopped) return;
+    n = std::min(n, m_currThreadCountLimit - 1);
+    if (n <= 0) return;
+    m_currThreadCountLimit -= n;
+    m_queue.retireWorkers(n);
+  }
+
+  /*
+   * Let the host health monitor drive the size of the worker pool.  Once
+   * this dispatcher is subscribed to the monitor, every status tick runs
+   * one step of a control loop: when jobs are queueing and the host still
+   * has CPU and memory headroom we grow right away, and when the demand
+   * peak over the trailing window stayed below the number of running
+   * threads we retire the surplus (the window is the hysteresis, so a
+   * momentary lull doesn't tear down threads a burst will want back).
+   * The pool never shrinks below minThreads and never grows beyond
+   * maxThreadCount.
+   */
+  void enableWorkerScaling(int minThreads) {
+    Lock lock(m_mutex);
+    m_scaleMinThreads =
+      std::min(std::max(minThreads, 1), m_maxThreadCount);
+  }
+
   void getWorkers(std::vector<TWorker*> &workers) {
     Lock lock(m_mutex);
     workers.insert(workers.end(), m_workers.begin(), m_workers.end());
@@ -700,13 +1038,14 @@ struct JobQueueDispatcher : IHostHealthObserver {
   }
 
   void notifyNewStatus(HealthLevel newStatus) override {
-    bool curStopDequeue = (newStatus == HealthLevel::BackOff);
-    if (!curStopDequeue) {
-      // release blocked requests in queue if any
+    if (m_healthStatus == HealthLevel::BackOff &&
+        newStatus != HealthLevel::BackOff) {
+      // release requests that blocked in the queue while we backed off
       m_queue.releaseQueuedJobs();
     }
-
     m_healthStatus = newStatus;
+
+    if (m_scaleMinThreads > 0) scaleWorkers(newStatus);
   }
 
   HealthLevel getHealthLevel() override {
@@ -718,6 +1057,10 @@ struct JobQueueDispatcher : IHostHealthObserver {
   }
 
 private:
+  // Health monitor ticks (~1s each at the default update frequency) a
+  // worker surplus must persist before we start shrinking the pool.
+  static constexpr int kScaleWindowTicks = 30;
+
   bool m_stopped;
   HealthLevel m_healthStatus;
   int m_id;
@@ -727,9 +1070,11 @@ private:
   int m_hugeThreadCount{0};
   const bool m_startReaperThread;
   int m_queueToWorkerRatio{1};
-  JobQueue<typename TWorker::JobType,
-           TWorker::Waitable,
-           typename TWorker::DropCachePolicy> m_queue;
+  int m_scaleMinThreads{0};             // > 0 enables autoscaling
+  int m_scaleSurplusTicks{0};
+  int m_scalePeakDemand{0};
+  std::vector<int> m_freeIds;           // worker ids freed by retirement
+  typename TWorker::QueueType m_queue;
 
   Mutex m_mutex;
   std::set<TWorker*> m_workers;
@@ -746,6 +1091,74 @@ private:
     return m_maxThreadCount;
   }
 
+  // One step of the worker-pool control loop, invoked from the health
+  // monitor thread via notifyNewStatus(); keep it cheap.
+  void scaleWorkers(HealthLevel host) {
+    Lock lock(m_mutex);
+    if (m_stopped) return;
+    reapWorkers();
+
+    auto const running = static_cast<int>(m_workers.size());
+    auto const r = m_queueToWorkerRatio;
+    auto const demand = getActiveWorker() + (getQueuedJobs() + r - 1) / r;
+
+    // Grow immediately while the host still has headroom; CPU or memory
+    // pressure (Cautious or worse) stops us from adding fuel to the fire.
+    if (demand > running && host < HealthLevel::Cautious) {
+      auto const target = std::min(demand, m_maxThreadCount);
+      if (m_currThreadCountLimit < target) m_currThreadCountLimit = target;
+      while (static_cast<int>(m_workers.size()) < target) {
+        addWorkerImpl(true);
+      }
+      m_scaleSurplusTicks = 0;
+      m_scalePeakDemand = 0;
+      return;
+    }
+
+    // Shrink with hysteresis: only after the demand peak over a full
+    // window stayed below the running count.  When the host is out of
+    // memory or CPU (NoMore or worse), aim straight for the floor; note
+    // that only idle workers actually retire, busy ones finish first.
+    m_scalePeakDemand = std::max(m_scalePeakDemand, demand);
+    auto const target = host >= HealthLevel::NoMore
+      ? m_scaleMinThreads
+      : std::max(m_scalePeakDemand, m_scaleMinThreads);
+    if (running <= target) {
+      m_scaleSurplusTicks = 0;
+      m_scalePeakDemand = demand;
+      return;
+    }
+    if (++m_scaleSurplusTicks < kScaleWindowTicks) return;
+    m_currThreadCountLimit = target;
+    m_queue.retireWorkers(running - target);
+    m_scaleSurplusTicks = 0;
+    m_scalePeakDemand = 0;
+  }
+
+  // Join and free workers whose threads exited after retireWorkers(), so
+  // m_workers reflects what actually runs and ids can be reused.  The
+  // caller must hold m_mutex.
+  void reapWorkers() {
+    for (auto it = m_funcs.begin(); it != m_funcs.end();) {
+      auto const func = *it;
+      if (!func->finished()) {
+        ++it;
+        continue;
+      }
+      try {
+        func->waitForEnd();
+      } catch (Exception& e) {
+        Logger::Error("worker thread exited: %s", e.getMessage().c_str());
+      }
+      auto const worker = func->getObject();
+      m_freeIds.push_back(worker->getId());
+      m_workers.erase(worker);
+      delete worker;
+      delete func;
+      it = m_funcs.erase(it);
+    }
+  }
+
   // Cannot be called concurrently (callers should hold m_mutex, or
   // otherwise ensure that no other threads are calling this).
   void addWorkerImpl(bool start) {
@@ -759,7 +1172,15 @@ private:
       new AsyncFunc<TWorker>(worker, &TWorker::start);
     m_workers.insert(worker);
     m_funcs.insert(func);
-    int id = m_id++;
+    int id;
+    if (!m_freeIds.empty()) {
+      // Reuse the id of a retired worker: ids index per-worker state in
+      // the queue and must stay below maxThreadCount.
+      id = m_freeIds.back();
+      m_freeIds.pop_back();
+    } else {
+      id = m_id++;
+    }
     worker->create(id, &m_queue, func, m_context);
 
     if (start) {
@@ -25,6 +25,9 @@ LockProfiler::PFUNC_PROFILE LockProfiler::s_pfunc_profile = nullptr;
 bool LockProfiler::s_profile = false;
 int LockProfiler::s_profile_sampling = 1000;
 
+MutexContentionProfiler::PFUNC_CONTEND
+MutexContentionProfiler::s_pfunc_contend = nullptr;
+
 LockProfiler::LockProfiler(bool profile) : m_profiling(false) {
   if (s_profile && s_pfunc_profile && profile &&
       s_profile_sampling && (rand() % s_profile_sampling) == 0) {
@@ -115,10 +115,11 @@ private:
   Mutex &m_mutex;
 };
 
-struct SimpleConditionalLock : BaseConditionalLock<SimpleMutex> {
-  SimpleConditionalLock(SimpleMutex &mutex,
-                        bool condition, bool profile = true)
-    : BaseConditionalLock<SimpleMutex>(mutex, condition, profile)
+template <typename MutexT>
+struct SimpleConditionalLockBase : BaseConditionalLock<MutexT> {
+  SimpleConditionalLockBase(MutexT &mutex,
+                            bool condition, bool profile = true)
+    : BaseConditionalLock<MutexT>(mutex, condition, profile)
   {
     if (condition) {
       mutex.assertOwnedBySelf();
@@ -126,11 +127,17 @@ struct SimpleConditionalLock : BaseConditionalLock<SimpleMutex> {
   }
 };
 
-struct SimpleLock : SimpleConditionalLock {
-  explicit SimpleLock(SimpleMutex &mutex, bool profile = true)
-    : SimpleConditionalLock(mutex, true, profile) {}
+template <typename MutexT>
+struct SimpleLockBase : SimpleConditionalLockBase<MutexT> {
+  explicit SimpleLockBase(MutexT &mutex, bool profile = true)
+    : SimpleConditionalLockBase<MutexT>(mutex, true, profile) {}
 };
 
+using SimpleConditionalLock = SimpleConditionalLockBase<SimpleMutex>;
+using SimpleLock = SimpleLockBase<SimpleMutex>;
+using SimpleAdaptiveLock = SimpleLockBase<SimpleAdaptiveMutex>;
+using AdaptiveLock = SimpleLockBase<AdaptiveMutex>;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 struct ReadLock {
@@ -173,6 +180,46 @@ private:
   ReadWriteMutex& m_mutex;
 };
 
+struct SharedReadLock {
+  explicit SharedReadLock(SharedReadWriteMutex& mutex, bool profile = true)
+    : m_profiler(profile)
+    , m_mutex(mutex)
+  {
+    m_mutex.acquireRead();
+  }
+
+  SharedReadLock(const SharedReadLock&) = delete;
+  SharedReadLock& operator=(const SharedReadLock&) = delete;
+
+  ~SharedReadLock() {
+    m_mutex.releaseRead();
+  }
+
+private:
+  LockProfiler m_profiler;
+  SharedReadWriteMutex& m_mutex;
+};
+
+struct SharedWriteLock {
+  explicit SharedWriteLock(SharedReadWriteMutex& mutex, bool profile = true)
+    : m_profiler(profile)
+    , m_mutex(mutex)
+  {
+    m_mutex.acquireWrite();
+  }
+
+  SharedWriteLock(const SharedWriteLock&) = delete;
+  SharedWriteLock& operator=(const SharedWriteLock&) = delete;
+
+  ~SharedWriteLock() {
+    m_mutex.releaseWrite();
+  }
+
+private:
+  LockProfiler m_profiler;
+  SharedReadWriteMutex& m_mutex;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 }
 
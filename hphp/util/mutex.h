@@ -21,15 +21,31 @@
 #include <time.h>
 #include <thread>
 
+#include <folly/SharedMutex.h>
 #include <tbb/concurrent_hash_map.h>
 
 #include "hphp/util/portability.h"
 #include "hphp/util/assertions.h"
+#include "hphp/util/cycles.h"
 #include "hphp/util/rank.h"
+#include "hphp/util/timer.h"
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Hook for lock-contention profiling. While a callback is installed,
+ * every mutex acquisition that cannot take the lock on the first try
+ * reports the mutex address and the microseconds spent waiting;
+ * aggregation (symbolizing the owner, ranking sites) is left to the
+ * installer. Kept null in production, where the only cost on the
+ * acquisition path is one predicted-untaken branch.
+ */
+struct MutexContentionProfiler {
+  typedef void (*PFUNC_CONTEND)(const void* mutex, int64_t wait_us);
+  static PFUNC_CONTEND s_pfunc_contend;
+};
+
 template <bool enableAssertions>
 struct BaseMutex {
 private:
@@ -146,13 +162,32 @@ public:
     assert(m_magic == kMagic);
     checkRank(m_rank);
 #endif
-    UNUSED int ret = pthread_mutex_lock(&m_mutex);
-    assert(ret == 0);
+    if (UNLIKELY(MutexContentionProfiler::s_pfunc_contend != nullptr)) {
+      lockContended();
+    } else {
+      UNUSED int ret = pthread_mutex_lock(&m_mutex);
+      assert(ret == 0);
+    }
 
     recordAcquisition();
     assertOwnedBySelf();
   }
 
+private:
+  NEVER_INLINE void lockContended() {
+    if (!pthread_mutex_trylock(&m_mutex)) return; // uncontended
+    timespec wait_begin;
+    gettime(CLOCK_MONOTONIC, &wait_begin);
+    UNUSED int ret = pthread_mutex_lock(&m_mutex);
+    assert(ret == 0);
+    timespec wait_end;
+    gettime(CLOCK_MONOTONIC, &wait_end);
+    MutexContentionProfiler::s_pfunc_contend(
+      this, gettime_diff_us(wait_begin, wait_end));
+  }
+
+public:
+
   void unlock() {
 #ifdef DEBUG
     assert(m_magic == kMagic);
@@ -190,6 +225,43 @@ struct SimpleMutex : BaseMutex<true> {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Mutex that makes a bounded number of trylock attempts, pausing the cpu
+ * between them, before parking in the kernel. For sub-microsecond
+ * critical sections under light contention the owner usually unlocks
+ * within the spin budget, saving both futex round trips; longer waits
+ * fall through to an ordinary blocking lock rather than burning the
+ * core. Always non-recursive.
+ */
+template <bool enableAssertions>
+struct BaseAdaptiveMutex : BaseMutex<enableAssertions> {
+  explicit BaseAdaptiveMutex(Rank rank = RankUnranked)
+    : BaseMutex<enableAssertions>(false /* recursive */, rank) {}
+
+  void lock() {
+    for (int i = 0; i < kSpinLimit; ++i) {
+      if (this->tryLock()) return;
+      cpuRelax();
+    }
+    BaseMutex<enableAssertions>::lock();
+  }
+
+private:
+  static constexpr int kSpinLimit = 40;
+};
+
+struct AdaptiveMutex : BaseAdaptiveMutex<false> {
+  explicit AdaptiveMutex(Rank rank = RankUnranked)
+    : BaseAdaptiveMutex<false>(rank) {}
+};
+
+struct SimpleAdaptiveMutex : BaseAdaptiveMutex<true> {
+  explicit SimpleAdaptiveMutex(Rank rank = RankUnranked)
+    : BaseAdaptiveMutex<true>(rank) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 /**
  * Read-write lock wrapper.
  */
@@ -286,6 +358,30 @@ private:
   pthread_rwlock_t m_rwlock;
 };
 
+/**
+ * Shared/exclusive mutex for read-mostly data. folly::SharedMutex keeps
+ * reader state in core-local slots, so uncontended shared acquisitions
+ * don't bounce a cache line between readers the way pthread_rwlock_t's
+ * central reader count does, and it spins briefly before parking.
+ * Unlike ReadWriteMutex, release is side-specific; use SharedReadLock /
+ * SharedWriteLock from lock.h, or pair the calls by hand.
+ */
+struct SharedReadWriteMutex {
+  SharedReadWriteMutex() {}
+  SharedReadWriteMutex(const SharedReadWriteMutex&) = delete;
+  SharedReadWriteMutex& operator=(const SharedReadWriteMutex&) = delete;
+
+  void acquireRead() { m_lock.lock_shared(); }
+  void acquireWrite() { m_lock.lock(); }
+  bool attemptRead() { return m_lock.try_lock_shared(); }
+  bool attemptWrite() { return m_lock.try_lock(); }
+  void releaseRead() { m_lock.unlock_shared(); }
+  void releaseWrite() { m_lock.unlock(); }
+
+private:
+  folly::SharedMutex m_lock;
+};
+
 /*
  * A ranked wrapper around tbb::concurrent_hash_map.
  */
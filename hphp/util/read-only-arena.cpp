@@ -17,6 +17,10 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #include <folly/Exception.h>
 #include <folly/portability/SysMman.h>
 
@@ -44,12 +48,22 @@ void checked_mprotect(void* addr, size_t size, int prot) {
                      rval);
 }
 
+/*
+ * Fraction of the minimal chunk size handed to a thread when its local
+ * region runs dry.  Large enough to keep lock acquisitions rare, small
+ * enough that the tail wasted when a thread stops allocating is modest.
+ */
+constexpr size_t kLocalRegionDivisor = 8;
+
+std::atomic<unsigned> s_nextArenaId{0};
+
 }
 
 //////////////////////////////////////////////////////////////////////
 
 ReadOnlyArena::ReadOnlyArena(size_t minChunkSize)
   : m_minChunkSize((minChunkSize + (s_pageSize - 1)) & ~(s_pageSize - 1))
+  , m_id(s_nextArenaId.fetch_add(1, std::memory_order_relaxed))
   , m_frontier(nullptr)
   , m_end(nullptr)
 {
@@ -64,31 +78,57 @@ ReadOnlyArena::~ReadOnlyArena() {
 }
 
 const void* ReadOnlyArena::allocate(const void* data, size_t dataLen) {
-  guard g(m_mutex);
-
   // Round up to the minimal alignment.
   auto alignedLen =
     (dataLen + (kMinimalAlignment - 1)) & ~(kMinimalAlignment - 1);
 
-  ensureFree(alignedLen);
-  always_assert(m_frontier + alignedLen <= m_end);
+  auto& local = localRegion();
+  if (static_cast<size_t>(local.end - local.frontier) < alignedLen) {
+    guard g(m_mutex);
+    refillLocal(local, alignedLen);
+  }
+  always_assert(local.frontier + alignedLen <= local.end);
 
-  auto const ret = m_frontier;
+  auto const ret = local.frontier;
   assert((uintptr_t(ret) & (kMinimalAlignment - 1)) == 0);
 
-  m_frontier += alignedLen;
+  local.frontier += alignedLen;
 
+  // The region is page granular and private to this thread, so flipping
+  // protection on our own pages can't race with another thread's copy.
   auto pageAddr = reinterpret_cast<unsigned char*>(
     uintptr_t(ret) & ~(s_pageSize - 1)
   );
-  checked_mprotect(pageAddr, m_frontier - pageAddr, PROT_WRITE|PROT_READ);
+  checked_mprotect(pageAddr, local.frontier - pageAddr, PROT_WRITE|PROT_READ);
   auto const ucData = static_cast<const unsigned char*>(data);
   std::copy(ucData, ucData + dataLen, ret);
-  checked_mprotect(pageAddr, m_frontier - pageAddr, PROT_READ);
+  checked_mprotect(pageAddr, local.frontier - pageAddr, PROT_READ);
 
   return ret;
 }
 
+ReadOnlyArena::LocalRegion& ReadOnlyArena::localRegion() const {
+  static thread_local std::vector<LocalRegion> tl_regions;
+  if (tl_regions.size() <= m_id) tl_regions.resize(m_id + 1);
+  return tl_regions[m_id];
+}
+
+// Pre: mutex held.  Replaces the thread's region with a fresh page-aligned
+// one big enough for `bytes'; whatever was left in the old region is
+// abandoned.
+//
+// Post: local.end - local.frontier >= bytes
+void ReadOnlyArena::refillLocal(LocalRegion& local, size_t bytes) {
+  auto regionSize = std::max(bytes, m_minChunkSize / kLocalRegionDivisor);
+  regionSize = (regionSize + (s_pageSize - 1)) & ~(s_pageSize - 1);
+  ensureFree(regionSize);
+  always_assert(m_frontier + regionSize <= m_end);
+  assert((uintptr_t(m_frontier) & (s_pageSize - 1)) == 0);
+  local.frontier = m_frontier;
+  local.end = m_frontier + regionSize;
+  m_frontier += regionSize;
+}
+
 // Pre: mutex already held, or no other threads may be able to access this
 // (i.e. it's the ctor).
 //
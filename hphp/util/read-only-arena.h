@@ -38,6 +38,11 @@ namespace HPHP {
  * writable and put the data in there, then mprotect it back to read only.
  *
  * One read only arena may safely be concurrently accessed by multiple threads.
+ *
+ * Threads bump-allocate out of private, page-aligned regions and only take
+ * the arena lock to carve a new region out of the shared chunk, so
+ * allocations from different threads are not contiguous and a region's tail
+ * may be wasted when it can't fit a request.
  */
 struct ReadOnlyArena {
   /*
@@ -79,10 +84,23 @@ struct ReadOnlyArena {
   const void* allocate(const void* data, size_t dataLen);
 
 private:
+  /*
+   * A thread's private piece of a chunk.  Regions are page-aligned and a
+   * multiple of the page size, so no two threads ever mprotect the same
+   * page.
+   */
+  struct LocalRegion {
+    unsigned char* frontier{nullptr};
+    unsigned char* end{nullptr};
+  };
+
+  LocalRegion& localRegion() const;
+  void refillLocal(LocalRegion& local, size_t bytes);
   void ensureFree(size_t bytes);
 
 private:
   size_t const m_minChunkSize;
+  unsigned const m_id;
 
   mutable std::mutex m_mutex;
   unsigned char* m_frontier;
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 #include <folly/Bits.h>
 #include <folly/portability/PThread.h>
@@ -146,5 +147,96 @@ ringbufferEntryRip(RingBufferType t, uint64_t sk) {
   ringbufferEntry(t, sk, rip);
 }
 
+/*
+ * Per-thread structured binary rings, plus a registry of all rings ever
+ * created so a dumper can walk them. Like tl_ring_ptr above, the rings are
+ * never freed, so registry entries stay valid after their thread exits.
+ */
+static __thread RingBufferEntry* tl_struct_ring;
+static __thread unsigned tl_structIdx;
+
+static pthread_mutex_t s_structRingsLock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<RingBufferEntry*>* s_structRings;
+
+NEVER_INLINE static RingBufferEntry* initStructRing() {
+  auto const ring = (RingBufferEntry*)calloc(sizeof(RingBufferEntry),
+                                             kMaxStructuredRBEntries);
+  pthread_mutex_lock(&s_structRingsLock);
+  if (!s_structRings) s_structRings = new std::vector<RingBufferEntry*>();
+  s_structRings->push_back(ring);
+  pthread_mutex_unlock(&s_structRingsLock);
+  tl_struct_ring = ring;
+  return ring;
+}
+
+void
+structuredRingbufferEntry(RingBufferType t, uint64_t sk, uint64_t data) {
+  static_assert((kMaxStructuredRBEntries & (kMaxStructuredRBEntries - 1)) == 0,
+                "kMaxStructuredRBEntries must be a power of two");
+  auto ring = tl_struct_ring;
+  if (UNLIKELY(!ring)) ring = initStructRing();
+  auto& rb = ring[tl_structIdx];
+  tl_structIdx = (tl_structIdx + 1) & (kMaxStructuredRBEntries - 1);
+  rb.m_sk = sk;
+  rb.m_data = data;
+  rb.m_threadId = (uint32_t)((int64_t)pthread_self() & 0xFFFFFFFF);
+  rb.m_seq = g_seqnum.fetch_add(1, std::memory_order_relaxed);
+  rb.m_type = t;
+}
+
+/*
+ * Dump format, all integers little-endian host order:
+ *
+ *   char[8]  magic "HHVMRBUF"
+ *   uint32   version (currently 1)
+ *   uint32   sizeof(RingBufferEntry)
+ *   uint32   number of RingBufferTypes, then for each, in id order:
+ *     uint32 name length, followed by that many name bytes
+ *   uint32   number of rings, then for each:
+ *     uint32 number of entries, followed by the raw entries
+ *
+ * Embedding the type-name table makes the file self-describing, so the
+ * offline decoder does not need to match the hhvm binary that wrote it.
+ */
+bool dumpStructuredRingbuffers(const char* path) {
+  auto const f = fopen(path, "w");
+  if (!f) return false;
+  bool ok = true;
+  auto const writeU32 = [&](uint32_t v) {
+    ok &= fwrite(&v, sizeof(v), 1, f) == 1;
+  };
+
+  ok &= fwrite("HHVMRBUF", 8, 1, f) == 1;
+  writeU32(1);
+  writeU32(sizeof(RingBufferEntry));
+
+  uint32_t numTypes = 0;
+#define RBTYPE(x) ++numTypes;
+  RBTYPES
+#undef RBTYPE
+  writeU32(numTypes);
+  for (uint32_t i = 0; i < numTypes; ++i) {
+    auto const name = ringbufferName(static_cast<RingBufferType>(i));
+    auto const len = static_cast<uint32_t>(strlen(name));
+    writeU32(len);
+    ok &= fwrite(name, 1, len, f) == len;
+  }
+
+  pthread_mutex_lock(&s_structRingsLock);
+  std::vector<RingBufferEntry*> rings;
+  if (s_structRings) rings = *s_structRings;
+  pthread_mutex_unlock(&s_structRingsLock);
+
+  writeU32(static_cast<uint32_t>(rings.size()));
+  for (auto const ring : rings) {
+    writeU32(kMaxStructuredRBEntries);
+    ok &= fwrite(ring, sizeof(RingBufferEntry),
+                 kMaxStructuredRBEntries, f) == kMaxStructuredRBEntries;
+  }
+
+  ok &= fclose(f) == 0;
+  return ok;
+}
+
 }
 }
@@ -40,7 +40,9 @@ namespace Trace {
   RBTYPE(BytecodeStart) \
   RBTYPE(ServiceReq) \
   RBTYPE(DispatchBB) \
-  RBTYPE(InterpOne)
+  RBTYPE(InterpOne) \
+  RBTYPE(RequestBegin) \
+  RBTYPE(RequestEnd)
 
 enum RingBufferType : uint8_t {
 #define RBTYPE(x) RBType ## x,
@@ -92,6 +94,33 @@ void ringbufferMsg(const char* msg, size_t msgLen,
 void ringbufferEntry(RingBufferType t, uint64_t sk, uint64_t data);
 void ringbufferEntryRip(RingBufferType t, uint64_t sk);
 
+/*
+ * Structured, always-on tracing.
+ *
+ * Unlike the shared ringbuffer above, every writing thread owns a private
+ * ring, so recording an entry is a few plain stores with no atomic
+ * read-modify-write on a shared cache line (only the global sequence
+ * number, a relaxed increment, is shared). Records are typed ids plus raw
+ * arguments -- nothing is formatted at trace time -- which keeps the
+ * facility cheap enough to leave enabled in production.
+ *
+ * The rings can be written out in a self-describing binary format via
+ * dumpStructuredRingbuffers() (see the dump-trace-rings admin command) and
+ * decoded offline with hphp/tools/trace-ring-decode.py.
+ */
+
+constexpr unsigned kMaxStructuredRBEntries = 1 << 14; // per thread
+
+void structuredRingbufferEntry(RingBufferType t, uint64_t sk, uint64_t data);
+
+/*
+ * Write all threads' structured rings to 'path'. The snapshot is racy with
+ * respect to concurrent writers; in-flight entries may be torn, and the
+ * decoder is expected to discard records that do not parse. Returns false
+ * if the file could not be written.
+ */
+bool dumpStructuredRingbuffers(const char* path);
+
 }
 }
 
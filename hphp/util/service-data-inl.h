@@ -51,6 +51,28 @@ inline void ExportedHistogram::removeValue(int64_t value) {
   m_histogram->removeValue(value);
 }
 
+inline uint32_t ExportedStripedHistogram::bucketFor(int64_t value) {
+  if (value < static_cast<int64_t>(kSubBuckets)) {
+    return value < 0 ? 0 : static_cast<uint32_t>(value);
+  }
+  auto const v = static_cast<uint64_t>(value);
+  auto const h = 63 - __builtin_clzll(v);
+  return (h - kSubBucketBits + 1) * kSubBuckets +
+         static_cast<uint32_t>((v >> (h - kSubBucketBits)) & (kSubBuckets - 1));
+}
+
+inline uint32_t ExportedStripedHistogram::stripeIndex() {
+  static std::atomic<uint32_t> s_nextStripe{0};
+  static thread_local uint32_t tl_stripe =
+    s_nextStripe.fetch_add(1, std::memory_order_relaxed) % kNumStripes;
+  return tl_stripe;
+}
+
+inline void ExportedStripedHistogram::addValue(int64_t value) {
+  m_stripes[stripeIndex()].m_buckets[bucketFor(value)]
+    .fetch_add(1, std::memory_order_relaxed);
+}
+
 }  // namespace ServiceData
 
 //////////////////////////////////////////////////////////////////////
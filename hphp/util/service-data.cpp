@@ -17,6 +17,7 @@
 #include "hphp/util/service-data.h"
 
 #include <array>
+#include <cmath>
 #include <memory>
 #include <vector>
 #include <tbb/concurrent_unordered_map.h>
@@ -131,6 +132,91 @@ void ExportedHistogram::exportAll(const std::string& prefix,
   }
 }
 
+namespace {
+
+// ExportedHistogram keys are built with folly::to<int32_t>(percentile * 100),
+// which cannot express sub-percent percentiles. Use as many digits as needed
+// instead: 0.5 -> "p50", 0.95 -> "p95", 0.999 -> "p999".
+std::string percentileName(double percentile) {
+  auto const scaled = percentile * 100;
+  if (scaled == std::floor(scaled)) {
+    return folly::to<std::string>("p", static_cast<int64_t>(scaled));
+  }
+  return folly::to<std::string>("p", static_cast<int64_t>(percentile * 1000));
+}
+
+} // namespace
+
+ExportedStripedHistogram::ExportedStripedHistogram(
+  const std::vector<double>& exportPercentiles)
+    : m_stripes(new Stripe[kNumStripes]),
+      m_exportPercentiles(exportPercentiles) {
+  for (uint32_t s = 0; s < kNumStripes; ++s) {
+    for (auto& bucket : m_stripes[s].m_buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+int64_t ExportedStripedHistogram::bucketLow(uint32_t index) {
+  if (index < kSubBuckets) return index;
+  auto const h = index / kSubBuckets + kSubBucketBits - 1;
+  auto const sub = index % kSubBuckets;
+  return static_cast<int64_t>(
+    (static_cast<uint64_t>(kSubBuckets) + sub) << (h - kSubBucketBits));
+}
+
+int64_t ExportedStripedHistogram::bucketWidth(uint32_t index) {
+  if (index < kSubBuckets) return 1;
+  return int64_t{1} << (index / kSubBuckets - 1);
+}
+
+int64_t ExportedStripedHistogram::percentileEstimate(const uint64_t* counts,
+                                                     uint64_t total,
+                                                     double percentile) {
+  if (total == 0) return 0;
+  auto const target = percentile * static_cast<double>(total);
+  uint64_t cumulative = 0;
+  for (uint32_t b = 0; b < kNumBuckets; ++b) {
+    if (counts[b] == 0) continue;
+    if (static_cast<double>(cumulative + counts[b]) >= target) {
+      // Interpolate linearly within the bucket.
+      auto const frac =
+        (target - static_cast<double>(cumulative)) / counts[b];
+      return bucketLow(b) + static_cast<int64_t>(frac * bucketWidth(b));
+    }
+    cumulative += counts[b];
+  }
+  return bucketLow(kNumBuckets - 1);
+}
+
+void ExportedStripedHistogram::exportAll(
+    const std::string& prefix,
+    std::map<std::string, int64_t>& statsMap) {
+  // Merge the stripes. Updates are relaxed stores from other threads, so
+  // the merged view is only approximately a point-in-time snapshot; that
+  // is good enough for reporting.
+  std::array<uint64_t, kNumBuckets> merged;
+  merged.fill(0);
+  uint64_t total = 0;
+  for (uint32_t s = 0; s < kNumStripes; ++s) {
+    for (uint32_t b = 0; b < kNumBuckets; ++b) {
+      auto const count =
+        m_stripes[s].m_buckets[b].load(std::memory_order_relaxed);
+      merged[b] += count;
+      total += count;
+    }
+  }
+
+  for (double percentile : m_exportPercentiles) {
+    statsMap.insert(
+      std::make_pair(
+        folly::to<std::string>(
+          prefix, ".hist.", percentileName(percentile)),
+        percentileEstimate(merged.data(), total, percentile)));
+  }
+}
+
 namespace detail {
 template <class ClassWithPrivateDestructor>
 struct FriendDeleter {
@@ -246,6 +332,13 @@ struct Impl {
       m_histogramMap, name, bucketSize, min, max, exportPercentiles);
   }
 
+  ExportedStripedHistogram* createStripedHistogram(
+      const std::string& name,
+      const std::vector<double>& exportPercentiles) {
+    return getOrCreateWithArgs(
+      m_stripedHistogramMap, name, exportPercentiles);
+  }
+
   void exportAll(std::map<std::string, int64_t>& statsMap) {
     for (auto& counter : m_counterMap) {
       statsMap.insert(std::make_pair(counter.first,
@@ -260,6 +353,10 @@ struct Impl {
       histogram.second->exportAll(histogram.first, statsMap);
     }
 
+    for (auto& histogram : m_stripedHistogramMap) {
+      histogram.second->exportAll(histogram.first, statsMap);
+    }
+
     SYNCHRONIZED_CONST(m_counterFuncs) {
       for (auto& pair : m_counterFuncs) {
         pair.second(statsMap);
@@ -304,11 +401,14 @@ struct Impl {
     ExportedTimeSeriesMap;
   typedef tbb::concurrent_unordered_map<std::string, ExportedHistogram*>
     ExportedHistogramMap;
+  typedef tbb::concurrent_unordered_map<std::string, ExportedStripedHistogram*>
+    ExportedStripedHistogramMap;
 
   ExportedCounterMap m_counterMap;
   folly::Synchronized<CounterFuncMap> m_counterFuncs;
   ExportedTimeSeriesMap m_timeseriesMap;
   ExportedHistogramMap m_histogramMap;
+  ExportedStripedHistogramMap m_stripedHistogramMap;
 };
 
 // Implementation note:
@@ -374,6 +474,13 @@ ExportedHistogram* createHistogram(
     name, bucketSize, min, max, exportPercentile);
 }
 
+ExportedStripedHistogram* createStripedHistogram(
+    const std::string& name,
+    const std::vector<double>& exportPercentile) {
+  return getServiceDataInstance().createStripedHistogram(
+    name, exportPercentile);
+}
+
 void exportAll(std::map<std::string, int64_t>& statsMap) {
   return getServiceDataInstance().exportAll(statsMap);
 }
@@ -17,9 +17,11 @@
 #ifndef incl_HPHP_SERVICE_DATA_H_
 #define incl_HPHP_SERVICE_DATA_H_
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -98,6 +100,7 @@ namespace ServiceData {
 
 struct ExportedCounter;
 struct ExportedHistogram;
+struct ExportedStripedHistogram;
 struct ExportedTimeSeries;
 
 namespace detail {
@@ -223,6 +226,26 @@ ExportedHistogram* createHistogram(
   int64_t max,
   const std::vector<double>& exportPercentile);
 
+/*
+ * Create a striped histogram counter named 'name'. Return an existing one if
+ * it has already been created.
+ *
+ * Unlike createHistogram(), updates do not synchronize on a shared stats
+ * object: each thread adds into one of several stripes of atomic bucket
+ * counters, and the stripes are merged when the histogram is exported. This
+ * makes addValue() cheap enough for per-request instrumentation on every
+ * worker thread, at the cost of export-time merging and log-linear (rather
+ * than fixed-size) buckets.
+ *
+ * 'exportPercentile' works as for createHistogram(); percentiles that do not
+ * fall on a whole percent are exported with a promille suffix, e.g. 0.999 is
+ * exported as "name.hist.p999".
+ */
+ExportedStripedHistogram* createStripedHistogram(
+  const std::string& name,
+  const std::vector<double>& exportPercentile =
+    std::vector<double>{0.5, 0.95, 0.999});
+
 /*
  * Export all the statistics as simple key, value pairs.
  */
@@ -295,6 +318,47 @@ struct ExportedHistogram {
   const std::vector<double> m_exportPercentiles;
 };
 
+// Interface for striped histogram data. All methods are thread safe.
+struct ExportedStripedHistogram {
+  explicit ExportedStripedHistogram(
+    const std::vector<double>& exportPercentiles);
+
+  void addValue(int64_t value);
+  void exportAll(const std::string& prefix,
+                 std::map<std::string, int64_t>& statsMap);
+
+ private:
+  friend struct detail::FriendDeleter<ExportedStripedHistogram>;
+  ~ExportedStripedHistogram() {}
+
+  // Log-linear bucketing: each power-of-two range of values is split into
+  // kSubBuckets linear sub-buckets, bounding the relative quantization
+  // error at 1/kSubBuckets over the entire non-negative int64_t range.
+  static constexpr uint32_t kSubBucketBits = 4;
+  static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+  static constexpr uint32_t kNumBuckets = (64 - kSubBucketBits) * kSubBuckets;
+
+  // Number of independently updated copies of the bucket array. Threads are
+  // spread over the stripes round-robin, so with enough stripes an
+  // addValue() is an uncontended relaxed fetch_add.
+  static constexpr uint32_t kNumStripes = 16;
+
+  static uint32_t bucketFor(int64_t value);
+  static int64_t bucketLow(uint32_t index);
+  static int64_t bucketWidth(uint32_t index);
+  static uint32_t stripeIndex();
+  static int64_t percentileEstimate(const uint64_t* counts,
+                                    uint64_t total,
+                                    double percentile);
+
+  struct Stripe {
+    std::array<std::atomic<uint64_t>, kNumBuckets> m_buckets;
+  };
+
+  const std::unique_ptr<Stripe[]> m_stripes;
+  const std::vector<double> m_exportPercentiles;
+};
+
 };  // namespace ServiceData
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,150 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/util/simd-memmem.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/*
+ * Portable fallback: memchr on the first needle byte, then confirm with
+ * memcmp.  This is also what the candidate confirmation inside the
+ * vectorized kernels bottoms out in, so behavior is identical.
+ */
+const char* memmem_scalar(const char* haystack, size_t haystackLen,
+                          const char* needle, size_t needleLen) {
+  const char* p = haystack;
+  const char* end = haystack + haystackLen - needleLen;
+  char last = needle[needleLen - 1];
+  while (p <= end) {
+    p = (const char*)memchr(p, *needle, end - p + 1);
+    if (p == nullptr) return nullptr;
+    if (p[needleLen - 1] == last && !memcmp(p + 1, needle + 1, needleLen - 2)) {
+      return p;
+    }
+    p++;
+  }
+  return nullptr;
+}
+
+#ifdef __x86_64__
+
+/*
+ * Compare the first and the last bytes of the needle against two shifted
+ * windows of the haystack at once; each set bit in the resulting mask is
+ * a position where both bytes match, and only those candidates are
+ * confirmed with memcmp.  For needles with a rare first or last byte
+ * (the common case for markup and delimiters) almost every iteration
+ * retires 16/32 haystack bytes with no candidate at all.
+ */
+const char* memmem_sse2(const char* haystack, size_t haystackLen,
+                        const char* needle, size_t needleLen) {
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last  = _mm_set1_epi8(needle[needleLen - 1]);
+
+  const size_t scan = haystackLen - needleLen + 1;
+  size_t i = 0;
+  for (; i + 16 <= scan; i += 16) {
+    auto const blockFirst =
+      _mm_loadu_si128((const __m128i*)(haystack + i));
+    auto const blockLast =
+      _mm_loadu_si128((const __m128i*)(haystack + i + needleLen - 1));
+    auto mask = _mm_movemask_epi8(
+      _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst),
+                    _mm_cmpeq_epi8(last, blockLast)));
+    while (mask != 0) {
+      auto const bit = __builtin_ctz(mask);
+      if (!memcmp(haystack + i + bit + 1, needle + 1, needleLen - 2)) {
+        return haystack + i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  if (i < scan) {
+    return memmem_scalar(haystack + i, haystackLen - i, needle, needleLen);
+  }
+  return nullptr;
+}
+
+__attribute__((__target__("avx2")))
+const char* memmem_avx2(const char* haystack, size_t haystackLen,
+                        const char* needle, size_t needleLen) {
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last  = _mm256_set1_epi8(needle[needleLen - 1]);
+
+  const size_t scan = haystackLen - needleLen + 1;
+  size_t i = 0;
+  for (; i + 32 <= scan; i += 32) {
+    auto const blockFirst =
+      _mm256_loadu_si256((const __m256i*)(haystack + i));
+    auto const blockLast =
+      _mm256_loadu_si256((const __m256i*)(haystack + i + needleLen - 1));
+    uint32_t mask = _mm256_movemask_epi8(
+      _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst),
+                       _mm256_cmpeq_epi8(last, blockLast)));
+    while (mask != 0) {
+      auto const bit = __builtin_ctz(mask);
+      if (!memcmp(haystack + i + bit + 1, needle + 1, needleLen - 2)) {
+        return haystack + i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  if (i < scan) {
+    return memmem_sse2(haystack + i, haystackLen - i, needle, needleLen);
+  }
+  return nullptr;
+}
+
+using MemmemFn = const char* (*)(const char*, size_t, const char*, size_t);
+
+MemmemFn pick_memmem() {
+  return __builtin_cpu_supports("avx2") ? memmem_avx2 : memmem_sse2;
+}
+
+const MemmemFn s_memmem = pick_memmem();
+
+#endif
+
+}
+
+const char* simd_memmem(const char* haystack, size_t haystackLen,
+                        const char* needle, size_t needleLen) {
+  if (needleLen > haystackLen) return nullptr;
+  if (needleLen == 1) {
+    return (const char*)memchr(haystack, *needle, haystackLen);
+  }
+#ifdef __x86_64__
+  // Below ~2 vectors of haystack the dispatch and tail handling cost more
+  // than they save; let the scalar loop have it.
+  if (haystackLen >= 64) {
+    return s_memmem(haystack, haystackLen, needle, needleLen);
+  }
+#endif
+  return memmem_scalar(haystack, haystackLen, needle, needleLen);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,43 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_SIMD_MEMMEM_H_
+#define incl_HPHP_SIMD_MEMMEM_H_
+
+#include <stddef.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Vectorized substring search.
+ *
+ * Returns a pointer to the first occurrence of needle[0..needleLen) in
+ * haystack[0..haystackLen), or nullptr if it does not occur.  needleLen
+ * must be nonzero.  Unlike libc memmem, this is tuned for the large
+ * haystacks the string builtins see: on x64 it scans 32 (AVX2) or 16
+ * (SSE2) bytes per iteration, comparing the first and last needle bytes
+ * in parallel and only falling back to memcmp on candidate positions.
+ * The implementation is selected once at startup based on cpuid; other
+ * architectures get a portable memchr-driven loop.
+ */
+const char* simd_memmem(const char* haystack, size_t haystackLen,
+                        const char* needle, size_t needleLen);
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif
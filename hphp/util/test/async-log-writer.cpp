@@ -0,0 +1,56 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include <folly/Conv.h>
+#include <folly/portability/Unistd.h>
+
+#include "hphp/util/async-log-writer.h"
+
+namespace HPHP {
+
+TEST(AsyncLogWriterTest, OrderAndFlush) {
+  char tmpl[] = "/tmp/AsyncLogWriterTest.XXXXXX";
+  int fd = mkstemp(tmpl);
+  ASSERT_GE(fd, 0);
+  unlink(tmpl);
+
+  auto writer = AsyncLogWriter::Get();
+  for (int i = 0; i < 100; ++i) {
+    writer->enqueue(fd, folly::to<std::string>("line ", i, "\n"));
+  }
+  writer->flush();
+
+  lseek(fd, 0, SEEK_SET);
+  std::string contents(1 << 16, '\0');
+  auto nread = read(fd, &contents[0], contents.size());
+  ASSERT_GT(nread, 0);
+  contents.resize(nread);
+
+  // Same-fd lines must come out complete and in enqueue order.
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    expected += folly::to<std::string>("line ", i, "\n");
+  }
+  EXPECT_EQ(expected, contents);
+
+  close(fd);
+}
+
+}
@@ -15,6 +15,7 @@
 */
 #include "hphp/util/job-queue.h"
 
+#include <set>
 #include <thread>
 #include <gtest/gtest.h>
 
@@ -198,4 +199,70 @@ TEST(JobQueue, Priority) {
   EXPECT_EQ(4, fifo_queue.dequeueMaybeExpired(0, 0, true, &expired));
 }
 
+TEST(JobQueue, RetireWorkers) {
+  JobQueue<int> job_queue(2, 0, false);
+
+  // A retirement request makes the next idle dequeuer throw StopSignal
+  // without stopping the queue.
+  bool exceptionCaught = false;
+  std::thread thread([&]() {
+      bool expired;
+      try {
+        job_queue.dequeueMaybeExpired(0, 0, false, &expired);
+      } catch (const JobQueue<int>::StopSignal&) {
+        exceptionCaught = true;
+      }
+    });
+  job_queue.retireWorkers(1);
+  thread.join();
+  EXPECT_TRUE(exceptionCaught);
+
+  // The queue keeps serving jobs once the request has been consumed.
+  job_queue.enqueue(7);
+  bool expired;
+  EXPECT_EQ(7, job_queue.dequeueMaybeExpired(1, 0, false, &expired));
+}
+
+TEST(JobQueue, Stealing) {
+  StealingJobQueue<int> job_queue(2, 0, false);
+
+  // Attach both workers' slots by letting each pull one job.
+  bool expired;
+  job_queue.enqueue(100);
+  job_queue.enqueue(101);
+  std::set<int> warmup;
+  warmup.insert(job_queue.dequeueMaybeExpired(0, 0, false, &expired));
+  warmup.insert(job_queue.dequeueMaybeExpired(1, 0, false, &expired));
+  EXPECT_EQ(2, warmup.size());
+
+  for (int i = 0; i < 10; ++i) {
+    job_queue.enqueue(i);
+  }
+  EXPECT_EQ(10, job_queue.getQueuedJobs());
+
+  // Worker 0 can drain everything: its own deque, the shared overflow,
+  // and whatever landed in worker 1's deque.
+  std::set<int> seen;
+  for (int i = 0; i < 10; ++i) {
+    seen.insert(job_queue.dequeueMaybeExpired(0, 0, false, &expired));
+    EXPECT_FALSE(expired);
+  }
+  EXPECT_EQ(10, seen.size());
+  EXPECT_EQ(0, job_queue.getQueuedJobs());
+
+  // stop() wakes a blocked worker.
+  bool exceptionCaught = false;
+  std::thread thread([&]() {
+      bool expired2;
+      try {
+        job_queue.dequeueMaybeExpired(1, 0, false, &expired2);
+      } catch (const StealingJobQueue<int>::StopSignal&) {
+        exceptionCaught = true;
+      }
+    });
+  job_queue.stop();
+  thread.join();
+  EXPECT_TRUE(exceptionCaught);
+}
+
 }
@@ -16,6 +16,8 @@
 #include "hphp/util/read-only-arena.h"
 #include <gtest/gtest.h>
 
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace HPHP {
@@ -41,6 +43,34 @@ TEST(ReadOnlyArena, simpleTest) {
   EXPECT_EQ(strcmp(strP2, someJunk), 0);
 }
 
+TEST(ReadOnlyArena, concurrentTest) {
+  ReadOnlyArena arena(4096 * 10);
+
+  constexpr int kThreads = 8;
+  constexpr int kAllocsPerThread = 500;
+  std::vector<std::vector<const char*>> results(kThreads);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&arena, &results, t] {
+      for (int i = 0; i < kAllocsPerThread; ++i) {
+        auto str = std::to_string(t) + ":" + std::to_string(i);
+        results[t].push_back(static_cast<const char*>(
+          arena.allocate(str.c_str(), str.size() + 1)
+        ));
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kAllocsPerThread; ++i) {
+      auto expected = std::to_string(t) + ":" + std::to_string(i);
+      EXPECT_EQ(expected, results[t][i]);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////
 
 }
@@ -122,4 +122,20 @@ TEST(ServiceDataTest, Histogram) {
   }
 }
 
+TEST(ServiceDataTest, StripedHistogram) {
+  auto hist = ServiceData::createStripedHistogram("sfoo");
+
+  for (int i = 0; i < 100; ++i) {
+    hist->addValue(i);
+  }
+
+  {
+    std::map<std::string, int64_t> values;
+    ServiceData::exportAll(values);
+    EXPECT_EQ(50, values["sfoo.hist.p50"]);
+    EXPECT_EQ(95, values["sfoo.hist.p95"]);
+    EXPECT_EQ(99, values["sfoo.hist.p999"]);
+  }
+}
+
 }
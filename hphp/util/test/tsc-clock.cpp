@@ -0,0 +1,53 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/util/tsc-clock.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+namespace HPHP {
+
+TEST(TscClockTest, Monotonic) {
+  auto last = TscClock::nowNanos();
+  for (int i = 0; i < 1000; ++i) {
+    auto const now = TscClock::nowNanos();
+    EXPECT_GE(now, last);
+    last = now;
+  }
+}
+
+TEST(TscClockTest, TracksRealTime) {
+  auto const t0 = TscClock::nowMicros();
+  usleep(50000);
+  auto const elapsed = TscClock::nowMicros() - t0;
+  // usleep may oversleep but never undersleeps; allow generous slack above.
+  EXPECT_GE(elapsed, 50000);
+  EXPECT_LT(elapsed, 5000000);
+}
+
+TEST(TscClockTest, TickRate) {
+  if (!TscClock::invariant()) return;
+  auto const mhz = TscClock::tickRateMHz();
+  // Any machine we run on clocks somewhere between 100MHz and 10GHz.
+  EXPECT_GT(mhz, 100);
+  EXPECT_LT(mhz, 10000);
+  // One second worth of ticks should convert back to about one second.
+  auto const us = TscClock::ticksToMicros(mhz * 1000000);
+  EXPECT_NEAR(us, 1000000, 1000);
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/util/utf8-scan.h"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+
+namespace HPHP {
+
+TEST(Utf8ScanTest, AsciiPrefix) {
+  EXPECT_EQ(0, utf8_ascii_prefix("", 0));
+
+  // Long enough to exercise the vector loop, with the first non-ASCII
+  // byte at every offset within a 16-byte chunk.
+  std::string s(64, 'a');
+  EXPECT_EQ(s.size(), utf8_ascii_prefix(s.data(), s.size()));
+  for (size_t i = 0; i < 40; ++i) {
+    auto t = s;
+    t[i] = '\xc3';
+    EXPECT_EQ(i, utf8_ascii_prefix(t.data(), t.size()));
+  }
+}
+
+TEST(Utf8ScanTest, ValidSequences) {
+  auto const ok = [] (const char* s) {
+    return utf8_is_valid(s, std::strlen(s));
+  };
+  EXPECT_TRUE(ok(""));
+  EXPECT_TRUE(ok("plain ascii"));
+  EXPECT_TRUE(ok("caf\xc3\xa9"));                  // U+00E9
+  EXPECT_TRUE(ok("\xe2\x82\xac"));                 // U+20AC
+  EXPECT_TRUE(ok("\xed\x9f\xbf"));                 // U+D7FF, below surrogates
+  EXPECT_TRUE(ok("\xee\x80\x80"));                 // U+E000, above surrogates
+  EXPECT_TRUE(ok("\xf0\x90\x80\x80"));             // U+10000
+  EXPECT_TRUE(ok("\xf4\x8f\xbf\xbf"));             // U+10FFFF
+}
+
+TEST(Utf8ScanTest, InvalidSequences) {
+  auto const bad = [] (const char* s) {
+    return !utf8_is_valid(s, std::strlen(s));
+  };
+  EXPECT_TRUE(bad("\x80"));                        // bare continuation
+  EXPECT_TRUE(bad("\xc3"));                        // truncated sequence
+  EXPECT_TRUE(bad("\xc0\xaf"));                    // overlong two-byte
+  EXPECT_TRUE(bad("\xe0\x80\xaf"));                // overlong three-byte
+  EXPECT_TRUE(bad("\xf0\x80\x80\xaf"));            // overlong four-byte
+  EXPECT_TRUE(bad("\xed\xa0\x80"));                // U+D800, surrogate
+  EXPECT_TRUE(bad("\xed\xbf\xbf"));                // U+DFFF, surrogate
+  EXPECT_TRUE(bad("\xf4\x90\x80\x80"));            // above U+10FFFF
+  EXPECT_TRUE(bad("\xf5\x80\x80\x80"));            // invalid lead
+  EXPECT_TRUE(bad("ok until \xc3\x28 here"));      // bad continuation
+}
+
+TEST(Utf8ScanTest, Utf16Ascii) {
+  uint16_t units[32];
+  for (size_t i = 0; i < 32; ++i) units[i] = 'x';
+  EXPECT_TRUE(utf16_is_ascii(units, 32));
+  EXPECT_TRUE(utf16_is_ascii(units, 0));
+
+  for (size_t i = 0; i < 20; ++i) {
+    units[i] = 0x20ac;
+    EXPECT_FALSE(utf16_is_ascii(units, 32));
+    units[i] = 'x';
+  }
+}
+
+}
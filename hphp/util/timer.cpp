@@ -22,6 +22,7 @@
 
 #include "hphp/util/logger.h"
 #include "hphp/util/trace.h"
+#include "hphp/util/tsc-clock.h"
 #include "hphp/util/vdso.h"
 
 namespace HPHP {
@@ -76,7 +77,12 @@ void Timer::report() const {
 }
 
 void Timer::GetMonotonicTime(timespec &ts) {
-  vdso::clock_gettime(CLOCK_MONOTONIC, &ts);
+  // All callers diff these timestamps against each other, so the calibrated
+  // TSC source is safe to substitute for CLOCK_MONOTONIC (and falls back to
+  // it on machines without an invariant TSC).
+  auto const ns = TscClock::nowNanos();
+  ts.tv_sec = ns / 1000000000;
+  ts.tv_nsec = ns % 1000000000;
 }
 
 void Timer::GetRealtimeTime(timespec &ts) {
@@ -0,0 +1,116 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/util/tsc-clock.h"
+
+#include "hphp/util/cycles.h"
+#include "hphp/util/vdso.h"
+
+#include <folly/portability/Time.h>
+#include <folly/portability/Unistd.h>
+
+#ifdef __x86_64__
+#include <cpuid.h>
+#endif
+
+namespace HPHP {
+
+namespace {
+///////////////////////////////////////////////////////////////////////////////
+
+bool detectInvariantTsc() {
+#ifdef __x86_64__
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx)) return false;
+  if (eax < 0x80000007) return false;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+  // EDX bit 8: invariant TSC.
+  return (edx & (1u << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+struct Calibration {
+  bool invariant{false};
+  double nsPerTick{0.0};
+  double ticksPerUs{0.0};
+  uint64_t anchorTsc{0};
+  int64_t anchorNs{0};
+
+  Calibration() {
+    invariant = detectInvariantTsc();
+    if (!invariant) return;
+
+    // Calibrate against CLOCK_MONOTONIC over a ~10ms window.  Unlike the
+    // busy-loop calibration hotprofiler historically did, sleeping is fine
+    // here: an invariant TSC keeps counting at its fixed rate through idle
+    // states.  The serialized reads keep the counter samples from drifting
+    // into or out of the bracketing clock_gettime calls.
+    auto const t0 = vdso::clock_gettime_ns(CLOCK_MONOTONIC);
+    auto const c0 = cpuCyclesSerialized();
+    usleep(10000);
+    auto const c1 = cpuCyclesSerialized();
+    auto const t1 = vdso::clock_gettime_ns(CLOCK_MONOTONIC);
+    if (c1 <= c0 || t1 <= t0) {
+      invariant = false;
+      return;
+    }
+    nsPerTick = double(t1 - t0) / double(c1 - c0);
+    ticksPerUs = double(c1 - c0) * 1000.0 / double(t1 - t0);
+    anchorTsc = c1;
+    anchorNs = t1;
+  }
+};
+
+const Calibration& calib() {
+  static Calibration c;
+  return c;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+bool TscClock::invariant() {
+  return calib().invariant;
+}
+
+int64_t TscClock::tickRateMHz() {
+  auto const& c = calib();
+  return c.invariant ? int64_t(c.ticksPerUs + 0.5) : 0;
+}
+
+int64_t TscClock::ticksToNanos(uint64_t ticks) {
+  return int64_t(ticks * calib().nsPerTick);
+}
+
+int64_t TscClock::ticksToMicros(uint64_t ticks) {
+  return ticksToNanos(ticks) / 1000;
+}
+
+int64_t TscClock::nowNanos() {
+  auto const& c = calib();
+  if (!c.invariant) {
+    return vdso::clock_gettime_ns(CLOCK_MONOTONIC);
+  }
+  return c.anchorNs + int64_t(double(cpuCycles() - c.anchorTsc) * c.nsPerTick);
+}
+
+int64_t TscClock::nowMicros() {
+  return nowNanos() / 1000;
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef incl_HPHP_UTIL_TSC_CLOCK_H_
+#define incl_HPHP_UTIL_TSC_CLOCK_H_
+
+#include <cstdint>
+
+namespace HPHP {
+
+/*
+ * A process-wide calibrated TSC time source.
+ *
+ * On machines with an invariant TSC (a counter that ticks at a constant
+ * rate regardless of frequency scaling or idle states, synchronized across
+ * cores), reading the cycle counter and scaling by a per-boot calibration
+ * against CLOCK_MONOTONIC yields monotonic time in a handful of
+ * nanoseconds -- several times cheaper than even the vdso clock_gettime
+ * path.  When the TSC is not invariant every query falls back to
+ * clock_gettime, so callers may use this unconditionally.
+ *
+ * Because all readings share one process-wide anchor, timestamps taken on
+ * different threads may be diffed against each other.  Calibration error
+ * is on the order of parts per million, so TSC-derived timestamps should
+ * not be compared against raw CLOCK_MONOTONIC readings taken elsewhere.
+ */
+struct TscClock {
+  /*
+   * Whether the TSC is invariant and the calibrated fast path is in use.
+   */
+  static bool invariant();
+
+  /*
+   * The calibrated TSC rate in ticks per microsecond (i.e. MHz).  Returns
+   * 0 when the TSC is not invariant.
+   */
+  static int64_t tickRateMHz();
+
+  /*
+   * Convert a tick delta (e.g. a difference of two cpuCycles() readings)
+   * to wall time.  Only meaningful when invariant() is true.
+   */
+  static int64_t ticksToMicros(uint64_t ticks);
+  static int64_t ticksToNanos(uint64_t ticks);
+
+  /*
+   * Current monotonic time.
+   */
+  static int64_t nowNanos();
+  static int64_t nowMicros();
+};
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include "hphp/util/utf8-scan.h"
+
+#ifdef __x86_64__
+#include <emmintrin.h>
+#endif
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+size_t utf8_ascii_prefix(const char* data, size_t len) {
+  size_t pos = 0;
+#ifdef __x86_64__
+  // The sign bit of each byte is exactly the non-ASCII bit, so a
+  // 16-byte movemask finds the first multibyte lead or continuation
+  // byte directly.
+  while (len - pos >= 16) {
+    auto const chunk =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    auto const mask = _mm_movemask_epi8(chunk);
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+    pos += 16;
+  }
+#endif
+  while (pos < len && !(static_cast<uint8_t>(data[pos]) & 0x80)) {
+    ++pos;
+  }
+  return pos;
+}
+
+bool utf8_is_valid(const char* data, size_t len) {
+  auto const bytes = reinterpret_cast<const uint8_t*>(data);
+  size_t pos = 0;
+
+  auto const cont = [&] (size_t i) {
+    return i < len && (bytes[i] & 0xc0) == 0x80;
+  };
+
+  while (pos < len) {
+    // Skip runs of ASCII in bulk; multibyte sequences tend to cluster,
+    // so resuming the vector scan after each one is still a win on
+    // mostly-ASCII text.
+    pos += utf8_ascii_prefix(data + pos, len - pos);
+    if (pos >= len) break;
+
+    auto const lead = bytes[pos];
+    if (lead >= 0xc2 && lead <= 0xdf) {
+      // Two bytes: U+0080..U+07FF.  Leads c0/c1 would be overlong.
+      if (!cont(pos + 1)) return false;
+      pos += 2;
+    } else if (lead == 0xe0) {
+      // Three bytes, low range: the second byte must be a0..bf or the
+      // sequence encodes a code point below U+0800 (overlong).
+      if (pos + 2 >= len ||
+          bytes[pos + 1] < 0xa0 || bytes[pos + 1] > 0xbf ||
+          !cont(pos + 2)) {
+        return false;
+      }
+      pos += 3;
+    } else if (lead == 0xed) {
+      // Three bytes, U+D000..U+D7FF: a second byte above 9f would land
+      // in the surrogate range U+D800..U+DFFF.
+      if (pos + 2 >= len ||
+          bytes[pos + 1] < 0x80 || bytes[pos + 1] > 0x9f ||
+          !cont(pos + 2)) {
+        return false;
+      }
+      pos += 3;
+    } else if ((lead & 0xf0) == 0xe0) {
+      // Remaining three byte leads: e1..ec, ee, ef.
+      if (!cont(pos + 1) || !cont(pos + 2)) return false;
+      pos += 3;
+    } else if (lead == 0xf0) {
+      // Four bytes, low range: the second byte must be 90..bf or the
+      // sequence encodes a code point below U+10000 (overlong).
+      if (pos + 3 >= len ||
+          bytes[pos + 1] < 0x90 || bytes[pos + 1] > 0xbf ||
+          !cont(pos + 2) || !cont(pos + 3)) {
+        return false;
+      }
+      pos += 4;
+    } else if (lead >= 0xf1 && lead <= 0xf3) {
+      if (!cont(pos + 1) || !cont(pos + 2) || !cont(pos + 3)) return false;
+      pos += 4;
+    } else if (lead == 0xf4) {
+      // Four bytes, high range: a second byte above 8f would exceed
+      // U+10FFFF.
+      if (pos + 3 >= len ||
+          bytes[pos + 1] < 0x80 || bytes[pos + 1] > 0x8f ||
+          !cont(pos + 2) || !cont(pos + 3)) {
+        return false;
+      }
+      pos += 4;
+    } else {
+      // Bare continuation byte, overlong lead (c0/c1), or lead beyond
+      // U+10FFFF (f5..ff).
+      return false;
+    }
+  }
+  return true;
+}
+
+bool utf16_is_ascii(const uint16_t* data, size_t len) {
+  size_t pos = 0;
+#ifdef __x86_64__
+  while (len - pos >= 8) {
+    auto const chunk =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    // Any unit >= 0x80 has a nonzero bit outside the low seven, so
+    // masking against ~0x7f and testing for zero covers all eight
+    // units at once.
+    auto const high = _mm_andnot_si128(_mm_set1_epi16(0x7f), chunk);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) !=
+        0xffff) {
+      return false;
+    }
+    pos += 8;
+  }
+#endif
+  for (; pos < len; ++pos) {
+    if (data[pos] >= 0x80) return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,59 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010-present Facebook, Inc. (http://www.facebook.com)  |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+#ifndef incl_HPHP_UTF8_SCAN_H_
+#define incl_HPHP_UTF8_SCAN_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Bulk scanning helpers for UTF-8 and UTF-16 buffers.
+ *
+ * Most strings that pass through the encoding extensions are pure
+ * ASCII, and for those the generic converters (ICU, libmbfl) spend all
+ * their time discovering byte by byte that there is nothing to do.
+ * These helpers let callers detect the common cases up front with a
+ * vectorized scan and fall back to the full converter only when the
+ * input actually contains multibyte data.
+ */
+
+/*
+ * Return the length of the longest prefix of data that consists
+ * entirely of ASCII bytes (< 0x80).  Returns len when the whole buffer
+ * is ASCII.
+ */
+size_t utf8_ascii_prefix(const char* data, size_t len);
+
+/*
+ * Return true iff data is well-formed UTF-8 in the strict RFC 3629
+ * sense: no overlong encodings, no surrogate code points, and nothing
+ * above U+10FFFF.
+ */
+bool utf8_is_valid(const char* data, size_t len);
+
+/*
+ * Return true iff every UTF-16 code unit in data is an ASCII character
+ * (< 0x80).
+ */
+bool utf16_is_ascii(const uint16_t* data, size_t len);
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif
@@ -19,6 +19,10 @@
 #include <unicode/uchar.h>
 #include <unicode/utf8.h>
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #include "hphp/util/lock.h"
 #include "hphp/util/functional.h"
 #include "hphp/util/hash-map-typedefs.h"
@@ -670,6 +674,35 @@ char *string_html_encode(const char *input, int &len,
   }
   char *q = ret;
   for (const char *p = input, *end = input + len; p < end; p++) {
+#ifdef __x86_64__
+    // Copy runs with no markup-significant bytes 16 at a time. ORing the
+    // chunk itself into the movemask operand flags any byte >= 0x80 (its
+    // sign bit is set), so non-ASCII input drops to the scalar code
+    // below, which deals with charsets and quote-style flags.
+    while (end - p >= 16) {
+      auto const chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      auto const special = _mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+                       _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\''))),
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')),
+                       _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>')))),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('&')), chunk)));
+      if (special == 0) {
+        memcpy(q, p, 16);
+        q += 16;
+        p += 16;
+        continue;
+      }
+      auto const run = __builtin_ctz(special);
+      memcpy(q, p, run);
+      q += run;
+      p += run;
+      break;
+    }
+    if (p >= end) break;
+#endif
     unsigned char c = *p;
     char entity[5];
     int codeLength = 0;